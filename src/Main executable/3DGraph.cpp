@@ -24,6 +24,7 @@
 #include "ZBuffer.h"
 #include "TopoGraf.h"
 #include "MapSprites.h"
+#include "NewCode/TerrainRaster.h"
 int MaxTex;
 void ErrM(char* s);
 //#include "3DLow.h"
@@ -769,104 +770,6 @@ bool PrecPrepareToRender(int NLines, int startX, int startY) {
 	//Now we are ready to render trrriangle !!!!!!!!!!!!
 	return true;
 };
-static word STRTX;
-bool AbsolutePrecPrepareToRender(int NLines, int startX, int startY) {
-	__asm {
-		mov		ax, VertBuf[0]
-		mov		bx, VertBuf[2]
-		cmp		ax, 0xFFFF
-		je		uu1
-		cmp		bx, 0xFFFF
-		je		uu3
-		cmp		ax, bx
-		jb		uu3
-		mov		curx, bx
-		jmp		uu5
-		uu3 : mov		curx, ax
-			  jmp		uu5
-			  uu1 : mov		curx, 0xFFFF
-					uu5 :
-	};
-	STRTX = startX;
-	OffsetX = -curx + startX;
-	OffsetY = -startY;
-	if (curx == 0xFFFF)return false;
-	BMXStart = BMX + BMDXX*(curx - startX) - BMDXY*startY;
-	BMYStart = BMY + BMDYX*(curx - startX) - BMDYY*startY;
-	fogstart = FOG1 + FogDx*(curx - startX) - FogDy*startY;
-	__asm {
-		push	edi
-		push	esi
-		pushf
-		mov		esi, offset VertBuf
-		mov		ecx, NLines
-		mov		bx, curx
-		mov		edi, BMXStart
-		mov		TempEBP, EBP
-		mov		ebp, BMYStart
-		per1 : mov		bx, curx
-			   mov		dx, [esi]
-			   mov		ax, [esi + 2]
-			   cmp		ax, 0xFFFF
-			   jne		per2
-			   mov		ax, dx
-			   per2 : cmp		dx, ax
-					  jb		per3
-					  xchg	dx, ax	//now dx<=ax
-					  per3 : sub		ax, dx
-							 mov[esi + 2], ax  //now ax is free
-							 cmp		dx, bx		//dx=x1,bx=curx
-							 je		x1eqCurx
-							 jae		x1moreCurx
-							 //need to move left,x1<curx
-							 mov		ax, bx
-							 sub		ax, dx
-							 mov		ebx, fogstart
-							 per4 : sub		edi, BMDXX
-									sub		ebp, BMDYX
-									//and     edi,00111111111111110011111111111111b
-									sub		ebx, FogDx
-									dec		ax
-									jnz		per4
-									mov		fogstart, ebx
-									jmp		PrepareToNextLine
-									x1moreCurx :
-		mov		ax, dx
-			sub		ax, bx
-			mov		ebx, fogstart
-			per5 : add		edi, BMDXX
-			add		ebp, BMDYX
-			//and     edi,00111111111111110011111111111111b
-			add		ebx, FogDx
-			dec		ax
-			jnz		per5
-			mov		fogstart, ebx
-			x1eqCurx :
-	PrepareToNextLine:
-		mov		ebx, fogstart
-			mov[esi + 12], ebx
-			add		ebx, FogDy
-			mov		fogstart, ebx
-			mov		bx, curx
-			mov		curx, dx
-			sub		dx, STRTX
-			mov[esi], dx
-			mov[esi + 4], edi
-			mov[esi + 8], ebp
-			add		edi, BMDXY   //edi=BMxy
-			add		ebp, BMDYY
-			//and     edi,00111111111111110011111111111111b
-			add		esi, 16
-			dec		ecx
-			jnz		per1
-			mov		EBP, TempEBP
-			popf
-			pop		esi
-			pop		edi
-	};
-	//Now we are ready to render trrriangle !!!!!!!!!!!!
-	return true;
-};
 //RENDERING THE TRIANGLE. 
 //It is really important. Before this oeration
 //VertBuf must be filled by values of x1,Lx,BMxy,Fog
@@ -1309,160 +1212,6 @@ int RenderBestTriangle128(int xs1, int ys1,
 		f1 << 16, FDx, FDy, Bitm, Dest);
 
 };
-int DirectRenderTriangle64Dithering(int NLines, int StartLine, int EndLine, int DestSizeX, byte* Dest, byte* Bitmap) {
-	if (StartLine >= NLines || EndLine < 0)return 0;
-	int RealStartLine = StartLine;
-	if (RealStartLine < 0)RealStartLine = 0;
-	int RealEndLine = EndLine;
-	if (RealEndLine >= NLines)RealEndLine = NLines - 1;
-	RealEndLine -= RealStartLine - 1;
-	int Startscan;
-	int ScanSize;
-	int VertPos;
-	//((int*)Dest)[1]=OffsetX;
-	//((int*)Dest)[2]=OffsetY;
-	int VBpos = int(VertBuf) + (RealStartLine << 4);
-	int StartEDI = int(Dest) + RealStartLine*DestSizeX;
-	__asm {
-		push	esi
-		push	edi
-		pushf
-		mov		esi, Bitmap
-		add		edi, 12
-		mov		ebx, VBpos
-		cld
-		StartLineCode :
-		//Rendering the linear transformation
-		mov		edi, StartEDI
-			mov		ecx, [ebx]
-			//mov		[edi],ecx
-			xor eax, eax
-			mov		ax, cx
-			test	cx, 0x8000
-			jz		ululuk
-			or eax, 0xFFFF0000
-			ululuk:
-		add		edi, eax   //edi points to Dest
-			shr		ecx, 16    //Length of the scan line
-			mov		ScanSize, ecx
-			mov		Startscan, edi  //Storing for shadowing
-			mov		edx, [ebx + 4]    //BMX
-			mov		VertPos, ebx
-			mov		ebx, [ebx + 8]    //BMY
-			//and     ebx,0011 1111 1111 1110 0011 1111 1111 1110b
-			jcxz	StartShad
-			StartLinear :
-		mov		eax, edx     //1
-			ror		ebx, 8       //0
-			shr		eax, 16      //1
-			mov		ah, bh       //1
-			and		ax, 0011111100111111b
-			mov		al, [esi + eax]//?
-			rol		ebx, 8       //0
-			add		edx, BMDXX   //0
-			add		ebx, BMDYX   //1
-			dec		cx          //0
-			stosb               //0  could be optimized to stosd
-			jnz		StartLinear //1
-
-	//Shadow processing
-			StartShad :
-		mov		edi, Startscan
-			mov		esi, VertPos
-			mov		ecx, ScanSize
-			mov		ebx, [esi + 12]   //fog
-			test	NLines, 1
-			jz		uuu2
-			add		ebx, 16384
-			uuu2:
-		mov		edx, FogDx
-			//mov		edi,Startscan
-			jcxz	endfog
-			StartFog4 :      //Not optimal now! 32 bit reading coulde performed
-		mov		eax, ebx
-			sar		eax, 8
-			add		ebx, edx
-			add		ebx, 32768
-			mov		al, [edi]
-			mov		al, [darkfog + 16384 + eax]
-			mov[edi], al
-			inc		edi
-			dec		cx
-			jz		endfog
-			mov		eax, ebx
-			sar		eax, 8
-			add		ebx, edx
-			sub		ebx, 32768
-			mov		al, [edi]
-			mov		al, [darkfog + 16384 + eax]
-			mov[edi], al
-			inc		edi
-			dec		cx
-			jnz		StartFog4
-			endfog : mov		edi, StartEDI
-			add		edi, DestSizeX
-			mov		StartEDI, edi
-			mov		ebx, esi
-			mov		esi, Bitmap
-			add		ebx, 16
-			dec		RealEndLine
-			jnz		StartLineCode
-			popf
-			pop		esi
-			pop		edi
-	};
-	return 0;
-};
-int DirectPreRenderTri64(int x1, int y1,
-	int x2, int y2,
-	int x3, int y3,
-	int bmx, int bmy,
-	int bmdxx, int bmdyx, int bmdxy, int bmdyy,
-	int fog, int fogdx, int fogdy,
-	byte* bitm,
-	byte* Dest,
-	int StartLine, int EndLine, int ScanSize) {
-	int z1 = GetMin(y1, y2, y3);
-	int z2 = GetMax(y1, y2, y3);
-	int MyStart = StartLine + y1 - z1;
-	int MyEnd = EndLine + y1 - z1;
-	curScrOfs = x1 + y1*Buf3DLx;
-	CurFog = fog;
-	curXT = x1;
-	curYT = y1 - z1;
-	FogDx = fogdx;
-	FogDy = fogdy;
-	BMX = bmx;
-	BMY = bmy;
-	BMDXX = bmdxx;
-	BMDYX = bmdyx;
-	BMDXY = bmdxy;
-	BMDYY = bmdyy;
-	FOG1 = fog;
-	int VBpos = int(VertBuf);
-	//Инициализация VertBuf
-	__asm {
-		push	edi
-		pushf
-		cld
-		mov		edi, VBpos
-		mov		ecx, z2
-		sub		ecx, z1
-		inc		ecx
-		uux1 : mov		dword ptr[edi], 0xFFFFFFFF;
-		add		edi, 16
-			dec		ecx
-			jnz		uux1
-			popf
-			pop		edi
-	};
-	addLine(x2, y2 - z1);
-	addLine(x3, y3 - z1);
-	addLine(x1, y1 - z1);
-	AbsolutePrecPrepareToRender(z2 - z1 + 1, x1, y1 - z1);
-	DirectRenderTriangle64Dithering(z2 - z1 + 1, MyStart, MyEnd, ScanSize, Dest + (z1 - y1)*ScanSize, bitm);//Dithering(z2-z1+1,Dest,bitm);
-	return 0;
-};
 void DirectRenderTriangle64(int xs1, int ys1,
 	int xs2, int ys2,
 	int xs3, int ys3,
@@ -1472,48 +1221,9 @@ void DirectRenderTriangle64(int xs1, int ys1,
 	int f1, int f2, int f3,
 	byte * Dest, byte* Bitm,
 	int StartLine, int EndLine, int ScanSize) {
-	StartLine -= ys1;
-	EndLine -= ys1;
-	Dest += xs1 + ys1*ScanSize;
-	int dxb2 = xb2 - xb1;
-	int dxb3 = xb3 - xb1;
-	int dyb2 = yb2 - yb1;
-	int dyb3 = yb3 - yb1;
-	int dxs2 = xs2 - xs1;
-	int dxs3 = xs3 - xs1;
-	int dys2 = ys2 - ys1;
-	int dys3 = ys3 - ys1;
-
-	int D = dxs2*dys3 - dys2*dxs3;
-	if (!D) {
-		Dest = NULL;
-		return;
-	};
-	int Axx = dys3*dxb2 - dxb3*dys2;
-	int Axy = dxs2*dxb3 - dxb2*dxs3;
-	int Ayx = dys3*dyb2 - dyb3*dys2;
-	int Ayy = dxs2*dyb3 - dyb2*dxs3;
-
-	Axx = div(Axx << 16, D).quot;
-	Ayy = div(Ayy << 16, D).quot;
-	Axy = div(Axy << 16, D).quot;
-	Ayx = div(Ayx << 16, D).quot;
-
-	int bmxy = ((xb1 & 63) << 8) + ((yb1 & 63) << 24);
-	int bmdx = word(Axx) + (word(Ayx) << 16);
-	int bmdy = word(Axy) + (word(Ayy) << 16);
-	//Fogging
-	int DScr = dys2*dxs3 - dxs2*dys3;
-	int FDx = 0;
-	int FDy = 0;
-	if (DScr) {
-		FDx = div(((f3 - f1)*dys2 - dys3*(f2 - f1)) << 16, DScr).quot;
-		FDy = div(((f2 - f1)*dxs3 - dxs2*(f3 - f1)) << 16, DScr).quot;
-	};
-	DirectPreRenderTri64(xs1, ys1, xs2, ys2, xs3, ys3,
-		((xb1 & 255) << 16) + 32768, ((yb1 & 255) << 16) + 32768, Axx, Ayx, Axy, Ayy,
-		(f1 << 16) + 32768, FDx, FDy, Bitm, Dest, StartLine, EndLine, ScanSize);
-
+	//reentrant, the sectors of the VirtualScreen are rendered in parallel
+	TR_RenderTriangle64(xs1, ys1, xs2, ys2, xs3, ys3, xb1, yb1, xb2, yb2, xb3, yb3,
+		f1, f2, f3, Dest, Bitm, StartLine, EndLine, ScanSize, darkfog);
 };
 //---------------------NEW 3D MAP RENDERING!--------------------
 
@@ -1613,6 +1323,7 @@ void SetHi(int i, int h) {
 	if (i<0 || i>MaxTH*(MaxTH + 1))return;
 	THMap[i] = h;
 };
+void MarkPointToDraw(int i);
 void CreateTriBlob(int x, int y, int h, int r) {
 	int sx = x << 5;
 	int sy = y << 5;
@@ -1632,6 +1343,7 @@ void CreateTriBlob(int x, int y, int h, int r) {
 				double sss = -double((vx - sx)*(vx - sx) + (vy - sy)*(vy - sy)) / r2;
 				if (abs(int(sss)) < 10) dh = int(double(h)*exp(sss));
 				SetHi(vert, GetHi(vert) + dh);
+				if (dh)MarkPointToDraw(vert);
 			};
 		};
 };
@@ -1650,10 +1362,10 @@ void CreateEffect(int x, int y, int r, HiCallback* HCB) {
 				vx = GetTriX(vert);
 				vy = GetTriY(vert);
 				SetHi(vert, HCB(vx, vy, GetHi(vert)));
+				MarkPointToDraw(vert);
 			};
 		};
 };
-void MarkPointToDraw(int i);
 void CreateAveragePlane(int x, int y, int r) {
 	int h = 0;
 	int np = 0;
@@ -2383,7 +2095,7 @@ int RenderSector(int i, bool Mode3D, byte* DST, bool NeedRender)
 					SECTMAP(StartSide),
 					SECTMAP(StartSide + 2),
 					SECTMAP(StartSide + SectInLine + 1),
-					SimpleMask, tex1);
+					SimpleMask, tex1, ResultMask);
 				RSIZE = RenderBestTriangle64(1024 + x1, 1024 + z1, 1024 + x3, 1024 + z3, 1024 + x2, 1024 + z2,
 					30, 15, 0, 31, 0, 0,
 					f1, f3, f2, DST,
@@ -2394,7 +2106,7 @@ int RenderSector(int i, bool Mode3D, byte* DST, bool NeedRender)
 					SECTMAP(StartSide + 2),
 					SECTMAP(StartSide + 3),
 					SECTMAP(StartSide + 1),
-					SimpleMask, tex1);
+					SimpleMask, tex1, ResultMask);
 				RSIZE = RenderBestTriangle64(1024 + x1, 1024 + z1, 1024 + x3, 1024 + z3, 1024 + x2, 1024 + z2,
 					30, 1, 1, 14, 30, 30,
 					f1, f3, f2, DST,
@@ -2405,7 +2117,7 @@ int RenderSector(int i, bool Mode3D, byte* DST, bool NeedRender)
 					SECTMAP(StartSide + 3),
 					SECTMAP(StartSide + 4),
 					SECTMAP(StartSide + 5),
-					SimpleMask, tex1);
+					SimpleMask, tex1, ResultMask);
 				RSIZE = RenderBestTriangle64(1024 + x1, 1024 + z1, 1024 + x3, 1024 + z3, 1024 + x2, 1024 + z2,
 					1, 30, 1, 1, 30, 14,
 					f1, f3, f2, DST,
@@ -2416,7 +2128,7 @@ int RenderSector(int i, bool Mode3D, byte* DST, bool NeedRender)
 					SECTMAP(StartSide + SectInLine + 4),
 					SECTMAP(StartSide + 6),
 					SECTMAP(StartSide + 5),
-					SimpleMask, tex1);
+					SimpleMask, tex1, ResultMask);
 				RSIZE = RenderBestTriangle64(1024 + x1, 1024 + z1, 1024 + x3, 1024 + z3, 1024 + x2, 1024 + z2,
 					30, 30, 30, 1, 1, 14,
 					f1, f3, f2, DST,
@@ -373,7 +373,10 @@ void SetTexture(int Vert, int nm) {
 	else {
 		if (ix >= 0 && ix < maxmap&&iy >= 0 && iy < maxmap)minimap[iy][ix] = c;
 	};
-	TexMap[Vert] = nm;
+	if (TexMap[Vert] != nm) {
+		TexMap[Vert] = nm;
+		MarkPointToDraw(Vert);
+	};
 	word tf = TexFlags[nm];
 	/*
 	if(tf&TEX_PLAIN)AddTHMap[Vert]=0;
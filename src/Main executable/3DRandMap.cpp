@@ -1890,7 +1890,11 @@ void MakeUndo()
 					if ( OB->LockType )OB->RealDir = 32;
 					OB->Die();
 					OB = Group[ID];
-					if ( OB )OB->Sdoxlo = 2500;
+					if ( OB )
+					{
+						OB->Sdoxlo = 2500;
+						StoreObjHot( OB );
+					}
 				};
 			};
 			break;
@@ -3343,6 +3347,7 @@ bool CreateRandomTerrain( char* Name, int NPlay, int MountStyle,
 			if ( OB )
 			{
 				OB->Sdoxlo = 6000;
+				StoreObjHot( OB );
 			}
 		}
 	}
@@ -5008,6 +5013,7 @@ void GenerateMapForMission( char* Relief, char* Ground, char* Mount, char* Soft
 			if ( OB )
 			{
 				OB->Sdoxlo = 6000;
+				StoreObjHot( OB );
 			}
 		}
 	}
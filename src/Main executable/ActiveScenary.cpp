@@ -38,6 +38,7 @@
 #include "EInfoClass.h"
 
 #include "PlayerInfo.h"
+#include "NewCode/ObjIndex.h"
 extern PlayerInfo PINFO[8];
 
 extern bool NOPAUSE;
@@ -83,7 +84,8 @@ void HandleMission()
 		GTM++;
 	}
 }
-void FogSpot( int x, int y );
+void FogLight( int x, int y, int Type );
+void FlushFogLights();
 void ScenaryLights()
 {
 	for ( int i = 0; i < 64; i++ )
@@ -93,88 +95,12 @@ void ScenaryLights()
 		int Type = SCENINF.LSpot[i].Type;
 		if ( xx )
 		{
-			int rr = 200;
-			int rr1 = rr - ( rr >> 2 );
 			yy -= ( GetHeight( xx, yy ) << 1 );
-			switch ( Type )
-			{
-			case 0:
-				FogSpot( xx, yy );
-				break;
-			case 1:
-				FogSpot( xx + 128, yy );
-				FogSpot( xx - 128, yy );
-				FogSpot( xx, yy + 128 );
-				FogSpot( xx, yy - 128 );
-				break;
-			case 2:
-				FogSpot( xx + 128, yy + 128 );
-				FogSpot( xx - 128, yy + 128 );
-				FogSpot( xx + 128, yy - 128 );
-				FogSpot( xx - 128, yy - 128 );
-				break;
-			case 3:
-				FogSpot( xx + 2 * 128, yy );
-				FogSpot( xx - 2 * 128, yy );
-				FogSpot( xx, yy - 2 * 128 );
-				FogSpot( xx, yy + 2 * 128 );
-				FogSpot( xx + 128, yy + 128 );
-				FogSpot( xx - 128, yy + 128 );
-				FogSpot( xx + 128, yy - 128 );
-				FogSpot( xx - 128, yy - 128 );
-				break;
-			case 4:
-				FogSpot( xx + 3 * 128, yy );
-				FogSpot( xx - 3 * 128, yy );
-				FogSpot( xx, yy + 3 * 128 );
-				FogSpot( xx, yy - 3 * 128 );
-				FogSpot( xx + 2 * 128, yy + 2 * 128 );
-				FogSpot( xx - 2 * 128, yy + 2 * 128 );
-				FogSpot( xx + 2 * 128, yy - 2 * 128 );
-				FogSpot( xx - 2 * 128, yy - 2 * 128 );
-				break;
-			case 5:
-				FogSpot( xx + 4 * 128, yy );
-				FogSpot( xx - 4 * 128, yy );
-				FogSpot( xx, yy + 4 * 128 );
-				FogSpot( xx, yy - 4 * 128 );
-				FogSpot( xx + 3 * 128, yy + 3 * 128 );
-				FogSpot( xx - 3 * 128, yy + 3 * 128 );
-				FogSpot( xx + 3 * 128, yy - 3 * 128 );
-				FogSpot( xx - 3 * 128, yy - 3 * 128 );
-				break;
-			case 6:
-				FogSpot( xx + 5 * 128, yy );
-				FogSpot( xx - 5 * 128, yy );
-				FogSpot( xx, yy + 5 * 128 );
-				FogSpot( xx, yy - 5 * 128 );
-				FogSpot( xx + 4 * 128, yy + 4 * 128 );
-				FogSpot( xx - 4 * 128, yy + 4 * 128 );
-				FogSpot( xx + 4 * 128, yy - 4 * 128 );
-				FogSpot( xx - 4 * 128, yy - 4 * 128 );
-				break;
-			case 7:
-				FogSpot( xx + 6 * 128, yy );
-				FogSpot( xx - 6 * 128, yy );
-				FogSpot( xx, yy + 6 * 128 );
-				FogSpot( xx, yy - 6 * 128 );
-				FogSpot( xx + 4 * 128, yy + 4 );
-				FogSpot( xx - 4 * 128, yy + 4 * 128 );
-				FogSpot( xx + 4 * 128, yy - 4 * 128 );
-				FogSpot( xx - 4 * 128, yy - 4 * 128 );
-				break;
-			default:
-				FogSpot( xx + 7 * 128, yy );
-				FogSpot( xx - 7 * 128, yy );
-				FogSpot( xx, yy + 7 * 128 );
-				FogSpot( xx, yy - 7 * 128 );
-				FogSpot( xx + 5 * 128, yy + 3 );
-				FogSpot( xx - 5 * 128, yy + 5 * 128 );
-				FogSpot( xx + 5 * 128, yy - 5 * 128 );
-				FogSpot( xx - 5 * 128, yy - 5 * 128 );
-			}
+			//types above 7 use the widest spots without the center
+			FogLight( xx, yy, Type >= 0 && Type < 8 ? Type : 9 );
 		}
 	}
+	FlushFogLights();
 }
 void ScenaryInterface::UnLoading()
 {
@@ -879,11 +805,11 @@ extern "C" __declspec( dllexport ) int GetUnitsAmount0( GAMEOBJ* Zone, byte Nati
 					int NMon = MCount[cell];
 					if ( NMon )
 					{
-						int ofs1 = cell << SHFCELL;
+						word* CUnits = CB_CellUnits( cell );
 						word MID;
 						for ( int i = 0; i < NMon; i++ )
 						{
-							MID = GetNMSL( ofs1 + i );
+							MID = CUnits[i];
 							if ( MID != 0xFFFF )
 							{
 								OneObject* OB = Group[MID];
@@ -939,11 +865,11 @@ extern "C" __declspec( dllexport ) int GetUnitsAmount0( GAMEOBJ* Zone, byte Nati
 					int NMon = MCount[cell];
 					if ( NMon )
 					{
-						int ofs1 = cell << SHFCELL;
+						word* CUnits = CB_CellUnits( cell );
 						word MID;
 						for ( int i = 0; i < NMon; i++ )
 						{
-							MID = GetNMSL( ofs1 + i );
+							MID = CUnits[i];
 							if ( MID != 0xFFFF )
 							{
 								OneObject* OB = Group[MID];
@@ -1061,11 +987,11 @@ extern "C" __declspec( dllexport ) void SelectUnitsInZone( GAMEOBJ* Zone, byte N
 					int NMon = MCount[cell];
 					if ( NMon )
 					{
-						int ofs1 = cell << SHFCELL;
+						word* CUnits = CB_CellUnits( cell );
 						word MID;
 						for ( int i = 0; i < NMon; i++ )
 						{
-							MID = GetNMSL( ofs1 + i );
+							MID = CUnits[i];
 							if ( MID != 0xFFFF )
 							{
 								OneObject* OB = Group[MID];
@@ -1122,11 +1048,11 @@ extern "C" __declspec( dllexport ) void SelectUnitsInZone( GAMEOBJ* Zone, byte N
 					int NMon = MCount[cell];
 					if ( NMon )
 					{
-						int ofs1 = cell << SHFCELL;
+						word* CUnits = CB_CellUnits( cell );
 						word MID;
 						for ( int i = 0; i < NMon; i++ )
 						{
-							MID = GetNMSL( ofs1 + i );
+							MID = CUnits[i];
 							if ( MID != 0xFFFF )
 							{
 								OneObject* OB = Group[MID];
@@ -1215,11 +1141,11 @@ extern "C" __declspec( dllexport ) void SelectTypeOfUnitsInZone( GAMEOBJ* Zone,
 					int NMon = MCount[cell];
 					if ( NMon )
 					{
-						int ofs1 = cell << SHFCELL;
+						word* CUnits = CB_CellUnits( cell );
 						word MID;
 						for ( int i = 0; i < NMon; i++ )
 						{
-							MID = GetNMSL( ofs1 + i );
+							MID = CUnits[i];
 							if ( MID != 0xFFFF )
 							{
 								OneObject* OB = Group[MID];
@@ -1276,11 +1202,11 @@ extern "C" __declspec( dllexport ) void SelectTypeOfUnitsInZone( GAMEOBJ* Zone,
 					int NMon = MCount[cell];
 					if ( NMon )
 					{
-						int ofs1 = cell << SHFCELL;
+						word* CUnits = CB_CellUnits( cell );
 						word MID;
 						for ( int i = 0; i < NMon; i++ )
 						{
-							MID = GetNMSL( ofs1 + i );
+							MID = CUnits[i];
 							if ( MID != 0xFFFF )
 							{
 								OneObject* OB = Group[MID];
@@ -1400,11 +1326,11 @@ extern "C" __declspec( dllexport ) int GetUnitsAmount2( GAMEOBJ* Zone, GAMEOBJ*
 					int NMon = MCount[cell];
 					if ( NMon )
 					{
-						int ofs1 = cell << SHFCELL;
+						word* CUnits = CB_CellUnits( cell );
 						word MID;
 						for ( int i = 0; i < NMon; i++ )
 						{
-							MID = GetNMSL( ofs1 + i );
+							MID = CUnits[i];
 							if ( MID != 0xFFFF )
 							{
 								OneObject* OB = Group[MID];
@@ -1456,11 +1382,11 @@ extern "C" __declspec( dllexport ) int GetUnitsAmount2( GAMEOBJ* Zone, GAMEOBJ*
 					int NMon = MCount[cell];
 					if ( NMon )
 					{
-						int ofs1 = cell << SHFCELL;
+						word* CUnits = CB_CellUnits( cell );
 						word MID;
 						for ( int i = 0; i < NMon; i++ )
 						{
-							MID = GetNMSL( ofs1 + i );
+							MID = CUnits[i];
 							if ( MID != 0xFFFF )
 							{
 								OneObject* OB = Group[MID];
@@ -2009,7 +1935,7 @@ extern "C" __declspec( dllexport ) void SelectUnitsType( GAMEOBJ* UnitsType, byt
 	}
 	int NU = 0;
 	GeneralObject* GO = NATIONS[Nat].Mon[UnitsType->Index];
-	for ( int i = 0; i < MAXOBJECT; i++ )
+	for ( int i = OI_Next( 0 ); i < MAXOBJECT; i = OI_Next( i + 1 ) )
 	{
 		OneObject* OB = Group[i];
 		if ( OB && ( !OB->Sdoxlo ) && OB->Ref.General == GO&&OB->NNUM == Nat )NU++;
@@ -2026,7 +1952,7 @@ extern "C" __declspec( dllexport ) void SelectUnitsType( GAMEOBJ* UnitsType, byt
 		NSL[Nat] += NU;
 
 		NU = 0;
-		for ( int i = 0; i < MAXOBJECT; i++ )
+		for ( int i = OI_Next( 0 ); i < MAXOBJECT; i = OI_Next( i + 1 ) )
 		{
 			OneObject* OB = Group[i];
 			if ( OB && ( !OB->Sdoxlo ) && OB->Ref.General == GO&&OB->NNUM == Nat )
@@ -2294,11 +2220,11 @@ word SearchUnitInZone( int zx, int zy, int Rz, byte Nat )
 				int NMon = MCount[cell];
 				if ( NMon )
 				{
-					int ofs1 = cell << SHFCELL;
+					word* CUnits = CB_CellUnits( cell );
 					word MID;
 					for ( int i = 0; i < NMon; i++ )
 					{
-						MID = GetNMSL( ofs1 + i );
+						MID = CUnits[i];
 						if ( MID != 0xFFFF )
 						{
 							OneObject* OB = Group[MID];
@@ -2414,11 +2340,11 @@ OneObject* SearchUnitInCell( int cell, byte nmask )
 	cell += VAL_MAXCX + 1;
 	int NMon = MCount[cell];
 	if ( NMon < 3 )return NULL;
-	int ofs1 = cell << SHFCELL;
+	word* CUnits = CB_CellUnits( cell );
 	word MID;
 	for ( int i = 0; i < NMon; i++ )
 	{
-		MID = GetNMSL( ofs1 + i );
+		MID = CUnits[i];
 		if ( MID != 0xFFFF )
 		{
 			OneObject* OB = Group[MID];
@@ -2432,11 +2358,11 @@ OneObject* SearchShipInCell( int cell, byte nmask )
 	cell += VAL_MAXCX + 1;
 	int NMon = MCount[cell];
 	if ( NMon < 3 )return NULL;
-	int ofs1 = cell << SHFCELL;
+	word* CUnits = CB_CellUnits( cell );
 	word MID;
 	for ( int i = 0; i < NMon; i++ )
 	{
-		MID = GetNMSL( ofs1 + i );
+		MID = CUnits[i];
 		if ( MID != 0xFFFF )
 		{
 			OneObject* OB = Group[MID];
@@ -2698,7 +2624,7 @@ extern "C" __declspec( dllexport ) void ChangeFriends( byte Nat, byte Flags )
 		SCENINF.NErrors++;
 		return;
 	}
-	for ( int i = 0; i < MAXOBJECT; i++ )
+	for ( int i = OI_Next( 0 ); i < MAXOBJECT; i = OI_Next( i + 1 ) )
 	{
 		OneObject* OB = Group[i];
 		if ( OB&&OB->NNUM == Nat )
@@ -2750,6 +2676,7 @@ extern "C" __declspec( dllexport ) void SelChangeNation( byte SrcNat, byte DstNa
 				//OB->Selected=0;
 				//OB->ImSelected=0;
 				AddObject( OB );
+				IndexObject( OB );
 			}
 		}
 	}
@@ -3263,7 +3190,7 @@ extern "C" __declspec( dllexport ) void RunAI( byte Nat )
 	{
 		NT->AI_Enabled = true;
 		//NT->NMask=0x7E;
-		for ( int i = 0; i < MAXOBJECT; i++ )
+		for ( int i = OI_Next( 0 ); i < MAXOBJECT; i = OI_Next( i + 1 ) )
 		{
 			OneObject* OB = Group[i];
 			if ( OB&&OB->NNUM == Nat&&OB->newMons->Usage == PeasantID )
@@ -3279,7 +3206,7 @@ extern "C" __declspec( dllexport ) void RunAI( byte Nat )
 			}
 		}
 	RegUni:;
-		for ( int i = 0; i < MAXOBJECT; i++ )
+		for ( int i = OI_Next( 0 ); i < MAXOBJECT; i = OI_Next( i + 1 ) )
 		{
 			OneObject* OB = Group[i];
 			if ( OB&&OB->NNUM == Nat&&OB->BrigadeID == 0xFFFF )
@@ -3311,7 +3238,7 @@ extern "C" __declspec( dllexport ) void RunAIWithPeasants( byte Nat, char* P_Nam
 				LoadAIFromDLL( Nat, GlobalAI.Ai[j].LandAI[0] );
 			}
 		}
-		for ( int i = 0; i < MAXOBJECT; i++ )
+		for ( int i = OI_Next( 0 ); i < MAXOBJECT; i = OI_Next( i + 1 ) )
 		{
 			OneObject* OB = Group[i];
 			if ( OB&&OB->NNUM == Nat&&OB->BrigadeID == 0xFFFF )
@@ -4683,6 +4610,7 @@ extern "C" __declspec( dllexport ) void SetUnitInfo( OneUnit* Uni )
 			{
 				OB->RealX = Uni->x << 4;
 				OB->RealY = Uni->y << 4;
+				StoreObjHot( OB );
 			}
 		}
 	}
@@ -5388,7 +5316,7 @@ extern "C" __declspec( dllexport )bool NationIsErased( byte Nat )
 		//for(int i=0;i<8;i++)if(NATIONS[i].VictState==1)LockN[i]=0;
 		int NMyUnits = 0;
 		//NThemUnits=0;
-		for ( int i = 0; i < MAXOBJECT; i++ )
+		for ( int i = OI_Next( 0 ); i < MAXOBJECT; i = OI_Next( i + 1 ) )
 		{
 			OneObject* OB = Group[i];
 			if ( OB && !( OB->Sdoxlo && !OB->Hidden ) )
@@ -5467,7 +5395,7 @@ extern "C" __declspec( dllexport ) int GetRandomIndex()
 	if ( NPlayers )
 	{
 		int RR = 0;
-		for ( int i = 0; i < MAXOBJECT; i++ )
+		for ( int i = OI_Next( 0 ); i < MAXOBJECT; i = OI_Next( i + 1 ) )
 		{
 			OneObject* OB = Group[i];
 			if ( OB )
@@ -6341,7 +6269,7 @@ extern "C" __declspec( dllexport ) void SelectBuildingsInZone( byte NI, GAMEOBJ*
 
 	if ( UTP )
 	{
-		for ( int i = 0; i < MAXOBJECT; i++ )
+		for ( int i = OI_Next( 0, OIL_BUILDINGS ); i < MAXOBJECT; i = OI_Next( i + 1, OIL_BUILDINGS ) )
 		{
 			OneObject* OB = Group[i];
 			if ( OB && OB->NewBuilding && OB->NIndex == UTP->Index && OB->NNUM == NI && !OB->Sdoxlo )
@@ -6356,7 +6284,7 @@ extern "C" __declspec( dllexport ) void SelectBuildingsInZone( byte NI, GAMEOBJ*
 	}
 	else
 	{
-		for ( int i = 0; i < MAXOBJECT; i++ )
+		for ( int i = OI_Next( 0, OIL_BUILDINGS ); i < MAXOBJECT; i = OI_Next( i + 1, OIL_BUILDINGS ) )
 		{
 			OneObject* OB = Group[i];
 			if ( OB && OB->NewBuilding && OB->NNUM == NI && !OB->Sdoxlo )
@@ -27,6 +27,8 @@
 #include "StrategyResearch.h"
 #include "Safety.h"
 #include "EinfoClass.h"
+#include "NewCode/NavalPlan.h"
+#include <vector>
 
 extern int PeaceTimeLeft;
 void CheckArmies( City* CT );
@@ -1010,10 +1012,10 @@ int Brigade::AddInRadius( int x, int y, int r, BrigMemb* pBM )
 				int N1 = MCount[ofst];
 				if ( N1 )
 				{
-					ofst <<= SHFCELL;
+					word* CUnits = CB_CellUnits( ofst );
 					for ( int k = 0; k < N1; k++ )
 					{
-						word MID = GetNMSL( ofst + k );
+						word MID = CUnits[k];
 						if ( MID != 0xFFFF )
 						{
 							OneObject* OB = Group[MID];
@@ -1652,11 +1654,11 @@ int FindUnitsInCell( int cell, int x, int y, int r, int Type, byte Nation, int N
 		if ( cell >= VAL_MAXCIOFS )return 0;
 		int NMon = MCount[cell];
 		if ( !NMon )return NULL;
-		int ofs1 = cell << SHFCELL;
+		word* CUnits = CB_CellUnits( cell );
 		word MID;
 		for ( int i = 0; i < NMon; i++ )
 		{
-			MID = GetNMSL( ofs1 + i );
+			MID = CUnits[i];
 			if ( MID != 0xFFFF )
 			{
 				OneObject* OB = Group[MID];
@@ -3160,11 +3162,11 @@ word CheckMotionThroughEnemyAbility( OneObject* OB, int px, int py )
 			cell += VAL_MAXCX + 1;
 			int NMon = MCount[cell];
 			if ( !NMon )return 0xFFFF;
-			int ofs1 = cell << SHFCELL;
+			word* CUnits = CB_CellUnits( cell );
 			word MID;
 			for ( int i = 0; i < NMon; i++ )
 			{
-				MID = GetNMSL( ofs1 + i );
+				MID = CUnits[i];
 				if ( MID != 0xFFFF )
 				{
 					OneObject* OBJ = Group[MID];
@@ -3233,11 +3235,11 @@ void Brigade_Bitva::AddEnemXY( int x, int y, int MyTop, byte mask )
 	{
 		int NMon = MCount[cell];
 		if ( !NMon )return;
-		int ofs1 = cell << SHFCELL;
+		word* CUnits = CB_CellUnits( cell );
 		word MID;
 		for ( int i = 0; i < NMon; i++ )
 		{
-			MID = GetNMSL( ofs1 + i );
+			MID = CUnits[i];
 			if ( MID != 0xFFFF )
 			{
 				OneObject* OB = Group[MID];
@@ -4641,7 +4643,6 @@ word GetNearestBrig( City* CT, word Top )
 {
 	int D = 1000000;
 	int BRB = -1;
-	int TP1 = Top*WNAreas;
 	for ( int i = 0; i < 128; i++ )
 	{
 		int N = CT->WaterBrigs[i];
@@ -4659,7 +4660,7 @@ word GetNearestBrig( City* CT, word Top )
 					}
 					else
 					{
-						int R = WLinksDist[TP1 + TP];
+						int R = GetTopDist( 1, TP, Top );
 						if ( R < D )
 						{
 							D = R;
@@ -4676,7 +4677,6 @@ word GetNearestBrigToKillUnitsAndTowers( City* CT, word Top )
 {
 	int D = 1000000;
 	int BRB = -1;
-	int TP1 = Top*WNAreas;
 	for ( int i = 0; i < 128; i++ )
 	{
 		int N = CT->WaterBrigs[i];
@@ -4694,7 +4694,7 @@ word GetNearestBrigToKillUnitsAndTowers( City* CT, word Top )
 					}
 					else
 					{
-						int R = WLinksDist[TP1 + TP];
+						int R = GetTopDist( 1, TP, Top );
 						if ( R < D )
 						{
 							D = R;
@@ -4711,7 +4711,6 @@ word GetNearestBrigToKillMines( City* CT, word Top )
 {
 	int D = 1000000;
 	int BRB = -1;
-	int TP1 = Top*WNAreas;
 	for ( int i = 0; i < 128; i++ )
 	{
 		int N = CT->WaterBrigs[i];
@@ -4729,7 +4728,7 @@ word GetNearestBrigToKillMines( City* CT, word Top )
 					}
 					else
 					{
-						int R = WLinksDist[TP1 + TP];
+						int R = GetTopDist( 1, TP, Top );
 						if ( R < D )
 						{
 							D = R;
@@ -4746,7 +4745,6 @@ word GetNearestBrigWithType( City* CT, word Top, byte Type )
 {
 	int D = 1000000;
 	int BRB = -1;
-	int TP1 = Top*WNAreas;
 	for ( int i = 0; i < 128; i++ )
 	{
 		int N = CT->WaterBrigs[i];
@@ -4764,7 +4762,7 @@ word GetNearestBrigWithType( City* CT, word Top, byte Type )
 					}
 					else
 					{
-						int R = WLinksDist[TP1 + TP];
+						int R = GetTopDist( 1, TP, Top );
 						if ( R < D )
 						{
 							D = R;
@@ -4798,8 +4796,6 @@ void MakeShipBattleLink( Brigade* BR )
 	int FinalTop = -1;
 	//test for connection
 	City* CT = BR->CT;
-	word* WDst = GTOP[1].LinksDist;
-	int NWA = GTOP[1].NAreas;
 	int XC = int( CT->CenterX ) << ( 7 + 4 );
 	int YC = int( CT->CenterY ) << ( 7 + 4 );
 	EnemyInfo* EIN = GNFO.EINF[BR->CT->NI];
@@ -4839,7 +4835,7 @@ void MakeShipBattleLink( Brigade* BR )
 						int FTop = BRF->LastTopology;
 						if ( FTop != 0xFFFF )
 						{
-							int D = WDst[FTop*NWA + CurTop];
+							int D = GetTopDist( 1, FTop, CurTop );
 							if ( FTop == CurTop || D < 24 )
 							{
 								if ( BR->NMemb < BRF->NMemb )
@@ -4923,7 +4919,7 @@ void MakeShipBattleLink( Brigade* BR )
 					int FTop = BRF->LastTopology;
 					if ( FTop != 0xFFFF )
 					{
-						int D = WDst[FTop*NWA + CurTop];
+						int D = GetTopDist( 1, FTop, CurTop );
 						if ( D < MinD )
 						{
 							int F = EIN->GetMaxForceOnTheWay( CurTop, FTop );
@@ -4947,11 +4943,12 @@ void MakeShipBattleLink( Brigade* BR )
 		for ( int i = 0; i < EIN->NSGRP; i++ )if ( SGR->CTop != 0xFFFF )
 		{
 			int DT = 0;
-			if ( SGR->CTop != CurTop )DT = WLinksDist[CurTop*WNAreas + SGR->CTop];
+			//water links are symmetric, the ways toward CurTop serve all groups
+			if ( SGR->CTop != CurTop )DT = GetTopDist( 1, SGR->CTop, CurTop );
 			int R0 = Norma( ( ( SGR->xL + SGR->xR ) >> 1 ) - XC, ( ( SGR->yL + SGR->yR ) >> 1 ) - YC );
 			int F = EIN->GetMaxForceOnTheWay( CurTop, SGR->CTop );
 			if ( CurTop == SGR->CTop )DT = 0;
-			else DT = WLinksDist[CurTop*WNAreas + SGR->CTop];
+			else DT = GetTopDist( 1, SGR->CTop, CurTop );
 			if ( DT < MinTopDst )
 			{
 				F -= F >> 1;
@@ -4990,7 +4987,7 @@ void MakeShipBattleLink( Brigade* BR )
 		for ( int i = 0; i < EIN->NWTopNear; i++ )
 		{
 			int top = EIN->WTopNear[i];
-			int D = WLinksDist[top*WNAreas + CurTop];
+			int D = GetTopDist( 1, top, CurTop );
 			if ( top == CurTop )D = 0;
 			if ( D < DT )
 			{
@@ -5048,7 +5045,7 @@ void MakeShipBattleLink( Brigade* BR )
 
 	if ( FinalTop != -1 && CurTop >= 0 && CurTop < 0xFFFE )
 	{
-		NextTop = GTOP[1].MotionLinks[FinalTop + CurTop*GTOP[1].NAreas];
+		NextTop = GetNextTop( 1, CurTop, FinalTop );
 		if ( NextTop < 0xFFFE )
 		{
 			OR->Params[1] = NextTop;
@@ -5163,6 +5160,24 @@ int NCost;
 int MaxCost;
 extern byte* WaterDeep;
 extern int WLX;
+int GetWTopology( int x, int y, byte LTP );
+
+static int CostPlaceInfo( int i, int* x, int* y, int* Key )
+{
+	CostPlace* CP = COSTPL + i;
+	*x = CP->xw;
+	*y = CP->yw;
+	*Key = CP->Island;
+	return GetWTopology( CP->xw << 4, CP->yw << 4, 1 );
+}
+
+//Spatial index of the cost places, after they are made or loaded and
+//after the water topology
+void IndexCostPlaces()
+{
+	NP_SetNorm( &Norma );
+	NP_SetCoast( NCost, &CostPlaceInfo );
+}
 
 void CreateCostPlaces()
 {
@@ -5227,6 +5242,7 @@ void CreateCostPlaces()
 	}
 	MFT->FreeAlloc();
 	free( MFT );
+	IndexCostPlaces();
 }
 
 int GetWarInCell( int cell )
@@ -5234,12 +5250,12 @@ int GetWarInCell( int cell )
 	cell += VAL_MAXCX + 1;
 	int NMon = MCount[cell];
 	if ( !NMon )return NULL;
-	int ofs1 = cell << SHFCELL;
+	word* CUnits = CB_CellUnits( cell );
 	word MID;
 	int NU = 0;
 	for ( int i = 0; i < NMon; i++ )
 	{
-		MID = GetNMSL( ofs1 + i );
+		MID = CUnits[i];
 		if ( MID != 0xFFFF )
 		{
 			OneObject* OB = Group[MID];
@@ -5289,11 +5305,11 @@ int GetTrInCell( int cell )
 		return 0;
 	}
 
-	int ofs1 = cell << SHFCELL;
+	word* CUnits = CB_CellUnits( cell );
 	word MID;
 	for ( int i = 0; i < NMon; i++ )
 	{
-		MID = GetNMSL( ofs1 + i );
+		MID = CUnits[i];
 		if ( MID != 0xFFFF )
 		{
 			OneObject* OB = Group[MID];
@@ -5358,6 +5374,7 @@ void ProcessCostPoints()
 void ClearCostPlaces()
 {
 	NCost = 0;
+	NP_SetCoast( 0, NULL );
 }
 
 extern int RealLx;
@@ -5405,27 +5422,28 @@ public:
 	int CostPointIndex;
 	int StartTime;
 };
+static bool FreeCost( int i, void* Param )
+{
+	CostPlace* CP = COSTPL + i;
+	return CP->Access && CP->Transport == 0xFFFF;
+};
+static bool CostOfIslands( int i, void* Param )
+{
+	CostPlace* CP = COSTPL + i;
+	byte* ISLSET = (byte*) Param;
+	int ISL = CP->Island;
+	return CP->Access && CP->Transport == 0xFFFF && ( ISLSET[ISL >> 3] & ( 1 << ( ISL & 7 ) ) ) != 0;
+};
+//Nearest free cost place of the island Isl
 int FindCostPoint( int x, int y, byte Isl )
 {
 	if ( !NCost )return -1;
-	int MinR = 100000;
-	int BestPL = -1;
-	for ( int i = 0; i < NCost; i++ )
-	{
-		int R = Norma( x - COSTPL[i].xw, y - COSTPL[i].yw );
-		if ( R > 20 && R < MinR&&COSTPL[i].Access&&COSTPL[i].Island == Isl&&COSTPL[i].Transport == 0xFFFF )
-		{
-			MinR = R;
-			BestPL = i;
-		};
-	};
-	return BestPL;
+	return NP_FindCoast( x, y, 20, -1, Isl, &FreeCost, NULL );
 };
+//Nearest free cost place of an island of a nation out of Mask
 int FindCostPointEx( int x, int y, byte Mask )
 {
 	if ( !NCost )return -1;
-	int MinR = 100000;
-	int BestPL = -1;
 	byte ISLSET[32];
 	memset( ISLSET, 0, 32 );
 	for ( int i = 0; i < 8; i++ )if ( !( NATIONS[i].NMask&Mask ) )
@@ -5436,23 +5454,68 @@ int FindCostPointEx( int x, int y, byte Mask )
 			ISLSET[isl >> 3] |= 1 << ( isl & 7 );
 		};
 	};
-	for ( int i = 0; i < NCost; i++ )
-	{
-		int R = Norma( x - COSTPL[i].xw, y - COSTPL[i].yw );
-		if ( R > 20 && R < MinR&&COSTPL[i].Access&&COSTPL[i].Transport == 0xFFFF )
-		{
-			int ISL = COSTPL[i].Island;
-			if ( ISLSET[ISL >> 3] & ( 1 << ( ISL & 7 ) ) )
-			{
-				MinR = R;
-				BestPL = i;
+	return NP_FindCoast( x, y, 20, -1, -1, &CostOfIslands, ISLSET );
+};
+void LeaveAll( OneObject* OB );
+void ArmyMakeBattleLink( AI_Army* ARM );
+//brigade types that go to the ships, the first ones first
+//0-Light infantry(short range)
+//1-infantry(strelok)
+//2-fasthorce
+//3-hardhorce
+//4-horse-strelok
+//5-mortira&pushka
+//6-grenader
+//7-peasant
+//8-weak units
+//9-supermortira
+static const byte DesantTypes[7] = { 2, 3, 5, 0, 1, 4, 6 };
+//The next unit of the battle armies of the city for the loading ship, if
+//more than MaxInMy units are in them. The first brigade of the first type
+//of DesantTypes gives it: one pass puts the brigades in NP_Assign with the
+//type as the priority, and the one ship without a key takes the first.
+static OneObject* PickDesantUnit( City* CT, OneObject* TRANS, int MaxInMy )
+{
+	static std::vector<NP_Group> Groups;
+	static std::vector<OneObject*> Units;
+	static std::vector<int> Ship;
+	Groups.clear();
+	Units.clear();
+	int NAR = 0;
+	for ( int i = 0; i < MaxArm; i++ )
+	{
+		AI_Army* AR = CT->ARMS + i;
+		if ( AR->Enabled&&AR->AOrder&&AR->AOrder->ALink == &ArmyMakeBattleLink )
+		{
+			for ( int j = 0; j < AR->NExBrigs; j++ )
+			{
+				Brigade* BRG = AR->ExBrigs[j].Brig;
+				NAR += BRG->NMemb;
+				int p = 0;
+				while ( p < 7 && DesantTypes[p] != AR->ExBrigs[j].BrigadeType )p++;
+				if ( p < 7 && BRG->NMemb && BRG->Memb[0] != 0xFFFF )
+				{
+					OneObject* OB = Group[BRG->Memb[0]];
+					if ( OB&&OB->Serial == BRG->MembSN[0] )
+					{
+						NP_Group G = { OB->RealX >> 4, OB->RealY >> 4, -1, p };
+						Groups.push_back( G );
+						Units.push_back( OB );
+					};
+				};
 			};
 		};
 	};
-	return BestPL;
+	if ( NAR <= MaxInMy || Groups.empty() )return NULL;
+	NP_Ship S = { TRANS->DstX >> 4, TRANS->DstY >> 4, -1 };
+	Ship.resize( Groups.size() );
+	NP_Assign( &S, 1, Groups.data(), int( Groups.size() ), 1, Ship.data() );
+	for ( int g = 0; g < int( Groups.size() ); g++ )
+	{
+		if ( Ship[g] == 0 )return Units[g];
+	};
+	return NULL;
 };
-void LeaveAll( OneObject* OB );
-void ArmyMakeBattleLink( AI_Army* ARM );
 void MakeDiversionLink( Brigade* BR )
 {
 	if ( PeaceTimeLeft )return;
@@ -5493,88 +5556,7 @@ void MakeDiversionLink( Brigade* BR )
 				{
 					if ( CurTrans == TRANS )
 					{
-						int NAR = 0;
-						for ( int i = 0; i < MaxArm; i++ )
-						{
-							AI_Army* AR = CT->ARMS + i;
-							if ( AR->Enabled&&AR->AOrder&&AR->AOrder->ALink == &ArmyMakeBattleLink )
-							{
-								for ( int j = 0; j < AR->NExBrigs; j++ )
-								{
-									Brigade* BRG = AR->ExBrigs[j].Brig;
-									NAR += BRG->NMemb;
-								};
-							};
-						};
-						OneObject* UNI = NULL;
-						byte Unitype = 2;
-						if ( NAR > MaxInMy )
-						{
-							do
-							{
-								for ( int i = 0; i < MaxArm; i++ )
-								{
-									AI_Army* AR = CT->ARMS + i;
-									if ( AR->Enabled&&AR->AOrder&&AR->AOrder->ALink == &ArmyMakeBattleLink )
-									{
-										for ( int j = 0; j < AR->NExBrigs; j++ )
-										{
-											if ( AR->ExBrigs[j].BrigadeType == Unitype )
-											{
-												Brigade* BRG = AR->ExBrigs[j].Brig;
-												if ( BRG->NMemb )
-												{
-													if ( BRG->Memb[0] != 0xFFFF )
-													{
-														OneObject* OB = Group[BRG->Memb[0]];
-														if ( OB&&OB->Serial == BRG->MembSN[0] )
-														{
-															UNI = OB;
-															goto UNIFOUND;
-														};
-													};
-												};
-											};
-										};
-									};
-								};
-								//0-Light infantry(short range)
-								//1-infantry(strelok)
-								//2-fasthorce
-								//3-hardhorce
-								//4-horse-strelok
-								//5-mortira&pushka
-								//6-grenader
-								//7-peasant
-								//8-weak units
-								//9-supermortira
-								switch ( Unitype )
-								{
-								case 2:
-									Unitype = 3;
-									break;
-								case 3:
-									Unitype = 5;
-									break;
-								case 5:
-									Unitype = 0;
-									break;
-								case 0:
-									Unitype = 1;
-									break;
-								case 1:
-									Unitype = 4;
-									break;
-								case 4:
-									Unitype = 6;
-									break;
-								case 6:
-									Unitype = 0xFF;
-									break;
-								};
-							} while ( Unitype != 0xFF );
-						};
-					UNIFOUND:
+						OneObject* UNI = PickDesantUnit( CT, TRANS, MaxInMy );
 						if ( UNI )
 						{
 							CT->UnRegisterNewUnit( UNI );
@@ -101,11 +101,11 @@ void MoveAwayShipInCell( int cell, int x, int y )
 	cell += VAL_MAXCX + 1;
 	int NMon = MCount[cell];
 	if ( !NMon )return;
-	int ofs1 = cell << SHFCELL;
+	word* CUnits = CB_CellUnits( cell );
 	word MID;
 	for ( int i = 0; i < NMon; i++ )
 	{
-		MID = GetNMSL( ofs1 + i );
+		MID = CUnits[i];
 		if ( MID != 0xFFFF )
 		{
 			OneObject* OB = Group[MID];
@@ -602,6 +602,7 @@ void GotoFinePositionLink( OneObject* OB )
 		int yy0 = yy;
 		FindUnitPosition( &xx, &yy, OB->newMons );
 		OB->Sdoxlo = 0;
+		StoreObjHot( OB );
 		if ( xx == xx0&&yy == yy0 )
 		{
 			OB->DeleteLastOrder();
@@ -31,21 +31,21 @@
 #include "Safety.h"
 #include "3DGraph.h"
 #include "Nature.h"
-int NDOBJ;
-word DOBJ[512];
-word DOBJSN[512];
-int DOBJLastTime = 0;
-extern int DangLx;
-extern int DangSH;
-byte* DANGMAP;
-word* DCHTIME;
+#include "NewCode/DangerField.h"
+//The dangerous objects of every nation stamp their reach into the maps of
+//NewCode/DangerField.h, see CheckDOBJS
+int DOBJLastTime = -1;
+extern int tmtmt;
+extern byte WeaponFlags[32];
+int Norma(int, int);
+static int DangHeight(int x, int y) {
+	return GetHeight(x, y) + 32;
+};
 void InitDANGER() {
-	NDOBJ = 0;
-	DOBJLastTime = 0;
-	memset(DOBJ, 0, sizeof DOBJ);
-	memset(DOBJSN, 0, sizeof DOBJSN);
-	memset(DANGMAP, 0, sizeof DANGMAP);
-	memset(DCHTIME, 0, sizeof DCHTIME);
+	DOBJLastTime = -1;
+	DF_SetNorm(&Norma);
+	DF_SetHeight(&DangHeight);
+	DF_Clear();
 };
 byte OBJDANG[48] = { 0,0,0,0,0,0,0,0, 0,1,1,0,0,0,6,0,
 				   0,0,0,0,0,0,0,0, 0,3,0,2,1,0,1,0,
@@ -53,50 +53,65 @@ byte OBJDANG[48] = { 0,0,0,0,0,0,0,0, 0,1,1,0,0,0,6,0,
 byte OBJDTYPE[48] = { 0,0,0,0,0,0,0,0, 0,0,0,0,0,0,2,0,
 				   0,0,0,0,0,0,0,0, 0,2,0,1,1,0,1,0,
 				   0,0,0,0,0,0,0,0, 0,0,0,0,0,0,0,0 };
-extern int tmtmt;
-int CheckDamageAbility(OneObject* OB, int x, int y, int z, byte Nation, int Soft);
+//Call after an object is created or changes its nation
+void AddDangerObject(word Index) {
+	OneObject* OB = Group[Index];
+	if (OB && !OB->Sdoxlo && OBJDANG[OB->newMons->Usage])DF_Add(Index);
+};
+//Call when Group[Index] is cleared
+void DelDangerObject(word Index) {
+	DF_Del(Index);
+};
+//The reach test of CheckDamageAbility(OB,x,y,z,Nation,Soft) without PredictShot,
+//with the Soft the old scan used
+static void GetDangerReach(OneObject* OB, DF_Reach* R) {
+	NewMonster* NMN = OB->newMons;
+	AdvCharacter* ADC = OB->Ref.General->MoreCharacter;
+	int USE = NMN->Usage;
+	int w = OBJDTYPE[USE];
+	int Soft = 1 + (OB->Selected ? w : 0);
+	int DRMAX = 0;
+	if (Soft == 3)DRMAX = 280;
+	bool NWATER = !OB->LockType;
+	R->x = OB->RealX >> 4;
+	R->y = OB->RealY >> 4;
+	R->z = OB->RZ + NMN->SrcZPoint;
+	R->Nat = OB->NNUM;
+	R->Dam = OBJDANG[USE];
+	R->Water = w != 0;
+	R->Pad = 48;
+	for (int i = 0; i < NAttTypes; i++) {
+		R->Kind[i] = NMN->DamWeap[i] ? DFW_SHOOTS : 0;
+		R->R1[i] = ADC->AttackRadius1[i];
+		R->R2[i] = ADC->AttackRadius2[i];
+		if (NWATER&&WeaponFlags[NMN->WeaponKind[i]] & 1)R->Kind[i] |= DFW_ARC;
+		else if (R->R2[i])R->R2[i] += DRMAX;
+	};
+};
+//Once per tick: every dangerous object that moved or changed is stamped again
 void CheckDOBJS() {
-	if (tmtmt - DOBJLastTime > 256 + (rando() & 63)) {
-		NDOBJ = 0;
-		for (int i = 0; i < MAXOBJECT&&NDOBJ < 511; i++) {
-			OneObject* OB = Group[i];
-			if (OB&&OB->NNUM == 0 && !OB->Sdoxlo) {
-				byte USE = OB->newMons->Usage;
-				if (OBJDANG[USE]) {
-					DOBJ[NDOBJ] = OB->Index;
-					DOBJSN[NDOBJ] = OB->Serial;
-					NDOBJ++;
-				};
-			};
+	if (tmtmt == DOBJLastTime)return;
+	DOBJLastTime = tmtmt;
+	for (int k = DF_Count() - 1; k >= 0; k--) {
+		int i = DF_Index(k);
+		OneObject* OB = Group[i];
+		if (!OB || OB->Sdoxlo || !OBJDANG[OB->newMons->Usage]) {
+			DF_Del(i);
+			continue;
 		};
-		DOBJLastTime = tmtmt;
+		DF_Reach R;
+		GetDangerReach(OB, &R);
+		DF_Set(i, &R);
 	};
 };
+//Danger of the objects of nation 0 on the cell (x,y) of DangLx cells:
+//their damage and 128 if a ship reaches it.
+//The old DANGMAP kept a cell for 256..383 ticks and the list of the
+//objects for 256..319 ticks, and drew rando() for both. The maps are
+//current on every tick, draw nothing and cap the damage at 127 where
+//the old sum ran into the ship bit, so the AI decides on other values
+//and records of dwVersion 101 do not play.
 byte GetDangValue(int x, int y) {
 	CheckDOBJS();
-	int ofs = x + (y << DangSH);
-	word tm = word(tmtmt);
-	if (tm - DCHTIME[ofs] > 255) {
-		int xx = (x << 7) + 64;
-		int yy = (y << 7) + 64;
-		int zz = GetHeight(xx, yy) + 32;
-		int dam = 0;
-		int wat = 0;
-		DCHTIME[ofs] = tm - (rando() & 127);
-		for (int i = 0; i < NDOBJ; i++) {
-			OneObject* OB = Group[DOBJ[i]];
-			if (OB&&OB->Serial == DOBJSN[i]) {
-				int USE = OB->newMons->Usage;
-				int w = OBJDTYPE[USE];
-				int w1 = w;
-				if (!OB->Selected)w1 = 0;
-				if (CheckDamageAbility(OB, xx, yy, zz, OB->NNUM, 1 + w1) >= 0) {
-					if (w)wat = 128;
-					dam += OBJDANG[USE];
-				};
-			};
-		};
-		return DANGMAP[ofs] = dam | wat;
-	};
-	return DANGMAP[ofs];
+	return DF_Get(x, y, 0);
 };
@@ -1,3 +1,5 @@
 void InitDANGER();
 void CheckDOBJS();
-byte GetDangValue(int x,int y);
\ No newline at end of file
+byte GetDangValue(int x,int y);
+void AddDangerObject(word Index);
+void DelDangerObject(word Index);
@@ -52,6 +52,8 @@ double screen_ratio;
 #include "NewAI.h"
 #include "Danger.h"
 #include "GP_Draw.h"
+#include "NewCode/GP_Bands.h"
+#include "NewCode/FrameBench.h"
 #include "Sort.h"
 #include "Recorder.h"
 #include "MPlayer.h"
@@ -99,8 +101,10 @@ const unsigned int kPostDrawInterval = 16;//~60 Hz
 //Time of the last PostDrawGameProcess() return
 unsigned long prev_postdraw_time = 0;
 
-//Game version. Must match with other clients
-__declspec( dllexport ) word dwVersion = 100;
+//Game version. Must match with other clients and the records played.
+//101: the victim search draws no random cells
+//102: GetDangValue reads the danger maps, see Danger.cpp
+__declspec( dllexport ) word dwVersion = 102;
 __declspec( dllexport ) char LobbyVersion[32] = "1.00";
 __declspec( dllexport ) char BuildVersion[32] = "V 1.00";
 
@@ -1932,6 +1936,9 @@ extern bool Lpressed;
 
 void FilesExit();
 
+//Render benchmark (/bench): no window (null backend), no frame limit
+static bool bench_mode = false;
+
 //Register winapi window class, init DirectDraw, sounds and cursor
 //Initialize raylib window system and game
 static BOOL doInit( HINSTANCE hInstance, int nCmdShow )
@@ -1942,9 +1949,10 @@ static BOOL doInit( HINSTANCE hInstance, int nCmdShow )
 	config.height = window_mode ? RealLy : screen_height;
 	config.title = TITLE;
 	config.fullscreen = !window_mode;
-	config.vsync = true;
+	config.vsync = !bench_mode;
 	config.resizable = window_mode;
-	config.target_fps = 60;
+	config.target_fps = bench_mode ? 0 : 60;
+	config.headless = bench_mode;
 
 	// Initialize raylib window system
 	if (!InitRaylibWindow(&config))
@@ -2026,6 +2034,7 @@ static BOOL doInit( HINSTANCE hInstance, int nCmdShow )
 
 void AddDestn( byte x, byte y );
 void ProcessNewMonsters();
+void ProcessPaths();
 void InitXShift();
 void HandleMines();
 void ControlGates();
@@ -2245,6 +2254,7 @@ void PreDrawGameProcess()
 							if (OB)
 							{
 								OB->Sdoxlo = 2500;
+								StoreObjHot( OB );
 							}
 						}
 					}
@@ -2375,6 +2385,7 @@ void PreDrawGameProcess()
 
 
 		ProcessNewMonsters();
+		ProcessPaths();
 
 		ObjTimer.Handle();
 	}
@@ -2390,6 +2401,8 @@ void PreDrawGameProcess()
 
 	//Something about area linking?
 	ProcessDynamicalTopology();
+
+	OrdPool.NewFrame();
 }
 
 bool ProcessMessages();
@@ -2950,6 +2963,12 @@ int PASCAL WinMain(
 		window_style = WS_POPUP;
 	}
 
+	if ( strstr( lpCmdLine, "/bench" ) )
+	{
+		bench_mode = true;
+		window_mode = true;
+	}
+
 	//Init DirectDraw and find possible resolutions
 	EnumModesOnly();
 
@@ -3035,6 +3054,51 @@ int PASCAL WinMain(
 		Gscanf( rec_settings_file, "%d%s", &RecordMode, &RECFILE );
 		Gclose( rec_settings_file );
 	}
+	//Optional sprite cash settings: budget in MB, 1 to save gpcash.log on exit,
+	//1 to unpack whole GP files into atlases at load time,
+	//number of row bands for the Z-buffer drawing (0 - auto, 1 - serial)
+	int cash_stats_log = 0;
+	GFILE *cash_settings_file = Gopen( "gpcash.dat", "rt" );
+	if (cash_settings_file)
+	{
+		int cash_budget = 0;
+		int cash_atlas = 0;
+		Gscanf( cash_settings_file, "%d%d%d%d", &cash_budget, &cash_stats_log, &cash_atlas, &GPB_NBands );
+		Gclose( cash_settings_file );
+		GPS.UseAtlas = cash_atlas != 0;
+		if (cash_budget > 0)
+		{
+			GPS.SetCashBudget( cash_budget << 20 );
+		}
+	}
+	//Render benchmark settings: save file, number of frames, dump every n-th
+	//frame into benchNNNN.bmp (0 - no dumps), number of camera waypoints
+	//followed by their mapx mapy. The results go to bench.log.
+	if (bench_mode)
+	{
+		GFILE *bench_file = Gopen( "bench.dat", "rt" );
+		if (bench_file)
+		{
+			char bench_save[256];
+			int bench_frames = 0;
+			int bench_dump = 0;
+			int bench_points = 0;
+			if (Gscanf( bench_file, "%s%d%d%d", bench_save, &bench_frames, &bench_dump, &bench_points ) == 4)
+			{
+				FB_Setup( bench_save, bench_frames, bench_dump );
+				for (int i = 0; i < bench_points; i++)
+				{
+					int x, y;
+					if (Gscanf( bench_file, "%d%d", &x, &y ) != 2)
+					{
+						break;
+					}
+					FB_AddWaypoint( x, y );
+				}
+			}
+			Gclose( bench_file );
+		}
+	}
 
 	//Look if loaded values match possible screen resolutions
 	bool ExMode = 0;
@@ -3220,10 +3284,22 @@ int PASCAL WinMain(
 				Gprintf( rec_settings_file, "%d %s", RecordMode, RECFILE );
 				Gclose( rec_settings_file );
 			}
+			if (cash_stats_log)
+			{
+				GPS.SaveCashStats( "gpcash.log" );
+			}
+			if (bench_mode)
+			{
+				FB_SaveReport( "bench.log" );
+			}
 
 			FilesExit();
 			StopPlayCD();
 			FinExplorer();
+			if (bench_mode)
+			{
+				break;
+			}
 		}
 	}
 	
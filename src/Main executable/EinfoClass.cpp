@@ -27,6 +27,7 @@
 #include "Sort.h"
 #include "ConstStr.h"
 #include "EinfoClass.h"
+#include "NewCode/ObjIndex.h"
 extern int PeaceTimeLeft;
 extern int SafeMLx;
 extern int SafeMSH;
@@ -159,7 +160,7 @@ bool GlobalEnemyInfo::FindNearestEnemy(byte NNUM, int* x, int* y, bool TowerFear
 		int by = 0;
 		int bdis = 0xFFFF;
 		int TIND = MyTop*NAreas;
-		for (int i = 0; i < MAXOBJECT; i++) {
+		for (int i = OI_Next(0); i < MAXOBJECT; i = OI_Next(i + 1)) {
 			OneObject* OB = Group[i];
 			if (OB && (!(OB->NMask&ms)) && !OB->Sdoxlo) {
 				NewMonster* NM = OB->newMons;
@@ -223,7 +224,7 @@ void EnemyInfo::CreateListOfDangerObjects() {
 	NDINF = 0;
 	byte msk = Mask;
 	DangerInfo* DF = DINF;
-	for (int MID = 0; MID < MAXOBJECT; MID++) {
+	for (int MID = OI_Next(0); MID < MAXOBJECT; MID = OI_Next(MID + 1)) {
 		OneObject* OB = Group[MID];
 		if (OB&&OB->Ready && !(OB->Sdoxlo || OB->NMask&msk)) {
 			if (OB->newMons->Usage == TowerID) {
@@ -492,7 +493,7 @@ word EnemyInfo::SearchBestEnemyAndPlaceForSupermortira(OneObject* OB, int* BestX
 void EnemyInfo::CreateEnmBuildList() {
 	NEnmBuild = 0;
 	byte msk = Mask;
-	for (int MID = 0; MID < MAXOBJECT&&NEnmBuild < 128; MID++) {
+	for (int MID = OI_Next(0, OIL_BUILDINGS); MID < MAXOBJECT&&NEnmBuild < 128; MID = OI_Next(MID + 1, OIL_BUILDINGS)) {
 		OneObject* OB = Group[MID];
 		if (OB && (!(OB->NMask&msk)) && OB->NewBuilding && !OB->Wall) {
 			NewMonster* NM = OB->newMons;
@@ -507,7 +508,7 @@ void EnemyInfo::CreateEnmBuildList() {
 void EnemyInfo::CreateProtectionMap() {
 	byte MASK = 0xFE;
 	memset(ProtectionMap, 0, MAXCIOFS);
-	for (int i = 0; i < MAXOBJECT; i++) {
+	for (int i = OI_Next(0); i < MAXOBJECT; i = OI_Next(i + 1)) {
 		OneObject* OB = Group[i];
 		if (OB&&OB->NMask&MASK && !(OB->Sdoxlo || OB->NewBuilding || OB->newMons->Capture || OB->newMons->Behavior == 2)) {
 			int cell = (OB->RealX >> 11) + (((OB->RealY) >> 11) << VAL_SHFCX);
@@ -778,7 +779,7 @@ void EnemyInfo::InitBuildSafety() {
 void EnemyInfo::CreateBuildSafetyMap() {
 	memset(SafeMAP, 0, SafeMLx*SafeMLx);
 	byte msk = Mask;
-	for (int i = 0; i < MAXOBJECT; i++) {
+	for (int i = OI_Next(0); i < MAXOBJECT; i = OI_Next(i + 1)) {
 		OneObject* OB = Group[i];
 		if (OB && (!(OB->Sdoxlo || OB->NMask&msk || OB->Wall))) {
 			int x = OB->RealX >> (4 + 10);
@@ -1045,7 +1046,7 @@ void EnemyInfo::ResearchHumanAttackPlaces() {
 	byte MASK = Mask;
 	memset(TMAP, 0, TSX*TSX);
 	memset(NUN, 0, TSX*TSX);
-	for (int MID = 0; MID < MAXOBJECT; MID++) {
+	for (int MID = OI_Next(0); MID < MAXOBJECT; MID = OI_Next(MID + 1)) {
 		OneObject* OB = Group[MID];
 		if (OB && (!(OB->Sdoxlo || OB->NewBuilding || OB->Wall || OB->LockType || OB->NMask&MASK))) {
 			int ofs = (OB->RealX >> TSSHIFT) + ((OB->RealY >> TSSHIFT) << TSH);
@@ -1056,7 +1057,7 @@ void EnemyInfo::ResearchHumanAttackPlaces() {
 		};
 	};
 
-	for (int MID = 0; MID < MAXOBJECT; MID++) {
+	for (int MID = OI_Next(0, OIL_BUILDINGS); MID < MAXOBJECT; MID = OI_Next(MID + 1, OIL_BUILDINGS)) {
 		OneObject* OB = Group[MID];
 		if (OB&&OB->NewBuilding && !(OB->Sdoxlo || OB->NMask&MASK)) {
 			byte USE = OB->newMons->Usage;
@@ -1148,7 +1149,7 @@ void EnemyInfo::RegisterHumanShips() {
 	if (TopAreasDanger) {
 		memset(TopAreasDanger, 0, WNAreas * 2);
 	};
-	for (int MID = 0; MID < MAXOBJECT&&NHSHIPS < 128; MID++) {
+	for (int MID = OI_Next(0); MID < MAXOBJECT&&NHSHIPS < 128; MID = OI_Next(MID + 1)) {
 		OneObject* OB = Group[MID];
 		if (OB && (!OB->Sdoxlo) && (!(OB->NMask&Mask)) && OB->LockType) {
 			byte Usage = OB->newMons->Usage;
@@ -1179,7 +1180,7 @@ int EnemyInfo::GetMaxForceOnTheWay(int TopStart, int FinalTop) {
 	if (!WNAreas)return 0;
 	int MaxF = 0;
 	while (TopStart != FinalTop) {
-		int NextTop = WMotionLinks[FinalTop + TopStart*WNAreas];
+		int NextTop = GetNextTop(1, TopStart, FinalTop);
 		if (NextTop == 0xFFFF)return 0;
 		int F = TopAreasDanger[NextTop];
 		if (F > MaxF)MaxF = F;
@@ -8,13 +8,19 @@
 #include <CrtDbg.h>
 #include "CTables.h"
 #include "GP_Draw.h"
+#include "NewCode/GP_Blit.h"
+#include "NewCode/GP_Unpack.h"
+#include "NewCode/GP_Cache.h"
+#include "NewCode/GP_Bands.h"
+#include "NewCode/GP_Atlas.h"
+#include <algorithm>
+#include <vector>
 #include "mapdiscr.h"
 #include "RealWater.h"
 #include <math.h>
 #include "ActiveScenary.h"
 #include "GSINC.h"
 bool NewGPImage;
-#define INTV(x) (((int*)(x))[0])
 
 //What are you?
 extern int XShift[512];
@@ -27,16 +33,9 @@ int LOADED = 0;
 
 extern int COUNTER;
 typedef short* lpShort;
-typedef DWORD* lpDWORD;
 GP_System::GP_System()
 {
-	CashSize = 4200000;
-	PackCash = new byte[CashSize + 4];
-	PackCash[CashSize] = 0x37;
-	PackCash[CashSize + 1] = 0x42;
-	INTV( PackCash ) = 0;
-	INTV( PackCash + 4 ) = CashSize;
-	CashPos = 0;
+	Cash = new GP_Cache;
 	NGP = 0;
 	NGPReady = MaxGPIdx;
 	GPH = new lpGP_GlobalHeader[NGPReady];
@@ -60,18 +59,27 @@ GP_System::GP_System()
 	memset( ImLy, 0, 4 * NGPReady );
 	memset( ItDX, 0, 4 * NGPReady );
 	memset( ItLX, 0, 4 * NGPReady );
-	CASHREF = new lpDWORD[NGPReady];
+	CASHREF = new size_t*[NGPReady];
 	Mapping = new byte[NGPReady];
-	memset( CASHREF, 0, NGPReady << 2 );
+	memset( CASHREF, 0, NGPReady * sizeof( size_t* ) );
 	memset( Mapping, 0, NGPReady );
+	UseAtlas = false;
+	Atlas = new GPA_Atlas*[NGPReady];
+	AtlasSlots = new byte*[NGPReady];
+	AtlasSize = new int[NGPReady];
+	memset( Atlas, 0, NGPReady * sizeof( GPA_Atlas* ) );
+	memset( AtlasSlots, 0, NGPReady * sizeof( byte* ) );
+	memset( AtlasSize, 0, NGPReady * sizeof( int ) );
 	//PreLoadGPImage("gets2");
 	memset( GP_L_IDXS, 0, sizeof GP_L_IDXS );
+	GPB_Init();
 };
 GP_System::~GP_System()
 {
-	free( PackCash );
+	delete Cash;
 	for (int i = 0; i < NGP; i++)
 	{
+		FreeAtlas( i );
 		if (GPH[i] && !Mapping[i])free( GPH[i] );
 		if (RLCImage[i])free( RLCImage[i] );
 		if (RLCShadow[i])free( RLCShadow[i] );
@@ -85,6 +93,9 @@ GP_System::~GP_System()
 	free( GPNFrames );
 	free( ImageType );
 	free( CASHREF );
+	free( Atlas );
+	free( AtlasSlots );
+	free( AtlasSize );
 	free( Mapping );
 	free( UNITBL );
 };
@@ -141,61 +152,360 @@ bool GP_System::GetGPSize( int i, int n, int* Lx, int* Ly )
 	}
 	else return false;
 };
-byte* GP_System::GetCash( int Size )
+byte* GP_System::GetCash( int Size, size_t* Ref, int FileIndex )
 {
-	int UsedSize = -8;
-	int NSeg = 0;
-	int tpos = CashPos;
-	int cas = CashSize;
-	//COUNTER=div(CashPos*100,CashSize).quot;
-	byte* Cash = PackCash;
-	//assert(Cash[CashSize]==0x37&&Cash[CashSize+1]==0x42);
-	while (tpos < cas&&UsedSize < Size)
+	return Cash->Alloc( Ref, Size, FileIndex, false );
+}
+
+void GP_System::SetCashBudget( int Bytes )
+{
+	Cash->SetBudget( Bytes );
+}
+
+void GP_System::SaveCashStats( char* Name )
+{
+	FILE* F = fopen( Name, "w" );
+	if (!F)
 	{
-		int sz = INTV( Cash + tpos + 4 );
-		UsedSize += sz;
-		tpos += sz;
-		NSeg++;
-	};
-	if (UsedSize < Size)
+		return;
+	}
+	int AtlasTotal = 0;
+	for (int i = 0; i < NGP; i++)
+	{
+		AtlasTotal += AtlasSize[i];
+	}
+	fprintf( F, "budget %d used %d blocks %d atlas %d\n", int( Cash->GetBudget() ), int( Cash->GetUsed() ), Cash->GetNBlocks(), AtlasTotal );
+	fprintf( F, "file hits misses evictions decoded\n" );
+	int N = Cash->GetNStats();
+	if (N > NGP)
+	{
+		N = NGP;
+	}
+	for (int i = 0; i < N; i++)
 	{
-		tpos = 0;
-		UsedSize = -8;
-		NSeg = 0;
-		CashPos = 0;
-		while (UsedSize < Size)
+		GP_CacheStats* S = Cash->GetStats( i );
+		if (S->Hits || S->Misses)
 		{
-			int sz = INTV( Cash + tpos + 4 );
-			UsedSize += sz;
-			tpos += sz;
-			NSeg++;
-		};
-	};
-	//free refs
-	tpos = CashPos;
-	for (int i = 0; i < NSeg; i++)
+			fprintf( F, "%s %d %d %d %.0f\n", GPNames[i], S->Hits, S->Misses, S->Evictions, double( S->BytesDecoded ) );
+		}
+	}
+	for (int i = 0; i < NGP; i++)
 	{
-		int sz = INTV( Cash + tpos + 4 );
-		int* ptr = (int*) INTV( Cash + tpos );
-		if (ptr)
+		if (Atlas[i])
 		{
-			ptr[0] = 0xFFFFFFFF;
-			INTV( Cash + tpos ) = NULL;
-		};
-		tpos += sz;
-	};
-	if (UsedSize - Size > 32)
+			GPA_Atlas* A = Atlas[i];
+			fprintf( F, "atlas %s %d page %dx%d pixels %d\n", GPNames[i], AtlasSize[i], A->PageLx, A->PageLy, A->NPixels );
+		}
+	}
+	fclose( F );
+}
+
+//Unpack job of one layer without the destination.
+//False for the layers that are drawn straight from the file.
+static bool GP_GetLayerJob( GP_GlobalHeader* lpGH, GP_Header* lpGPCUR, GP_UnpackJob* J, int* Size )
+{
+	byte Optx = lpGPCUR->Options;
+	int Opt = Optx & 63;
+	int Extra = 0;
+	switch (Opt)
 	{
-		INTV( Cash + CashPos + Size + 8 ) = 0;
-		INTV( Cash + CashPos + Size + 12 ) = UsedSize - Size;
-		UsedSize = Size;
-	};
-	INTV( Cash + CashPos ) = 0;
-	INTV( Cash + CashPos + 4 ) = UsedSize + 8;
-	byte* cps = Cash + CashPos;
-	CashPos += UsedSize + 8;
-	return cps;
+	case 0:
+		J->Method = GPU_STD;
+		Extra = 18;
+		break;
+	case 1:
+		J->Method = GPU_NAT;
+		break;
+	case 38:
+		J->Method = GPU_GREY;
+		break;
+	case 42:
+	case 43:
+	case 44:
+		J->Method = GPU_LZ;
+		Extra = 18;
+		break;
+	default:
+		return false;
+	}
+
+	int UnpackLen = lpGPCUR->CData >> 14;
+	int CDOffs = lpGPCUR->CData & 16383;
+	if (Opt == 43)UnpackLen += 262144;
+	if (Opt == 44)UnpackLen += 262144 * 2;
+	if (Optx & 64)CDOffs += 16384;
+	if (Optx & 128)CDOffs += 32768;
+
+	J->Dest = NULL;
+	J->Src = ( (byte*) lpGPCUR ) + CDOffs;
+	J->Voc = ( (byte*) lpGH ) + lpGH->VocOffset;
+	J->Len = UnpackLen;
+	*Size = UnpackLen + Extra;
+	return true;
+}
+
+//Batched unpack queue. The cash blocks are reserved and locked on the main
+//thread, UnpackQueued() splits the unpacking over the workers and returns
+//when all of it is done, so the frame still waits for it. The queue takes
+//at most half of the budget, so it can not push the whole view out of the
+//cash.
+#define MaxUnpackQueue 1024
+static GP_UnpackJob GP_UnpackQueue[MaxUnpackQueue];
+static int GP_NUnpackQueue = 0;
+static int GP_UnpackQueueSize = 0;
+
+void GP_System::QueueUnpackGP( int FileIndex, int SprIndex )
+{
+	if (!( FileIndex < NGP && ( SprIndex & 4095 ) < GPNFrames[FileIndex] ))
+	{
+		return;
+	}
+
+	if (( ImageType[FileIndex] & 7 ) != 1)
+	{
+		return;
+	}
+
+	if (!GPH[FileIndex])
+	{
+		LoadGP( FileIndex );
+	}
+
+	GP_GlobalHeader* lpGH = GPH[FileIndex];
+	if (!lpGH)
+	{
+		return;
+	}
+
+	int RSprIndex = SprIndex & 4095;
+	GP_Header* lpGP = GPX( lpGH, LGPH[RSprIndex] );
+	GP_Header* lpGPCUR = lpGP;
+	size_t* PAK = CASHREF[FileIndex];
+	PAK += PAK[RSprIndex];
+
+	int DIFF;
+	do
+	{
+		GP_UnpackJob* J = GP_UnpackQueue + GP_NUnpackQueue;
+		int Need;
+		if (GP_NUnpackQueue < MaxUnpackQueue && (byte*) ( *PAK ) == NO_PACK && GP_GetLayerJob( lpGH, lpGPCUR, J, &Need ))
+		{
+			if (GP_UnpackQueueSize + Need > int( Cash->GetBudget() >> 1 ))
+			{
+				return;
+			}
+
+			//locked until UnpackQueued() has unpacked it
+			J->Dest = Cash->Alloc( PAK, Need, FileIndex, true );
+			GP_NUnpackQueue++;
+			GP_UnpackQueueSize += Need;
+		}
+
+		DIFF = lpGPCUR->NextPict;
+		lpGPCUR = (GP_Header*) ( ( (byte*) lpGP ) + DIFF );
+		PAK++;
+	} while (DIFF != -1);
+}
+
+void GP_System::UnpackQueued()
+{
+	GP_UnpackBatch( GP_UnpackQueue, GP_NUnpackQueue );
+	for (int i = 0; i < GP_NUnpackQueue; i++)
+	{
+		Cash->Unlock( GP_UnpackQueue[i].Dest );
+	}
+	GP_NUnpackQueue = 0;
+	GP_UnpackQueueSize = 0;
+}
+
+void GP_System::BeginBands()
+{
+	//blocks evicted while commands are recorded are freed after the flush
+	Cash->Hold( true );
+	GPB_BeginBands();
+}
+
+void GP_System::EndBands()
+{
+	GPB_EndBands();
+	Cash->Hold( false );
+}
+
+//Layer slots of the atlases: 16 bytes of the cash block header, then the
+//frame. Sorted by address, GP_ShowMasked() looks its data up here.
+#define GP_SLOT_SIZE 32
+//Width of the atlas pages
+#define GP_ATLAS_LX 1024
+struct GP_AtlasSlots
+{
+	byte* Lo;
+	byte* Hi;
 };
+static std::vector<GP_AtlasSlots> GP_Slots;
+
+static const GPA_Frame* GP_FindAtlasFrame( const byte* CData )
+{
+	if (GP_Slots.empty() || !CData)
+	{
+		return nullptr;
+	}
+	auto it = std::upper_bound( GP_Slots.begin(), GP_Slots.end(), CData,
+		[]( const byte* p, const GP_AtlasSlots& R ) { return p < R.Lo; } );
+	if (it == GP_Slots.begin())
+	{
+		return nullptr;
+	}
+	--it;
+	if (CData >= it->Hi)
+	{
+		return nullptr;
+	}
+	return *(const GPA_Frame**) CData;
+}
+
+bool GP_System::BuildAtlas( int i )
+{
+	GP_GlobalHeader* lpGH = GPH[i];
+	if (!lpGH || Atlas[i])
+	{
+		return false;
+	}
+
+	int np = lpGH->NPictures;
+	GP_UnpackJob J;
+	int Need;
+
+	int NJobs = 0;
+	int Size = 0;
+	for (int n = 0; n < np; n++)
+	{
+		GP_Header* lpGP = GPX( lpGH, LGPH[n] );
+		GP_Header* lpGPCUR = lpGP;
+		int DIFF;
+		do
+		{
+			if (GP_GetLayerJob( lpGH, lpGPCUR, &J, &Need ))
+			{
+				NJobs++;
+				Size += ( Need + 15 ) & ~15;
+			}
+			DIFF = lpGPCUR->NextPict;
+			lpGPCUR = (GP_Header*) ( ( (byte*) lpGP ) + DIFF );
+		} while (DIFF != -1);
+	}
+
+	if (!NJobs)
+	{
+		return false;
+	}
+
+	//the layers are unpacked once, packed and the unpacked data dropped
+	byte* Buf = (byte*) malloc( Size );
+	GP_UnpackJob* Jobs = (GP_UnpackJob*) malloc( NJobs * sizeof( GP_UnpackJob ) );
+	GP_BlitSprite* Layers = (GP_BlitSprite*) malloc( NJobs * sizeof( GP_BlitSprite ) );
+	size_t** Refs = (size_t**) malloc( NJobs * sizeof( size_t* ) );
+	NJobs = 0;
+	int Pos = 0;
+	for (int n = 0; n < np; n++)
+	{
+		GP_Header* lpGP = GPX( lpGH, LGPH[n] );
+		GP_Header* lpGPCUR = lpGP;
+		size_t* PAK = CASHREF[i];
+		PAK += PAK[n];
+		int DIFF;
+		do
+		{
+			if (GP_GetLayerJob( lpGH, lpGPCUR, Jobs + NJobs, &Need ))
+			{
+				Jobs[NJobs].Dest = Buf + Pos;
+				GP_BlitSprite& L = Layers[NJobs];
+				L.x = 0;
+				L.y = 0;
+				L.Lx = lpGPCUR->Lx;
+				L.NLines = lpGPCUR->NLines;
+				L.Mask = (byte*) lpGPCUR + GP_HEADER_SIZE;
+				L.CData = Buf + Pos;
+				L.Frame = nullptr;
+				Refs[NJobs] = PAK;
+				NJobs++;
+				Pos += ( Need + 15 ) & ~15;
+			}
+			DIFF = lpGPCUR->NextPict;
+			lpGPCUR = (GP_Header*) ( ( (byte*) lpGP ) + DIFF );
+			PAK++;
+		} while (DIFF != -1);
+	}
+
+	GP_UnpackBatch( Jobs, NJobs );
+	GPA_Atlas* A = new GPA_Atlas;
+	GPA_Build( A, Layers, NJobs, GP_ATLAS_LX );
+	free( Jobs );
+	free( Layers );
+	free( Buf );
+
+	//the slots carry the cash block header, so Touch() knows them
+	byte* Slots = (byte*) malloc( NJobs * GP_SLOT_SIZE );
+	for (int k = 0; k < NJobs; k++)
+	{
+		byte* Data = Slots + k * GP_SLOT_SIZE + GPC_HEADER_SIZE;
+		GP_Cache::InitForeign( Data );
+		*(const GPA_Frame**) Data = A->Frames + k;
+		*Refs[k] = (size_t) Data;
+	}
+	free( Refs );
+
+	GP_AtlasSlots R;
+	R.Lo = Slots;
+	R.Hi = Slots + NJobs * GP_SLOT_SIZE;
+	GP_Slots.insert( std::upper_bound( GP_Slots.begin(), GP_Slots.end(), R,
+		[]( const GP_AtlasSlots& a, const GP_AtlasSlots& b ) { return a.Lo < b.Lo; } ), R );
+
+	Atlas[i] = A;
+	AtlasSlots[i] = Slots;
+	AtlasSize[i] = int( GPA_Bytes( A ) ) + NJobs * GP_SLOT_SIZE;
+	return true;
+}
+
+void GP_System::FreeAtlas( int i )
+{
+	if (!Atlas[i])
+	{
+		return;
+	}
+
+	GP_GlobalHeader* lpGH = GPH[i];
+	int np = lpGH->NPictures;
+	for (int n = 0; n < np; n++)
+	{
+		GP_Header* lpGP = GPX( lpGH, LGPH[n] );
+		GP_Header* lpGPCUR = lpGP;
+		size_t* PAK = CASHREF[i];
+		PAK += PAK[n];
+		int DIFF;
+		do
+		{
+			*PAK = GPC_EMPTY;
+			DIFF = lpGPCUR->NextPict;
+			lpGPCUR = (GP_Header*) ( ( (byte*) lpGP ) + DIFF );
+			PAK++;
+		} while (DIFF != -1);
+	}
+
+	for (size_t k = 0; k < GP_Slots.size(); k++)
+	{
+		if (GP_Slots[k].Lo == AtlasSlots[i])
+		{
+			GP_Slots.erase( GP_Slots.begin() + k );
+			break;
+		}
+	}
+	GPA_Free( Atlas[i] );
+	delete Atlas[i];
+	free( AtlasSlots[i] );
+	Atlas[i] = NULL;
+	AtlasSlots[i] = NULL;
+	AtlasSize[i] = 0;
+}
 
 int GP_System::PreLoadGPImage( char* Name, bool Shadow )
 {
@@ -576,9 +886,9 @@ bool GP_System::LoadGP( int i )
 					};
 				} while (DIFF != -1);
 			};
-			CASHREF[i] = new DWORD[csz + 1];
-			DWORD* CREF = CASHREF[i];
-			memset( CREF, 0xFF, ( csz + 1 ) << 2 );
+			CASHREF[i] = new size_t[csz + 1];
+			size_t* CREF = CASHREF[i];
+			memset( CREF, 0xFF, ( csz + 1 ) * sizeof( size_t ) );
 			csz = np;
 			for (int n = 0; n < np; n++)
 			{
@@ -598,6 +908,10 @@ bool GP_System::LoadGP( int i )
 					};
 				} while (DIFF != -1);
 			};
+			if (UseAtlas)
+			{
+				BuildAtlas( i );
+			}
 			return true;
 		}
 		else return false;
@@ -643,7634 +957,140 @@ bool GP_System::LoadGP( int i )
 //DWORD Pack reference offset(PRefOfs)[=NULL if not assigned]
 //DWORD Unpacked data size+8(UDataSize)
 
-//Draw units in shadows and menu effects
-void GP_ShowMaskedPict( int x, int y, GP_Header* Pic, byte* CData, byte* Encoder )
-{
-	x += Pic->dx;
-	y += Pic->dy;
-	int Lx = Pic->Lx;
-	int NLines = Pic->NLines;
-	int ofst = int( Pic ) + 23;
-
-	if (y + NLines <= WindY || x + Lx <= WindX || x > WindX1 || y > WindY1)
-	{
-		return;
-	}
+extern byte refl[3072];
 
-	//vertical clipping
-	//top clipper
-	int CDPOS = int( CData );
+//Current screen and clip window as a blit target
+static void GP_GetBlitTarget( GP_BlitTarget* T )
+{
+	T->Screen = (byte*) ScreenPtr;
+	T->Pitch = ScrWidth;
+	T->WindX = WindX;
+	T->WindY = WindY;
+	T->WindX1 = WindX1;
+	T->WindY1 = WindY1;
+	T->BandY = WindY;
+	T->BandY1 = WindY1;
+}
 
-	if (y < WindY)
-	{
-		__asm
-		{
-			mov		ecx, WindY
-			sub		ecx, y
-			sub		NLines, ecx
-			add		y, ecx
-			mov		ebx, ofst
-			xor		eax, eax
-			xor		edx, edx
-			NLINE : mov		al, [ebx]
-					test	al, 128
-					jz		SIMPLE_LINE
-					inc		ebx
-					mov		ah, al
-					and		al, 31
-					or al, al
-					jz		COMPLINE_1
-					and		ah, 32
-					shr		ah, 1
-					COMPLINE_LOOP1:
-			mov		dl, [ebx]
-				shr		dl, 4
-				or dl, ah
-				add		CDPOS, edx
-				inc		ebx
-				dec		al
-				jnz		COMPLINE_LOOP1
-				COMPLINE_1 :
-			xor		eax, eax
-				dec		ecx
-				jnz		NLINE
-				jmp		END_VCLIP
-				SIMPLE_LINE : inc		ebx
-				or eax, eax
-				jz		SIMPLINE_1
-				SIMPLINE_LOOP1 :
-			mov		dl, [ebx + 1]
-				add		CDPOS, edx
-				add		ebx, 2
-				dec		al
-				jnz		SIMPLINE_LOOP1
-				SIMPLINE_1 : dec		ecx
-				jnz		NLINE
-				END_VCLIP : mov		ofst, ebx
+//Draws one masked GP layer through the portable kernels (NewCode/GP_Blit.cpp)
+static void GP_ShowMasked( int Mode, bool Inv, int x, int y, GP_Header* Pic, byte* CData, byte* Table, int* WShift )
+{
+	GP_BlitTarget T;
+	GP_GetBlitTarget( &T );
+	GP_BlitSprite S;
+	S.x = Inv ? x - Pic->dx : x + Pic->dx;
+	S.y = y + Pic->dy;
+	S.Lx = Pic->Lx;
+	S.NLines = Pic->NLines;
+	S.Mask = (byte*) Pic + GP_HEADER_SIZE;
+	S.CData = CData;
+	S.Frame = GP_FindAtlasFrame( CData );
+	if (GPB_Recording())
+	{
+		//the water reflection writes across the rows of its lines
+		if (!WShift)
+		{
+			GPB_Record( &T, Mode, Inv, &S, Table );
+			return;
 		}
+		GPB_FlushBands();
 	}
-	//bottom clipper
-
-	if (y + NLines > WindY1)
-	{
-		NLines = WindY1 - y + 1;
-	}
+	GPB_Draw( &T, Mode, Inv, &S, Table, WShift );
+}
 
-	//horisontal clipper
-	int x1 = x + Lx - 1;
-	int scrofs = int( ScreenPtr ) + x + y*ScrWidth;
-	int TEMP1;
-	int LineStart;
-	int CLIP;
-	int CURCLIP;
-	byte SPACE_MASK;
-	byte PIX_MASK;
-
-	if (x >= WindX && x1 <= WindX1)
-	{
-		//***********************************************************//
-		//******************(((((((((((())))))))))))*****************//
-		//**                      NO CLIPPING                      **//
-		//******************(((((((((((())))))))))))*****************//
-		//***********************************************************//
-				//no clipping
-		__asm
-		{
-			pushf
-			push	esi
-			push	edi
-			//initialisation
-			mov		edi, scrofs			//edi-screen pointer
-			mov		esi, CDPOS			//esi-points array
-			mov		ebx, Encoder		//ebx-encoding pointer
-			mov		edx, ofst			//edx-mask offset
-			xor		eax, eax
-			xor		ecx, ecx
-			cld
-			sub		edi, ScrWidth
-			mov		LineStart, edi
-			START_SCANLINE :
-			mov		edi, LineStart
-				mov		al, [edx]
-				inc		edx
-				add		edi, ScrWidth
-				or al, al
-				mov		LineStart, edi
-				jnz		DRAW_LINE
-				dec		NLines
-				jnz		START_SCANLINE
-				jmp		END_DRAW_PICTURE
-				DRAW_LINE : test	al, 128
-				jnz		DRAW_COMPLEX_LINE
-				//drawing simple line
-				or al, al
-				jz		NEXT_SEGMENT
-				mov		TEMP1, eax
-				START_SIMPLE_SEGMENT :
-			mov		al, [edx]	//empty space
-				add		edi, eax
-				mov		cl, [edx + 1]
-				add		edx, 2
-				//*****************************************//
-				//put various code with encoding&loop there//
-				//*****************************************//
-				mov		al, cl
-				shr		cl, 2
-				and al, 3
-				rep		movsd
-				mov		cl, al
-				rep		movsb
-				//*****************************************//
-				//          end of variation zone          //
-				//*****************************************//
-				dec		TEMP1
-				jnz		START_SIMPLE_SEGMENT
-				NEXT_SEGMENT :
-			dec		NLines
-				jnz		START_SCANLINE
-				jmp		END_DRAW_PICTURE
-				DRAW_COMPLEX_LINE :
-			//complex packed line
-			mov		SPACE_MASK, 0
-				mov		PIX_MASK, 0
-				test	al, 64
-				jz		DCL1
-				mov		SPACE_MASK, 16
-				DCL1:		test	al, 32
-				jz		DCL2
-				mov		PIX_MASK, 16
-				DCL2 : and		al, 31
-				jz		NEXT_SEGMENT
-				mov		TEMP1, eax
-				START_COMPLEX_SEGMENT :
-			mov		al, [edx]
-				mov		cl, al
-				and		al, 15
-				or al, SPACE_MASK
-				add		edi, eax
-				shr		cl, 4
-				or cl, PIX_MASK
-				inc		edx
-				//*****************************************//
-				//put various code with encoding&loop there//
-				//*****************************************//
-				mov		al, cl
-				shr		cl, 2
-				and al, 3
-				rep		movsd
-				mov		cl, al
-				rep		movsb
-				//*****************************************//
-				//          end of variation zone          //
-				//*****************************************//
-				dec		TEMP1
-				jnz		START_COMPLEX_SEGMENT
-				dec		NLines
-				jnz		START_SCANLINE
-				END_DRAW_PICTURE :
-			//end code
-			pop		edi
-				pop		esi
-				popf
-		}
-	}
-	else
-	{
-		//image must be clipped
-		if (x < WindX)
-		{
-			//****************************************************************//
-			//****************************************************************//
-			//**                                                            **//
-			//**					clipping LEFT edge						**//
-			//**                                                            **//
-			//****************************************************************//
-			//****************************************************************//
-			CLIP = WindX - x;
-			__asm
-			{
-				pushf
-				push	esi
-				push	edi
-				//initialisation
-				mov		edi, scrofs			//edi-screen pointer
-				mov		esi, CDPOS			//esi-points array
-				mov		ebx, Encoder			//ebx-encoding pointer
-				mov		edx, ofst			//edx-mask offset
-				xor		eax, eax
-				xor		ecx, ecx
-				cld
-				sub		edi, ScrWidth
-				mov		LineStart, edi
-				CLIPLEFT_START_SCANLINE :
-				mov		edi, LineStart
-					mov		al, [edx]
-					inc		edx
-					xchg	CLIP, edx
-					add		edi, ScrWidth
-					mov		CURCLIP, edx
-					or al, al
-					xchg	CLIP, edx
-					mov		LineStart, edi
-					jnz		CLIPLEFT_DRAW_LINE
-					dec		NLines
-					jnz		CLIPLEFT_START_SCANLINE
-					jmp		CLIPLEFT_END_DRAW_PICTURE
-					CLIPLEFT_DRAW_LINE : test	al, 128
-					jnz		CLIPLEFT_DRAW_COMPLEX_LINE
-					//drawing simple line
-					or al, al
-					jz		CLIPLEFT_NEXT_SEGMENT
-					mov		TEMP1, eax
-					CLIPLEFT_START_SIMPLE_SEGMENT :
-				mov		al, [edx]	//empty space
-					add		edi, eax
-					mov		cl, [edx + 1]
-					add		edx, 2
-					sub		CURCLIP, eax
-					jle		CLIPLEFT_DRAW_SIMPLE_SEGMENT
-					cmp		CURCLIP, ecx
-					jl		CLIPLEFT_PARTIAL_SIMPLE
-					//full  clipping
-					sub		CURCLIP, ecx
-					add		esi, ecx
-					add		edi, ecx
-					dec		TEMP1
-					jnz		CLIPLEFT_START_SIMPLE_SEGMENT
-					dec		NLines
-					jnz		CLIPLEFT_START_SCANLINE
-					jmp		CLIPLEFT_END_DRAW_PICTURE
-					CLIPLEFT_PARTIAL_SIMPLE :
-				//partial clipping
-				add		esi, CURCLIP
-					add		edi, CURCLIP
-					sub		ecx, CURCLIP
-					mov		CURCLIP, -1
-					CLIPLEFT_DRAW_SIMPLE_SEGMENT :
-					//*****************************************//
-					//put various code with encoding&loop there//
-					//*****************************************//
-					mov		al, cl
-					shr		cl, 2
-					and al, 3
-					rep		movsd
-					mov		cl, al
-					rep		movsb
-					//*****************************************//
-					//          end of variation zone          //
-					//*****************************************//
-					dec		TEMP1
-					jnz		CLIPLEFT_START_SIMPLE_SEGMENT
-					CLIPLEFT_NEXT_SEGMENT :
-				dec		NLines
-					jnz		CLIPLEFT_START_SCANLINE
-					jmp		CLIPLEFT_END_DRAW_PICTURE
-					CLIPLEFT_DRAW_COMPLEX_LINE :
-				//complex packed line
-				mov		SPACE_MASK, 0
-					mov		PIX_MASK, 0
-					test	al, 64
-					jz		CLIPLEFT_DCL1
-					mov		SPACE_MASK, 16
-					CLIPLEFT_DCL1:	test	al, 32
-					jz		CLIPLEFT_DCL2
-					mov		PIX_MASK, 16
-					CLIPLEFT_DCL2 : and		al, 31
-					jz		CLIPLEFT_NEXT_SEGMENT
-					mov		TEMP1, eax
-					CLIPLEFT_START_COMPLEX_SEGMENT :
-				mov		al, [edx]
-					mov		cl, al
-					and		al, 15
-					or al, SPACE_MASK
-					add		edi, eax
-					shr		cl, 4
-					or cl, PIX_MASK
-					inc		edx
-					sub		CURCLIP, eax
-					jle		CLIPLEFT_DRAW_COMPLEX_SEGMENT
-					cmp		CURCLIP, ecx
-					jl		CLIPLEFT_PARTIAL_COMPLEX
-					//full  clipping
-					sub		CURCLIP, ecx
-					add		esi, ecx
-					add		edi, ecx
-					dec		TEMP1
-					jnz		CLIPLEFT_START_COMPLEX_SEGMENT
-					dec		NLines
-					jnz		CLIPLEFT_START_SCANLINE
-					jmp		CLIPLEFT_END_DRAW_PICTURE
-					CLIPLEFT_PARTIAL_COMPLEX :
-				//partial clipping
-				add		esi, CURCLIP
-					add		edi, CURCLIP
-					sub		ecx, CURCLIP
-					mov		CURCLIP, -1
-					CLIPLEFT_DRAW_COMPLEX_SEGMENT :
-					//*****************************************//
-					//put various code with encoding&loop there//
-					//*****************************************//
-					mov		al, cl
-					shr		cl, 2
-					and al, 3
-					rep		movsd
-					mov		cl, al
-					rep		movsb
-					//*****************************************//
-					//          end of variation zone          //
-					//*****************************************//
-					dec		TEMP1
-					jnz		CLIPLEFT_START_COMPLEX_SEGMENT
-					dec		NLines
-					jnz		CLIPLEFT_START_SCANLINE
-					CLIPLEFT_END_DRAW_PICTURE :
-				//end code
-				pop		edi
-					pop		esi
-					popf
-			}
-		}
-		else
-		{
-			if (x1 > WindX1)
-			{
-				//****************************************************************//
-				//****************************************************************//
-				//**      **     **                                **    **     **//
-				//****************   	clipping RIGHT edge			**************//
-				//**      **     **                                **    **     **//
-				//****************************************************************//
-				//****************************************************************//
-				CLIP = WindX1 - x + 1;
-				int ADDESI;
-				__asm
-				{
-					pushf
-					push	esi
-					push	edi
-					//initialisation
-					mov		edi, scrofs			//edi-screen pointer
-					mov		esi, CDPOS			//esi-points array
-					mov		ebx, Encoder			//ebx-encoding pointer
-					mov		edx, ofst			//edx-mask offset
-					xor		eax, eax
-					xor		ecx, ecx
-					cld
-					sub		edi, ScrWidth
-					mov		LineStart, edi
-					CLIPRIGHT_START_SCANLINE :
-					mov		edi, LineStart
-						mov		al, [edx]
-						inc		edx
-						mov		ADDESI, 0
-						xchg	CLIP, edx
-						add		edi, ScrWidth
-						mov		CURCLIP, edx
-						or al, al
-						xchg	CLIP, edx
-						mov		LineStart, edi
-						jnz		CLIPRIGHT_DRAW_LINE
-						dec		NLines
-						jnz		CLIPRIGHT_START_SCANLINE
-						jmp		CLIPRIGHT_END_DRAW_PICTURE
-						CLIPRIGHT_DRAW_LINE :
-					test	al, 128
-						jnz		CLIPRIGHT_DRAW_COMPLEX_LINE
-						//drawing simple line
-						or al, al
-						jz		CLIPRIGHT_NEXT_SEGMENT
-						mov		TEMP1, eax
-						CLIPRIGHT_START_SIMPLE_SEGMENT :
-					mov		al, [edx]	//empty space
-						add		edi, eax
-						mov		cl, [edx + 1]
-						add		edx, 2
-						sub		CURCLIP, eax
-						jg		CLIPRIGHT_TRY_TO_CLIP
-						//full clipping until the end of line
-						add		esi, ecx
-						dec		TEMP1
-						jnz		CLIPRIGHT_START_SIMPLE_SEGMENT
-						dec		NLines
-						jnz		CLIPRIGHT_START_SCANLINE
-						jmp		CLIPRIGHT_END_DRAW_PICTURE
-						CLIPRIGHT_TRY_TO_CLIP :
-					cmp		CURCLIP, ecx
-						jl		CLIPRIGHT_PARTIAL_SIMPLE
-						sub		CURCLIP, ecx
-						jmp		CLIPRIGHT_DRAW_SIMPLE_SEGMENT
-						CLIPRIGHT_PARTIAL_SIMPLE :
-					//partial clipping
-					sub		ecx, CURCLIP
-						mov		ADDESI, ecx
-						mov		ecx, CURCLIP
-						mov		CURCLIP, -1
-						CLIPRIGHT_DRAW_SIMPLE_SEGMENT :
-						//*****************************************//
-						//put various code with encoding&loop there//
-						//*****************************************//
-						mov		al, cl
-						shr		cl, 2
-						and al, 3
-						rep		movsd
-						mov		cl, al
-						rep		movsb
-						//*****************************************//
-						//          end of variation zone          //
-						//*****************************************//
-						add		esi, ADDESI
-						dec		TEMP1
-						jnz		CLIPRIGHT_START_SIMPLE_SEGMENT
-						CLIPRIGHT_NEXT_SEGMENT :
-					dec		NLines
-						jnz		CLIPRIGHT_START_SCANLINE
-						jmp		CLIPRIGHT_END_DRAW_PICTURE
-						CLIPRIGHT_DRAW_COMPLEX_LINE :
-					//complex packed line
-					mov		SPACE_MASK, 0
-						mov		PIX_MASK, 0
-						test	al, 64
-						jz		CLIPRIGHT_DCL1
-						mov		SPACE_MASK, 16
-						CLIPRIGHT_DCL1:		test	al, 32
-						jz		CLIPRIGHT_DCL2
-						mov		PIX_MASK, 16
-						CLIPRIGHT_DCL2 : and		al, 31
-						jz		CLIPRIGHT_NEXT_SEGMENT
-						mov		TEMP1, eax
-						CLIPRIGHT_START_COMPLEX_SEGMENT :
-					mov		al, [edx]
-						mov		cl, al
-						and		al, 15
-						or al, SPACE_MASK
-						add		edi, eax
-						shr		cl, 4
-						or cl, PIX_MASK
-						inc		edx
-						sub		CURCLIP, eax
-						jg		CLIPRIGHT_TRY_TO_CLIP_COMPLEX
-						//full clipping until the end of line
-						add		esi, ecx
-						dec		TEMP1
-						jnz		CLIPRIGHT_START_COMPLEX_SEGMENT
-						dec		NLines
-						jnz		CLIPRIGHT_START_SCANLINE
-						jmp		CLIPRIGHT_END_DRAW_PICTURE
-						CLIPRIGHT_TRY_TO_CLIP_COMPLEX :
-					cmp		CURCLIP, ecx
-						jl		CLIPRIGHT_PARTIAL_COMPLEX
-						sub		CURCLIP, ecx
-						jmp		CLIPRIGHT_DRAW_COMPLEX_SEGMENT
-						CLIPRIGHT_PARTIAL_COMPLEX :
-					//partial clipping
-					sub		ecx, CURCLIP
-						mov		ADDESI, ecx
-						mov		ecx, CURCLIP
-						mov		CURCLIP, -1
-						CLIPRIGHT_DRAW_COMPLEX_SEGMENT :
-						//*****************************************//
-						//put various code with encoding&loop there//
-						//*****************************************//
-						mov		al, cl
-						shr		cl, 2
-						and al, 3
-						rep		movsd
-						mov		cl, al
-						rep		movsb
-						//*****************************************//
-						//          end of variation zone          //
-						//*****************************************//
-						add		esi, ADDESI
-						dec		TEMP1
-						jnz		CLIPRIGHT_START_COMPLEX_SEGMENT
-						dec		NLines
-						jnz		CLIPRIGHT_START_SCANLINE
-						CLIPRIGHT_END_DRAW_PICTURE :
-					//end code
-					pop		edi
-						pop		esi
-						popf
-				}
-			}
-		}
-	}
+//Draw units in shadows and menu effects
+void GP_ShowMaskedPict( int x, int y, GP_Header* Pic, byte* CData, byte* Encoder )
+{
+	GP_ShowMasked( GPB_COPY, false, x, y, Pic, CData, Encoder, nullptr );
 }
 
 void GP_ShowMaskedPictInv( int x, int y, GP_Header* Pic, byte* CData, byte* Encoder )
 {
-	x -= Pic->dx;
-	y += Pic->dy;
-	int Lx = Pic->Lx;
-	int NLines = Pic->NLines;
-	int ofst = int( Pic ) + 23;
-	if (y + NLines <= WindY || x - Lx >= WindX1 || x<WindX || y>WindY1)return;
-	//vertical clipping
-	//top clipper
-	int CDPOS = int( CData );
-	if (y < WindY)
-	{
-		__asm {
-			mov		ecx, WindY
-			sub		ecx, y
-			sub		NLines, ecx
-			add		y, ecx
-			mov		ebx, ofst
-			xor		eax, eax
-			xor		edx, edx
-			NLINE : mov		al, [ebx]
-					test	al, 128
-					jz		SIMPLE_LINE
-					inc		ebx
-					mov		ah, al
-					and		al, 31
-					or al, al
-					jz		COMPLINE_1
-					and		ah, 32
-					shr		ah, 1
-					COMPLINE_LOOP1:
-			mov		dl, [ebx]
-				shr		dl, 4
-				or dl, ah
-				add		CDPOS, edx
-				inc		ebx
-				dec		al
-				jnz		COMPLINE_LOOP1
-				COMPLINE_1 :
-			xor		eax, eax
-				dec		ecx
-				jnz		NLINE
-				jmp		END_VCLIP
-				SIMPLE_LINE : inc		ebx
-				or eax, eax
-				jz		SIMPLINE_1
-				SIMPLINE_LOOP1 :
-			mov		dl, [ebx + 1]
-				add		CDPOS, edx
-				add		ebx, 2
-				dec		al
-				jnz		SIMPLINE_LOOP1
-				SIMPLINE_1 : dec		ecx
-				jnz		NLINE
-				END_VCLIP : mov		ofst, ebx
-		};
-	};
-	//bottom clipper
-	if (y + NLines > WindY1)NLines = WindY1 - y + 1;
-	//horisontal clipper
-	int x1 = x - Lx + 1;
-	int scrofs = int( ScreenPtr ) + x + y*ScrWidth;
-	int TEMP1;
-	int LineStart;
-	int CLIP;
-	int CURCLIP;
-	byte SPACE_MASK;
-	byte PIX_MASK;
-	if (x1 >= WindX&&x <= WindX1)
-	{
-		//***********************************************************//
-		//******************(((((((((((())))))))))))*****************//
-		//**                      NO CLIPPING                      **//INVERTED
-		//******************(((((((((((())))))))))))*****************//
-		//***********************************************************//
-				//no clipping
-		__asm {
-			pushf
-			push	esi
-			push	edi
-			//initialisation
-			mov		edi, scrofs			//edi-screen pointer
-			mov		esi, CDPOS			//esi-points array
-			mov		ebx, Encoder			//ebx-encoding pointer
-			mov		edx, ofst			//edx-mask offset
-			xor		eax, eax
-			xor		ecx, ecx
-			cld
-			sub		edi, ScrWidth
-			mov		LineStart, edi
-			START_SCANLINE :
-			mov		edi, LineStart
-				mov		al, [edx]
-				inc		edx
-				add		edi, ScrWidth
-				or al, al
-				mov		LineStart, edi
-				jnz		DRAW_LINE
-				dec		NLines
-				jnz		START_SCANLINE
-				jmp		END_DRAW_PICTURE
-				DRAW_LINE : test	al, 128
-				jnz		DRAW_COMPLEX_LINE
-				//drawing simple line
-				or al, al
-				jz		NEXT_SEGMENT
-				mov		TEMP1, eax
-				START_SIMPLE_SEGMENT :
-			mov		al, [edx]	//empty space
-				sub		edi, eax
-				mov		cl, [edx + 1]
-				add		edx, 2
-				//*****************************************//
-				//put various code with encoding&loop there//INVERTED
-				//*****************************************//
-				or cl, cl
-				jz		LP0_1
-				LP0_0 : movsb
-				sub		edi, 2
-				dec		cl
-				jnz		LP0_0
-				LP0_1 :
-			//*****************************************//
-			//          end of variation zone          //INVERTED
-			//*****************************************//
-			dec		TEMP1
-				jnz		START_SIMPLE_SEGMENT
-				NEXT_SEGMENT :
-			dec		NLines
-				jnz		START_SCANLINE
-				jmp		END_DRAW_PICTURE
-				DRAW_COMPLEX_LINE :
-			//complex packed line
-			mov		SPACE_MASK, 0
-				mov		PIX_MASK, 0
-				test	al, 64
-				jz		DCL1
-				mov		SPACE_MASK, 16
-				DCL1:		test	al, 32
-				jz		DCL2
-				mov		PIX_MASK, 16
-				DCL2 : and		al, 31
-				jz		NEXT_SEGMENT
-				mov		TEMP1, eax
-				START_COMPLEX_SEGMENT :
-			mov		al, [edx]
-				mov		cl, al
-				and		al, 15
-				or al, SPACE_MASK
-				sub		edi, eax
-				shr		cl, 4
-				or cl, PIX_MASK
-				inc		edx
-				//*****************************************//
-				//put various code with encoding&loop there//INVERTED
-				//*****************************************//
-				or cl, cl
-				jz		LP1_1
-				LP1_0 : movsb
-				sub		edi, 2
-				dec		cl
-				jnz		LP1_0
-				LP1_1 :
-			//*****************************************//
-			//          end of variation zone          //INVERTED
-			//*****************************************//
-			dec		TEMP1
-				jnz		START_COMPLEX_SEGMENT
-				dec		NLines
-				jnz		START_SCANLINE
-				END_DRAW_PICTURE :
-			//end code
-			pop		edi
-				pop		esi
-				popf
-		};
-	}
-	else
-	{
-		//image must be clipped
-		if (x > WindX1)
-		{
-			//****************************************************************//
-			//****************************************************************//
-			//**                                                            **//
-			//**					clipping RIGT(old-LEFT) edge						**//INVERTED
-			//**                                                            **//
-			//****************************************************************//
-			//****************************************************************//
-			CLIP = x - WindX1;
-			__asm {
-				pushf
-				push	esi
-				push	edi
-				//initialisation
-				mov		edi, scrofs			//edi-screen pointer
-				mov		esi, CDPOS			//esi-points array
-				mov		ebx, Encoder			//ebx-encoding pointer
-				mov		edx, ofst			//edx-mask offset
-				xor		eax, eax
-				xor		ecx, ecx
-				cld
-				sub		edi, ScrWidth
-				mov		LineStart, edi
-				CLIPLEFT_START_SCANLINE :
-				mov		edi, LineStart
-					mov		al, [edx]
-					inc		edx
-					xchg	CLIP, edx
-					add		edi, ScrWidth
-					mov		CURCLIP, edx
-					or al, al
-					xchg	CLIP, edx
-					mov		LineStart, edi
-					jnz		CLIPLEFT_DRAW_LINE
-					dec		NLines
-					jnz		CLIPLEFT_START_SCANLINE
-					jmp		CLIPLEFT_END_DRAW_PICTURE
-					CLIPLEFT_DRAW_LINE : test	al, 128
-					jnz		CLIPLEFT_DRAW_COMPLEX_LINE
-					//drawing simple line
-					or al, al
-					jz		CLIPLEFT_NEXT_SEGMENT
-					mov		TEMP1, eax
-					CLIPLEFT_START_SIMPLE_SEGMENT :
-				mov		al, [edx]	//empty space
-					sub		edi, eax
-					mov		cl, [edx + 1]
-					add		edx, 2
-					sub		CURCLIP, eax
-					jle		CLIPLEFT_DRAW_SIMPLE_SEGMENT
-					cmp		CURCLIP, ecx
-					jl		CLIPLEFT_PARTIAL_SIMPLE
-					//full  clipping
-					sub		CURCLIP, ecx
-					add		esi, ecx
-					sub		edi, ecx
-					dec		TEMP1
-					jnz		CLIPLEFT_START_SIMPLE_SEGMENT
-					dec		NLines
-					jnz		CLIPLEFT_START_SCANLINE
-					jmp		CLIPLEFT_END_DRAW_PICTURE
-					CLIPLEFT_PARTIAL_SIMPLE :
-				//partial clipping
-				add		esi, CURCLIP
-					sub		edi, CURCLIP
-					sub		ecx, CURCLIP
-					mov		CURCLIP, -1
-					CLIPLEFT_DRAW_SIMPLE_SEGMENT :
-					//*****************************************//
-					//put various code with encoding&loop there//INVERTED
-					//*****************************************//
-					or cl, cl
-					jz		LP2_1
-					LP2_0 : movsb
-					sub		edi, 2
-					dec		cl
-					jnz		LP2_0
-					LP2_1 :
-				//*****************************************//
-				//          end of variation zone          //INVERTED
-				//*****************************************//
-				dec		TEMP1
-					jnz		CLIPLEFT_START_SIMPLE_SEGMENT
-					CLIPLEFT_NEXT_SEGMENT :
-				dec		NLines
-					jnz		CLIPLEFT_START_SCANLINE
-					jmp		CLIPLEFT_END_DRAW_PICTURE
-					CLIPLEFT_DRAW_COMPLEX_LINE :
-				//complex packed line
-				mov		SPACE_MASK, 0
-					mov		PIX_MASK, 0
-					test	al, 64
-					jz		CLIPLEFT_DCL1
-					mov		SPACE_MASK, 16
-					CLIPLEFT_DCL1:	test	al, 32
-					jz		CLIPLEFT_DCL2
-					mov		PIX_MASK, 16
-					CLIPLEFT_DCL2 : and		al, 31
-					jz		CLIPLEFT_NEXT_SEGMENT
-					mov		TEMP1, eax
-					CLIPLEFT_START_COMPLEX_SEGMENT :
-				mov		al, [edx]
-					mov		cl, al
-					and		al, 15
-					or al, SPACE_MASK
-					sub		edi, eax
-					shr		cl, 4
-					or cl, PIX_MASK
-					inc		edx
-					sub		CURCLIP, eax
-					jle		CLIPLEFT_DRAW_COMPLEX_SEGMENT
-					cmp		CURCLIP, ecx
-					jl		CLIPLEFT_PARTIAL_COMPLEX
-					//full  clipping
-					sub		CURCLIP, ecx
-					add		esi, ecx
-					sub		edi, ecx
-					dec		TEMP1
-					jnz		CLIPLEFT_START_COMPLEX_SEGMENT
-					dec		NLines
-					jnz		CLIPLEFT_START_SCANLINE
-					jmp		CLIPLEFT_END_DRAW_PICTURE
-					CLIPLEFT_PARTIAL_COMPLEX :
-				//partial clipping
-				add		esi, CURCLIP
-					sub		edi, CURCLIP
-					sub		ecx, CURCLIP
-					mov		CURCLIP, -1
-					CLIPLEFT_DRAW_COMPLEX_SEGMENT :
-					//*****************************************//
-					//put various code with encoding&loop there//INVERTED
-					//*****************************************//
-					or cl, cl
-					jz		LP3_1
-					LP3_0 : movsb
-					sub		edi, 2
-					dec		cl
-					jnz		LP3_0
-					LP3_1 :
-				//*****************************************//
-				//          end of variation zone          //INVERTED
-				//*****************************************//
-				dec		TEMP1
-					jnz		CLIPLEFT_START_COMPLEX_SEGMENT
-					dec		NLines
-					jnz		CLIPLEFT_START_SCANLINE
-					CLIPLEFT_END_DRAW_PICTURE :
-				//end code
-				pop		edi
-					pop		esi
-					popf
-			};
-		}
-		else
-		{
-			if (x1 < WindX1)
-			{
-				//****************************************************************//
-				//****************************************************************//
-				//**      **     **                                **    **     **//
-				//****************   clipping LEFT(old-RIGHT) edge  **************//INVERTED
-				//**      **     **                                **    **     **//
-				//****************************************************************//
-				//****************************************************************//
-				CLIP = x - WindX + 1;
-				int ADDESI;
-				__asm {
-					pushf
-					push	esi
-					push	edi
-					//initialisation
-					mov		edi, scrofs			//edi-screen pointer
-					mov		esi, CDPOS			//esi-points array
-					mov		ebx, Encoder			//ebx-encoding pointer
-					mov		edx, ofst			//edx-mask offset
-					xor		eax, eax
-					xor		ecx, ecx
-					cld
-					sub		edi, ScrWidth
-					mov		LineStart, edi
-					CLIPRIGHT_START_SCANLINE :
-					mov		edi, LineStart
-						mov		al, [edx]
-						inc		edx
-						mov		ADDESI, 0
-						xchg	CLIP, edx
-						add		edi, ScrWidth
-						mov		CURCLIP, edx
-						or al, al
-						xchg	CLIP, edx
-						mov		LineStart, edi
-						jnz		CLIPRIGHT_DRAW_LINE
-						dec		NLines
-						jnz		CLIPRIGHT_START_SCANLINE
-						jmp		CLIPRIGHT_END_DRAW_PICTURE
-						CLIPRIGHT_DRAW_LINE :
-					test	al, 128
-						jnz		CLIPRIGHT_DRAW_COMPLEX_LINE
-						//drawing simple line
-						or al, al
-						jz		CLIPRIGHT_NEXT_SEGMENT
-						mov		TEMP1, eax
-						CLIPRIGHT_START_SIMPLE_SEGMENT :
-					mov		al, [edx]	//empty space
-						sub		edi, eax
-						mov		cl, [edx + 1]
-						add		edx, 2
-						sub		CURCLIP, eax
-						jg		CLIPRIGHT_TRY_TO_CLIP
-						//full clipping until the end of line
-						add		esi, ecx
-						dec		TEMP1
-						jnz		CLIPRIGHT_START_SIMPLE_SEGMENT
-						dec		NLines
-						jnz		CLIPRIGHT_START_SCANLINE
-						jmp		CLIPRIGHT_END_DRAW_PICTURE
-						CLIPRIGHT_TRY_TO_CLIP :
-					cmp		CURCLIP, ecx
-						jl		CLIPRIGHT_PARTIAL_SIMPLE
-						sub		CURCLIP, ecx
-						jmp		CLIPRIGHT_DRAW_SIMPLE_SEGMENT
-						CLIPRIGHT_PARTIAL_SIMPLE :
-					//partial clipping
-					sub		ecx, CURCLIP
-						mov		ADDESI, ecx
-						mov		ecx, CURCLIP
-						mov		CURCLIP, -1
-						CLIPRIGHT_DRAW_SIMPLE_SEGMENT :
-						//*****************************************//
-						//put various code with encoding&loop there//INVERTED
-						//*****************************************//
-						or cl, cl
-						jz		LP4_1
-						LP4_0 : movsb
-						sub		edi, 2
-						dec		cl
-						jnz		LP4_0
-						LP4_1 :
-					//*****************************************//
-					//          end of variation zone          //INVERTED
-					//*****************************************//
-					add		esi, ADDESI
-						dec		TEMP1
-						jnz		CLIPRIGHT_START_SIMPLE_SEGMENT
-						CLIPRIGHT_NEXT_SEGMENT :
-					dec		NLines
-						jnz		CLIPRIGHT_START_SCANLINE
-						jmp		CLIPRIGHT_END_DRAW_PICTURE
-						CLIPRIGHT_DRAW_COMPLEX_LINE :
-					//complex packed line
-					mov		SPACE_MASK, 0
-						mov		PIX_MASK, 0
-						test	al, 64
-						jz		CLIPRIGHT_DCL1
-						mov		SPACE_MASK, 16
-						CLIPRIGHT_DCL1:		test	al, 32
-						jz		CLIPRIGHT_DCL2
-						mov		PIX_MASK, 16
-						CLIPRIGHT_DCL2 : and		al, 31
-						jz		CLIPRIGHT_NEXT_SEGMENT
-						mov		TEMP1, eax
-						CLIPRIGHT_START_COMPLEX_SEGMENT :
-					mov		al, [edx]
-						mov		cl, al
-						and		al, 15
-						or al, SPACE_MASK
-						sub		edi, eax
-						shr		cl, 4
-						or cl, PIX_MASK
-						inc		edx
-						sub		CURCLIP, eax
-						jg		CLIPRIGHT_TRY_TO_CLIP_COMPLEX
-						//full clipping until the end of line
-						add		esi, ecx
-						dec		TEMP1
-						jnz		CLIPRIGHT_START_COMPLEX_SEGMENT
-						dec		NLines
-						jnz		CLIPRIGHT_START_SCANLINE
-						jmp		CLIPRIGHT_END_DRAW_PICTURE
-						CLIPRIGHT_TRY_TO_CLIP_COMPLEX :
-					cmp		CURCLIP, ecx
-						jl		CLIPRIGHT_PARTIAL_COMPLEX
-						sub		CURCLIP, ecx
-						jmp		CLIPRIGHT_DRAW_COMPLEX_SEGMENT
-						CLIPRIGHT_PARTIAL_COMPLEX :
-					//partial clipping
-					sub		ecx, CURCLIP
-						mov		ADDESI, ecx
-						mov		ecx, CURCLIP
-						mov		CURCLIP, -1
-						CLIPRIGHT_DRAW_COMPLEX_SEGMENT :
-						//*****************************************//
-						//put various code with encoding&loop there//INVERTED
-						//*****************************************//
-						or cl, cl
-						jz		LP5_1
-						LP5_0 : movsb
-						sub		edi, 2
-						dec		cl
-						jnz		LP5_0
-						LP5_1 :
-					//*****************************************//
-					//          end of variation zone          //INVERTED
-					//*****************************************//
-					add		esi, ADDESI
-						dec		TEMP1
-						jnz		CLIPRIGHT_START_COMPLEX_SEGMENT
-						dec		NLines
-						jnz		CLIPRIGHT_START_SCANLINE
-						CLIPRIGHT_END_DRAW_PICTURE :
-					//end code
-					pop		edi
-						pop		esi
-						popf
-				};
-			};
-		};
-	};
-};
-//key word: SHADRAW
-//******************************************************************************//
-//******************************************************************************//
-//******************************************************************************//
-//****																		****//
-//****																		****//
-//****				       S H A D O W   D R A W I N G						****//
-//****																		****//
-//****																		****//
-//******************************************************************************//
-//******************************************************************************//
-//******************************************************************************//
+	GP_ShowMasked( GPB_COPY, true, x, y, Pic, CData, Encoder, nullptr );
+}
+
 void GP_ShowMaskedPictShadow( int x, int y, GP_Header* Pic, byte* CData, byte* Encoder )
 {
-	x += Pic->dx;
-	y += Pic->dy;
-	int Lx = Pic->Lx;
-	int NLines = Pic->NLines;
-	int ofst = int( Pic ) + 23;
-	if (y + NLines <= WindY || x + Lx <= WindX || x > WindX1 || y > WindY1)return;
-	//vertical clipping
-	//top clipper
-	int CDPOS = int( CData );
-	if (y < WindY)
-	{
-		__asm {
-			mov		ecx, WindY
-			sub		ecx, y
-			sub		NLines, ecx
-			add		y, ecx
-			mov		ebx, ofst
-			xor		eax, eax
-			xor		edx, edx
-			NLINE : mov		al, [ebx]
-					test	al, 128
-					jz		SIMPLE_LINE
-					inc		ebx
-					mov		ah, al
-					and		al, 31
-					or al, al
-					jz		COMPLINE_1
-					and		ah, 32
-					shr		ah, 1
-					COMPLINE_LOOP1:
-			mov		dl, [ebx]
-				shr		dl, 4
-				or dl, ah
-				add		CDPOS, edx
-				inc		ebx
-				dec		al
-				jnz		COMPLINE_LOOP1
-				COMPLINE_1 :
-			xor		eax, eax
-				dec		ecx
-				jnz		NLINE
-				jmp		END_VCLIP
-				SIMPLE_LINE : inc		ebx
-				or eax, eax
-				jz		SIMPLINE_1
-				SIMPLINE_LOOP1 :
-			mov		dl, [ebx + 1]
-				add		CDPOS, edx
-				add		ebx, 2
-				dec		al
-				jnz		SIMPLINE_LOOP1
-				SIMPLINE_1 : dec		ecx
-				jnz		NLINE
-				END_VCLIP : mov		ofst, ebx
-		};
-	};
-	//bottom clipper
-	if (y + NLines > WindY1)NLines = WindY1 - y + 1;
-	//horisontal clipper
-	int x1 = x + Lx - 1;
-	int scrofs = int( ScreenPtr ) + x + y*ScrWidth;
-	int TEMP1;
-	int LineStart;
-	int CLIP;
-	int CURCLIP;
-	byte SPACE_MASK;
-	byte PIX_MASK;
-	if (x >= WindX&&x1 <= WindX1)
-	{
-		//***********************************************************//
-		//******************(((((((((((())))))))))))*****************//
-		//**                      NO CLIPPING                      **//
-		//******************(((((((((((())))))))))))*****************//
-		//***********************************************************//
-				//no clipping
-		__asm {
-			pushf
-			push	esi
-			push	edi
-			//initialisation
-			mov		edi, scrofs			//edi-screen pointer
-			mov		esi, CDPOS			//esi-points array
-			mov		ebx, Encoder			//ebx-encoding pointer
-			mov		edx, ofst			//edx-mask offset
-			xor		eax, eax
-			xor		ecx, ecx
-			cld
-			sub		edi, ScrWidth
-			mov		LineStart, edi
-			START_SCANLINE :
-			mov		edi, LineStart
-				mov		al, [edx]
-				inc		edx
-				add		edi, ScrWidth
-				or al, al
-				mov		LineStart, edi
-				jnz		DRAW_LINE
-				dec		NLines
-				jnz		START_SCANLINE
-				jmp		END_DRAW_PICTURE
-				DRAW_LINE : test	al, 128
-				jnz		DRAW_COMPLEX_LINE
-				//drawing simple line
-				or al, al
-				jz		NEXT_SEGMENT
-				mov		TEMP1, eax
-				START_SIMPLE_SEGMENT :
-			mov		al, [edx]	//empty space
-				add		edi, eax
-				mov		cl, [edx + 1]
-				add		edx, 2
-				//*****************************************//
-				//put various code with encoding&loop there//
-				//*****************************************//
-				or cl, cl
-				jz		SH0_1
-				xor		eax, eax
-				SH0_0 : mov		al, [edi]
-				mov		al, [ebx + eax]
-				mov[edi], al
-				inc		edi
-				dec		cl
-				jnz		SH0_0
-				SH0_1 :
-			//*****************************************//
-			//          end of variation zone          //
-			//*****************************************//
-			dec		TEMP1
-				jnz		START_SIMPLE_SEGMENT
-				NEXT_SEGMENT :
-			dec		NLines
-				jnz		START_SCANLINE
-				jmp		END_DRAW_PICTURE
-				DRAW_COMPLEX_LINE :
-			//complex packed line
-			mov		SPACE_MASK, 0
-				mov		PIX_MASK, 0
-				test	al, 64
-				jz		DCL1
-				mov		SPACE_MASK, 16
-				DCL1:		test	al, 32
-				jz		DCL2
-				mov		PIX_MASK, 16
-				DCL2 : and		al, 31
-				jz		NEXT_SEGMENT
-				mov		TEMP1, eax
-				START_COMPLEX_SEGMENT :
-			mov		al, [edx]
-				mov		cl, al
-				and		al, 15
-				or al, SPACE_MASK
-				add		edi, eax
-				shr		cl, 4
-				or cl, PIX_MASK
-				inc		edx
-				//*****************************************//
-				//put various code with encoding&loop there//
-				//*****************************************//
-				or cl, cl
-				jz		SH1_1
-				xor		eax, eax
-				SH1_0 : mov		al, [edi]
-				mov		al, [ebx + eax]
-				mov[edi], al
-				inc		edi
-				dec		cl
-				jnz		SH1_0
-				SH1_1 :
-			//*****************************************//
-			//          end of variation zone          //
-			//*****************************************//
-			dec		TEMP1
-				jnz		START_COMPLEX_SEGMENT
-				dec		NLines
-				jnz		START_SCANLINE
-				END_DRAW_PICTURE :
-			//end code
-			pop		edi
-				pop		esi
-				popf
-		};
-	}
-	else
-	{
-		//image must be clipped
-		if (x < WindX)
-		{
-			//****************************************************************//
-			//****************************************************************//
-			//**                                                            **//
-			//**					clipping LEFT edge						**//
-			//**                                                            **//
-			//****************************************************************//
-			//****************************************************************//
-			CLIP = WindX - x;
-			__asm {
-				pushf
-				push	esi
-				push	edi
-				//initialisation
-				mov		edi, scrofs			//edi-screen pointer
-				mov		esi, CDPOS			//esi-points array
-				mov		ebx, Encoder			//ebx-encoding pointer
-				mov		edx, ofst			//edx-mask offset
-				xor		eax, eax
-				xor		ecx, ecx
-				cld
-				sub		edi, ScrWidth
-				mov		LineStart, edi
-				CLIPLEFT_START_SCANLINE :
-				mov		edi, LineStart
-					mov		al, [edx]
-					inc		edx
-					xchg	CLIP, edx
-					add		edi, ScrWidth
-					mov		CURCLIP, edx
-					or al, al
-					xchg	CLIP, edx
-					mov		LineStart, edi
-					jnz		CLIPLEFT_DRAW_LINE
-					dec		NLines
-					jnz		CLIPLEFT_START_SCANLINE
-					jmp		CLIPLEFT_END_DRAW_PICTURE
-					CLIPLEFT_DRAW_LINE : test	al, 128
-					jnz		CLIPLEFT_DRAW_COMPLEX_LINE
-					//drawing simple line
-					or al, al
-					jz		CLIPLEFT_NEXT_SEGMENT
-					mov		TEMP1, eax
-					CLIPLEFT_START_SIMPLE_SEGMENT :
-				mov		al, [edx]	//empty space
-					add		edi, eax
-					mov		cl, [edx + 1]
-					add		edx, 2
-					sub		CURCLIP, eax
-					jle		CLIPLEFT_DRAW_SIMPLE_SEGMENT
-					cmp		CURCLIP, ecx
-					jl		CLIPLEFT_PARTIAL_SIMPLE
-					//full  clipping
-					sub		CURCLIP, ecx
-					add		esi, ecx
-					add		edi, ecx
-					dec		TEMP1
-					jnz		CLIPLEFT_START_SIMPLE_SEGMENT
-					dec		NLines
-					jnz		CLIPLEFT_START_SCANLINE
-					jmp		CLIPLEFT_END_DRAW_PICTURE
-					CLIPLEFT_PARTIAL_SIMPLE :
-				//partial clipping
-				add		esi, CURCLIP
-					add		edi, CURCLIP
-					sub		ecx, CURCLIP
-					mov		CURCLIP, -1
-					CLIPLEFT_DRAW_SIMPLE_SEGMENT :
-					//*****************************************//
-					//put various code with encoding&loop there//
-					//*****************************************//
-					or cl, cl
-					jz		SH2_1
-					xor		eax, eax
-					SH2_0 : mov		al, [edi]
-					mov		al, [ebx + eax]
-					mov[edi], al
-					inc		edi
-					dec		cl
-					jnz		SH2_0
-					SH2_1 :
-				//*****************************************//
-				//          end of variation zone          //
-				//*****************************************//
-				dec		TEMP1
-					jnz		CLIPLEFT_START_SIMPLE_SEGMENT
-					CLIPLEFT_NEXT_SEGMENT :
-				dec		NLines
-					jnz		CLIPLEFT_START_SCANLINE
-					jmp		CLIPLEFT_END_DRAW_PICTURE
-					CLIPLEFT_DRAW_COMPLEX_LINE :
-				//complex packed line
-				mov		SPACE_MASK, 0
-					mov		PIX_MASK, 0
-					test	al, 64
-					jz		CLIPLEFT_DCL1
-					mov		SPACE_MASK, 16
-					CLIPLEFT_DCL1:	test	al, 32
-					jz		CLIPLEFT_DCL2
-					mov		PIX_MASK, 16
-					CLIPLEFT_DCL2 : and		al, 31
-					jz		CLIPLEFT_NEXT_SEGMENT
-					mov		TEMP1, eax
-					CLIPLEFT_START_COMPLEX_SEGMENT :
-				mov		al, [edx]
-					mov		cl, al
-					and		al, 15
-					or al, SPACE_MASK
-					add		edi, eax
-					shr		cl, 4
-					or cl, PIX_MASK
-					inc		edx
-					sub		CURCLIP, eax
-					jle		CLIPLEFT_DRAW_COMPLEX_SEGMENT
-					cmp		CURCLIP, ecx
-					jl		CLIPLEFT_PARTIAL_COMPLEX
-					//full  clipping
-					sub		CURCLIP, ecx
-					add		esi, ecx
-					add		edi, ecx
-					dec		TEMP1
-					jnz		CLIPLEFT_START_COMPLEX_SEGMENT
-					dec		NLines
-					jnz		CLIPLEFT_START_SCANLINE
-					jmp		CLIPLEFT_END_DRAW_PICTURE
-					CLIPLEFT_PARTIAL_COMPLEX :
-				//partial clipping
-				add		esi, CURCLIP
-					add		edi, CURCLIP
-					sub		ecx, CURCLIP
-					mov		CURCLIP, -1
-					CLIPLEFT_DRAW_COMPLEX_SEGMENT :
-					//*****************************************//
-					//put various code with encoding&loop there//
-					//*****************************************//
-					or cl, cl
-					jz		SH3_1
-					xor		eax, eax
-					SH3_0 : mov		al, [edi]
-					mov		al, [ebx + eax]
-					mov[edi], al
-					inc		edi
-					dec		cl
-					jnz		SH3_0
-					SH3_1 :
-				//*****************************************//
-				//          end of variation zone          //
-				//*****************************************//
-				dec		TEMP1
-					jnz		CLIPLEFT_START_COMPLEX_SEGMENT
-					dec		NLines
-					jnz		CLIPLEFT_START_SCANLINE
-					CLIPLEFT_END_DRAW_PICTURE :
-				//end code
-				pop		edi
-					pop		esi
-					popf
-			};
-		}
-		else
-		{
-			if (x1 > WindX1)
-			{
-				//****************************************************************//
-				//****************************************************************//
-				//**      **     **                                **    **     **//
-				//****************   	clipping RIGHT edge			**************//
-				//**      **     **                                **    **     **//
-				//****************************************************************//
-				//****************************************************************//
-				CLIP = WindX1 - x + 1;
-				int ADDESI;
-				__asm {
-					pushf
-					push	esi
-					push	edi
-					//initialisation
-					mov		edi, scrofs			//edi-screen pointer
-					mov		esi, CDPOS			//esi-points array
-					mov		ebx, Encoder			//ebx-encoding pointer
-					mov		edx, ofst			//edx-mask offset
-					xor		eax, eax
-					xor		ecx, ecx
-					cld
-					sub		edi, ScrWidth
-					mov		LineStart, edi
-					CLIPRIGHT_START_SCANLINE :
-					mov		edi, LineStart
-						mov		al, [edx]
-						inc		edx
-						mov		ADDESI, 0
-						xchg	CLIP, edx
-						add		edi, ScrWidth
-						mov		CURCLIP, edx
-						or al, al
-						xchg	CLIP, edx
-						mov		LineStart, edi
-						jnz		CLIPRIGHT_DRAW_LINE
-						dec		NLines
-						jnz		CLIPRIGHT_START_SCANLINE
-						jmp		CLIPRIGHT_END_DRAW_PICTURE
-						CLIPRIGHT_DRAW_LINE :
-					test	al, 128
-						jnz		CLIPRIGHT_DRAW_COMPLEX_LINE
-						//drawing simple line
-						or al, al
-						jz		CLIPRIGHT_NEXT_SEGMENT
-						mov		TEMP1, eax
-						CLIPRIGHT_START_SIMPLE_SEGMENT :
-					mov		al, [edx]	//empty space
-						add		edi, eax
-						mov		cl, [edx + 1]
-						add		edx, 2
-						sub		CURCLIP, eax
-						jg		CLIPRIGHT_TRY_TO_CLIP
-						//full clipping until the end of line
-						add		esi, ecx
-						dec		TEMP1
-						jnz		CLIPRIGHT_START_SIMPLE_SEGMENT
-						dec		NLines
-						jnz		CLIPRIGHT_START_SCANLINE
-						jmp		CLIPRIGHT_END_DRAW_PICTURE
-						CLIPRIGHT_TRY_TO_CLIP :
-					cmp		CURCLIP, ecx
-						jl		CLIPRIGHT_PARTIAL_SIMPLE
-						sub		CURCLIP, ecx
-						jmp		CLIPRIGHT_DRAW_SIMPLE_SEGMENT
-						CLIPRIGHT_PARTIAL_SIMPLE :
-					//partial clipping
-					sub		ecx, CURCLIP
-						mov		ADDESI, ecx
-						mov		ecx, CURCLIP
-						mov		CURCLIP, -1
-						CLIPRIGHT_DRAW_SIMPLE_SEGMENT :
-						//*****************************************//
-						//put various code with encoding&loop there//
-						//*****************************************//
-						or cl, cl
-						jz		SH4_1
-						xor		eax, eax
-						SH4_0 : mov		al, [edi]
-						mov		al, [ebx + eax]
-						mov[edi], al
-						inc		edi
-						dec		cl
-						jnz		SH4_0
-						SH4_1 :
-					//*****************************************//
-					//          end of variation zone          //
-					//*****************************************//
-					add		esi, ADDESI
-						dec		TEMP1
-						jnz		CLIPRIGHT_START_SIMPLE_SEGMENT
-						CLIPRIGHT_NEXT_SEGMENT :
-					dec		NLines
-						jnz		CLIPRIGHT_START_SCANLINE
-						jmp		CLIPRIGHT_END_DRAW_PICTURE
-						CLIPRIGHT_DRAW_COMPLEX_LINE :
-					//complex packed line
-					mov		SPACE_MASK, 0
-						mov		PIX_MASK, 0
-						test	al, 64
-						jz		CLIPRIGHT_DCL1
-						mov		SPACE_MASK, 16
-						CLIPRIGHT_DCL1:		test	al, 32
-						jz		CLIPRIGHT_DCL2
-						mov		PIX_MASK, 16
-						CLIPRIGHT_DCL2 : and		al, 31
-						jz		CLIPRIGHT_NEXT_SEGMENT
-						mov		TEMP1, eax
-						CLIPRIGHT_START_COMPLEX_SEGMENT :
-					mov		al, [edx]
-						mov		cl, al
-						and		al, 15
-						or al, SPACE_MASK
-						add		edi, eax
-						shr		cl, 4
-						or cl, PIX_MASK
-						inc		edx
-						sub		CURCLIP, eax
-						jg		CLIPRIGHT_TRY_TO_CLIP_COMPLEX
-						//full clipping until the end of line
-						add		esi, ecx
-						dec		TEMP1
-						jnz		CLIPRIGHT_START_COMPLEX_SEGMENT
-						dec		NLines
-						jnz		CLIPRIGHT_START_SCANLINE
-						jmp		CLIPRIGHT_END_DRAW_PICTURE
-						CLIPRIGHT_TRY_TO_CLIP_COMPLEX :
-					cmp		CURCLIP, ecx
-						jl		CLIPRIGHT_PARTIAL_COMPLEX
-						sub		CURCLIP, ecx
-						jmp		CLIPRIGHT_DRAW_COMPLEX_SEGMENT
-						CLIPRIGHT_PARTIAL_COMPLEX :
-					//partial clipping
-					sub		ecx, CURCLIP
-						mov		ADDESI, ecx
-						mov		ecx, CURCLIP
-						mov		CURCLIP, -1
-						CLIPRIGHT_DRAW_COMPLEX_SEGMENT :
-						//*****************************************//
-						//put various code with encoding&loop there//
-						//*****************************************//
-						or cl, cl
-						jz		SH5_1
-						xor		eax, eax
-						SH5_0 : mov		al, [edi]
-						mov		al, [ebx + eax]
-						mov[edi], al
-						inc		edi
-						dec		cl
-						jnz		SH5_0
-						SH5_1 :
-					//*****************************************//
-					//          end of variation zone          //
-					//*****************************************//
-					add		esi, ADDESI
-						dec		TEMP1
-						jnz		CLIPRIGHT_START_COMPLEX_SEGMENT
-						dec		NLines
-						jnz		CLIPRIGHT_START_SCANLINE
-						CLIPRIGHT_END_DRAW_PICTURE :
-					//end code
-					pop		edi
-						pop		esi
-						popf
-				};
-			};
-		};
-	};
-};
+	GP_ShowMasked( GPB_SHADOW, false, x, y, Pic, CData, Encoder, nullptr );
+}
+
 void GP_ShowMaskedPictShadowInv( int x, int y, GP_Header* Pic, byte* CData, byte* Encoder )
 {
-	x -= Pic->dx;
-	y += Pic->dy;
-	int Lx = Pic->Lx;
-	int NLines = Pic->NLines;
-	int ofst = int( Pic ) + 23;
-	if (y + NLines <= WindY || x - Lx >= WindX1 || x<WindX || y>WindY1)return;
-	//vertical clipping
-	//top clipper
-	int CDPOS = int( CData );
-	if (y < WindY)
-	{
-		__asm {
-			mov		ecx, WindY
-			sub		ecx, y
-			sub		NLines, ecx
-			add		y, ecx
-			mov		ebx, ofst
-			xor		eax, eax
-			xor		edx, edx
-			NLINE : mov		al, [ebx]
-					test	al, 128
-					jz		SIMPLE_LINE
-					inc		ebx
-					mov		ah, al
-					and		al, 31
-					or al, al
-					jz		COMPLINE_1
-					and		ah, 32
-					shr		ah, 1
-					COMPLINE_LOOP1:
-			mov		dl, [ebx]
-				shr		dl, 4
-				or dl, ah
-				add		CDPOS, edx
-				inc		ebx
-				dec		al
-				jnz		COMPLINE_LOOP1
-				COMPLINE_1 :
-			xor		eax, eax
-				dec		ecx
-				jnz		NLINE
-				jmp		END_VCLIP
-				SIMPLE_LINE : inc		ebx
-				or eax, eax
-				jz		SIMPLINE_1
-				SIMPLINE_LOOP1 :
-			mov		dl, [ebx + 1]
-				add		CDPOS, edx
-				add		ebx, 2
-				dec		al
-				jnz		SIMPLINE_LOOP1
-				SIMPLINE_1 : dec		ecx
-				jnz		NLINE
-				END_VCLIP : mov		ofst, ebx
-		};
-	};
-	//bottom clipper
-	if (y + NLines > WindY1)NLines = WindY1 - y + 1;
-	//horisontal clipper
-	int x1 = x - Lx + 1;
-	int scrofs = int( ScreenPtr ) + x + y*ScrWidth;
-	int TEMP1;
-	int LineStart;
-	int CLIP;
-	int CURCLIP;
-	byte SPACE_MASK;
-	byte PIX_MASK;
-	if (x1 >= WindX&&x <= WindX1)
-	{
-		//***********************************************************//
-		//******************(((((((((((())))))))))))*****************//
-		//**                      NO CLIPPING                      **//INVERTED
-		//******************(((((((((((())))))))))))*****************//
-		//***********************************************************//
-				//no clipping
-		__asm {
-			pushf
-			push	esi
-			push	edi
-			//initialisation
-			mov		edi, scrofs			//edi-screen pointer
-			mov		esi, CDPOS			//esi-points array
-			mov		ebx, Encoder			//ebx-encoding pointer
-			mov		edx, ofst			//edx-mask offset
-			xor		eax, eax
-			xor		ecx, ecx
-			cld
-			sub		edi, ScrWidth
-			mov		LineStart, edi
-			START_SCANLINE :
-			mov		edi, LineStart
-				mov		al, [edx]
-				inc		edx
-				add		edi, ScrWidth
-				or al, al
-				mov		LineStart, edi
-				jnz		DRAW_LINE
-				dec		NLines
-				jnz		START_SCANLINE
-				jmp		END_DRAW_PICTURE
-				DRAW_LINE : test	al, 128
-				jnz		DRAW_COMPLEX_LINE
-				//drawing simple line
-				or al, al
-				jz		NEXT_SEGMENT
-				mov		TEMP1, eax
-				START_SIMPLE_SEGMENT :
-			mov		al, [edx]	//empty space
-				sub		edi, eax
-				mov		cl, [edx + 1]
-				add		edx, 2
-				//*****************************************//
-				//put various code with encoding&loop there//INVERTED
-				//*****************************************//
-				or cl, cl
-				jz		SH0_1
-				xor		eax, eax
-				SH0_0 : mov		al, [edi]
-				mov		al, [ebx + eax]
-				mov[edi], al
-				dec		edi
-				dec		cl
-				jnz		SH0_0
-				SH0_1 :
-			//*****************************************//
-			//          end of variation zone          //INVERTED
-			//*****************************************//
-			dec		TEMP1
-				jnz		START_SIMPLE_SEGMENT
-				NEXT_SEGMENT :
-			dec		NLines
-				jnz		START_SCANLINE
-				jmp		END_DRAW_PICTURE
-				DRAW_COMPLEX_LINE :
-			//complex packed line
-			mov		SPACE_MASK, 0
-				mov		PIX_MASK, 0
-				test	al, 64
-				jz		DCL1
-				mov		SPACE_MASK, 16
-				DCL1:		test	al, 32
-				jz		DCL2
-				mov		PIX_MASK, 16
-				DCL2 : and		al, 31
-				jz		NEXT_SEGMENT
-				mov		TEMP1, eax
-				START_COMPLEX_SEGMENT :
-			mov		al, [edx]
-				mov		cl, al
-				and		al, 15
-				or al, SPACE_MASK
-				sub		edi, eax
-				shr		cl, 4
-				or cl, PIX_MASK
-				inc		edx
-				//*****************************************//
-				//put various code with encoding&loop there//INVERTED
-				//*****************************************//
-				or cl, cl
-				jz		SH1_1
-				xor		eax, eax
-				SH1_0 : mov		al, [edi]
-				mov		al, [ebx + eax]
-				mov[edi], al
-				dec		edi
-				dec		cl
-				jnz		SH1_0
-				SH1_1 :
-			//*****************************************//
-			//          end of variation zone          //INVERTED
-			//*****************************************//
-			dec		TEMP1
-				jnz		START_COMPLEX_SEGMENT
-				dec		NLines
-				jnz		START_SCANLINE
-				END_DRAW_PICTURE :
-			//end code
-			pop		edi
-				pop		esi
-				popf
-		};
-	}
-	else
-	{
-		//image must be clipped
-		if (x > WindX1)
-		{
-			//****************************************************************//
-			//****************************************************************//
-			//**                                                            **//
-			//**					clipping RIGT(old-LEFT) edge						**//INVERTED
-			//**                                                            **//
-			//****************************************************************//
-			//****************************************************************//
-			CLIP = x - WindX1;
-			__asm {
-				pushf
-				push	esi
-				push	edi
-				//initialisation
-				mov		edi, scrofs			//edi-screen pointer
-				mov		esi, CDPOS			//esi-points array
-				mov		ebx, Encoder			//ebx-encoding pointer
-				mov		edx, ofst			//edx-mask offset
-				xor		eax, eax
-				xor		ecx, ecx
-				cld
-				sub		edi, ScrWidth
-				mov		LineStart, edi
-				CLIPLEFT_START_SCANLINE :
-				mov		edi, LineStart
-					mov		al, [edx]
-					inc		edx
-					xchg	CLIP, edx
-					add		edi, ScrWidth
-					mov		CURCLIP, edx
-					or al, al
-					xchg	CLIP, edx
-					mov		LineStart, edi
-					jnz		CLIPLEFT_DRAW_LINE
-					dec		NLines
-					jnz		CLIPLEFT_START_SCANLINE
-					jmp		CLIPLEFT_END_DRAW_PICTURE
-					CLIPLEFT_DRAW_LINE : test	al, 128
-					jnz		CLIPLEFT_DRAW_COMPLEX_LINE
-					//drawing simple line
-					or al, al
-					jz		CLIPLEFT_NEXT_SEGMENT
-					mov		TEMP1, eax
-					CLIPLEFT_START_SIMPLE_SEGMENT :
-				mov		al, [edx]	//empty space
-					sub		edi, eax
-					mov		cl, [edx + 1]
-					add		edx, 2
-					sub		CURCLIP, eax
-					jle		CLIPLEFT_DRAW_SIMPLE_SEGMENT
-					cmp		CURCLIP, ecx
-					jl		CLIPLEFT_PARTIAL_SIMPLE
-					//full  clipping
-					sub		CURCLIP, ecx
-					add		esi, ecx
-					sub		edi, ecx
-					dec		TEMP1
-					jnz		CLIPLEFT_START_SIMPLE_SEGMENT
-					dec		NLines
-					jnz		CLIPLEFT_START_SCANLINE
-					jmp		CLIPLEFT_END_DRAW_PICTURE
-					CLIPLEFT_PARTIAL_SIMPLE :
-				//partial clipping
-				add		esi, CURCLIP
-					sub		edi, CURCLIP
-					sub		ecx, CURCLIP
-					mov		CURCLIP, -1
-					CLIPLEFT_DRAW_SIMPLE_SEGMENT :
-					//*****************************************//
-					//put various code with encoding&loop there//INVERTED
-					//*****************************************//
-					or cl, cl
-					jz		SH2_1
-					xor		eax, eax
-					SH2_0 : mov		al, [edi]
-					mov		al, [ebx + eax]
-					mov[edi], al
-					dec		edi
-					dec		cl
-					jnz		SH2_0
-					SH2_1 :
-				//*****************************************//
-				//          end of variation zone          //INVERTED
-				//*****************************************//
-				dec		TEMP1
-					jnz		CLIPLEFT_START_SIMPLE_SEGMENT
-					CLIPLEFT_NEXT_SEGMENT :
-				dec		NLines
-					jnz		CLIPLEFT_START_SCANLINE
-					jmp		CLIPLEFT_END_DRAW_PICTURE
-					CLIPLEFT_DRAW_COMPLEX_LINE :
-				//complex packed line
-				mov		SPACE_MASK, 0
-					mov		PIX_MASK, 0
-					test	al, 64
-					jz		CLIPLEFT_DCL1
-					mov		SPACE_MASK, 16
-					CLIPLEFT_DCL1:	test	al, 32
-					jz		CLIPLEFT_DCL2
-					mov		PIX_MASK, 16
-					CLIPLEFT_DCL2 : and		al, 31
-					jz		CLIPLEFT_NEXT_SEGMENT
-					mov		TEMP1, eax
-					CLIPLEFT_START_COMPLEX_SEGMENT :
-				mov		al, [edx]
-					mov		cl, al
-					and		al, 15
-					or al, SPACE_MASK
-					sub		edi, eax
-					shr		cl, 4
-					or cl, PIX_MASK
-					inc		edx
-					sub		CURCLIP, eax
-					jle		CLIPLEFT_DRAW_COMPLEX_SEGMENT
-					cmp		CURCLIP, ecx
-					jl		CLIPLEFT_PARTIAL_COMPLEX
-					//full  clipping
-					sub		CURCLIP, ecx
-					add		esi, ecx
-					sub		edi, ecx
-					dec		TEMP1
-					jnz		CLIPLEFT_START_COMPLEX_SEGMENT
-					dec		NLines
-					jnz		CLIPLEFT_START_SCANLINE
-					jmp		CLIPLEFT_END_DRAW_PICTURE
-					CLIPLEFT_PARTIAL_COMPLEX :
-				//partial clipping
-				add		esi, CURCLIP
-					sub		edi, CURCLIP
-					sub		ecx, CURCLIP
-					mov		CURCLIP, -1
-					CLIPLEFT_DRAW_COMPLEX_SEGMENT :
-					//*****************************************//
-					//put various code with encoding&loop there//INVERTED
-					//*****************************************//
-					or cl, cl
-					jz		SH3_1
-					xor		eax, eax
-					SH3_0 : mov		al, [edi]
-					mov		al, [ebx + eax]
-					mov[edi], al
-					dec		edi
-					dec		cl
-					jnz		SH3_0
-					SH3_1 :
-				//*****************************************//
-				//          end of variation zone          //INVERTED
-				//*****************************************//
-				dec		TEMP1
-					jnz		CLIPLEFT_START_COMPLEX_SEGMENT
-					dec		NLines
-					jnz		CLIPLEFT_START_SCANLINE
-					CLIPLEFT_END_DRAW_PICTURE :
-				//end code
-				pop		edi
-					pop		esi
-					popf
-			};
-		}
-		else
-		{
-			if (x1 < WindX1)
-			{
-				//****************************************************************//
-				//****************************************************************//
-				//**      **     **                                **    **     **//
-				//****************   clipping LEFT(old-RIGHT) edge  **************//INVERTED
-				//**      **     **                                **    **     **//
-				//****************************************************************//
-				//****************************************************************//
-				CLIP = x - WindX + 1;
-				int ADDESI;
-				__asm {
-					pushf
-					push	esi
-					push	edi
-					//initialisation
-					mov		edi, scrofs			//edi-screen pointer
-					mov		esi, CDPOS			//esi-points array
-					mov		ebx, Encoder			//ebx-encoding pointer
-					mov		edx, ofst			//edx-mask offset
-					xor		eax, eax
-					xor		ecx, ecx
-					cld
-					sub		edi, ScrWidth
-					mov		LineStart, edi
-					CLIPRIGHT_START_SCANLINE :
-					mov		edi, LineStart
-						mov		al, [edx]
-						inc		edx
-						mov		ADDESI, 0
-						xchg	CLIP, edx
-						add		edi, ScrWidth
-						mov		CURCLIP, edx
-						or al, al
-						xchg	CLIP, edx
-						mov		LineStart, edi
-						jnz		CLIPRIGHT_DRAW_LINE
-						dec		NLines
-						jnz		CLIPRIGHT_START_SCANLINE
-						jmp		CLIPRIGHT_END_DRAW_PICTURE
-						CLIPRIGHT_DRAW_LINE :
-					test	al, 128
-						jnz		CLIPRIGHT_DRAW_COMPLEX_LINE
-						//drawing simple line
-						or al, al
-						jz		CLIPRIGHT_NEXT_SEGMENT
-						mov		TEMP1, eax
-						CLIPRIGHT_START_SIMPLE_SEGMENT :
-					mov		al, [edx]	//empty space
-						sub		edi, eax
-						mov		cl, [edx + 1]
-						add		edx, 2
-						sub		CURCLIP, eax
-						jg		CLIPRIGHT_TRY_TO_CLIP
-						//full clipping until the end of line
-						add		esi, ecx
-						dec		TEMP1
-						jnz		CLIPRIGHT_START_SIMPLE_SEGMENT
-						dec		NLines
-						jnz		CLIPRIGHT_START_SCANLINE
-						jmp		CLIPRIGHT_END_DRAW_PICTURE
-						CLIPRIGHT_TRY_TO_CLIP :
-					cmp		CURCLIP, ecx
-						jl		CLIPRIGHT_PARTIAL_SIMPLE
-						sub		CURCLIP, ecx
-						jmp		CLIPRIGHT_DRAW_SIMPLE_SEGMENT
-						CLIPRIGHT_PARTIAL_SIMPLE :
-					//partial clipping
-					sub		ecx, CURCLIP
-						mov		ADDESI, ecx
-						mov		ecx, CURCLIP
-						mov		CURCLIP, -1
-						CLIPRIGHT_DRAW_SIMPLE_SEGMENT :
-						//*****************************************//
-						//put various code with encoding&loop there//INVERTED
-						//*****************************************//
-						or cl, cl
-						jz		SH4_1
-						xor		eax, eax
-						SH4_0 : mov		al, [edi]
-						mov		al, [ebx + eax]
-						mov[edi], al
-						dec		edi
-						dec		cl
-						jnz		SH4_0
-						SH4_1 :
-					//*****************************************//
-					//          end of variation zone          //INVERTED
-					//*****************************************//
-					add		esi, ADDESI
-						dec		TEMP1
-						jnz		CLIPRIGHT_START_SIMPLE_SEGMENT
-						CLIPRIGHT_NEXT_SEGMENT :
-					dec		NLines
-						jnz		CLIPRIGHT_START_SCANLINE
-						jmp		CLIPRIGHT_END_DRAW_PICTURE
-						CLIPRIGHT_DRAW_COMPLEX_LINE :
-					//complex packed line
-					mov		SPACE_MASK, 0
-						mov		PIX_MASK, 0
-						test	al, 64
-						jz		CLIPRIGHT_DCL1
-						mov		SPACE_MASK, 16
-						CLIPRIGHT_DCL1:		test	al, 32
-						jz		CLIPRIGHT_DCL2
-						mov		PIX_MASK, 16
-						CLIPRIGHT_DCL2 : and		al, 31
-						jz		CLIPRIGHT_NEXT_SEGMENT
-						mov		TEMP1, eax
-						CLIPRIGHT_START_COMPLEX_SEGMENT :
-					mov		al, [edx]
-						mov		cl, al
-						and		al, 15
-						or al, SPACE_MASK
-						sub		edi, eax
-						shr		cl, 4
-						or cl, PIX_MASK
-						inc		edx
-						sub		CURCLIP, eax
-						jg		CLIPRIGHT_TRY_TO_CLIP_COMPLEX
-						//full clipping until the end of line
-						add		esi, ecx
-						dec		TEMP1
-						jnz		CLIPRIGHT_START_COMPLEX_SEGMENT
-						dec		NLines
-						jnz		CLIPRIGHT_START_SCANLINE
-						jmp		CLIPRIGHT_END_DRAW_PICTURE
-						CLIPRIGHT_TRY_TO_CLIP_COMPLEX :
-					cmp		CURCLIP, ecx
-						jl		CLIPRIGHT_PARTIAL_COMPLEX
-						sub		CURCLIP, ecx
-						jmp		CLIPRIGHT_DRAW_COMPLEX_SEGMENT
-						CLIPRIGHT_PARTIAL_COMPLEX :
-					//partial clipping
-					sub		ecx, CURCLIP
-						mov		ADDESI, ecx
-						mov		ecx, CURCLIP
-						mov		CURCLIP, -1
-						CLIPRIGHT_DRAW_COMPLEX_SEGMENT :
-						//*****************************************//
-						//put various code with encoding&loop there//INVERTED
-						//*****************************************//
-						or cl, cl
-						jz		SH5_1
-						xor		eax, eax
-						SH5_0 : mov		al, [edi]
-						mov		al, [ebx + eax]
-						mov[edi], al
-						dec		edi
-						dec		cl
-						jnz		SH5_0
-						SH5_1 :
-					//*****************************************//
-					//          end of variation zone          //INVERTED
-					//*****************************************//
-					add		esi, ADDESI
-						dec		TEMP1
-						jnz		CLIPRIGHT_START_COMPLEX_SEGMENT
-						dec		NLines
-						jnz		CLIPRIGHT_START_SCANLINE
-						CLIPRIGHT_END_DRAW_PICTURE :
-					//end code
-					pop		edi
-						pop		esi
-						popf
-				};
-			};
-		};
-	};
-};
-//key word: DARK_OVERPOINT
-//******************************************************************************//
-//******************************************************************************//
-//******************************************************************************//
-//****																		****//
-//****																		****//
-//****				       OVERPOINT   D R A W I N G						****//
-//****																		****//
-//****																		****//
-//******************************************************************************//
-//******************************************************************************//
-//******************************************************************************//
+	GP_ShowMasked( GPB_SHADOW, true, x, y, Pic, CData, Encoder, nullptr );
+}
+
 void GP_ShowMaskedPictOverpoint( int x, int y, GP_Header* Pic, byte* CData, byte* Encoder )
 {
-	x += Pic->dx;
-	y += Pic->dy;
-	int Lx = Pic->Lx;
-	int NLines = Pic->NLines;
-	int ofst = int( Pic ) + 23;
-	int OCNTR = y;
-	if (y + NLines <= WindY || x + Lx <= WindX || x > WindX1 || y > WindY1)return;
-	//vertical clipping
-	//top clipper
-	int CDPOS = int( CData );
-	if (y < WindY)
-	{
-		__asm {
-			mov		ecx, WindY
-			sub		ecx, y
-			sub		NLines, ecx
-			add		y, ecx
-			mov		ebx, ofst
-			xor		eax, eax
-			xor		edx, edx
-			NLINE : mov		al, [ebx]
-					test	al, 128
-					jz		SIMPLE_LINE
-					inc		ebx
-					mov		ah, al
-					and		al, 31
-					or al, al
-					jz		COMPLINE_1
-					and		ah, 32
-					shr		ah, 1
-					COMPLINE_LOOP1:
-			mov		dl, [ebx]
-				shr		dl, 4
-				or dl, ah
-				add		CDPOS, edx
-				inc		ebx
-				dec		al
-				jnz		COMPLINE_LOOP1
-				COMPLINE_1 :
-			xor		eax, eax
-				dec		ecx
-				jnz		NLINE
-				jmp		END_VCLIP
-				SIMPLE_LINE : inc		ebx
-				or eax, eax
-				jz		SIMPLINE_1
-				SIMPLINE_LOOP1 :
-			mov		dl, [ebx + 1]
-				add		CDPOS, edx
-				add		ebx, 2
-				dec		al
-				jnz		SIMPLINE_LOOP1
-				SIMPLINE_1 : dec		ecx
-				jnz		NLINE
-				END_VCLIP : mov		ofst, ebx
-		};
-		OCNTR = WindY;
-	};
-	//bottom clipper
-	if (y + NLines > WindY1)NLines = WindY1 - y + 1;
-	//horisontal clipper
-	int x1 = x + Lx - 1;
-	int scrofs = int( ScreenPtr ) + x + y*ScrWidth;
-	int TEMP1;
-	int LineStart;
-	int CLIP;
-	int CURCLIP;
-	byte SPACE_MASK;
-	byte PIX_MASK;
-	if (x >= WindX&&x1 <= WindX1)
-	{
-		//***********************************************************//
-		//******************(((((((((((())))))))))))*****************//
-		//**                      NO CLIPPING                      **//
-		//******************(((((((((((())))))))))))*****************//
-		//***********************************************************//
-				//no clipping
-		__asm {
-			pushf
-			push	esi
-			push	edi
-			//initialisation
-			mov		edi, scrofs			//edi-screen pointer
-			mov		esi, CDPOS			//esi-points array
-			mov		ebx, Encoder			//ebx-encoding pointer
-			mov		edx, ofst			//edx-mask offset
-			xor		eax, eax
-			xor		ecx, ecx
-			cld
-			sub		edi, ScrWidth
-			mov		LineStart, edi
-			START_SCANLINE :
-			mov		edi, LineStart
-				mov		al, [edx]
-				inc		edx
-				add		edi, ScrWidth
-				or al, al
-				mov		LineStart, edi
-				jnz		DRAW_LINE
-				dec		NLines
-				jnz		START_SCANLINE
-				jmp		END_DRAW_PICTURE
-				DRAW_LINE : test	al, 128
-				jnz		DRAW_COMPLEX_LINE
-				//drawing simple line
-				or al, al
-				jz		NEXT_SEGMENT
-				mov		TEMP1, eax
-				START_SIMPLE_SEGMENT :
-			mov		al, [edx]	//empty space
-				add		edi, eax
-				mov		cl, [edx + 1]
-				add		edx, 2
-				//*****************************************//
-				//put various code with encoding&loop there//
-				//*****************************************//
-				or cl, cl
-				jz		SH0_1
-				mov		eax, OCNTR
-				SH0_0 : add		eax, edi
-				test	al, 1
-				jz		SH0_0A
-				mov		byte ptr[edi], 0
-				SH0_0A : sub		eax, edi
-				inc		edi
-				dec		cl
-				jnz		SH0_0
-				SH0_1 : xor		eax, eax
-				//*****************************************//
-				//          end of variation zone          //
-				//*****************************************//
-				dec		TEMP1
-				jnz		START_SIMPLE_SEGMENT
-				NEXT_SEGMENT :
-			inc     OCNTR
-				dec		NLines
-				jnz		START_SCANLINE
-				jmp		END_DRAW_PICTURE
-				DRAW_COMPLEX_LINE :
-			//complex packed line
-			mov		SPACE_MASK, 0
-				mov		PIX_MASK, 0
-				test	al, 64
-				jz		DCL1
-				mov		SPACE_MASK, 16
-				DCL1:		test	al, 32
-				jz		DCL2
-				mov		PIX_MASK, 16
-				DCL2 : and		al, 31
-				jz		NEXT_SEGMENT
-				mov		TEMP1, eax
-				START_COMPLEX_SEGMENT :
-			mov		al, [edx]
-				mov		cl, al
-				and		al, 15
-				or al, SPACE_MASK
-				add		edi, eax
-				shr		cl, 4
-				or cl, PIX_MASK
-				inc		edx
-				//*****************************************//
-				//put various code with encoding&loop there//
-				//*****************************************//
-				or cl, cl
-				jz		SH1_1
-				mov		eax, OCNTR
-				SH1_0 : add		eax, edi
-				test	al, 1
-				jz		SH1_0A
-				mov		byte ptr[edi], 0
-				SH1_0A : sub		eax, edi
-				inc		edi
-				dec		cl
-				jnz		SH1_0
-				SH1_1 : xor		eax, eax
-				//*****************************************//
-				//          end of variation zone          //
-				//*****************************************//
-				dec		TEMP1
-				jnz		START_COMPLEX_SEGMENT
-				inc     OCNTR
-				dec		NLines
-				jnz		START_SCANLINE
-				END_DRAW_PICTURE :
-			//end code
-			pop		edi
-				pop		esi
-				popf
-		};
-	}
-	else
-	{
-		//image must be clipped
-		if (x < WindX)
-		{
-			//****************************************************************//
-			//****************************************************************//
-			//**                                                            **//
-			//**					clipping LEFT edge						**//
-			//**                                                            **//
-			//****************************************************************//
-			//****************************************************************//
-			CLIP = WindX - x;
-			__asm {
-				pushf
-				push	esi
-				push	edi
-				//initialisation
-				mov		edi, scrofs			//edi-screen pointer
-				mov		esi, CDPOS			//esi-points array
-				mov		ebx, Encoder			//ebx-encoding pointer
-				mov		edx, ofst			//edx-mask offset
-				xor		eax, eax
-				xor		ecx, ecx
-				cld
-				sub		edi, ScrWidth
-				mov		LineStart, edi
-				CLIPLEFT_START_SCANLINE :
-				mov		edi, LineStart
-					mov		al, [edx]
-					inc		edx
-					xchg	CLIP, edx
-					add		edi, ScrWidth
-					mov		CURCLIP, edx
-					or al, al
-					xchg	CLIP, edx
-					mov		LineStart, edi
-					jnz		CLIPLEFT_DRAW_LINE
-					dec		NLines
-					jnz		CLIPLEFT_START_SCANLINE
-					jmp		CLIPLEFT_END_DRAW_PICTURE
-					CLIPLEFT_DRAW_LINE : test	al, 128
-					jnz		CLIPLEFT_DRAW_COMPLEX_LINE
-					//drawing simple line
-					or al, al
-					jz		CLIPLEFT_NEXT_SEGMENT
-					mov		TEMP1, eax
-					CLIPLEFT_START_SIMPLE_SEGMENT :
-				mov		al, [edx]	//empty space
-					add		edi, eax
-					mov		cl, [edx + 1]
-					add		edx, 2
-					sub		CURCLIP, eax
-					jle		CLIPLEFT_DRAW_SIMPLE_SEGMENT
-					cmp		CURCLIP, ecx
-					jl		CLIPLEFT_PARTIAL_SIMPLE
-					//full  clipping
-					sub		CURCLIP, ecx
-					add		esi, ecx
-					add		edi, ecx
-					dec		TEMP1
-					jnz		CLIPLEFT_START_SIMPLE_SEGMENT
-					dec		NLines
-					jnz		CLIPLEFT_START_SCANLINE
-					jmp		CLIPLEFT_END_DRAW_PICTURE
-					CLIPLEFT_PARTIAL_SIMPLE :
-				//partial clipping
-				add		esi, CURCLIP
-					add		edi, CURCLIP
-					sub		ecx, CURCLIP
-					mov		CURCLIP, -1
-					CLIPLEFT_DRAW_SIMPLE_SEGMENT :
-					//*****************************************//
-					//put various code with encoding&loop there//
-					//*****************************************//
-					or cl, cl
-					jz		SH2_1
-					mov		eax, OCNTR
-					SH2_0 : add		eax, edi
-					test	al, 1
-					jz		SH2_0A
-					mov		byte ptr[edi], 0
-					SH2_0A : sub		eax, edi
-					inc		edi
-					dec		cl
-					jnz		SH2_0
-					SH2_1 : xor		eax, eax
-					//*****************************************//
-					//          end of variation zone          //
-					//*****************************************//
-					dec		TEMP1
-					jnz		CLIPLEFT_START_SIMPLE_SEGMENT
-					CLIPLEFT_NEXT_SEGMENT :
-				inc		OCNTR
-					dec		NLines
-					jnz		CLIPLEFT_START_SCANLINE
-					jmp		CLIPLEFT_END_DRAW_PICTURE
-					CLIPLEFT_DRAW_COMPLEX_LINE :
-				//complex packed line
-				mov		SPACE_MASK, 0
-					mov		PIX_MASK, 0
-					test	al, 64
-					jz		CLIPLEFT_DCL1
-					mov		SPACE_MASK, 16
-					CLIPLEFT_DCL1:	test	al, 32
-					jz		CLIPLEFT_DCL2
-					mov		PIX_MASK, 16
-					CLIPLEFT_DCL2 : and		al, 31
-					jz		CLIPLEFT_NEXT_SEGMENT
-					mov		TEMP1, eax
-					CLIPLEFT_START_COMPLEX_SEGMENT :
-				mov		al, [edx]
-					mov		cl, al
-					and		al, 15
-					or al, SPACE_MASK
-					add		edi, eax
-					shr		cl, 4
-					or cl, PIX_MASK
-					inc		edx
-					sub		CURCLIP, eax
-					jle		CLIPLEFT_DRAW_COMPLEX_SEGMENT
-					cmp		CURCLIP, ecx
-					jl		CLIPLEFT_PARTIAL_COMPLEX
-					//full  clipping
-					sub		CURCLIP, ecx
-					add		esi, ecx
-					add		edi, ecx
-					dec		TEMP1
-					jnz		CLIPLEFT_START_COMPLEX_SEGMENT
-					dec		NLines
-					jnz		CLIPLEFT_START_SCANLINE
-					jmp		CLIPLEFT_END_DRAW_PICTURE
-					CLIPLEFT_PARTIAL_COMPLEX :
-				//partial clipping
-				add		esi, CURCLIP
-					add		edi, CURCLIP
-					sub		ecx, CURCLIP
-					mov		CURCLIP, -1
-					CLIPLEFT_DRAW_COMPLEX_SEGMENT :
-					//*****************************************//
-					//put various code with encoding&loop there//
-					//*****************************************//
-					or cl, cl
-					jz		SH3_1
-					mov		eax, OCNTR
-					SH3_0 : add		eax, edi
-					test	al, 1
-					jz		SH3_0A
-					mov[edi], 0
-					SH3_0A : sub		eax, edi
-					inc		edi
-					dec		cl
-					jnz		SH3_0
-					SH3_1 : xor		eax, eax
-					//*****************************************//
-					//          end of variation zone          //
-					//*****************************************//
-					dec		TEMP1
-					jnz		CLIPLEFT_START_COMPLEX_SEGMENT
-					inc     OCNTR
-					dec		NLines
-					jnz		CLIPLEFT_START_SCANLINE
-					CLIPLEFT_END_DRAW_PICTURE :
-				//end code
-				pop		edi
-					pop		esi
-					popf
-			};
-		}
-		else
-		{
-			if (x1 > WindX1)
-			{
-				//****************************************************************//
-				//****************************************************************//
-				//**      **     **                                **    **     **//
-				//****************   	clipping RIGHT edge			**************//
-				//**      **     **                                **    **     **//
-				//****************************************************************//
-				//****************************************************************//
-				CLIP = WindX1 - x + 1;
-				int ADDESI;
-				__asm {
-					pushf
-					push	esi
-					push	edi
-					//initialisation
-					mov		edi, scrofs			//edi-screen pointer
-					mov		esi, CDPOS			//esi-points array
-					mov		ebx, Encoder			//ebx-encoding pointer
-					mov		edx, ofst			//edx-mask offset
-					xor		eax, eax
-					xor		ecx, ecx
-					cld
-					sub		edi, ScrWidth
-					mov		LineStart, edi
-					CLIPRIGHT_START_SCANLINE :
-					mov		edi, LineStart
-						mov		al, [edx]
-						inc		edx
-						mov		ADDESI, 0
-						xchg	CLIP, edx
-						add		edi, ScrWidth
-						mov		CURCLIP, edx
-						or al, al
-						xchg	CLIP, edx
-						mov		LineStart, edi
-						jnz		CLIPRIGHT_DRAW_LINE
-						dec		NLines
-						jnz		CLIPRIGHT_START_SCANLINE
-						jmp		CLIPRIGHT_END_DRAW_PICTURE
-						CLIPRIGHT_DRAW_LINE :
-					test	al, 128
-						jnz		CLIPRIGHT_DRAW_COMPLEX_LINE
-						//drawing simple line
-						or al, al
-						jz		CLIPRIGHT_NEXT_SEGMENT
-						mov		TEMP1, eax
-						CLIPRIGHT_START_SIMPLE_SEGMENT :
-					mov		al, [edx]	//empty space
-						add		edi, eax
-						mov		cl, [edx + 1]
-						add		edx, 2
-						sub		CURCLIP, eax
-						jg		CLIPRIGHT_TRY_TO_CLIP
-						//full clipping until the end of line
-						add		esi, ecx
-						dec		TEMP1
-						jnz		CLIPRIGHT_START_SIMPLE_SEGMENT
-						dec		NLines
-						jnz		CLIPRIGHT_START_SCANLINE
-						jmp		CLIPRIGHT_END_DRAW_PICTURE
-						CLIPRIGHT_TRY_TO_CLIP :
-					cmp		CURCLIP, ecx
-						jl		CLIPRIGHT_PARTIAL_SIMPLE
-						sub		CURCLIP, ecx
-						jmp		CLIPRIGHT_DRAW_SIMPLE_SEGMENT
-						CLIPRIGHT_PARTIAL_SIMPLE :
-					//partial clipping
-					sub		ecx, CURCLIP
-						mov		ADDESI, ecx
-						mov		ecx, CURCLIP
-						mov		CURCLIP, -1
-						CLIPRIGHT_DRAW_SIMPLE_SEGMENT :
-						//*****************************************//
-						//put various code with encoding&loop there//
-						//*****************************************//
-						or cl, cl
-						jz		SH4_1
-						mov		eax, OCNTR
-						SH4_0 : add		eax, edi
-						test	al, 1
-						jz		SH4_0A
-						mov		byte ptr[edi], 0
-						SH4_0A : sub		eax, edi
-						inc		edi
-						dec		cl
-						jnz		SH4_0
-						SH4_1 : xor		eax, eax
-						//*****************************************//
-						//          end of variation zone          //
-						//*****************************************//
-						add		esi, ADDESI
-						inc		OCNTR
-						dec		TEMP1
-						jnz		CLIPRIGHT_START_SIMPLE_SEGMENT
-						CLIPRIGHT_NEXT_SEGMENT :
-					dec		NLines
-						jnz		CLIPRIGHT_START_SCANLINE
-						jmp		CLIPRIGHT_END_DRAW_PICTURE
-						CLIPRIGHT_DRAW_COMPLEX_LINE :
-					//complex packed line
-					mov		SPACE_MASK, 0
-						mov		PIX_MASK, 0
-						test	al, 64
-						jz		CLIPRIGHT_DCL1
-						mov		SPACE_MASK, 16
-						CLIPRIGHT_DCL1:		test	al, 32
-						jz		CLIPRIGHT_DCL2
-						mov		PIX_MASK, 16
-						CLIPRIGHT_DCL2 : and		al, 31
-						jz		CLIPRIGHT_NEXT_SEGMENT
-						mov		TEMP1, eax
-						CLIPRIGHT_START_COMPLEX_SEGMENT :
-					mov		al, [edx]
-						mov		cl, al
-						and		al, 15
-						or al, SPACE_MASK
-						add		edi, eax
-						shr		cl, 4
-						or cl, PIX_MASK
-						inc		edx
-						sub		CURCLIP, eax
-						jg		CLIPRIGHT_TRY_TO_CLIP_COMPLEX
-						//full clipping until the end of line
-						add		esi, ecx
-						dec		TEMP1
-						jnz		CLIPRIGHT_START_COMPLEX_SEGMENT
-						dec		NLines
-						jnz		CLIPRIGHT_START_SCANLINE
-						jmp		CLIPRIGHT_END_DRAW_PICTURE
-						CLIPRIGHT_TRY_TO_CLIP_COMPLEX :
-					cmp		CURCLIP, ecx
-						jl		CLIPRIGHT_PARTIAL_COMPLEX
-						sub		CURCLIP, ecx
-						jmp		CLIPRIGHT_DRAW_COMPLEX_SEGMENT
-						CLIPRIGHT_PARTIAL_COMPLEX :
-					//partial clipping
-					sub		ecx, CURCLIP
-						mov		ADDESI, ecx
-						mov		ecx, CURCLIP
-						mov		CURCLIP, -1
-						CLIPRIGHT_DRAW_COMPLEX_SEGMENT :
-						//*****************************************//
-						//put various code with encoding&loop there//
-						//*****************************************//
-						or cl, cl
-						jz		SH5_1
-						mov		eax, OCNTR
-						SH5_0 : add		eax, edi
-						test	al, 1
-						jz		SH5_0A
-						mov		byte ptr[edi], 0
-						SH5_0A : sub		eax, edi
-						inc		edi
-						dec		cl
-						jnz		SH5_0
-						SH5_1 : xor		eax, eax
-						//*****************************************//
-						//          end of variation zone          //
-						//*****************************************//
-						add		esi, ADDESI
-						dec		TEMP1
-						jnz		CLIPRIGHT_START_COMPLEX_SEGMENT
-						inc		OCNTR
-						dec		NLines
-						jnz		CLIPRIGHT_START_SCANLINE
-						CLIPRIGHT_END_DRAW_PICTURE :
-					//end code
-					pop		edi
-						pop		esi
-						popf
-				};
-			};
-		};
-	};
-};
+	GP_ShowMasked( GPB_OVERPOINT, false, x, y, Pic, CData, Encoder, nullptr );
+}
+
+//The inverted overpoint blitter has always drawn a plain shadow
 void GP_ShowMaskedPictOverpointInv( int x, int y, GP_Header* Pic, byte* CData, byte* Encoder )
 {
-	x -= Pic->dx;
-	y += Pic->dy;
-	int Lx = Pic->Lx;
-	int NLines = Pic->NLines;
-	int ofst = int( Pic ) + 23;
-	if (y + NLines <= WindY || x - Lx >= WindX1 || x<WindX || y>WindY1)return;
-	//vertical clipping
-	//top clipper
-	int CDPOS = int( CData );
-	if (y < WindY)
-	{
-		__asm {
-			mov		ecx, WindY
-			sub		ecx, y
-			sub		NLines, ecx
-			add		y, ecx
-			mov		ebx, ofst
-			xor		eax, eax
-			xor		edx, edx
-			NLINE : mov		al, [ebx]
-					test	al, 128
-					jz		SIMPLE_LINE
-					inc		ebx
-					mov		ah, al
-					and		al, 31
-					or al, al
-					jz		COMPLINE_1
-					and		ah, 32
-					shr		ah, 1
-					COMPLINE_LOOP1:
-			mov		dl, [ebx]
-				shr		dl, 4
-				or dl, ah
-				add		CDPOS, edx
-				inc		ebx
-				dec		al
-				jnz		COMPLINE_LOOP1
-				COMPLINE_1 :
-			xor		eax, eax
-				dec		ecx
-				jnz		NLINE
-				jmp		END_VCLIP
-				SIMPLE_LINE : inc		ebx
-				or eax, eax
-				jz		SIMPLINE_1
-				SIMPLINE_LOOP1 :
-			mov		dl, [ebx + 1]
-				add		CDPOS, edx
-				add		ebx, 2
-				dec		al
-				jnz		SIMPLINE_LOOP1
-				SIMPLINE_1 : dec		ecx
-				jnz		NLINE
-				END_VCLIP : mov		ofst, ebx
-		};
-	};
-	//bottom clipper
-	if (y + NLines > WindY1)NLines = WindY1 - y + 1;
-	//horisontal clipper
-	int x1 = x - Lx + 1;
-	int scrofs = int( ScreenPtr ) + x + y*ScrWidth;
-	int TEMP1;
-	int LineStart;
-	int CLIP;
-	int CURCLIP;
-	byte SPACE_MASK;
-	byte PIX_MASK;
-	if (x1 >= WindX&&x <= WindX1)
-	{
-		//***********************************************************//
-		//******************(((((((((((())))))))))))*****************//
-		//**                      NO CLIPPING                      **//INVERTED
-		//******************(((((((((((())))))))))))*****************//
-		//***********************************************************//
-				//no clipping
-		__asm {
-			pushf
-			push	esi
-			push	edi
-			//initialisation
-			mov		edi, scrofs			//edi-screen pointer
-			mov		esi, CDPOS			//esi-points array
-			mov		ebx, Encoder			//ebx-encoding pointer
-			mov		edx, ofst			//edx-mask offset
-			xor		eax, eax
-			xor		ecx, ecx
-			cld
-			sub		edi, ScrWidth
-			mov		LineStart, edi
-			START_SCANLINE :
-			mov		edi, LineStart
-				mov		al, [edx]
-				inc		edx
-				add		edi, ScrWidth
-				or al, al
-				mov		LineStart, edi
-				jnz		DRAW_LINE
-				dec		NLines
-				jnz		START_SCANLINE
-				jmp		END_DRAW_PICTURE
-				DRAW_LINE : test	al, 128
-				jnz		DRAW_COMPLEX_LINE
-				//drawing simple line
-				or al, al
-				jz		NEXT_SEGMENT
-				mov		TEMP1, eax
-				START_SIMPLE_SEGMENT :
-			mov		al, [edx]	//empty space
-				sub		edi, eax
-				mov		cl, [edx + 1]
-				add		edx, 2
-				//*****************************************//
-				//put various code with encoding&loop there//INVERTED
-				//*****************************************//
-				or cl, cl
-				jz		SH0_1
-				xor		eax, eax
-				SH0_0 : mov		al, [edi]
-				mov		al, [ebx + eax]
-				mov[edi], al
-				dec		edi
-				dec		cl
-				jnz		SH0_0
-				SH0_1 :
-			//*****************************************//
-			//          end of variation zone          //INVERTED
-			//*****************************************//
-			dec		TEMP1
-				jnz		START_SIMPLE_SEGMENT
-				NEXT_SEGMENT :
-			dec		NLines
-				jnz		START_SCANLINE
-				jmp		END_DRAW_PICTURE
-				DRAW_COMPLEX_LINE :
-			//complex packed line
-			mov		SPACE_MASK, 0
-				mov		PIX_MASK, 0
-				test	al, 64
-				jz		DCL1
-				mov		SPACE_MASK, 16
-				DCL1:		test	al, 32
-				jz		DCL2
-				mov		PIX_MASK, 16
-				DCL2 : and		al, 31
-				jz		NEXT_SEGMENT
-				mov		TEMP1, eax
-				START_COMPLEX_SEGMENT :
-			mov		al, [edx]
-				mov		cl, al
-				and		al, 15
-				or al, SPACE_MASK
-				sub		edi, eax
-				shr		cl, 4
-				or cl, PIX_MASK
-				inc		edx
-				//*****************************************//
-				//put various code with encoding&loop there//INVERTED
-				//*****************************************//
-				or cl, cl
-				jz		SH1_1
-				xor		eax, eax
-				SH1_0 : mov		al, [edi]
-				mov		al, [ebx + eax]
-				mov[edi], al
-				dec		edi
-				dec		cl
-				jnz		SH1_0
-				SH1_1 :
-			//*****************************************//
-			//          end of variation zone          //INVERTED
-			//*****************************************//
-			dec		TEMP1
-				jnz		START_COMPLEX_SEGMENT
-				dec		NLines
-				jnz		START_SCANLINE
-				END_DRAW_PICTURE :
-			//end code
-			pop		edi
-				pop		esi
-				popf
-		};
-	}
-	else
-	{
-		//image must be clipped
-		if (x > WindX1)
-		{
-			//****************************************************************//
-			//****************************************************************//
-			//**                                                            **//
-			//**					clipping RIGT(old-LEFT) edge						**//INVERTED
-			//**                                                            **//
-			//****************************************************************//
-			//****************************************************************//
-			CLIP = x - WindX1;
-			__asm {
-				pushf
-				push	esi
-				push	edi
-				//initialisation
-				mov		edi, scrofs			//edi-screen pointer
-				mov		esi, CDPOS			//esi-points array
-				mov		ebx, Encoder			//ebx-encoding pointer
-				mov		edx, ofst			//edx-mask offset
-				xor		eax, eax
-				xor		ecx, ecx
-				cld
-				sub		edi, ScrWidth
-				mov		LineStart, edi
-				CLIPLEFT_START_SCANLINE :
-				mov		edi, LineStart
-					mov		al, [edx]
-					inc		edx
-					xchg	CLIP, edx
-					add		edi, ScrWidth
-					mov		CURCLIP, edx
-					or al, al
-					xchg	CLIP, edx
-					mov		LineStart, edi
-					jnz		CLIPLEFT_DRAW_LINE
-					dec		NLines
-					jnz		CLIPLEFT_START_SCANLINE
-					jmp		CLIPLEFT_END_DRAW_PICTURE
-					CLIPLEFT_DRAW_LINE : test	al, 128
-					jnz		CLIPLEFT_DRAW_COMPLEX_LINE
-					//drawing simple line
-					or al, al
-					jz		CLIPLEFT_NEXT_SEGMENT
-					mov		TEMP1, eax
-					CLIPLEFT_START_SIMPLE_SEGMENT :
-				mov		al, [edx]	//empty space
-					sub		edi, eax
-					mov		cl, [edx + 1]
-					add		edx, 2
-					sub		CURCLIP, eax
-					jle		CLIPLEFT_DRAW_SIMPLE_SEGMENT
-					cmp		CURCLIP, ecx
-					jl		CLIPLEFT_PARTIAL_SIMPLE
-					//full  clipping
-					sub		CURCLIP, ecx
-					add		esi, ecx
-					sub		edi, ecx
-					dec		TEMP1
-					jnz		CLIPLEFT_START_SIMPLE_SEGMENT
-					dec		NLines
-					jnz		CLIPLEFT_START_SCANLINE
-					jmp		CLIPLEFT_END_DRAW_PICTURE
-					CLIPLEFT_PARTIAL_SIMPLE :
-				//partial clipping
-				add		esi, CURCLIP
-					sub		edi, CURCLIP
-					sub		ecx, CURCLIP
-					mov		CURCLIP, -1
-					CLIPLEFT_DRAW_SIMPLE_SEGMENT :
-					//*****************************************//
-					//put various code with encoding&loop there//INVERTED
-					//*****************************************//
-					or cl, cl
-					jz		SH2_1
-					xor		eax, eax
-					SH2_0 : mov		al, [edi]
-					mov		al, [ebx + eax]
-					mov[edi], al
-					dec		edi
-					dec		cl
-					jnz		SH2_0
-					SH2_1 :
-				//*****************************************//
-				//          end of variation zone          //INVERTED
-				//*****************************************//
-				dec		TEMP1
-					jnz		CLIPLEFT_START_SIMPLE_SEGMENT
-					CLIPLEFT_NEXT_SEGMENT :
-				dec		NLines
-					jnz		CLIPLEFT_START_SCANLINE
-					jmp		CLIPLEFT_END_DRAW_PICTURE
-					CLIPLEFT_DRAW_COMPLEX_LINE :
-				//complex packed line
-				mov		SPACE_MASK, 0
-					mov		PIX_MASK, 0
-					test	al, 64
-					jz		CLIPLEFT_DCL1
-					mov		SPACE_MASK, 16
-					CLIPLEFT_DCL1:	test	al, 32
-					jz		CLIPLEFT_DCL2
-					mov		PIX_MASK, 16
-					CLIPLEFT_DCL2 : and		al, 31
-					jz		CLIPLEFT_NEXT_SEGMENT
-					mov		TEMP1, eax
-					CLIPLEFT_START_COMPLEX_SEGMENT :
-				mov		al, [edx]
-					mov		cl, al
-					and		al, 15
-					or al, SPACE_MASK
-					sub		edi, eax
-					shr		cl, 4
-					or cl, PIX_MASK
-					inc		edx
-					sub		CURCLIP, eax
-					jle		CLIPLEFT_DRAW_COMPLEX_SEGMENT
-					cmp		CURCLIP, ecx
-					jl		CLIPLEFT_PARTIAL_COMPLEX
-					//full  clipping
-					sub		CURCLIP, ecx
-					add		esi, ecx
-					sub		edi, ecx
-					dec		TEMP1
-					jnz		CLIPLEFT_START_COMPLEX_SEGMENT
-					dec		NLines
-					jnz		CLIPLEFT_START_SCANLINE
-					jmp		CLIPLEFT_END_DRAW_PICTURE
-					CLIPLEFT_PARTIAL_COMPLEX :
-				//partial clipping
-				add		esi, CURCLIP
-					sub		edi, CURCLIP
-					sub		ecx, CURCLIP
-					mov		CURCLIP, -1
-					CLIPLEFT_DRAW_COMPLEX_SEGMENT :
-					//*****************************************//
-					//put various code with encoding&loop there//INVERTED
-					//*****************************************//
-					or cl, cl
-					jz		SH3_1
-					xor		eax, eax
-					SH3_0 : mov		al, [edi]
-					mov		al, [ebx + eax]
-					mov[edi], al
-					dec		edi
-					dec		cl
-					jnz		SH3_0
-					SH3_1 :
-				//*****************************************//
-				//          end of variation zone          //INVERTED
-				//*****************************************//
-				dec		TEMP1
-					jnz		CLIPLEFT_START_COMPLEX_SEGMENT
-					dec		NLines
-					jnz		CLIPLEFT_START_SCANLINE
-					CLIPLEFT_END_DRAW_PICTURE :
-				//end code
-				pop		edi
-					pop		esi
-					popf
-			};
-		}
-		else
-		{
-			if (x1 < WindX1)
-			{
-				//****************************************************************//
-				//****************************************************************//
-				//**      **     **                                **    **     **//
-				//****************   clipping LEFT(old-RIGHT) edge  **************//INVERTED
-				//**      **     **                                **    **     **//
-				//****************************************************************//
-				//****************************************************************//
-				CLIP = x - WindX + 1;
-				int ADDESI;
-				__asm {
-					pushf
-					push	esi
-					push	edi
-					//initialisation
-					mov		edi, scrofs			//edi-screen pointer
-					mov		esi, CDPOS			//esi-points array
-					mov		ebx, Encoder			//ebx-encoding pointer
-					mov		edx, ofst			//edx-mask offset
-					xor		eax, eax
-					xor		ecx, ecx
-					cld
-					sub		edi, ScrWidth
-					mov		LineStart, edi
-					CLIPRIGHT_START_SCANLINE :
-					mov		edi, LineStart
-						mov		al, [edx]
-						inc		edx
-						mov		ADDESI, 0
-						xchg	CLIP, edx
-						add		edi, ScrWidth
-						mov		CURCLIP, edx
-						or al, al
-						xchg	CLIP, edx
-						mov		LineStart, edi
-						jnz		CLIPRIGHT_DRAW_LINE
-						dec		NLines
-						jnz		CLIPRIGHT_START_SCANLINE
-						jmp		CLIPRIGHT_END_DRAW_PICTURE
-						CLIPRIGHT_DRAW_LINE :
-					test	al, 128
-						jnz		CLIPRIGHT_DRAW_COMPLEX_LINE
-						//drawing simple line
-						or al, al
-						jz		CLIPRIGHT_NEXT_SEGMENT
-						mov		TEMP1, eax
-						CLIPRIGHT_START_SIMPLE_SEGMENT :
-					mov		al, [edx]	//empty space
-						sub		edi, eax
-						mov		cl, [edx + 1]
-						add		edx, 2
-						sub		CURCLIP, eax
-						jg		CLIPRIGHT_TRY_TO_CLIP
-						//full clipping until the end of line
-						add		esi, ecx
-						dec		TEMP1
-						jnz		CLIPRIGHT_START_SIMPLE_SEGMENT
-						dec		NLines
-						jnz		CLIPRIGHT_START_SCANLINE
-						jmp		CLIPRIGHT_END_DRAW_PICTURE
-						CLIPRIGHT_TRY_TO_CLIP :
-					cmp		CURCLIP, ecx
-						jl		CLIPRIGHT_PARTIAL_SIMPLE
-						sub		CURCLIP, ecx
-						jmp		CLIPRIGHT_DRAW_SIMPLE_SEGMENT
-						CLIPRIGHT_PARTIAL_SIMPLE :
-					//partial clipping
-					sub		ecx, CURCLIP
-						mov		ADDESI, ecx
-						mov		ecx, CURCLIP
-						mov		CURCLIP, -1
-						CLIPRIGHT_DRAW_SIMPLE_SEGMENT :
-						//*****************************************//
-						//put various code with encoding&loop there//INVERTED
-						//*****************************************//
-						or cl, cl
-						jz		SH4_1
-						xor		eax, eax
-						SH4_0 : mov		al, [edi]
-						mov		al, [ebx + eax]
-						mov[edi], al
-						dec		edi
-						dec		cl
-						jnz		SH4_0
-						SH4_1 :
-					//*****************************************//
-					//          end of variation zone          //INVERTED
-					//*****************************************//
-					add		esi, ADDESI
-						dec		TEMP1
-						jnz		CLIPRIGHT_START_SIMPLE_SEGMENT
-						CLIPRIGHT_NEXT_SEGMENT :
-					dec		NLines
-						jnz		CLIPRIGHT_START_SCANLINE
-						jmp		CLIPRIGHT_END_DRAW_PICTURE
-						CLIPRIGHT_DRAW_COMPLEX_LINE :
-					//complex packed line
-					mov		SPACE_MASK, 0
-						mov		PIX_MASK, 0
-						test	al, 64
-						jz		CLIPRIGHT_DCL1
-						mov		SPACE_MASK, 16
-						CLIPRIGHT_DCL1:		test	al, 32
-						jz		CLIPRIGHT_DCL2
-						mov		PIX_MASK, 16
-						CLIPRIGHT_DCL2 : and		al, 31
-						jz		CLIPRIGHT_NEXT_SEGMENT
-						mov		TEMP1, eax
-						CLIPRIGHT_START_COMPLEX_SEGMENT :
-					mov		al, [edx]
-						mov		cl, al
-						and		al, 15
-						or al, SPACE_MASK
-						sub		edi, eax
-						shr		cl, 4
-						or cl, PIX_MASK
-						inc		edx
-						sub		CURCLIP, eax
-						jg		CLIPRIGHT_TRY_TO_CLIP_COMPLEX
-						//full clipping until the end of line
-						add		esi, ecx
-						dec		TEMP1
-						jnz		CLIPRIGHT_START_COMPLEX_SEGMENT
-						dec		NLines
-						jnz		CLIPRIGHT_START_SCANLINE
-						jmp		CLIPRIGHT_END_DRAW_PICTURE
-						CLIPRIGHT_TRY_TO_CLIP_COMPLEX :
-					cmp		CURCLIP, ecx
-						jl		CLIPRIGHT_PARTIAL_COMPLEX
-						sub		CURCLIP, ecx
-						jmp		CLIPRIGHT_DRAW_COMPLEX_SEGMENT
-						CLIPRIGHT_PARTIAL_COMPLEX :
-					//partial clipping
-					sub		ecx, CURCLIP
-						mov		ADDESI, ecx
-						mov		ecx, CURCLIP
-						mov		CURCLIP, -1
-						CLIPRIGHT_DRAW_COMPLEX_SEGMENT :
-						//*****************************************//
-						//put various code with encoding&loop there//INVERTED
-						//*****************************************//
-						or cl, cl
-						jz		SH5_1
-						xor		eax, eax
-						SH5_0 : mov		al, [edi]
-						mov		al, [ebx + eax]
-						mov[edi], al
-						dec		edi
-						dec		cl
-						jnz		SH5_0
-						SH5_1 :
-					//*****************************************//
-					//          end of variation zone          //INVERTED
-					//*****************************************//
-					add		esi, ADDESI
-						dec		TEMP1
-						jnz		CLIPRIGHT_START_COMPLEX_SEGMENT
-						dec		NLines
-						jnz		CLIPRIGHT_START_SCANLINE
-						CLIPRIGHT_END_DRAW_PICTURE :
-					//end code
-					pop		edi
-						pop		esi
-						popf
-				};
-			};
-		};
-	};
-};
+	GP_ShowMasked( GPB_SHADOW, true, x, y, Pic, CData, Encoder, nullptr );
+}
 
-//key word: PALDRAW
-//******************************************************************************//
-//******************************************************************************//
-//******************************************************************************//
-//****																		****//
-//****																		****//
-//****						PALETTED IMAGE  DRAWING							****//
-//****																		****//
-//****																		****//
-//******************************************************************************//
-//******************************************************************************//
-//******************************************************************************//
 void GP_ShowMaskedPalPict( int x, int y, GP_Header* Pic, byte* CData, byte* Encoder )
 {
-	x += Pic->dx;
-	y += Pic->dy;
-	int Lx = Pic->Lx;
-	int NLines = Pic->NLines;
-	int ofst = int( Pic ) + 23;
-	if (y + NLines <= WindY || x + Lx <= WindX || x > WindX1 || y > WindY1)return;
-	//vertical clipping
-	//top clipper
-	int CDPOS = int( CData );
-	if (y < WindY)
-	{
-		__asm {
-			mov		ecx, WindY
-			sub		ecx, y
-			sub		NLines, ecx
-			add		y, ecx
-			mov		ebx, ofst
-			xor		eax, eax
-			xor		edx, edx
-			NLINE : mov		al, [ebx]
-					test	al, 128
-					jz		SIMPLE_LINE
-					inc		ebx
-					mov		ah, al
-					and		al, 31
-					or al, al
-					jz		COMPLINE_1
-					and		ah, 32
-					shr		ah, 1
-					COMPLINE_LOOP1:
-			mov		dl, [ebx]
-				shr		dl, 4
-				or dl, ah
-				add		CDPOS, edx
-				inc		ebx
-				dec		al
-				jnz		COMPLINE_LOOP1
-				COMPLINE_1 :
-			xor		eax, eax
-				dec		ecx
-				jnz		NLINE
-				jmp		END_VCLIP
-				SIMPLE_LINE : inc		ebx
-				or eax, eax
-				jz		SIMPLINE_1
-				SIMPLINE_LOOP1 :
-			mov		dl, [ebx + 1]
-				add		CDPOS, edx
-				add		ebx, 2
-				dec		al
-				jnz		SIMPLINE_LOOP1
-				SIMPLINE_1 : dec		ecx
-				jnz		NLINE
-				END_VCLIP : mov		ofst, ebx
-		};
-	};
-	//bottom clipper
-	if (y + NLines > WindY1)NLines = WindY1 - y + 1;
-	//horisontal clipper
-	int x1 = x + Lx - 1;
-	int scrofs = int( ScreenPtr ) + x + y*ScrWidth;
-	int TEMP1;
-	int LineStart;
-	int CLIP;
-	int CURCLIP;
-	byte SPACE_MASK;
-	byte PIX_MASK;
-	if (x >= WindX&&x1 <= WindX1)
-	{
-		//***********************************************************//
-		//******************(((((((((((())))))))))))*****************//
-		//**                      NO CLIPPING                      **//
-		//******************(((((((((((())))))))))))*****************//
-		//***********************************************************//
-				//no clipping
-		__asm {
-			pushf
-			push	esi
-			push	edi
-			//initialisation
-			mov		edi, scrofs			//edi-screen pointer
-			mov		esi, CDPOS			//esi-points array
-			mov		ebx, Encoder			//ebx-encoding pointer
-			mov		edx, ofst			//edx-mask offset
-			xor		eax, eax
-			xor		ecx, ecx
-			cld
-			sub		edi, ScrWidth
-			mov		LineStart, edi
-			START_SCANLINE :
-			mov		edi, LineStart
-				mov		al, [edx]
-				inc		edx
-				add		edi, ScrWidth
-				or al, al
-				mov		LineStart, edi
-				jnz		DRAW_LINE
-				dec		NLines
-				jnz		START_SCANLINE
-				jmp		END_DRAW_PICTURE
-				DRAW_LINE : test	al, 128
-				jnz		DRAW_COMPLEX_LINE
-				//drawing simple line
-				or al, al
-				jz		NEXT_SEGMENT
-				mov		TEMP1, eax
-				START_SIMPLE_SEGMENT :
-			mov		al, [edx]	//empty space
-				add		edi, eax
-				mov		cl, [edx + 1]
-				add		edx, 2
-				//*****************************************//
-				//put various code with encoding&loop there//
-				//*****************************************//
-				or cl, cl
-				jz		PAL0_1
-				xor		eax, eax
-				PAL0_0 : lodsb
-				mov		al, [ebx + eax]
-				stosb
-				dec		cl
-				jnz		PAL0_0
-				PAL0_1 :
-			//*****************************************//
-			//          end of variation zone          //
-			//*****************************************//
-			dec		TEMP1
-				jnz		START_SIMPLE_SEGMENT
-				NEXT_SEGMENT :
-			dec		NLines
-				jnz		START_SCANLINE
-				jmp		END_DRAW_PICTURE
-				DRAW_COMPLEX_LINE :
-			//complex packed line
-			mov		SPACE_MASK, 0
-				mov		PIX_MASK, 0
-				test	al, 64
-				jz		DCL1
-				mov		SPACE_MASK, 16
-				DCL1:		test	al, 32
-				jz		DCL2
-				mov		PIX_MASK, 16
-				DCL2 : and		al, 31
-				jz		NEXT_SEGMENT
-				mov		TEMP1, eax
-				START_COMPLEX_SEGMENT :
-			mov		al, [edx]
-				mov		cl, al
-				and		al, 15
-				or al, SPACE_MASK
-				add		edi, eax
-				shr		cl, 4
-				or cl, PIX_MASK
-				inc		edx
-				//*****************************************//
-				//put various code with encoding&loop there//
-				//*****************************************//
-				or cl, cl
-				jz		PAL1_1
-				xor		eax, eax
-				PAL1_0 : lodsb
-				mov		al, [ebx + eax]
-				stosb
-				dec		cl
-				jnz		PAL1_0
-				PAL1_1 :
-			//*****************************************//
-			//          end of variation zone          //
-			//*****************************************//
-			dec		TEMP1
-				jnz		START_COMPLEX_SEGMENT
-				dec		NLines
-				jnz		START_SCANLINE
-				END_DRAW_PICTURE :
-			//end code
-			pop		edi
-				pop		esi
-				popf
-		};
-	}
-	else
-	{
-		//image must be clipped
-		if (x < WindX)
-		{
-			//****************************************************************//
-			//****************************************************************//
-			//**                                                            **//
-			//**					clipping LEFT edge						**//
-			//**                                                            **//
-			//****************************************************************//
-			//****************************************************************//
-			CLIP = WindX - x;
-			__asm {
-				pushf
-				push	esi
-				push	edi
-				//initialisation
-				mov		edi, scrofs			//edi-screen pointer
-				mov		esi, CDPOS			//esi-points array
-				mov		ebx, Encoder			//ebx-encoding pointer
-				mov		edx, ofst			//edx-mask offset
-				xor		eax, eax
-				xor		ecx, ecx
-				cld
-				sub		edi, ScrWidth
-				mov		LineStart, edi
-				CLIPLEFT_START_SCANLINE :
-				mov		edi, LineStart
-					mov		al, [edx]
-					inc		edx
-					xchg	CLIP, edx
-					add		edi, ScrWidth
-					mov		CURCLIP, edx
-					or al, al
-					xchg	CLIP, edx
-					mov		LineStart, edi
-					jnz		CLIPLEFT_DRAW_LINE
-					dec		NLines
-					jnz		CLIPLEFT_START_SCANLINE
-					jmp		CLIPLEFT_END_DRAW_PICTURE
-					CLIPLEFT_DRAW_LINE : test	al, 128
-					jnz		CLIPLEFT_DRAW_COMPLEX_LINE
-					//drawing simple line
-					or al, al
-					jz		CLIPLEFT_NEXT_SEGMENT
-					mov		TEMP1, eax
-					CLIPLEFT_START_SIMPLE_SEGMENT :
-				mov		al, [edx]	//empty space
-					add		edi, eax
-					mov		cl, [edx + 1]
-					add		edx, 2
-					sub		CURCLIP, eax
-					jle		CLIPLEFT_DRAW_SIMPLE_SEGMENT
-					cmp		CURCLIP, ecx
-					jl		CLIPLEFT_PARTIAL_SIMPLE
-					//full  clipping
-					sub		CURCLIP, ecx
-					add		esi, ecx
-					add		edi, ecx
-					dec		TEMP1
-					jnz		CLIPLEFT_START_SIMPLE_SEGMENT
-					dec		NLines
-					jnz		CLIPLEFT_START_SCANLINE
-					jmp		CLIPLEFT_END_DRAW_PICTURE
-					CLIPLEFT_PARTIAL_SIMPLE :
-				//partial clipping
-				add		esi, CURCLIP
-					add		edi, CURCLIP
-					sub		ecx, CURCLIP
-					mov		CURCLIP, -1
-					CLIPLEFT_DRAW_SIMPLE_SEGMENT :
-					//*****************************************//
-					//put various code with encoding&loop there//
-					//*****************************************//
-					or cl, cl
-					jz		PAL2_1
-					xor		eax, eax
-					PAL2_0 : lodsb
-					mov		al, [ebx + eax]
-					stosb
-					dec		cl
-					jnz		PAL2_0
-					PAL2_1 :
-				//*****************************************//
-				//          end of variation zone          //
-				//*****************************************//
-				dec		TEMP1
-					jnz		CLIPLEFT_START_SIMPLE_SEGMENT
-					CLIPLEFT_NEXT_SEGMENT :
-				dec		NLines
-					jnz		CLIPLEFT_START_SCANLINE
-					jmp		CLIPLEFT_END_DRAW_PICTURE
-					CLIPLEFT_DRAW_COMPLEX_LINE :
-				//complex packed line
-				mov		SPACE_MASK, 0
-					mov		PIX_MASK, 0
-					test	al, 64
-					jz		CLIPLEFT_DCL1
-					mov		SPACE_MASK, 16
-					CLIPLEFT_DCL1:	test	al, 32
-					jz		CLIPLEFT_DCL2
-					mov		PIX_MASK, 16
-					CLIPLEFT_DCL2 : and		al, 31
-					jz		CLIPLEFT_NEXT_SEGMENT
-					mov		TEMP1, eax
-					CLIPLEFT_START_COMPLEX_SEGMENT :
-				mov		al, [edx]
-					mov		cl, al
-					and		al, 15
-					or al, SPACE_MASK
-					add		edi, eax
-					shr		cl, 4
-					or cl, PIX_MASK
-					inc		edx
-					sub		CURCLIP, eax
-					jle		CLIPLEFT_DRAW_COMPLEX_SEGMENT
-					cmp		CURCLIP, ecx
-					jl		CLIPLEFT_PARTIAL_COMPLEX
-					//full  clipping
-					sub		CURCLIP, ecx
-					add		esi, ecx
-					add		edi, ecx
-					dec		TEMP1
-					jnz		CLIPLEFT_START_COMPLEX_SEGMENT
-					dec		NLines
-					jnz		CLIPLEFT_START_SCANLINE
-					jmp		CLIPLEFT_END_DRAW_PICTURE
-					CLIPLEFT_PARTIAL_COMPLEX :
-				//partial clipping
-				add		esi, CURCLIP
-					add		edi, CURCLIP
-					sub		ecx, CURCLIP
-					mov		CURCLIP, -1
-					CLIPLEFT_DRAW_COMPLEX_SEGMENT :
-					//*****************************************//
-					//put various code with encoding&loop there//
-					//*****************************************//
-					or cl, cl
-					jz		PAL3_1
-					xor		eax, eax
-					PAL3_0 : lodsb
-					mov		al, [ebx + eax]
-					stosb
-					dec		cl
-					jnz		PAL3_0
-					PAL3_1 :
-				//*****************************************//
-				//          end of variation zone          //
-				//*****************************************//
-				dec		TEMP1
-					jnz		CLIPLEFT_START_COMPLEX_SEGMENT
-					dec		NLines
-					jnz		CLIPLEFT_START_SCANLINE
-					CLIPLEFT_END_DRAW_PICTURE :
-				//end code
-				pop		edi
-					pop		esi
-					popf
-			};
-		}
-		else
-		{
-			if (x1 > WindX1)
-			{
-				//****************************************************************//
-				//****************************************************************//
-				//**      **     **                                **    **     **//
-				//****************   	clipping RIGHT edge			**************//
-				//**      **     **                                **    **     **//
-				//****************************************************************//
-				//****************************************************************//
-				CLIP = WindX1 - x + 1;
-				int ADDESI;
-				__asm {
-					pushf
-					push	esi
-					push	edi
-					//initialisation
-					mov		edi, scrofs			//edi-screen pointer
-					mov		esi, CDPOS			//esi-points array
-					mov		ebx, Encoder			//ebx-encoding pointer
-					mov		edx, ofst			//edx-mask offset
-					xor		eax, eax
-					xor		ecx, ecx
-					cld
-					sub		edi, ScrWidth
-					mov		LineStart, edi
-					CLIPRIGHT_START_SCANLINE :
-					mov		edi, LineStart
-						mov		al, [edx]
-						inc		edx
-						mov		ADDESI, 0
-						xchg	CLIP, edx
-						add		edi, ScrWidth
-						mov		CURCLIP, edx
-						or al, al
-						xchg	CLIP, edx
-						mov		LineStart, edi
-						jnz		CLIPRIGHT_DRAW_LINE
-						dec		NLines
-						jnz		CLIPRIGHT_START_SCANLINE
-						jmp		CLIPRIGHT_END_DRAW_PICTURE
-						CLIPRIGHT_DRAW_LINE :
-					test	al, 128
-						jnz		CLIPRIGHT_DRAW_COMPLEX_LINE
-						//drawing simple line
-						or al, al
-						jz		CLIPRIGHT_NEXT_SEGMENT
-						mov		TEMP1, eax
-						CLIPRIGHT_START_SIMPLE_SEGMENT :
-					mov		al, [edx]	//empty space
-						add		edi, eax
-						mov		cl, [edx + 1]
-						add		edx, 2
-						sub		CURCLIP, eax
-						jg		CLIPRIGHT_TRY_TO_CLIP
-						//full clipping until the end of line
-						add		esi, ecx
-						dec		TEMP1
-						jnz		CLIPRIGHT_START_SIMPLE_SEGMENT
-						dec		NLines
-						jnz		CLIPRIGHT_START_SCANLINE
-						jmp		CLIPRIGHT_END_DRAW_PICTURE
-						CLIPRIGHT_TRY_TO_CLIP :
-					cmp		CURCLIP, ecx
-						jl		CLIPRIGHT_PARTIAL_SIMPLE
-						sub		CURCLIP, ecx
-						jmp		CLIPRIGHT_DRAW_SIMPLE_SEGMENT
-						CLIPRIGHT_PARTIAL_SIMPLE :
-					//partial clipping
-					sub		ecx, CURCLIP
-						mov		ADDESI, ecx
-						mov		ecx, CURCLIP
-						mov		CURCLIP, -1
-						CLIPRIGHT_DRAW_SIMPLE_SEGMENT :
-						//*****************************************//
-						//put various code with encoding&loop there//
-						//*****************************************//
-						or cl, cl
-						jz		PAL4_1
-						xor		eax, eax
-						PAL4_0 : lodsb
-						mov		al, [ebx + eax]
-						stosb
-						dec		cl
-						jnz		PAL4_0
-						PAL4_1 :
-					//*****************************************//
-					//          end of variation zone          //
-					//*****************************************//
-					add		esi, ADDESI
-						dec		TEMP1
-						jnz		CLIPRIGHT_START_SIMPLE_SEGMENT
-						CLIPRIGHT_NEXT_SEGMENT :
-					dec		NLines
-						jnz		CLIPRIGHT_START_SCANLINE
-						jmp		CLIPRIGHT_END_DRAW_PICTURE
-						CLIPRIGHT_DRAW_COMPLEX_LINE :
-					//complex packed line
-					mov		SPACE_MASK, 0
-						mov		PIX_MASK, 0
-						test	al, 64
-						jz		CLIPRIGHT_DCL1
-						mov		SPACE_MASK, 16
-						CLIPRIGHT_DCL1:		test	al, 32
-						jz		CLIPRIGHT_DCL2
-						mov		PIX_MASK, 16
-						CLIPRIGHT_DCL2 : and		al, 31
-						jz		CLIPRIGHT_NEXT_SEGMENT
-						mov		TEMP1, eax
-						CLIPRIGHT_START_COMPLEX_SEGMENT :
-					mov		al, [edx]
-						mov		cl, al
-						and		al, 15
-						or al, SPACE_MASK
-						add		edi, eax
-						shr		cl, 4
-						or cl, PIX_MASK
-						inc		edx
-						sub		CURCLIP, eax
-						jg		CLIPRIGHT_TRY_TO_CLIP_COMPLEX
-						//full clipping until the end of line
-						add		esi, ecx
-						dec		TEMP1
-						jnz		CLIPRIGHT_START_COMPLEX_SEGMENT
-						dec		NLines
-						jnz		CLIPRIGHT_START_SCANLINE
-						jmp		CLIPRIGHT_END_DRAW_PICTURE
-						CLIPRIGHT_TRY_TO_CLIP_COMPLEX :
-					cmp		CURCLIP, ecx
-						jl		CLIPRIGHT_PARTIAL_COMPLEX
-						sub		CURCLIP, ecx
-						jmp		CLIPRIGHT_DRAW_COMPLEX_SEGMENT
-						CLIPRIGHT_PARTIAL_COMPLEX :
-					//partial clipping
-					sub		ecx, CURCLIP
-						mov		ADDESI, ecx
-						mov		ecx, CURCLIP
-						mov		CURCLIP, -1
-						CLIPRIGHT_DRAW_COMPLEX_SEGMENT :
-						//*****************************************//
-						//put various code with encoding&loop there//
-						//*****************************************//
-						or cl, cl
-						jz		PAL5_1
-						xor		eax, eax
-						PAL5_0 : lodsb
-						mov		al, [ebx + eax]
-						stosb
-						dec		cl
-						jnz		PAL5_0
-						PAL5_1 :
-					//*****************************************//
-					//          end of variation zone          //
-					//*****************************************//
-					add		esi, ADDESI
-						dec		TEMP1
-						jnz		CLIPRIGHT_START_COMPLEX_SEGMENT
-						dec		NLines
-						jnz		CLIPRIGHT_START_SCANLINE
-						CLIPRIGHT_END_DRAW_PICTURE :
-					//end code
-					pop		edi
-						pop		esi
-						popf
-				};
-			};
-		};
-	};
-};
+	GP_ShowMasked( GPB_PAL, false, x, y, Pic, CData, Encoder, nullptr );
+}
+
 void GP_ShowMaskedPalPictInv( int x, int y, GP_Header* Pic, byte* CData, byte* Encoder )
 {
-	x -= Pic->dx;
-	y += Pic->dy;
-	int Lx = Pic->Lx;
-	int NLines = Pic->NLines;
-	int ofst = int( Pic ) + 23;
-	if (y + NLines <= WindY || x - Lx >= WindX1 || x<WindX || y>WindY1)return;
-	//vertical clipping
-	//top clipper
-	int CDPOS = int( CData );
-	if (y < WindY)
-	{
-		__asm {
-			mov		ecx, WindY
-			sub		ecx, y
-			sub		NLines, ecx
-			add		y, ecx
-			mov		ebx, ofst
-			xor		eax, eax
-			xor		edx, edx
-			NLINE : mov		al, [ebx]
-					test	al, 128
-					jz		SIMPLE_LINE
-					inc		ebx
-					mov		ah, al
-					and		al, 31
-					or al, al
-					jz		COMPLINE_1
-					and		ah, 32
-					shr		ah, 1
-					COMPLINE_LOOP1:
-			mov		dl, [ebx]
-				shr		dl, 4
-				or dl, ah
-				add		CDPOS, edx
-				inc		ebx
-				dec		al
-				jnz		COMPLINE_LOOP1
-				COMPLINE_1 :
-			xor		eax, eax
-				dec		ecx
-				jnz		NLINE
-				jmp		END_VCLIP
-				SIMPLE_LINE : inc		ebx
-				or eax, eax
-				jz		SIMPLINE_1
-				SIMPLINE_LOOP1 :
-			mov		dl, [ebx + 1]
-				add		CDPOS, edx
-				add		ebx, 2
-				dec		al
-				jnz		SIMPLINE_LOOP1
-				SIMPLINE_1 : dec		ecx
-				jnz		NLINE
-				END_VCLIP : mov		ofst, ebx
-		};
-	};
-	//bottom clipper
-	if (y + NLines > WindY1)NLines = WindY1 - y + 1;
-	//horisontal clipper
-	int x1 = x - Lx + 1;
-	int scrofs = int( ScreenPtr ) + x + y*ScrWidth;
-	int TEMP1;
-	int LineStart;
-	int CLIP;
-	int CURCLIP;
-	byte SPACE_MASK;
-	byte PIX_MASK;
-	if (x1 >= WindX&&x <= WindX1)
-	{
-		//***********************************************************//
-		//******************(((((((((((())))))))))))*****************//
-		//**                      NO CLIPPING                      **//INVERTED
-		//******************(((((((((((())))))))))))*****************//
-		//***********************************************************//
-				//no clipping
-		__asm {
-			pushf
-			push	esi
-			push	edi
-			//initialisation
-			mov		edi, scrofs			//edi-screen pointer
-			mov		esi, CDPOS			//esi-points array
-			mov		ebx, Encoder			//ebx-encoding pointer
-			mov		edx, ofst			//edx-mask offset
-			xor		eax, eax
-			xor		ecx, ecx
-			cld
-			sub		edi, ScrWidth
-			mov		LineStart, edi
-			START_SCANLINE :
-			mov		edi, LineStart
-				mov		al, [edx]
-				inc		edx
-				add		edi, ScrWidth
-				or al, al
-				mov		LineStart, edi
-				jnz		DRAW_LINE
-				dec		NLines
-				jnz		START_SCANLINE
-				jmp		END_DRAW_PICTURE
-				DRAW_LINE : test	al, 128
-				jnz		DRAW_COMPLEX_LINE
-				//drawing simple line
-				or al, al
-				jz		NEXT_SEGMENT
-				mov		TEMP1, eax
-				START_SIMPLE_SEGMENT :
-			mov		al, [edx]	//empty space
-				sub		edi, eax
-				mov		cl, [edx + 1]
-				add		edx, 2
-				//*****************************************//
-				//put various code with encoding&loop there//INVERTED
-				//*****************************************//
-				or cl, cl
-				jz		PAL0_1
-				xor		eax, eax
-				PAL0_0 : lodsb
-				mov		al, [ebx + eax]
-				mov[edi], al
-				dec		edi
-				dec		cl
-				jnz		PAL0_0
-				PAL0_1 :
-			//*****************************************//
-			//          end of variation zone          //INVERTED
-			//*****************************************//
-			dec		TEMP1
-				jnz		START_SIMPLE_SEGMENT
-				NEXT_SEGMENT :
-			dec		NLines
-				jnz		START_SCANLINE
-				jmp		END_DRAW_PICTURE
-				DRAW_COMPLEX_LINE :
-			//complex packed line
-			mov		SPACE_MASK, 0
-				mov		PIX_MASK, 0
-				test	al, 64
-				jz		DCL1
-				mov		SPACE_MASK, 16
-				DCL1:		test	al, 32
-				jz		DCL2
-				mov		PIX_MASK, 16
-				DCL2 : and		al, 31
-				jz		NEXT_SEGMENT
-				mov		TEMP1, eax
-				START_COMPLEX_SEGMENT :
-			mov		al, [edx]
-				mov		cl, al
-				and		al, 15
-				or al, SPACE_MASK
-				sub		edi, eax
-				shr		cl, 4
-				or cl, PIX_MASK
-				inc		edx
-				//*****************************************//
-				//put various code with encoding&loop there//INVERTED
-				//*****************************************//
-				or cl, cl
-				jz		PAL1_1
-				xor		eax, eax
-				PAL1_0 : lodsb
-				mov		al, [ebx + eax]
-				mov[edi], al
-				dec		edi
-				dec		cl
-				jnz		PAL1_0
-				PAL1_1 :
-			//*****************************************//
-			//          end of variation zone          //INVERTED
-			//*****************************************//
-			dec		TEMP1
-				jnz		START_COMPLEX_SEGMENT
-				dec		NLines
-				jnz		START_SCANLINE
-				END_DRAW_PICTURE :
-			//end code
-			pop		edi
-				pop		esi
-				popf
-		};
-	}
-	else
-	{
-		//image must be clipped
-		if (x > WindX1)
-		{
-			//****************************************************************//
-			//****************************************************************//
-			//**                                                            **//
-			//**					clipping RIGT(old-LEFT) edge						**//INVERTED
-			//**                                                            **//
-			//****************************************************************//
-			//****************************************************************//
-			CLIP = x - WindX1;
-			__asm {
-				pushf
-				push	esi
-				push	edi
-				//initialisation
-				mov		edi, scrofs			//edi-screen pointer
-				mov		esi, CDPOS			//esi-points array
-				mov		ebx, Encoder			//ebx-encoding pointer
-				mov		edx, ofst			//edx-mask offset
-				xor		eax, eax
-				xor		ecx, ecx
-				cld
-				sub		edi, ScrWidth
-				mov		LineStart, edi
-				CLIPLEFT_START_SCANLINE :
-				mov		edi, LineStart
-					mov		al, [edx]
-					inc		edx
-					xchg	CLIP, edx
-					add		edi, ScrWidth
-					mov		CURCLIP, edx
-					or al, al
-					xchg	CLIP, edx
-					mov		LineStart, edi
-					jnz		CLIPLEFT_DRAW_LINE
-					dec		NLines
-					jnz		CLIPLEFT_START_SCANLINE
-					jmp		CLIPLEFT_END_DRAW_PICTURE
-					CLIPLEFT_DRAW_LINE : test	al, 128
-					jnz		CLIPLEFT_DRAW_COMPLEX_LINE
-					//drawing simple line
-					or al, al
-					jz		CLIPLEFT_NEXT_SEGMENT
-					mov		TEMP1, eax
-					CLIPLEFT_START_SIMPLE_SEGMENT :
-				mov		al, [edx]	//empty space
-					sub		edi, eax
-					mov		cl, [edx + 1]
-					add		edx, 2
-					sub		CURCLIP, eax
-					jle		CLIPLEFT_DRAW_SIMPLE_SEGMENT
-					cmp		CURCLIP, ecx
-					jl		CLIPLEFT_PARTIAL_SIMPLE
-					//full  clipping
-					sub		CURCLIP, ecx
-					add		esi, ecx
-					sub		edi, ecx
-					dec		TEMP1
-					jnz		CLIPLEFT_START_SIMPLE_SEGMENT
-					dec		NLines
-					jnz		CLIPLEFT_START_SCANLINE
-					jmp		CLIPLEFT_END_DRAW_PICTURE
-					CLIPLEFT_PARTIAL_SIMPLE :
-				//partial clipping
-				add		esi, CURCLIP
-					sub		edi, CURCLIP
-					sub		ecx, CURCLIP
-					mov		CURCLIP, -1
-					CLIPLEFT_DRAW_SIMPLE_SEGMENT :
-					//*****************************************//
-					//put various code with encoding&loop there//INVERTED
-					//*****************************************//
-					or cl, cl
-					jz		PAL2_1
-					xor		eax, eax
-					PAL2_0 : lodsb
-					mov		al, [ebx + eax]
-					mov[edi], al
-					dec		edi
-					dec		cl
-					jnz		PAL2_0
-					PAL2_1 :
-				//*****************************************//
-				//          end of variation zone          //INVERTED
-				//*****************************************//
-				dec		TEMP1
-					jnz		CLIPLEFT_START_SIMPLE_SEGMENT
-					CLIPLEFT_NEXT_SEGMENT :
-				dec		NLines
-					jnz		CLIPLEFT_START_SCANLINE
-					jmp		CLIPLEFT_END_DRAW_PICTURE
-					CLIPLEFT_DRAW_COMPLEX_LINE :
-				//complex packed line
-				mov		SPACE_MASK, 0
-					mov		PIX_MASK, 0
-					test	al, 64
-					jz		CLIPLEFT_DCL1
-					mov		SPACE_MASK, 16
-					CLIPLEFT_DCL1:	test	al, 32
-					jz		CLIPLEFT_DCL2
-					mov		PIX_MASK, 16
-					CLIPLEFT_DCL2 : and		al, 31
-					jz		CLIPLEFT_NEXT_SEGMENT
-					mov		TEMP1, eax
-					CLIPLEFT_START_COMPLEX_SEGMENT :
-				mov		al, [edx]
-					mov		cl, al
-					and		al, 15
-					or al, SPACE_MASK
-					sub		edi, eax
-					shr		cl, 4
-					or cl, PIX_MASK
-					inc		edx
-					sub		CURCLIP, eax
-					jle		CLIPLEFT_DRAW_COMPLEX_SEGMENT
-					cmp		CURCLIP, ecx
-					jl		CLIPLEFT_PARTIAL_COMPLEX
-					//full  clipping
-					sub		CURCLIP, ecx
-					add		esi, ecx
-					sub		edi, ecx
-					dec		TEMP1
-					jnz		CLIPLEFT_START_COMPLEX_SEGMENT
-					dec		NLines
-					jnz		CLIPLEFT_START_SCANLINE
-					jmp		CLIPLEFT_END_DRAW_PICTURE
-					CLIPLEFT_PARTIAL_COMPLEX :
-				//partial clipping
-				add		esi, CURCLIP
-					sub		edi, CURCLIP
-					sub		ecx, CURCLIP
-					mov		CURCLIP, -1
-					CLIPLEFT_DRAW_COMPLEX_SEGMENT :
-					//*****************************************//
-					//put various code with encoding&loop there//INVERTED
-					//*****************************************//
-					or cl, cl
-					jz		PAL3_1
-					xor		eax, eax
-					PAL3_0 : lodsb
-					mov		al, [ebx + eax]
-					mov[edi], al
-					dec		edi
-					dec		cl
-					jnz		PAL3_0
-					PAL3_1 :
-				//*****************************************//
-				//          end of variation zone          //INVERTED
-				//*****************************************//
-				dec		TEMP1
-					jnz		CLIPLEFT_START_COMPLEX_SEGMENT
-					dec		NLines
-					jnz		CLIPLEFT_START_SCANLINE
-					CLIPLEFT_END_DRAW_PICTURE :
-				//end code
-				pop		edi
-					pop		esi
-					popf
-			};
-		}
-		else
-		{
-			if (x1 < WindX1)
-			{
-				//****************************************************************//
-				//****************************************************************//
-				//**      **     **                                **    **     **//
-				//****************   clipping LEFT(old-RIGHT) edge  **************//INVERTED
-				//**      **     **                                **    **     **//
-				//****************************************************************//
-				//****************************************************************//
-				CLIP = x - WindX + 1;
-				int ADDESI;
-				__asm {
-					pushf
-					push	esi
-					push	edi
-					//initialisation
-					mov		edi, scrofs			//edi-screen pointer
-					mov		esi, CDPOS			//esi-points array
-					mov		ebx, Encoder			//ebx-encoding pointer
-					mov		edx, ofst			//edx-mask offset
-					xor		eax, eax
-					xor		ecx, ecx
-					cld
-					sub		edi, ScrWidth
-					mov		LineStart, edi
-					CLIPRIGHT_START_SCANLINE :
-					mov		edi, LineStart
-						mov		al, [edx]
-						inc		edx
-						mov		ADDESI, 0
-						xchg	CLIP, edx
-						add		edi, ScrWidth
-						mov		CURCLIP, edx
-						or al, al
-						xchg	CLIP, edx
-						mov		LineStart, edi
-						jnz		CLIPRIGHT_DRAW_LINE
-						dec		NLines
-						jnz		CLIPRIGHT_START_SCANLINE
-						jmp		CLIPRIGHT_END_DRAW_PICTURE
-						CLIPRIGHT_DRAW_LINE :
-					test	al, 128
-						jnz		CLIPRIGHT_DRAW_COMPLEX_LINE
-						//drawing simple line
-						or al, al
-						jz		CLIPRIGHT_NEXT_SEGMENT
-						mov		TEMP1, eax
-						CLIPRIGHT_START_SIMPLE_SEGMENT :
-					mov		al, [edx]	//empty space
-						sub		edi, eax
-						mov		cl, [edx + 1]
-						add		edx, 2
-						sub		CURCLIP, eax
-						jg		CLIPRIGHT_TRY_TO_CLIP
-						//full clipping until the end of line
-						add		esi, ecx
-						dec		TEMP1
-						jnz		CLIPRIGHT_START_SIMPLE_SEGMENT
-						dec		NLines
-						jnz		CLIPRIGHT_START_SCANLINE
-						jmp		CLIPRIGHT_END_DRAW_PICTURE
-						CLIPRIGHT_TRY_TO_CLIP :
-					cmp		CURCLIP, ecx
-						jl		CLIPRIGHT_PARTIAL_SIMPLE
-						sub		CURCLIP, ecx
-						jmp		CLIPRIGHT_DRAW_SIMPLE_SEGMENT
-						CLIPRIGHT_PARTIAL_SIMPLE :
-					//partial clipping
-					sub		ecx, CURCLIP
-						mov		ADDESI, ecx
-						mov		ecx, CURCLIP
-						mov		CURCLIP, -1
-						CLIPRIGHT_DRAW_SIMPLE_SEGMENT :
-						//*****************************************//
-						//put various code with encoding&loop there//INVERTED
-						//*****************************************//
-						or cl, cl
-						jz		PAL4_1
-						xor		eax, eax
-						PAL4_0 : lodsb
-						mov		al, [ebx + eax]
-						mov[edi], al
-						dec		edi
-						dec		cl
-						jnz		PAL4_0
-						PAL4_1 :
-					//*****************************************//
-					//          end of variation zone          //INVERTED
-					//*****************************************//
-					add		esi, ADDESI
-						dec		TEMP1
-						jnz		CLIPRIGHT_START_SIMPLE_SEGMENT
-						CLIPRIGHT_NEXT_SEGMENT :
-					dec		NLines
-						jnz		CLIPRIGHT_START_SCANLINE
-						jmp		CLIPRIGHT_END_DRAW_PICTURE
-						CLIPRIGHT_DRAW_COMPLEX_LINE :
-					//complex packed line
-					mov		SPACE_MASK, 0
-						mov		PIX_MASK, 0
-						test	al, 64
-						jz		CLIPRIGHT_DCL1
-						mov		SPACE_MASK, 16
-						CLIPRIGHT_DCL1:		test	al, 32
-						jz		CLIPRIGHT_DCL2
-						mov		PIX_MASK, 16
-						CLIPRIGHT_DCL2 : and		al, 31
-						jz		CLIPRIGHT_NEXT_SEGMENT
-						mov		TEMP1, eax
-						CLIPRIGHT_START_COMPLEX_SEGMENT :
-					mov		al, [edx]
-						mov		cl, al
-						and		al, 15
-						or al, SPACE_MASK
-						sub		edi, eax
-						shr		cl, 4
-						or cl, PIX_MASK
-						inc		edx
-						sub		CURCLIP, eax
-						jg		CLIPRIGHT_TRY_TO_CLIP_COMPLEX
-						//full clipping until the end of line
-						add		esi, ecx
-						dec		TEMP1
-						jnz		CLIPRIGHT_START_COMPLEX_SEGMENT
-						dec		NLines
-						jnz		CLIPRIGHT_START_SCANLINE
-						jmp		CLIPRIGHT_END_DRAW_PICTURE
-						CLIPRIGHT_TRY_TO_CLIP_COMPLEX :
-					cmp		CURCLIP, ecx
-						jl		CLIPRIGHT_PARTIAL_COMPLEX
-						sub		CURCLIP, ecx
-						jmp		CLIPRIGHT_DRAW_COMPLEX_SEGMENT
-						CLIPRIGHT_PARTIAL_COMPLEX :
-					//partial clipping
-					sub		ecx, CURCLIP
-						mov		ADDESI, ecx
-						mov		ecx, CURCLIP
-						mov		CURCLIP, -1
-						CLIPRIGHT_DRAW_COMPLEX_SEGMENT :
-						//*****************************************//
-						//put various code with encoding&loop there//INVERTED
-						//*****************************************//
-						or cl, cl
-						jz		PAL5_1
-						xor		eax, eax
-						PAL5_0 : lodsb
-						mov		al, [ebx + eax]
-						mov[edi], al
-						dec		edi
-						dec		cl
-						jnz		PAL5_0
-						PAL5_1 :
-					//*****************************************//
-					//          end of variation zone          //INVERTED
-					//*****************************************//
-					add		esi, ADDESI
-						dec		TEMP1
-						jnz		CLIPRIGHT_START_COMPLEX_SEGMENT
-						dec		NLines
-						jnz		CLIPRIGHT_START_SCANLINE
-						CLIPRIGHT_END_DRAW_PICTURE :
-					//end code
-					pop		edi
-						pop		esi
-						popf
-				};
-			};
-		};
-	};
-};
-//key word: MULTIDRAW
-//******************************************************************************//
-//******************************************************************************//
-//******************************************************************************//
-//****																		****//
-//****																		****//
-//****				      COMPOSED WITH BACKGROUND PICTURE					****//
-//****																		****//
-//****																		****//
-//******************************************************************************//
-//******************************************************************************//
-//******************************************************************************//
+	GP_ShowMasked( GPB_PAL, true, x, y, Pic, CData, Encoder, nullptr );
+}
+
 void GP_ShowMaskedMultiPalPict( int x, int y, GP_Header* Pic, byte* CData, byte* Encoder )
 {
-	x += Pic->dx;
-	y += Pic->dy;
-	int Lx = Pic->Lx;
-	int NLines = Pic->NLines;
-	int ofst = int( Pic ) + 23;
-	if (y + NLines <= WindY || x + Lx <= WindX || x > WindX1 || y > WindY1)return;
-	//vertical clipping
-	//top clipper
-	int CDPOS = int( CData );
-	if (y < WindY)
-	{
-		__asm {
-			mov		ecx, WindY
-			sub		ecx, y
-			sub		NLines, ecx
-			add		y, ecx
-			mov		ebx, ofst
-			xor		eax, eax
-			xor		edx, edx
-			NLINE : mov		al, [ebx]
-					test	al, 128
-					jz		SIMPLE_LINE
-					inc		ebx
-					mov		ah, al
-					and		al, 31
-					or al, al
-					jz		COMPLINE_1
-					and		ah, 32
-					shr		ah, 1
-					COMPLINE_LOOP1:
-			mov		dl, [ebx]
-				shr		dl, 4
-				or dl, ah
-				add		CDPOS, edx
-				inc		ebx
-				dec		al
-				jnz		COMPLINE_LOOP1
-				COMPLINE_1 :
-			xor		eax, eax
-				dec		ecx
-				jnz		NLINE
-				jmp		END_VCLIP
-				SIMPLE_LINE : inc		ebx
-				or eax, eax
-				jz		SIMPLINE_1
-				SIMPLINE_LOOP1 :
-			mov		dl, [ebx + 1]
-				add		CDPOS, edx
-				add		ebx, 2
-				dec		al
-				jnz		SIMPLINE_LOOP1
-				SIMPLINE_1 : dec		ecx
-				jnz		NLINE
-				END_VCLIP : mov		ofst, ebx
-		};
-	};
-	//bottom clipper
-	if (y + NLines > WindY1)NLines = WindY1 - y + 1;
-	//horisontal clipper
-	int x1 = x + Lx - 1;
-	int scrofs = int( ScreenPtr ) + x + y*ScrWidth;
-	int TEMP1;
-	int LineStart;
-	int CLIP;
-	int CURCLIP;
-	byte SPACE_MASK;
-	byte PIX_MASK;
-	if (x >= WindX&&x1 <= WindX1)
-	{
-		//***********************************************************//
-		//******************(((((((((((())))))))))))*****************//
-		//**                      NO CLIPPING                      **//
-		//******************(((((((((((())))))))))))*****************//
-		//***********************************************************//
-				//no clipping
-		__asm {
-			pushf
-			push	esi
-			push	edi
-			//initialisation
-			mov		edi, scrofs			//edi-screen pointer
-			mov		esi, CDPOS			//esi-points array
-			mov		ebx, Encoder			//ebx-encoding pointer
-			mov		edx, ofst			//edx-mask offset
-			xor		eax, eax
-			xor		ecx, ecx
-			cld
-			sub		edi, ScrWidth
-			mov		LineStart, edi
-			START_SCANLINE :
-			mov		edi, LineStart
-				mov		al, [edx]
-				inc		edx
-				add		edi, ScrWidth
-				or al, al
-				mov		LineStart, edi
-				jnz		DRAW_LINE
-				dec		NLines
-				jnz		START_SCANLINE
-				jmp		END_DRAW_PICTURE
-				DRAW_LINE : test	al, 128
-				jnz		DRAW_COMPLEX_LINE
-				//drawing simple line
-				or al, al
-				jz		NEXT_SEGMENT
-				mov		TEMP1, eax
-				START_SIMPLE_SEGMENT :
-			mov		al, [edx]	//empty space
-				add		edi, eax
-				mov		cl, [edx + 1]
-				add		edx, 2
-				//*****************************************//
-				//put various code with encoding&loop there//
-				//*****************************************//
-				or cl, cl
-				jz		MPL0_1
-				xor		eax, eax
-				MPL0_0 : mov		al, [edi]
-				mov		ah, [esi]
-				mov		al, [ebx + eax]
-				inc		esi
-				stosb
-				dec		cl
-				jnz		MPL0_0
-				MPL0_1 : xor		eax, eax
-				//*****************************************//
-				//          end of variation zone          //
-				//*****************************************//
-				dec		TEMP1
-				jnz		START_SIMPLE_SEGMENT
-				NEXT_SEGMENT :
-			dec		NLines
-				jnz		START_SCANLINE
-				jmp		END_DRAW_PICTURE
-				DRAW_COMPLEX_LINE :
-			//complex packed line
-			mov		SPACE_MASK, 0
-				mov		PIX_MASK, 0
-				test	al, 64
-				jz		DCL1
-				mov		SPACE_MASK, 16
-				DCL1:		test	al, 32
-				jz		DCL2
-				mov		PIX_MASK, 16
-				DCL2 : and		al, 31
-				jz		NEXT_SEGMENT
-				mov		TEMP1, eax
-				START_COMPLEX_SEGMENT :
-			mov		al, [edx]
-				mov		cl, al
-				and		al, 15
-				or al, SPACE_MASK
-				add		edi, eax
-				shr		cl, 4
-				or cl, PIX_MASK
-				inc		edx
-				//*****************************************//
-				//put various code with encoding&loop there//
-				//*****************************************//
-				or cl, cl
-				jz		MPL1_1
-				xor		eax, eax
-				MPL1_0 : mov		al, [edi]
-				mov		ah, [esi]
-				mov		al, [ebx + eax]
-				inc		esi
-				stosb
-				dec		cl
-				jnz		MPL1_0
-				MPL1_1 : xor		eax, eax
-				//*****************************************//
-				//          end of variation zone          //
-				//*****************************************//
-				dec		TEMP1
-				jnz		START_COMPLEX_SEGMENT
-				dec		NLines
-				jnz		START_SCANLINE
-				END_DRAW_PICTURE :
-			//end code
-			pop		edi
-				pop		esi
-				popf
-		};
-	}
-	else
-	{
-		//image must be clipped
-		if (x < WindX)
-		{
-			//****************************************************************//
-			//****************************************************************//
-			//**                                                            **//
-			//**					clipping LEFT edge						**//
-			//**                                                            **//
-			//****************************************************************//
-			//****************************************************************//
-			CLIP = WindX - x;
-			__asm {
-				pushf
-				push	esi
-				push	edi
-				//initialisation
-				mov		edi, scrofs			//edi-screen pointer
-				mov		esi, CDPOS			//esi-points array
-				mov		ebx, Encoder			//ebx-encoding pointer
-				mov		edx, ofst			//edx-mask offset
-				xor		eax, eax
-				xor		ecx, ecx
-				cld
-				sub		edi, ScrWidth
-				mov		LineStart, edi
-				CLIPLEFT_START_SCANLINE :
-				mov		edi, LineStart
-					mov		al, [edx]
-					inc		edx
-					xchg	CLIP, edx
-					add		edi, ScrWidth
-					mov		CURCLIP, edx
-					or al, al
-					xchg	CLIP, edx
-					mov		LineStart, edi
-					jnz		CLIPLEFT_DRAW_LINE
-					dec		NLines
-					jnz		CLIPLEFT_START_SCANLINE
-					jmp		CLIPLEFT_END_DRAW_PICTURE
-					CLIPLEFT_DRAW_LINE : test	al, 128
-					jnz		CLIPLEFT_DRAW_COMPLEX_LINE
-					//drawing simple line
-					or al, al
-					jz		CLIPLEFT_NEXT_SEGMENT
-					mov		TEMP1, eax
-					CLIPLEFT_START_SIMPLE_SEGMENT :
-				mov		al, [edx]	//empty space
-					add		edi, eax
-					mov		cl, [edx + 1]
-					add		edx, 2
-					sub		CURCLIP, eax
-					jle		CLIPLEFT_DRAW_SIMPLE_SEGMENT
-					cmp		CURCLIP, ecx
-					jl		CLIPLEFT_PARTIAL_SIMPLE
-					//full  clipping
-					sub		CURCLIP, ecx
-					add		esi, ecx
-					add		edi, ecx
-					dec		TEMP1
-					jnz		CLIPLEFT_START_SIMPLE_SEGMENT
-					dec		NLines
-					jnz		CLIPLEFT_START_SCANLINE
-					jmp		CLIPLEFT_END_DRAW_PICTURE
-					CLIPLEFT_PARTIAL_SIMPLE :
-				//partial clipping
-				add		esi, CURCLIP
-					add		edi, CURCLIP
-					sub		ecx, CURCLIP
-					mov		CURCLIP, -1
-					CLIPLEFT_DRAW_SIMPLE_SEGMENT :
-					//*****************************************//
-					//put various code with encoding&loop there//
-					//*****************************************//
-					or cl, cl
-					jz		MPL2_1
-					xor		eax, eax
-					MPL2_0 : mov		al, [edi]
-					mov		ah, [esi]
-					mov		al, [ebx + eax]
-					inc		esi
-					stosb
-					dec		cl
-					jnz		MPL2_0
-					MPL2_1 : xor		eax, eax
-					//*****************************************//
-					//          end of variation zone          //
-					//*****************************************//
-					dec		TEMP1
-					jnz		CLIPLEFT_START_SIMPLE_SEGMENT
-					CLIPLEFT_NEXT_SEGMENT :
-				dec		NLines
-					jnz		CLIPLEFT_START_SCANLINE
-					jmp		CLIPLEFT_END_DRAW_PICTURE
-					CLIPLEFT_DRAW_COMPLEX_LINE :
-				//complex packed line
-				mov		SPACE_MASK, 0
-					mov		PIX_MASK, 0
-					test	al, 64
-					jz		CLIPLEFT_DCL1
-					mov		SPACE_MASK, 16
-					CLIPLEFT_DCL1:	test	al, 32
-					jz		CLIPLEFT_DCL2
-					mov		PIX_MASK, 16
-					CLIPLEFT_DCL2 : and		al, 31
-					jz		CLIPLEFT_NEXT_SEGMENT
-					mov		TEMP1, eax
-					CLIPLEFT_START_COMPLEX_SEGMENT :
-				mov		al, [edx]
-					mov		cl, al
-					and		al, 15
-					or al, SPACE_MASK
-					add		edi, eax
-					shr		cl, 4
-					or cl, PIX_MASK
-					inc		edx
-					sub		CURCLIP, eax
-					jle		CLIPLEFT_DRAW_COMPLEX_SEGMENT
-					cmp		CURCLIP, ecx
-					jl		CLIPLEFT_PARTIAL_COMPLEX
-					//full  clipping
-					sub		CURCLIP, ecx
-					add		esi, ecx
-					add		edi, ecx
-					dec		TEMP1
-					jnz		CLIPLEFT_START_COMPLEX_SEGMENT
-					dec		NLines
-					jnz		CLIPLEFT_START_SCANLINE
-					jmp		CLIPLEFT_END_DRAW_PICTURE
-					CLIPLEFT_PARTIAL_COMPLEX :
-				//partial clipping
-				add		esi, CURCLIP
-					add		edi, CURCLIP
-					sub		ecx, CURCLIP
-					mov		CURCLIP, -1
-					CLIPLEFT_DRAW_COMPLEX_SEGMENT :
-					//*****************************************//
-					//put various code with encoding&loop there//
-					//*****************************************//
-					or cl, cl
-					jz		MPL3_1
-					xor		eax, eax
-					MPL3_0 : mov		al, [edi]
-					mov		ah, [esi]
-					mov		al, [ebx + eax]
-					inc		esi
-					stosb
-					dec		cl
-					jnz		MPL3_0
-					MPL3_1 : xor		eax, eax
-					//*****************************************//
-					//          end of variation zone          //
-					//*****************************************//
-					dec		TEMP1
-					jnz		CLIPLEFT_START_COMPLEX_SEGMENT
-					dec		NLines
-					jnz		CLIPLEFT_START_SCANLINE
-					CLIPLEFT_END_DRAW_PICTURE :
-				//end code
-				pop		edi
-					pop		esi
-					popf
-			};
-		}
-		else
-		{
-			if (x1 > WindX1)
-			{
-				//****************************************************************//
-				//****************************************************************//
-				//**      **     **                                **    **     **//
-				//****************   	clipping RIGHT edge			**************//
-				//**      **     **                                **    **     **//
-				//****************************************************************//
-				//****************************************************************//
-				CLIP = WindX1 - x + 1;
-				int ADDESI;
-				__asm {
-					pushf
-					push	esi
-					push	edi
-					//initialisation
-					mov		edi, scrofs			//edi-screen pointer
-					mov		esi, CDPOS			//esi-points array
-					mov		ebx, Encoder			//ebx-encoding pointer
-					mov		edx, ofst			//edx-mask offset
-					xor		eax, eax
-					xor		ecx, ecx
-					cld
-					sub		edi, ScrWidth
-					mov		LineStart, edi
-					CLIPRIGHT_START_SCANLINE :
-					mov		edi, LineStart
-						mov		al, [edx]
-						inc		edx
-						mov		ADDESI, 0
-						xchg	CLIP, edx
-						add		edi, ScrWidth
-						mov		CURCLIP, edx
-						or al, al
-						xchg	CLIP, edx
-						mov		LineStart, edi
-						jnz		CLIPRIGHT_DRAW_LINE
-						dec		NLines
-						jnz		CLIPRIGHT_START_SCANLINE
-						jmp		CLIPRIGHT_END_DRAW_PICTURE
-						CLIPRIGHT_DRAW_LINE :
-					test	al, 128
-						jnz		CLIPRIGHT_DRAW_COMPLEX_LINE
-						//drawing simple line
-						or al, al
-						jz		CLIPRIGHT_NEXT_SEGMENT
-						mov		TEMP1, eax
-						CLIPRIGHT_START_SIMPLE_SEGMENT :
-					mov		al, [edx]	//empty space
-						add		edi, eax
-						mov		cl, [edx + 1]
-						add		edx, 2
-						sub		CURCLIP, eax
-						jg		CLIPRIGHT_TRY_TO_CLIP
-						//full clipping until the end of line
-						add		esi, ecx
-						dec		TEMP1
-						jnz		CLIPRIGHT_START_SIMPLE_SEGMENT
-						dec		NLines
-						jnz		CLIPRIGHT_START_SCANLINE
-						jmp		CLIPRIGHT_END_DRAW_PICTURE
-						CLIPRIGHT_TRY_TO_CLIP :
-					cmp		CURCLIP, ecx
-						jl		CLIPRIGHT_PARTIAL_SIMPLE
-						sub		CURCLIP, ecx
-						jmp		CLIPRIGHT_DRAW_SIMPLE_SEGMENT
-						CLIPRIGHT_PARTIAL_SIMPLE :
-					//partial clipping
-					sub		ecx, CURCLIP
-						mov		ADDESI, ecx
-						mov		ecx, CURCLIP
-						mov		CURCLIP, -1
-						CLIPRIGHT_DRAW_SIMPLE_SEGMENT :
-						//*****************************************//
-						//put various code with encoding&loop there//
-						//*****************************************//
-						or cl, cl
-						jz		MPL4_1
-						xor		eax, eax
-						MPL4_0 : mov		al, [edi]
-						mov		ah, [esi]
-						mov		al, [ebx + eax]
-						inc		esi
-						stosb
-						dec		cl
-						jnz		MPL4_0
-						MPL4_1 : xor		eax, eax
-						//*****************************************//
-						//          end of variation zone          //
-						//*****************************************//
-						add		esi, ADDESI
-						dec		TEMP1
-						jnz		CLIPRIGHT_START_SIMPLE_SEGMENT
-						CLIPRIGHT_NEXT_SEGMENT :
-					dec		NLines
-						jnz		CLIPRIGHT_START_SCANLINE
-						jmp		CLIPRIGHT_END_DRAW_PICTURE
-						CLIPRIGHT_DRAW_COMPLEX_LINE :
-					//complex packed line
-					mov		SPACE_MASK, 0
-						mov		PIX_MASK, 0
-						test	al, 64
-						jz		CLIPRIGHT_DCL1
-						mov		SPACE_MASK, 16
-						CLIPRIGHT_DCL1:		test	al, 32
-						jz		CLIPRIGHT_DCL2
-						mov		PIX_MASK, 16
-						CLIPRIGHT_DCL2 : and		al, 31
-						jz		CLIPRIGHT_NEXT_SEGMENT
-						mov		TEMP1, eax
-						CLIPRIGHT_START_COMPLEX_SEGMENT :
-					mov		al, [edx]
-						mov		cl, al
-						and		al, 15
-						or al, SPACE_MASK
-						add		edi, eax
-						shr		cl, 4
-						or cl, PIX_MASK
-						inc		edx
-						sub		CURCLIP, eax
-						jg		CLIPRIGHT_TRY_TO_CLIP_COMPLEX
-						//full clipping until the end of line
-						add		esi, ecx
-						dec		TEMP1
-						jnz		CLIPRIGHT_START_COMPLEX_SEGMENT
-						dec		NLines
-						jnz		CLIPRIGHT_START_SCANLINE
-						jmp		CLIPRIGHT_END_DRAW_PICTURE
-						CLIPRIGHT_TRY_TO_CLIP_COMPLEX :
-					cmp		CURCLIP, ecx
-						jl		CLIPRIGHT_PARTIAL_COMPLEX
-						sub		CURCLIP, ecx
-						jmp		CLIPRIGHT_DRAW_COMPLEX_SEGMENT
-						CLIPRIGHT_PARTIAL_COMPLEX :
-					//partial clipping
-					sub		ecx, CURCLIP
-						mov		ADDESI, ecx
-						mov		ecx, CURCLIP
-						mov		CURCLIP, -1
-						CLIPRIGHT_DRAW_COMPLEX_SEGMENT :
-						//*****************************************//
-						//put various code with encoding&loop there//
-						//*****************************************//
-						or cl, cl
-						jz		MPL5_1
-						xor		eax, eax
-						MPL5_0 : mov		al, [edi]
-						mov		ah, [esi]
-						mov		al, [ebx + eax]
-						inc		esi
-						stosb
-						dec		cl
-						jnz		MPL5_0
-						MPL5_1 : xor		eax, eax
-						//*****************************************//
-						//          end of variation zone          //
-						//*****************************************//
-						add		esi, ADDESI
-						dec		TEMP1
-						jnz		CLIPRIGHT_START_COMPLEX_SEGMENT
-						dec		NLines
-						jnz		CLIPRIGHT_START_SCANLINE
-						CLIPRIGHT_END_DRAW_PICTURE :
-					//end code
-					pop		edi
-						pop		esi
-						popf
-				};
-			};
-		};
-	};
-};
+	GP_ShowMasked( GPB_MULTIPAL, false, x, y, Pic, CData, Encoder, nullptr );
+}
+
 void GP_ShowMaskedMultiPalPictInv( int x, int y, GP_Header* Pic, byte* CData, byte* Encoder )
 {
-	x -= Pic->dx;
-	y += Pic->dy;
-	int Lx = Pic->Lx;
-	int NLines = Pic->NLines;
-	int ofst = int( Pic ) + 23;
-	if (y + NLines <= WindY || x - Lx >= WindX1 || x<WindX || y>WindY1)return;
-	//vertical clipping
-	//top clipper
-	int CDPOS = int( CData );
-	if (y < WindY)
-	{
-		__asm {
-			mov		ecx, WindY
-			sub		ecx, y
-			sub		NLines, ecx
-			add		y, ecx
-			mov		ebx, ofst
-			xor		eax, eax
-			xor		edx, edx
-			NLINE : mov		al, [ebx]
-					test	al, 128
-					jz		SIMPLE_LINE
-					inc		ebx
-					mov		ah, al
-					and		al, 31
-					or al, al
-					jz		COMPLINE_1
-					and		ah, 32
-					shr		ah, 1
-					COMPLINE_LOOP1:
-			mov		dl, [ebx]
-				shr		dl, 4
-				or dl, ah
-				add		CDPOS, edx
-				inc		ebx
-				dec		al
-				jnz		COMPLINE_LOOP1
-				COMPLINE_1 :
-			xor		eax, eax
-				dec		ecx
-				jnz		NLINE
-				jmp		END_VCLIP
-				SIMPLE_LINE : inc		ebx
-				or eax, eax
-				jz		SIMPLINE_1
-				SIMPLINE_LOOP1 :
-			mov		dl, [ebx + 1]
-				add		CDPOS, edx
-				add		ebx, 2
-				dec		al
-				jnz		SIMPLINE_LOOP1
-				SIMPLINE_1 : dec		ecx
-				jnz		NLINE
-				END_VCLIP : mov		ofst, ebx
-		};
-	};
-	//bottom clipper
-	if (y + NLines > WindY1)NLines = WindY1 - y + 1;
-	//horisontal clipper
-	int x1 = x - Lx + 1;
-	int scrofs = int( ScreenPtr ) + x + y*ScrWidth;
-	int TEMP1;
-	int LineStart;
-	int CLIP;
-	int CURCLIP;
-	byte SPACE_MASK;
-	byte PIX_MASK;
-	if (x1 >= WindX&&x <= WindX1)
-	{
-		//***********************************************************//
-		//******************(((((((((((())))))))))))*****************//
-		//**                      NO CLIPPING                      **//INVERTED
-		//******************(((((((((((())))))))))))*****************//
-		//***********************************************************//
-				//no clipping
-		__asm {
-			pushf
-			push	esi
-			push	edi
-			//initialisation
-			mov		edi, scrofs			//edi-screen pointer
-			mov		esi, CDPOS			//esi-points array
-			mov		ebx, Encoder			//ebx-encoding pointer
-			mov		edx, ofst			//edx-mask offset
-			xor		eax, eax
-			xor		ecx, ecx
-			cld
-			sub		edi, ScrWidth
-			mov		LineStart, edi
-			START_SCANLINE :
-			mov		edi, LineStart
-				mov		al, [edx]
-				inc		edx
-				add		edi, ScrWidth
-				or al, al
-				mov		LineStart, edi
-				jnz		DRAW_LINE
-				dec		NLines
-				jnz		START_SCANLINE
-				jmp		END_DRAW_PICTURE
-				DRAW_LINE : test	al, 128
-				jnz		DRAW_COMPLEX_LINE
-				//drawing simple line
-				or al, al
-				jz		NEXT_SEGMENT
-				mov		TEMP1, eax
-				START_SIMPLE_SEGMENT :
-			mov		al, [edx]	//empty space
-				sub		edi, eax
-				mov		cl, [edx + 1]
-				add		edx, 2
-				//*****************************************//
-				//put various code with encoding&loop there//INVERTED
-				//*****************************************//
-				or cl, cl
-				jz		MPL0_1
-				xor		eax, eax
-				MPL0_0 : mov		al, [edi]
-				mov		ah, [esi]
-				mov		al, [ebx + eax]
-				inc		esi
-				mov[edi], al
-				dec		edi
-				dec		cl
-				jnz		MPL0_0
-				MPL0_1 : xor		eax, eax
-				//*****************************************//
-				//          end of variation zone          //INVERTED
-				//*****************************************//
-				dec		TEMP1
-				jnz		START_SIMPLE_SEGMENT
-				NEXT_SEGMENT :
-			dec		NLines
-				jnz		START_SCANLINE
-				jmp		END_DRAW_PICTURE
-				DRAW_COMPLEX_LINE :
-			//complex packed line
-			mov		SPACE_MASK, 0
-				mov		PIX_MASK, 0
-				test	al, 64
-				jz		DCL1
-				mov		SPACE_MASK, 16
-				DCL1:		test	al, 32
-				jz		DCL2
-				mov		PIX_MASK, 16
-				DCL2 : and		al, 31
-				jz		NEXT_SEGMENT
-				mov		TEMP1, eax
-				START_COMPLEX_SEGMENT :
-			mov		al, [edx]
-				mov		cl, al
-				and		al, 15
-				or al, SPACE_MASK
-				sub		edi, eax
-				shr		cl, 4
-				or cl, PIX_MASK
-				inc		edx
-				//*****************************************//
-				//put various code with encoding&loop there//INVERTED
-				//*****************************************//
-				or cl, cl
-				jz		MPL1_1
-				xor		eax, eax
-				MPL1_0 : mov		al, [edi]
-				mov		ah, [esi]
-				mov		al, [ebx + eax]
-				inc		esi
-				mov[edi], al
-				dec		edi
-				dec		cl
-				jnz		MPL1_0
-				MPL1_1 : xor		eax, eax
-				//*****************************************//
-				//          end of variation zone          //INVERTED
-				//*****************************************//
-				dec		TEMP1
-				jnz		START_COMPLEX_SEGMENT
-				dec		NLines
-				jnz		START_SCANLINE
-				END_DRAW_PICTURE :
-			//end code
-			pop		edi
-				pop		esi
-				popf
-		};
-	}
-	else
-	{
-		//image must be clipped
-		if (x > WindX1)
-		{
-			//****************************************************************//
-			//****************************************************************//
-			//**                                                            **//
-			//**					clipping RIGT(old-LEFT) edge						**//INVERTED
-			//**                                                            **//
-			//****************************************************************//
-			//****************************************************************//
-			CLIP = x - WindX1;
-			__asm {
-				pushf
-				push	esi
-				push	edi
-				//initialisation
-				mov		edi, scrofs			//edi-screen pointer
-				mov		esi, CDPOS			//esi-points array
-				mov		ebx, Encoder			//ebx-encoding pointer
-				mov		edx, ofst			//edx-mask offset
-				xor		eax, eax
-				xor		ecx, ecx
-				cld
-				sub		edi, ScrWidth
-				mov		LineStart, edi
-				CLIPLEFT_START_SCANLINE :
-				mov		edi, LineStart
-					mov		al, [edx]
-					inc		edx
-					xchg	CLIP, edx
-					add		edi, ScrWidth
-					mov		CURCLIP, edx
-					or al, al
-					xchg	CLIP, edx
-					mov		LineStart, edi
-					jnz		CLIPLEFT_DRAW_LINE
-					dec		NLines
-					jnz		CLIPLEFT_START_SCANLINE
-					jmp		CLIPLEFT_END_DRAW_PICTURE
-					CLIPLEFT_DRAW_LINE : test	al, 128
-					jnz		CLIPLEFT_DRAW_COMPLEX_LINE
-					//drawing simple line
-					or al, al
-					jz		CLIPLEFT_NEXT_SEGMENT
-					mov		TEMP1, eax
-					CLIPLEFT_START_SIMPLE_SEGMENT :
-				mov		al, [edx]	//empty space
-					sub		edi, eax
-					mov		cl, [edx + 1]
-					add		edx, 2
-					sub		CURCLIP, eax
-					jle		CLIPLEFT_DRAW_SIMPLE_SEGMENT
-					cmp		CURCLIP, ecx
-					jl		CLIPLEFT_PARTIAL_SIMPLE
-					//full  clipping
-					sub		CURCLIP, ecx
-					add		esi, ecx
-					sub		edi, ecx
-					dec		TEMP1
-					jnz		CLIPLEFT_START_SIMPLE_SEGMENT
-					dec		NLines
-					jnz		CLIPLEFT_START_SCANLINE
-					jmp		CLIPLEFT_END_DRAW_PICTURE
-					CLIPLEFT_PARTIAL_SIMPLE :
-				//partial clipping
-				add		esi, CURCLIP
-					sub		edi, CURCLIP
-					sub		ecx, CURCLIP
-					mov		CURCLIP, -1
-					CLIPLEFT_DRAW_SIMPLE_SEGMENT :
-					//*****************************************//
-					//put various code with encoding&loop there//INVERTED
-					//*****************************************//
-					or cl, cl
-					jz		MPL2_1
-					xor		eax, eax
-					MPL2_0 : mov		al, [edi]
-					mov		ah, [esi]
-					mov		al, [ebx + eax]
-					inc		esi
-					mov[edi], al
-					dec		edi
-					dec		cl
-					jnz		MPL2_0
-					MPL2_1 : xor		eax, eax
-					//*****************************************//
-					//          end of variation zone          //INVERTED
-					//*****************************************//
-					dec		TEMP1
-					jnz		CLIPLEFT_START_SIMPLE_SEGMENT
-					CLIPLEFT_NEXT_SEGMENT :
-				dec		NLines
-					jnz		CLIPLEFT_START_SCANLINE
-					jmp		CLIPLEFT_END_DRAW_PICTURE
-					CLIPLEFT_DRAW_COMPLEX_LINE :
-				//complex packed line
-				mov		SPACE_MASK, 0
-					mov		PIX_MASK, 0
-					test	al, 64
-					jz		CLIPLEFT_DCL1
-					mov		SPACE_MASK, 16
-					CLIPLEFT_DCL1:	test	al, 32
-					jz		CLIPLEFT_DCL2
-					mov		PIX_MASK, 16
-					CLIPLEFT_DCL2 : and		al, 31
-					jz		CLIPLEFT_NEXT_SEGMENT
-					mov		TEMP1, eax
-					CLIPLEFT_START_COMPLEX_SEGMENT :
-				mov		al, [edx]
-					mov		cl, al
-					and		al, 15
-					or al, SPACE_MASK
-					sub		edi, eax
-					shr		cl, 4
-					or cl, PIX_MASK
-					inc		edx
-					sub		CURCLIP, eax
-					jle		CLIPLEFT_DRAW_COMPLEX_SEGMENT
-					cmp		CURCLIP, ecx
-					jl		CLIPLEFT_PARTIAL_COMPLEX
-					//full  clipping
-					sub		CURCLIP, ecx
-					add		esi, ecx
-					sub		edi, ecx
-					dec		TEMP1
-					jnz		CLIPLEFT_START_COMPLEX_SEGMENT
-					dec		NLines
-					jnz		CLIPLEFT_START_SCANLINE
-					jmp		CLIPLEFT_END_DRAW_PICTURE
-					CLIPLEFT_PARTIAL_COMPLEX :
-				//partial clipping
-				add		esi, CURCLIP
-					sub		edi, CURCLIP
-					sub		ecx, CURCLIP
-					mov		CURCLIP, -1
-					CLIPLEFT_DRAW_COMPLEX_SEGMENT :
-					//*****************************************//
-					//put various code with encoding&loop there//INVERTED
-					//*****************************************//
-					or cl, cl
-					jz		MPL3_1
-					xor		eax, eax
-					MPL3_0 : mov		al, [edi]
-					mov		ah, [esi]
-					mov		al, [ebx + eax]
-					inc		esi
-					mov[edi], al
-					dec		edi
-					dec		cl
-					jnz		MPL3_0
-					MPL3_1 : xor		eax, eax
-					//*****************************************//
-					//          end of variation zone          //INVERTED
-					//*****************************************//
-					dec		TEMP1
-					jnz		CLIPLEFT_START_COMPLEX_SEGMENT
-					dec		NLines
-					jnz		CLIPLEFT_START_SCANLINE
-					CLIPLEFT_END_DRAW_PICTURE :
-				//end code
-				pop		edi
-					pop		esi
-					popf
-			};
-		}
-		else
-		{
-			if (x1 < WindX1)
-			{
-				//****************************************************************//
-				//****************************************************************//
-				//**      **     **                                **    **     **//
-				//****************   clipping LEFT(old-RIGHT) edge  **************//INVERTED
-				//**      **     **                                **    **     **//
-				//****************************************************************//
-				//****************************************************************//
-				CLIP = x - WindX + 1;
-				int ADDESI;
-				__asm {
-					pushf
-					push	esi
-					push	edi
-					//initialisation
-					mov		edi, scrofs			//edi-screen pointer
-					mov		esi, CDPOS			//esi-points array
-					mov		ebx, Encoder			//ebx-encoding pointer
-					mov		edx, ofst			//edx-mask offset
-					xor		eax, eax
-					xor		ecx, ecx
-					cld
-					sub		edi, ScrWidth
-					mov		LineStart, edi
-					CLIPRIGHT_START_SCANLINE :
-					mov		edi, LineStart
-						mov		al, [edx]
-						inc		edx
-						mov		ADDESI, 0
-						xchg	CLIP, edx
-						add		edi, ScrWidth
-						mov		CURCLIP, edx
-						or al, al
-						xchg	CLIP, edx
-						mov		LineStart, edi
-						jnz		CLIPRIGHT_DRAW_LINE
-						dec		NLines
-						jnz		CLIPRIGHT_START_SCANLINE
-						jmp		CLIPRIGHT_END_DRAW_PICTURE
-						CLIPRIGHT_DRAW_LINE :
-					test	al, 128
-						jnz		CLIPRIGHT_DRAW_COMPLEX_LINE
-						//drawing simple line
-						or al, al
-						jz		CLIPRIGHT_NEXT_SEGMENT
-						mov		TEMP1, eax
-						CLIPRIGHT_START_SIMPLE_SEGMENT :
-					mov		al, [edx]	//empty space
-						sub		edi, eax
-						mov		cl, [edx + 1]
-						add		edx, 2
-						sub		CURCLIP, eax
-						jg		CLIPRIGHT_TRY_TO_CLIP
-						//full clipping until the end of line
-						add		esi, ecx
-						dec		TEMP1
-						jnz		CLIPRIGHT_START_SIMPLE_SEGMENT
-						dec		NLines
-						jnz		CLIPRIGHT_START_SCANLINE
-						jmp		CLIPRIGHT_END_DRAW_PICTURE
-						CLIPRIGHT_TRY_TO_CLIP :
-					cmp		CURCLIP, ecx
-						jl		CLIPRIGHT_PARTIAL_SIMPLE
-						sub		CURCLIP, ecx
-						jmp		CLIPRIGHT_DRAW_SIMPLE_SEGMENT
-						CLIPRIGHT_PARTIAL_SIMPLE :
-					//partial clipping
-					sub		ecx, CURCLIP
-						mov		ADDESI, ecx
-						mov		ecx, CURCLIP
-						mov		CURCLIP, -1
-						CLIPRIGHT_DRAW_SIMPLE_SEGMENT :
-						//*****************************************//
-						//put various code with encoding&loop there//INVERTED
-						//*****************************************//
-						or cl, cl
-						jz		MPL4_1
-						xor		eax, eax
-						MPL4_0 : mov		al, [edi]
-						mov		ah, [esi]
-						mov		al, [ebx + eax]
-						inc		esi
-						mov[edi], al
-						dec		edi
-						dec		cl
-						jnz		MPL4_0
-						MPL4_1 : xor		eax, eax
-						//*****************************************//
-						//          end of variation zone          //INVERTED
-						//*****************************************//
-						add		esi, ADDESI
-						dec		TEMP1
-						jnz		CLIPRIGHT_START_SIMPLE_SEGMENT
-						CLIPRIGHT_NEXT_SEGMENT :
-					dec		NLines
-						jnz		CLIPRIGHT_START_SCANLINE
-						jmp		CLIPRIGHT_END_DRAW_PICTURE
-						CLIPRIGHT_DRAW_COMPLEX_LINE :
-					//complex packed line
-					mov		SPACE_MASK, 0
-						mov		PIX_MASK, 0
-						test	al, 64
-						jz		CLIPRIGHT_DCL1
-						mov		SPACE_MASK, 16
-						CLIPRIGHT_DCL1:		test	al, 32
-						jz		CLIPRIGHT_DCL2
-						mov		PIX_MASK, 16
-						CLIPRIGHT_DCL2 : and		al, 31
-						jz		CLIPRIGHT_NEXT_SEGMENT
-						mov		TEMP1, eax
-						CLIPRIGHT_START_COMPLEX_SEGMENT :
-					mov		al, [edx]
-						mov		cl, al
-						and		al, 15
-						or al, SPACE_MASK
-						sub		edi, eax
-						shr		cl, 4
-						or cl, PIX_MASK
-						inc		edx
-						sub		CURCLIP, eax
-						jg		CLIPRIGHT_TRY_TO_CLIP_COMPLEX
-						//full clipping until the end of line
-						add		esi, ecx
-						dec		TEMP1
-						jnz		CLIPRIGHT_START_COMPLEX_SEGMENT
-						dec		NLines
-						jnz		CLIPRIGHT_START_SCANLINE
-						jmp		CLIPRIGHT_END_DRAW_PICTURE
-						CLIPRIGHT_TRY_TO_CLIP_COMPLEX :
-					cmp		CURCLIP, ecx
-						jl		CLIPRIGHT_PARTIAL_COMPLEX
-						sub		CURCLIP, ecx
-						jmp		CLIPRIGHT_DRAW_COMPLEX_SEGMENT
-						CLIPRIGHT_PARTIAL_COMPLEX :
-					//partial clipping
-					sub		ecx, CURCLIP
-						mov		ADDESI, ecx
-						mov		ecx, CURCLIP
-						mov		CURCLIP, -1
-						CLIPRIGHT_DRAW_COMPLEX_SEGMENT :
-						//*****************************************//
-						//put various code with encoding&loop there//INVERTED
-						//*****************************************//
-						or cl, cl
-						jz		MPL5_1
-						xor		eax, eax
-						MPL5_0 : mov		al, [edi]
-						mov		ah, [esi]
-						mov		al, [ebx + eax]
-						inc		esi
-						mov[edi], al
-						dec		edi
-						dec		cl
-						jnz		MPL5_0
-						MPL5_1 : xor		eax, eax
-						//*****************************************//
-						//          end of variation zone          //INVERTED
-						//*****************************************//
-						add		esi, ADDESI
-						dec		TEMP1
-						jnz		CLIPRIGHT_START_COMPLEX_SEGMENT
-						dec		NLines
-						jnz		CLIPRIGHT_START_SCANLINE
-						CLIPRIGHT_END_DRAW_PICTURE :
-					//end code
-					pop		edi
-						pop		esi
-						popf
-				};
-			};
-		};
-	};
-};
-//key word: MULTIDRAW
-//******************************************************************************//
-//******************************************************************************//
-//******************************************************************************//
-//****																		****//
-//****																		****//
-//****			      COMPOSED WITH BACKGROUND PICTURE(TRANSPOSED)			****//
-//****																		****//
-//****																		****//
-//******************************************************************************//
-//******************************************************************************//
-//******************************************************************************//
-void GP_ShowMaskedMultiPalTPict( int x, int y, GP_Header* Pic, byte* CData, byte* Encoder )
-{
-	x += Pic->dx;
-	y += Pic->dy;
-	int Lx = Pic->Lx;
-	int NLines = Pic->NLines;
-	int ofst = int( Pic ) + 23;
-	if (y + NLines <= WindY || x + Lx <= WindX || x > WindX1 || y > WindY1)return;
-	//vertical clipping
-	//top clipper
-	int CDPOS = int( CData );
-	if (y < WindY)
-	{
-		__asm {
-			mov		ecx, WindY
-			sub		ecx, y
-			sub		NLines, ecx
-			add		y, ecx
-			mov		ebx, ofst
-			xor		eax, eax
-			xor		edx, edx
-			NLINE : mov		al, [ebx]
-					test	al, 128
-					jz		SIMPLE_LINE
-					inc		ebx
-					mov		ah, al
-					and		al, 31
-					or al, al
-					jz		COMPLINE_1
-					and		ah, 32
-					shr		ah, 1
-					COMPLINE_LOOP1:
-			mov		dl, [ebx]
-				shr		dl, 4
-				or dl, ah
-				add		CDPOS, edx
-				inc		ebx
-				dec		al
-				jnz		COMPLINE_LOOP1
-				COMPLINE_1 :
-			xor		eax, eax
-				dec		ecx
-				jnz		NLINE
-				jmp		END_VCLIP
-				SIMPLE_LINE : inc		ebx
-				or eax, eax
-				jz		SIMPLINE_1
-				SIMPLINE_LOOP1 :
-			mov		dl, [ebx + 1]
-				add		CDPOS, edx
-				add		ebx, 2
-				dec		al
-				jnz		SIMPLINE_LOOP1
-				SIMPLINE_1 : dec		ecx
-				jnz		NLINE
-				END_VCLIP : mov		ofst, ebx
-		};
-	};
-	//bottom clipper
-	if (y + NLines > WindY1)NLines = WindY1 - y + 1;
-	//horisontal clipper
-	int x1 = x + Lx - 1;
-	int scrofs = int( ScreenPtr ) + x + y*ScrWidth;
-	int TEMP1;
-	int LineStart;
-	int CLIP;
-	int CURCLIP;
-	byte SPACE_MASK;
-	byte PIX_MASK;
-	if (x >= WindX&&x1 <= WindX1)
-	{
-		//***********************************************************//
-		//******************(((((((((((())))))))))))*****************//
-		//**                      NO CLIPPING                      **//
-		//******************(((((((((((())))))))))))*****************//
-		//***********************************************************//
-				//no clipping
-		__asm {
-			pushf
-			push	esi
-			push	edi
-			//initialisation
-			mov		edi, scrofs			//edi-screen pointer
-			mov		esi, CDPOS			//esi-points array
-			mov		ebx, Encoder			//ebx-encoding pointer
-			mov		edx, ofst			//edx-mask offset
-			xor		eax, eax
-			xor		ecx, ecx
-			cld
-			sub		edi, ScrWidth
-			mov		LineStart, edi
-			START_SCANLINE :
-			mov		edi, LineStart
-				mov		al, [edx]
-				inc		edx
-				add		edi, ScrWidth
-				or al, al
-				mov		LineStart, edi
-				jnz		DRAW_LINE
-				dec		NLines
-				jnz		START_SCANLINE
-				jmp		END_DRAW_PICTURE
-				DRAW_LINE : test	al, 128
-				jnz		DRAW_COMPLEX_LINE
-				//drawing simple line
-				or al, al
-				jz		NEXT_SEGMENT
-				mov		TEMP1, eax
-				START_SIMPLE_SEGMENT :
-			mov		al, [edx]	//empty space
-				add		edi, eax
-				mov		cl, [edx + 1]
-				add		edx, 2
-				//*****************************************//
-				//put various code with encoding&loop there//
-				//*****************************************//
-				or cl, cl
-				jz		MPL0_1
-				xor		eax, eax
-				MPL0_0 : mov		ah, [edi]
-				lodsb
-				mov		al, [ebx + eax]
-				stosb
-				dec		cl
-				jnz		MPL0_0
-				MPL0_1 : xor		eax, eax
-				//*****************************************//
-				//          end of variation zone          //
-				//*****************************************//
-				dec		TEMP1
-				jnz		START_SIMPLE_SEGMENT
-				NEXT_SEGMENT :
-			dec		NLines
-				jnz		START_SCANLINE
-				jmp		END_DRAW_PICTURE
-				DRAW_COMPLEX_LINE :
-			//complex packed line
-			mov		SPACE_MASK, 0
-				mov		PIX_MASK, 0
-				test	al, 64
-				jz		DCL1
-				mov		SPACE_MASK, 16
-				DCL1:		test	al, 32
-				jz		DCL2
-				mov		PIX_MASK, 16
-				DCL2 : and		al, 31
-				jz		NEXT_SEGMENT
-				mov		TEMP1, eax
-				START_COMPLEX_SEGMENT :
-			mov		al, [edx]
-				mov		cl, al
-				and		al, 15
-				or al, SPACE_MASK
-				add		edi, eax
-				shr		cl, 4
-				or cl, PIX_MASK
-				inc		edx
-				//*****************************************//
-				//put various code with encoding&loop there//
-				//*****************************************//
-				or cl, cl
-				jz		MPL1_1
-				xor		eax, eax
-				MPL1_0 : mov		ah, [edi]
-				lodsb
-				mov		al, [ebx + eax]
-				stosb
-				dec		cl
-				jnz		MPL1_0
-				MPL1_1 : xor		eax, eax
-				//*****************************************//
-				//          end of variation zone          //
-				//*****************************************//
-				dec		TEMP1
-				jnz		START_COMPLEX_SEGMENT
-				dec		NLines
-				jnz		START_SCANLINE
-				END_DRAW_PICTURE :
-			//end code
-			pop		edi
-				pop		esi
-				popf
-		};
-	}
-	else
-	{
-		//image must be clipped
-		if (x < WindX)
-		{
-			//****************************************************************//
-			//****************************************************************//
-			//**                                                            **//
-			//**					clipping LEFT edge						**//
-			//**                                                            **//
-			//****************************************************************//
-			//****************************************************************//
-			CLIP = WindX - x;
-			__asm {
-				pushf
-				push	esi
-				push	edi
-				//initialisation
-				mov		edi, scrofs			//edi-screen pointer
-				mov		esi, CDPOS			//esi-points array
-				mov		ebx, Encoder			//ebx-encoding pointer
-				mov		edx, ofst			//edx-mask offset
-				xor		eax, eax
-				xor		ecx, ecx
-				cld
-				sub		edi, ScrWidth
-				mov		LineStart, edi
-				CLIPLEFT_START_SCANLINE :
-				mov		edi, LineStart
-					mov		al, [edx]
-					inc		edx
-					xchg	CLIP, edx
-					add		edi, ScrWidth
-					mov		CURCLIP, edx
-					or al, al
-					xchg	CLIP, edx
-					mov		LineStart, edi
-					jnz		CLIPLEFT_DRAW_LINE
-					dec		NLines
-					jnz		CLIPLEFT_START_SCANLINE
-					jmp		CLIPLEFT_END_DRAW_PICTURE
-					CLIPLEFT_DRAW_LINE : test	al, 128
-					jnz		CLIPLEFT_DRAW_COMPLEX_LINE
-					//drawing simple line
-					or al, al
-					jz		CLIPLEFT_NEXT_SEGMENT
-					mov		TEMP1, eax
-					CLIPLEFT_START_SIMPLE_SEGMENT :
-				mov		al, [edx]	//empty space
-					add		edi, eax
-					mov		cl, [edx + 1]
-					add		edx, 2
-					sub		CURCLIP, eax
-					jle		CLIPLEFT_DRAW_SIMPLE_SEGMENT
-					cmp		CURCLIP, ecx
-					jl		CLIPLEFT_PARTIAL_SIMPLE
-					//full  clipping
-					sub		CURCLIP, ecx
-					add		esi, ecx
-					add		edi, ecx
-					dec		TEMP1
-					jnz		CLIPLEFT_START_SIMPLE_SEGMENT
-					dec		NLines
-					jnz		CLIPLEFT_START_SCANLINE
-					jmp		CLIPLEFT_END_DRAW_PICTURE
-					CLIPLEFT_PARTIAL_SIMPLE :
-				//partial clipping
-				add		esi, CURCLIP
-					add		edi, CURCLIP
-					sub		ecx, CURCLIP
-					mov		CURCLIP, -1
-					CLIPLEFT_DRAW_SIMPLE_SEGMENT :
-					//*****************************************//
-					//put various code with encoding&loop there//
-					//*****************************************//
-					or cl, cl
-					jz		MPL2_1
-					xor		eax, eax
-					MPL2_0 : mov		ah, [edi]
-					lodsb
-					mov		al, [ebx + eax]
-					stosb
-					dec		cl
-					jnz		MPL2_0
-					MPL2_1 : xor		eax, eax
-					//*****************************************//
-					//          end of variation zone          //
-					//*****************************************//
-					dec		TEMP1
-					jnz		CLIPLEFT_START_SIMPLE_SEGMENT
-					CLIPLEFT_NEXT_SEGMENT :
-				dec		NLines
-					jnz		CLIPLEFT_START_SCANLINE
-					jmp		CLIPLEFT_END_DRAW_PICTURE
-					CLIPLEFT_DRAW_COMPLEX_LINE :
-				//complex packed line
-				mov		SPACE_MASK, 0
-					mov		PIX_MASK, 0
-					test	al, 64
-					jz		CLIPLEFT_DCL1
-					mov		SPACE_MASK, 16
-					CLIPLEFT_DCL1:	test	al, 32
-					jz		CLIPLEFT_DCL2
-					mov		PIX_MASK, 16
-					CLIPLEFT_DCL2 : and		al, 31
-					jz		CLIPLEFT_NEXT_SEGMENT
-					mov		TEMP1, eax
-					CLIPLEFT_START_COMPLEX_SEGMENT :
-				mov		al, [edx]
-					mov		cl, al
-					and		al, 15
-					or al, SPACE_MASK
-					add		edi, eax
-					shr		cl, 4
-					or cl, PIX_MASK
-					inc		edx
-					sub		CURCLIP, eax
-					jle		CLIPLEFT_DRAW_COMPLEX_SEGMENT
-					cmp		CURCLIP, ecx
-					jl		CLIPLEFT_PARTIAL_COMPLEX
-					//full  clipping
-					sub		CURCLIP, ecx
-					add		esi, ecx
-					add		edi, ecx
-					dec		TEMP1
-					jnz		CLIPLEFT_START_COMPLEX_SEGMENT
-					dec		NLines
-					jnz		CLIPLEFT_START_SCANLINE
-					jmp		CLIPLEFT_END_DRAW_PICTURE
-					CLIPLEFT_PARTIAL_COMPLEX :
-				//partial clipping
-				add		esi, CURCLIP
-					add		edi, CURCLIP
-					sub		ecx, CURCLIP
-					mov		CURCLIP, -1
-					CLIPLEFT_DRAW_COMPLEX_SEGMENT :
-					//*****************************************//
-					//put various code with encoding&loop there//
-					//*****************************************//
-					or cl, cl
-					jz		MPL3_1
-					xor		eax, eax
-					MPL3_0 : mov		ah, [edi]
-					lodsb
-					mov		al, [ebx + eax]
-					stosb
-					dec		cl
-					jnz		MPL3_0
-					MPL3_1 : xor		eax, eax
-					//*****************************************//
-					//          end of variation zone          //
-					//*****************************************//
-					dec		TEMP1
-					jnz		CLIPLEFT_START_COMPLEX_SEGMENT
-					dec		NLines
-					jnz		CLIPLEFT_START_SCANLINE
-					CLIPLEFT_END_DRAW_PICTURE :
-				//end code
-				pop		edi
-					pop		esi
-					popf
-			};
-		}
-		else
-		{
-			if (x1 > WindX1)
-			{
-				//****************************************************************//
-				//****************************************************************//
-				//**      **     **                                **    **     **//
-				//****************   	clipping RIGHT edge			**************//
-				//**      **     **                                **    **     **//
-				//****************************************************************//
-				//****************************************************************//
-				CLIP = WindX1 - x + 1;
-				int ADDESI;
-				__asm {
-					pushf
-					push	esi
-					push	edi
-					//initialisation
-					mov		edi, scrofs			//edi-screen pointer
-					mov		esi, CDPOS			//esi-points array
-					mov		ebx, Encoder			//ebx-encoding pointer
-					mov		edx, ofst			//edx-mask offset
-					xor		eax, eax
-					xor		ecx, ecx
-					cld
-					sub		edi, ScrWidth
-					mov		LineStart, edi
-					CLIPRIGHT_START_SCANLINE :
-					mov		edi, LineStart
-						mov		al, [edx]
-						inc		edx
-						mov		ADDESI, 0
-						xchg	CLIP, edx
-						add		edi, ScrWidth
-						mov		CURCLIP, edx
-						or al, al
-						xchg	CLIP, edx
-						mov		LineStart, edi
-						jnz		CLIPRIGHT_DRAW_LINE
-						dec		NLines
-						jnz		CLIPRIGHT_START_SCANLINE
-						jmp		CLIPRIGHT_END_DRAW_PICTURE
-						CLIPRIGHT_DRAW_LINE :
-					test	al, 128
-						jnz		CLIPRIGHT_DRAW_COMPLEX_LINE
-						//drawing simple line
-						or al, al
-						jz		CLIPRIGHT_NEXT_SEGMENT
-						mov		TEMP1, eax
-						CLIPRIGHT_START_SIMPLE_SEGMENT :
-					mov		al, [edx]	//empty space
-						add		edi, eax
-						mov		cl, [edx + 1]
-						add		edx, 2
-						sub		CURCLIP, eax
-						jg		CLIPRIGHT_TRY_TO_CLIP
-						//full clipping until the end of line
-						add		esi, ecx
-						dec		TEMP1
-						jnz		CLIPRIGHT_START_SIMPLE_SEGMENT
-						dec		NLines
-						jnz		CLIPRIGHT_START_SCANLINE
-						jmp		CLIPRIGHT_END_DRAW_PICTURE
-						CLIPRIGHT_TRY_TO_CLIP :
-					cmp		CURCLIP, ecx
-						jl		CLIPRIGHT_PARTIAL_SIMPLE
-						sub		CURCLIP, ecx
-						jmp		CLIPRIGHT_DRAW_SIMPLE_SEGMENT
-						CLIPRIGHT_PARTIAL_SIMPLE :
-					//partial clipping
-					sub		ecx, CURCLIP
-						mov		ADDESI, ecx
-						mov		ecx, CURCLIP
-						mov		CURCLIP, -1
-						CLIPRIGHT_DRAW_SIMPLE_SEGMENT :
-						//*****************************************//
-						//put various code with encoding&loop there//
-						//*****************************************//
-						or cl, cl
-						jz		MPL4_1
-						xor		eax, eax
-						MPL4_0 : mov		ah, [edi]
-						lodsb
-						mov		al, [ebx + eax]
-						stosb
-						dec		cl
-						jnz		MPL4_0
-						MPL4_1 : xor		eax, eax
-						//*****************************************//
-						//          end of variation zone          //
-						//*****************************************//
-						add		esi, ADDESI
-						dec		TEMP1
-						jnz		CLIPRIGHT_START_SIMPLE_SEGMENT
-						CLIPRIGHT_NEXT_SEGMENT :
-					dec		NLines
-						jnz		CLIPRIGHT_START_SCANLINE
-						jmp		CLIPRIGHT_END_DRAW_PICTURE
-						CLIPRIGHT_DRAW_COMPLEX_LINE :
-					//complex packed line
-					mov		SPACE_MASK, 0
-						mov		PIX_MASK, 0
-						test	al, 64
-						jz		CLIPRIGHT_DCL1
-						mov		SPACE_MASK, 16
-						CLIPRIGHT_DCL1:		test	al, 32
-						jz		CLIPRIGHT_DCL2
-						mov		PIX_MASK, 16
-						CLIPRIGHT_DCL2 : and		al, 31
-						jz		CLIPRIGHT_NEXT_SEGMENT
-						mov		TEMP1, eax
-						CLIPRIGHT_START_COMPLEX_SEGMENT :
-					mov		al, [edx]
-						mov		cl, al
-						and		al, 15
-						or al, SPACE_MASK
-						add		edi, eax
-						shr		cl, 4
-						or cl, PIX_MASK
-						inc		edx
-						sub		CURCLIP, eax
-						jg		CLIPRIGHT_TRY_TO_CLIP_COMPLEX
-						//full clipping until the end of line
-						add		esi, ecx
-						dec		TEMP1
-						jnz		CLIPRIGHT_START_COMPLEX_SEGMENT
-						dec		NLines
-						jnz		CLIPRIGHT_START_SCANLINE
-						jmp		CLIPRIGHT_END_DRAW_PICTURE
-						CLIPRIGHT_TRY_TO_CLIP_COMPLEX :
-					cmp		CURCLIP, ecx
-						jl		CLIPRIGHT_PARTIAL_COMPLEX
-						sub		CURCLIP, ecx
-						jmp		CLIPRIGHT_DRAW_COMPLEX_SEGMENT
-						CLIPRIGHT_PARTIAL_COMPLEX :
-					//partial clipping
-					sub		ecx, CURCLIP
-						mov		ADDESI, ecx
-						mov		ecx, CURCLIP
-						mov		CURCLIP, -1
-						CLIPRIGHT_DRAW_COMPLEX_SEGMENT :
-						//*****************************************//
-						//put various code with encoding&loop there//
-						//*****************************************//
-						or cl, cl
-						jz		MPL5_1
-						xor		eax, eax
-						MPL5_0 : mov		ah, [edi]
-						lodsb
-						mov		al, [ebx + eax]
-						stosb
-						dec		cl
-						jnz		MPL5_0
-						MPL5_1 : xor		eax, eax
-						//*****************************************//
-						//          end of variation zone          //
-						//*****************************************//
-						add		esi, ADDESI
-						dec		TEMP1
-						jnz		CLIPRIGHT_START_COMPLEX_SEGMENT
-						dec		NLines
-						jnz		CLIPRIGHT_START_SCANLINE
-						CLIPRIGHT_END_DRAW_PICTURE :
-					//end code
-					pop		edi
-						pop		esi
-						popf
-				};
-			};
-		};
-	};
-};
+	GP_ShowMasked( GPB_MULTIPAL, true, x, y, Pic, CData, Encoder, nullptr );
+}
+
+void GP_ShowMaskedMultiPalTPict( int x, int y, GP_Header* Pic, byte* CData, byte* Encoder )
+{
+	GP_ShowMasked( GPB_MULTIPALT, false, x, y, Pic, CData, Encoder, nullptr );
+}
 
 void GP_ShowMaskedMultiPalTPictInv( int x, int y, GP_Header* Pic, byte* CData, byte* Encoder )
 {
-	x -= Pic->dx;
-	y += Pic->dy;
-	int Lx = Pic->Lx;
-	int NLines = Pic->NLines;
-	int ofst = int( Pic ) + 23;
-	if (y + NLines <= WindY || x - Lx >= WindX1 || x<WindX || y>WindY1)return;
-	//vertical clipping
-	//top clipper
-	int CDPOS = int( CData );
-	if (y < WindY)
-	{
-		__asm {
-			mov		ecx, WindY
-			sub		ecx, y
-			sub		NLines, ecx
-			add		y, ecx
-			mov		ebx, ofst
-			xor		eax, eax
-			xor		edx, edx
-			NLINE : mov		al, [ebx]
-					test	al, 128
-					jz		SIMPLE_LINE
-					inc		ebx
-					mov		ah, al
-					and		al, 31
-					or al, al
-					jz		COMPLINE_1
-					and		ah, 32
-					shr		ah, 1
-					COMPLINE_LOOP1:
-			mov		dl, [ebx]
-				shr		dl, 4
-				or dl, ah
-				add		CDPOS, edx
-				inc		ebx
-				dec		al
-				jnz		COMPLINE_LOOP1
-				COMPLINE_1 :
-			xor		eax, eax
-				dec		ecx
-				jnz		NLINE
-				jmp		END_VCLIP
-				SIMPLE_LINE : inc		ebx
-				or eax, eax
-				jz		SIMPLINE_1
-				SIMPLINE_LOOP1 :
-			mov		dl, [ebx + 1]
-				add		CDPOS, edx
-				add		ebx, 2
-				dec		al
-				jnz		SIMPLINE_LOOP1
-				SIMPLINE_1 : dec		ecx
-				jnz		NLINE
-				END_VCLIP : mov		ofst, ebx
-		};
-	};
-	//bottom clipper
-	if (y + NLines > WindY1)NLines = WindY1 - y + 1;
-	//horisontal clipper
-	int x1 = x - Lx + 1;
-	int scrofs = int( ScreenPtr ) + x + y*ScrWidth;
-	int TEMP1;
-	int LineStart;
-	int CLIP;
-	int CURCLIP;
-	byte SPACE_MASK;
-	byte PIX_MASK;
-	if (x1 >= WindX&&x <= WindX1)
-	{
-		//***********************************************************//
-		//******************(((((((((((())))))))))))*****************//
-		//**                      NO CLIPPING                      **//INVERTED
-		//******************(((((((((((())))))))))))*****************//
-		//***********************************************************//
-				//no clipping
-		__asm {
-			pushf
-			push	esi
-			push	edi
-			//initialisation
-			mov		edi, scrofs			//edi-screen pointer
-			mov		esi, CDPOS			//esi-points array
-			mov		ebx, Encoder			//ebx-encoding pointer
-			mov		edx, ofst			//edx-mask offset
-			xor		eax, eax
-			xor		ecx, ecx
-			cld
-			sub		edi, ScrWidth
-			mov		LineStart, edi
-			START_SCANLINE :
-			mov		edi, LineStart
-				mov		al, [edx]
-				inc		edx
-				add		edi, ScrWidth
-				or al, al
-				mov		LineStart, edi
-				jnz		DRAW_LINE
-				dec		NLines
-				jnz		START_SCANLINE
-				jmp		END_DRAW_PICTURE
-				DRAW_LINE : test	al, 128
-				jnz		DRAW_COMPLEX_LINE
-				//drawing simple line
-				or al, al
-				jz		NEXT_SEGMENT
-				mov		TEMP1, eax
-				START_SIMPLE_SEGMENT :
-			mov		al, [edx]	//empty space
-				sub		edi, eax
-				mov		cl, [edx + 1]
-				add		edx, 2
-				//*****************************************//
-				//put various code with encoding&loop there//INVERTED
-				//*****************************************//
-				or cl, cl
-				jz		MPL0_1
-				xor		eax, eax
-				MPL0_0 : mov		ah, [edi]
-				lodsb
-				mov		al, [ebx + eax]
-				mov[edi], al
-				dec		edi
-				dec		cl
-				jnz		MPL0_0
-				MPL0_1 : xor		eax, eax
-				//*****************************************//
-				//          end of variation zone          //INVERTED
-				//*****************************************//
-				dec		TEMP1
-				jnz		START_SIMPLE_SEGMENT
-				NEXT_SEGMENT :
-			dec		NLines
-				jnz		START_SCANLINE
-				jmp		END_DRAW_PICTURE
-				DRAW_COMPLEX_LINE :
-			//complex packed line
-			mov		SPACE_MASK, 0
-				mov		PIX_MASK, 0
-				test	al, 64
-				jz		DCL1
-				mov		SPACE_MASK, 16
-				DCL1:		test	al, 32
-				jz		DCL2
-				mov		PIX_MASK, 16
-				DCL2 : and		al, 31
-				jz		NEXT_SEGMENT
-				mov		TEMP1, eax
-				START_COMPLEX_SEGMENT :
-			mov		al, [edx]
-				mov		cl, al
-				and		al, 15
-				or al, SPACE_MASK
-				sub		edi, eax
-				shr		cl, 4
-				or cl, PIX_MASK
-				inc		edx
-				//*****************************************//
-				//put various code with encoding&loop there//INVERTED
-				//*****************************************//
-				or cl, cl
-				jz		MPL1_1
-				xor		eax, eax
-				MPL1_0 : mov		ah, [edi]
-				lodsb
-				mov		al, [ebx + eax]
-				mov[edi], al
-				dec		edi
-				dec		cl
-				jnz		MPL1_0
-				MPL1_1 : xor		eax, eax
-				//*****************************************//
-				//          end of variation zone          //INVERTED
-				//*****************************************//
-				dec		TEMP1
-				jnz		START_COMPLEX_SEGMENT
-				dec		NLines
-				jnz		START_SCANLINE
-				END_DRAW_PICTURE :
-			//end code
-			pop		edi
-				pop		esi
-				popf
-		};
-	}
-	else
-	{
-		//image must be clipped
-		if (x > WindX1)
-		{
-			//****************************************************************//
-			//****************************************************************//
-			//**                                                            **//
-			//**					clipping RIGT(old-LEFT) edge						**//INVERTED
-			//**                                                            **//
-			//****************************************************************//
-			//****************************************************************//
-			CLIP = x - WindX1;
-			__asm {
-				pushf
-				push	esi
-				push	edi
-				//initialisation
-				mov		edi, scrofs			//edi-screen pointer
-				mov		esi, CDPOS			//esi-points array
-				mov		ebx, Encoder			//ebx-encoding pointer
-				mov		edx, ofst			//edx-mask offset
-				xor		eax, eax
-				xor		ecx, ecx
-				cld
-				sub		edi, ScrWidth
-				mov		LineStart, edi
-				CLIPLEFT_START_SCANLINE :
-				mov		edi, LineStart
-					mov		al, [edx]
-					inc		edx
-					xchg	CLIP, edx
-					add		edi, ScrWidth
-					mov		CURCLIP, edx
-					or al, al
-					xchg	CLIP, edx
-					mov		LineStart, edi
-					jnz		CLIPLEFT_DRAW_LINE
-					dec		NLines
-					jnz		CLIPLEFT_START_SCANLINE
-					jmp		CLIPLEFT_END_DRAW_PICTURE
-					CLIPLEFT_DRAW_LINE : test	al, 128
-					jnz		CLIPLEFT_DRAW_COMPLEX_LINE
-					//drawing simple line
-					or al, al
-					jz		CLIPLEFT_NEXT_SEGMENT
-					mov		TEMP1, eax
-					CLIPLEFT_START_SIMPLE_SEGMENT :
-				mov		al, [edx]	//empty space
-					sub		edi, eax
-					mov		cl, [edx + 1]
-					add		edx, 2
-					sub		CURCLIP, eax
-					jle		CLIPLEFT_DRAW_SIMPLE_SEGMENT
-					cmp		CURCLIP, ecx
-					jl		CLIPLEFT_PARTIAL_SIMPLE
-					//full  clipping
-					sub		CURCLIP, ecx
-					add		esi, ecx
-					sub		edi, ecx
-					dec		TEMP1
-					jnz		CLIPLEFT_START_SIMPLE_SEGMENT
-					dec		NLines
-					jnz		CLIPLEFT_START_SCANLINE
-					jmp		CLIPLEFT_END_DRAW_PICTURE
-					CLIPLEFT_PARTIAL_SIMPLE :
-				//partial clipping
-				add		esi, CURCLIP
-					sub		edi, CURCLIP
-					sub		ecx, CURCLIP
-					mov		CURCLIP, -1
-					CLIPLEFT_DRAW_SIMPLE_SEGMENT :
-					//*****************************************//
-					//put various code with encoding&loop there//INVERTED
-					//*****************************************//
-					or cl, cl
-					jz		MPL2_1
-					xor		eax, eax
-					MPL2_0 : mov		ah, [edi]
-					lodsb
-					mov		al, [ebx + eax]
-					mov[edi], al
-					dec		edi
-					dec		cl
-					jnz		MPL2_0
-					MPL2_1 : xor		eax, eax
-					//*****************************************//
-					//          end of variation zone          //INVERTED
-					//*****************************************//
-					dec		TEMP1
-					jnz		CLIPLEFT_START_SIMPLE_SEGMENT
-					CLIPLEFT_NEXT_SEGMENT :
-				dec		NLines
-					jnz		CLIPLEFT_START_SCANLINE
-					jmp		CLIPLEFT_END_DRAW_PICTURE
-					CLIPLEFT_DRAW_COMPLEX_LINE :
-				//complex packed line
-				mov		SPACE_MASK, 0
-					mov		PIX_MASK, 0
-					test	al, 64
-					jz		CLIPLEFT_DCL1
-					mov		SPACE_MASK, 16
-					CLIPLEFT_DCL1:	test	al, 32
-					jz		CLIPLEFT_DCL2
-					mov		PIX_MASK, 16
-					CLIPLEFT_DCL2 : and		al, 31
-					jz		CLIPLEFT_NEXT_SEGMENT
-					mov		TEMP1, eax
-					CLIPLEFT_START_COMPLEX_SEGMENT :
-				mov		al, [edx]
-					mov		cl, al
-					and		al, 15
-					or al, SPACE_MASK
-					sub		edi, eax
-					shr		cl, 4
-					or cl, PIX_MASK
-					inc		edx
-					sub		CURCLIP, eax
-					jle		CLIPLEFT_DRAW_COMPLEX_SEGMENT
-					cmp		CURCLIP, ecx
-					jl		CLIPLEFT_PARTIAL_COMPLEX
-					//full  clipping
-					sub		CURCLIP, ecx
-					add		esi, ecx
-					sub		edi, ecx
-					dec		TEMP1
-					jnz		CLIPLEFT_START_COMPLEX_SEGMENT
-					dec		NLines
-					jnz		CLIPLEFT_START_SCANLINE
-					jmp		CLIPLEFT_END_DRAW_PICTURE
-					CLIPLEFT_PARTIAL_COMPLEX :
-				//partial clipping
-				add		esi, CURCLIP
-					sub		edi, CURCLIP
-					sub		ecx, CURCLIP
-					mov		CURCLIP, -1
-					CLIPLEFT_DRAW_COMPLEX_SEGMENT :
-					//*****************************************//
-					//put various code with encoding&loop there//INVERTED
-					//*****************************************//
-					or cl, cl
-					jz		MPL3_1
-					xor		eax, eax
-					MPL3_0 : mov		ah, [edi]
-					lodsb
-					mov		al, [ebx + eax]
-					mov[edi], al
-					dec		edi
-					dec		cl
-					jnz		MPL3_0
-					MPL3_1 : xor		eax, eax
-					//*****************************************//
-					//          end of variation zone          //INVERTED
-					//*****************************************//
-					dec		TEMP1
-					jnz		CLIPLEFT_START_COMPLEX_SEGMENT
-					dec		NLines
-					jnz		CLIPLEFT_START_SCANLINE
-					CLIPLEFT_END_DRAW_PICTURE :
-				//end code
-				pop		edi
-					pop		esi
-					popf
-			};
-		}
-		else
-		{
-			if (x1 < WindX1)
-			{
-				//****************************************************************//
-				//****************************************************************//
-				//**      **     **                                **    **     **//
-				//****************   clipping LEFT(old-RIGHT) edge  **************//INVERTED
-				//**      **     **                                **    **     **//
-				//****************************************************************//
-				//****************************************************************//
-				CLIP = x - WindX + 1;
-				int ADDESI;
-				__asm {
-					pushf
-					push	esi
-					push	edi
-					//initialisation
-					mov		edi, scrofs			//edi-screen pointer
-					mov		esi, CDPOS			//esi-points array
-					mov		ebx, Encoder			//ebx-encoding pointer
-					mov		edx, ofst			//edx-mask offset
-					xor		eax, eax
-					xor		ecx, ecx
-					cld
-					sub		edi, ScrWidth
-					mov		LineStart, edi
-					CLIPRIGHT_START_SCANLINE :
-					mov		edi, LineStart
-						mov		al, [edx]
-						inc		edx
-						mov		ADDESI, 0
-						xchg	CLIP, edx
-						add		edi, ScrWidth
-						mov		CURCLIP, edx
-						or al, al
-						xchg	CLIP, edx
-						mov		LineStart, edi
-						jnz		CLIPRIGHT_DRAW_LINE
-						dec		NLines
-						jnz		CLIPRIGHT_START_SCANLINE
-						jmp		CLIPRIGHT_END_DRAW_PICTURE
-						CLIPRIGHT_DRAW_LINE :
-					test	al, 128
-						jnz		CLIPRIGHT_DRAW_COMPLEX_LINE
-						//drawing simple line
-						or al, al
-						jz		CLIPRIGHT_NEXT_SEGMENT
-						mov		TEMP1, eax
-						CLIPRIGHT_START_SIMPLE_SEGMENT :
-					mov		al, [edx]	//empty space
-						sub		edi, eax
-						mov		cl, [edx + 1]
-						add		edx, 2
-						sub		CURCLIP, eax
-						jg		CLIPRIGHT_TRY_TO_CLIP
-						//full clipping until the end of line
-						add		esi, ecx
-						dec		TEMP1
-						jnz		CLIPRIGHT_START_SIMPLE_SEGMENT
-						dec		NLines
-						jnz		CLIPRIGHT_START_SCANLINE
-						jmp		CLIPRIGHT_END_DRAW_PICTURE
-						CLIPRIGHT_TRY_TO_CLIP :
-					cmp		CURCLIP, ecx
-						jl		CLIPRIGHT_PARTIAL_SIMPLE
-						sub		CURCLIP, ecx
-						jmp		CLIPRIGHT_DRAW_SIMPLE_SEGMENT
-						CLIPRIGHT_PARTIAL_SIMPLE :
-					//partial clipping
-					sub		ecx, CURCLIP
-						mov		ADDESI, ecx
-						mov		ecx, CURCLIP
-						mov		CURCLIP, -1
-						CLIPRIGHT_DRAW_SIMPLE_SEGMENT :
-						//*****************************************//
-						//put various code with encoding&loop there//INVERTED
-						//*****************************************//
-						or cl, cl
-						jz		MPL4_1
-						xor		eax, eax
-						MPL4_0 : mov		ah, [edi]
-						lodsb
-						mov		al, [ebx + eax]
-						mov[edi], al
-						dec		edi
-						dec		cl
-						jnz		MPL4_0
-						MPL4_1 : xor		eax, eax
-						//*****************************************//
-						//          end of variation zone          //INVERTED
-						//*****************************************//
-						add		esi, ADDESI
-						dec		TEMP1
-						jnz		CLIPRIGHT_START_SIMPLE_SEGMENT
-						CLIPRIGHT_NEXT_SEGMENT :
-					dec		NLines
-						jnz		CLIPRIGHT_START_SCANLINE
-						jmp		CLIPRIGHT_END_DRAW_PICTURE
-						CLIPRIGHT_DRAW_COMPLEX_LINE :
-					//complex packed line
-					mov		SPACE_MASK, 0
-						mov		PIX_MASK, 0
-						test	al, 64
-						jz		CLIPRIGHT_DCL1
-						mov		SPACE_MASK, 16
-						CLIPRIGHT_DCL1:		test	al, 32
-						jz		CLIPRIGHT_DCL2
-						mov		PIX_MASK, 16
-						CLIPRIGHT_DCL2 : and		al, 31
-						jz		CLIPRIGHT_NEXT_SEGMENT
-						mov		TEMP1, eax
-						CLIPRIGHT_START_COMPLEX_SEGMENT :
-					mov		al, [edx]
-						mov		cl, al
-						and		al, 15
-						or al, SPACE_MASK
-						sub		edi, eax
-						shr		cl, 4
-						or cl, PIX_MASK
-						inc		edx
-						sub		CURCLIP, eax
-						jg		CLIPRIGHT_TRY_TO_CLIP_COMPLEX
-						//full clipping until the end of line
-						add		esi, ecx
-						dec		TEMP1
-						jnz		CLIPRIGHT_START_COMPLEX_SEGMENT
-						dec		NLines
-						jnz		CLIPRIGHT_START_SCANLINE
-						jmp		CLIPRIGHT_END_DRAW_PICTURE
-						CLIPRIGHT_TRY_TO_CLIP_COMPLEX :
-					cmp		CURCLIP, ecx
-						jl		CLIPRIGHT_PARTIAL_COMPLEX
-						sub		CURCLIP, ecx
-						jmp		CLIPRIGHT_DRAW_COMPLEX_SEGMENT
-						CLIPRIGHT_PARTIAL_COMPLEX :
-					//partial clipping
-					sub		ecx, CURCLIP
-						mov		ADDESI, ecx
-						mov		ecx, CURCLIP
-						mov		CURCLIP, -1
-						CLIPRIGHT_DRAW_COMPLEX_SEGMENT :
-						//*****************************************//
-						//put various code with encoding&loop there//INVERTED
-						//*****************************************//
-						or cl, cl
-						jz		MPL5_1
-						xor		eax, eax
-						MPL5_0 : mov		ah, [edi]
-						lodsb
-						mov		al, [ebx + eax]
-						mov[edi], al
-						dec		edi
-						dec		cl
-						jnz		MPL5_0
-						MPL5_1 : xor		eax, eax
-						//*****************************************//
-						//          end of variation zone          //INVERTED
-						//*****************************************//
-						add		esi, ADDESI
-						dec		TEMP1
-						jnz		CLIPRIGHT_START_COMPLEX_SEGMENT
-						dec		NLines
-						jnz		CLIPRIGHT_START_SCANLINE
-						CLIPRIGHT_END_DRAW_PICTURE :
-					//end code
-					pop		edi
-						pop		esi
-						popf
-				};
-			};
-		};
-	};
-};
+	GP_ShowMasked( GPB_MULTIPALT, true, x, y, Pic, CData, Encoder, nullptr );
+}
+
 //key word: WMIRROR
-extern byte refl[3072];
-//******************************************************************************//
-//******************************************************************************//
-//******************************************************************************//
-//****																		****//
-//****																		****//
-//****									MIRROR								****//
-//****																		****//
-//****																		****//
-//******************************************************************************//
-//******************************************************************************//
-//******************************************************************************//
 void GP_ShowMaskedMirrorPict( int x, int y, GP_Header* Pic, byte* CData, int* WSHIFT )
 {
-	x += Pic->dx;
-	y += Pic->dy;
-	int Lx = Pic->Lx;
-	int NLines = Pic->NLines;
-	int ofst = int( Pic ) + 23;
-
-	if (y + NLines <= WindY || x + Lx <= WindX || x > WindX1 || y > WindY1)
-		return;
+	GP_ShowMasked( GPB_MIRROR, false, x, y, Pic, CData, refl, WSHIFT );
+}
 
-	//vertical clipping
-	//top clipper
-	int CDPOS = int( CData );
-	if (y < WindY)
-	{
-		__asm
-		{
-			mov		ecx, WindY
-			sub		ecx, y
-			sub		NLines, ecx
-			add		y, ecx
-			mov		ebx, ofst
-			xor		eax, eax
-			xor		edx, edx
-			NLINE : mov		al, [ebx]
-					test	al, 128
-					jz		SIMPLE_LINE
-					inc		ebx
-					mov		ah, al
-					and		al, 31
-					or al, al
-					jz		COMPLINE_1
-					and		ah, 32
-					shr		ah, 1
-					COMPLINE_LOOP1:
-			mov		dl, [ebx]
-				shr		dl, 4
-				or dl, ah
-				add		CDPOS, edx
-				inc		ebx
-				dec		al
-				jnz		COMPLINE_LOOP1
-				COMPLINE_1 :
-			xor		eax, eax
-				dec		ecx
-				jnz		NLINE
-				jmp		END_VCLIP
-				SIMPLE_LINE : inc		ebx
-				or eax, eax
-				jz		SIMPLINE_1
-				SIMPLINE_LOOP1 :
-			mov		dl, [ebx + 1]
-				add		CDPOS, edx
-				add		ebx, 2
-				dec		al
-				jnz		SIMPLINE_LOOP1
-				SIMPLINE_1 : dec		ecx
-				jnz		NLINE
-				END_VCLIP : mov		ofst, ebx
-		};
-	};
-	//bottom clipper
-	if (y + NLines > WindY1)NLines = WindY1 - y + 1;
-	//horisontal clipper
-	int x1 = x + Lx - 1;
-	int scrofs = int( ScreenPtr ) + x + y*ScrWidth;
-	int TEMP1;
-	int LineStart;
-	int CLIP;
-	int CURCLIP;
-	byte SPACE_MASK;
-	byte PIX_MASK;
-	if (x >= WindX + 10 && x1 <= WindX1 - 10)
-	{
-		//***********************************************************//
-		//******************(((((((((((())))))))))))*****************//
-		//**                      NO CLIPPING                      **//
-		//******************(((((((((((())))))))))))*****************//
-		//***********************************************************//
-				//no clipping
-		__asm {
-			pushf
-			push	esi
-			push	edi
-			//initialisation
-			mov		edi, scrofs			//edi-screen pointer
-			mov		esi, CDPOS			//esi-points array
-			mov		ebx, WSHIFT			//ebx-encoding pointer
-			mov		edx, ofst			//edx-mask offset
-			xor		eax, eax
-			xor		ecx, ecx
-			cld
-			sub		edi, ScrWidth
-			mov		LineStart, edi
-			START_SCANLINE :
-			mov		edi, LineStart
-				mov		al, [edx]
-				inc		edx
-				add		edi, [ebx]
-				add		ebx, 4
-				add		edi, ScrWidth
-				or al, al
-				mov		LineStart, edi
-				jnz		DRAW_LINE
-				dec		NLines
-				jnz		START_SCANLINE
-				jmp		END_DRAW_PICTURE
-				DRAW_LINE :
-			test	al, 128
-				jnz		DRAW_COMPLEX_LINE
-				//drawing simple line
-				or al, al
-				jz		NEXT_SEGMENT
-				mov		TEMP1, eax
-				START_SIMPLE_SEGMENT :
-			mov		al, [edx]	//empty space
-				add		edi, eax
-				mov		cl, [edx + 1]
-				add		edx, 2
-				//*****************************************//
-				//put various code with encoding&loop there//
-				//*****************************************//
-				or cl, cl
-				jz		MPL0_1
-				xor		eax, eax
-				MPL0_0 : mov		al, [edi]
-				sub		al, 0xB0
-				cmp		al, 0xB
-				jae		MPL0_0A
-				mov		ah, al
-				mov		al, [esi]
-				mov		al, [refl + eax]
-				mov[edi], al
-				MPL0_0A : inc edi
-				inc		esi
-				dec		cl
-				jnz		MPL0_0
-				MPL0_1 : xor		eax, eax
-				//*****************************************//
-				//          end of variation zone          //
-				//*****************************************//
-				dec		TEMP1
-				jnz		START_SIMPLE_SEGMENT
-				NEXT_SEGMENT :
-			dec		NLines
-				jnz		START_SCANLINE
-				jmp		END_DRAW_PICTURE
-				DRAW_COMPLEX_LINE :
-			//complex packed line
-			mov		SPACE_MASK, 0
-				mov		PIX_MASK, 0
-				test	al, 64
-				jz		DCL1
-				mov		SPACE_MASK, 16
-				DCL1:		test	al, 32
-				jz		DCL2
-				mov		PIX_MASK, 16
-				DCL2 : and		al, 31
-				jz		NEXT_SEGMENT
-				mov		TEMP1, eax
-				START_COMPLEX_SEGMENT :
-			mov		al, [edx]
-				mov		cl, al
-				and		al, 15
-				or al, SPACE_MASK
-				add		edi, eax
-				shr		cl, 4
-				or cl, PIX_MASK
-				inc		edx
-				//*****************************************//
-				//put various code with encoding&loop there//
-				//*****************************************//
-				or cl, cl
-				jz		MPL1_1
-				xor		eax, eax
-
-				MPL1_0 : mov		al, [edi]
-				sub		al, 0xB0
-				cmp		al, 0xB
-				jae		MPL1_0A
-				mov		ah, al
-				mov		al, [esi]
-				mov		al, [refl + eax]
-				mov[edi], al
-				MPL1_0A : inc edi
-				inc		esi
-				dec		cl
-				jnz		MPL1_0
-
-				MPL1_1 : xor		eax, eax
-				//*****************************************//
-				//          end of variation zone          //
-				//*****************************************//
-				dec		TEMP1
-				jnz		START_COMPLEX_SEGMENT
-				dec		NLines
-				jnz		START_SCANLINE
-				END_DRAW_PICTURE :
-			//end code
-			pop		edi
-				pop		esi
-				popf
-		};
-	}
-	else
-	{
-		//image must be clipped
-		if (x < WindX + 10)
-		{
-			//****************************************************************//
-			//****************************************************************//
-			//**                                                            **//
-			//**					clipping LEFT edge						**//
-			//**                                                            **//
-			//****************************************************************//
-			//****************************************************************//
-			CLIP = WindX - x;
-			__asm {
-				pushf
-				push	esi
-				push	edi
-				//initialisation
-				mov		edi, scrofs			//edi-screen pointer
-				mov		esi, CDPOS			//esi-points array
-				mov		ebx, WSHIFT			//ebx-encoding pointer
-				mov		edx, ofst			//edx-mask offset
-				xor		eax, eax
-				xor		ecx, ecx
-				cld
-				sub		edi, ScrWidth
-				mov		LineStart, edi
-				CLIPLEFT_START_SCANLINE :
-				mov		edi, LineStart
-					mov		al, [edx]
-					inc		edx
-					add		edi, [ebx]
-					xchg	CLIP, edx
-					add		edi, ScrWidth
-					sub		edx, [ebx]
-					add		ebx, 4
-					mov		CURCLIP, edx
-					or al, al
-					xchg	CLIP, edx
-					mov		LineStart, edi
-					jnz		CLIPLEFT_DRAW_LINE
-					dec		NLines
-					jnz		CLIPLEFT_START_SCANLINE
-					jmp		CLIPLEFT_END_DRAW_PICTURE
-					CLIPLEFT_DRAW_LINE : test	al, 128
-					jnz		CLIPLEFT_DRAW_COMPLEX_LINE
-					//drawing simple line
-					or al, al
-					jz		CLIPLEFT_NEXT_SEGMENT
-					mov		TEMP1, eax
-					CLIPLEFT_START_SIMPLE_SEGMENT :
-				mov		al, [edx]	//empty space
-					add		edi, eax
-					mov		cl, [edx + 1]
-					add		edx, 2
-					sub		CURCLIP, eax
-					jle		CLIPLEFT_DRAW_SIMPLE_SEGMENT
-					cmp		CURCLIP, ecx
-					jl		CLIPLEFT_PARTIAL_SIMPLE
-					//full  clipping
-					sub		CURCLIP, ecx
-					add		esi, ecx
-					add		edi, ecx
-					dec		TEMP1
-					jnz		CLIPLEFT_START_SIMPLE_SEGMENT
-					dec		NLines
-					jnz		CLIPLEFT_START_SCANLINE
-					jmp		CLIPLEFT_END_DRAW_PICTURE
-					CLIPLEFT_PARTIAL_SIMPLE :
-				//partial clipping
-				add		esi, CURCLIP
-					add		edi, CURCLIP
-					sub		ecx, CURCLIP
-					mov		CURCLIP, -1
-					CLIPLEFT_DRAW_SIMPLE_SEGMENT :
-					//*****************************************//
-					//put various code with encoding&loop there//
-					//*****************************************//
-					or cl, cl
-					jz		MPL2_1
-					xor		eax, eax
-
-					MPL2_0 : mov		al, [edi]
-					sub		al, 0xB0
-					cmp		al, 12
-					jae		MPL2_0A
-					mov		ah, al
-					mov		al, [esi]
-					mov		al, [refl + eax]
-					mov[edi], al
-					MPL2_0A : inc edi
-					inc		esi
-					dec		cl
-					jnz		MPL2_0
-					MPL2_1 : xor		eax, eax
-					//*****************************************//
-					//          end of variation zone          //
-					//*****************************************//
-					dec		TEMP1
-					jnz		CLIPLEFT_START_SIMPLE_SEGMENT
-					CLIPLEFT_NEXT_SEGMENT :
-				dec		NLines
-					jnz		CLIPLEFT_START_SCANLINE
-					jmp		CLIPLEFT_END_DRAW_PICTURE
-					CLIPLEFT_DRAW_COMPLEX_LINE :
-				//complex packed line
-				mov		SPACE_MASK, 0
-					mov		PIX_MASK, 0
-					test	al, 64
-					jz		CLIPLEFT_DCL1
-					mov		SPACE_MASK, 16
-					CLIPLEFT_DCL1:	test	al, 32
-					jz		CLIPLEFT_DCL2
-					mov		PIX_MASK, 16
-					CLIPLEFT_DCL2 : and		al, 31
-					jz		CLIPLEFT_NEXT_SEGMENT
-					mov		TEMP1, eax
-					CLIPLEFT_START_COMPLEX_SEGMENT :
-				mov		al, [edx]
-					mov		cl, al
-					and		al, 15
-					or al, SPACE_MASK
-					add		edi, eax
-					shr		cl, 4
-					or cl, PIX_MASK
-					inc		edx
-					sub		CURCLIP, eax
-					jle		CLIPLEFT_DRAW_COMPLEX_SEGMENT
-					cmp		CURCLIP, ecx
-					jl		CLIPLEFT_PARTIAL_COMPLEX
-					//full  clipping
-					sub		CURCLIP, ecx
-					add		esi, ecx
-					add		edi, ecx
-					dec		TEMP1
-					jnz		CLIPLEFT_START_COMPLEX_SEGMENT
-					dec		NLines
-					jnz		CLIPLEFT_START_SCANLINE
-					jmp		CLIPLEFT_END_DRAW_PICTURE
-					CLIPLEFT_PARTIAL_COMPLEX :
-				//partial clipping
-				add		esi, CURCLIP
-					add		edi, CURCLIP
-					sub		ecx, CURCLIP
-					mov		CURCLIP, -1
-					CLIPLEFT_DRAW_COMPLEX_SEGMENT :
-					//*****************************************//
-					//put various code with encoding&loop there//
-					//*****************************************//
-					or cl, cl
-					jz		MPL3_1
-					xor		eax, eax
-
-					MPL3_0 : mov		al, [edi]
-					sub		al, 0xB0
-					cmp		al, 12
-					jae		MPL3_0A
-					mov		ah, al
-					mov		al, [esi]
-					mov		al, [refl + eax]
-					mov[edi], al
-					MPL3_0A : inc edi
-					inc		esi
-					dec		cl
-					jnz		MPL3_0
-
-					MPL3_1 : xor		eax, eax
-					//*****************************************//
-					//          end of variation zone          //
-					//*****************************************//
-					dec		TEMP1
-					jnz		CLIPLEFT_START_COMPLEX_SEGMENT
-					dec		NLines
-					jnz		CLIPLEFT_START_SCANLINE
-					CLIPLEFT_END_DRAW_PICTURE :
-				//end code
-				pop		edi
-					pop		esi
-					popf
-			};
-		}
-		else
-		{
-			if (x1 > WindX1 - 10)
-			{
-				//****************************************************************//
-				//****************************************************************//
-				//**      **     **                                **    **     **//
-				//****************   	clipping RIGHT edge			**************//
-				//**      **     **                                **    **     **//
-				//****************************************************************//
-				//****************************************************************//
-				CLIP = WindX1 - x + 1;
-				int ADDESI;
-				__asm {
-					pushf
-					push	esi
-					push	edi
-					//initialisation
-					mov		edi, scrofs			//edi-screen pointer
-					mov		esi, CDPOS			//esi-points array
-					mov		ebx, WSHIFT			//ebx-encoding pointer
-					mov		edx, ofst			//edx-mask offset
-					xor		eax, eax
-					xor		ecx, ecx
-					cld
-					sub		edi, ScrWidth
-					mov		LineStart, edi
-					CLIPRIGHT_START_SCANLINE :
-					mov		edi, LineStart
-						mov		al, [edx]
-						inc		edx
-						mov		ADDESI, 0
-						add		edi, [ebx]
-						xchg	CLIP, edx
-						sub		edx, [ebx]
-						add		ebx, 4
-						add		edi, ScrWidth
-						mov		CURCLIP, edx
-						or al, al
-						xchg	CLIP, edx
-						mov		LineStart, edi
-						jnz		CLIPRIGHT_DRAW_LINE
-						dec		NLines
-						jnz		CLIPRIGHT_START_SCANLINE
-						jmp		CLIPRIGHT_END_DRAW_PICTURE
-						CLIPRIGHT_DRAW_LINE :
-					test	al, 128
-						jnz		CLIPRIGHT_DRAW_COMPLEX_LINE
-						//drawing simple line
-						or al, al
-						jz		CLIPRIGHT_NEXT_SEGMENT
-						mov		TEMP1, eax
-						CLIPRIGHT_START_SIMPLE_SEGMENT :
-					mov		al, [edx]	//empty space
-						add		edi, eax
-						mov		cl, [edx + 1]
-						add		edx, 2
-						sub		CURCLIP, eax
-						jg		CLIPRIGHT_TRY_TO_CLIP
-						//full clipping until the end of line
-						add		esi, ecx
-						dec		TEMP1
-						jnz		CLIPRIGHT_START_SIMPLE_SEGMENT
-						dec		NLines
-						jnz		CLIPRIGHT_START_SCANLINE
-						jmp		CLIPRIGHT_END_DRAW_PICTURE
-						CLIPRIGHT_TRY_TO_CLIP :
-					cmp		CURCLIP, ecx
-						jl		CLIPRIGHT_PARTIAL_SIMPLE
-						sub		CURCLIP, ecx
-						jmp		CLIPRIGHT_DRAW_SIMPLE_SEGMENT
-						CLIPRIGHT_PARTIAL_SIMPLE :
-					//partial clipping
-					sub		ecx, CURCLIP
-						mov		ADDESI, ecx
-						mov		ecx, CURCLIP
-						mov		CURCLIP, -1
-						CLIPRIGHT_DRAW_SIMPLE_SEGMENT :
-						//*****************************************//
-						//put various code with encoding&loop there//
-						//*****************************************//
-						or cl, cl
-						jz		MPL4_1
-						xor		eax, eax
-
-						MPL4_0 : mov		al, [edi]
-						sub		al, 0xB0
-						cmp		al, 12
-						jae		MPL4_0A
-						mov		ah, al
-						mov		al, [esi]
-						mov		al, [refl + eax]
-						mov[edi], al
-						MPL4_0A : inc edi
-						inc		esi
-						dec		cl
-						jnz		MPL4_0
-
-						MPL4_1 : xor		eax, eax
-						//*****************************************//
-						//          end of variation zone          //
-						//*****************************************//
-						add		esi, ADDESI
-						dec		TEMP1
-						jnz		CLIPRIGHT_START_SIMPLE_SEGMENT
-						CLIPRIGHT_NEXT_SEGMENT :
-					dec		NLines
-						jnz		CLIPRIGHT_START_SCANLINE
-						jmp		CLIPRIGHT_END_DRAW_PICTURE
-						CLIPRIGHT_DRAW_COMPLEX_LINE :
-					//complex packed line
-					mov		SPACE_MASK, 0
-						mov		PIX_MASK, 0
-						test	al, 64
-						jz		CLIPRIGHT_DCL1
-						mov		SPACE_MASK, 16
-						CLIPRIGHT_DCL1:		test	al, 32
-						jz		CLIPRIGHT_DCL2
-						mov		PIX_MASK, 16
-						CLIPRIGHT_DCL2 : and		al, 31
-						jz		CLIPRIGHT_NEXT_SEGMENT
-						mov		TEMP1, eax
-						CLIPRIGHT_START_COMPLEX_SEGMENT :
-					mov		al, [edx]
-						mov		cl, al
-						and		al, 15
-						or al, SPACE_MASK
-						add		edi, eax
-						shr		cl, 4
-						or cl, PIX_MASK
-						inc		edx
-						sub		CURCLIP, eax
-						jg		CLIPRIGHT_TRY_TO_CLIP_COMPLEX
-						//full clipping until the end of line
-						add		esi, ecx
-						dec		TEMP1
-						jnz		CLIPRIGHT_START_COMPLEX_SEGMENT
-						dec		NLines
-						jnz		CLIPRIGHT_START_SCANLINE
-						jmp		CLIPRIGHT_END_DRAW_PICTURE
-						CLIPRIGHT_TRY_TO_CLIP_COMPLEX :
-					cmp		CURCLIP, ecx
-						jl		CLIPRIGHT_PARTIAL_COMPLEX
-						sub		CURCLIP, ecx
-						jmp		CLIPRIGHT_DRAW_COMPLEX_SEGMENT
-						CLIPRIGHT_PARTIAL_COMPLEX :
-					//partial clipping
-					sub		ecx, CURCLIP
-						mov		ADDESI, ecx
-						mov		ecx, CURCLIP
-						mov		CURCLIP, -1
-						CLIPRIGHT_DRAW_COMPLEX_SEGMENT :
-						//*****************************************//
-						//put various code with encoding&loop there//
-						//*****************************************//
-						or cl, cl
-						jz		MPL5_1
-						xor		eax, eax
-
-						MPL5_0 : mov		al, [edi]
-						sub		al, 0xB0
-						cmp		al, 12
-						jae		MPL5_0A
-						mov		ah, al
-						mov		al, [esi]
-						mov		al, [refl + eax]
-						mov[edi], al
-						MPL5_0A : inc edi
-						inc		esi
-						dec		cl
-						jnz		MPL5_0
-
-						jnz		MPL5_0
-						MPL5_1 : xor		eax, eax
-						//*****************************************//
-						//          end of variation zone          //
-						//*****************************************//
-						add		esi, ADDESI
-						dec		TEMP1
-						jnz		CLIPRIGHT_START_COMPLEX_SEGMENT
-						dec		NLines
-						jnz		CLIPRIGHT_START_SCANLINE
-						CLIPRIGHT_END_DRAW_PICTURE :
-					//end code
-					pop		edi
-						pop		esi
-						popf
-				};
-			};
-		};
-	};
-};
 void GP_ShowMaskedMirrorPictInv( int x, int y, GP_Header* Pic, byte* CData, int* WSHIFT )
 {
-	x -= Pic->dx;
-	y += Pic->dy;
-	int Lx = Pic->Lx;
-	int NLines = Pic->NLines;
-	int ofst = int( Pic ) + 23;
-	if (y + NLines <= WindY || x - Lx >= WindX1 || x<WindX || y>WindY1)return;
-	//vertical clipping
-	//top clipper
-	int CDPOS = int( CData );
-	if (y < WindY)
-	{
-		__asm {
-			mov		ecx, WindY
-			sub		ecx, y
-			sub		NLines, ecx
-			add		y, ecx
-			mov		ebx, ofst
-			xor		eax, eax
-			xor		edx, edx
-			NLINE : mov		al, [ebx]
-					test	al, 128
-					jz		SIMPLE_LINE
-					inc		ebx
-					mov		ah, al
-					and		al, 31
-					or al, al
-					jz		COMPLINE_1
-					and		ah, 32
-					shr		ah, 1
-					COMPLINE_LOOP1:
-			mov		dl, [ebx]
-				shr		dl, 4
-				or dl, ah
-				add		CDPOS, edx
-				inc		ebx
-				dec		al
-				jnz		COMPLINE_LOOP1
-				COMPLINE_1 :
-			xor		eax, eax
-				dec		ecx
-				jnz		NLINE
-				jmp		END_VCLIP
-				SIMPLE_LINE : inc		ebx
-				or eax, eax
-				jz		SIMPLINE_1
-				SIMPLINE_LOOP1 :
-			mov		dl, [ebx + 1]
-				add		CDPOS, edx
-				add		ebx, 2
-				dec		al
-				jnz		SIMPLINE_LOOP1
-				SIMPLINE_1 : dec		ecx
-				jnz		NLINE
-				END_VCLIP : mov		ofst, ebx
-		};
-	};
-	//bottom clipper
-	if (y + NLines > WindY1)NLines = WindY1 - y + 1;
-	//horisontal clipper
-	int x1 = x - Lx + 1;
-	int scrofs = int( ScreenPtr ) + x + y*ScrWidth;
-	int TEMP1;
-	int LineStart;
-	int CLIP;
-	int CURCLIP;
-	byte SPACE_MASK;
-	byte PIX_MASK;
-	if (x1 >= WindX + 10 && x <= WindX1 - 10)
-	{
-		//***********************************************************//
-		//******************(((((((((((())))))))))))*****************//
-		//**                      NO CLIPPING                      **//INVERTED
-		//******************(((((((((((())))))))))))*****************//
-		//***********************************************************//
-				//no clipping
-		__asm {
-			pushf
-			push	esi
-			push	edi
-			//initialisation
-			mov		edi, scrofs			//edi-screen pointer
-			mov		esi, CDPOS			//esi-points array
-			mov		ebx, WSHIFT			//ebx-encoding pointer
-			mov		edx, ofst			//edx-mask offset
-			xor		eax, eax
-			xor		ecx, ecx
-			cld
-			sub		edi, ScrWidth
-			mov		LineStart, edi
-			START_SCANLINE :
-			mov		edi, LineStart
-				mov		al, [edx]
-				inc		edx
-				add		edi, [ebx]
-				add		ebx, 4
-				add		edi, ScrWidth
-				or al, al
-				mov		LineStart, edi
-				jnz		DRAW_LINE
-				dec		NLines
-				jnz		START_SCANLINE
-				jmp		END_DRAW_PICTURE
-				DRAW_LINE :
-			test	al, 128
-				jnz		DRAW_COMPLEX_LINE
-				//drawing simple line
-				or al, al
-				jz		NEXT_SEGMENT
-				mov		TEMP1, eax
-				START_SIMPLE_SEGMENT :
-			mov		al, [edx]	//empty space
-				sub		edi, eax
-				mov		cl, [edx + 1]
-				add		edx, 2
-				//*****************************************//
-				//put various code with encoding&loop there//INVERTED
-				//*****************************************//
-				or cl, cl
-				jz		MPL0_1
-				xor		eax, eax
-				MPL0_0 : mov		al, [edi]
-				sub		al, 0xB0
-				cmp		al, 0x0B
-				ja		MPL0_0A
-				mov		ah, al
-				mov		al, [esi]
-				mov		al, [refl + eax]
-				mov[edi], al
-				MPL0_0A : inc		esi
-				dec		edi
-				dec		cl
-				jnz		MPL0_0
-				MPL0_1 : xor		eax, eax
-				//*****************************************//
-				//          end of variation zone          //INVERTED
-				//*****************************************//
-				dec		TEMP1
-				jnz		START_SIMPLE_SEGMENT
-				NEXT_SEGMENT :
-			dec		NLines
-				jnz		START_SCANLINE
-				jmp		END_DRAW_PICTURE
-				DRAW_COMPLEX_LINE :
-			//complex packed line
-			mov		SPACE_MASK, 0
-				mov		PIX_MASK, 0
-				test	al, 64
-				jz		DCL1
-				mov		SPACE_MASK, 16
-				DCL1:		test	al, 32
-				jz		DCL2
-				mov		PIX_MASK, 16
-				DCL2 : and		al, 31
-				jz		NEXT_SEGMENT
-				mov		TEMP1, eax
-				START_COMPLEX_SEGMENT :
-			mov		al, [edx]
-				mov		cl, al
-				and		al, 15
-				or al, SPACE_MASK
-				sub		edi, eax
-				shr		cl, 4
-				or cl, PIX_MASK
-				inc		edx
-				//*****************************************//
-				//put various code with encoding&loop there//INVERTED
-				//*****************************************//
-				or cl, cl
-				jz		MPL1_1
-				xor		eax, eax
-
-				MPL1_0 : mov		al, [edi]
-				sub		al, 0xB0
-				cmp		al, 0x0B
-				ja		MPL1_0A
-				mov		ah, al
-				mov		al, [esi]
-				mov		al, [refl + eax]
-				mov[edi], al
-				MPL1_0A : inc		esi
-				dec		edi
-				dec		cl
-				jnz		MPL1_0
-
-				MPL1_1 : xor		eax, eax
-				//*****************************************//
-				//          end of variation zone          //INVERTED
-				//*****************************************//
-				dec		TEMP1
-				jnz		START_COMPLEX_SEGMENT
-				dec		NLines
-				jnz		START_SCANLINE
-				END_DRAW_PICTURE :
-			//end code
-			pop		edi
-				pop		esi
-				popf
-		};
-	}
-	else
-	{
-		//image must be clipped
-		if (x > WindX1 - 10)
-		{
-			//****************************************************************//
-			//****************************************************************//
-			//**                                                            **//
-			//**					clipping RIGT(old-LEFT) edge						**//INVERTED
-			//**                                                            **//
-			//****************************************************************//
-			//****************************************************************//
-			CLIP = x - WindX1;
-			__asm {
-				pushf
-				push	esi
-				push	edi
-				//initialisation
-				mov		edi, scrofs			//edi-screen pointer
-				mov		esi, CDPOS			//esi-points array
-				mov		ebx, WSHIFT			//ebx-encoding pointer
-				mov		edx, ofst			//edx-mask offset
-				xor		eax, eax
-				xor		ecx, ecx
-				cld
-				sub		edi, ScrWidth
-				mov		LineStart, edi
-				CLIPLEFT_START_SCANLINE :
-				mov		edi, LineStart
-					mov		al, [edx]
-					inc		edx
-					add		edi, [ebx]
-					xchg	CLIP, edx
-					add		edx, [ebx]
-					add		ebx, 4
-					add		edi, ScrWidth
-					mov		CURCLIP, edx
-					or al, al
-					xchg	CLIP, edx
-					mov		LineStart, edi
-					jnz		CLIPLEFT_DRAW_LINE
-					dec		NLines
-					jnz		CLIPLEFT_START_SCANLINE
-					jmp		CLIPLEFT_END_DRAW_PICTURE
-					CLIPLEFT_DRAW_LINE :
-				test	al, 128
-					jnz		CLIPLEFT_DRAW_COMPLEX_LINE
-					//drawing simple line
-					or al, al
-					jz		CLIPLEFT_NEXT_SEGMENT
-					mov		TEMP1, eax
-					CLIPLEFT_START_SIMPLE_SEGMENT :
-				mov		al, [edx]	//empty space
-					sub		edi, eax
-					mov		cl, [edx + 1]
-					add		edx, 2
-					sub		CURCLIP, eax
-					jle		CLIPLEFT_DRAW_SIMPLE_SEGMENT
-					cmp		CURCLIP, ecx
-					jl		CLIPLEFT_PARTIAL_SIMPLE
-					//full  clipping
-					sub		CURCLIP, ecx
-					add		esi, ecx
-					sub		edi, ecx
-					dec		TEMP1
-					jnz		CLIPLEFT_START_SIMPLE_SEGMENT
-					dec		NLines
-					jnz		CLIPLEFT_START_SCANLINE
-					jmp		CLIPLEFT_END_DRAW_PICTURE
-					CLIPLEFT_PARTIAL_SIMPLE :
-				//partial clipping
-				add		esi, CURCLIP
-					sub		edi, CURCLIP
-					sub		ecx, CURCLIP
-					mov		CURCLIP, -1
-					CLIPLEFT_DRAW_SIMPLE_SEGMENT :
-					//*****************************************//
-					//put various code with encoding&loop there//INVERTED
-					//*****************************************//
-					or cl, cl
-					jz		MPL2_1
-					xor		eax, eax
-					MPL2_0 : mov		al, [edi]
-					sub		al, 0xB0
-					cmp		al, 0x0B
-					ja		MPL2_0A
-					mov		ah, al
-					mov		al, [esi]
-					mov		al, [refl + eax]
-					mov[edi], al
-					MPL2_0A : inc		esi
-					dec		edi
-					dec		cl
-					jnz		MPL2_0
-					MPL2_1 : xor		eax, eax
-					//*****************************************//
-					//          end of variation zone          //INVERTED
-					//*****************************************//
-					dec		TEMP1
-					jnz		CLIPLEFT_START_SIMPLE_SEGMENT
-					CLIPLEFT_NEXT_SEGMENT :
-				dec		NLines
-					jnz		CLIPLEFT_START_SCANLINE
-					jmp		CLIPLEFT_END_DRAW_PICTURE
-					CLIPLEFT_DRAW_COMPLEX_LINE :
-				//complex packed line
-				mov		SPACE_MASK, 0
-					mov		PIX_MASK, 0
-					test	al, 64
-					jz		CLIPLEFT_DCL1
-					mov		SPACE_MASK, 16
-					CLIPLEFT_DCL1:	test	al, 32
-					jz		CLIPLEFT_DCL2
-					mov		PIX_MASK, 16
-					CLIPLEFT_DCL2 : and		al, 31
-					jz		CLIPLEFT_NEXT_SEGMENT
-					mov		TEMP1, eax
-					CLIPLEFT_START_COMPLEX_SEGMENT :
-				mov		al, [edx]
-					mov		cl, al
-					and		al, 15
-					or al, SPACE_MASK
-					sub		edi, eax
-					shr		cl, 4
-					or cl, PIX_MASK
-					inc		edx
-					sub		CURCLIP, eax
-					jle		CLIPLEFT_DRAW_COMPLEX_SEGMENT
-					cmp		CURCLIP, ecx
-					jl		CLIPLEFT_PARTIAL_COMPLEX
-					//full  clipping
-					sub		CURCLIP, ecx
-					add		esi, ecx
-					sub		edi, ecx
-					dec		TEMP1
-					jnz		CLIPLEFT_START_COMPLEX_SEGMENT
-					dec		NLines
-					jnz		CLIPLEFT_START_SCANLINE
-					jmp		CLIPLEFT_END_DRAW_PICTURE
-					CLIPLEFT_PARTIAL_COMPLEX :
-				//partial clipping
-				add		esi, CURCLIP
-					sub		edi, CURCLIP
-					sub		ecx, CURCLIP
-					mov		CURCLIP, -1
-					CLIPLEFT_DRAW_COMPLEX_SEGMENT :
-					//*****************************************//
-					//put various code with encoding&loop there//INVERTED
-					//*****************************************//
-					or cl, cl
-					jz		MPL3_1
-					xor		eax, eax
-					MPL3_0 : mov		al, [edi]
-					sub		al, 0xB0
-					cmp		al, 0x0B
-					ja		MPL3_0A
-					mov		ah, al
-					mov		al, [esi]
-					mov		al, [refl + eax]
-					mov[edi], al
-					MPL3_0A : inc		esi
-					dec		edi
-					dec		cl
-					jnz		MPL3_0
-					MPL3_1 : xor		eax, eax
-					//*****************************************//
-					//          end of variation zone          //INVERTED
-					//*****************************************//
-					dec		TEMP1
-					jnz		CLIPLEFT_START_COMPLEX_SEGMENT
-					dec		NLines
-					jnz		CLIPLEFT_START_SCANLINE
-					CLIPLEFT_END_DRAW_PICTURE :
-				//end code
-				pop		edi
-					pop		esi
-					popf
-			};
-		}
-		else
-		{
-			if (x1 < WindX1 + 10)
-			{
-				//****************************************************************//
-				//****************************************************************//
-				//**      **     **                                **    **     **//
-				//****************   clipping LEFT(old-RIGHT) edge  **************//INVERTED
-				//**      **     **                                **    **     **//
-				//****************************************************************//
-				//****************************************************************//
-				CLIP = x - WindX + 1;
-				int ADDESI;
-				__asm {
-					pushf
-					push	esi
-					push	edi
-					//initialisation
-					mov		edi, scrofs			//edi-screen pointer
-					mov		esi, CDPOS			//esi-points array
-					mov		ebx, WSHIFT			//ebx-encoding pointer
-					mov		edx, ofst			//edx-mask offset
-					xor		eax, eax
-					xor		ecx, ecx
-					cld
-					sub		edi, ScrWidth
-					mov		LineStart, edi
-					CLIPRIGHT_START_SCANLINE :
-					mov		edi, LineStart
-						mov		al, [edx]
-						inc		edx
-						add		edi, [ebx]
-						mov		ADDESI, 0
-						xchg	CLIP, edx
-						add		edx, [ebx]
-						add		ebx, 4
-						add		edi, ScrWidth
-						mov		CURCLIP, edx
-						or al, al
-						xchg	CLIP, edx
-						mov		LineStart, edi
-						jnz		CLIPRIGHT_DRAW_LINE
-						dec		NLines
-						jnz		CLIPRIGHT_START_SCANLINE
-						jmp		CLIPRIGHT_END_DRAW_PICTURE
-						CLIPRIGHT_DRAW_LINE :
-					test	al, 128
-						jnz		CLIPRIGHT_DRAW_COMPLEX_LINE
-						//drawing simple line
-						or al, al
-						jz		CLIPRIGHT_NEXT_SEGMENT
-						mov		TEMP1, eax
-						CLIPRIGHT_START_SIMPLE_SEGMENT :
-					mov		al, [edx]	//empty space
-						sub		edi, eax
-						mov		cl, [edx + 1]
-						add		edx, 2
-						sub		CURCLIP, eax
-						jg		CLIPRIGHT_TRY_TO_CLIP
-						//full clipping until the end of line
-						add		esi, ecx
-						dec		TEMP1
-						jnz		CLIPRIGHT_START_SIMPLE_SEGMENT
-						dec		NLines
-						jnz		CLIPRIGHT_START_SCANLINE
-						jmp		CLIPRIGHT_END_DRAW_PICTURE
-						CLIPRIGHT_TRY_TO_CLIP :
-					cmp		CURCLIP, ecx
-						jl		CLIPRIGHT_PARTIAL_SIMPLE
-						sub		CURCLIP, ecx
-						jmp		CLIPRIGHT_DRAW_SIMPLE_SEGMENT
-						CLIPRIGHT_PARTIAL_SIMPLE :
-					//partial clipping
-					sub		ecx, CURCLIP
-						mov		ADDESI, ecx
-						mov		ecx, CURCLIP
-						mov		CURCLIP, -1
-						CLIPRIGHT_DRAW_SIMPLE_SEGMENT :
-						//*****************************************//
-						//put various code with encoding&loop there//INVERTED
-						//*****************************************//
-						or cl, cl
-						jz		MPL4_1
-						xor		eax, eax
-						MPL4_0 : mov		al, [edi]
-						sub		al, 0xB0
-						cmp		al, 0x0B
-						ja		MPL4_0A
-						mov		ah, al
-						mov		al, [esi]
-						mov		al, [refl + eax]
-						mov[edi], al
-						MPL4_0A : inc		esi
-						dec		edi
-						dec		cl
-						jnz		MPL4_0
-						MPL4_1 : xor		eax, eax
-						//*****************************************//
-						//          end of variation zone          //INVERTED
-						//*****************************************//
-						add		esi, ADDESI
-						dec		TEMP1
-						jnz		CLIPRIGHT_START_SIMPLE_SEGMENT
-						CLIPRIGHT_NEXT_SEGMENT :
-					dec		NLines
-						jnz		CLIPRIGHT_START_SCANLINE
-						jmp		CLIPRIGHT_END_DRAW_PICTURE
-						CLIPRIGHT_DRAW_COMPLEX_LINE :
-					//complex packed line
-					mov		SPACE_MASK, 0
-						mov		PIX_MASK, 0
-						test	al, 64
-						jz		CLIPRIGHT_DCL1
-						mov		SPACE_MASK, 16
-						CLIPRIGHT_DCL1:		test	al, 32
-						jz		CLIPRIGHT_DCL2
-						mov		PIX_MASK, 16
-						CLIPRIGHT_DCL2 : and		al, 31
-						jz		CLIPRIGHT_NEXT_SEGMENT
-						mov		TEMP1, eax
-						CLIPRIGHT_START_COMPLEX_SEGMENT :
-					mov		al, [edx]
-						mov		cl, al
-						and		al, 15
-						or al, SPACE_MASK
-						sub		edi, eax
-						shr		cl, 4
-						or cl, PIX_MASK
-						inc		edx
-						sub		CURCLIP, eax
-						jg		CLIPRIGHT_TRY_TO_CLIP_COMPLEX
-						//full clipping until the end of line
-						add		esi, ecx
-						dec		TEMP1
-						jnz		CLIPRIGHT_START_COMPLEX_SEGMENT
-						dec		NLines
-						jnz		CLIPRIGHT_START_SCANLINE
-						jmp		CLIPRIGHT_END_DRAW_PICTURE
-						CLIPRIGHT_TRY_TO_CLIP_COMPLEX :
-					cmp		CURCLIP, ecx
-						jl		CLIPRIGHT_PARTIAL_COMPLEX
-						sub		CURCLIP, ecx
-						jmp		CLIPRIGHT_DRAW_COMPLEX_SEGMENT
-						CLIPRIGHT_PARTIAL_COMPLEX :
-					//partial clipping
-					sub		ecx, CURCLIP
-						mov		ADDESI, ecx
-						mov		ecx, CURCLIP
-						mov		CURCLIP, -1
-						CLIPRIGHT_DRAW_COMPLEX_SEGMENT :
-						//*****************************************//
-						//put various code with encoding&loop there//INVERTED
-						//*****************************************//
-						or cl, cl
-						jz		MPL5_1
-						xor		eax, eax
-						MPL5_0 : mov		al, [edi]
-						sub		al, 0xB0
-						cmp		al, 0x0B
-						ja		MPL5_0A
-						mov		ah, al
-						mov		al, [esi]
-						mov		al, [refl + eax]
-						mov[edi], al
-						MPL5_0A : inc		esi
-						dec		edi
-						dec		cl
-						jnz		MPL5_0
-						MPL5_1 : xor		eax, eax
-						//*****************************************//
-						//          end of variation zone          //INVERTED
-						//*****************************************//
-						add		esi, ADDESI
-						dec		TEMP1
-						jnz		CLIPRIGHT_START_COMPLEX_SEGMENT
-						dec		NLines
-						jnz		CLIPRIGHT_START_SCANLINE
-						CLIPRIGHT_END_DRAW_PICTURE :
-					//end code
-					pop		edi
-						pop		esi
-						popf
-				};
-			};
-		};
-	};
-};
+	GP_ShowMasked( GPB_MIRROR, true, x, y, Pic, CData, refl, WSHIFT );
+}
+
 inline void NatUnpack( byte* Dest, byte* Src, int Len )
 {
-	__asm {
-		push	esi
-		push	edi
-		pushf
-		mov		ecx, Len
-		shr		ecx, 2
-		mov		esi, Src
-		mov		edi, Dest
-		cld
-		jcxz	NTZERO
-		NTUNP1 : lodsb
-				 mov		bl, al
-				 mov		bh, al
-				 and		bl, 00110000b
-				 and		bh, 11000000b
-				 shr		bl, 4
-				 shr		bh, 6
-				 shl		ebx, 16
-				 mov		bl, al
-				 mov		bh, al
-				 and		bh, 00001100b
-				 and		bl, 00000011b
-				 shr		bh, 2
-				 mov		eax, ebx
-				 stosd
-				 dec		ecx
-				 jnz		NTUNP1
-				 NTZERO : popf
-						  pop		edi
-						  pop		esi
-	};
-};
+	GP_NatUnpack( Dest, Src, Len );
+}
+
 inline void GreyUnpack( byte* Dest, byte* Src, int Len )
 {
-	Len >>= 1;
-	__asm {
-		push	esi
-		push	edi
-		pushf
-		mov		ecx, Len
-		shr		ecx, 1
-		mov		esi, Src
-		mov		edi, Dest
-		cld
-		jcxz	NTZERO
-		NTUNP1 : lodsb
-				 mov		bl, al
-				 mov		bh, al
-				 and		bl, 00001111b
-				 shl     bl, 1
-				 and bh, 11110000b
-				 shr		bh, 3
-				 mov		ax, bx
-				 stosw
-				 dec		ecx
-				 jnz		NTUNP1
-				 NTZERO : popf
-						  pop		edi
-						  pop		esi
-	};
-};
+	GP_GreyUnpack( Dest, Src, Len );
+}
+
 inline void StdUnpack( byte* Dest, byte* Src, int Len, byte* Voc )
 {
-	//COUNTER++;
-	byte Calc;
-	__asm {
-		push	esi
-		push	edi
-		pushf
-		cld
-		mov		ebx, Src
-		mov		edi, Dest
-		mov		edx, Len
-		xor		eax, eax
-		xor		ecx, ecx
-		Unpack_Loop_Start_Octant :
-		mov		ah, [ebx]
-			mov		Calc, 8
-			inc		ebx
-			Unpack_Local_Start :
-		test	ah, 128
-			jz		O1UL_1
-			mov		cx, [ebx]
-			mov		esi, ecx
-			shr		ecx, 12
-			and esi, 0xFFF
-			add		ecx, 3
-			add		esi, Voc
-			add		ebx, 2
-			sub		edx, ecx
-			rep		movsb
-			jle		Unpack_End
-			shl		ah, 1
-			dec		Calc
-			jnz		Unpack_Local_Start
-			jmp		Unpack_Loop_Start_Octant
-			O1UL_1 : mov		al, [ebx]
-			mov[edi], al
-			inc		edi
-			dec		edx
-			jz		Unpack_End
-			inc		ebx
-			shl		ah, 1
-			dec		Calc
-			jnz		Unpack_Local_Start
-			jmp		Unpack_Loop_Start_Octant
-			Unpack_End :
-		popf
-			pop		edi
-			pop		esi
-	};
-};
+	GP_StdUnpack( Dest, Src, Len, Voc );
+}
+
 inline void LZUnpack( byte* Dest, byte* Src, int Len )
 {
-	byte Calc;
-	__asm {
-		push	esi
-		push	edi
-		pushf
-		cld
-		mov		ebx, Src
-		mov		edi, Dest
-		mov		edx, Len
-		xor		eax, eax
-		xor		ecx, ecx
-		Unpack_Loop_Start_Octant :
-		mov		ah, [ebx]
-			mov		Calc, 8
-			inc		ebx
-			Unpack_Local_Start :
-		test	ah, 1
-			jz		O1UL_1
-			mov		cx, [ebx]
-			mov		esi, ecx
-			and     esi, 0x1FFF
-			neg     esi
-			shr		ecx, 13
-			add		ecx, 3
-			add		esi, edi
-			dec		esi
-			add		ebx, 2
-			sub		edx, ecx
-			rep		movsb
-			jle		Unpack_End
-			shr		ah, 1
-			dec		Calc
-			jnz		Unpack_Local_Start
-			jmp		Unpack_Loop_Start_Octant
-			O1UL_1 : mov		al, [ebx]
-			mov[edi], al
-			inc		edi
-			dec		edx
-			jz		Unpack_End
-			inc		ebx
-			shr		ah, 1
-			dec		Calc
-			jnz		Unpack_Local_Start
-			jmp		Unpack_Loop_Start_Octant
-			Unpack_End :
-		popf
-			pop		edi
-			pop		esi
-	};
-};
+	GP_LZUnpack( Dest, Src, Len );
+}
+
 extern byte Bright[8192];
 
 
@@ -8338,6 +1158,7 @@ void GP_System::ShowGP(//IMPORTANT: show sprite with color masking
 
 		if (RLCImage[FileIndex])
 		{
+			GPB_FlushBands();
 			ShowRLCItem( x, y, RLCImage + FileIndex, SprIndex, Nation );
 		}
 
@@ -8369,7 +1190,7 @@ void GP_System::ShowGP(//IMPORTANT: show sprite with color masking
 	GP_Header* lpGPCUR = lpGP;
 
 
-	DWORD* PAK = CASHREF[FileIndex];
+	size_t* PAK = CASHREF[FileIndex];
 	PAK += PAK[RSprIndex];
 
 	if (ItDX[FileIndex])
@@ -8412,13 +1233,13 @@ void GP_System::ShowGP(//IMPORTANT: show sprite with color masking
 		case 0://standart packing
 			if (PACKOFS == NO_PACK)
 			{
-				PACKOFS = GetCash( UnpackLen + 18 );
-				INTV( PACKOFS ) = (int) ( PAK );//&lpGPCUR->Pack);
-				PACKOFS += 8;
-				//lpGPCUR->Pack=PACKOFS;
-				*PAK = (DWORD) PACKOFS;
+				PACKOFS = GetCash( UnpackLen + 18, PAK, FileIndex );
 				StdUnpack( PACKOFS, ( (byte*) lpGPCUR ) + CDOffs, UnpackLen, ( (byte*) lpGH ) + lpGH->VocOffset );
 			}
+			else
+			{
+				Cash->Touch( PACKOFS );
+			}
 
 			if (SprIndex >= 4096)
 				GP_ShowMaskedPictInv( x, y, lpGPCUR, PACKOFS, NULL );
@@ -8430,13 +1251,13 @@ void GP_System::ShowGP(//IMPORTANT: show sprite with color masking
 		case 1://National mask
 			if (PACKOFS == NO_PACK)
 			{
-				PACKOFS = GetCash( UnpackLen + 8 );
-				INTV( PACKOFS ) = (int) PAK;//&lpGPCUR->Pack);
-				PACKOFS += 8;
-				//lpGPCUR->Pack=PACKOFS;
-				*PAK = (DWORD) PACKOFS;
+				PACKOFS = GetCash( UnpackLen, PAK, FileIndex );
 				NatUnpack( PACKOFS, ( (byte*) lpGPCUR ) + CDOffs, UnpackLen );
 			}
+			else
+			{
+				Cash->Touch( PACKOFS );
+			}
 
 
 			if (SprIndex >= 4096)
@@ -8508,13 +1329,13 @@ void GP_System::ShowGP(//IMPORTANT: show sprite with color masking
 		case 38:
 			if (PACKOFS == NO_PACK)
 			{
-				PACKOFS = GetCash( UnpackLen + 8 );
-				INTV( PACKOFS ) = (int) PAK;//&lpGPCUR->Pack);
-				PACKOFS += 8;
-				//lpGPCUR->Pack=PACKOFS;
-				*PAK = (DWORD) PACKOFS;
+				PACKOFS = GetCash( UnpackLen, PAK, FileIndex );
 				GreyUnpack( PACKOFS, ( (byte*) lpGPCUR ) + CDOffs, UnpackLen );
-			};
+			}
+			else
+			{
+				Cash->Touch( PACKOFS );
+			}
 			switch (imt)
 			{
 			case 1://white
@@ -8603,13 +1424,13 @@ void GP_System::ShowGP(//IMPORTANT: show sprite with color masking
 		case 42:
 			if (PACKOFS == NO_PACK)
 			{
-				PACKOFS = GetCash( UnpackLen + 18 );
-				INTV( PACKOFS ) = (int) PAK;//&lpGPCUR->Pack);
-				PACKOFS += 8;
-				//lpGPCUR->Pack=PACKOFS;
-				*PAK = (DWORD) PACKOFS;
+				PACKOFS = GetCash( UnpackLen + 18, PAK, FileIndex );
 				LZUnpack( PACKOFS, ( (byte*) lpGPCUR ) + CDOffs, UnpackLen );
-			};
+			}
+			else
+			{
+				Cash->Touch( PACKOFS );
+			}
 			if (SprIndex >= 4096)GP_ShowMaskedPictInv( x, y, lpGPCUR, PACKOFS, NULL );
 			else GP_ShowMaskedPict( x, y, lpGPCUR, PACKOFS, NULL );
 			break;
@@ -8652,6 +1473,7 @@ void GP_System::ShowGPLayers(//IMPORTANT: color masking for units and buildings
 		}
 		if (RLCImage[FileIndex])
 		{
+			GPB_FlushBands();
 			ShowRLCItem( x, y, RLCImage + FileIndex, SprIndex, Nation );
 		}
 		return;
@@ -8665,7 +1487,7 @@ void GP_System::ShowGPLayers(//IMPORTANT: color masking for units and buildings
 	GP_GlobalHeader* lpGH = GPH[FileIndex];
 	GP_Header* lpGP = GPX( lpGH, LGPH[SprIndex & 4095] );
 	GP_Header* lpGPCUR = lpGP;
-	DWORD* PAK = CASHREF[FileIndex];
+	size_t* PAK = CASHREF[FileIndex];
 	PAK += PAK[SprIndex & 4095];
 	int DIFF = -1;
 	int UnpackLen = lpGP->CData >> 14;
@@ -8698,13 +1520,13 @@ void GP_System::ShowGPLayers(//IMPORTANT: color masking for units and buildings
 			{
 				if (PACKOFS == NO_PACK)
 				{
-					PACKOFS = GetCash( UnpackLen + 18 );
-					INTV( PACKOFS ) = (int) PAK;//&lpGPCUR->Pack);
-					PACKOFS += 8;
-					//lpGPCUR->Pack=PACKOFS;
-					*PAK = (DWORD) PACKOFS;
+					PACKOFS = GetCash( UnpackLen + 18, PAK, FileIndex );
 					StdUnpack( PACKOFS, ( (byte*) lpGPCUR ) + CDOffs, UnpackLen, ( (byte*) lpGH ) + lpGH->VocOffset );
-				};
+				}
+				else
+				{
+					Cash->Touch( PACKOFS );
+				}
 				if (mask & 512)
 				{
 					if (SprIndex >= 4096)GP_ShowMaskedPictInv( x, y, lpGPCUR, PACKOFS, NULL );
@@ -8722,13 +1544,13 @@ void GP_System::ShowGPLayers(//IMPORTANT: color masking for units and buildings
 			{
 				if (PACKOFS == NO_PACK)
 				{
-					PACKOFS = GetCash( UnpackLen + 8 );
-					INTV( PACKOFS ) = (int) PAK;//&lpGPCUR->Pack);
-					PACKOFS += 8;
-					//lpGPCUR->Pack=PACKOFS;
-					*PAK = (DWORD) PACKOFS;
+					PACKOFS = GetCash( UnpackLen, PAK, FileIndex );
 					NatUnpack( PACKOFS, ( (byte*) lpGPCUR ) + CDOffs, UnpackLen );
-				};
+				}
+				else
+				{
+					Cash->Touch( PACKOFS );
+				}
 				if (SprIndex >= 4096)GP_ShowMaskedPalPictInv( x, y, lpGPCUR, PACKOFS, (byte*) ( NatPal + ( Nation << 2 ) ) );
 				else GP_ShowMaskedPalPict( x, y, lpGPCUR, PACKOFS, (byte*) ( NatPal + ( Nation << 2 ) ) );
 			};
@@ -8793,13 +1615,13 @@ void GP_System::ShowGPLayers(//IMPORTANT: color masking for units and buildings
 			{
 				if (PACKOFS == NO_PACK)
 				{
-					PACKOFS = GetCash( UnpackLen + 8 );
-					INTV( PACKOFS ) = (int) PAK;//&lpGPCUR->Pack);
-					PACKOFS += 8;
-					//lpGPCUR->Pack=PACKOFS;
-					*PAK = (DWORD) PACKOFS;
+					PACKOFS = GetCash( UnpackLen, PAK, FileIndex );
 					GreyUnpack( PACKOFS, ( (byte*) lpGPCUR ) + CDOffs, UnpackLen );
-				};
+				}
+				else
+				{
+					Cash->Touch( PACKOFS );
+				}
 				switch (imt)
 				{
 				case 1://white
@@ -8890,13 +1712,13 @@ void GP_System::ShowGPLayers(//IMPORTANT: color masking for units and buildings
 			{
 				if (PACKOFS == NO_PACK)
 				{
-					PACKOFS = GetCash( UnpackLen + 18 );
-					INTV( PACKOFS ) = (int) PAK;//&lpGPCUR->Pack);
-					PACKOFS += 8;
-					//lpGPCUR->Pack=PACKOFS;
-					*PAK = (DWORD) PACKOFS;
+					PACKOFS = GetCash( UnpackLen + 18, PAK, FileIndex );
 					LZUnpack( PACKOFS, ( (byte*) lpGPCUR ) + CDOffs, UnpackLen );
-				};
+				}
+				else
+				{
+					Cash->Touch( PACKOFS );
+				}
 				if (mask & 512)
 				{
 					if (SprIndex >= 4096)GP_ShowMaskedPictInv( x, y, lpGPCUR, PACKOFS, NULL );
@@ -8942,7 +1764,11 @@ void GP_System::ShowGPTransparent( int x, int y, int FileIndex, int SprIndex, by
 		{
 			LoadGP( FileIndex );
 		};
-		if (RLCImage[FileIndex])ShowRLCItem( x, y, RLCImage + FileIndex, SprIndex, Nation );
+		if (RLCImage[FileIndex])
+		{
+			GPB_FlushBands();
+			ShowRLCItem( x, y, RLCImage + FileIndex, SprIndex, Nation );
+		}
 
 		return;
 	};
@@ -8953,7 +1779,7 @@ void GP_System::ShowGPTransparent( int x, int y, int FileIndex, int SprIndex, by
 	GP_GlobalHeader* lpGH = GPH[FileIndex];
 	GP_Header* lpGP = GPX( lpGH, LGPH[SprIndex & 4095] );
 	GP_Header* lpGPCUR = lpGP;
-	DWORD* PAK = CASHREF[FileIndex];
+	size_t* PAK = CASHREF[FileIndex];
 	PAK += PAK[SprIndex & 4095];
 	int DIFF = -1;
 	int UnpackLen = lpGP->CData >> 14;
@@ -8972,26 +1798,26 @@ void GP_System::ShowGPTransparent( int x, int y, int FileIndex, int SprIndex, by
 		case 0://standart packing
 			if (PACKOFS == NO_PACK)
 			{
-				PACKOFS = GetCash( UnpackLen + 18 );
-				INTV( PACKOFS ) = (int) PAK;//&lpGPCUR->Pack);
-				PACKOFS += 8;
-				//lpGPCUR->Pack=PACKOFS;
-				*PAK = (DWORD) PACKOFS;
+				PACKOFS = GetCash( UnpackLen + 18, PAK, FileIndex );
 				StdUnpack( PACKOFS, ( (byte*) lpGPCUR ) + CDOffs, UnpackLen, ( (byte*) lpGH ) + lpGH->VocOffset );
-			};
+			}
+			else
+			{
+				Cash->Touch( PACKOFS );
+			}
 			if (SprIndex >= 4096)GP_ShowMaskedMultiPalPictInv( x, y, lpGPCUR, PACKOFS, trans8 );
 			else GP_ShowMaskedMultiPalPict( x, y, lpGPCUR, PACKOFS, trans8 );
 			break;
 		case 1://National mask
 			if (PACKOFS == NO_PACK)
 			{
-				PACKOFS = GetCash( UnpackLen + 8 );
-				INTV( PACKOFS ) = (int) PAK;//&lpGPCUR->Pack);
-				PACKOFS += 8;
-				//lpGPCUR->Pack=PACKOFS;
-				*PAK = (DWORD) PACKOFS;
+				PACKOFS = GetCash( UnpackLen, PAK, FileIndex );
 				NatUnpack( PACKOFS, ( (byte*) lpGPCUR ) + CDOffs, UnpackLen );
-			};
+			}
+			else
+			{
+				Cash->Touch( PACKOFS );
+			}
 			if (SprIndex >= 4096)GP_ShowMaskedPalPictInv( x, y, lpGPCUR, PACKOFS, (byte*) ( NatPal + ( Nation << 2 ) ) );
 			else GP_ShowMaskedPalPict( x, y, lpGPCUR, PACKOFS, (byte*) ( NatPal + ( Nation << 2 ) ) );
 			break;
@@ -9015,13 +1841,13 @@ void GP_System::ShowGPTransparent( int x, int y, int FileIndex, int SprIndex, by
 		case 42:
 			if (PACKOFS == NO_PACK)
 			{
-				PACKOFS = GetCash( UnpackLen + 18 );
-				INTV( PACKOFS ) = (int) PAK;//&lpGPCUR->Pack);
-				PACKOFS += 8;
-				//lpGPCUR->Pack=PACKOFS;
-				*PAK = (DWORD) PACKOFS;
+				PACKOFS = GetCash( UnpackLen + 18, PAK, FileIndex );
 				LZUnpack( PACKOFS, ( (byte*) lpGPCUR ) + CDOffs, UnpackLen );
-			};
+			}
+			else
+			{
+				Cash->Touch( PACKOFS );
+			}
 			if (SprIndex >= 4096)GP_ShowMaskedMultiPalPictInv( x, y, lpGPCUR, PACKOFS, trans8 );
 			else GP_ShowMaskedMultiPalPict( x, y, lpGPCUR, PACKOFS, trans8 );
 			break;
@@ -9060,7 +1886,11 @@ void GP_System::ShowGPTransparentLayers( int x, int y, int FileIndex, int SprInd
 		{
 			LoadGP( FileIndex );
 		};
-		if (RLCImage[FileIndex])ShowRLCItem( x, y, RLCImage + FileIndex, SprIndex, Nation );
+		if (RLCImage[FileIndex])
+		{
+			GPB_FlushBands();
+			ShowRLCItem( x, y, RLCImage + FileIndex, SprIndex, Nation );
+		}
 
 		return;
 	};
@@ -9071,7 +1901,7 @@ void GP_System::ShowGPTransparentLayers( int x, int y, int FileIndex, int SprInd
 	GP_GlobalHeader* lpGH = GPH[FileIndex];
 	GP_Header* lpGP = GPX( lpGH, LGPH[SprIndex & 4095] );
 	GP_Header* lpGPCUR = lpGP;
-	DWORD* PAK = CASHREF[FileIndex];
+	size_t* PAK = CASHREF[FileIndex];
 	PAK += PAK[SprIndex & 4095];
 	int DIFF = -1;
 	int UnpackLen = lpGP->CData >> 14;
@@ -9092,13 +1922,13 @@ void GP_System::ShowGPTransparentLayers( int x, int y, int FileIndex, int SprInd
 			{
 				if (PACKOFS == NO_PACK)
 				{
-					PACKOFS = GetCash( UnpackLen + 18 );
-					INTV( PACKOFS ) = (int) PAK;//&lpGPCUR->Pack);
-					PACKOFS += 8;
-					//lpGPCUR->Pack=PACKOFS;
-					*PAK = (DWORD) PACKOFS;
+					PACKOFS = GetCash( UnpackLen + 18, PAK, FileIndex );
 					StdUnpack( PACKOFS, ( (byte*) lpGPCUR ) + CDOffs, UnpackLen, ( (byte*) lpGH ) + lpGH->VocOffset );
-				};
+				}
+				else
+				{
+					Cash->Touch( PACKOFS );
+				}
 				if (SprIndex >= 4096)GP_ShowMaskedMultiPalPictInv( x, y, lpGPCUR, PACKOFS, trans8 );
 				else GP_ShowMaskedMultiPalPict( x, y, lpGPCUR, PACKOFS, trans8 );
 			};
@@ -9108,13 +1938,13 @@ void GP_System::ShowGPTransparentLayers( int x, int y, int FileIndex, int SprInd
 			{
 				if (PACKOFS == NO_PACK)
 				{
-					PACKOFS = GetCash( UnpackLen + 8 );
-					INTV( PACKOFS ) = (int) PAK;//&lpGPCUR->Pack);
-					PACKOFS += 8;
-					//lpGPCUR->Pack=PACKOFS;
-					*PAK = (DWORD) PACKOFS;
+					PACKOFS = GetCash( UnpackLen, PAK, FileIndex );
 					NatUnpack( PACKOFS, ( (byte*) lpGPCUR ) + CDOffs, UnpackLen );
 				}
+				else
+				{
+					Cash->Touch( PACKOFS );
+				}
 
 				if (SprIndex >= 4096)
 				{
@@ -9170,13 +2000,13 @@ void GP_System::ShowGPTransparentLayers( int x, int y, int FileIndex, int SprInd
 			{
 				if (PACKOFS == NO_PACK)
 				{
-					PACKOFS = GetCash( UnpackLen + 18 );
-					INTV( PACKOFS ) = (int) PAK;//&lpGPCUR->Pack);
-					PACKOFS += 8;
-					//lpGPCUR->Pack=PACKOFS;
-					*PAK = (DWORD) PACKOFS;
+					PACKOFS = GetCash( UnpackLen + 18, PAK, FileIndex );
 					LZUnpack( PACKOFS, ( (byte*) lpGPCUR ) + CDOffs, UnpackLen );
-				};
+				}
+				else
+				{
+					Cash->Touch( PACKOFS );
+				}
 				if (SprIndex >= 4096)GP_ShowMaskedMultiPalPictInv( x, y, lpGPCUR, PACKOFS, trans8 );
 				else GP_ShowMaskedMultiPalPict( x, y, lpGPCUR, PACKOFS, trans8 );
 			};
@@ -9209,61 +2039,9 @@ void GP_System::FreeRefs( int FileIndex )
 		return;
 	}
 
-	GP_GlobalHeader* lpGH = GPH[FileIndex];
-	int NFR = GPNFrames[FileIndex];
-
-	for (int SprIndex = 0; SprIndex < NFR; SprIndex++)
-	{
-		GP_Header* lpGP = GPX( lpGH, LGPH[SprIndex & 4095] );
-		GP_Header* lpGPCUR = lpGP;
-		DWORD* PAK = CASHREF[FileIndex];
-		PAK += PAK[SprIndex & 4095];
-
-		int DIFF = -1;
-
-		int UnpackLen = lpGP->CData >> 14;
-		int CDOffs = lpGP->CData & 16383;
-
-		byte Optx = lpGP->Options;
-		if (Optx & 64)
-			CDOffs += 16384;
-		if (Optx & 128)
-			CDOffs += 32768;
-
-		byte* PACKOFS = (byte*) ( *PAK );//lpGP->Pack;
-
-		do
-		{
-			if (( PACKOFS ) && PACKOFS != NO_PACK)
-			{
-				INTV( PACKOFS - 8 ) = 0;
-			}
-
-			//lpGPCUR->Pack=NULL;
-
-			*PAK = 0xFFFFFFFF;
-			DIFF = lpGPCUR->NextPict;
-
-			__asm
-			{
-				mov		eax, lpGP
-				add		eax, DIFF
-				mov		lpGPCUR, eax
-			}
-
-			UnpackLen = lpGPCUR->CData >> 14;
-			CDOffs = lpGPCUR->CData & 16383;
-
-			byte Optx = lpGPCUR->Options;
-			if (Optx & 64)
-				CDOffs += 16384;
-			if (Optx & 128)
-				CDOffs += 32768;
-
-			PAK++;
-			PACKOFS = (byte*) ( *PAK );//lpGPCUR->Pack;
-		} while (DIFF != -1);
-	}
+	//the cash resets the layer slots of the blocks it drops
+	Cash->FreeFile( FileIndex );
+	FreeAtlas( FileIndex );
 }
 
 void GP_System::ShowGPPal(//IMPORTANT: color masking for buildings (only in placement mode) and ???
@@ -9282,7 +2060,10 @@ void GP_System::ShowGPPal(//IMPORTANT: color masking for buildings (only in plac
 			LoadGP( FileIndex );
 		}
 		if (RLCImage[FileIndex])
+		{
+			GPB_FlushBands();
 			ShowRLCItemPal( x, y, RLCImage + FileIndex, SprIndex, Table );
+		}
 
 
 
@@ -9297,7 +2078,7 @@ void GP_System::ShowGPPal(//IMPORTANT: color masking for buildings (only in plac
 	GP_GlobalHeader* lpGH = GPH[FileIndex];
 	GP_Header* lpGP = GPX( lpGH, LGPH[SprIndex & 4095] );
 	GP_Header* lpGPCUR = lpGP;
-	DWORD* PAK = CASHREF[FileIndex];
+	size_t* PAK = CASHREF[FileIndex];
 	PAK += PAK[SprIndex & 4095];
 	int imt = ImageType[FileIndex] >> 4;
 	int DIFF = -1;
@@ -9315,12 +2096,13 @@ void GP_System::ShowGPPal(//IMPORTANT: color masking for buildings (only in plac
 		case 0://standart packing
 			if (PACKOFS == NO_PACK)
 			{
-				PACKOFS = GetCash( UnpackLen + 18 );
-				INTV( PACKOFS ) = (int) PAK;
-				PACKOFS += 8;
-				*PAK = (DWORD) PACKOFS;
+				PACKOFS = GetCash( UnpackLen + 18, PAK, FileIndex );
 				StdUnpack( PACKOFS, ( (byte*) lpGPCUR ) + CDOffs, UnpackLen, ( (byte*) lpGH ) + lpGH->VocOffset );
 			}
+			else
+			{
+				Cash->Touch( PACKOFS );
+			}
 
 			if (SprIndex >= 4096)
 				GP_ShowMaskedPalPictInv( x, y, lpGPCUR, PACKOFS, Table );
@@ -9331,12 +2113,13 @@ void GP_System::ShowGPPal(//IMPORTANT: color masking for buildings (only in plac
 		case 1://National mask
 			if (PACKOFS == NO_PACK)
 			{
-				PACKOFS = GetCash( UnpackLen + 8 );
-				INTV( PACKOFS ) = (int) PAK;
-				PACKOFS += 8;
-				*PAK = (DWORD) PACKOFS;
+				PACKOFS = GetCash( UnpackLen, PAK, FileIndex );
 				NatUnpack( PACKOFS, ( (byte*) lpGPCUR ) + CDOffs, UnpackLen );
 			}
+			else
+			{
+				Cash->Touch( PACKOFS );
+			}
 
 			if (SprIndex >= 4096)
 			{
@@ -9377,12 +2160,13 @@ void GP_System::ShowGPPal(//IMPORTANT: color masking for buildings (only in plac
 		case 42:
 			if (PACKOFS == NO_PACK)
 			{
-				PACKOFS = GetCash( UnpackLen + 18 );
-				INTV( PACKOFS ) = (int) PAK;
-				PACKOFS += 8;
-				*PAK = (DWORD) PACKOFS;
+				PACKOFS = GetCash( UnpackLen + 18, PAK, FileIndex );
 				LZUnpack( PACKOFS, ( (byte*) lpGPCUR ) + CDOffs, UnpackLen );
 			}
+			else
+			{
+				Cash->Touch( PACKOFS );
+			}
 
 			if (SprIndex >= 4096)
 			{
@@ -9396,12 +2180,13 @@ void GP_System::ShowGPPal(//IMPORTANT: color masking for buildings (only in plac
 		case 38:
 			if (PACKOFS == NO_PACK)
 			{
-				PACKOFS = GetCash( UnpackLen + 8 );
-				INTV( PACKOFS ) = (int) PAK;
-				PACKOFS += 8;
-				*PAK = (DWORD) PACKOFS;
+				PACKOFS = GetCash( UnpackLen, PAK, FileIndex );
 				GreyUnpack( PACKOFS, ( (byte*) lpGPCUR ) + CDOffs, UnpackLen );
 			}
+			else
+			{
+				Cash->Touch( PACKOFS );
+			}
 
 			switch (imt)
 			{
@@ -9493,7 +2278,11 @@ void GP_System::ShowGPPalLayers(//IMPORTANT: color masking for buildings (only w
 		{
 			LoadGP( FileIndex );
 		}
-		if (RLCImage[FileIndex])ShowRLCItemPal( x, y, RLCImage + FileIndex, SprIndex, Table );
+		if (RLCImage[FileIndex])
+		{
+			GPB_FlushBands();
+			ShowRLCItemPal( x, y, RLCImage + FileIndex, SprIndex, Table );
+		}
 
 		return;
 	}
@@ -9507,7 +2296,7 @@ void GP_System::ShowGPPalLayers(//IMPORTANT: color masking for buildings (only w
 	GP_GlobalHeader* lpGH = GPH[FileIndex];
 	GP_Header* lpGP = GPX( lpGH, LGPH[SprIndex & 4095] );
 	GP_Header* lpGPCUR = lpGP;
-	DWORD* PAK = CASHREF[FileIndex];
+	size_t* PAK = CASHREF[FileIndex];
 	PAK += PAK[SprIndex & 4095];
 	int DIFF = -1;
 	int UnpackLen = lpGP->CData >> 14;
@@ -9526,13 +2315,13 @@ void GP_System::ShowGPPalLayers(//IMPORTANT: color masking for buildings (only w
 			{
 				if (PACKOFS == NO_PACK)
 				{
-					PACKOFS = GetCash( UnpackLen + 18 );
-					INTV( PACKOFS ) = (int) PAK;//&lpGPCUR->Pack);
-					PACKOFS += 8;
-					//lpGPCUR->Pack=PACKOFS;
-					*PAK = (DWORD) PACKOFS;
+					PACKOFS = GetCash( UnpackLen + 18, PAK, FileIndex );
 					StdUnpack( PACKOFS, ( (byte*) lpGPCUR ) + CDOffs, UnpackLen, ( (byte*) lpGH ) + lpGH->VocOffset );
-				};
+				}
+				else
+				{
+					Cash->Touch( PACKOFS );
+				}
 				if (SprIndex >= 4096)GP_ShowMaskedPalPictInv( x, y, lpGPCUR, PACKOFS, Table );
 				else GP_ShowMaskedPalPict( x, y, lpGPCUR, PACKOFS, Table );
 			};
@@ -9542,13 +2331,13 @@ void GP_System::ShowGPPalLayers(//IMPORTANT: color masking for buildings (only w
 			{
 				if (PACKOFS == NO_PACK)
 				{
-					PACKOFS = GetCash( UnpackLen + 8 );
-					INTV( PACKOFS ) = (int) PAK;//&lpGPCUR->Pack);
-					PACKOFS += 8;
-					//lpGPCUR->Pack=PACKOFS;
-					*PAK = (DWORD) PACKOFS;
+					PACKOFS = GetCash( UnpackLen, PAK, FileIndex );
 					NatUnpack( PACKOFS, ( (byte*) lpGPCUR ) + CDOffs, UnpackLen );
-				};
+				}
+				else
+				{
+					Cash->Touch( PACKOFS );
+				}
 				if (SprIndex >= 4096)GP_ShowMaskedPalPictInv( x, y, lpGPCUR, PACKOFS, (byte*) ( NatPal + ( Nation << 2 ) ) );
 				else GP_ShowMaskedPalPict( x, y, lpGPCUR, PACKOFS, (byte*) ( NatPal + ( Nation << 2 ) ) );
 			};
@@ -9603,13 +2392,13 @@ void GP_System::ShowGPPalLayers(//IMPORTANT: color masking for buildings (only w
 			{
 				if (PACKOFS == NO_PACK)
 				{
-					PACKOFS = GetCash( UnpackLen + 18 );
-					INTV( PACKOFS ) = (int) PAK;//&lpGPCUR->Pack);
-					PACKOFS += 8;
-					//lpGPCUR->Pack=PACKOFS;
-					*PAK = (DWORD) PACKOFS;
+					PACKOFS = GetCash( UnpackLen + 18, PAK, FileIndex );
 					LZUnpack( PACKOFS, ( (byte*) lpGPCUR ) + CDOffs, UnpackLen );
-				};
+				}
+				else
+				{
+					Cash->Touch( PACKOFS );
+				}
 				if (SprIndex >= 4096)GP_ShowMaskedPalPictInv( x, y, lpGPCUR, PACKOFS, Table );
 				else GP_ShowMaskedPalPict( x, y, lpGPCUR, PACKOFS, Table );
 			};
@@ -9619,13 +2408,13 @@ void GP_System::ShowGPPalLayers(//IMPORTANT: color masking for buildings (only w
 			{
 				if (PACKOFS == NO_PACK)
 				{
-					PACKOFS = GetCash( UnpackLen + 8 );
-					INTV( PACKOFS ) = (int) PAK;//&lpGPCUR->Pack);
-					PACKOFS += 8;
-					//lpGPCUR->Pack=PACKOFS;
-					*PAK = (DWORD) PACKOFS;
+					PACKOFS = GetCash( UnpackLen, PAK, FileIndex );
 					GreyUnpack( PACKOFS, ( (byte*) lpGPCUR ) + CDOffs, UnpackLen );
-				};
+				}
+				else
+				{
+					Cash->Touch( PACKOFS );
+				}
 				switch (imt)
 				{
 				case 1://white
@@ -9749,7 +2538,11 @@ void GP_System::ShowGPGrad( int x, int y, int FileIndex, int SprIndex, byte Nati
 		{
 			LoadGP( FileIndex );
 		};
-		if (RLCImage[FileIndex])ShowRLCItemGrad( x, y, RLCImage + FileIndex, SprIndex, Table );
+		if (RLCImage[FileIndex])
+		{
+			GPB_FlushBands();
+			ShowRLCItemGrad( x, y, RLCImage + FileIndex, SprIndex, Table );
+		}
 
 		return;
 	};
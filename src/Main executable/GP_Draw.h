@@ -16,7 +16,7 @@ public:
 	short dy;
 	short Lx;
 	short Ly;
-	byte* Pack;
+	DWORD Pack;//unused, keeps the 23 byte layout of the file
 	char  Options;
 	DWORD CData;
 	short NLines;
@@ -63,16 +63,17 @@ public:
 	UNICODETABLE* FindFont(char* Name);
 };
 extern GP_API UNIFONTS UFONTS;
-#define NO_PACK ((byte*)0xFFFFFFFF)
+#define NO_PACK ((byte*)~(size_t)0)
 void ErrM(char* s);
 typedef GP_GlobalHeader* lpGP_GlobalHeader;
+class GP_Cache;
+struct GPA_Atlas;
 
 class GP_API GP_System
 {
 public:
-	byte* PackCash;
-	int CashSize;
-	int CashPos;
+	//Unpacked layers, see NewCode/GP_Cache.h
+	GP_Cache* Cash;
 
 	//Current amount of loaded images in this instance
 	int NGP;
@@ -82,7 +83,15 @@ public:
 	//Array of pointers to buffers with loaded resource files
 	GP_GlobalHeader** GPH;
 
-	DWORD** CASHREF;
+	//Per file: NFrames indices of the first layer slot, then the layer slots
+	size_t** CASHREF;
+	//Atlas mode: all packed layers of a file are unpacked once by LoadGP,
+	//packed into an atlas (NewCode/GP_Atlas.h) and never go through the
+	//cash. The layer slots point at AtlasSlots, each holds its frame.
+	bool UseAtlas;
+	GPA_Atlas** Atlas;
+	byte** AtlasSlots;
+	int* AtlasSize;
 	byte* Mapping;
 	char** GPNames;
 	word* GPNFrames;
@@ -105,7 +114,21 @@ public:
 	UNICODETABLE** UNITBL;
 	GP_System();
 	~GP_System();
-	byte* GetCash(int Size);
+	byte* GetCash(int Size,size_t* Ref,int FileIndex);
+	void SetCashBudget(int Bytes);
+	//Writes hits, misses, evictions and unpacked bytes of every file
+	void SaveCashStats(char* Name);
+	bool BuildAtlas(int i);
+	void FreeAtlas(int i);
+	//Reserves cash for the packed layers of a frame and queues their unpacking
+	void QueueUnpackGP(int FileIndex,int SprIndex);
+	//Unpacks the queued layers as one batch split over the worker threads,
+	//returns when all of them are done
+	void UnpackQueued();
+	//Masked layers drawn between the calls are rendered in row bands on
+	//the worker threads (NewCode/GP_Bands.h)
+	void BeginBands();
+	void EndBands();
 	int PreLoadGPImage(char* Name);
 	int PreLoadGPImage(char* Name,bool Shadow);
 	bool LoadGP(int i);
@@ -3,6 +3,7 @@
 #include "NewCode/UdpHolePuncher.h"
 
 #include "ddini.h"
+#include "NewCode/FrameBench.h"
 #include "ResFile.h"
 #include "FastDraw.h"
 #include "mgraph.h"
@@ -6676,7 +6677,12 @@ int processMainMenu()
 				ItemChoose = 111;
 			}
 
-			if ( TOTALEXIT )
+			if ( FB_Pending() )
+			{
+				ItemChoose = 112;
+			}
+
+			if ( TOTALEXIT || FB_Finished() )
 			{
 				ItemChoose = mcmExit;
 			}
@@ -6729,7 +6735,10 @@ int processMainMenu()
 		if ( ItemChoose == mcmExit )
 		{
 			SlowUnLoadPalette( "2\\agew_1.pal" );
-			SlideShow();
+			if ( !FB_Finished() )
+			{
+				SlideShow();
+			}
 		}
 
 		if ( ItemChoose == 43 )
@@ -6757,6 +6766,23 @@ int processMainMenu()
 			ItemChoose = mcmSingle;
 			RUNUSERMISSION = 0;
 		}
+
+		if ( ItemChoose == 112 )
+		{
+			//Render benchmark, see bench.dat
+			if ( !PlName[0] )
+			{
+				strcpy( PlName, "Player" );
+			}
+			EditMapMode = 0;
+			ShowLoading();
+			PrepareToGame();
+			SFLB_LoadGame( (char*) FB_GetSaveName(), 1 );
+			HideFlags();
+			ContinueGame = true;
+			FB_Start();
+			ItemChoose = mcmSingle;
+		}
 		break;
 	}
 
@@ -7513,6 +7539,7 @@ void EnterChat()
 												OB->Ref.General = GO;
 												OB->NIndex = i;
 												OB->newMons = GO->newMons;
+												IndexObject( OB );
 											};
 										};
 									};
@@ -8560,7 +8587,9 @@ void DrawAllScreen()
 	GFieldShow();
 
 	//Copy minimap into screen buffer
+	FB_BeginStage( FBS_MINIMAP );
 	GMiniShow();
+	FB_EndStage( FBS_MINIMAP );
 
 	//Draw units?
 	ShowProp();
@@ -8606,7 +8635,9 @@ void FastScreenProcess()
 
 	if ( SHOWSLIDE )
 	{
+		FB_BeginStage( FBS_MINIMAP );
 		GMiniShow();
+		FB_EndStage( FBS_MINIMAP );
 
 		ShowProp();
 
@@ -8770,6 +8801,8 @@ extern int screen_width;
 extern int screen_height;
 
 //Main game loop
+void SaveScreenShot( char* Name );
+
 void PlayGame()
 {
 	InGame = true;
@@ -8822,6 +8855,10 @@ StartPlay://IMPORTANT: Main game loop
 
 			ProcessMessages();
 
+			//Render benchmark moves the camera itself
+			FB_GetCamera( &mapx, &mapy );
+			FB_BeginStage( FBS_FRAME );
+
 			if ( GameNeedToDraw )
 			{
 				DrawAllScreen();
@@ -8832,6 +8869,18 @@ StartPlay://IMPORTANT: Main game loop
 				FastScreenProcess();
 			}
 
+			FB_EndStage( FBS_FRAME );
+			FB_SetOrderHigh( OrdPool.GetFrameHigh() );
+			char BenchShot[64];
+			if ( FB_EndFrame( BenchShot ) )
+			{
+				SaveScreenShot( BenchShot );
+			}
+			if ( FB_Finished() )
+			{
+				GameExit = true;
+			}
+
 			ProcessMessages();
 
 			time1 = GetRealTime();
@@ -13932,6 +13981,7 @@ KRT:
 											OB->Ref.General = GO;
 											OB->NIndex = i;
 											OB->newMons = GO->newMons;
+											IndexObject( OB );
 										}
 									}
 								}
@@ -30,6 +30,10 @@
 #include "Graphs.h"
 #include "EinfoClass.h"
 #include "VirtScreen.h"
+#include "NewCode/FogDiffusion.h"
+#include "NewCode/TargetQuery.h"
+#include "NewCode/PathFinder.h"
+#include "NewCode/DangerField.h"
 
 #include "PlayerInfo.h"
 extern PlayerInfo PINFO[8];
@@ -398,7 +402,6 @@ extern char LASTSAVEFILE[64];
 extern int LastAddSpr;
 extern byte* RivDir;
 void ClearSMS();
-extern int NeedITR;
 void DoNormalTBL();
 extern int GameTime;
 extern int PeaceTimeLeft;
@@ -483,9 +486,9 @@ void UnLoading()
 	CURTMTMT = 0;
 	PeaceTimeLeft = 0;
 	DoNormalTBL();
-	NeedITR = 100;
 	ClearSMS();
 	memset( NPresence, 0, VAL_MAXCIOFS );
+	TQ_Clear();
 
 	LastAddSpr = 0;
 	CLRGR();
@@ -517,7 +520,8 @@ void UnLoading()
 	MapScenaryDLL[0] = 0;
 	ReloadECO();
 	GoAndAttackMode = 0;
-	memset( BLDList, 0xFF, VAL_MAXCIOFS * 2 );
+	CB_Reset();
+	PF_Reset();
 	tmtmt = 0;
 	REALTIME = 0;
 	RealTime = 0;
@@ -567,6 +571,7 @@ void UnLoading()
 		if (Group[i])
 		{
 			Group[i]->CloseObject();
+			UnindexObject( i );
 			Group[i] = NULL;
 		}
 	}
@@ -768,6 +773,8 @@ void SaveMap( SaveBuf* SB )
 	SaveRLE1( SB, UnitsField.MapV, MAPSY*BMSX );
 	SaveRLE1( SB, MFIELDS[0].MapV, MAPSY*BMSX );
 	SaveRLE1( SB, MFIELDS[1].MapV, MAPSY*BMSX );
+	//the searches are not saved, go on like the loaded game will
+	PF_Reset();
 	if (FishMap)
 	{
 		xBlockWrite( SB, &FishLx, 4 );
@@ -794,6 +801,7 @@ void LoadMap( SaveBuf* SB )
 	LoadRLE1( SB, UnitsField.MapV );
 	LoadRLE1( SB, MFIELDS[0].MapV );
 	LoadRLE1( SB, MFIELDS[1].MapV );
+	PF_Reset();
 	//UnitsField.ClearMaps();
 	SetLight( 0, 20, 30 );
 	if (FishMap)
@@ -1299,7 +1307,7 @@ void LoadObjects( SaveBuf* SB )
 		if (OB->InFire)CreateGround( OB );
 		OB->ImSelected = OB->Selected;
 	};
-
+	ReindexObjects();
 };
 void SaveSelection( SaveBuf* SB )
 {
@@ -1752,6 +1760,7 @@ void LS_SaveTopology( SaveBuf* SB )
 };
 void CreateRoadsNet();
 void ClearLinkInfo();
+void CreateLinkInfo();
 void LS_LoadTopology( SaveBuf* SB )
 {
 	ClearLinkInfo();
@@ -1796,6 +1805,9 @@ void LS_LoadTopology( SaveBuf* SB )
 		xBlockRead( SB, TmpMLinks, NAreas*NAreas * 2 );
 		xBlockRead( SB, TmpMDist, NAreas*NAreas * 2 );
 	};
+	//the dynamical topology repairs exact matrices, the saved ones may come
+	//from the old relaxation
+	CreateLinkInfo();
 	//CreateRoadsNet();
 };
 //--------------------------Saving AI-------------------------//
@@ -2854,6 +2866,7 @@ void CreateMaskForSaveFile( char* Name )
 }
 
 void ResearchIslands();
+void IndexCostPlaces();
 
 int GetMapSUMM( char* Name )
 {
@@ -3128,6 +3141,9 @@ void SFLB_PreLoadGame( SaveBuf* SB, bool LoadNation )
 		ResearchCurrentIsland( i );
 	}
 
+	//the cost places came before the water topology
+	IndexCostPlaces();
+
 	SetMonstersInCells();
 
 	int ttt = 0;
@@ -3221,11 +3237,10 @@ extern int FMSX;
 extern int FMSX2;
 extern word* fmap1;
 
-extern byte* MCount;
+extern word* MCount;
 extern word* BLDList;
 
 extern byte* NPresence;
-extern byte* TmpMC;
 extern WallCell** WRefs;
 extern byte* NSpri;
 extern int** SpRefs;
@@ -3298,8 +3313,6 @@ extern int SqMaxY;
 extern int SqDX;
 extern int SqDY;
 
-extern byte* DANGMAP;
-extern word* DCHTIME;
 int RivNX;
 int RivSH;
 extern byte* RivDir;
@@ -3339,10 +3352,6 @@ extern VirtualScreen SVSC;
 void FreeArrays();
 
 int ARRSZ = 0;
-word* MRef = nullptr;//32768 bytes memset
-word* MCash = nullptr;
-int MaxMCash = 0;
-int CurMCash = 0;
 int ACTUAL_ADDSH;
 void CreateFractal();
 int TEXARR[8] = { 0,0,6,6,5,5,4,4 };
@@ -3352,12 +3361,12 @@ void ClearArrays()
 {
 	memset( fmap, 0, LX_fmap*LX_fmap * 2 );
 	memset( fmap1, 0, LX_fmap*LX_fmap * 2 );
+	FD_Reset();
 	memset( RivDir, 0, RivNX*RivNX );
 	memset( RivVol, 0, RivNX*RivNX );
-	memset( MCount, 0, VAL_MAXCIOFS );
-	memset( MRef, 0xFF, VAL_MAXCIOFS * 2 );//32768
-	memset( BLDList, 0, VAL_MAXCIOFS * 2 );
+	CB_Reset();
 	memset( NPresence, 0, VAL_MAXCIOFS );
+	TQ_Clear();
 	memset( NSpri, 0, VAL_SPRSIZE );
 	memset( SpRefs, 0, VAL_SPRSIZE * 4 );
 	memset( WaterDeep, 0, ( VAL_MAPSX*VAL_MAPSX ) >> 2 );
@@ -3367,6 +3376,7 @@ void ClearArrays()
 	{
 		memset( MFIELDS[i].MapV, 0, MAPSY*BMSX );
 	}
+	PF_Reset();
 
 	memset( UnitsField.MapV, 0, MAPSY*BMSX );
 	memset( NObj3, 0, B3SZ * 2 );
@@ -3388,8 +3398,7 @@ void ClearArrays()
 		OTRI.NTRIANG[i] = 0;
 	}
 
-	memset( DANGMAP, 0, DangLx*DangLx );
-	memset( DCHTIME, 0, DangLx*DangLx * 2 );
+	DF_Reset();
 }
 
 void SetFractalTexture()
@@ -3524,26 +3533,19 @@ void SetupArrays()
 
 	VAL_MAXCX = ( 64 << ADDSH );
 
-	MCount = new byte[VAL_MAXCIOFS];
+	MCount = new word[VAL_MAXCIOFS];
 
-	szz = VAL_MAXCIOFS;
-	ARRSZ += szz;
-	memset( MCount, 0, VAL_MAXCIOFS );
-	MRef = new word[VAL_MAXCIOFS];//unsigned short MRef[16384]
-	memset( MRef, 0xFF, VAL_MAXCIOFS * 2 );
 	szz = VAL_MAXCIOFS * 2;
 	ARRSZ += szz;
 	BLDList = new word[VAL_MAXCIOFS];
 	szz = VAL_MAXCIOFS * 2;
 	ARRSZ += szz;
-	memset( BLDList, 0, VAL_MAXCIOFS * 2 );
+	CB_Init( VAL_MAXCX, VAL_SHFCX, MCount, BLDList );
 	NPresence = new byte[VAL_MAXCIOFS];
 	szz = VAL_MAXCIOFS;
 	ARRSZ += szz;
 	memset( NPresence, 0, VAL_MAXCIOFS );
-	TmpMC = new byte[VAL_MAXCIOFS];
-	szz = VAL_MAXCIOFS;
-	ARRSZ += szz;
+	TQ_Init( VAL_MAXCX, VAL_SHFCX );
 
 	WRefs = (WallCell**) calloc( VAL_MAXCIOFS * 4 * 4, 1 );
 	szz = VAL_MAXCIOFS * 4 * 4;
@@ -3568,6 +3570,7 @@ void SetupArrays()
 	for (int i = 0; i < 2; i++)
 	{
 		MFIELDS[i].Allocate();
+		PF_SetField( i, MFIELDS[i].MapV, MAPSX, MAPSY, BMSX );
 	}
 
 	UnitsField.Allocate();
@@ -3629,14 +3632,7 @@ void SetupArrays()
 		OTRI.NTRIANG[i] = 0;
 	}
 
-	DANGMAP = new byte[DangLx*DangLx];
-	szz = DangLx*DangLx;
-	ARRSZ += szz;
-	memset( DANGMAP, 0, DangLx*DangLx );
-	DCHTIME = new word[DangLx*DangLx];
-	szz = DangLx*DangLx * 2;
-	ARRSZ += szz;
-	memset( DCHTIME, 0, DangLx*DangLx * 2 );
+	DF_Init( DangLx, DangSH );
 	Init3DMapSystem();
 	//SetFractalTexture();
 	TEST_GM();
@@ -3657,19 +3653,13 @@ void FreeArrays()
 	MCount = NULL;
 	//free(NMsList);
 	//NMsList=NULL;
-	free( MRef );
-	MRef = NULL;
-	free( MCash );
-	MCash = NULL;
-	MaxMCash = 0;
-	CurMCash = 0;
+	CB_Free();
 
 	free( BLDList );
 	BLDList = NULL;
 	free( NPresence );
 	NPresence = NULL;
-	free( TmpMC );
-	TmpMC = NULL;
+	TQ_Free();
 	free( WRefs );
 	WRefs = NULL;
 	free( NSpri );
@@ -3684,6 +3674,7 @@ void FreeArrays()
 	for (int i = 0; i < 2; i++)
 	{
 		MFIELDS[i].FreeAlloc();
+		PF_SetField( i, nullptr, 0, 0, 0 );
 	}
 
 	UnitsField.FreeAlloc();
@@ -3716,10 +3707,7 @@ void FreeArrays()
 	OTRI.TRIANG = NULL;
 	free( OTRI.NTRIANG );
 	OTRI.NTRIANG = NULL;
-	free( DANGMAP );
-	DANGMAP = NULL;
-	free( DCHTIME );
-	DCHTIME = NULL;
+	DF_Free();
 	GNFO.Clear();
 	MaxSprt = 0;
 	free( NatDeals );
@@ -3730,8 +3718,8 @@ void MotionField::Allocate()
 {
 	//MapH=new byte[MAPSY*BMSX];
 	//memset(MapH,0,MAPSY*BMSX);
-	MapV = new byte[MAPSY*BMSX];
-	memset( MapV, 0, MAPSY*BMSX );
+	//whole 64-bit words, MotionField works on them
+	MapV = (byte*) calloc( MAPSY*BMSX / 8, 8 );
 }
 
 void MotionField::FreeAlloc()
@@ -3761,44 +3749,3 @@ void EnemyInfo::FREE()
 	free( SupMortLastTime );
 	free( GAINF.ArmDistr );
 }
-
-word GetNMSL( int i )
-{
-	int v = i >> 6;// : 64
-
-	if (v < VAL_MAXCIOFS)//BUGFIX: prevent access violation in MRef[v] when v > 128^2
-	{
-		int idx = MRef[v];
-
-		if (idx != 0xFFFF)
-		{
-			return MCash[( idx << 6 ) + ( i & 63 )];
-		}
-	}
-
-	return 0;
-}
-
-void SetNMSL( int i, word W )
-{
-	int v = i >> 6;
-	int idx = MRef[v];
-	if (idx == 0xFFFF)
-	{
-		if (CurMCash >= MaxMCash)
-		{
-			MaxMCash += 512;
-			MCash = (word*) realloc( MCash, MaxMCash << 7 );
-		}
-		idx = CurMCash;
-		CurMCash++;
-		MRef[v] = idx;
-	}
-	MCash[( idx << 6 ) + ( i & 63 )] = W;
-}
-
-void CleanNMSL()
-{
-	CurMCash = 0;
-	memset( MRef, 0xFF, VAL_MAXCIOFS << 1 );
-}
@@ -9,6 +9,9 @@
 div_t __cdecl SecureDivision( int const numerator, int const denominator );
 #define div(x,y) SecureDivision(x,y)
 
+//outside of pack(1), it holds a std::vector
+#include "NewCode/SlabPool.h"
+
 #pragma pack(1)
 
 typedef unsigned short word;
@@ -34,11 +37,6 @@ extern int ADDSH;
 extern int MAXCX;
 #define MAXCY MAXCX
 
-//maximal amount of units in cell
-#define MAXINCELL 64
-
-#define SHFCELL 6
-
 //Size of cell
 #define CELLSIZE 4
 
@@ -1272,8 +1270,6 @@ public:
 	void CreatePath( int x1, int y1 );
 	void CreateSimplePath( int x1, int y1 );
 	bool CreatePrePath( int x1, int y1 );
-	bool CreatePrePath2( int x1, int y1 );
-	bool CreatePrePath4( int x1, int y1 );
 	void ProcessNewMotion();
 	void FreeAsmLink();
 	void Die();
@@ -1722,6 +1718,23 @@ public:
 #define maximage 2048
 
 extern OneObject* Group[ULIMIT];
+
+#include "NewCode/ObjHot.h"
+void CB_Mark( int Index );
+//Writes the hot fields of OB through to the arrays of NewCode/ObjHot.h,
+//call after changing RealX, RealY, Sdoxlo, NNUM or NZalp of an object in Group
+inline void StoreObjHot( OneObject* OB )
+{
+	word i = OB->Index;
+	OH_X[i] = OB->RealX;
+	OH_Y[i] = OB->RealY;
+	OH_Flags[i] = ( OB->NewMonst ? OHF_UNIT : 0 ) | ( OB->NewBuilding ? OHF_BUILDING : 0 ) | ( OB->Sdoxlo ? OHF_DYING : 0 );
+	OH_Nat[i] = OB->NNUM;
+	OH_NZalp[i] = OB->NZalp;
+	OH_MaxZalp[i] = OB->newMons->MaxZalp;
+	CB_Mark( i );
+}
+
 extern RLCTable MImage[maximage];
 extern RLCTable miniMImage[maximage];
 
@@ -1734,15 +1747,12 @@ void LoadLock();
 #define MaxAsmCount 16384
 #define OneAsmSize 256
 #define OneAShift 8;
-#define MaxOrdCount 32768
-#define OneOrdSize 32;
-#define OneOShift 5;
 char* GetAsmBlock();
 void FreeAsmBlock( char* p );
 void InitAsmBuf();
+//Zeroed order from OrdPool, released with OneObject::FreeOrdBlock
 Order1* GetOrdBlock();
-void InitOrdBuf();
-extern Order1 OrdBuf[MaxOrdCount];
+extern SlabPool OrdPool;
 extern bool	AsmUsage[MaxAsmCount];
 extern int	msx;
 extern int msy;
@@ -1939,8 +1949,10 @@ extern int EatenRes;
 #include "UnSyncro.h"
 
 extern word* fmap;
-extern byte* MCount;
+//units in a cell and the list of them, see NewCode/CellBuckets.h
+extern word* MCount;
 extern word* BLDList;
+#include "NewCode/CellBuckets.h"
 extern byte* NPresence;
 
 //------------sorting by nations-------------
@@ -1951,6 +1963,10 @@ void SetupNatList();
 void InitNatList();
 void AddObject( OneObject* OB );
 void DelObject( OneObject* OB );
+//live object index, see NewCode/ObjIndex.h
+void IndexObject( OneObject* OB );
+void UnindexObject( word Index );
+void ReindexObjects();
 void PlayAnimation( NewAnimation* NA, int Frame, int x, int y );
 void MakeOrderSound( OneObject* OB, byte SMask );
 
@@ -2094,9 +2110,6 @@ int AddTHMap( int );
 
 #define SECTMAP(i) (SectMap?SectMap[i]:(word(randoma[word(i&8191)])%3))
 
-word GetNMSL( int i );
-void SetNMSL( int i, word W );
-void CleanNMSL();
 extern int LastActionX;
 extern int LastActionY;
 extern byte NatRefTBL[8];
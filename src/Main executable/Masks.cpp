@@ -21,209 +21,70 @@
 byte ResultMask[MaskLx*256];
 extern byte trans4[65536];
 extern byte trans8[65536];
-void CopyMaskedBitmap64(byte* Bits,int x,int y,void* Mask){
-	__asm{
-		push	esi
-		push	edi
-		pushf
-		mov		esi,Mask
-		mov		edi,Bits
-		xor		ebx,ebx
-		mov		bl,byte ptr x
-		mov		bh,byte ptr y
-		mov		cl,[esi+2]    //Number of strings
-		add		esi,4
-		xor		edx,edx     //ResulMask offset
-rlclop1:
-		mov		ch,[esi]    //number of RLE segments
-		inc		esi
-		or		ch,ch
-		jz		endrlclop
-rllpstrt:
-		mov		ax,[esi]
-		add		bl,al
-		add		dl,al
-lpp1:	and		bx,0011111100111111b
-		mov		al,[edi+ebx]
-		inc		ebx
-		mov		[ResultMask+edx],al
-		inc		edx
-		dec		ah
-		jnz		lpp1
-		add		esi,2
-		dec		ch
-		jnz		rllpstrt
-endrlclop:
-		xor		dl,dl
-		inc		bh
-		inc		dh
-		mov		bl,byte ptr x
-		dec		cl
-		jnz		rlclop1
-		popf
-		pop		edi
-		pop		esi
-	};
-};
-void CopyMaskedTransparentBitmap_8(byte* Bits,int x,int y,void* Mask){
-	byte nstr;
-	__asm{
-		push	esi
-		push	edi
-		pushf
-		mov		esi,Mask
-		mov		edi,Bits
-		xor		ebx,ebx
-		mov		bl,byte ptr x
-		mov		bh,byte ptr y
-		mov		cl,[esi+2]    //Number of strings
-		mov		nstr,cl
-		add		esi,4
-		xor		eax,eax
-		xor		edx,edx     //ResulMask offset
-rlclop1:
-		mov		ch,[esi]    //number of RLE segments
-		inc		esi
-		or		ch,ch
-		jz		endrlclop
-rllpstrt:
-		mov		ax,[esi]
-		add		bl,al
-		add		dl,al
-		mov		cl,ah
-lpp1:	and		bx,0011111100111111b
-		mov		ah,[edi+ebx]
-		mov		al,[ResultMask+edx]
-		mov		al,[trans8+eax]
-		inc		ebx
-		mov		[ResultMask+edx],al
-		inc		edx
-		dec		cl
-		jnz		lpp1
-		add		esi,2
-		dec		ch
-		jnz		rllpstrt
-endrlclop:
-		xor		dl,dl
-		inc		bh
-		inc		dh
-		mov		bl,byte ptr x
-		dec		nstr
-		jnz		rlclop1
-		popf
-		pop		edi
-		pop		esi
-	};
-};
-void CopyMaskedTransparentBitmap_4(byte* Bits,int x,int y,void* Mask){
-	byte nstr;
-	__asm{
-		push	esi
-		push	edi
-		pushf
-		mov		esi,Mask
-		mov		edi,Bits
-		xor		ebx,ebx
-		mov		bl,byte ptr x
-		mov		bh,byte ptr y
-		mov		cl,[esi+2]    //Number of strings
-		mov		nstr,cl
-		add		esi,4
-		xor		eax,eax
-		xor		edx,edx     //ResulMask offset
-rlclop1:
-		mov		ch,[esi]    //number of RLE segments
-		inc		esi
-		or		ch,ch
-		jz		endrlclop
-rllpstrt:
-		mov		ax,[esi]
-		add		bl,al
-		add		dl,al
-		mov		cl,ah
-lpp1:	and		bx,0011111100111111b
-		mov		ah,[edi+ebx]
-		mov		al,[ResultMask+edx]
-		mov		al,[trans4+eax]
-		inc		ebx
-		mov		[ResultMask+edx],al
-		inc		edx
-		dec		cl
-		jnz		lpp1
-		add		esi,2
-		dec		ch
-		jnz		rllpstrt
-endrlclop:
-		xor		dl,dl
-		inc		bh
-		inc		dh
-		mov		bl,byte ptr x
-		dec		nstr
-		jnz		rlclop1
-		popf
-		pop		edi
-		pop		esi
-	};
+//Mask: RLC picture, byte 2 - number of lines, then for every line the number
+//of segments and (space,length) pairs. Every mask pixel takes the texel of
+//the 64x64 bitmap at the same offset from (x,y), wrapping inside the bitmap.
+//Op 0 copies it, 4/8/12 blend it with the pixel of Result through trans4/trans8.
+static void CopyMaskedOp(byte* Result,byte* Bits,int x,int y,void* Mask,int Op){
+	byte* m=(byte*)Mask;
+	byte bx=byte(x);
+	byte by=byte(y);
+	byte nstr=m[2];
+	m+=4;
+	//offset in Result: low byte is the column, next byte the line
+	DWORD ofs=0;
+	do{
+		byte nseg=*m++;
+		for(;nseg;nseg--){
+			bx+=m[0];
+			ofs=(ofs&~0xFF)|byte(ofs+m[0]);
+			byte n=m[1];
+			do{
+				bx&=63;
+				by&=63;
+				byte t=Bits[(by<<8)+bx];
+				byte r=Result[ofs];
+				switch(Op){
+				case 0:
+					r=t;
+					break;
+				case 4:
+					r=trans4[(t<<8)+r];
+					break;
+				case 8:
+					r=trans8[(t<<8)+r];
+					break;
+				case 12:
+					r=trans4[(r<<8)+t];
+					break;
+				};
+				Result[ofs]=r;
+				bx++;
+				ofs++;
+			}while(--n);
+			m+=2;
+		};
+		ofs=(ofs&~0xFFFF)|(((ofs+0x100)&0xFF00));
+		by++;
+		bx=byte(x);
+	}while(--nstr);
 };
-void CopyMaskedTransparentBitmap_12(byte* Bits,int x,int y,void* Mask){
-	byte nstr;
-	__asm{
-		push	esi
-		push	edi
-		pushf
-		mov		esi,Mask
-		mov		edi,Bits
-		xor		ebx,ebx
-		mov		bl,byte ptr x
-		mov		bh,byte ptr y
-		mov		cl,[esi+2]    //Number of strings
-		mov		nstr,cl
-		add		esi,4
-		xor		eax,eax
-		xor		edx,edx     //ResulMask offset
-rlclop1:
-		mov		ch,[esi]    //number of RLE segments
-		inc		esi
-		or		ch,ch
-		jz		endrlclop
-rllpstrt:
-		mov		ax,[esi]
-		add		bl,al
-		add		dl,al
-		mov		cl,ah
-lpp1:	and		bx,0011111100111111b
-		mov		al,[edi+ebx]
-		mov		ah,[ResultMask+edx]
-		mov		al,[trans4+eax]
-		inc		ebx
-		mov		[ResultMask+edx],al
-		inc		edx
-		dec		cl
-		jnz		lpp1
-		add		esi,2
-		dec		ch
-		jnz		rllpstrt
-endrlclop:
-		xor		dl,dl
-		inc		bh
-		inc		dh
-		mov		bl,byte ptr x
-		dec		nstr
-		jnz		rlclop1
-		popf
-		pop		edi
-		pop		esi
-	};
+void CopyMaskedBitmap64(byte* Result,byte* Bits,int x,int y,void* Mask){
+	CopyMaskedOp(Result,Bits,x,y,Mask,0);
 };
 extern RLCTable SimpleMaskA;
 extern RLCTable SimpleMaskB;
 extern RLCTable SimpleMaskC;
 extern RLCTable SimpleMaskD;
-void CopyMaskedBitmap(byte* Bits,int x,int y,int MaskID){
-	CopyMaskedBitmap64(Bits,x,y,   (void*)(SimpleMaskA->OfsTable[MaskID]));
-	CopyMaskedTransparentBitmap_4(Bits,x,y,(void*)(SimpleMaskB->OfsTable[MaskID]));
-	CopyMaskedTransparentBitmap_8(Bits,x,y, (void*)(SimpleMaskC->OfsTable[MaskID]));
-	CopyMaskedTransparentBitmap_12(Bits,x,y, (void*)(SimpleMaskD->OfsTable[MaskID]));
+void CopyMaskedBitmap(byte* Result,byte* Bits,int x,int y,int MaskID){
+	CopyMaskedOp(Result,Bits,x,y,(void*)(SimpleMaskA->OfsTable[MaskID]),0);
+	CopyMaskedOp(Result,Bits,x,y,(void*)(SimpleMaskB->OfsTable[MaskID]),4);
+	CopyMaskedOp(Result,Bits,x,y,(void*)(SimpleMaskC->OfsTable[MaskID]),8);
+	CopyMaskedOp(Result,Bits,x,y,(void*)(SimpleMaskD->OfsTable[MaskID]),12);
+};
+//Width of line i (0..31) of the 64 pixels high triangle: 2,4..32,32..4,2
+static int TriMaskWidth(int i){
+	return i<16 ? 2+i*2 : 32-(i-16)*2;
 };
 //  0
 //	|\
@@ -233,112 +94,14 @@ void CopyMaskedBitmap(byte* Bits,int x,int y,int MaskID){
 //	|  /
 //	|/ 
 //Creates triangle (Type1) with bitmap
-void FastCreateMaskedBitmap64_1(byte* Bits,int x,int y){
-	int tmedi;
-	__asm{
-		push	esi
-		push	edi
-		pushf
-		mov		al,64
-		xor		ebx,ebx
-		mov		bl,byte ptr x
-		mov		bh,byte ptr y
-		and		ebx,0011111100111111b
-		sub		al,bl       //Max x in trapezoid
-		xor		ecx,ecx
-		mov		ah,16//32
-		mov		edi,offset ResultMask
-		mov		dl,2
-		cld
-		mov		tmedi,edi
-StartTrapezoid1:
-		and     ebx,0011111100111111b
-		mov		esi,Bits
-		add		esi,ebx
-		cmp		dl,al
-		ja		RightPart1
-		mov		cl,dl
-		shr		cl,2
-		rep		movsd
-		mov		cl,dl
-		and		cl,3
-		rep     movsb
-		add		tmedi,256
-		mov		edi,tmedi
-		add		dl,2
-		inc		bh
-		dec		ah
-		jnz		StartTrapezoid1
-		jmp		Trap2
-RightPart1:
-		mov		cl,al
-		shr		cl,2
-		rep		movsd
-		mov		cl,al
-		and		cl,3
-		rep		movsb
-		sub		esi,64
-		mov		cl,dl
-		sub		cl,al
-		mov		dh,cl
-		shr		cl,2
-		rep		movsd
-		mov		cl,dh
-		and		cl,3
-		rep		movsb
-		add		dl,2
-		add		tmedi,256
-		mov		edi,tmedi
-		inc		bh
-		dec		ah
-		jnz		StartTrapezoid1
-Trap2:  sub		dl,2
-		mov		ah,16
-DoTrapezoid2:
-		and     ebx,0011111100111111b
-		mov		esi,Bits
-		add		esi,ebx
-		cmp		dl,al
-		ja		RightPart2
-		mov		cl,dl
-		shr		cl,2
-		rep		movsd
-		mov		cl,dl
-		and		cl,3
-		rep     movsb
-		add		tmedi,256
-		mov		edi,tmedi
-		sub		dl,2
-		inc		bh
-		dec		ah
-		jnz		DoTrapezoid2
-		jmp		EndTrapezoid
-RightPart2:
-		mov		cl,al
-		shr		cl,2
-		rep		movsd
-		mov		cl,al
-		and		cl,3
-		rep		movsb
-		sub		esi,64
-		mov		cl,dl
-		sub		cl,al
-		mov		dh,cl
-		shr		cl,2
-		rep		movsd
-		mov		cl,dh
-		and		cl,3
-		rep		movsb
-		sub		dl,2
-		add		tmedi,256
-		mov		edi,tmedi
-		inc		bh
-		dec		ah
-		jnz		DoTrapezoid2
-EndTrapezoid:
-		popf
-		pop		edi
-		pop		esi
+void FastCreateMaskedBitmap64_1(byte* Result,byte* Bits,int x,int y){
+	int bx=x&63;
+	int by=y&63;
+	for(int i=0;i<32;i++){
+		int w=TriMaskWidth(i);
+		byte* src=Bits+(((by+i)&63)<<8);
+		byte* dst=Result+(i<<8);
+		for(int k=0;k<w;k++)dst[k]=src[(bx+k)&63];
 	};
 };
 //      /|
@@ -347,164 +110,14 @@ EndTrapezoid:
 //  \    |
 //    \  |
 //      \|
-void FastCreateMaskedBitmap64_2(byte* Bits,int x,int y){
-	int tmedi;
-	__asm{
-		push	esi
-		push	edi
-		pushf
-		xor		ebx,ebx
-		mov		bl,byte ptr x
-		mov		bh,byte ptr y
-		add		bl,32//64
-		sub		bh,16//31
-		and		ebx,0011111100111111b
-		mov		al,bl       //Max x in trapezoid
-		xor		ecx,ecx
-		mov		ah,16//32
-		mov		edi,offset ResultMask
-		add		edi,32//64
-		mov		dl,2
-		std
-		mov		tmedi,edi
-StartTrapezoid1:
-		and     ebx,0011111100111111b
-		mov		esi,Bits
-		add		esi,ebx
-		cmp		dl,al
-		ja		RightPart1
-		mov		cl,dl
-		dec		esi
-		dec		edi
-		cmp		cl,4
-		jb		uue1
-		shr		cl,2
-		sub		esi,3
-		sub		edi,3
-		rep		movsd
-		add		esi,3
-		add		edi,3
-uue1:
-		mov		cl,dl
-		and		cl,3
-		rep     movsb
-		add		tmedi,256
-		mov		edi,tmedi
-		inc		bh
-		add		dl,2
-		dec		ah
-		jnz		StartTrapezoid1
-		jmp		Trap2
-RightPart1:
-		mov		cl,al
-		dec		esi
-		dec		edi
-		cmp		cl,4
-		jb		uu3
-		sub		esi,3
-		sub		edi,3
-		shr		cl,2
-		rep		movsd
-		add		esi,3
-		add		edi,3
-uu3:
-		mov		cl,al
-		and		cl,3
-		rep		movsb
-		add		esi,64
-		mov		cl,dl
-		sub		cl,al
-		mov		dh,cl
-		cmp		cl,4
-		jb		uu31
-		shr		cl,2
-		sub		esi,3
-		sub		edi,3
-		rep		movsd
-		add		esi,3
-		add		edi,3
-uu31:
-		mov		cl,dh
-		and		cl,3
-		rep		movsb
-		add		dl,2
-		add		tmedi,256
-		mov		edi,tmedi
-		inc		bh
-		dec		ah
-		jnz		StartTrapezoid1
-Trap2:	sub		dl,2
-		mov		ah,16
-DoTrapezoid2:
-		and     ebx,0011111100111111b
-		mov		esi,Bits
-		add		esi,ebx
-		cmp		dl,al
-		ja		RightPart2
-		mov		cl,dl
-		dec		esi
-		dec		edi
-		cmp		cl,4
-		jb		uue1x
-		shr		cl,2
-		sub		esi,3
-		sub		edi,3
-		rep		movsd
-		add		esi,3
-		add		edi,3
-uue1x:
-		mov		cl,dl
-		and		cl,3
-		rep     movsb
-		add		tmedi,256
-		mov		edi,tmedi
-		inc		bh
-		sub		dl,2
-		dec		ah
-		jnz		DoTrapezoid2
-		jmp		EndTrapezoid
-RightPart2:
-		mov		cl,al
-		dec		esi
-		dec		edi
-		cmp		cl,4
-		jb		uu3x
-		sub		esi,3
-		sub		edi,3
-		shr		cl,2
-		rep		movsd
-		add		esi,3
-		add		edi,3
-uu3x:
-		mov		cl,al
-		and		cl,3
-		rep		movsb
-		add		esi,64
-		mov		cl,dl
-		sub		cl,al
-		mov		dh,cl
-		cmp		cl,4
-		jb		uu31x
-		shr		cl,2
-		sub		esi,3
-		sub		edi,3
-		rep		movsd
-		add		esi,3
-		add		edi,3
-uu31x:
-		mov		cl,dh
-		and		cl,3
-		rep		movsb
-		sub		dl,2
-		add		tmedi,256
-		mov		edi,tmedi
-		inc		bh
-		dec		ah
-		jnz		DoTrapezoid2
-EndTrapezoid:
-		popf
-		pop		edi
-		pop		esi
+void FastCreateMaskedBitmap64_2(byte* Result,byte* Bits,int x,int y){
+	int bx=(x+32)&63;
+	int by=(y-16)&63;
+	for(int i=0;i<32;i++){
+		int w=TriMaskWidth(i);
+		byte* src=Bits+(((by+i)&63)<<8);
+		byte* dst=Result+(i<<8)+32-w;
+		for(int k=0;k<w;k++)dst[k]=src[(bx-w+k)&63];
 	};
 };
 int GetBmOfst(int i){
@@ -695,63 +308,63 @@ void PrepareIntersection2(int bm1,int bm2,int bm3,
 void PrepareIntersection1(int bm1,int bm2,int bm3,
 						  int x0,int y0,
 						  int s1,int s2,int s3,
-						  RLCTable Masks,byte* BitmapsArray){
+						  RLCTable Masks,byte* BitmapsArray,byte* Result){
 	if(bm1==bm2){
 		if(bm3<bm2){
 			//1,2 over 3 - inverse mask
-			FastCreateMaskedBitmap64_1(BitmapsArray+GetBmOfst(bm1),x0,y0);
-			CopyMaskedBitmap(BitmapsArray+GetBmOfst(bm3),x0,y0,27+(2-s2)*3+s3);
+			FastCreateMaskedBitmap64_1(Result,BitmapsArray+GetBmOfst(bm1),x0,y0);
+			CopyMaskedBitmap(Result,BitmapsArray+GetBmOfst(bm3),x0,y0,27+(2-s2)*3+s3);
 			return;
 		}else{
 			//3 over 1,2 - normal mask
-			FastCreateMaskedBitmap64_1(BitmapsArray+GetBmOfst(bm1),x0,y0);
-			CopyMaskedBitmap(BitmapsArray+GetBmOfst(bm3),x0,y0,18+(2-s2)*3+s3);
+			FastCreateMaskedBitmap64_1(Result,BitmapsArray+GetBmOfst(bm1),x0,y0);
+			CopyMaskedBitmap(Result,BitmapsArray+GetBmOfst(bm3),x0,y0,18+(2-s2)*3+s3);
 			return;
 		};
 	};
 	if(bm2==bm3){
 		if(bm1<bm3){
 			//2,3 over 1 - inverse mask
-			FastCreateMaskedBitmap64_1(BitmapsArray+GetBmOfst(bm3),x0,y0);
-			CopyMaskedBitmap(BitmapsArray+GetBmOfst(bm1),x0,y0,45+(2-s3)*3+s1);
+			FastCreateMaskedBitmap64_1(Result,BitmapsArray+GetBmOfst(bm3),x0,y0);
+			CopyMaskedBitmap(Result,BitmapsArray+GetBmOfst(bm1),x0,y0,45+(2-s3)*3+s1);
 			return;
 		}else{
 			//1 over 2,3 - normal mask
-			FastCreateMaskedBitmap64_1(BitmapsArray+GetBmOfst(bm3),x0,y0);
-			CopyMaskedBitmap(BitmapsArray+GetBmOfst(bm1),x0,y0,36+(2-s3)*3+s1);
+			FastCreateMaskedBitmap64_1(Result,BitmapsArray+GetBmOfst(bm3),x0,y0);
+			CopyMaskedBitmap(Result,BitmapsArray+GetBmOfst(bm1),x0,y0,36+(2-s3)*3+s1);
 			return;
 		};
 	};
 	if(bm1==bm3){
 		if(bm2<bm3){
 			//1,3 over 2 - inverse mask
-			FastCreateMaskedBitmap64_1(BitmapsArray+GetBmOfst(bm3),x0,y0);
-			CopyMaskedBitmap(BitmapsArray+GetBmOfst(bm2),x0,y0,9+(2-s1)*3+s2);
+			FastCreateMaskedBitmap64_1(Result,BitmapsArray+GetBmOfst(bm3),x0,y0);
+			CopyMaskedBitmap(Result,BitmapsArray+GetBmOfst(bm2),x0,y0,9+(2-s1)*3+s2);
 			return;
 		}else{
 			//2 over 1,3 - normal mask
-			FastCreateMaskedBitmap64_1(BitmapsArray+GetBmOfst(bm3),x0,y0);
-			CopyMaskedBitmap(BitmapsArray+GetBmOfst(bm2),x0,y0,(2-s1)*3+s2);
+			FastCreateMaskedBitmap64_1(Result,BitmapsArray+GetBmOfst(bm3),x0,y0);
+			CopyMaskedBitmap(Result,BitmapsArray+GetBmOfst(bm2),x0,y0,(2-s1)*3+s2);
 			return;
 		};
 	};
 	//Triple intersections
 	if(bm1<bm2&&bm1<bm3){
-		FastCreateMaskedBitmap64_1(BitmapsArray+GetBmOfst(bm1),x0,y0);
-		CopyMaskedBitmap64(BitmapsArray+GetBmOfst(bm2),x0,y0,
+		FastCreateMaskedBitmap64_1(Result,BitmapsArray+GetBmOfst(bm1),x0,y0);
+		CopyMaskedBitmap64(Result,BitmapsArray+GetBmOfst(bm2),x0,y0,
 				(void*)(Masks->OfsTable[(2-s1)*3+s2]));
-		CopyMaskedBitmap(BitmapsArray+GetBmOfst(bm3),x0,y0,18+(2-s2)*3+s3);
+		CopyMaskedBitmap(Result,BitmapsArray+GetBmOfst(bm3),x0,y0,18+(2-s2)*3+s3);
 		return;
 	};
 	if(bm2<bm1&&bm2<bm3){
-		FastCreateMaskedBitmap64_1(BitmapsArray+GetBmOfst(bm2),x0,y0);
-		CopyMaskedBitmap(BitmapsArray+GetBmOfst(bm1),x0,y0,36+(2-s3)*3+s1);
-		CopyMaskedBitmap(BitmapsArray+GetBmOfst(bm3),x0,y0,18+(2-s2)*3+s3);
+		FastCreateMaskedBitmap64_1(Result,BitmapsArray+GetBmOfst(bm2),x0,y0);
+		CopyMaskedBitmap(Result,BitmapsArray+GetBmOfst(bm1),x0,y0,36+(2-s3)*3+s1);
+		CopyMaskedBitmap(Result,BitmapsArray+GetBmOfst(bm3),x0,y0,18+(2-s2)*3+s3);
 		return;
 	};
-	FastCreateMaskedBitmap64_1(BitmapsArray+GetBmOfst(bm3),x0,y0);
-	CopyMaskedBitmap(BitmapsArray+GetBmOfst(bm1),x0,y0,36+(2-s3)*3+s1);
-	CopyMaskedBitmap(BitmapsArray+GetBmOfst(bm2),x0,y0,(2-s1)*3+s2);
+	FastCreateMaskedBitmap64_1(Result,BitmapsArray+GetBmOfst(bm3),x0,y0);
+	CopyMaskedBitmap(Result,BitmapsArray+GetBmOfst(bm1),x0,y0,36+(2-s3)*3+s1);
+	CopyMaskedBitmap(Result,BitmapsArray+GetBmOfst(bm2),x0,y0,(2-s1)*3+s2);
 };
 //
 //                1
@@ -765,63 +378,63 @@ void PrepareIntersection1(int bm1,int bm2,int bm3,
 void PrepareIntersection2(int bm1,int bm2,int bm3,
 						  int x0,int y01,
 						  int s1,int s2,int s3,
-						  RLCTable Masks,byte* BitmapsArray){
+						  RLCTable Masks,byte* BitmapsArray,byte* Result){
 	int y0=y01-31;
 	if(bm1==bm2){
 		if(bm3<bm2){
 			//1,2 over 3 - inverse mask
-			FastCreateMaskedBitmap64_2(BitmapsArray+GetBmOfst(bm1),x0,y01);
-			CopyMaskedBitmap(BitmapsArray+GetBmOfst(bm3),x0,y0,54+27+(2-s2)*3+s3);
+			FastCreateMaskedBitmap64_2(Result,BitmapsArray+GetBmOfst(bm1),x0,y01);
+			CopyMaskedBitmap(Result,BitmapsArray+GetBmOfst(bm3),x0,y0,54+27+(2-s2)*3+s3);
 			return;
 		}else{
 			//3 over 1,2 - normal mask
-			FastCreateMaskedBitmap64_2(BitmapsArray+GetBmOfst(bm1),x0,y01);
-			CopyMaskedBitmap(BitmapsArray+GetBmOfst(bm3),x0,y0,54+18+(2-s2)*3+s3);
+			FastCreateMaskedBitmap64_2(Result,BitmapsArray+GetBmOfst(bm1),x0,y01);
+			CopyMaskedBitmap(Result,BitmapsArray+GetBmOfst(bm3),x0,y0,54+18+(2-s2)*3+s3);
 			return;
 		};
 	};
 	if(bm2==bm3){
 		if(bm1<bm3){
 			//2,3 over 1 - inverse mask
-			FastCreateMaskedBitmap64_2(BitmapsArray+GetBmOfst(bm3),x0,y01);
-			CopyMaskedBitmap(BitmapsArray+GetBmOfst(bm1),x0,y0,54+45+(2-s3)*3+s1);
+			FastCreateMaskedBitmap64_2(Result,BitmapsArray+GetBmOfst(bm3),x0,y01);
+			CopyMaskedBitmap(Result,BitmapsArray+GetBmOfst(bm1),x0,y0,54+45+(2-s3)*3+s1);
 			return;
 		}else{
 			//1 over 2,3 - normal mask
-			FastCreateMaskedBitmap64_2(BitmapsArray+GetBmOfst(bm3),x0,y01);
-			CopyMaskedBitmap(BitmapsArray+GetBmOfst(bm1),x0,y0,54+36+(2-s3)*3+s1);
+			FastCreateMaskedBitmap64_2(Result,BitmapsArray+GetBmOfst(bm3),x0,y01);
+			CopyMaskedBitmap(Result,BitmapsArray+GetBmOfst(bm1),x0,y0,54+36+(2-s3)*3+s1);
 			return;
 		};
 	};
 	if(bm1==bm3){
 		if(bm2<bm3){
 			//1,3 over 2 - inverse mask
-			FastCreateMaskedBitmap64_2(BitmapsArray+GetBmOfst(bm3),x0,y01);
-			CopyMaskedBitmap(BitmapsArray+GetBmOfst(bm2),x0,y0,54+9+(2-s1)*3+s2);
+			FastCreateMaskedBitmap64_2(Result,BitmapsArray+GetBmOfst(bm3),x0,y01);
+			CopyMaskedBitmap(Result,BitmapsArray+GetBmOfst(bm2),x0,y0,54+9+(2-s1)*3+s2);
 			return;
 		}else{
 			//2 over 1,3 - normal mask
-			FastCreateMaskedBitmap64_2(BitmapsArray+GetBmOfst(bm3),x0,y01);
-			CopyMaskedBitmap(BitmapsArray+GetBmOfst(bm2),x0,y0,54+(2-s1)*3+s2);
+			FastCreateMaskedBitmap64_2(Result,BitmapsArray+GetBmOfst(bm3),x0,y01);
+			CopyMaskedBitmap(Result,BitmapsArray+GetBmOfst(bm2),x0,y0,54+(2-s1)*3+s2);
 			return;
 		};
 	};
 	//Triple intersections
 	if(bm1<bm2&&bm1<bm3){
-		FastCreateMaskedBitmap64_2(BitmapsArray+GetBmOfst(bm1),x0,y01);
-		CopyMaskedBitmap(BitmapsArray+GetBmOfst(bm2),x0,y0,54+(2-s1)*3+s2);
-		CopyMaskedBitmap(BitmapsArray+GetBmOfst(bm3),x0,y0,54+18+(2-s2)*3+s3);
+		FastCreateMaskedBitmap64_2(Result,BitmapsArray+GetBmOfst(bm1),x0,y01);
+		CopyMaskedBitmap(Result,BitmapsArray+GetBmOfst(bm2),x0,y0,54+(2-s1)*3+s2);
+		CopyMaskedBitmap(Result,BitmapsArray+GetBmOfst(bm3),x0,y0,54+18+(2-s2)*3+s3);
 		return;
 	};
 	if(bm2<bm1&&bm2<bm3){
-		FastCreateMaskedBitmap64_2(BitmapsArray+GetBmOfst(bm2),x0,y01);
-		CopyMaskedBitmap(BitmapsArray+GetBmOfst(bm1),x0,y0,54+36+(2-s3)*3+s1);
-		CopyMaskedBitmap(BitmapsArray+GetBmOfst(bm3),x0,y0,54+18+(2-s2)*3+s3);
+		FastCreateMaskedBitmap64_2(Result,BitmapsArray+GetBmOfst(bm2),x0,y01);
+		CopyMaskedBitmap(Result,BitmapsArray+GetBmOfst(bm1),x0,y0,54+36+(2-s3)*3+s1);
+		CopyMaskedBitmap(Result,BitmapsArray+GetBmOfst(bm3),x0,y0,54+18+(2-s2)*3+s3);
 		return;
 	};
-	FastCreateMaskedBitmap64_2(BitmapsArray+GetBmOfst(bm3),x0,y01);
-	CopyMaskedBitmap(BitmapsArray+GetBmOfst(bm1),x0,y0,54+36+(2-s3)*3+s1);
-	CopyMaskedBitmap(BitmapsArray+GetBmOfst(bm2),x0,y0,54+(2-s1)*3+s2);	
+	FastCreateMaskedBitmap64_2(Result,BitmapsArray+GetBmOfst(bm3),x0,y01);
+	CopyMaskedBitmap(Result,BitmapsArray+GetBmOfst(bm1),x0,y0,54+36+(2-s3)*3+s1);
+	CopyMaskedBitmap(Result,BitmapsArray+GetBmOfst(bm2),x0,y0,54+(2-s1)*3+s2);	
 };
 void ClearIntersectionBuffer(){
 	memset(ResultMask,0,sizeof ResultMask);
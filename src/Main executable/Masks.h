@@ -14,10 +14,11 @@ extern byte ResultMask[MaskLx*256];
 // s1 (0..2) - section of 1-2 
 // s2 (0..2) - section of 2-3 
 // s3 (0..2) - section of 3-1 
+// Result - 64x64 mask buffer with 256 bytes per line (ResultMask)
 void PrepareIntersection1(int bm1,int bm2,int bm3,
 						  int x0,int y0,
 						  int s1,int s2,int s3,
-						  RLCTable Masks,byte* BitmapsArray);
+						  RLCTable Masks,byte* BitmapsArray,byte* Result);
 //
 //                1
 //         s1   /|
@@ -30,6 +31,6 @@ void PrepareIntersection1(int bm1,int bm2,int bm3,
 void PrepareIntersection2(int bm1,int bm2,int bm3,
 						  int x0,int y01,
 						  int s1,int s2,int s3,
-						  RLCTable Masks,byte* BitmapsArray);
+						  RLCTable Masks,byte* BitmapsArray,byte* Result);
 void ShowIntersectionBuffer();
 int GetBmOfst(int i);
\ No newline at end of file
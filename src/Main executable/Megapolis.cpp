@@ -28,6 +28,7 @@
 #include "Sort.h"
 #include "ConstStr.h"
 #include "EinfoClass.h"
+#include "NewCode/ObjIndex.h"
 #include <crtdbg.h>
 
 extern const int kImportantMessageDisplayTime;
@@ -910,7 +911,7 @@ void City::EnumUnits()
 	for ( int i = 0; i < 4; i++ )
 		Nat->NArtUnits[i] = 0;
 
-	for ( int i = 0; i < MAXOBJECT; i++ )
+	for ( int i = OI_Next( 0, OIL_ALL, NI ); i < MAXOBJECT; i = OI_Next( i + 1, OIL_ALL, NI ) )
 	{
 		OB = Group[i];
 		if ( OB&&OB->NNUM == NI && ( OB->Hidden || !OB->Sdoxlo ) )
@@ -1005,6 +1006,7 @@ void City::EnumUnits()
 					OB->NMask = 1 << 7;
 					OB->Ref.General = NATIONS[7].Mon[OB->NIndex];
 					OB->Nat = NATIONS + 7;
+					IndexObject( OB );
 					break;
 				}
 
@@ -1035,7 +1037,7 @@ void City::EnumUnits()
 	if ( NBUILDERS < NEEDBLD )
 	{
 		int np = NEEDBLD - NBUILDERS;
-		for ( int i = 0; i < MAXOBJECT&&np; i++ )
+		for ( int i = OI_Next( 0, OIL_ALL, NI ); i < MAXOBJECT&&np; i = OI_Next( i + 1, OIL_ALL, NI ) )
 		{
 			OB = Group[i];
 			if ( OB&&OB->NIndex == PID&&OB->NNUM == NI && !( OB->Sdoxlo || OB->NoBuilder || OB->DoWalls ) )
@@ -1445,7 +1447,7 @@ void RepairControl( City* CT )
 {
 	byte NI = CT->NI;
 	word PS;
-	for ( int i = 0; i < MAXOBJECT; i++ )
+	for ( int i = OI_Next( 0 ); i < MAXOBJECT; i = OI_Next( i + 1 ) )
 	{
 		OneObject* OB = Group[i];
 		if ( OB&&OB->capBuilding && ( !OB->delay ) && OB->Stage == OB->NStages )
@@ -1548,7 +1550,7 @@ bool City::FindApproximateBuildingPlace( GeneralObject* GO )
 	case PortID:
 		NPORTS = 0;
 		{
-			for ( int k = 0; k < MAXOBJECT&&NPORTS < 32; k++ )
+			for ( int k = OI_Next( 0 ); k < MAXOBJECT&&NPORTS < 32; k = OI_Next( k + 1 ) )
 			{
 				OneObject* OB = Group[k];
 				if ( OB && ( !OB->Sdoxlo ) && ( OB->Ref.General == GO ) )
@@ -1567,7 +1569,7 @@ bool City::FindApproximateBuildingPlace( GeneralObject* GO )
 		int eyc = 0;
 		int ne = 0;
 		NPORTS = 0;
-		for ( int k = 0; k < MAXOBJECT&&NPORTS < 32; k++ )
+		for ( int k = OI_Next( 0 ); k < MAXOBJECT&&NPORTS < 32; k = OI_Next( k + 1 ) )
 		{
 			OneObject* OB = Group[k];
 			if ( OB && ( !OB->Sdoxlo ) )
@@ -1655,13 +1657,13 @@ int SearchPeasants( int x, int y, bool Workers, byte NI, word* AddTo, int maxpos
 	int pos = 0;
 	int NMon = MCount[cell];
 	if ( !NMon )return NULL;
-	int ofs1 = cell << SHFCELL;
+	word* CUnits = CB_CellUnits( cell );
 	word MID;
 	int BRID = 0x5432;
 	if ( !Workers )BRID = NATIONS[NI].CITY->Builders.ID;
 	for ( int i = 0; i < NMon; i++ )
 	{
-		MID = GetNMSL( ofs1 + i );
+		MID = CUnits[i];
 		if ( MID != 0xFFFF )
 		{
 			OneObject* OB = Group[MID];
@@ -1867,7 +1869,7 @@ void City::HandleConstructions()
 						{
 							//checking if someone wants to build this building
 							int nw = 0;
-							for ( int i = 0; i < MAXOBJECT; i++ )
+							for ( int i = OI_Next( 0, OIL_ALL, NI ); i < MAXOBJECT; i = OI_Next( i + 1, OIL_ALL, NI ) )
 							{
 								OneObject* POB = Group[i];
 								if ( POB&&POB->NNUM == NI&&POB->newMons->Peasant )
@@ -2932,7 +2934,7 @@ OneObject* DetermineMineBySprite( int Spr )
 	OneSprite* OS = &Sprites[Spr];
 	if ( OS->Enabled )
 	{
-		for ( int i = 0; i < MAXOBJECT; i++ )
+		for ( int i = OI_Next( 0 ); i < MAXOBJECT; i = OI_Next( i + 1 ) )
 		{
 			OneObject* OB = Group[i];
 			if ( OB&&OB->newMons->ProdType )
@@ -5382,11 +5384,11 @@ void Army_Bitva::AddEnemXY( int x, int y, int MyTop, byte msk )
 	{
 		int NMon = MCount[cell];
 		if ( !NMon )return;
-		int ofs1 = cell << SHFCELL;
+		word* CUnits = CB_CellUnits( cell );
 		word MID;
 		for ( int i = 0; i < NMon; i++ )
 		{
-			MID = GetNMSL( ofs1 + i );
+			MID = CUnits[i];
 			if ( MID != 0xFFFF )
 			{
 				OneObject* OB = Group[MID];
@@ -5738,13 +5740,13 @@ int FindStrongestUnitInCell( int cell, int* MinStrength, byte NAT )
 	int strength = *MinStrength;
 	int NMon = MCount[cell];
 	if ( !NMon )return 0xFFFF;
-	int ofs1 = cell << SHFCELL;
+	word* CUnits = CB_CellUnits( cell );
 	word MID;
 	word BestMID = 0xFFFF;
 	int N = 0;
 	for ( int i = 0; i < NMon; i++ )
 	{
-		MID = GetNMSL( ofs1 + i );
+		MID = CUnits[i];
 		if ( MID != 0xFFFF )
 		{
 			OneObject* OB = Group[MID];
@@ -5867,7 +5869,7 @@ void A_DiversiaLink( AI_Army* ARM )
 				int NZero = 0;
 				byte mask = 1 << ARM->NI;
 				word* EnMids = NatList[0];
-				for ( int MID = 0; MID < MAXOBJECT; MID++ )
+				for ( int MID = OI_Next( 0 ); MID < MAXOBJECT; MID = OI_Next( MID + 1 ) )
 				{
 					//word MID=EnMids[i];
 					OneObject* OB = Group[MID];
@@ -7041,7 +7043,7 @@ int GetBestVictimForArchers( byte NI, int x, int y, int R, int MyTop )
 	int y0 = ( y - 1024 ) << 4;
 	byte Mask = 1 << NI;
 
-	for ( int i = 0; i < MAXOBJECT; i++ )
+	for ( int i = OI_Next( 0 ); i < MAXOBJECT; i = OI_Next( i + 1 ) )
 	{
 		OneObject*OB = Group[i];
 		if ( OB&&OB->RealX > minx&&OB->RealX<maxx&&OB->RealY>miny&&OB->RealY < maxy && !OB->Sdoxlo )
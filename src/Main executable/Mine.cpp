@@ -158,6 +158,7 @@ GGG1:
 						OB->NNUM = OBJ->NNUM;
 						OB->Nat->CITY->RegisterNewUnit( OB );
 						AddObject( OB );
+						IndexObject( OB );
 						if (OB->NewBuilding)
 							OBJ->Stage = ( oldst*int( OBJ->Ref.General->MoreCharacter->ProduceStages ) ) / oldmax;
 						goto GGG1;
@@ -319,6 +320,7 @@ void OneObject::HideMe()
 {
 	Hidden = true;
 	Sdoxlo = 1;
+	StoreObjHot( this );
 	ClearOrders();
 	DeleteFromSelection( this );
 	DestX = -1;
@@ -336,6 +338,7 @@ void OneObject::ShowMe()
 {
 	Hidden = false;
 	Sdoxlo = 0;
+	StoreObjHot( this );
 }
 
 void PushUnitOutOfMine( int i )
@@ -1066,6 +1069,7 @@ void TakeResourceFromSpriteLink( OneObject* OBJ )
 						OB->CloseObject();
 						OBJ->NInside--;
 						DelObject( OB );
+						UnindexObject( OB->Index );
 						Group[OB->Index] = nullptr;
 					}
 				}
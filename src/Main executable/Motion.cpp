@@ -216,6 +216,7 @@ void MoveObject(OneObject* OB){
 	int vy=OB->RealVy;
 	OB->RealX+=vx;
 	OB->RealY+=vy;
+	StoreObjHot(OB);
 	//if(vx||vy)OB->StandTime=0;
 	//else OB->StandTime++;
 	NewMonster* NM=OB->newMons;
@@ -234,10 +235,10 @@ void EraseLodkiInCell(int cell,int x,int y,int Lx,int Ly){
 	cell+=VAL_MAXCX+1;
     int NMon=MCount[cell];
 	if(!NMon)return;
-	int ofs1=cell<<SHFCELL;
+	word* CUnits=CB_CellUnits(cell);
 	word MID;
 	for(int i=0;i<NMon;i++){
-		MID=GetNMSL(ofs1+i);
+		MID=CUnits[i];
 		if(MID!=0xFFFF){
 			OneObject* OB=Group[MID];
 			if(OB&&OB->newMons->Usage==FisherID){
@@ -260,10 +261,10 @@ int GetShipDangerInCell(int cell,int x,int y){
 	cell+=VAL_MAXCX+1;
     int NMon=MCount[cell];
 	if(!NMon)return 0;
-	int ofs1=cell<<SHFCELL;
+	word* CUnits=CB_CellUnits(cell);
 	word MID;
 	for(int i=0;i<NMon;i++){
-		MID=GetNMSL(ofs1+i);
+		MID=CUnits[i];
 		if(MID!=0xFFFF){
 			OneObject* OB=Group[MID];
 			if(OB&&OB->LockType&&OB->newMons->Usage!=FisherID){
@@ -354,12 +355,12 @@ bool RemoveShipsInCell(int cell,int x,int y,int Lx,OneObject* MyObj){
 	int my1=y+Lx-1;
     int NMon=MCount[cell];
 	if(!NMon)return false;
-	int ofs1=cell<<SHFCELL;
+	word* CUnits=CB_CellUnits(cell);
 	word MID;
 	int cx=(x<<1)+Lx;
 	int cy=(y<<1)+Lx;
 	for(int i=0;i<NMon;i++){
-		MID=GetNMSL(ofs1+i);
+		MID=CUnits[i];
 		if(MID!=0xFFFF){
 			OneObject* OB=Group[MID];
 			if(OB&&(!OB->Sdoxlo)&&OB->Index!=MyMid&&OB->LockType&&!(OB->Transport&&OB->DstX>0)){
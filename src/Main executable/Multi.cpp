@@ -24,6 +24,7 @@
 #include "Graphs.h"
 #include "Fonts.h"
 #include "DrawForm.h"
+#include "NewCode/TargetQuery.h"
 
 #pragma pack(1)
 #include "IR.h"
@@ -2770,9 +2771,11 @@ void EraseSelected( byte NI )
 				if ( OB )
 				{
 					OB->Sdoxlo = 2500;
+					StoreObjHot( OB );
 					if ( OB->NewBuilding )
 					{
 						EliminateBuilding( OB );
+						UnindexObject( MID );
 						Group[MID] = nullptr;
 					};
 				};
@@ -5212,6 +5215,7 @@ void ExecuteBuffer()
 	InitEBuf();
 
 	memset( NPresence, 0, VAL_MAXCX*VAL_MAXCX );
+	TQ_Clear();
 
 	int ofs;
 	for ( int i = 0; i < MAXOBJECT; i++ )
@@ -5223,6 +5227,7 @@ void ExecuteBuffer()
 			if ( ofs >= 0 && ofs < VAL_MAXCIOFS )
 			{
 				NPresence[ofs] |= OB->NMask;
+				TQ_Occupy( ofs, OB->NMask );
 			}
 		}
 	}
@@ -31,6 +31,7 @@
 #include "StrategyResearch.h"
 #include "Safety.h"
 #include "EinfoClass.h"
+#include "NewCode/ObjIndex.h"
 
 extern const int kSystemMessageDisplayTime;
 
@@ -186,7 +187,7 @@ void PrepareProcessing()
 {
 	NAsk = 0;
 	//Only for DEBUGGIONG 
-	for (int i = 0; i < MAXOBJECT; i++)
+	for (int i = OI_Next( 0 ); i < MAXOBJECT; i = OI_Next( i + 1 ))
 	{
 		OneObject* OB = Group[i];
 		if (OB)
@@ -306,19 +307,6 @@ inline void cmDone()
 
 typedef byte xxx[64];
 
-void COrd( Order1* ordr )
-{
-	if (!int( ordr ))
-	{
-		return;
-	}
-
-	if (( int( ordr ) - int( OrdBuf ) ) / sizeof Order1 >= MaxOrdCount)
-	{
-		int RRRR = ( int( ordr ) - int( OrdBuf ) ) / sizeof Order1;
-	}
-}
-
 void SendToLink( OneObject* OBJ );
 
 //Атаковать point
@@ -607,9 +595,10 @@ void ProcessDeathList()
 			if (OB && OB->Serial == DeathSN[i])
 			{
 				OB->Sdoxlo = 3333;
+				StoreObjHot( OB );
 			}
 		}
-		for (int i = 0; i < MAXOBJECT; i++)
+		for (int i = OI_Next( 0 ); i < MAXOBJECT; i = OI_Next( i + 1 ))
 		{
 			OneObject* OB = Group[i];
 			if (OB && OB->Ready)
@@ -627,6 +616,7 @@ void ProcessDeathList()
 			if (OB && OB->Serial == DeathSN[i])
 			{
 				OB->Sdoxlo = 0;
+				StoreObjHot( OB );
 			}
 		}
 	}
@@ -742,10 +732,12 @@ void OneObject::Die()
 				{
 					OB->Hidden = 0;
 					OB->Sdoxlo = 0;
+					StoreObjHot( OB );
 					OB->Die();
 					if (Group[MID])
 					{
 						OB->Sdoxlo = 5000;
+						StoreObjHot( OB );
 					}
 				}
 			}
@@ -764,7 +756,7 @@ void OneObject::Die()
 	if (Hidden)
 	{
 		int idx = Index;
-		for (int i = 0; i < MAXOBJECT; i++)
+		for (int i = OI_Next( 0 ); i < MAXOBJECT; i = OI_Next( i + 1 ))
 		{
 			OneObject* OB = Group[i];
 			if (OB && OB->NInside)
@@ -856,6 +848,7 @@ void OneObject::Die()
 						WCL->Visible = false;
 						WCL->ClearLocking();
 						DelObject( OB );
+						UnindexObject( OB->Index );
 						Group[OB->Index] = nullptr;
 						NewMonster* NM = OB->newMons;
 						if (NM->NBars)
@@ -921,11 +914,13 @@ void OneObject::Die()
 			{
 				DestructBuilding( this );
 				DelObject( this );
+				UnindexObject( Index );
 				Group[Index] = nullptr;
 			}
 			else
 			{
 				Sdoxlo = true;
+				StoreObjHot( this );
 				LoLayer = &NM->DeathLie2;
 				NewAnm = nullptr;
 			}
@@ -936,11 +931,13 @@ void OneObject::Die()
 			{
 				DestructBuilding( this );
 				DelObject( this );
+				UnindexObject( Index );
 				Group[Index] = nullptr;
 			}
 			else
 			{
 				Sdoxlo = true;
+				StoreObjHot( this );
 				LoLayer = &NM->DeathLie1;
 				NewAnm = nullptr;
 			}
@@ -978,6 +975,7 @@ DESTRUCTING:
 	if (Hidden)
 	{
 		Sdoxlo = 5000;
+		StoreObjHot( this );
 		Hidden = false;
 	}
 	else
@@ -985,6 +983,7 @@ DESTRUCTING:
 		if (!Sdoxlo)
 		{
 			Sdoxlo = 1;
+			StoreObjHot( this );
 		}
 	}
 
@@ -996,7 +995,7 @@ void HealWalls()
 {
 	if (( tmtmt % 128 ) == 3)
 	{
-		for (int i = 0; i < MAXOBJECT; i++)
+		for (int i = OI_Next( 0 ); i < MAXOBJECT; i = OI_Next( i + 1 ))
 		{
 			OneObject* OB = Group[i];
 			if (OB && OB->Wall)
@@ -1012,6 +1011,7 @@ void HealWalls()
 						{
 							Delete3DBar( OB->Index );
 						}
+						UnindexObject( OB->Index );
 						Group[OB->Index] = nullptr;
 					}
 				}
@@ -1240,7 +1240,7 @@ void WinnerControl( bool Anyway )
 	{
 		NMyUnits = 0;
 		NThemUnits = 0;
-		for (int i = 0; i < MAXOBJECT; i++)
+		for (int i = OI_Next( 0 ); i < MAXOBJECT; i = OI_Next( i + 1 ))
 		{
 			OneObject* OB = Group[i];
 			if (OB && UnLockN[OB->NNUM] && OB->NNUM != 7 && !( OB->Sdoxlo && !OB->Hidden ))
@@ -1712,7 +1712,7 @@ void Nation::AddUpgrade( word ID, int time )
 void EnumPopulation()
 {
 	int NMN[8] = { 0,0,0,0,0,0,0,0 };
-	for (int i = 0; i < MAXOBJECT; i++)
+	for (int i = OI_Next( 0 ); i < MAXOBJECT; i = OI_Next( i + 1 ))
 	{
 		OneObject* OB = Group[i];
 		if (OB && ( OB->Hidden || !OB->Sdoxlo ) && ( !OB->NewBuilding ))
@@ -16,6 +16,8 @@
 #include "MapSprites.h"
 #include <assert.h>
 #include "GP_Draw.h"
+#include "NewCode/ObjIndex.h"
+#include "Danger.h"
 int mul3( int );
 
 void GetRect( OneObject* ZZ, int* x, int* y, int* Lx, int* Ly );
@@ -335,3 +337,55 @@ void DelObject( OneObject* OB )
 		}
 	}
 }
+
+//-----------------------------------Live object index-----------------------------
+//Call after creating an object and after its nation changes
+void IndexObject( OneObject* OB )
+{
+	int Kinds = 0;
+	if (OB->NewBuilding)
+	{
+		Kinds |= OIK_BUILDING;
+		if (OB->newMons->Usage == TowerID)
+		{
+			Kinds |= OIK_TOWER;
+		}
+	}
+	else
+	{
+		if (OB->NewMonst)
+		{
+			Kinds |= OIK_UNIT;
+			if (OB->LockType == 1)
+			{
+				Kinds |= OIK_SHIP;
+			}
+		}
+	}
+	OI_Add( OB->Index, OB->NNUM, Kinds );
+	StoreObjHot( OB );
+	AddDangerObject( OB->Index );
+}
+
+//Call when Group[Index] is cleared
+void UnindexObject( word Index )
+{
+	OI_Del( Index );
+	CB_Mark( Index );
+	DelDangerObject( Index );
+}
+
+//Builds the index from Group, after loading or clearing the objects
+void ReindexObjects()
+{
+	OI_Clear();
+	InitDANGER();
+	for (int i = 0; i < ULIMIT; i++)
+	{
+		if (Group[i])
+		{
+			IndexObject( Group[i] );
+		}
+	}
+	CB_Reset();
+}
@@ -0,0 +1,1112 @@
+#include "../cross_platform/platform_compat.h"
+#include "AreaGraph.h"
+#include "JobPool.h"
+#include <string.h>
+#include <vector>
+#include <queue>
+#include <functional>
+#include <chrono>
+
+#define AG_INF 0x7FFFFFFF
+#define AG_CLOSED 0xFFFF
+
+typedef unsigned long long AG_Key;
+
+struct AG_Table
+{
+	int To;
+	DWORD Used;
+	//ways of the portals, by the index of the portal
+	std::vector<int> PDist;
+	std::vector<word> PNext;
+	//Next and Dist are filled for the clusters with Done set
+	std::vector<byte> Done;
+	std::vector<word> Next;
+	std::vector<word> Dist;
+};
+
+struct AG_Layer
+{
+	int N;
+	//links leaving an area and links entering it
+	std::vector<int> OutStart;
+	std::vector<word> OutTo;
+	std::vector<word> OutLen;
+	std::vector<int> InStart;
+	std::vector<word> InFrom;
+	std::vector<word> InLen;
+	//cluster of an area and the index of the area in it
+	std::vector<int> Clu;
+	std::vector<int> Loc;
+	//areas and portals of a cluster
+	std::vector<int> MemStart;
+	std::vector<word> Mem;
+	std::vector<int> PorStart;
+	std::vector<word> Por;
+	//index of a portal in Por, -1 for other areas
+	std::vector<int> PIdx;
+	//ways inside the cluster toward a portal, Tab[i] is the offset of the
+	//table of portal i, the table is indexed by Loc
+	std::vector<int> Tab;
+	std::vector<int> IDist;
+	std::vector<word> INext;
+	//edges of the portal graph entering portal i: EFrom can go to the
+	//portal through ENext with a way of ELen
+	std::vector<int> EStart;
+	std::vector<word> EFrom;
+	std::vector<int> ELen;
+	std::vector<word> ENext;
+	AG_Table Cache[AG_NCACHE];
+	DWORD Clock;
+	AG_Stats Stats;
+};
+
+static AG_Layer Layers[AG_NLAYERS];
+
+//Dijkstra state, D and Via are valid for the areas with Seen==Gen
+struct AG_Search
+{
+	std::vector<int> D;
+	std::vector<word> Via;
+	std::vector<DWORD> Seen;
+	DWORD Gen = 0;
+	//way length<<16|area, ties go to the lower area
+	std::priority_queue<AG_Key, std::vector<AG_Key>, std::greater<AG_Key> > Heap;
+
+	void New( int N )
+	{
+		if (int( Seen.size() ) < N)
+		{
+			D.resize( N );
+			Via.resize( N );
+			Seen.resize( N, 0 );
+		}
+		Gen++;
+		while (!Heap.empty())
+		{
+			Heap.pop();
+		}
+	}
+
+	int GetD( int a )
+	{
+		return Seen[a] == Gen ? D[a] : AG_INF;
+	}
+
+	void Update( int a, int d, word Next )
+	{
+		if (d < GetD( a ))
+		{
+			Seen[a] = Gen;
+			D[a] = d;
+			Via[a] = Next;
+			Heap.push( ( AG_Key( d ) << 16 ) | AG_Key( a ) );
+		}
+	}
+};
+
+//search of the tables, the rows of AG_Matrix have one per thread
+static AG_Search Work;
+//ways inside the cluster of the target
+static std::vector<int> LD;
+static std::vector<word> LN;
+
+//Ways from the areas of the cluster of T to T that do not leave the cluster
+static void LocalWays( AG_Layer& G, int T, int* Dist, word* Next )
+{
+	int c = G.Clu[T];
+	int M = G.MemStart[c + 1] - G.MemStart[c];
+	for (int i = 0; i < M; i++)
+	{
+		Dist[i] = AG_INF;
+		Next[i] = AG_NONE;
+	}
+	Work.New( G.N );
+	Dist[G.Loc[T]] = 0;
+	Work.Heap.push( AG_Key( T ) );
+	while (!Work.Heap.empty())
+	{
+		AG_Key K = Work.Heap.top();
+		Work.Heap.pop();
+		int u = int( K & 0xFFFF );
+		int d = int( K >> 16 );
+		if (d > Dist[G.Loc[u]])
+		{
+			continue;
+		}
+		for (int k = G.InStart[u]; k < G.InStart[u + 1]; k++)
+		{
+			int v = G.InFrom[k];
+			if (G.InLen[k] == AG_CLOSED || G.Clu[v] != c)
+			{
+				continue;
+			}
+			int nd = d + G.InLen[k];
+			int lv = G.Loc[v];
+			if (nd < Dist[lv])
+			{
+				Dist[lv] = nd;
+				Next[lv] = word( u );
+				Work.Heap.push( ( AG_Key( nd ) << 16 ) | AG_Key( v ) );
+			}
+		}
+	}
+}
+
+void AG_Free( int Layer )
+{
+	AG_Layer& G = Layers[Layer];
+	G.N = 0;
+	G.OutStart.clear();
+	G.OutTo.clear();
+	G.OutLen.clear();
+	G.InStart.clear();
+	G.InFrom.clear();
+	G.InLen.clear();
+	G.Clu.clear();
+	G.Loc.clear();
+	G.MemStart.clear();
+	G.Mem.clear();
+	G.PorStart.clear();
+	G.Por.clear();
+	G.PIdx.clear();
+	G.Tab.clear();
+	G.IDist.clear();
+	G.INext.clear();
+	G.EStart.clear();
+	G.EFrom.clear();
+	G.ELen.clear();
+	G.ENext.clear();
+	for (int i = 0; i < AG_NCACHE; i++)
+	{
+		AG_Table& R = G.Cache[i];
+		R.To = -1;
+		R.Used = 0;
+		R.PDist.clear();
+		R.PNext.clear();
+		R.Done.clear();
+		R.Next.clear();
+		R.Dist.clear();
+	}
+	G.Clock = 0;
+	memset( &G.Stats, 0, sizeof G.Stats );
+}
+
+//Sorts the areas into NC buckets by Key, Start[b]..Start[b+1] is bucket b
+static void Bucket( const std::vector<int>& Key, int NC, const std::vector<byte>* Only, std::vector<int>& Start, std::vector<word>& List )
+{
+	int N = int( Key.size() );
+	Start.assign( NC + 1, 0 );
+	for (int i = 0; i < N; i++)
+	{
+		if (!Only || ( *Only )[i])
+		{
+			Start[Key[i] + 1]++;
+		}
+	}
+	for (int c = 0; c < NC; c++)
+	{
+		Start[c + 1] += Start[c];
+	}
+	List.resize( Start[NC] );
+	std::vector<int> Pos( Start.begin(), Start.end() - 1 );
+	for (int i = 0; i < N; i++)
+	{
+		if (!Only || ( *Only )[i])
+		{
+			List[Pos[Key[i]]++] = word( i );
+		}
+	}
+}
+
+//Edges of the portal graph entering every portal: the links from the
+//other clusters and the ways inside the cluster that pass no other portal
+static void MakeEdges( AG_Layer& G )
+{
+	int NP = int( G.Por.size() );
+	G.EStart.assign( NP + 1, 0 );
+	for (int i = 0; i < NP; i++)
+	{
+		int u = G.Por[i];
+		int cu = G.Clu[u];
+		for (int k = G.InStart[u]; k < G.InStart[u + 1]; k++)
+		{
+			int v = G.InFrom[k];
+			if (G.InLen[k] != AG_CLOSED && G.Clu[v] != cu)
+			{
+				G.EFrom.push_back( word( G.PIdx[v] ) );
+				G.ELen.push_back( G.InLen[k] );
+				G.ENext.push_back( word( u ) );
+			}
+		}
+		const int* ID = &G.IDist[G.Tab[i]];
+		const word* IN = &G.INext[G.Tab[i]];
+		for (int k = G.PorStart[cu]; k < G.PorStart[cu + 1]; k++)
+		{
+			int v = G.Por[k];
+			if (v == u || ID[G.Loc[v]] == AG_INF)
+			{
+				continue;
+			}
+			//a way through portal w is made of the edges v-w and w-u
+			bool Direct = true;
+			for (int w = IN[G.Loc[v]]; w != u; w = IN[G.Loc[w]])
+			{
+				if (G.PIdx[w] >= 0)
+				{
+					Direct = false;
+					break;
+				}
+			}
+			if (Direct)
+			{
+				G.EFrom.push_back( word( k ) );
+				G.ELen.push_back( ID[G.Loc[v]] );
+				G.ENext.push_back( IN[G.Loc[v]] );
+			}
+		}
+		G.EStart[i + 1] = int( G.EFrom.size() );
+	}
+}
+
+void AG_Build( int Layer, int N, AG_Area Info )
+{
+	AG_Free( Layer );
+	if (N <= 0 || N >= AG_NONE)
+	{
+		return;
+	}
+	AG_Layer& G = Layers[Layer];
+	G.N = N;
+	std::vector<int> X( N );
+	std::vector<int> Y( N );
+	G.OutStart.assign( N + 1, 0 );
+	for (int i = 0; i < N; i++)
+	{
+		const word* Link = nullptr;
+		int NL = Info( i, &X[i], &Y[i], &Link );
+		for (int k = 0; k < NL; k++)
+		{
+			if (Link[k + k] < N && Link[k + k] != i)
+			{
+				G.OutTo.push_back( Link[k + k] );
+				G.OutLen.push_back( Link[k + k + 1] );
+			}
+		}
+		G.OutStart[i + 1] = int( G.OutTo.size() );
+	}
+	//links entering an area, in the order of the areas they come from
+	G.InStart.assign( N + 1, 0 );
+	for (size_t k = 0; k < G.OutTo.size(); k++)
+	{
+		G.InStart[G.OutTo[k] + 1]++;
+	}
+	for (int i = 0; i < N; i++)
+	{
+		G.InStart[i + 1] += G.InStart[i];
+	}
+	G.InFrom.resize( G.OutTo.size() );
+	G.InLen.resize( G.OutTo.size() );
+	std::vector<int> Pos( G.InStart.begin(), G.InStart.end() - 1 );
+	for (int i = 0; i < N; i++)
+	{
+		for (int k = G.OutStart[i]; k < G.OutStart[i + 1]; k++)
+		{
+			int p = Pos[G.OutTo[k]]++;
+			G.InFrom[p] = word( i );
+			G.InLen[p] = G.OutLen[k];
+		}
+	}
+	//square clusters of a power of two side, AG_CLUSTER areas on average
+	int x0 = X[0];
+	int y0 = Y[0];
+	int x1 = X[0];
+	int y1 = Y[0];
+	for (int i = 1; i < N; i++)
+	{
+		x0 = X[i] < x0 ? X[i] : x0;
+		y0 = Y[i] < y0 ? Y[i] : y0;
+		x1 = X[i] > x1 ? X[i] : x1;
+		y1 = Y[i] > y1 ? Y[i] : y1;
+	}
+	long long Want = (long long) ( x1 - x0 + 1 ) * ( y1 - y0 + 1 ) * AG_CLUSTER / N;
+	int s = 0;
+	while (( 1LL << ( s + s ) ) < Want)
+	{
+		s++;
+	}
+	int CW = ( ( x1 - x0 ) >> s ) + 1;
+	int NC = CW * ( ( ( y1 - y0 ) >> s ) + 1 );
+	G.Clu.resize( N );
+	for (int i = 0; i < N; i++)
+	{
+		G.Clu[i] = ( ( X[i] - x0 ) >> s ) + ( ( Y[i] - y0 ) >> s ) * CW;
+	}
+	Bucket( G.Clu, NC, nullptr, G.MemStart, G.Mem );
+	G.Loc.resize( N );
+	int MaxM = 0;
+	for (int c = 0; c < NC; c++)
+	{
+		for (int k = G.MemStart[c]; k < G.MemStart[c + 1]; k++)
+		{
+			G.Loc[G.Mem[k]] = k - G.MemStart[c];
+		}
+		if (G.MemStart[c + 1] - G.MemStart[c] > MaxM)
+		{
+			MaxM = G.MemStart[c + 1] - G.MemStart[c];
+		}
+	}
+	if (int( LD.size() ) < MaxM)
+	{
+		LD.resize( MaxM );
+		LN.resize( MaxM );
+	}
+	//portals: areas with an open link to or from another cluster
+	std::vector<byte> IsPor( N, 0 );
+	for (int i = 0; i < N; i++)
+	{
+		for (int k = G.OutStart[i]; k < G.OutStart[i + 1]; k++)
+		{
+			if (G.OutLen[k] != AG_CLOSED && G.Clu[G.OutTo[k]] != G.Clu[i])
+			{
+				IsPor[i] = 1;
+				IsPor[G.OutTo[k]] = 1;
+			}
+		}
+	}
+	Bucket( G.Clu, NC, &IsPor, G.PorStart, G.Por );
+	int NP = int( G.Por.size() );
+	G.PIdx.assign( N, -1 );
+	G.Tab.resize( NP );
+	int Size = 0;
+	for (int i = 0; i < NP; i++)
+	{
+		int p = G.Por[i];
+		G.PIdx[p] = i;
+		G.Tab[i] = Size;
+		Size += G.MemStart[G.Clu[p] + 1] - G.MemStart[G.Clu[p]];
+	}
+	G.IDist.resize( Size );
+	G.INext.resize( Size );
+	for (int i = 0; i < NP; i++)
+	{
+		LocalWays( G, G.Por[i], &G.IDist[G.Tab[i]], &G.INext[G.Tab[i]] );
+	}
+	MakeEdges( G );
+	G.Stats.Areas = N;
+	G.Stats.Clusters = NC;
+	G.Stats.Portals = NP;
+}
+
+int AG_GetN( int Layer )
+{
+	return Layers[Layer].N;
+}
+
+//Ways of the portals toward R.To, Dijkstra over the portal graph starting
+//from the portals of the cluster of the target
+static void MakeTable( AG_Layer& G, AG_Table& R )
+{
+	int T = R.To;
+	int NP = int( G.Por.size() );
+	int NC = int( G.MemStart.size() ) - 1;
+	R.PDist.assign( NP, AG_INF );
+	R.PNext.assign( NP, AG_NONE );
+	R.Done.assign( NC, 0 );
+	R.Next.resize( G.N );
+	R.Dist.resize( G.N );
+	int c = G.Clu[T];
+	LocalWays( G, T, &LD[0], &LN[0] );
+	Work.New( NP );
+	for (int k = G.PorStart[c]; k < G.PorStart[c + 1]; k++)
+	{
+		int l = G.Loc[G.Por[k]];
+		if (LD[l] != AG_INF)
+		{
+			Work.Update( k, LD[l], LN[l] );
+		}
+	}
+	while (!Work.Heap.empty())
+	{
+		AG_Key K = Work.Heap.top();
+		Work.Heap.pop();
+		int u = int( K & 0xFFFF );
+		int d = int( K >> 16 );
+		if (d > Work.D[u])
+		{
+			continue;
+		}
+		for (int e = G.EStart[u]; e < G.EStart[u + 1]; e++)
+		{
+			Work.Update( G.EFrom[e], d + G.ELen[e], G.ENext[e] );
+		}
+	}
+	for (int i = 0; i < NP; i++)
+	{
+		if (Work.Seen[i] == Work.Gen)
+		{
+			R.PDist[i] = Work.D[i];
+			R.PNext[i] = Work.Via[i];
+		}
+	}
+}
+
+//Ways of the areas of cluster k: a portal has its own, the other areas go
+//to the best portal of the cluster or stay inside the cluster of the target
+static void FillCluster( AG_Layer& G, AG_Table& R, int k )
+{
+	int T = R.To;
+	bool Own = G.Clu[T] == k;
+	if (Own)
+	{
+		LocalWays( G, T, &LD[0], &LN[0] );
+	}
+	for (int m = G.MemStart[k]; m < G.MemStart[k + 1]; m++)
+	{
+		int a = G.Mem[m];
+		int la = m - G.MemStart[k];
+		int Best = AG_INF;
+		word Next = AG_NONE;
+		if (a != T && G.PIdx[a] >= 0)
+		{
+			Best = R.PDist[G.PIdx[a]];
+			Next = R.PNext[G.PIdx[a]];
+		}
+		else if (a != T)
+		{
+			if (Own && LD[la] != AG_INF)
+			{
+				Best = LD[la];
+				Next = LN[la];
+			}
+			for (int q = G.PorStart[k]; q < G.PorStart[k + 1]; q++)
+			{
+				int dp = R.PDist[q];
+				int l = G.IDist[G.Tab[q] + la];
+				if (dp != AG_INF && l != AG_INF && dp + l < Best)
+				{
+					Best = dp + l;
+					Next = G.INext[G.Tab[q] + la];
+				}
+			}
+		}
+		if (Best != AG_INF)
+		{
+			R.Dist[a] = word( Best < 0xFFFE ? Best : 0xFFFE );
+			R.Next[a] = Next;
+		}
+		else
+		{
+			R.Dist[a] = AG_NONE;
+			R.Next[a] = AG_NONE;
+		}
+	}
+	R.Done[k] = 1;
+}
+
+//Table toward To with the cluster of From filled
+static AG_Table* GetTable( AG_Layer& G, int From, int To )
+{
+	AG_Table* R = nullptr;
+	AG_Table* Old = G.Cache;
+	for (int i = 0; i < AG_NCACHE && !R; i++)
+	{
+		AG_Table* C = G.Cache + i;
+		if (C->To == To)
+		{
+			R = C;
+			G.Stats.Hits++;
+		}
+		else if (C->Used < Old->Used)
+		{
+			Old = C;
+		}
+	}
+	if (!R)
+	{
+		R = Old;
+		R->To = To;
+		MakeTable( G, *R );
+		G.Stats.Tables++;
+	}
+	R->Used = ++G.Clock;
+	if (!R->Done[G.Clu[From]])
+	{
+		FillCluster( G, *R, G.Clu[From] );
+	}
+	return R;
+}
+
+word AG_Next( int Layer, int From, int To )
+{
+	AG_Layer& G = Layers[Layer];
+	if (From == To || From < 0 || To < 0 || From >= G.N || To >= G.N)
+	{
+		return AG_NONE;
+	}
+	return GetTable( G, From, To )->Next[From];
+}
+
+word AG_Dist( int Layer, int From, int To )
+{
+	AG_Layer& G = Layers[Layer];
+	if (From == To || From < 0 || To < 0 || From >= G.N || To >= G.N)
+	{
+		return AG_NONE;
+	}
+	return GetTable( G, From, To )->Dist[From];
+}
+
+//Plain Dijkstra over the areas from From, Via is the first step of the way
+static void RowWays( AG_Layer& G, AG_Search& S, int From, word* Next, word* Dist )
+{
+	for (int i = 0; i < G.N; i++)
+	{
+		Next[i] = AG_NONE;
+		Dist[i] = AG_NONE;
+	}
+	if (From < 0 || From >= G.N)
+	{
+		return;
+	}
+	S.New( G.N );
+	S.Update( From, 0, AG_NONE );
+	while (!S.Heap.empty())
+	{
+		AG_Key K = S.Heap.top();
+		S.Heap.pop();
+		int u = int( K & 0xFFFF );
+		int d = int( K >> 16 );
+		if (d > S.D[u])
+		{
+			continue;
+		}
+		for (int k = G.OutStart[u]; k < G.OutStart[u + 1]; k++)
+		{
+			if (G.OutLen[k] != AG_CLOSED)
+			{
+				int v = G.OutTo[k];
+				S.Update( v, d + G.OutLen[k], u == From ? word( v ) : S.Via[u] );
+			}
+		}
+	}
+	for (int i = 0; i < G.N; i++)
+	{
+		if (i != From && S.GetD( i ) != AG_INF)
+		{
+			Next[i] = S.Via[i];
+			Dist[i] = word( S.D[i] < 0xFFFE ? S.D[i] : 0xFFFE );
+		}
+	}
+}
+
+void AG_Row( int Layer, int From, word* Next, word* Dist )
+{
+	RowWays( Layers[Layer], Work, From, Next, Dist );
+}
+
+struct AG_MatrixJob
+{
+	AG_Layer* G;
+	word* Next;
+	word* Dist;
+
+	void operator()( int From )
+	{
+		static thread_local AG_Search S;
+		size_t Ofs = size_t( From ) * G->N;
+		RowWays( *G, S, From, Next + Ofs, Dist + Ofs );
+	}
+};
+
+void AG_Matrix( int Layer, word* Next, word* Dist )
+{
+	AG_Layer& G = Layers[Layer];
+	auto T0 = std::chrono::steady_clock::now();
+	AG_MatrixJob Job = { &G, Next, Dist };
+	JOBS.ParallelFor( G.N, Job );
+	auto T1 = std::chrono::steady_clock::now();
+	G.Stats.MatrixTime = std::chrono::duration<double, std::milli>( T1 - T0 ).count();
+	G.Stats.MatrixThreads = JOBS.GetNThreads();
+}
+
+//A link that got longer or shorter: Len is the old length of a longer
+//link and the new length of a shorter one
+struct AG_Change
+{
+	word From;
+	word To;
+	word Len;
+};
+
+//Length of the shortest open link i->j in Len[Start..End), AG_INF if none
+static int LinkLen( const word* To, const word* Len, int Start, int End, int j )
+{
+	int L = AG_INF;
+	for (int k = Start; k < End; k++)
+	{
+		if (To[k] == j && Len[k] != AG_CLOSED && Len[k] < L)
+		{
+			L = Len[k];
+		}
+	}
+	return L;
+}
+
+//State of a row of AG_Repair. The areas with Seen==Gen in S have a new
+//length in D and a new next area in Via.
+struct AG_RepairWork
+{
+	AG_Search S;
+	//areas that may have lost their way, Lost[a]==Stamp
+	std::vector<DWORD> Lost;
+	std::vector<DWORD> Queued;
+	DWORD Stamp = 0;
+	std::vector<word> LostList;
+	std::vector<word> Touch;
+	std::priority_queue<AG_Key, std::vector<AG_Key>, std::greater<AG_Key> > Heap;
+	std::vector<word> RNext;
+	std::vector<word> RDist;
+	//the row
+	int From;
+	word* Next;
+	word* Dist;
+	//a length of the row is clamped to 0xFFFE
+	bool Clamped;
+};
+
+struct AG_RepairJob
+{
+	AG_Layer* G;
+	word* Next;
+	word* Dist;
+	const std::vector<AG_Change>* Up;
+	const std::vector<AG_Change>* Down;
+	//a link of length 0 before or after the change
+	bool Zero;
+	int* Count;
+
+	//length of the way from the source of the row, -1 if it is clamped
+	static int Get( const word* Row, int From, int a )
+	{
+		return a == From ? 0 : Row[a] == AG_NONE ? AG_INF : Row[a] == 0xFFFE ? -1 : Row[a];
+	}
+
+	//The ways RowWays() picks depend only on the shortest lengths and the
+	//links that lie on shortest ways. While no longer link was on one and
+	//no shorter link makes a way as short, both stay and so does the row.
+	bool Touched( const word* Row, int From )
+	{
+		for (const AG_Change& c : *Up)
+		{
+			int du = Get( Row, From, c.From );
+			int dv = Get( Row, From, c.To );
+			if (du != AG_INF && ( du < 0 || dv < 0 || du + c.Len == dv ))
+			{
+				return true;
+			}
+		}
+		for (const AG_Change& c : *Down)
+		{
+			int du = Get( Row, From, c.From );
+			int dv = Get( Row, From, c.To );
+			if (du != AG_INF && ( du < 0 || dv < 0 || du + c.Len <= dv ))
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	static int OldD( AG_RepairWork& W, int a )
+	{
+		int d = Get( W.Dist, W.From, a );
+		if (d < 0)
+		{
+			W.Clamped = true;
+			return 0xFFFE;
+		}
+		return d;
+	}
+
+	static int CurD( AG_RepairWork& W, int a )
+	{
+		return W.S.Seen[a] == W.S.Gen ? W.S.D[a] : OldD( W, a );
+	}
+
+	static word CurVia( AG_RepairWork& W, int a )
+	{
+		return W.S.Seen[a] == W.S.Gen ? W.S.Via[a] : W.Next[a];
+	}
+
+	static void Set( AG_RepairWork& W, int a, int d, word Via )
+	{
+		if (W.S.Seen[a] != W.S.Gen)
+		{
+			W.S.Seen[a] = W.S.Gen;
+			W.Touch.push_back( word( a ) );
+		}
+		W.S.D[a] = d;
+		W.S.Via[a] = Via;
+	}
+
+	static void Push( AG_RepairWork& W, int a, int d )
+	{
+		if (W.Queued[a] != W.Stamp)
+		{
+			W.Queued[a] = W.Stamp;
+			W.Heap.push( ( AG_Key( d ) << 16 ) | AG_Key( a ) );
+		}
+	}
+
+	//Areas whose length may grow: the ones left without a link on a
+	//shortest way from an area that keeps its length, in the order of the
+	//old lengths. Links are longer than 0, so that order is the one of the
+	//shortest ways.
+	void FindLost( AG_RepairWork& W )
+	{
+		W.Stamp++;
+		W.LostList.clear();
+		for (const AG_Change& c : *Up)
+		{
+			int du = OldD( W, c.From );
+			if (du != AG_INF && du + c.Len == OldD( W, c.To ))
+			{
+				Push( W, c.To, du + c.Len );
+			}
+		}
+		while (!W.Heap.empty())
+		{
+			AG_Key K = W.Heap.top();
+			W.Heap.pop();
+			int a = int( K & 0xFFFF );
+			int da = int( K >> 16 );
+			if (a == W.From)
+			{
+				continue;
+			}
+			bool Kept = false;
+			for (int k = G->InStart[a]; k < G->InStart[a + 1] && !Kept; k++)
+			{
+				int u = G->InFrom[k];
+				int du = W.Lost[u] == W.Stamp ? AG_INF : OldD( W, u );
+				Kept = G->InLen[k] != AG_CLOSED && du != AG_INF && du + G->InLen[k] <= da;
+			}
+			if (!Kept)
+			{
+				W.Lost[a] = W.Stamp;
+				W.LostList.push_back( word( a ) );
+				for (int k = G->OutStart[a]; k < G->OutStart[a + 1]; k++)
+				{
+					int x = G->OutTo[k];
+					int dx = OldD( W, x );
+					if (dx != AG_INF && dx > da)
+					{
+						Push( W, x, dx );
+					}
+				}
+			}
+		}
+	}
+
+	//New lengths: the lost areas start from the areas around them that
+	//keep theirs, the shorter links are offered, and the shorter ways are
+	//spread over the whole graph
+	void FindLengths( AG_RepairWork& W )
+	{
+		AG_Search& S = W.S;
+		for (word a : W.LostList)
+		{
+			Set( W, a, AG_INF, W.Next[a] );
+		}
+		for (word a : W.LostList)
+		{
+			for (int k = G->InStart[a]; k < G->InStart[a + 1]; k++)
+			{
+				int u = G->InFrom[k];
+				int du = W.Lost[u] == W.Stamp ? AG_INF : OldD( W, u );
+				if (G->InLen[k] != AG_CLOSED && du != AG_INF && du + G->InLen[k] < S.D[a])
+				{
+					S.D[a] = du + G->InLen[k];
+				}
+			}
+			if (S.D[a] != AG_INF)
+			{
+				S.Heap.push( ( AG_Key( S.D[a] ) << 16 ) | AG_Key( a ) );
+			}
+		}
+		for (const AG_Change& c : *Down)
+		{
+			int du = CurD( W, c.From );
+			if (c.To != W.From && du != AG_INF && du + c.Len < CurD( W, c.To ))
+			{
+				Set( W, c.To, du + c.Len, CurVia( W, c.To ) );
+				S.Heap.push( ( AG_Key( du + c.Len ) << 16 ) | AG_Key( c.To ) );
+			}
+		}
+		while (!S.Heap.empty())
+		{
+			AG_Key K = S.Heap.top();
+			S.Heap.pop();
+			int u = int( K & 0xFFFF );
+			int d = int( K >> 16 );
+			if (d > S.D[u])
+			{
+				continue;
+			}
+			for (int k = G->OutStart[u]; k < G->OutStart[u + 1]; k++)
+			{
+				int v = G->OutTo[k];
+				if (G->OutLen[k] != AG_CLOSED && v != W.From && d + G->OutLen[k] < CurD( W, v ))
+				{
+					Set( W, v, d + G->OutLen[k], CurVia( W, v ) );
+					S.Heap.push( ( AG_Key( d + G->OutLen[k] ) << 16 ) | AG_Key( v ) );
+				}
+			}
+		}
+	}
+
+	//New next areas. With links longer than 0 RowWays() reaches an area
+	//through the area of its shortest way taken first, the one of the
+	//shortest length and then the lowest index. That choice can change
+	//for the areas with a new length, the ones after them and the ends of
+	//the changed links, and a new next area passes on along the ways.
+	void FindNext( AG_RepairWork& W )
+	{
+		W.Stamp++;
+		size_t NT = W.Touch.size();
+		for (size_t i = 0; i < NT; i++)
+		{
+			int a = W.Touch[i];
+			if (W.S.D[a] == OldD( W, a ))
+			{
+				continue;
+			}
+			Push( W, a, W.S.D[a] );
+			for (int k = G->OutStart[a]; k < G->OutStart[a + 1]; k++)
+			{
+				Push( W, G->OutTo[k], CurD( W, G->OutTo[k] ) );
+			}
+		}
+		for (const AG_Change& c : *Up)
+		{
+			Push( W, c.To, CurD( W, c.To ) );
+		}
+		for (const AG_Change& c : *Down)
+		{
+			Push( W, c.To, CurD( W, c.To ) );
+		}
+		while (!W.Heap.empty())
+		{
+			AG_Key K = W.Heap.top();
+			W.Heap.pop();
+			int v = int( K & 0xFFFF );
+			int dv = int( K >> 16 );
+			if (v == W.From)
+			{
+				continue;
+			}
+			int Best = -1;
+			int BestD = AG_INF;
+			if (dv != AG_INF)
+			{
+				for (int k = G->InStart[v]; k < G->InStart[v + 1]; k++)
+				{
+					int u = G->InFrom[k];
+					int du = CurD( W, u );
+					if (G->InLen[k] != AG_CLOSED && du != AG_INF && du + G->InLen[k] == dv && ( du < BestD || ( du == BestD && u < Best ) ))
+					{
+						Best = u;
+						BestD = du;
+					}
+				}
+			}
+			word Via = Best < 0 ? AG_NONE : Best == W.From ? word( v ) : CurVia( W, Best );
+			if (Via != CurVia( W, v ))
+			{
+				Set( W, v, dv, Via );
+				for (int k = G->OutStart[v]; k < G->OutStart[v + 1]; k++)
+				{
+					int w = G->OutTo[k];
+					int dw = CurD( W, w );
+					if (G->OutLen[k] != AG_CLOSED && dv != AG_INF && dv + G->OutLen[k] == dw)
+					{
+						Push( W, w, dw );
+					}
+				}
+			}
+		}
+	}
+
+	void operator()( int From )
+	{
+		static thread_local AG_RepairWork W;
+		int N = G->N;
+		size_t Ofs = size_t( From ) * N;
+		Count[From] = 0;
+		if (!Touched( Dist + Ofs, From ))
+		{
+			return;
+		}
+		if (int( W.Lost.size() ) < N)
+		{
+			W.Lost.resize( N, 0 );
+			W.Queued.resize( N, 0 );
+			W.RNext.resize( N );
+			W.RDist.resize( N );
+		}
+		W.From = From;
+		W.Next = Next + Ofs;
+		W.Dist = Dist + Ofs;
+		W.Clamped = false;
+		W.Touch.clear();
+		W.S.New( N );
+		if (!Zero)
+		{
+			FindLost( W );
+			FindLengths( W );
+			FindNext( W );
+		}
+		if (Zero || W.Clamped)
+		{
+			//the order of the ways is not the one of the lengths, or the
+			//lengths are not known: the row is made again
+			RowWays( *G, W.S, From, &W.RNext[0], &W.RDist[0] );
+			for (int i = 0; i < N; i++)
+			{
+				if (W.Next[i] != W.RNext[i] || W.Dist[i] != W.RDist[i])
+				{
+					W.Next[i] = W.RNext[i];
+					W.Dist[i] = W.RDist[i];
+					Count[From]++;
+				}
+			}
+			return;
+		}
+		for (word a : W.Touch)
+		{
+			int d = W.S.D[a];
+			word nd = word( d == AG_INF ? AG_NONE : d < 0xFFFE ? d : 0xFFFE );
+			word nn = d == AG_INF ? AG_NONE : W.S.Via[a];
+			if (W.Dist[a] != nd || W.Next[a] != nn)
+			{
+				W.Dist[a] = nd;
+				W.Next[a] = nn;
+				Count[From]++;
+			}
+		}
+	}
+};
+
+void AG_Repair( int Layer, AG_Area Info, word* Next, word* Dist )
+{
+	AG_Layer& G = Layers[Layer];
+	auto T0 = std::chrono::steady_clock::now();
+	int N = G.N;
+	std::vector<int> OldStart;
+	std::vector<word> OldTo;
+	std::vector<word> OldLen;
+	OldStart.swap( G.OutStart );
+	OldTo.swap( G.OutTo );
+	OldLen.swap( G.OutLen );
+	AG_Stats Old = G.Stats;
+	AG_Build( Layer, N, Info );
+	G.Stats.MatrixTime = Old.MatrixTime;
+	G.Stats.MatrixThreads = Old.MatrixThreads;
+	G.Stats.Repairs = Old.Repairs + 1;
+	//links by their old and new length
+	std::vector<AG_Change> Up;
+	std::vector<AG_Change> Down;
+	for (int i = 0; i < N; i++)
+	{
+		int os = OldStart[i];
+		int oe = OldStart[i + 1];
+		int ns = G.OutStart[i];
+		int ne = G.OutStart[i + 1];
+		for (int k = os; k < oe; k++)
+		{
+			int j = OldTo[k];
+			int Was = LinkLen( &OldTo[0], &OldLen[0], os, oe, j );
+			int Now = LinkLen( &G.OutTo[0], &G.OutLen[0], ns, ne, j );
+			if (Now > Was && LinkLen( &OldTo[0], &OldLen[0], os, k, j ) == AG_INF)
+			{
+				AG_Change c = { word( i ), word( j ), word( Was ) };
+				Up.push_back( c );
+			}
+		}
+		for (int k = ns; k < ne; k++)
+		{
+			int j = G.OutTo[k];
+			int Was = LinkLen( &OldTo[0], &OldLen[0], os, oe, j );
+			int Now = LinkLen( &G.OutTo[0], &G.OutLen[0], ns, ne, j );
+			if (Now < Was && LinkLen( &G.OutTo[0], &G.OutLen[0], ns, k, j ) == AG_INF)
+			{
+				AG_Change c = { word( i ), word( j ), word( Now ) };
+				Down.push_back( c );
+			}
+		}
+	}
+	std::vector<int> Count( N, 0 );
+	if (Up.size() || Down.size())
+	{
+		bool Zero = false;
+		for (size_t k = 0; k < OldLen.size(); k++)
+		{
+			Zero |= !OldLen[k];
+		}
+		for (size_t k = 0; k < G.OutLen.size(); k++)
+		{
+			Zero |= !G.OutLen[k];
+		}
+		AG_RepairJob Job = { &G, Next, Dist, &Up, &Down, Zero, &Count[0] };
+		JOBS.ParallelFor( N, Job );
+	}
+	G.Stats.RepairLinks = int( Up.size() + Down.size() );
+	G.Stats.RepairRows = 0;
+	G.Stats.RepairEntries = 0;
+	for (int i = 0; i < N; i++)
+	{
+		G.Stats.RepairRows += Count[i] != 0;
+		G.Stats.RepairEntries += Count[i];
+	}
+	auto T1 = std::chrono::steady_clock::now();
+	G.Stats.RepairTime = std::chrono::duration<double, std::milli>( T1 - T0 ).count();
+}
+
+int AG_Check( int Layer, const word* Next, const word* Dist )
+{
+	AG_Layer& G = Layers[Layer];
+	int N = G.N;
+	std::vector<word> FNext( size_t( N ) * N );
+	std::vector<word> FDist( size_t( N ) * N );
+	if (N)
+	{
+		AG_MatrixJob Job = { &G, &FNext[0], &FDist[0] };
+		JOBS.ParallelFor( N, Job );
+	}
+	int Bad = 0;
+	for (size_t e = 0; e < FNext.size(); e++)
+	{
+		if (Next[e] != FNext[e] || Dist[e] != FDist[e])
+		{
+			Bad++;
+		}
+	}
+	return Bad;
+}
+
+void AG_GetStats( int Layer, AG_Stats* S )
+{
+	AG_Layer& G = Layers[Layer];
+	*S = G.Stats;
+	size_t B = ( G.OutStart.size() + G.InStart.size() + G.Clu.size() + G.Loc.size() + G.MemStart.size()
+		+ G.PorStart.size() + G.PIdx.size() + G.Tab.size() + G.IDist.size() + G.EStart.size() + G.ELen.size() ) * sizeof( int )
+		+ ( G.OutTo.size() + G.OutLen.size() + G.InFrom.size() + G.InLen.size() + G.Mem.size() + G.Por.size()
+		+ G.INext.size() + G.EFrom.size() + G.ENext.size() ) * sizeof( word );
+	for (int i = 0; i < AG_NCACHE; i++)
+	{
+		const AG_Table& R = G.Cache[i];
+		B += R.PDist.size() * sizeof( int ) + ( R.PNext.size() + R.Next.size() + R.Dist.size() ) * sizeof( word ) + R.Done.size();
+	}
+	S->Bytes = int( B );
+}
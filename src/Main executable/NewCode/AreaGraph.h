@@ -0,0 +1,94 @@
+#pragma once
+
+/*
+	Sparse graph of the topology areas with shortest way queries.
+
+	The areas are grouped into clusters by their position, about
+	AG_CLUSTER areas each. An area with a link to another cluster is a
+	portal. For every portal the ways from the other areas of its
+	cluster to it, inside the cluster, are kept. A query runs Dijkstra
+	over the portals only and then joins every area to the best portal
+	of its cluster, which gives the exact shortest ways of the full
+	graph.
+
+	The answer of a query is a next-hop table: the next area and the
+	length of the way toward one target from every area. The last
+	AG_NCACHE tables of a layer are kept, the least recently used one
+	is dropped first.
+
+	The contract is the one of the old MotionLinks/LinksDist matrices:
+	links of length 0xFFFF are closed, an area has no way to itself and
+	a missing way is AG_NONE. Results depend only on the links. Of the
+	shortest ways the matrices keep the one of a Dijkstra that takes the
+	areas by (length, index): an area goes through the first area taken
+	that gives it its shortest way. AG_Next() may give another way of the
+	same length. Not thread safe.
+
+	AG_Matrix() fills the full matrices, one Dijkstra per source on the
+	threads of JOBS. Each job writes only the row of its source, so the
+	matrices do not depend on the number of threads.
+
+	AG_Repair() keeps the matrices equal to the ones of AG_Matrix() when
+	links change. A row is touched only if a longer or removed link was
+	on one of its shortest ways, or a shorter or new link gives a way as
+	short as the one it has; the other rows can not change. In a touched
+	row the areas that may lose their way are searched again, shorter
+	ways are spread, and the next areas are picked again where the
+	lengths or links around them changed, by the rule above. With links
+	of length 0, or lengths clamped to 0xFFFE, a touched row is made
+	again whole.
+*/
+
+//The game headers leave pack(1) on, the module is built without it
+#pragma pack(push)
+#pragma pack()
+
+#define AG_NLAYERS 2
+#define AG_NCACHE 32
+#define AG_CLUSTER 32
+
+#define AG_NONE 0xFFFF
+
+//Position of area i and its links, Link[2k] is the area and Link[2k+1]
+//the length of the k-th link, as in Area::Link. Returns the number of links.
+typedef int ( *AG_Area )( int i, int* x, int* y, const word** Link );
+
+//Builds the graph of N areas, drops the kept tables
+void AG_Build( int Layer, int N, AG_Area Info );
+void AG_Free( int Layer );
+int AG_GetN( int Layer );
+
+//Next area on the way from From to To
+word AG_Next( int Layer, int From, int To );
+//Length of the way, at most 0xFFFE
+word AG_Dist( int Layer, int From, int To );
+//Ways from From to every area, for the row of a full matrix
+void AG_Row( int Layer, int From, word* Next, word* Dist );
+//All the rows, Next[From*N+To] and Dist[From*N+To]
+void AG_Matrix( int Layer, word* Next, word* Dist );
+//Builds the graph again from Info, with the same number of areas, and
+//brings the matrices of the old graph up to date
+void AG_Repair( int Layer, AG_Area Info, word* Next, word* Dist );
+//Entries, next area or length, that differ from AG_Matrix()
+int AG_Check( int Layer, const word* Next, const word* Dist );
+
+struct AG_Stats
+{
+	int Areas;
+	int Clusters;
+	int Portals;
+	int Tables;		//next-hop tables made
+	int Hits;		//queries answered by a kept table
+	int Bytes;
+	double MatrixTime;	//ms of the last AG_Matrix
+	int MatrixThreads;
+	int Repairs;		//AG_Repair calls, the rest is of the last one
+	int RepairLinks;	//links that got longer or shorter
+	int RepairRows;		//rows with changed entries
+	int RepairEntries;	//changed entries
+	double RepairTime;	//ms
+};
+
+void AG_GetStats( int Layer, AG_Stats* S );
+
+#pragma pack(pop)
@@ -0,0 +1,202 @@
+#include "../cross_platform/platform_compat.h"
+#include "CellBuckets.h"
+#include "ObjHot.h"
+#include "ObjIndex.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define CB_NOBJ 65536
+#define CB_NONE -1
+//list of an object
+#define CBL_UNITS 0
+#define CBL_BUILDINGS 1
+
+CB_Cell* CB_Units = nullptr;
+static CB_Cell* Buildings = nullptr;
+static int NCells = 0;
+static int MaxCX = 0;
+static int ShfCX = 0;
+static word* Count = nullptr;
+static word* TopBld = nullptr;
+
+//list and cell every object is in, CB_NONE if not in a list
+static signed char ListOf[CB_NOBJ];
+static int CellOf[CB_NOBJ];
+
+static word Marked[CB_NOBJ];
+static int NMarked = 0;
+static byte IsMarked[CB_NOBJ];
+
+static void FreeCells( CB_Cell* C )
+{
+	if (!C)
+	{
+		return;
+	}
+	for (int i = 0; i < NCells; i++)
+	{
+		free( C[i].List );
+	}
+	free( C );
+}
+
+static void EmptyCells( CB_Cell* C )
+{
+	for (int i = 0; i < NCells; i++)
+	{
+		C[i].N = 0;
+	}
+}
+
+//position of Index in the sorted list, or where it goes
+static int Find( CB_Cell& C, word Index )
+{
+	int a = 0;
+	int b = C.N;
+	while (a < b)
+	{
+		int m = ( a + b ) >> 1;
+		if (C.List[m] < Index)
+		{
+			a = m + 1;
+		}
+		else
+		{
+			b = m;
+		}
+	}
+	return a;
+}
+
+static void Insert( CB_Cell& C, word Index )
+{
+	if (C.N == C.Max)
+	{
+		C.Max = C.Max ? C.Max * 2 : 8;
+		C.List = (word*) realloc( C.List, C.Max * sizeof( word ) );
+	}
+	int p = Find( C, Index );
+	memmove( C.List + p + 1, C.List + p, ( C.N - p ) * sizeof( word ) );
+	C.List[p] = Index;
+	C.N++;
+}
+
+static void Remove( CB_Cell& C, word Index )
+{
+	int p = Find( C, Index );
+	if (p < C.N && C.List[p] == Index)
+	{
+		memmove( C.List + p, C.List + p + 1, ( C.N - p - 1 ) * sizeof( word ) );
+		C.N--;
+	}
+}
+
+static void Export( int List, int Cell )
+{
+	if (List == CBL_UNITS)
+	{
+		Count[Cell] = word( CB_Units[Cell].N );
+	}
+	else
+	{
+		CB_Cell& C = Buildings[Cell];
+		TopBld[Cell] = C.N ? C.List[C.N - 1] : 0xFFFF;
+	}
+}
+
+void CB_Init( int CX, int Shift, word* UnitCount, word* TopBuilding )
+{
+	CB_Free();
+	MaxCX = CX;
+	ShfCX = Shift;
+	NCells = CX * CX;
+	Count = UnitCount;
+	TopBld = TopBuilding;
+	CB_Units = (CB_Cell*) calloc( NCells, sizeof( CB_Cell ) );
+	Buildings = (CB_Cell*) calloc( NCells, sizeof( CB_Cell ) );
+	CB_Reset();
+}
+
+void CB_Free()
+{
+	FreeCells( CB_Units );
+	FreeCells( Buildings );
+	CB_Units = nullptr;
+	Buildings = nullptr;
+	NCells = 0;
+}
+
+void CB_Reset()
+{
+	if (!NCells)
+	{
+		return;
+	}
+	EmptyCells( CB_Units );
+	EmptyCells( Buildings );
+	memset( Count, 0, NCells * sizeof( word ) );
+	memset( TopBld, 0xFF, NCells * sizeof( word ) );
+	memset( ListOf, CB_NONE, sizeof ListOf );
+	memset( IsMarked, 0, sizeof IsMarked );
+	NMarked = 0;
+	for (int i = OI_Next( 0 ); i < OI_END; i = OI_Next( i + 1 ))
+	{
+		CB_Mark( i );
+	}
+}
+
+void CB_Mark( int Index )
+{
+	if (!IsMarked[Index])
+	{
+		IsMarked[Index] = 1;
+		Marked[NMarked++] = word( Index );
+	}
+}
+
+void CB_Update()
+{
+	for (int j = 0; j < NMarked; j++)
+	{
+		int i = Marked[j];
+		IsMarked[i] = 0;
+		int L = CB_NONE;
+		int C = 0;
+		byte F = OH_Flags[i];
+		if (OI_Has( i ) && !( F & OHF_DYING ))
+		{
+			if (F & OHF_UNIT)
+			{
+				L = CBL_UNITS;
+			}
+			else if (F & OHF_BUILDING)
+			{
+				L = CBL_BUILDINGS;
+			}
+			C = ( OH_X[i] >> 11 ) + ( ( OH_Y[i] >> 11 ) << ShfCX ) + MaxCX + 1;
+			if (C < 0 || C >= NCells)
+			{
+				L = CB_NONE;
+			}
+		}
+		int L0 = ListOf[i];
+		int C0 = CellOf[i];
+		if (L == L0 && ( L == CB_NONE || C == C0 ))
+		{
+			continue;
+		}
+		if (L0 != CB_NONE)
+		{
+			Remove( L0 == CBL_UNITS ? CB_Units[C0] : Buildings[C0], word( i ) );
+			Export( L0, C0 );
+		}
+		if (L != CB_NONE)
+		{
+			Insert( L == CBL_UNITS ? CB_Units[C] : Buildings[C], word( i ) );
+			Export( L, C );
+		}
+		ListOf[i] = (signed char) L;
+		CellOf[i] = C;
+	}
+	NMarked = 0;
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+/*
+	Persistent lists of the units and the buildings of every 2048 point
+	map cell, the cells of MCount and BLDList. The lists are kept from
+	tick to tick and an object moves from one list to another only when
+	its cell changes. A list grows as needed, so a crowded cell never
+	drops units, and keeps its objects in index order, so every peer
+	walks a cell in the same order.
+
+	StoreObjHot() and UnindexObject() mark the objects that changed and
+	CB_Update() re-buckets them at the start of the tick, so the lists
+	and MCount/BLDList stay fixed while the tick runs.
+*/
+
+//The game headers leave pack(1) on, the module is built without it
+#pragma pack(push)
+#pragma pack()
+
+struct CB_Cell
+{
+	word* List;
+	int N;
+	int Max;
+};
+
+extern CB_Cell* CB_Units;
+
+//Allocates the cells of a map MaxCX cells wide, Shift is log2(MaxCX).
+//Count and TopBuilding (MCount and BLDList) are kept up to date by
+//CB_Update with the size of the unit list and the highest building index
+void CB_Init( int MaxCX, int Shift, word* Count, word* TopBuilding );
+void CB_Free();
+
+//Empties every list and marks every object of the live index
+void CB_Reset();
+
+//Object Index changed its position, state or type
+void CB_Mark( int Index );
+
+//Moves the marked objects to the lists of their current cells
+void CB_Update();
+
+//Units in the cell, MCount[Cell] of them
+inline word* CB_CellUnits( int Cell )
+{
+	return CB_Units[Cell].List;
+}
+
+#pragma pack(pop)
@@ -0,0 +1,401 @@
+#include "../cross_platform/platform_compat.h"
+#include "DangerField.h"
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#define DF_MAXOBJ 65536
+
+//max+min/2 until the game gives its own
+static int HalfNorm( int dx, int dy )
+{
+	dx = abs( dx );
+	dy = abs( dy );
+	return dx > dy ? dx + ( dy >> 1 ) : dy + ( dx >> 1 );
+}
+
+static int FlatHeight( int, int )
+{
+	return 0;
+}
+
+static DF_Norm Norm = &HalfNorm;
+static DF_Height Height = &FlatHeight;
+static DF_Stats Stats;
+
+static int Lx = 0;
+static int Shf = 0;
+//damage and Water objects of every nation on every cell
+static word* Dam[DF_NNAT];
+static word* Wat[DF_NNAT];
+//height of the cell centres, filled by the first stamp
+static int* Z = nullptr;
+static int ZMin = 0;
+static bool ZDone = false;
+
+struct DF_Obj
+{
+	int Index;
+	bool HasReach;
+	bool Stamped;
+	DF_Reach R;
+};
+
+static std::vector<DF_Obj> Objs;
+//1 + the place of the object in Objs, 0 - not there
+static int Slot[DF_MAXOBJ];
+
+void DF_SetNorm( DF_Norm N )
+{
+	Norm = N ? N : &HalfNorm;
+}
+
+void DF_SetHeight( DF_Height H )
+{
+	Height = H ? H : &FlatHeight;
+}
+
+bool DF_Reaches( const DF_Reach* R, int x, int y, int z )
+{
+	int dst = Norm( x - R->x, y - R->y ) - R->Pad;
+	int dstx = dst + ( ( z - R->z ) << 1 );
+	if (dstx < 0)
+	{
+		dstx = 0;
+	}
+	int Need = -1;
+	for (int i = 0; i < DF_NWEAP; i++)
+	{
+		if (R->Kind[i] & DFW_ARC)
+		{
+			if (dst > R->R1[i] && dstx < R->R2[i])
+			{
+				Need = i;
+			}
+		}
+		else if (dst >= R->R1[i] && dst <= R->R2[i])
+		{
+			Need = i;
+		}
+	}
+	return Need >= 0 && ( R->Kind[Need] & DFW_SHOOTS );
+}
+
+static void FillZ()
+{
+	if (ZDone)
+	{
+		return;
+	}
+	ZMin = 0;
+	for (int cy = 0; cy < Lx; cy++)
+	{
+		for (int cx = 0; cx < Lx; cx++)
+		{
+			int h = Height( ( cx << DF_CSHIFT ) + DF_CELL / 2, ( cy << DF_CSHIFT ) + DF_CELL / 2 );
+			Z[cx + ( cy << Shf )] = h;
+			if (( !cx && !cy ) || h < ZMin)
+			{
+				ZMin = h;
+			}
+		}
+	}
+	ZDone = true;
+}
+
+//Farthest norm a weapon of R can reach, the lowest cell is the farthest
+//one for an arc
+static int Bound( const DF_Reach& R )
+{
+	int B = 0;
+	for (int i = 0; i < DF_NWEAP; i++)
+	{
+		int r = R.R2[i];
+		if (( R.Kind[i] & DFW_ARC ) && R.z > ZMin)
+		{
+			r += ( R.z - ZMin ) << 1;
+		}
+		if (( R.Kind[i] & DFW_SHOOTS ) && r > B)
+		{
+			B = r;
+		}
+	}
+	return B + ( R.Pad > 0 ? R.Pad : 0 );
+}
+
+//Adds Sign times R to the maps D and W, returns the cells it reached
+static int StampInto( word** D, word** W, const DF_Reach& R, int Sign )
+{
+	int B = Bound( R );
+	int x0 = ( R.x - B - DF_CELL / 2 ) >> DF_CSHIFT;
+	int x1 = ( ( R.x + B - DF_CELL / 2 ) >> DF_CSHIFT ) + 1;
+	int y0 = ( R.y - B - DF_CELL / 2 ) >> DF_CSHIFT;
+	int y1 = ( ( R.y + B - DF_CELL / 2 ) >> DF_CSHIFT ) + 1;
+	x0 = x0 < 0 ? 0 : x0;
+	y0 = y0 < 0 ? 0 : y0;
+	x1 = x1 >= Lx ? Lx - 1 : x1;
+	y1 = y1 >= Lx ? Lx - 1 : y1;
+	word* DM = D[R.Nat];
+	word* WM = W[R.Nat];
+	word dd = word( R.Dam * Sign );
+	word dw = word( R.Water ? Sign : 0 );
+	int N = 0;
+	for (int cy = y0; cy <= y1; cy++)
+	{
+		for (int cx = x0; cx <= x1; cx++)
+		{
+			int c = cx + ( cy << Shf );
+			if (DF_Reaches( &R, ( cx << DF_CSHIFT ) + DF_CELL / 2, ( cy << DF_CSHIFT ) + DF_CELL / 2, Z[c] ))
+			{
+				DM[c] += dd;
+				WM[c] += dw;
+				N++;
+			}
+		}
+	}
+	return N;
+}
+
+static void Stamp( DF_Obj& O, int Sign )
+{
+	if (Sign > 0)
+	{
+		FillZ();
+		Stats.Stamps++;
+	}
+	Stats.Cells += StampInto( Dam, Wat, O.R, Sign );
+	O.Stamped = Sign > 0;
+}
+
+static void ClearMaps()
+{
+	for (int n = 0; n < DF_NNAT && Lx; n++)
+	{
+		memset( Dam[n], 0, Lx * Lx * sizeof( word ) );
+		memset( Wat[n], 0, Lx * Lx * sizeof( word ) );
+	}
+	for (DF_Obj& O : Objs)
+	{
+		O.Stamped = false;
+	}
+	ZDone = false;
+}
+
+void DF_Init( int L, int Shift )
+{
+	DF_Free();
+	Lx = L;
+	Shf = Shift;
+	for (int n = 0; n < DF_NNAT; n++)
+	{
+		Dam[n] = (word*) calloc( Lx * Lx, sizeof( word ) );
+		Wat[n] = (word*) calloc( Lx * Lx, sizeof( word ) );
+	}
+	Z = (int*) calloc( Lx * Lx, sizeof( int ) );
+	ClearMaps();
+}
+
+void DF_Free()
+{
+	for (int n = 0; n < DF_NNAT; n++)
+	{
+		free( Dam[n] );
+		Dam[n] = nullptr;
+		free( Wat[n] );
+		Wat[n] = nullptr;
+	}
+	free( Z );
+	Z = nullptr;
+	Lx = 0;
+	ClearMaps();
+}
+
+void DF_Reset()
+{
+	ClearMaps();
+}
+
+void DF_Clear()
+{
+	for (const DF_Obj& O : Objs)
+	{
+		Slot[O.Index] = 0;
+	}
+	Objs.clear();
+	ClearMaps();
+}
+
+void DF_Add( int Index )
+{
+	if (Index < 0 || Index >= DF_MAXOBJ || Slot[Index])
+	{
+		return;
+	}
+	DF_Obj O;
+	O.Index = Index;
+	O.HasReach = false;
+	O.Stamped = false;
+	Objs.push_back( O );
+	Slot[Index] = int( Objs.size() );
+}
+
+static bool SameReach( const DF_Reach& a, const DF_Reach& b )
+{
+	if (a.x != b.x || a.y != b.y || a.z != b.z || a.Nat != b.Nat || a.Dam != b.Dam || a.Water != b.Water || a.Pad != b.Pad)
+	{
+		return false;
+	}
+	for (int i = 0; i < DF_NWEAP; i++)
+	{
+		if (a.Kind[i] != b.Kind[i] || a.R1[i] != b.R1[i] || a.R2[i] != b.R2[i])
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+void DF_Set( int Index, const DF_Reach* R )
+{
+	if (Index < 0 || Index >= DF_MAXOBJ || R->Nat < 0 || R->Nat >= DF_NNAT)
+	{
+		return;
+	}
+	DF_Add( Index );
+	DF_Obj& O = Objs[Slot[Index] - 1];
+	if (O.HasReach && ( O.Stamped || !Lx ) && SameReach( O.R, *R ))
+	{
+		Stats.Kept++;
+		return;
+	}
+	if (O.Stamped)
+	{
+		Stamp( O, -1 );
+	}
+	O.R = *R;
+	O.HasReach = true;
+	if (Lx)
+	{
+		Stamp( O, 1 );
+	}
+}
+
+void DF_Del( int Index )
+{
+	if (Index < 0 || Index >= DF_MAXOBJ || !Slot[Index])
+	{
+		return;
+	}
+	int k = Slot[Index] - 1;
+	if (Objs[k].Stamped)
+	{
+		Stamp( Objs[k], -1 );
+	}
+	Slot[Index] = 0;
+	if (k != int( Objs.size() ) - 1)
+	{
+		Objs[k] = Objs.back();
+		Slot[Objs[k].Index] = k + 1;
+	}
+	Objs.pop_back();
+}
+
+bool DF_Has( int Index )
+{
+	return Index >= 0 && Index < DF_MAXOBJ && Slot[Index];
+}
+
+int DF_Count()
+{
+	return int( Objs.size() );
+}
+
+int DF_Index( int k )
+{
+	return Objs[k].Index;
+}
+
+int DF_Get( int cx, int cy, int Nat )
+{
+	if (cx < 0 || cy < 0 || cx >= Lx || cy >= Lx || Nat < 0 || Nat >= DF_NNAT)
+	{
+		return 0;
+	}
+	int c = cx + ( cy << Shf );
+	int d = Dam[Nat][c];
+	return ( d > 127 ? 127 : d ) | ( Wat[Nat][c] ? 128 : 0 );
+}
+
+int DF_GetMask( int cx, int cy, int NatMask )
+{
+	if (cx < 0 || cy < 0 || cx >= Lx || cy >= Lx)
+	{
+		return 0;
+	}
+	int c = cx + ( cy << Shf );
+	int d = 0;
+	int w = 0;
+	for (int n = 0; n < DF_NNAT; n++)
+	{
+		if (NatMask & ( 1 << n ))
+		{
+			d += Dam[n][c];
+			w |= Wat[n][c];
+		}
+	}
+	return ( d > 127 ? 127 : d ) | ( w ? 128 : 0 );
+}
+
+int DF_Check()
+{
+	if (!Lx)
+	{
+		return 0;
+	}
+	std::vector<word> Buf( size_t( Lx * Lx ) * DF_NNAT * 2, 0 );
+	word* D[DF_NNAT];
+	word* W[DF_NNAT];
+	for (int n = 0; n < DF_NNAT; n++)
+	{
+		D[n] = &Buf[size_t( Lx * Lx ) * n];
+		W[n] = &Buf[size_t( Lx * Lx ) * ( DF_NNAT + n )];
+	}
+	for (const DF_Obj& O : Objs)
+	{
+		if (O.Stamped)
+		{
+			StampInto( D, W, O.R, 1 );
+		}
+	}
+	int Bad = 0;
+	for (int c = 0; c < Lx * Lx; c++)
+	{
+		for (int n = 0; n < DF_NNAT; n++)
+		{
+			if (D[n][c] != Dam[n][c] || W[n][c] != Wat[n][c])
+			{
+				Bad++;
+				break;
+			}
+		}
+	}
+	return Bad;
+}
+
+void DF_GetStats( DF_Stats* S )
+{
+	*S = Stats;
+	S->Objects = int( Objs.size() );
+	S->Stamped = 0;
+	for (const DF_Obj& O : Objs)
+	{
+		S->Stamped += O.Stamped;
+	}
+}
+
+void DF_ClearStats()
+{
+	Stats.Stamps = 0;
+	Stats.Kept = 0;
+	Stats.Cells = 0;
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+/*
+	Danger map of every nation: the cells of DF_CELL points that the
+	dangerous objects of the nation can shoot at.
+
+	Every object stamps its reach into the map of its nation once and
+	keeps what it stamped. DF_Set() takes the reach of the current state
+	of the object and does nothing while it is the stamped one. Otherwise
+	the old reach is taken away and the new one stamped, so the maps are
+	always the sum of the current reaches and a lookup is two reads.
+
+	A cell is reached if the reach test of CheckDamageAbility() holds
+	for its centre, without the test of the obstacles on the way of the
+	shot. The height of a cell is asked from the height function once
+	after DF_Clear() or DF_Reset() and kept, so a reach is taken away
+	from the very cells it was stamped into.
+
+	The maps depend only on the reaches given, the order of the calls
+	does not matter. Not thread safe.
+*/
+
+//The game headers leave pack(1) on, the module is built without it
+#pragma pack(push)
+#pragma pack()
+
+#define DF_NNAT 8
+#define DF_NWEAP 4
+#define DF_CSHIFT 7
+#define DF_CELL ( 1 << DF_CSHIFT )
+
+typedef int ( *DF_Norm )( int dx, int dy );
+//Height of a target at the point (x,y)
+typedef int ( *DF_Height )( int x, int y );
+
+//Bits of DF_Reach::Kind. A weapon matches if R1<=dst<=R2, an arc if
+//R1<dst and dst plus twice the height over the source is below R2.
+#define DFW_SHOOTS	1	//without it a match reaches nothing
+#define DFW_ARC		2
+
+//What an object can shoot at, the last weapon that matches decides
+struct DF_Reach
+{
+	int x, y, z;	//position, z of the shot source
+	int Nat;
+	int Dam;		//added to the cells it reaches
+	bool Water;		//counted apart, bit 128 of DF_Get
+	int Pad;		//taken from the distance before the weapons are tested
+	byte Kind[DF_NWEAP];
+	int R1[DF_NWEAP];
+	int R2[DF_NWEAP];
+};
+
+void DF_SetNorm( DF_Norm Norm );
+void DF_SetHeight( DF_Height Height );
+
+//Maps of Lx*Lx cells, Shift is log2(Lx). The objects are kept and
+//stamped again by their next DF_Set
+void DF_Init( int Lx, int Shift );
+void DF_Free();
+//Empties the maps, the objects are kept as DF_Init keeps them
+void DF_Reset();
+//Drops the objects and empties the maps
+void DF_Clear();
+
+//Adds the object Index without a reach, DF_Set stamps it
+void DF_Add( int Index );
+void DF_Set( int Index, const DF_Reach* R );
+void DF_Del( int Index );
+bool DF_Has( int Index );
+//The objects, DF_Del of the object k moves the last one to k
+int DF_Count();
+int DF_Index( int k );
+
+//Danger of nation Nat on the cell: the damage, at most 127, and 128 if
+//a Water object reaches it. 0 outside of the map
+int DF_Get( int cx, int cy, int Nat );
+//The same for the sum of the nations in NatMask
+int DF_GetMask( int cx, int cy, int NatMask );
+//true if R reaches a target at (x,y,z)
+bool DF_Reaches( const DF_Reach* R, int x, int y, int z );
+
+//Cells that differ from the maps stamped again from the objects
+int DF_Check();
+
+struct DF_Stats
+{
+	int Objects;
+	int Stamped;	//objects in the maps
+	int Stamps;		//reaches stamped
+	int Kept;		//DF_Set calls that changed nothing
+	int Cells;		//cells written by stamps and their removal
+};
+
+void DF_GetStats( DF_Stats* S );
+void DF_ClearStats();
+
+#pragma pack(pop)
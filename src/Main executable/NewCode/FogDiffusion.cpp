@@ -0,0 +1,247 @@
+#include "../cross_platform/platform_compat.h"
+#include "FogDiffusion.h"
+#include "JobPool.h"
+#include <vector>
+
+#if defined(_M_X64) || defined(__x86_64__) || defined(__SSE2__) || ( defined(_M_IX86_FP) && _M_IX86_FP >= 2 )
+#define FD_SSE2
+#include <emmintrin.h>
+#endif
+
+#define FD_TILE_SH 4
+#define FD_TILE ( 1 << FD_TILE_SH )
+
+static bool Incremental = true;
+static bool FullStep = true;
+static int MapLX = 0;
+static int NTiles = 0;
+static const word* LastMap = nullptr;
+static const word* LastCopy = nullptr;
+static int LastMLX = 0;
+static int LastMLY = 0;
+static int NProcessed = 0;
+
+//per tile: written from outside / changed in the last step / to copy / to compute
+static std::vector<byte> Edited;
+static std::vector<byte> Changed;
+static std::vector<byte> ToCopy;
+static std::vector<byte> ToStep;
+
+//Dst[i] for i in 0..n-1 from the neighbours of Src[i]; true if any cell changed
+static bool StepRow( word* Dst, const word* Src, int LX, int n )
+{
+	int i = 0;
+	word Diff = 0;
+#ifdef FD_SSE2
+	__m128i Acc = _mm_setzero_si128();
+	for (; i + 8 <= n; i += 8)
+	{
+		const word* s = Src + i;
+		__m128i Sum = _mm_add_epi16( _mm_loadu_si128( (const __m128i*) ( s - LX ) ), _mm_loadu_si128( (const __m128i*) ( s + LX ) ) );
+		Sum = _mm_add_epi16( Sum, _mm_loadu_si128( (const __m128i*) ( s - 1 ) ) );
+		Sum = _mm_add_epi16( Sum, _mm_loadu_si128( (const __m128i*) ( s + 1 ) ) );
+		__m128i R = _mm_sub_epi16( _mm_srli_epi16( Sum, 2 ), _mm_srli_epi16( Sum, 10 ) );
+		_mm_storeu_si128( (__m128i*) ( Dst + i ), R );
+		Acc = _mm_or_si128( Acc, _mm_xor_si128( R, _mm_loadu_si128( (const __m128i*) s ) ) );
+	}
+	if (_mm_movemask_epi8( _mm_cmpeq_epi8( Acc, _mm_setzero_si128() ) ) != 0xFFFF)
+	{
+		Diff = 1;
+	}
+#endif
+	for (; i < n; i++)
+	{
+		const word* s = Src + i;
+		word Sum = word( s[-LX] + s[LX] + s[-1] + s[1] );
+		word R = word( ( Sum >> 2 ) - ( Sum >> 10 ) );
+		Dst[i] = R;
+		Diff |= R ^ s[0];
+	}
+	return Diff != 0;
+}
+
+struct FD_Job
+{
+	word* Map;
+	word* Copy;
+	int LX;
+	int mlx;
+	int mly;
+};
+
+//Copies the tiles of row ty that changed since the last step
+static void CopyTileRow( int ty, void* Param )
+{
+	FD_Job* J = (FD_Job*) Param;
+	int y0 = ty << FD_TILE_SH;
+	int y1 = y0 + FD_TILE;
+	if (y1 > J->LX)
+	{
+		y1 = J->LX;
+	}
+	const byte* Flags = &ToCopy[ty * NTiles];
+	for (int tx = 0; tx < NTiles; tx++)
+	{
+		if (!Flags[tx])
+		{
+			continue;
+		}
+		int x0 = tx << FD_TILE_SH;
+		int n = FD_TILE;
+		if (x0 + n > J->LX)
+		{
+			n = J->LX - x0;
+		}
+		for (int y = y0; y < y1; y++)
+		{
+			int ofs = y * J->LX + x0;
+			memcpy( J->Copy + ofs, J->Map + ofs, n * 2 );
+		}
+	}
+}
+
+//Steps the marked tiles of row ty and records which of them changed
+static void StepTileRow( int ty, void* Param )
+{
+	FD_Job* J = (FD_Job*) Param;
+	int y0 = ty << FD_TILE_SH;
+	int y1 = y0 + FD_TILE;
+	if (y0 < 1)
+	{
+		y0 = 1;
+	}
+	if (y1 > J->mly)
+	{
+		y1 = J->mly;
+	}
+	const byte* Flags = &ToStep[ty * NTiles];
+	byte* Out = &Changed[ty * NTiles];
+	for (int tx = 0; tx < NTiles; tx++)
+	{
+		Out[tx] = 0;
+		if (!Flags[tx])
+		{
+			continue;
+		}
+		int x0 = tx << FD_TILE_SH;
+		int x1 = x0 + FD_TILE;
+		if (x0 < 1)
+		{
+			x0 = 1;
+		}
+		if (x1 > J->mlx)
+		{
+			x1 = J->mlx;
+		}
+		if (x1 <= x0)
+		{
+			continue;
+		}
+		bool Diff = false;
+		for (int y = y0; y < y1; y++)
+		{
+			int ofs = y * J->LX + x0;
+			if (StepRow( J->Map + ofs, J->Copy + ofs, J->LX, x1 - x0 ))
+			{
+				Diff = true;
+			}
+		}
+		Out[tx] = Diff;
+	}
+}
+
+void FD_MarkCell( int x, int y )
+{
+	if (FullStep || x < 0 || y < 0 || x >= MapLX || y >= MapLX)
+	{
+		return;
+	}
+	Edited[( y >> FD_TILE_SH ) * NTiles + ( x >> FD_TILE_SH )] = 1;
+}
+
+void FD_Reset()
+{
+	FullStep = true;
+}
+
+void FD_SetIncremental( bool On )
+{
+	if (On && !Incremental)
+	{
+		FullStep = true;
+	}
+	Incremental = On;
+}
+
+void FD_Process( word* Map, word* Copy, int LX, int mlx, int mly )
+{
+	if (mlx > LX - 1)
+	{
+		mlx = LX - 1;
+	}
+	if (mly > LX - 1)
+	{
+		mly = LX - 1;
+	}
+	if (LX != MapLX || Map != LastMap || Copy != LastCopy || mlx != LastMLX || mly != LastMLY)
+	{
+		MapLX = LX;
+		LastMap = Map;
+		LastCopy = Copy;
+		LastMLX = mlx;
+		LastMLY = mly;
+		NTiles = ( LX + FD_TILE - 1 ) >> FD_TILE_SH;
+		int N = NTiles * NTiles;
+		Edited.assign( N, 0 );
+		Changed.assign( N, 0 );
+		ToCopy.assign( N, 0 );
+		ToStep.assign( N, 0 );
+		FullStep = true;
+	}
+	int N = NTiles * NTiles;
+	FD_Job J = { Map, Copy, LX, mlx, mly };
+	if (FullStep || !Incremental)
+	{
+		memcpy( Copy, Map, LX * LX * 2 );
+		memset( ToStep.data(), 1, N );
+		NProcessed = N;
+	}
+	else
+	{
+		//a tile has to be copied if its input changed since the last step,
+		//and stepped if its own input or the input next to it changed
+		NProcessed = 0;
+		for (int i = 0; i < N; i++)
+		{
+			ToCopy[i] = Changed[i] | Edited[i];
+		}
+		for (int ty = 0; ty < NTiles; ty++)
+		{
+			for (int tx = 0; tx < NTiles; tx++)
+			{
+				int i = ty * NTiles + tx;
+				byte s = ToCopy[i];
+				if (tx > 0)s |= ToCopy[i - 1];
+				if (tx < NTiles - 1)s |= ToCopy[i + 1];
+				if (ty > 0)s |= ToCopy[i - NTiles];
+				if (ty < NTiles - 1)s |= ToCopy[i + NTiles];
+				ToStep[i] = s;
+				NProcessed += s;
+			}
+		}
+		JOBS.ParallelFor( NTiles, &CopyTileRow, &J );
+	}
+	JOBS.ParallelFor( NTiles, &StepTileRow, &J );
+	memset( Edited.data(), 0, N );
+	FullStep = false;
+}
+
+int FD_GetProcessedTiles()
+{
+	return NProcessed;
+}
+
+int FD_GetTotalTiles()
+{
+	return NTiles * NTiles;
+}
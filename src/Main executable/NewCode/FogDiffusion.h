@@ -0,0 +1,30 @@
+#pragma once
+
+/*
+	Diffusion step of the fog of war map.
+
+	Every cell gets the sum of its 4 neighbours s (16 bit) and becomes
+	(s >> 2) - (s >> 10), like the old ProcessFog1_1/2/3() assembler loops.
+	The map is split into 16x16 tiles. A cell keeps its value if it was
+	not written from outside and none of its neighbours changed in the
+	last step, so the incremental mode only recomputes the tiles that
+	changed in the last step or got a light spot, and the tiles next to
+	them. The result is the same as stepping the whole map. Quiet parts of
+	the map cost nothing. Tile rows are processed on the JobPool.
+*/
+
+//Cell (x,y) of the fog map was written outside of the diffusion
+void FD_MarkCell( int x, int y );
+//The whole map was written (cleared, reallocated); the next step is a full one
+void FD_Reset();
+//false: every step processes the whole map
+void FD_SetIncremental( bool On );
+
+//One step of the cells 1..mlx-1 x 1..mly-1 of Map (LX words per row).
+//Copy is a scratch map of the same size that has to be kept between the
+//steps; it holds the input of the last step.
+void FD_Process( word* Map, word* Copy, int LX, int mlx, int mly );
+
+//Tiles recomputed by the last step and the number of tiles of the map
+int FD_GetProcessedTiles();
+int FD_GetTotalTiles();
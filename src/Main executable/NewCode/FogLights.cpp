@@ -0,0 +1,61 @@
+#include "../cross_platform/platform_compat.h"
+#include "FogLights.h"
+#include "FogDiffusion.h"
+#include <vector>
+
+//(y << 16) | x of the queued cells
+static std::vector<DWORD> Queue;
+//one bit per cell of the map, set while the cell is written in FL_Flush
+static std::vector<DWORD> Seen;
+static std::vector<int> Written;
+
+void FL_Add( int x, int y )
+{
+	Queue.push_back( ( DWORD( y ) << 16 ) | DWORD( x & 0xFFFF ) );
+}
+
+int FL_GetQueued()
+{
+	return int( Queue.size() );
+}
+
+int FL_Flush( word* Map, int LX, word Value )
+{
+	int N = int( Queue.size() );
+	if (!N)
+	{
+		return 0;
+	}
+	size_t NBits = size_t( LX ) * LX;
+	if (Seen.size() * 32 < NBits)
+	{
+		Seen.assign( ( NBits + 31 ) >> 5, 0 );
+	}
+	Written.clear();
+	for (int i = 0; i < N; i++)
+	{
+		int x = Queue[i] & 0xFFFF;
+		int y = Queue[i] >> 16;
+		if (x >= LX || y >= LX)
+		{
+			continue;
+		}
+		int ofs = y * LX + x;
+		DWORD Bit = DWORD( 1 ) << ( ofs & 31 );
+		DWORD& W = Seen[ofs >> 5];
+		if (W & Bit)
+		{
+			continue;
+		}
+		W |= Bit;
+		Written.push_back( ofs );
+		Map[ofs] = Value;
+		FD_MarkCell( x, y );
+	}
+	for (int ofs : Written)
+	{
+		Seen[ofs >> 5] = 0;
+	}
+	Queue.clear();
+	return int( Written.size() );
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+/*
+	Light spots of the fog of war collected over one tick.
+
+	FogSpot() only queues the fog cell. FL_Flush() writes the light value
+	into every queued cell once and tells the fog diffusion about it, so a
+	crowd of units standing in the same cells costs one write per cell
+	instead of one per unit. Spots only set a constant, so the order in
+	which they are applied does not matter.
+*/
+
+//Queues the fog cell (x,y)
+void FL_Add( int x, int y );
+//Number of spots queued since the last flush
+int FL_GetQueued();
+//Sets Map cell of every queued spot to Value, returns the number of cells
+int FL_Flush( word* Map, int LX, word Value );
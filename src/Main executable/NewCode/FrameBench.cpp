@@ -0,0 +1,219 @@
+#include "../cross_platform/platform_compat.h"
+#include "FrameBench.h"
+#include <chrono>
+#include <vector>
+#include <algorithm>
+
+typedef std::chrono::steady_clock FB_Clock;
+
+static const char* StageNames[FBS_COUNT] = { "terrain", "objects", "fog", "minimap", "frame" };
+
+static char SaveName[256];
+static int NFrames = 0;
+static int DumpStep = 0;
+static std::vector<int> PathX;
+static std::vector<int> PathY;
+static int OrderHigh = 0;
+//OrderHigh of every frame
+static std::vector<int> OrderHighs;
+
+static bool Pending = false;
+static bool Active = false;
+static int CurFrame = 0;
+
+static FB_Clock::time_point StageStart[FBS_COUNT];
+static double FrameTime[FBS_COUNT];
+//Times[Stage][Frame], ms
+static std::vector<float> Times[FBS_COUNT];
+
+void FB_Setup( const char* Name, int Frames, int Step )
+{
+	strncpy( SaveName, Name, sizeof SaveName - 1 );
+	SaveName[sizeof SaveName - 1] = 0;
+	NFrames = Frames > 0 ? Frames : 0;
+	DumpStep = Step > 0 ? Step : 0;
+	PathX.clear();
+	PathY.clear();
+	OrderHigh = 0;
+	OrderHighs.clear();
+	OrderHighs.reserve( NFrames );
+	for (int i = 0; i < FBS_COUNT; i++)
+	{
+		Times[i].clear();
+		Times[i].reserve( NFrames );
+	}
+	Pending = NFrames > 0;
+	Active = false;
+	CurFrame = 0;
+}
+
+void FB_AddWaypoint( int x, int y )
+{
+	PathX.push_back( x );
+	PathY.push_back( y );
+}
+
+void FB_SetOrderHigh( int NOrders )
+{
+	OrderHigh = NOrders;
+}
+
+bool FB_Pending()
+{
+	return Pending;
+}
+
+const char* FB_GetSaveName()
+{
+	return SaveName;
+}
+
+void FB_Start()
+{
+	Pending = false;
+	Active = NFrames > 0;
+	CurFrame = 0;
+	memset( FrameTime, 0, sizeof FrameTime );
+}
+
+bool FB_Active()
+{
+	return Active;
+}
+
+bool FB_Finished()
+{
+	return NFrames > 0 && CurFrame >= NFrames;
+}
+
+void FB_GetCamera( int* x, int* y )
+{
+	int N = int( PathX.size() );
+	if (!Active || !N)
+	{
+		return;
+	}
+	if (N == 1 || NFrames < 2)
+	{
+		*x = PathX[0];
+		*y = PathY[0];
+		return;
+	}
+	//position on the path in 1/65536 of a segment
+	long long Pos = ( (long long) CurFrame * ( N - 1 ) << 16 ) / ( NFrames - 1 );
+	int Seg = int( Pos >> 16 );
+	if (Seg >= N - 1)
+	{
+		*x = PathX[N - 1];
+		*y = PathY[N - 1];
+		return;
+	}
+	int f = int( Pos & 0xFFFF );
+	*x = PathX[Seg] + int( ( (long long) ( PathX[Seg + 1] - PathX[Seg] ) * f ) >> 16 );
+	*y = PathY[Seg] + int( ( (long long) ( PathY[Seg + 1] - PathY[Seg] ) * f ) >> 16 );
+}
+
+void FB_BeginStage( int Stage )
+{
+	if (Active)
+	{
+		StageStart[Stage] = FB_Clock::now();
+	}
+}
+
+void FB_EndStage( int Stage )
+{
+	if (Active)
+	{
+		std::chrono::duration<double, std::milli> d = FB_Clock::now() - StageStart[Stage];
+		FrameTime[Stage] += d.count();
+	}
+}
+
+bool FB_EndFrame( char* DumpName )
+{
+	if (!Active)
+	{
+		return false;
+	}
+	for (int i = 0; i < FBS_COUNT; i++)
+	{
+		Times[i].push_back( float( FrameTime[i] ) );
+		FrameTime[i] = 0;
+	}
+	OrderHighs.push_back( OrderHigh );
+	bool Dump = DumpStep && CurFrame % DumpStep == 0;
+	if (Dump)
+	{
+		sprintf( DumpName, "bench%04d.bmp", CurFrame );
+	}
+	CurFrame++;
+	if (CurFrame >= NFrames)
+	{
+		Active = false;
+	}
+	return Dump;
+}
+
+//Value below which P percent of the sorted times lie
+static float Percentile( const std::vector<float>& Sorted, int P )
+{
+	if (Sorted.empty())
+	{
+		return 0;
+	}
+	size_t i = ( Sorted.size() - 1 ) * P / 100;
+	return Sorted[i];
+}
+
+bool FB_SaveReport( const char* Name )
+{
+	FILE* F = fopen( Name, "w" );
+	if (!F)
+	{
+		return false;
+	}
+	int N = int( Times[FBS_FRAME].size() );
+	fprintf( F, "save %s frames %d of %d\n", SaveName, N, NFrames );
+	if (!OrderHighs.empty())
+	{
+		double Sum = 0;
+		int Max = 0;
+		for (int h : OrderHighs)
+		{
+			Sum += h;
+			Max = h > Max ? h : Max;
+		}
+		fprintf( F, "orders in use per tick avg %.1f max %d\n", Sum / OrderHighs.size(), Max );
+	}
+	fprintf( F, "frame" );
+	for (int s = 0; s < FBS_COUNT; s++)
+	{
+		fprintf( F, " %s", StageNames[s] );
+	}
+	fprintf( F, "\n" );
+	for (int i = 0; i < N; i++)
+	{
+		fprintf( F, "%d", i );
+		for (int s = 0; s < FBS_COUNT; s++)
+		{
+			fprintf( F, " %.3f", Times[s][i] );
+		}
+		fprintf( F, "\n" );
+	}
+	fprintf( F, "stage avg p50 p95 max\n" );
+	for (int s = 0; s < FBS_COUNT; s++)
+	{
+		std::vector<float> Sorted = Times[s];
+		std::sort( Sorted.begin(), Sorted.end() );
+		double Sum = 0;
+		for (float t : Sorted)
+		{
+			Sum += t;
+		}
+		fprintf( F, "%s %.3f %.3f %.3f %.3f\n", StageNames[s], N ? Sum / N : 0.0,
+			Percentile( Sorted, 50 ), Percentile( Sorted, 95 ), Sorted.empty() ? 0.0f : Sorted.back() );
+	}
+	fclose( F );
+	return true;
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+/*
+	Render benchmark over a saved game.
+
+	The game loads the save, moves the camera along a fixed path of
+	waypoints and measures the drawing stages of every frame. Frames
+	can be dumped as BMP files to compare the output of two builds.
+	Stages are wall-clock times of the calling thread; a stage that is
+	entered several times in one frame is summed. All calls are no-ops
+	while no benchmark is running.
+*/
+
+enum FB_Stage
+{
+	FBS_TERRAIN,	//VirtualScreen refresh (TestTriangle)
+	FBS_OBJECTS,	//ShowZBuffer
+	FBS_FOG,		//fog of war processing and drawing
+	FBS_MINIMAP,	//GMiniShow
+	FBS_FRAME,		//whole DrawAllScreen/FastScreenProcess
+	FBS_COUNT
+};
+
+//Benchmark of NFrames frames over the save SaveName,
+//every DumpStep-th frame is dumped (0 - none)
+void FB_Setup( const char* SaveName, int NFrames, int DumpStep );
+//Camera position (mapx, mapy) of the path, the waypoints are evenly
+//spread over the frames
+void FB_AddWaypoint( int x, int y );
+//Most orders in use during the last game tick, kept with the frame
+void FB_SetOrderHigh( int NOrders );
+
+//Set up but the save is not loaded yet
+bool FB_Pending();
+const char* FB_GetSaveName();
+//Save is loaded, the next drawn frame is frame 0
+void FB_Start();
+bool FB_Active();
+//All frames are done
+bool FB_Finished();
+
+//Camera of the current frame
+void FB_GetCamera( int* x, int* y );
+void FB_BeginStage( int Stage );
+void FB_EndStage( int Stage );
+//Stores the frame times. Returns true and fills DumpName if the frame
+//has to be dumped.
+bool FB_EndFrame( char* DumpName );
+
+//Per-frame times and avg/p50/p95/max of every stage in ms
+bool FB_SaveReport( const char* Name );
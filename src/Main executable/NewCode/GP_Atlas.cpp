@@ -0,0 +1,195 @@
+#include "../cross_platform/platform_compat.h"
+#include "GP_Blit.h"
+#include "GP_Atlas.h"
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <vector>
+
+//Walks the segments of one mask line, see the format in GP_Blit.cpp.
+//Calls Seg( column, pixels ) for every segment and returns the header.
+template <class F>
+static int WalkLine( const byte*& Mask, F Seg )
+{
+	int h = *Mask++;
+	int cx = 0;
+	if (h & 128)
+	{
+		int sm = ( h & 64 ) ? 16 : 0;
+		int pm = ( h & 32 ) ? 16 : 0;
+		for (int s = h & 31; s > 0; s--)
+		{
+			int space = ( *Mask & 15 ) | sm;
+			int n = ( *Mask >> 4 ) | pm;
+			Mask++;
+			Seg( cx + space, n );
+			cx += space + n;
+		}
+	}
+	else
+	{
+		for (int s = h; s > 0; s--)
+		{
+			Seg( cx + Mask[0], Mask[1] );
+			cx += Mask[0] + Mask[1];
+			Mask += 2;
+		}
+	}
+	return h;
+}
+
+void GPA_Build( GPA_Atlas* A, const GP_BlitSprite* Layers, int N, int PageLx )
+{
+	memset( A, 0, sizeof( GPA_Atlas ) );
+	A->NFrames = N;
+	A->Frames = (GPA_Frame*) calloc( N > 0 ? N : 1, sizeof( GPA_Frame ) );
+
+	//columns of the rectangles and the number of the spans
+	int NRows = 0;
+	for (int k = 0; k < N; k++)
+	{
+		const GP_BlitSprite& L = Layers[k];
+		GPA_Frame& F = A->Frames[k];
+		const byte* Mask = L.Mask;
+		int x0 = 0x7FFFFFFF;
+		int x1 = -1;
+		for (int ln = 0; ln < L.NLines; ln++)
+		{
+			WalkLine( Mask, [&]( int x, int n )
+			{
+				if (n)
+				{
+					x0 = x < x0 ? x : x0;
+					x1 = x + n > x1 ? x + n : x1;
+				}
+				A->NSpans++;
+			} );
+		}
+		F.Dx = x1 < 0 ? 0 : x0;
+		F.Lx = x1 < 0 ? 0 : x1 - x0;
+		F.NLines = L.NLines;
+		F.Row = NRows;
+		F.Atlas = A;
+		NRows += L.NLines;
+		if (F.Lx > PageLx)
+		{
+			PageLx = F.Lx;
+		}
+	}
+	A->PageLx = ( PageLx + 15 ) & ~15;
+
+	//shelves, the tallest frames first
+	std::vector<int> Order;
+	for (int k = 0; k < N; k++)
+	{
+		if (A->Frames[k].Lx)
+		{
+			Order.push_back( k );
+		}
+	}
+	std::stable_sort( Order.begin(), Order.end(), [A]( int a, int b )
+	{
+		return A->Frames[a].NLines > A->Frames[b].NLines;
+	} );
+	int ShelfY = 0;
+	int ShelfLy = 0;
+	int x = 0;
+	for (int k : Order)
+	{
+		GPA_Frame& F = A->Frames[k];
+		if (x + F.Lx > A->PageLx)
+		{
+			ShelfY += ShelfLy;
+			ShelfLy = 0;
+			x = 0;
+		}
+		if (!ShelfLy)
+		{
+			ShelfLy = F.NLines;
+		}
+		F.PageX = x;
+		F.PageY = ShelfY;
+		x += F.Lx;
+	}
+	A->PageLy = ShelfY + ShelfLy;
+
+	//the pixels and the spans
+	A->Page = (byte*) calloc( size_t( A->PageLx ) * ( A->PageLy > 0 ? A->PageLy : 1 ), 1 );
+	A->Rows = (int*) malloc( ( NRows + 1 ) * sizeof( int ) );
+	A->Heads = (byte*) malloc( NRows > 0 ? NRows : 1 );
+	A->Spans = (GPA_Span*) malloc( ( A->NSpans > 0 ? A->NSpans : 1 ) * sizeof( GPA_Span ) );
+	int NS = 0;
+	for (int k = 0; k < N; k++)
+	{
+		const GP_BlitSprite& L = Layers[k];
+		GPA_Frame& F = A->Frames[k];
+		const byte* Mask = L.Mask;
+		const byte* Src = L.CData;
+		for (int ln = 0; ln < L.NLines; ln++)
+		{
+			A->Rows[F.Row + ln] = NS;
+			byte* Line = A->Page + size_t( F.PageY + ln ) * A->PageLx + F.PageX;
+			//segments without pixels are kept, they move the checkerboard of the draw
+			int h = WalkLine( Mask, [&]( int x, int n )
+			{
+				if (n)
+				{
+					memcpy( Line + x - F.Dx, Src, n );
+				}
+				A->Spans[NS].x = word( x );
+				A->Spans[NS].n = word( n );
+				NS++;
+				A->NPixels += n;
+				Src += n;
+			} );
+			A->Heads[F.Row + ln] = byte( !h ? GPA_EMPTY : ( h & 128 ) ? GPA_PACKED : GPA_PAIRS );
+		}
+	}
+	A->Rows[NRows] = NS;
+}
+
+void GPA_Free( GPA_Atlas* A )
+{
+	free( A->Page );
+	free( A->Frames );
+	free( A->Rows );
+	free( A->Heads );
+	free( A->Spans );
+	memset( A, 0, sizeof( GPA_Atlas ) );
+}
+
+size_t GPA_Bytes( const GPA_Atlas* A )
+{
+	int NRows = A->NFrames ? A->Frames[A->NFrames - 1].Row + A->Frames[A->NFrames - 1].NLines : 0;
+	return size_t( A->PageLx ) * A->PageLy + A->NFrames * sizeof( GPA_Frame ) +
+		( NRows + 1 ) * sizeof( int ) + NRows + A->NSpans * sizeof( GPA_Span );
+}
+
+int GPA_Check( const GPA_Atlas* A )
+{
+	int Bad = 0;
+	for (int a = 0; a < A->NFrames; a++)
+	{
+		const GPA_Frame& F = A->Frames[a];
+		if (!F.Lx)
+		{
+			continue;
+		}
+		if (F.PageX < 0 || F.PageY < 0 || F.PageX + F.Lx > A->PageLx || F.PageY + F.NLines > A->PageLy)
+		{
+			Bad++;
+			continue;
+		}
+		for (int b = 0; b < a; b++)
+		{
+			const GPA_Frame& G = A->Frames[b];
+			if (G.Lx && F.PageX < G.PageX + G.Lx && G.PageX < F.PageX + F.Lx &&
+				F.PageY < G.PageY + G.NLines && G.PageY < F.PageY + F.NLines)
+			{
+				Bad++;
+				break;
+			}
+		}
+	}
+	return Bad;
+}
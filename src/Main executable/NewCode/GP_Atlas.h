@@ -0,0 +1,77 @@
+#pragma once
+
+/*
+	Atlas of the unpacked layers of a GP file.
+
+	GPA_Build() takes the layers the way GPB_Draw() takes them, a line mask
+	and the unpacked pixels, and packs the pixels of all of them into one
+	indexed colour page. Every frame gets a rectangle of the page: the
+	columns its segments cover and all of its lines. The rectangles are
+	placed on shelves, the tallest frames first.
+
+	The segments of every line are kept as run-length spans (column,
+	pixels), and every line knows its first span and the kind of its
+	header. So a draw clipped at the top starts right at its first visible
+	line and never parses the mask. The pixels between the spans are 0 and
+	are never read.
+
+	A GP_BlitSprite with Frame set draws the frame instead of the mask;
+	GPB_Draw() gives the same pixels as for the layer it was made of.
+*/
+
+//The game headers leave pack(1) on, the module is built without it
+#pragma pack(push)
+#pragma pack()
+
+struct GP_BlitSprite;
+
+struct GPA_Span
+{
+	word x;		//first column, relative to the layer
+	word n;		//pixels, can be 0
+};
+
+//GPA_Atlas::Heads, the header of a line of the mask
+#define GPA_EMPTY 0		//no segments
+#define GPA_PAIRS 1		//(space, pixels) byte pairs
+#define GPA_PACKED 2	//packed nibbles
+
+struct GPA_Frame
+{
+	//rectangle of the page, Dx is the column of the layer at PageX
+	int PageX;
+	int PageY;
+	int Dx;
+	int Lx;
+	int NLines;
+	//the spans of line i are Spans[Rows[Row+i]]..Spans[Rows[Row+i+1]-1],
+	//its header is Heads[Row+i]
+	int Row;
+	const struct GPA_Atlas* Atlas;
+};
+
+struct GPA_Atlas
+{
+	int PageLx;
+	int PageLy;
+	byte* Page;
+	int NFrames;
+	GPA_Frame* Frames;
+	int* Rows;
+	byte* Heads;
+	GPA_Span* Spans;
+	int NSpans;
+	//pixels of the spans, to compare with the size of the page
+	int NPixels;
+};
+
+//Packs N layers into a page at least PageLx wide, the x and y of the
+//sprites are not used. Frame k of the atlas is layer k.
+void GPA_Build( GPA_Atlas* A, const GP_BlitSprite* Layers, int N, int PageLx );
+void GPA_Free( GPA_Atlas* A );
+//Bytes of the page and of the tables
+size_t GPA_Bytes( const GPA_Atlas* A );
+//Rectangles that overlap or leave the page, 0 for a good atlas
+int GPA_Check( const GPA_Atlas* A );
+
+#pragma pack(pop)
@@ -0,0 +1,126 @@
+#include "../cross_platform/platform_compat.h"
+#include "GP_Bands.h"
+#include "GP_Blit.h"
+#include "JobPool.h"
+
+int GPB_NBands = 0;
+
+struct GPB_Command
+{
+	GP_BlitTarget T;
+	GP_BlitSprite S;
+	const byte* Table;
+	int Mode;
+	bool Inv;
+	//screen rows the command may write
+	int Y0;
+	int Y1;
+};
+
+static std::vector<GPB_Command> Commands;
+static bool Recording = false;
+//rows of all recorded commands
+static int MinY;
+static int MaxY;
+
+struct GPB_BandJob
+{
+	int Y0;
+	int NRows;
+	int NBands;
+
+	void operator()( int Index )
+	{
+		GP_BlitTarget T;
+		int b0 = Y0 + int( (long long) NRows * Index / NBands );
+		int b1 = Y0 + int( (long long) NRows * ( Index + 1 ) / NBands ) - 1;
+		int N = int( Commands.size() );
+		for (int i = 0; i < N; i++)
+		{
+			const GPB_Command& C = Commands[i];
+			if (C.Y1 < b0 || C.Y0 > b1)
+			{
+				continue;
+			}
+			T = C.T;
+			T.BandY = b0 > T.BandY ? b0 : T.BandY;
+			T.BandY1 = b1 < T.BandY1 ? b1 : T.BandY1;
+			GPB_Draw( &T, C.Mode, C.Inv, &C.S, C.Table, nullptr );
+		}
+	}
+};
+
+void GPB_BeginBands()
+{
+	Commands.clear();
+	Recording = true;
+}
+
+void GPB_EndBands()
+{
+	GPB_FlushBands();
+	Recording = false;
+}
+
+bool GPB_Recording()
+{
+	return Recording;
+}
+
+void GPB_Record( const GP_BlitTarget* T, int Mode, bool Inv, const GP_BlitSprite* S, const byte* Table )
+{
+	GPB_Command C;
+	C.T = *T;
+	C.S = *S;
+	C.Table = Table;
+	C.Mode = Mode;
+	C.Inv = Inv;
+	C.Y0 = S->y > T->BandY ? S->y : T->BandY;
+	C.Y1 = S->y + S->NLines - 1 < T->BandY1 ? S->y + S->NLines - 1 : T->BandY1;
+	if (C.Y0 > C.Y1)
+	{
+		return;
+	}
+	if (Commands.empty())
+	{
+		MinY = C.Y0;
+		MaxY = C.Y1;
+	}
+	else
+	{
+		MinY = C.Y0 < MinY ? C.Y0 : MinY;
+		MaxY = C.Y1 > MaxY ? C.Y1 : MaxY;
+	}
+	Commands.push_back( C );
+}
+
+void GPB_FlushBands()
+{
+	if (Commands.empty())
+	{
+		return;
+	}
+
+	GPB_BandJob Job;
+	Job.Y0 = MinY;
+	Job.NRows = MaxY - MinY + 1;
+	Job.NBands = GPB_NBands > 0 ? GPB_NBands : JOBS.GetNThreads() * 2;
+	if (Job.NBands > Job.NRows)
+	{
+		Job.NBands = Job.NRows;
+	}
+	//a few small sprites are not worth waking the workers
+	if (Job.NBands <= 1 || Commands.size() < 4)
+	{
+		for (size_t i = 0; i < Commands.size(); i++)
+		{
+			const GPB_Command& C = Commands[i];
+			GPB_Draw( &C.T, C.Mode, C.Inv, &C.S, C.Table, nullptr );
+		}
+	}
+	else
+	{
+		JOBS.ParallelFor( Job.NBands, Job );
+	}
+	Commands.clear();
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+/*
+	Banded drawing of the masked GP layers.
+
+	Between GPB_BeginBands() and GPB_EndBands() the layers passed to
+	GPB_Record() are not drawn but stored with their own blit target.
+	GPB_FlushBands() splits the rows of the recorded targets into
+	horizontal bands and draws every band on a JobPool worker: each band
+	replays, in order, the commands that cross it, with the band rows as
+	the write limit of the target. Bands never share a screen row, so the
+	result is the same as the serial drawing.
+
+	Everything that draws into the screen without GPB_Record() has to call
+	GPB_FlushBands() first. The sprite data and tables of the recorded
+	commands must stay valid until the flush.
+*/
+
+//The game headers leave pack(1) on, the module is built without it
+#pragma pack(push)
+#pragma pack()
+
+struct GP_BlitTarget;
+struct GP_BlitSprite;
+
+//Number of bands, 0 - two per thread, 1 - serial drawing
+extern int GPB_NBands;
+
+void GPB_BeginBands();
+void GPB_EndBands();
+//True between GPB_BeginBands() and GPB_EndBands()
+bool GPB_Recording();
+//Stores one GPB_Draw() call; the water reflection (WShift) is never recorded
+void GPB_Record( const GP_BlitTarget* T, int Mode, bool Inv, const GP_BlitSprite* S, const byte* Table );
+//Draws and drops the recorded commands
+void GPB_FlushBands();
+
+#pragma pack(pop)
@@ -0,0 +1,795 @@
+#include "../cross_platform/platform_compat.h"
+#include "GP_Blit.h"
+#include "GP_Atlas.h"
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+#define GPB_X86
+#include <emmintrin.h>
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define GPB_TARGET_SSE2
+#define GPB_TARGET_AVX2
+#else
+#include <cpuid.h>
+#define GPB_TARGET_SSE2 __attribute__( ( target( "sse2" ) ) )
+#define GPB_TARGET_AVX2 __attribute__( ( target( "avx2" ) ) )
+#endif
+#endif
+
+/*
+	Scalar kernels. Reference behaviour of the old __asm variation zones.
+*/
+static void CopyScalar( byte* Dst, const byte* Src, int N, const byte*, int )
+{
+	memcpy( Dst, Src, N );
+}
+
+static void ShadowScalar( byte* Dst, const byte*, int N, const byte* Table, int )
+{
+	for (int i = 0; i < N; i++)
+	{
+		Dst[i] = Table[Dst[i]];
+	}
+}
+
+//Pixel i is cleared when (Parity+i) is odd
+static void OverpointScalar( byte* Dst, const byte*, int N, const byte*, int Parity )
+{
+	for (int i = Parity ? 0 : 1; i < N; i += 2)
+	{
+		Dst[i] = 0;
+	}
+}
+
+static void PalScalar( byte* Dst, const byte* Src, int N, const byte* Table, int )
+{
+	for (int i = 0; i < N; i++)
+	{
+		Dst[i] = Table[Src[i]];
+	}
+}
+
+static void MultiPalScalar( byte* Dst, const byte* Src, int N, const byte* Table, int )
+{
+	for (int i = 0; i < N; i++)
+	{
+		Dst[i] = Table[( Src[i] << 8 ) + Dst[i]];
+	}
+}
+
+static void MultiPalTScalar( byte* Dst, const byte* Src, int N, const byte* Table, int )
+{
+	for (int i = 0; i < N; i++)
+	{
+		Dst[i] = Table[( Dst[i] << 8 ) + Src[i]];
+	}
+}
+
+static void MirrorScalar( byte* Dst, const byte* Src, int N, const byte* Table, int NWater )
+{
+	for (int i = 0; i < N; i++)
+	{
+		unsigned int w = byte( Dst[i] - 0xB0 );
+		if (w < unsigned( NWater ))
+		{
+			Dst[i] = Table[( w << 8 ) + Src[i]];
+		}
+	}
+}
+
+static void ReverseScalar( byte* Dst, const byte* Src, int N )
+{
+	for (int i = 0; i < N; i++)
+	{
+		Dst[i] = Src[N - 1 - i];
+	}
+}
+
+static const GP_KernelSet ScalarKernels =
+{
+	"scalar",
+	{ CopyScalar, ShadowScalar, OverpointScalar, PalScalar, MultiPalScalar, MultiPalTScalar, MirrorScalar },
+	ReverseScalar
+};
+
+#ifdef GPB_X86
+/*
+	SSE2 kernels. SSE2 has no byte gather, so the table modes stay scalar
+	and only the straight copies, the checkerboard and the water test are vectorized.
+*/
+GPB_TARGET_SSE2 static void CopySSE2( byte* Dst, const byte* Src, int N, const byte*, int )
+{
+	int i = 0;
+	for (; i + 16 <= N; i += 16)
+	{
+		_mm_storeu_si128( (__m128i*) ( Dst + i ), _mm_loadu_si128( (const __m128i*) ( Src + i ) ) );
+	}
+	for (; i < N; i++)
+	{
+		Dst[i] = Src[i];
+	}
+}
+
+GPB_TARGET_SSE2 static void OverpointSSE2( byte* Dst, const byte*, int N, const byte*, int Parity )
+{
+	//keep even bytes for parity 0, odd bytes for parity 1
+	__m128i keep = _mm_set1_epi16( Parity ? short( 0xFF00 ) : short( 0x00FF ) );
+	int i = 0;
+	for (; i + 16 <= N; i += 16)
+	{
+		__m128i v = _mm_loadu_si128( (const __m128i*) ( Dst + i ) );
+		_mm_storeu_si128( (__m128i*) ( Dst + i ), _mm_and_si128( v, keep ) );
+	}
+	OverpointScalar( Dst + i, nullptr, N - i, nullptr, Parity );
+}
+
+GPB_TARGET_SSE2 static void MirrorSSE2( byte* Dst, const byte* Src, int N, const byte* Table, int NWater )
+{
+	__m128i base = _mm_set1_epi8( char( 0xB0 ) );
+	__m128i last = _mm_set1_epi8( char( NWater - 1 ) );
+	int i = 0;
+	for (; i + 16 <= N; i += 16)
+	{
+		__m128i w = _mm_sub_epi8( _mm_loadu_si128( (const __m128i*) ( Dst + i ) ), base );
+		int water = _mm_movemask_epi8( _mm_cmpeq_epi8( _mm_min_epu8( w, last ), w ) );
+		while (water)
+		{
+			int k = 0;
+			while (!( water & ( 1 << k ) ))
+			{
+				k++;
+			}
+			water &= ~( 1 << k );
+			Dst[i + k] = Table[( ( Dst[i + k] - 0xB0 ) << 8 ) + Src[i + k]];
+		}
+	}
+	MirrorScalar( Dst + i, Src + i, N - i, Table, NWater );
+}
+
+GPB_TARGET_SSE2 static inline __m128i Reverse16( __m128i v )
+{
+	v = _mm_shuffle_epi32( v, _MM_SHUFFLE( 0, 1, 2, 3 ) );
+	v = _mm_shufflelo_epi16( v, _MM_SHUFFLE( 2, 3, 0, 1 ) );
+	v = _mm_shufflehi_epi16( v, _MM_SHUFFLE( 2, 3, 0, 1 ) );
+	return _mm_or_si128( _mm_slli_epi16( v, 8 ), _mm_srli_epi16( v, 8 ) );
+}
+
+GPB_TARGET_SSE2 static void ReverseSSE2( byte* Dst, const byte* Src, int N )
+{
+	int i = 0;
+	for (; i + 16 <= N; i += 16)
+	{
+		__m128i v = _mm_loadu_si128( (const __m128i*) ( Src + N - 16 - i ) );
+		_mm_storeu_si128( (__m128i*) ( Dst + i ), Reverse16( v ) );
+	}
+	for (; i < N; i++)
+	{
+		Dst[i] = Src[N - 1 - i];
+	}
+}
+
+static const GP_KernelSet SSE2Kernels =
+{
+	"sse2",
+	{ CopySSE2, ShadowScalar, OverpointSSE2, PalScalar, MultiPalScalar, MultiPalTScalar, MirrorSSE2 },
+	ReverseSSE2
+};
+
+/*
+	AVX2 kernels. The colour tables are read with 32-bit gathers from
+	dword-aligned addresses, so a gather never leaves the dword that holds
+	the wanted byte even at the very end of a table.
+*/
+GPB_TARGET_AVX2 static void CopyAVX2( byte* Dst, const byte* Src, int N, const byte*, int )
+{
+	int i = 0;
+	for (; i + 32 <= N; i += 32)
+	{
+		_mm256_storeu_si256( (__m256i*) ( Dst + i ), _mm256_loadu_si256( (const __m256i*) ( Src + i ) ) );
+	}
+	if (i + 16 <= N)
+	{
+		_mm_storeu_si128( (__m128i*) ( Dst + i ), _mm_loadu_si128( (const __m128i*) ( Src + i ) ) );
+		i += 16;
+	}
+	for (; i < N; i++)
+	{
+		Dst[i] = Src[i];
+	}
+}
+
+GPB_TARGET_AVX2 static void OverpointAVX2( byte* Dst, const byte*, int N, const byte*, int Parity )
+{
+	__m256i keep = _mm256_set1_epi16( Parity ? short( 0xFF00 ) : short( 0x00FF ) );
+	int i = 0;
+	for (; i + 32 <= N; i += 32)
+	{
+		__m256i v = _mm256_loadu_si256( (const __m256i*) ( Dst + i ) );
+		_mm256_storeu_si256( (__m256i*) ( Dst + i ), _mm256_and_si256( v, keep ) );
+	}
+	OverpointScalar( Dst + i, nullptr, N - i, nullptr, Parity );
+}
+
+//8 table bytes at byte offsets Idx from the dword-aligned table base
+GPB_TARGET_AVX2 static inline __m256i Gather8( const byte* TBase, __m256i Idx )
+{
+	__m256i w = _mm256_i32gather_epi32( (const int*) TBase,
+		_mm256_andnot_si256( _mm256_set1_epi32( 3 ), Idx ), 1 );
+	__m256i sh = _mm256_slli_epi32( _mm256_and_si256( Idx, _mm256_set1_epi32( 3 ) ), 3 );
+	return _mm256_and_si256( _mm256_srlv_epi32( w, sh ), _mm256_set1_epi32( 0xFF ) );
+}
+
+//Packs two vectors of 8 dwords (values 0..255) into 16 ordered bytes
+GPB_TARGET_AVX2 static inline __m128i Pack16( __m256i a, __m256i b )
+{
+	__m256i p = _mm256_permute4x64_epi64( _mm256_packus_epi32( a, b ), _MM_SHUFFLE( 3, 1, 2, 0 ) );
+	p = _mm256_permute4x64_epi64( _mm256_packus_epi16( p, p ), _MM_SHUFFLE( 3, 1, 2, 0 ) );
+	return _mm256_castsi256_si128( p );
+}
+
+//Table modes, 16 pixels per step. Mode is a compile-time constant.
+template<int Mode>
+GPB_TARGET_AVX2 static void LookupAVX2( byte* Dst, const byte* Src, int N, const byte* Table, int Param )
+{
+	const byte* TBase = (const byte*) ( uintptr_t( Table ) & ~uintptr_t( 3 ) );
+	__m256i ofs = _mm256_set1_epi32( int( Table - TBase ) );
+	__m256i wbase = _mm256_set1_epi32( 0xB0 );
+	__m256i wlast = _mm256_set1_epi32( Param - 1 );
+	int i = 0;
+	for (; i + 16 <= N; i += 16)
+	{
+		__m128i d = _mm_loadu_si128( (const __m128i*) ( Dst + i ) );
+		__m256i d0 = _mm256_cvtepu8_epi32( d );
+		__m256i d1 = _mm256_cvtepu8_epi32( _mm_srli_si128( d, 8 ) );
+		__m256i s0 = d0;
+		__m256i s1 = d1;
+		if (Mode != GPB_SHADOW)
+		{
+			__m128i s = _mm_loadu_si128( (const __m128i*) ( Src + i ) );
+			s0 = _mm256_cvtepu8_epi32( s );
+			s1 = _mm256_cvtepu8_epi32( _mm_srli_si128( s, 8 ) );
+		}
+		__m256i i0, i1;
+		__m256i w0 = _mm256_setzero_si256();
+		__m256i w1 = w0;
+		switch (Mode)
+		{
+		case GPB_SHADOW:
+			i0 = d0;
+			i1 = d1;
+			break;
+		case GPB_PAL:
+			i0 = s0;
+			i1 = s1;
+			break;
+		case GPB_MULTIPAL:
+			i0 = _mm256_or_si256( _mm256_slli_epi32( s0, 8 ), d0 );
+			i1 = _mm256_or_si256( _mm256_slli_epi32( s1, 8 ), d1 );
+			break;
+		case GPB_MULTIPALT:
+			i0 = _mm256_or_si256( _mm256_slli_epi32( d0, 8 ), s0 );
+			i1 = _mm256_or_si256( _mm256_slli_epi32( d1, 8 ), s1 );
+			break;
+		default://GPB_MIRROR
+			w0 = _mm256_sub_epi32( d0, wbase );
+			w1 = _mm256_sub_epi32( d1, wbase );
+			//water lanes: 0<=w<=NWater-1, everything else reads Table[0]
+			w0 = _mm256_andnot_si256( _mm256_or_si256( _mm256_cmpgt_epi32( w0, wlast ),
+				_mm256_srai_epi32( w0, 31 ) ), _mm256_set1_epi32( -1 ) );
+			w1 = _mm256_andnot_si256( _mm256_or_si256( _mm256_cmpgt_epi32( w1, wlast ),
+				_mm256_srai_epi32( w1, 31 ) ), _mm256_set1_epi32( -1 ) );
+			if (!_mm256_movemask_epi8( _mm256_or_si256( w0, w1 ) ))
+			{
+				continue;
+			}
+			i0 = _mm256_and_si256( w0, _mm256_or_si256( _mm256_slli_epi32( _mm256_sub_epi32( d0, wbase ), 8 ), s0 ) );
+			i1 = _mm256_and_si256( w1, _mm256_or_si256( _mm256_slli_epi32( _mm256_sub_epi32( d1, wbase ), 8 ), s1 ) );
+			break;
+		}
+		__m256i r0 = Gather8( TBase, _mm256_add_epi32( i0, ofs ) );
+		__m256i r1 = Gather8( TBase, _mm256_add_epi32( i1, ofs ) );
+		if (Mode == GPB_MIRROR)
+		{
+			r0 = _mm256_blendv_epi8( d0, r0, w0 );
+			r1 = _mm256_blendv_epi8( d1, r1, w1 );
+		}
+		_mm_storeu_si128( (__m128i*) ( Dst + i ), Pack16( r0, r1 ) );
+	}
+	if (i < N)
+	{
+		ScalarKernels.Span[Mode]( Dst + i, Src ? Src + i : nullptr, N - i, Table, Param );
+	}
+}
+
+static const GP_KernelSet AVX2Kernels =
+{
+	"avx2",
+	{ CopyAVX2, LookupAVX2<GPB_SHADOW>, OverpointAVX2, LookupAVX2<GPB_PAL>,
+	LookupAVX2<GPB_MULTIPAL>, LookupAVX2<GPB_MULTIPALT>, LookupAVX2<GPB_MIRROR> },
+	ReverseSSE2
+};
+
+static void CpuId( int Leaf, int* Regs )
+{
+#ifdef _MSC_VER
+	__cpuidex( Regs, Leaf, 0 );
+#else
+	unsigned int a = 0, b = 0, c = 0, d = 0;
+	__cpuid_count( Leaf, 0, a, b, c, d );
+	Regs[0] = a;
+	Regs[1] = b;
+	Regs[2] = c;
+	Regs[3] = d;
+#endif
+}
+
+//AVX2 needs the CPU flag and the OS saving the YMM state
+static bool HasAVX2()
+{
+	int r[4];
+	CpuId( 0, r );
+	if (r[0] < 7)
+	{
+		return false;
+	}
+	CpuId( 1, r );
+	const int OSXSAVE = 1 << 27;
+	const int AVX = 1 << 28;
+	if (( r[2] & ( OSXSAVE | AVX ) ) != ( OSXSAVE | AVX ))
+	{
+		return false;
+	}
+#ifdef _MSC_VER
+	unsigned long long xcr0 = _xgetbv( 0 );
+#else
+	unsigned int lo, hi;
+	__asm__ __volatile__( "xgetbv" : "=a"( lo ), "=d"( hi ) : "c"( 0 ) );
+	unsigned long long xcr0 = ( (unsigned long long) hi << 32 ) | lo;
+#endif
+	if (( xcr0 & 6 ) != 6)
+	{
+		return false;
+	}
+	CpuId( 7, r );
+	return 0 != ( r[1] & ( 1 << 5 ) );
+}
+
+static bool HasSSE2()
+{
+	int r[4];
+	CpuId( 1, r );
+	return 0 != ( r[3] & ( 1 << 26 ) );
+}
+#endif //GPB_X86
+
+const GP_KernelSet* GPB_Kernels = &ScalarKernels;
+
+bool GPB_SelectKernels( const char* Name )
+{
+	if (!strcmp( Name, "scalar" ))
+	{
+		GPB_Kernels = &ScalarKernels;
+		return true;
+	}
+#ifdef GPB_X86
+	if (!strcmp( Name, "sse2" ) && HasSSE2())
+	{
+		GPB_Kernels = &SSE2Kernels;
+		return true;
+	}
+	if (!strcmp( Name, "avx2" ) && HasAVX2())
+	{
+		GPB_Kernels = &AVX2Kernels;
+		return true;
+	}
+#endif
+	return false;
+}
+
+void GPB_Init()
+{
+	if (!GPB_SelectKernels( "avx2" ) && !GPB_SelectKernels( "sse2" ))
+	{
+		GPB_SelectKernels( "scalar" );
+	}
+}
+
+/*
+	Line mask decoder.
+	Line header byte H:
+	  H&128 == 0: H segments of 2 bytes (space, pixels)
+	  H&128 != 0: H&31 segments of 1 byte, space=low nibble, pixels=high nibble,
+	              +16 to every space if H&64, +16 to every pixel count if H&32
+*/
+
+//Skips one line of the mask, returns the number of pixels it holds
+static int SkipLine( const byte*& Mask )
+{
+	int h = *Mask++;
+	int n = 0;
+	if (h & 128)
+	{
+		int pm = ( h & 32 ) ? 16 : 0;
+		for (int s = h & 31; s > 0; s--)
+		{
+			n += ( *Mask++ >> 4 ) | pm;
+		}
+	}
+	else
+	{
+		for (int s = h; s > 0; s--)
+		{
+			n += Mask[1];
+			Mask += 2;
+		}
+	}
+	return n;
+}
+
+/*
+	Line readers of DrawLines(). Skip() passes a line and returns true if
+	it is not empty, Begin() returns the number of segments of the next
+	line or -1 if it is empty and sets complex for a packed header, Next()
+	gives the column of a segment relative to the sprite x, its pixels and
+	its first pixel.
+*/
+
+//Lines of a mask and its pixel data
+struct MaskLines
+{
+	const byte* Mask;
+	const byte* CData;
+	int CDPos;
+	int cx;
+	int sm;
+	int pm;
+	bool complex;
+
+	bool Skip()
+	{
+		bool Drawn = *Mask != 0;
+		CDPos += SkipLine( Mask );
+		return Drawn;
+	}
+
+	void SkipN( int N )
+	{
+		for (int i = 0; i < N; i++)
+		{
+			CDPos += SkipLine( Mask );
+		}
+	}
+
+	int Begin()
+	{
+		int h = *Mask++;
+		if (!h)
+		{
+			return -1;
+		}
+		cx = 0;
+		complex = 0 != ( h & 128 );
+		if (complex)
+		{
+			sm = ( h & 64 ) ? 16 : 0;
+			pm = ( h & 32 ) ? 16 : 0;
+			return h & 31;
+		}
+		return h;
+	}
+
+	void Next( int& o, int& n, const byte*& Src )
+	{
+		int space;
+		if (complex)
+		{
+			space = ( *Mask & 15 ) | sm;
+			n = ( *Mask >> 4 ) | pm;
+			Mask++;
+		}
+		else
+		{
+			space = Mask[0];
+			n = Mask[1];
+			Mask += 2;
+		}
+		cx += space;
+		o = cx;
+		Src = CData ? CData + CDPos : nullptr;
+		CDPos += n;
+		cx += n;
+	}
+};
+
+//Lines of an atlas frame
+struct AtlasLines
+{
+	const int* Row;
+	const byte* Head;
+	const GPA_Span* Spans;
+	const GPA_Span* Sp;
+	const byte* Line;
+	const byte* Cur;
+	int Pitch;
+	int Dx;
+	bool complex;
+
+	bool Skip()
+	{
+		bool Drawn = *Head != GPA_EMPTY;
+		Row++;
+		Head++;
+		Line += Pitch;
+		return Drawn;
+	}
+
+	void SkipN( int N )
+	{
+		Row += N;
+		Head += N;
+		Line += N * Pitch;
+	}
+
+	int Begin()
+	{
+		int h = *Head++;
+		int n = Row[1] - Row[0];
+		Sp = Spans + Row[0];
+		Row++;
+		Cur = Line;
+		Line += Pitch;
+		complex = h == GPA_PACKED;
+		return h != GPA_EMPTY ? n : -1;
+	}
+
+	void Next( int& o, int& n, const byte*& Src )
+	{
+		o = Sp->x;
+		n = Sp->n;
+		Src = Cur + o - Dx;
+		Sp++;
+	}
+};
+
+//Paths of the old blitters, see DrawLines()
+enum
+{
+	PATH_INSIDE,
+	PATH_LEFT,
+	PATH_RIGHT
+};
+
+template <class Lines>
+static void DrawLines( const GP_BlitTarget* T, int Mode, bool Inv, const GP_BlitSprite* S,
+	const byte* Table, const int* WShift, Lines& L )
+{
+	int x = S->x;
+	int y = S->y;
+	int NLines = S->NLines;
+	if (Inv)
+	{
+		if (y + NLines <= T->WindY || x - S->Lx >= T->WindX1 || x < T->WindX || y > T->WindY1)
+		{
+			return;
+		}
+	}
+	else
+	{
+		if (y + NLines <= T->WindY || x + S->Lx <= T->WindX || x > T->WindX1 || y > T->WindY1)
+		{
+			return;
+		}
+	}
+
+	if (y + NLines <= T->BandY || y > T->BandY1)
+	{
+		return;
+	}
+
+	//checkerboard line counter
+	int OCNTR = y;
+
+	//top clipper
+	if (y < T->WindY)
+	{
+		int skip = T->WindY - y;
+		L.SkipN( skip );
+		NLines -= skip;
+		y = T->WindY;
+		OCNTR = T->WindY;
+	}
+	//bottom clipper
+	if (y + NLines > T->WindY1)
+	{
+		NLines = T->WindY1 - y + 1;
+	}
+
+	//The old blitters had one path for a sprite inside of the window and
+	//one for each clipped edge; the forward ones tried the left edge first,
+	//the mirrored ones the right one, the water reflection took a clipped
+	//path 10 columns before the edge. A sprite over both edges was only
+	//clipped at one of them, here it is clipped at both. The checkerboard
+	//counter went on by the segments the path reached, that is kept.
+	int Margin = Mode == GPB_MIRROR ? 10 : 0;
+	int Left = Inv ? x - S->Lx + 1 : x;
+	int Right = Inv ? x : x + S->Lx - 1;
+	int Path = PATH_INSIDE;
+	if (Left < T->WindX + Margin || Right > T->WindX1 - Margin)
+	{
+		if (Inv)
+		{
+			Path = Right > T->WindX1 - Margin ? PATH_RIGHT : PATH_LEFT;
+		}
+		else
+		{
+			Path = Left < T->WindX + Margin ? PATH_LEFT : PATH_RIGHT;
+		}
+	}
+
+	//The old unclipped forward water reflection tested 11 water colours
+	//instead of 12; kept so the output stays bit-identical.
+	int Param = 12;
+	if (Mode == GPB_MIRROR && !Inv && Path == PATH_INSIDE)
+	{
+		Param = 11;
+	}
+
+	const GP_KernelSet* K = GPB_Kernels;
+	GP_SpanKernel Span = K->Span[Mode];
+	bool ReadsSprite = Mode != GPB_SHADOW && Mode != GPB_OVERPOINT;
+	bool Checker = Mode == GPB_OVERPOINT;
+	byte Rev[256];
+	int Shift = 0;
+
+	//Walks one line, draws it at Row if Draw is set
+	auto DoLine = [&]( byte* Row, bool Draw )
+	{
+		int nseg = L.Begin();
+		if (nseg < 0)
+		{
+			return;
+		}
+		//sprite columns [lo,hi] land in the window
+		int lo = T->WindX - Shift;
+		int hi = T->WindX1 - Shift;
+		bool Any = nseg > 0;
+		//the old path reached the drawing of the last segment
+		bool Reached = true;
+		for (; nseg > 0; nseg--)
+		{
+			int o, n;
+			const byte* Src;
+			L.Next( o, n, Src );
+			//[a,b] - visible screen columns of the segment
+			int a, b;
+			if (Inv)
+			{
+				a = x - o - n + 1;
+				b = x - o;
+			}
+			else
+			{
+				a = x + o;
+				b = x + o + n - 1;
+			}
+			if (Checker)
+			{
+				if (Path == PATH_LEFT)
+				{
+					Reached = a + ( n ? n : 1 ) > T->WindX;
+				}
+				else if (Path == PATH_RIGHT)
+				{
+					Reached = a <= T->WindX1;
+				}
+			}
+			if (a < lo)
+			{
+				a = lo;
+			}
+			if (b > hi)
+			{
+				b = hi;
+			}
+			if (Draw && a <= b)
+			{
+				int cnt = b - a + 1;
+				if (ReadsSprite)
+				{
+					if (Inv)
+					{
+						//screen column p shows sprite pixel x-o-p of the segment
+						K->Reverse( Rev, Src + ( x - o - b ), cnt );
+						Src = Rev;
+					}
+					else
+					{
+						Src += a - ( x + o );
+					}
+				}
+				byte* Dst = Row + a + Shift;
+				int prm = Param;
+				if (Checker)
+				{
+					prm = int( ( unsigned( OCNTR ) + unsigned( uintptr_t( Dst ) ) ) & 1 );
+				}
+				Span( Dst, Src, cnt, Table, prm );
+			}
+			//the right clipped path counted the segments of a simple line
+			if (Checker && Path == PATH_RIGHT && !L.complex && Reached)
+			{
+				OCNTR++;
+			}
+		}
+		if (Path == PATH_INSIDE || ( Path == PATH_LEFT && Reached ) ||
+			( Path == PATH_RIGHT && L.complex && Any && Reached ))
+		{
+			OCNTR++;
+		}
+	};
+
+	int ln = 0;
+	//lines above the band are only walked: the pixel data offset, the
+	//checkerboard counter and the water shift go on as if they were drawn
+	for (; ln < NLines && y + ln < T->BandY; ln++)
+	{
+		if (WShift)
+		{
+			Shift += WShift[ln];
+		}
+		if (Checker && Path != PATH_INSIDE)
+		{
+			DoLine( nullptr, false );
+		}
+		else if (L.Skip())
+		{
+			OCNTR++;
+		}
+	}
+	if (y + NLines > T->BandY1 + 1)
+	{
+		NLines = T->BandY1 - y + 1;
+	}
+
+	byte* Line = T->Screen + ( y + ln ) * T->Pitch;
+	for (; ln < NLines; ln++, Line += T->Pitch)
+	{
+		if (WShift)
+		{
+			Shift += WShift[ln];
+		}
+		DoLine( Line, true );
+	}
+}
+
+void GPB_Draw( const GP_BlitTarget* T, int Mode, bool Inv, const GP_BlitSprite* S,
+	const byte* Table, const int* WShift )
+{
+	//the old mirrored overpoint blitter drew a plain shadow
+	if (Mode == GPB_OVERPOINT && Inv)
+	{
+		Mode = GPB_SHADOW;
+	}
+	if (S->Frame)
+	{
+		const GPA_Frame* F = S->Frame;
+		const GPA_Atlas* A = F->Atlas;
+		AtlasLines L;
+		L.Row = A->Rows + F->Row;
+		L.Head = A->Heads + F->Row;
+		L.Spans = A->Spans;
+		L.Pitch = A->PageLx;
+		L.Dx = F->Dx;
+		L.Line = A->Page + size_t( F->PageY ) * A->PageLx + F->PageX;
+		DrawLines( T, Mode, Inv, S, Table, WShift, L );
+	}
+	else
+	{
+		MaskLines L;
+		L.Mask = S->Mask;
+		L.CData = S->CData;
+		L.CDPos = 0;
+		DrawLines( T, Mode, Inv, S, Table, WShift, L );
+	}
+}
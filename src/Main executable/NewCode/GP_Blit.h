@@ -0,0 +1,88 @@
+#pragma once
+
+/*
+	Portable kernels for the GP_ShowMasked* sprite blitters.
+
+	The masked GP format stores every sprite line as a list of (space, pixels)
+	segments right after the 23-byte GP_Header. GPB_Draw() walks that list,
+	clips it against a GP_BlitTarget and hands every visible span to a span
+	kernel of the requested blend mode. The kernel set (scalar, SSE2 or AVX2)
+	is picked once by GPB_Init() from the CPU features.
+*/
+
+//The game headers leave pack(1) on, the module is built without it
+#pragma pack(push)
+#pragma pack()
+
+//Size of the packed GP_Header in the file; line masks start right after it
+#define GP_HEADER_SIZE 23
+
+//Destination surface and inclusive clip window.
+//BandY..BandY1 limits the rows that are written without moving the window,
+//so a sprite drawn band by band gives the same pixels as drawn at once.
+struct GP_BlitTarget
+{
+	byte* Screen;
+	int Pitch;
+	int WindX;
+	int WindY;
+	int WindX1;
+	int WindY1;
+	int BandY;
+	int BandY1;
+};
+
+struct GPA_Frame;
+
+//One frame layer of a GP picture, already shifted by its dx/dy.
+//With Frame set the lines come from that atlas frame (NewCode/GP_Atlas.h)
+//and Mask and CData are not used.
+struct GP_BlitSprite
+{
+	int x;
+	int y;
+	int Lx;
+	int NLines;
+	const byte* Mask;
+	const byte* CData;
+	const GPA_Frame* Frame;
+};
+
+enum GP_BlitMode
+{
+	GPB_COPY,		//Screen = Sprite
+	GPB_SHADOW,		//Screen = Table[Screen]
+	GPB_OVERPOINT,	//Screen = 0 on every second pixel (checkerboard), mirrored as GPB_SHADOW
+	GPB_PAL,		//Screen = Table[Sprite]
+	GPB_MULTIPAL,	//Screen = Table[Sprite*256+Screen]
+	GPB_MULTIPALT,	//Screen = Table[Screen*256+Sprite]
+	GPB_MIRROR,		//water pixels: Screen = Table[(Screen-0xB0)*256+Sprite]
+	GPB_NMODES
+};
+
+//Span kernel: N pixels from left to right.
+//Param is the checkerboard parity for GPB_OVERPOINT and
+//the number of water colours for GPB_MIRROR.
+typedef void( *GP_SpanKernel )( byte* Dst, const byte* Src, int N, const byte* Table, int Param );
+
+struct GP_KernelSet
+{
+	const char* Name;
+	GP_SpanKernel Span[GPB_NMODES];
+	//Dst[i]=Src[N-1-i], used by the inverted (mirrored) sprites
+	void( *Reverse )( byte* Dst, const byte* Src, int N );
+};
+
+//Kernel sets available on this CPU; GPB_Init() picks the widest one
+extern const GP_KernelSet* GPB_Kernels;
+
+void GPB_Init();
+//Forces a kernel set by name ("scalar", "sse2", "avx2"); false if unsupported
+bool GPB_SelectKernels( const char* Name );
+
+//Draws one masked layer. Inv draws it mirrored around x (SprIndex>=4096).
+//WShift is the per-line shift table of the water reflection (GPB_MIRROR only).
+void GPB_Draw( const GP_BlitTarget* T, int Mode, bool Inv, const GP_BlitSprite* S,
+	const byte* Table, const int* WShift );
+
+#pragma pack(pop)
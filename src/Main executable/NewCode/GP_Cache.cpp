@@ -0,0 +1,276 @@
+#include "../cross_platform/platform_compat.h"
+#include "GP_Cache.h"
+
+//Header in front of every block; 16 bytes keep the data aligned for SSE.
+//Entry is -1 for the foreign blocks.
+struct GPC_Header
+{
+	int Entry;
+	int Reserved[( GPC_HEADER_SIZE >> 2 ) - 1];
+};
+
+GP_Cache::GP_Cache()
+{
+	entries_ = nullptr;
+	n_entries_ = 0;
+	max_entries_ = 0;
+	first_free_ = -1;
+	hand_ = 0;
+	n_blocks_ = 0;
+	budget_ = 4200000;
+	used_ = 0;
+	hold_ = false;
+	held_ = nullptr;
+	n_held_ = 0;
+	max_held_ = 0;
+	stats_ = nullptr;
+	n_stats_ = 0;
+}
+
+GP_Cache::~GP_Cache()
+{
+	Hold( false );
+	free( held_ );
+	for (int i = 0; i < n_entries_; i++)
+	{
+		if (entries_[i].Block)
+		{
+			free( entries_[i].Block );
+		}
+	}
+	free( entries_ );
+	free( stats_ );
+}
+
+void GP_Cache::SetBudget( size_t Bytes )
+{
+	budget_ = Bytes;
+	MakeRoom( 0 );
+}
+
+size_t GP_Cache::GetBudget()
+{
+	return budget_;
+}
+
+size_t GP_Cache::GetUsed()
+{
+	return used_;
+}
+
+int GP_Cache::GetNBlocks()
+{
+	return n_blocks_;
+}
+
+GP_CacheStats* GP_Cache::Stats( int FileIndex )
+{
+	if (FileIndex < 0)
+	{
+		return nullptr;
+	}
+	if (FileIndex >= n_stats_)
+	{
+		int n = FileIndex + 64;
+		stats_ = (GP_CacheStats*) realloc( stats_, n * sizeof( GP_CacheStats ) );
+		memset( stats_ + n_stats_, 0, ( n - n_stats_ ) * sizeof( GP_CacheStats ) );
+		n_stats_ = n;
+	}
+	return stats_ + FileIndex;
+}
+
+GP_CacheStats* GP_Cache::GetStats( int FileIndex )
+{
+	if (FileIndex < 0 || FileIndex >= n_stats_)
+	{
+		return nullptr;
+	}
+	return stats_ + FileIndex;
+}
+
+int GP_Cache::GetNStats()
+{
+	return n_stats_;
+}
+
+void GP_Cache::ResetStats()
+{
+	if (stats_)
+	{
+		memset( stats_, 0, n_stats_ * sizeof( GP_CacheStats ) );
+	}
+}
+
+void GP_Cache::FreeBlock( byte* Block )
+{
+	if (!hold_)
+	{
+		free( Block );
+		return;
+	}
+	if (n_held_ == max_held_)
+	{
+		max_held_ = max_held_ ? max_held_ << 1 : 256;
+		held_ = (byte**) realloc( held_, max_held_ * sizeof( byte* ) );
+	}
+	held_[n_held_++] = Block;
+}
+
+void GP_Cache::Hold( bool On )
+{
+	hold_ = On;
+	if (On)
+	{
+		return;
+	}
+	for (int i = 0; i < n_held_; i++)
+	{
+		free( held_[i] );
+	}
+	n_held_ = 0;
+}
+
+void GP_Cache::Evict( int Index )
+{
+	Entry* E = entries_ + Index;
+	*E->Ref = GPC_EMPTY;
+	FreeBlock( E->Block );
+	used_ -= E->Size;
+	n_blocks_--;
+	GP_CacheStats* S = Stats( E->File );
+	if (S)
+	{
+		S->Evictions++;
+	}
+	E->Block = nullptr;
+	E->Ref = nullptr;
+	E->NextFree = first_free_;
+	first_free_ = Index;
+}
+
+//Runs the clock hand until Size more bytes fit into the budget.
+//Two full turns without a victim mean everything left is locked.
+void GP_Cache::MakeRoom( size_t Size )
+{
+	int idle = 0;
+	while (used_ + Size > budget_ && n_blocks_ && idle < ( n_entries_ << 1 ))
+	{
+		if (hand_ >= n_entries_)
+		{
+			hand_ = 0;
+		}
+		Entry* E = entries_ + hand_;
+		if (E->Block && !E->Locked)
+		{
+			if (E->Used)
+			{
+				E->Used = false;
+				idle++;
+			}
+			else
+			{
+				Evict( hand_ );
+				idle = 0;
+			}
+		}
+		else
+		{
+			idle++;
+		}
+		hand_++;
+	}
+}
+
+byte* GP_Cache::Alloc( size_t* Ref, int Size, int FileIndex, bool Lock )
+{
+	size_t Total = Size + sizeof( GPC_Header );
+	MakeRoom( Total );
+
+	int Index = first_free_;
+	if (Index != -1)
+	{
+		first_free_ = entries_[Index].NextFree;
+	}
+	else
+	{
+		if (n_entries_ == max_entries_)
+		{
+			max_entries_ = max_entries_ ? max_entries_ << 1 : 1024;
+			entries_ = (Entry*) realloc( entries_, max_entries_ * sizeof( Entry ) );
+		}
+		Index = n_entries_++;
+	}
+
+	Entry* E = entries_ + Index;
+	E->Block = (byte*) malloc( Total );
+	E->Ref = Ref;
+	E->Size = int( Total );
+	E->File = FileIndex;
+	E->NextFree = -1;
+	//a fresh block survives one pass of the hand
+	E->Used = true;
+	E->Locked = Lock;
+	( (GPC_Header*) E->Block )->Entry = Index;
+	used_ += Total;
+	n_blocks_++;
+
+	GP_CacheStats* S = Stats( FileIndex );
+	if (S)
+	{
+		S->Misses++;
+		S->BytesDecoded += Size;
+	}
+
+	byte* Data = E->Block + sizeof( GPC_Header );
+	*Ref = (size_t) Data;
+	return Data;
+}
+
+void GP_Cache::Touch( byte* Data )
+{
+	int Index = ( (GPC_Header*) ( Data - sizeof( GPC_Header ) ) )->Entry;
+	if (Index < 0)
+	{
+		return;
+	}
+	Entry* E = entries_ + Index;
+	E->Used = true;
+	GP_CacheStats* S = Stats( E->File );
+	if (S)
+	{
+		S->Hits++;
+	}
+}
+
+void GP_Cache::Unlock( byte* Data )
+{
+	int Index = ( (GPC_Header*) ( Data - sizeof( GPC_Header ) ) )->Entry;
+	if (Index >= 0)
+	{
+		entries_[Index].Locked = false;
+	}
+}
+
+void GP_Cache::InitForeign( byte* Data )
+{
+	( (GPC_Header*) ( Data - sizeof( GPC_Header ) ) )->Entry = -1;
+}
+
+void GP_Cache::FreeFile( int FileIndex )
+{
+	for (int i = 0; i < n_entries_; i++)
+	{
+		Entry* E = entries_ + i;
+		if (E->Block && E->File == FileIndex)
+		{
+			*E->Ref = GPC_EMPTY;
+			FreeBlock( E->Block );
+			used_ -= E->Size;
+			n_blocks_--;
+			E->Block = nullptr;
+			E->Ref = nullptr;
+			E->NextFree = first_free_;
+			first_free_ = i;
+		}
+	}
+}
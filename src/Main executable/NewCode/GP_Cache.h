@@ -0,0 +1,98 @@
+#pragma once
+
+/*
+	Cache of the unpacked GP layers.
+
+	Every block belongs to one layer slot of GP_System::CASHREF. The cache
+	keeps the total size under a byte budget and evicts with the CLOCK
+	algorithm: a hit sets the reference bit of the block, the hand clears
+	it and throws out blocks that were not used since its last pass.
+	An evicted slot gets GPC_EMPTY (NO_PACK) and is unpacked again on the
+	next draw. The slots are size_t, so the back references are valid on
+	64-bit builds as well.
+*/
+
+//The game headers leave pack(1) on, the module is built without it
+#pragma pack(push)
+#pragma pack()
+
+//Value of a layer slot without unpacked data
+#define GPC_EMPTY ( ~(size_t) 0 )
+//Bytes the cache keeps in front of the data of every block
+#define GPC_HEADER_SIZE 16
+
+struct GP_CacheStats
+{
+	int Hits;
+	int Misses;
+	int Evictions;
+	long long BytesDecoded;
+};
+
+class GP_Cache
+{
+public:
+	GP_Cache();
+	~GP_Cache();
+
+	void SetBudget( size_t Bytes );
+	size_t GetBudget();
+	size_t GetUsed();
+	int GetNBlocks();
+
+	//Returns Size bytes for the slot *Ref of file FileIndex and stores the
+	//pointer in *Ref. Locked blocks can not be evicted until Unlock().
+	byte* Alloc( size_t* Ref, int Size, int FileIndex, bool Lock );
+	//Block is drawn from the cache
+	void Touch( byte* Data );
+	void Unlock( byte* Data );
+	//Drops all blocks of the file
+	void FreeFile( int FileIndex );
+	//Data with GPC_HEADER_SIZE free bytes in front that lives outside of
+	//the cache (GP atlas). Touch() and Unlock() ignore such blocks.
+	static void InitForeign( byte* Data );
+	//While held, evicted blocks leave the cache but their memory is only
+	//freed by Hold( false ); recorded draw commands may still read them.
+	void Hold( bool On );
+
+	//NULL if the file never used the cache
+	GP_CacheStats* GetStats( int FileIndex );
+	int GetNStats();
+	void ResetStats();
+
+private:
+	struct Entry
+	{
+		byte* Block;
+		size_t* Ref;
+		int Size;
+		int File;
+		int NextFree;
+		bool Used;
+		bool Locked;
+	};
+
+	void Evict( int Index );
+	void FreeBlock( byte* Block );
+	void MakeRoom( size_t Size );
+	GP_CacheStats* Stats( int FileIndex );
+
+	Entry* entries_;
+	int n_entries_;
+	int max_entries_;
+	int first_free_;
+	int hand_;
+	int n_blocks_;
+	size_t budget_;
+	size_t used_;
+
+	bool hold_;
+	byte** held_;
+	int n_held_;
+	int max_held_;
+
+	GP_CacheStats* stats_;
+	int n_stats_;
+};
+
+#pragma pack(pop)
@@ -0,0 +1,242 @@
+#include "../cross_platform/platform_compat.h"
+#include "GP_Unpack.h"
+#include "JobPool.h"
+
+#if defined(_M_X64) || defined(__x86_64__) || defined(__SSE2__) || ( defined(_M_IX86_FP) && _M_IX86_FP >= 2 )
+#define GPU_SSE2
+#include <emmintrin.h>
+#endif
+
+/*
+	Nat: every source byte gives 4 pixels, 2 bits each, lowest bits first.
+*/
+void GP_NatUnpack( byte* Dest, const byte* Src, int Len )
+{
+	int N = Len >> 2;
+	int i = 0;
+#ifdef GPU_SSE2
+	//16 source bytes -> 64 pixels; the byte is spread to a dword and each
+	//lane takes its 2-bit field with a shift and a mask
+	const __m128i m0 = _mm_set1_epi32( 0x00000003 );
+	const __m128i m1 = _mm_set1_epi32( 0x00000300 );
+	const __m128i m2 = _mm_set1_epi32( 0x00030000 );
+	const __m128i m3 = _mm_set1_epi32( 0x03000000 );
+	for (; i + 16 <= N; i += 16)
+	{
+		__m128i v = _mm_loadu_si128( (const __m128i*) ( Src + i ) );
+		__m128i lo = _mm_unpacklo_epi8( v, v );
+		__m128i hi = _mm_unpackhi_epi8( v, v );
+		__m128i q[4];
+		q[0] = _mm_unpacklo_epi16( lo, lo );
+		q[1] = _mm_unpackhi_epi16( lo, lo );
+		q[2] = _mm_unpacklo_epi16( hi, hi );
+		q[3] = _mm_unpackhi_epi16( hi, hi );
+		for (int k = 0; k < 4; k++)
+		{
+			__m128i x = q[k];
+			__m128i r = _mm_and_si128( x, m0 );
+			r = _mm_or_si128( r, _mm_and_si128( _mm_srli_epi32( x, 2 ), m1 ) );
+			r = _mm_or_si128( r, _mm_and_si128( _mm_srli_epi32( x, 4 ), m2 ) );
+			r = _mm_or_si128( r, _mm_and_si128( _mm_srli_epi32( x, 6 ), m3 ) );
+			_mm_storeu_si128( (__m128i*) ( Dest + ( i << 2 ) + ( k << 4 ) ), r );
+		}
+	}
+#endif
+	for (; i < N; i++)
+	{
+		byte b = Src[i];
+		byte* d = Dest + ( i << 2 );
+		d[0] = b & 3;
+		d[1] = ( b >> 2 ) & 3;
+		d[2] = ( b >> 4 ) & 3;
+		d[3] = b >> 6;
+	}
+}
+
+/*
+	Grey: every source byte gives 2 pixels, low nibble first, both doubled.
+*/
+void GP_GreyUnpack( byte* Dest, const byte* Src, int Len )
+{
+	int N = ( Len >> 1 ) >> 1;
+	int i = 0;
+#ifdef GPU_SSE2
+	const __m128i m = _mm_set1_epi8( 0x0F );
+	for (; i + 16 <= N; i += 16)
+	{
+		__m128i v = _mm_loadu_si128( (const __m128i*) ( Src + i ) );
+		__m128i lo = _mm_and_si128( v, m );
+		__m128i hi = _mm_and_si128( _mm_srli_epi16( v, 4 ), m );
+		lo = _mm_add_epi8( lo, lo );
+		hi = _mm_add_epi8( hi, hi );
+		_mm_storeu_si128( (__m128i*) ( Dest + ( i << 1 ) ), _mm_unpacklo_epi8( lo, hi ) );
+		_mm_storeu_si128( (__m128i*) ( Dest + ( i << 1 ) + 16 ), _mm_unpackhi_epi8( lo, hi ) );
+	}
+#endif
+	for (; i < N; i++)
+	{
+		byte b = Src[i];
+		Dest[i << 1] = ( b & 15 ) << 1;
+		Dest[( i << 1 ) + 1] = ( b >> 4 ) << 1;
+	}
+}
+
+/*
+	Std: flag bit set -> word cx, copy (cx>>12)+3 bytes from Voc+(cx&0xFFF),
+	clear -> one literal byte. A match may run past Len (up to 17 bytes),
+	that is how the files were packed.
+*/
+void GP_StdUnpack( byte* Dest, const byte* Src, int Len, const byte* Voc )
+{
+	if (Len <= 0)
+	{
+		return;
+	}
+	for (;;)
+	{
+		byte Flags = *Src++;
+		//eight literals in a row
+		if (!Flags && Len >= 8)
+		{
+			memcpy( Dest, Src, 8 );
+			Dest += 8;
+			Len -= 8;
+			if (!Len)
+			{
+				return;
+			}
+			Src += 8;
+			continue;
+		}
+		for (int k = 0; k < 8; k++)
+		{
+			if (Flags & 128)
+			{
+				int cx = Src[0] + ( Src[1] << 8 );
+				int n = ( cx >> 12 ) + 3;
+				memcpy( Dest, Voc + ( cx & 0xFFF ), n );
+				Dest += n;
+				Src += 2;
+				Len -= n;
+				if (Len <= 0)
+				{
+					return;
+				}
+			}
+			else
+			{
+				*Dest++ = *Src;
+				if (!--Len)
+				{
+					return;
+				}
+				Src++;
+			}
+			Flags <<= 1;
+		}
+	}
+}
+
+/*
+	LZ: flag bit set -> word cx, copy (cx>>13)+3 bytes from Dest-(cx&0x1FFF)-1.
+	The source may overlap the destination, it has to be copied forward.
+*/
+void GP_LZUnpack( byte* Dest, const byte* Src, int Len )
+{
+	if (Len <= 0)
+	{
+		return;
+	}
+	for (;;)
+	{
+		byte Flags = *Src++;
+		if (!Flags && Len >= 8)
+		{
+			memcpy( Dest, Src, 8 );
+			Dest += 8;
+			Len -= 8;
+			if (!Len)
+			{
+				return;
+			}
+			Src += 8;
+			continue;
+		}
+		for (int k = 0; k < 8; k++)
+		{
+			if (Flags & 1)
+			{
+				int cx = Src[0] + ( Src[1] << 8 );
+				int n = ( cx >> 13 ) + 3;
+				int dist = ( cx & 0x1FFF ) + 1;
+				const byte* from = Dest - dist;
+				if (dist >= n)
+				{
+					memcpy( Dest, from, n );
+				}
+				else if (dist >= 4)
+				{
+					//chunks never reach bytes they have to read themselves
+					int j = 0;
+					for (; j + 4 <= n; j += 4)
+					{
+						memcpy( Dest + j, from + j, 4 );
+					}
+					for (; j < n; j++)
+					{
+						Dest[j] = from[j];
+					}
+				}
+				else
+				{
+					for (int j = 0; j < n; j++)
+					{
+						Dest[j] = from[j];
+					}
+				}
+				Dest += n;
+				Src += 2;
+				Len -= n;
+				if (Len <= 0)
+				{
+					return;
+				}
+			}
+			else
+			{
+				*Dest++ = *Src;
+				if (!--Len)
+				{
+					return;
+				}
+				Src++;
+			}
+			Flags >>= 1;
+		}
+	}
+}
+
+static void UnpackOne( int Index, void* Param )
+{
+	GP_UnpackJob* J = ( (GP_UnpackJob*) Param ) + Index;
+	switch (J->Method)
+	{
+	case GPU_STD:
+		GP_StdUnpack( J->Dest, J->Src, J->Len, J->Voc );
+		break;
+	case GPU_NAT:
+		GP_NatUnpack( J->Dest, J->Src, J->Len );
+		break;
+	case GPU_GREY:
+		GP_GreyUnpack( J->Dest, J->Src, J->Len );
+		break;
+	case GPU_LZ:
+		GP_LZUnpack( J->Dest, J->Src, J->Len );
+		break;
+	}
+}
+
+void GP_UnpackBatch( GP_UnpackJob* Jobs, int N )
+{
+	JOBS.ParallelFor( N, &UnpackOne, Jobs );
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+/*
+	Portable decoders for the packed GP layers (Options 0, 1, 38, 42..44).
+	They produce exactly the bytes of the old x86 assembler versions,
+	including the overrun of the last match in GP_StdUnpack()/GP_LZUnpack(),
+	so the destination still needs the slack reserved by the callers of GetCash().
+	All functions are reentrant and may run on the JobPool workers.
+*/
+
+//The game headers leave pack(1) on, the module is built without it
+#pragma pack(push)
+#pragma pack()
+
+//Options 1: national mask, 2 bits per pixel
+void GP_NatUnpack( byte* Dest, const byte* Src, int Len );
+//Options 38: grey shading, 4 bits per pixel
+void GP_GreyUnpack( byte* Dest, const byte* Src, int Len );
+//Options 0: 8 flags per byte (MSB first), matches point into the file vocabulary
+void GP_StdUnpack( byte* Dest, const byte* Src, int Len, const byte* Voc );
+//Options 42..44: 8 flags per byte (LSB first), matches point back into Dest
+void GP_LZUnpack( byte* Dest, const byte* Src, int Len );
+
+enum GP_UnpackMethod
+{
+	GPU_STD,
+	GPU_NAT,
+	GPU_GREY,
+	GPU_LZ
+};
+
+//One layer to decode into an already reserved cash block
+struct GP_UnpackJob
+{
+	byte* Dest;
+	const byte* Src;
+	const byte* Voc;
+	int Len;
+	int Method;
+};
+
+//Decodes the jobs on the JobPool; returns when all of them are done.
+//Destinations must not overlap.
+void GP_UnpackBatch( GP_UnpackJob* Jobs, int N );
+
+#pragma pack(pop)
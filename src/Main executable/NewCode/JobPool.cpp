@@ -0,0 +1,170 @@
+#include "../cross_platform/platform_compat.h"
+#include "JobPool.h"
+
+JobPool JOBS;
+
+JobPool::JobPool()
+{
+	started_ = false;
+	stopping_ = false;
+	batch_id_ = 0;
+	active_ = 0;
+	job_ = nullptr;
+	param_ = nullptr;
+	count_ = 0;
+	next_ = 0;
+	finished_ = 0;
+}
+
+JobPool::~JobPool()
+{
+	Stop();
+}
+
+void JobPool::Start( int NThreads )
+{
+	if (started_)
+	{
+		return;
+	}
+
+	if (NThreads <= 0)
+	{
+		NThreads = int( std::thread::hardware_concurrency() ) - 1;
+	}
+
+	started_ = true;
+	stopping_ = false;
+	for (int i = 0; i < NThreads; i++)
+	{
+		workers_.push_back( std::thread( &JobPool::WorkerLoop, this ) );
+	}
+}
+
+void JobPool::Stop()
+{
+	{
+		std::lock_guard<std::mutex> lock( mutex_ );
+		stopping_ = true;
+	}
+	wake_.notify_all();
+	for (size_t i = 0; i < workers_.size(); i++)
+	{
+		workers_[i].join();
+	}
+	workers_.clear();
+	started_ = false;
+}
+
+int JobPool::GetNThreads()
+{
+	if (!started_)
+	{
+		Start( 0 );
+	}
+	return int( workers_.size() ) + 1;
+}
+
+//Takes indices until the batch is exhausted
+void JobPool::RunBatch()
+{
+	int n = 0;
+	for (;;)
+	{
+		int i = next_.fetch_add( 1 );
+		if (i >= count_)
+		{
+			break;
+		}
+		job_( i, param_ );
+		n++;
+	}
+	if (n && finished_.fetch_add( n ) + n == count_)
+	{
+		std::lock_guard<std::mutex> lock( mutex_ );
+		done_.notify_all();
+	}
+}
+
+void JobPool::WorkerLoop()
+{
+	unsigned seen = 0;
+	for (;;)
+	{
+		{
+			std::unique_lock<std::mutex> lock( mutex_ );
+			while (!stopping_ && seen == batch_id_)
+			{
+				wake_.wait( lock );
+			}
+			if (stopping_)
+			{
+				return;
+			}
+			seen = batch_id_;
+			active_++;
+		}
+		RunBatch();
+		{
+			std::lock_guard<std::mutex> lock( mutex_ );
+			if (!--active_)
+			{
+				done_.notify_all();
+			}
+		}
+	}
+}
+
+void JobPool::ParallelFor( int N, JobFunc Job, void* Param )
+{
+	if (N <= 0)
+	{
+		return;
+	}
+
+	if (!started_)
+	{
+		Start( 0 );
+	}
+
+	if (N == 1 || workers_.empty())
+	{
+		for (int i = 0; i < N; i++)
+		{
+			Job( i, Param );
+		}
+		return;
+	}
+
+	//one batch at a time, nested calls from jobs run serially
+	std::unique_lock<std::mutex> batch( batch_mutex_, std::try_to_lock );
+	if (!batch.owns_lock())
+	{
+		for (int i = 0; i < N; i++)
+		{
+			Job( i, Param );
+		}
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock( mutex_ );
+		job_ = Job;
+		param_ = Param;
+		count_ = N;
+		next_ = 0;
+		finished_ = 0;
+		batch_id_++;
+	}
+	wake_.notify_all();
+
+	RunBatch();
+
+	//a late worker may still be inside RunBatch(), it must leave before
+	//the next batch resets the counters
+	std::unique_lock<std::mutex> lock( mutex_ );
+	while (finished_.load() < count_ || active_)
+	{
+		done_.wait( lock );
+	}
+}
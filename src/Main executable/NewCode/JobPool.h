@@ -0,0 +1,70 @@
+#pragma once
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <vector>
+
+/*
+	Small fork/join worker pool for the engine.
+	ParallelFor() hands out indices one by one to the workers and to the
+	calling thread and returns when all of them are processed. Jobs must
+	only write to their own slots, the order of execution is not defined.
+*/
+
+//The game headers leave pack(1) on, the module is built without it
+#pragma pack(push)
+#pragma pack()
+
+class JobPool
+{
+public:
+	typedef void( *JobFunc )( int Index, void* Param );
+
+	JobPool();
+	~JobPool();
+
+	//NThreads<=0: one worker less than the number of cores
+	void Start( int NThreads );
+	void Stop();
+	//Number of threads taking part in ParallelFor, including the caller
+	int GetNThreads();
+
+	void ParallelFor( int N, JobFunc Job, void* Param );
+
+	template<class F>
+	void ParallelFor( int N, F& Func )
+	{
+		ParallelFor( N, &CallFunctor<F>, &Func );
+	}
+
+private:
+	template<class F>
+	static void CallFunctor( int Index, void* Param )
+	{
+		( *(F*) Param )( Index );
+	}
+
+	void WorkerLoop();
+	void RunBatch();
+
+	std::vector<std::thread> workers_;
+	std::mutex mutex_;
+	std::mutex batch_mutex_;
+	std::condition_variable wake_;
+	std::condition_variable done_;
+	bool started_;
+	bool stopping_;
+	unsigned batch_id_;
+	int active_;
+
+	JobFunc job_;
+	void* param_;
+	int count_;
+	std::atomic<int> next_;
+	std::atomic<int> finished_;
+};
+
+extern JobPool JOBS;
+
+#pragma pack(pop)
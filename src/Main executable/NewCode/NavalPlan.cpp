@@ -0,0 +1,452 @@
+#include "../cross_platform/platform_compat.h"
+#include "NavalPlan.h"
+#include <stdlib.h>
+#include <vector>
+#include <algorithm>
+
+#define NP_FAR 0x7FFFFFFF
+
+//max+min/2 until the game gives its own
+static int HalfNorm( int dx, int dy )
+{
+	dx = abs( dx );
+	dy = abs( dy );
+	return dx > dy ? dx + ( dy >> 1 ) : dy + ( dx >> 1 );
+}
+
+static NP_Norm Norm = &HalfNorm;
+static NP_Stats Stats;
+
+//Points bucketed by square cells of 1<<SH
+struct NP_Grid
+{
+	int X0, Y0;
+	int SH;
+	int GX, GY;
+	//the points of cell c are Items[Start[c]..Start[c+1]-1], by index
+	std::vector<int> Start;
+	std::vector<int> Items;
+
+	//Points Idx[0..N-1] of X/Y, all N of them if Idx is null
+	void Build( const int* Idx, int N, const int* X, const int* Y );
+
+	//Nearest point i with a norm R over MinR that Accept(i) takes, ties go
+	//to the lower index. A point is taken only if it is nearer than *BestR
+	//or as near with a lower index than Best.
+	template<class F> int Nearest( int x, int y, int MinR, const int* X, const int* Y, F& Accept, int Best, int* BestR, int* Tested ) const
+	{
+		if (Items.empty())
+		{
+			return Best;
+		}
+		int cx = ( x - X0 ) >> SH;
+		int cy = ( y - Y0 ) >> SH;
+		cx = cx < 0 ? 0 : ( cx >= GX ? GX - 1 : cx );
+		cy = cy < 0 ? 0 : ( cy >= GY ? GY - 1 : cy );
+		int MaxRing = GX > GY ? GX : GY;
+		for (int r = 0; r < MaxRing; r++)
+		{
+			//the next ring is more than r cells away
+			if (Best >= 0 && r && *BestR <= ( ( r - 1 ) << SH ))
+			{
+				break;
+			}
+			int y0 = cy - r < 0 ? 0 : cy - r;
+			int y1 = cy + r >= GY ? GY - 1 : cy + r;
+			for (int yy = y0; yy <= y1; yy++)
+			{
+				//the whole row on the top and the bottom, the two ends in between
+				bool Edge = yy == cy - r || yy == cy + r;
+				int Step = Edge || !r ? 1 : r + r;
+				for (int xx = cx - r; xx <= cx + r; xx += Step)
+				{
+					if (xx < 0 || xx >= GX)
+					{
+						continue;
+					}
+					int c = yy * GX + xx;
+					for (int k = Start[c]; k < Start[c + 1]; k++)
+					{
+						int i = Items[k];
+						( *Tested )++;
+						int R = Norm( x - X[i], y - Y[i] );
+						if (R > MinR && ( R < *BestR || ( R == *BestR && i < Best ) ) && Accept( i ))
+						{
+							Best = i;
+							*BestR = R;
+						}
+					}
+				}
+			}
+		}
+		return Best;
+	}
+};
+
+void NP_Grid::Build( const int* Idx, int N, const int* X, const int* Y )
+{
+	Start.clear();
+	Items.clear();
+	if (N <= 0)
+	{
+		return;
+	}
+	Items.resize( N );
+	for (int k = 0; k < N; k++)
+	{
+		Items[k] = Idx ? Idx[k] : k;
+	}
+	int x0 = X[Items[0]];
+	int y0 = Y[Items[0]];
+	int x1 = x0;
+	int y1 = y0;
+	for (int i : Items)
+	{
+		x0 = X[i] < x0 ? X[i] : x0;
+		y0 = Y[i] < y0 ? Y[i] : y0;
+		x1 = X[i] > x1 ? X[i] : x1;
+		y1 = Y[i] > y1 ? Y[i] : y1;
+	}
+	X0 = x0;
+	Y0 = y0;
+	//about NP_PERCELL points in a cell
+	double Area = double( x1 - x0 + 1 ) * double( y1 - y0 + 1 ) * NP_PERCELL / N;
+	SH = 2;
+	while (SH < 24 && double( 1 << SH ) * double( 1 << SH ) < Area)
+	{
+		SH++;
+	}
+	GX = ( ( x1 - x0 ) >> SH ) + 1;
+	GY = ( ( y1 - y0 ) >> SH ) + 1;
+	Start.assign( GX * GY + 1, 0 );
+	for (int i : Items)
+	{
+		Start[( ( Y[i] - Y0 ) >> SH ) * GX + ( ( X[i] - X0 ) >> SH ) + 1]++;
+	}
+	for (int c = 0; c < GX * GY; c++)
+	{
+		Start[c + 1] += Start[c];
+	}
+	//the points were in the order of Idx, a cell keeps them by index
+	std::vector<int> Fill( Start.begin(), Start.end() - 1 );
+	std::vector<int> Sorted( N );
+	for (int i : Items)
+	{
+		Sorted[Fill[( ( Y[i] - Y0 ) >> SH ) * GX + ( ( X[i] - X0 ) >> SH )]++] = i;
+	}
+	Items.swap( Sorted );
+}
+
+//Grids of all the points and of the points of every key
+struct NP_KeyGrids
+{
+	NP_Grid All;
+	std::vector<int> Keys;	//sorted
+	std::vector<NP_Grid> Of;
+	std::vector<int> Idx;
+
+	void Build( int N, const int* X, const int* Y, const int* Key )
+	{
+		All.Build( nullptr, N, X, Y );
+		Idx.resize( N );
+		for (int i = 0; i < N; i++)
+		{
+			Idx[i] = i;
+		}
+		std::stable_sort( Idx.begin(), Idx.end(), [Key]( int a, int b ) { return Key[a] < Key[b]; } );
+		Keys.clear();
+		int NK = 0;
+		for (int k = 0; k < N; )
+		{
+			int e = k;
+			while (e < N && Key[Idx[e]] == Key[Idx[k]])
+			{
+				e++;
+			}
+			if (int( Of.size() ) <= NK)
+			{
+				Of.resize( NK + 1 );
+			}
+			Keys.push_back( Key[Idx[k]] );
+			Of[NK++].Build( Idx.data() + k, e - k, X, Y );
+			k = e;
+		}
+	}
+
+	//grid of the points of the key, null if there are none
+	const NP_Grid* Find( int Key ) const
+	{
+		std::vector<int>::const_iterator p = std::lower_bound( Keys.begin(), Keys.end(), Key );
+		if (p == Keys.end() || *p != Key)
+		{
+			return nullptr;
+		}
+		return &Of[p - Keys.begin()];
+	}
+};
+
+void NP_SetNorm( NP_Norm N )
+{
+	Norm = N ? N : &HalfNorm;
+}
+
+//Seas
+static std::vector<int> SeaOf;
+
+static int Root( std::vector<int>& Up, int a )
+{
+	while (Up[a] != a)
+	{
+		Up[a] = Up[Up[a]];
+		a = Up[a];
+	}
+	return a;
+}
+
+void NP_SetSeas( int N, AG_Area Info )
+{
+	std::vector<int> Up( N );
+	for (int i = 0; i < N; i++)
+	{
+		Up[i] = i;
+	}
+	for (int i = 0; i < N; i++)
+	{
+		int x, y;
+		const word* Link;
+		int NL = Info( i, &x, &y, &Link );
+		for (int k = 0; k < NL; k++)
+		{
+			int j = Link[k + k];
+			if (Link[k + k + 1] == 0xFFFF || j >= N)
+			{
+				continue;
+			}
+			int a = Root( Up, i );
+			int b = Root( Up, j );
+			//the lower area is the root, a sea is named by its first area
+			if (a < b)
+			{
+				Up[b] = a;
+			}
+			else if (b < a)
+			{
+				Up[a] = b;
+			}
+		}
+	}
+	SeaOf.resize( N );
+	Stats.Seas = 0;
+	for (int i = 0; i < N; i++)
+	{
+		SeaOf[i] = Root( Up, i );
+		if (SeaOf[i] == i)
+		{
+			Stats.Seas++;
+		}
+	}
+}
+
+int NP_GetSea( int Area )
+{
+	if (Area < 0 || Area >= int( SeaOf.size() ))
+	{
+		return -1;
+	}
+	return SeaOf[Area];
+}
+
+//Coast places
+static std::vector<int> PX;
+static std::vector<int> PY;
+static std::vector<int> PKey;
+static std::vector<int> PSea;
+static NP_KeyGrids Coast;
+
+void NP_SetCoast( int N, NP_Place Info )
+{
+	N = N > 0 ? N : 0;
+	PX.resize( N );
+	PY.resize( N );
+	PKey.resize( N );
+	PSea.resize( N );
+	for (int i = 0; i < N; i++)
+	{
+		PSea[i] = NP_GetSea( Info( i, &PX[i], &PY[i], &PKey[i] ) );
+	}
+	Coast.Build( N, PX.data(), PY.data(), PKey.data() );
+	Stats.Places = N;
+	Stats.Cells = N ? Coast.All.GX * Coast.All.GY : 0;
+}
+
+struct NP_CoastAccept
+{
+	int Sea;
+	NP_Accept Accept;
+	void* Param;
+
+	bool operator()( int i )
+	{
+		return ( Sea < 0 || PSea[i] == Sea ) && Accept( i, Param );
+	}
+};
+
+int NP_FindCoast( int x, int y, int MinR, int Sea, int Key, NP_Accept Accept, void* Param )
+{
+	Stats.Queries++;
+	const NP_Grid* G = Key < 0 ? &Coast.All : Coast.Find( Key );
+	if (!G)
+	{
+		return -1;
+	}
+	NP_CoastAccept A = { Sea, Accept, Param };
+	int R = NP_FAR;
+	return G->Nearest( x, y, MinR, PX.data(), PY.data(), A, -1, &R, &Stats.Tested );
+}
+
+//Routes
+int NP_Route( int From, int To, word* Areas, int MaxN )
+{
+	int N = AG_GetN( NP_LAYER );
+	if (From < 0 || To < 0 || From >= N || To >= N)
+	{
+		return -1;
+	}
+	if (From == To)
+	{
+		return 0;
+	}
+	if (AG_Dist( NP_LAYER, From, To ) == AG_NONE)
+	{
+		return -1;
+	}
+	int n = 0;
+	int a = From;
+	while (a != To)
+	{
+		if (n >= MaxN)
+		{
+			return -1;
+		}
+		a = AG_Next( NP_LAYER, a, To );
+		Areas[n++] = word( a );
+	}
+	return n;
+}
+
+int NP_RouteLen( int From, int To )
+{
+	int N = AG_GetN( NP_LAYER );
+	if (From < 0 || To < 0 || From >= N || To >= N)
+	{
+		return -1;
+	}
+	if (From == To)
+	{
+		return 0;
+	}
+	word D = AG_Dist( NP_LAYER, From, To );
+	return D == AG_NONE ? -1 : D;
+}
+
+//Transport assignment
+struct NP_ShipAccept
+{
+	const byte* Taken;
+
+	bool operator()( int i )
+	{
+		return !Taken[i];
+	}
+};
+
+int NP_Assign( const NP_Ship* S, int NS, const NP_Group* G, int NG, int MaxN, int* Ship )
+{
+	static std::vector<int> SX;
+	static std::vector<int> SY;
+	static std::vector<int> SKey;
+	static std::vector<byte> Taken;
+	static std::vector<int> Order;
+	static std::vector<int> NoShip;
+	static NP_KeyGrids Ships;
+	for (int g = 0; g < NG; g++)
+	{
+		Ship[g] = -1;
+	}
+	if (NS <= 0 || NG <= 0 || MaxN <= 0)
+	{
+		return 0;
+	}
+	SX.resize( NS );
+	SY.resize( NS );
+	SKey.resize( NS );
+	for (int i = 0; i < NS; i++)
+	{
+		SX[i] = S[i].x;
+		SY[i] = S[i].y;
+		//all the ships without a key are under -1
+		SKey[i] = S[i].Key < 0 ? -1 : S[i].Key;
+	}
+	Taken.assign( NS, 0 );
+	Ships.Build( NS, SX.data(), SY.data(), SKey.data() );
+	const NP_Grid* Any = Ships.Find( -1 );
+	Order.resize( NG );
+	for (int g = 0; g < NG; g++)
+	{
+		Order[g] = g;
+	}
+	std::stable_sort( Order.begin(), Order.end(), [G]( int a, int b ) { return G[a].Prio < G[b].Prio; } );
+	//keys without a free ship, ships are only taken so they stay so
+	NoShip.clear();
+	NP_ShipAccept A = { Taken.data() };
+	int NM = 0;
+	for (int k = 0; k < NG && NM < MaxN && NM < NS; k++)
+	{
+		const NP_Group& Gr = G[Order[k]];
+		if (std::find( NoShip.begin(), NoShip.end(), Gr.Key ) != NoShip.end())
+		{
+			continue;
+		}
+		int R = NP_FAR;
+		int s = -1;
+		if (Gr.Key < 0)
+		{
+			s = Ships.All.Nearest( Gr.x, Gr.y, -1, SX.data(), SY.data(), A, s, &R, &Stats.ShipTests );
+		}
+		else
+		{
+			const NP_Grid* Own = Ships.Find( Gr.Key );
+			if (Own)
+			{
+				s = Own->Nearest( Gr.x, Gr.y, -1, SX.data(), SY.data(), A, s, &R, &Stats.ShipTests );
+			}
+			if (Any)
+			{
+				s = Any->Nearest( Gr.x, Gr.y, -1, SX.data(), SY.data(), A, s, &R, &Stats.ShipTests );
+			}
+		}
+		if (s < 0)
+		{
+			NoShip.push_back( Gr.Key );
+			continue;
+		}
+		Taken[s] = 1;
+		Ship[Order[k]] = s;
+		NM++;
+	}
+	Stats.Matched += NM;
+	return NM;
+}
+
+void NP_GetStats( NP_Stats* S )
+{
+	*S = Stats;
+}
+
+void NP_ClearStats()
+{
+	Stats.Queries = 0;
+	Stats.Tested = 0;
+	Stats.Matched = 0;
+	Stats.ShipTests = 0;
+}
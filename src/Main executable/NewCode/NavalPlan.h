@@ -0,0 +1,99 @@
+#pragma once
+#include "AreaGraph.h"
+
+/*
+	Naval planning over the water topology.
+
+	The water areas are split into seas, the groups of areas joined by
+	open links. A ship never finds a way out of its sea, so the places
+	and the ships of another sea are skipped before any way is asked.
+
+	The coast places are kept in a grid of square cells, about
+	NP_PERCELL places in a cell, and the places of every key (the island
+	of the place) in a grid of their own. The nearest place walks square
+	rings of cells around the cell of the point and stops when the next
+	ring can not hold a nearer place. The norm given to NP_SetNorm() must
+	be at least the larger of |dx| and |dy|, as the game Norma() is.
+	Ties go to the lower index, so a query gives the place the linear
+	scan over all places gave.
+
+	NP_Route() follows the next areas of the area graph of the water
+	layer, NP_RouteLen() is the length of that way.
+
+	NP_Assign() matches land groups to ships. The groups go by their
+	priority, then by their index, and each takes the nearest free ship
+	with its key. The ships of every key are in a grid of their own, so
+	a group looks only at the ships of its key in the few cells around
+	it, not at every ship.
+
+	Everything depends only on the input, all peers plan alike. Not
+	thread safe.
+*/
+
+//The game headers leave pack(1) on, the module is built without it
+#pragma pack(push)
+#pragma pack()
+
+#define NP_LAYER 1
+#define NP_PERCELL 2
+
+typedef int ( *NP_Norm )( int dx, int dy );
+
+//Position and key of the coast place i, returns its water area or AG_NONE
+typedef int ( *NP_Place )( int i, int* x, int* y, int* Key );
+
+//true if the place i may be taken, Param is the one given to the query
+typedef bool ( *NP_Accept )( int i, void* Param );
+
+void NP_SetNorm( NP_Norm Norm );
+
+//Seas of the N water areas from their links
+void NP_SetSeas( int N, AG_Area Info );
+//Sea of a water area, -1 for none
+int NP_GetSea( int Area );
+
+//Indexes N coast places, after NP_SetSeas(). N=0 drops them.
+void NP_SetCoast( int N, NP_Place Info );
+//Nearest place with a norm over MinR from (x,y) on the sea Sea and with
+//the key Key (-1 - any) that Accept takes, -1 if none
+int NP_FindCoast( int x, int y, int MinR, int Sea, int Key, NP_Accept Accept, void* Param );
+
+//Areas of the way from From to To without From, the last one is To.
+//Returns their number, or -1 if there is no way or it is longer than MaxN
+int NP_Route( int From, int To, word* Areas, int MaxN );
+//Length of the way, -1 if none
+int NP_RouteLen( int From, int To );
+
+//Key<0 matches any key
+struct NP_Ship
+{
+	int x, y;
+	int Key;
+};
+
+struct NP_Group
+{
+	int x, y;
+	int Key;
+	int Prio;	//lower goes first
+};
+
+//Every ship takes one group. Ship[g] is the ship of group g or -1, at
+//most MaxN groups get one. Returns the number of matched groups.
+int NP_Assign( const NP_Ship* S, int NS, const NP_Group* G, int NG, int MaxN, int* Ship );
+
+struct NP_Stats
+{
+	int Seas;
+	int Places;
+	int Cells;		//cells of the place grid
+	int Queries;	//NP_FindCoast calls
+	int Tested;		//places they looked at
+	int Matched;	//groups matched by NP_Assign
+	int ShipTests;	//ships looked at by NP_Assign
+};
+
+void NP_GetStats( NP_Stats* S );
+void NP_ClearStats();
+
+#pragma pack(pop)
@@ -0,0 +1,9 @@
+#include "../cross_platform/platform_compat.h"
+#include "ObjHot.h"
+
+int OH_X[65536];
+int OH_Y[65536];
+byte OH_Flags[65536];
+byte OH_Nat[65536];
+byte OH_NZalp[65536];
+byte OH_MaxZalp[65536];
@@ -0,0 +1,23 @@
+#pragma once
+
+/*
+	Hot fields of the objects in parallel arrays indexed by the object
+	index, for the per-tick passes that need only the position, the state
+	and the nation of every object. Streaming these arrays touches a few
+	bytes per object instead of the cache lines of the large OneObject.
+
+	OneObject stays the owner of the data and of the save format. Every
+	place that changes RealX, RealY, Sdoxlo, NNUM or NZalp of an object in
+	Group writes them through with StoreObjHot(), see MapDiscr.h.
+*/
+
+#define OHF_UNIT		1	//NewMonst
+#define OHF_BUILDING	2	//NewBuilding
+#define OHF_DYING		4	//Sdoxlo!=0
+
+extern int OH_X[65536];
+extern int OH_Y[65536];
+extern byte OH_Flags[65536];
+extern byte OH_Nat[65536];
+extern byte OH_NZalp[65536];
+extern byte OH_MaxZalp[65536];
@@ -0,0 +1,177 @@
+#include "../cross_platform/platform_compat.h"
+#include "ObjIndex.h"
+#include <string.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+#define OI_NWORDS ( OI_END >> 5 )
+#define OI_NSUM ( OI_NWORDS >> 5 )
+//slot 0: all nations, 1..8: nation 0..7
+#define OI_NSLOTS 9
+
+struct OI_Set
+{
+	//bit w of Sum[s]: Bits[(s<<5)+w] is not empty
+	DWORD Sum[OI_NSUM];
+	//bit w of Full[s]: all bits of Bits[(s<<5)+w] are set
+	DWORD Full[OI_NSUM];
+	DWORD Bits[OI_NWORDS];
+	int N;
+};
+
+static OI_Set Sets[OIL_COUNT][OI_NSLOTS];
+//nation and kind bits of every indexed object, Kinds is 0 if not indexed
+static byte NatOf[OI_END];
+static byte KindsOf[OI_END];
+
+static inline int LowBit( DWORD V )
+{
+#ifdef _MSC_VER
+	unsigned long r;
+	_BitScanForward( &r, V );
+	return int( r );
+#else
+	return __builtin_ctz( V );
+#endif
+}
+
+static void SetBit( OI_Set& S, int i )
+{
+	DWORD& W = S.Bits[i >> 5];
+	if (!W)
+	{
+		S.Sum[i >> 10] |= DWORD( 1 ) << ( ( i >> 5 ) & 31 );
+	}
+	W |= DWORD( 1 ) << ( i & 31 );
+	if (W == 0xFFFFFFFF)
+	{
+		S.Full[i >> 10] |= DWORD( 1 ) << ( ( i >> 5 ) & 31 );
+	}
+	S.N++;
+}
+
+static void ClearBit( OI_Set& S, int i )
+{
+	DWORD& W = S.Bits[i >> 5];
+	W &= ~( DWORD( 1 ) << ( i & 31 ) );
+	S.Full[i >> 10] &= ~( DWORD( 1 ) << ( ( i >> 5 ) & 31 ) );
+	if (!W)
+	{
+		S.Sum[i >> 10] &= ~( DWORD( 1 ) << ( ( i >> 5 ) & 31 ) );
+	}
+	S.N--;
+}
+
+static int NextBit( const OI_Set& S, int i )
+{
+	int w = i >> 5;
+	DWORD W = S.Bits[w] & ( 0xFFFFFFFF << ( i & 31 ) );
+	if (W)
+	{
+		return ( w << 5 ) + LowBit( W );
+	}
+	w++;
+	int s = w >> 5;
+	if (s >= OI_NSUM)
+	{
+		return OI_END;
+	}
+	DWORD M = S.Sum[s] & ( 0xFFFFFFFF << ( w & 31 ) );
+	while (!M)
+	{
+		s++;
+		if (s >= OI_NSUM)
+		{
+			return OI_END;
+		}
+		M = S.Sum[s];
+	}
+	w = ( s << 5 ) + LowBit( M );
+	return ( w << 5 ) + LowBit( S.Bits[w] );
+}
+
+void OI_Add( int Index, int Nat, int Kinds )
+{
+	if (Index < 0 || Index >= OI_END)
+	{
+		return;
+	}
+	OI_Del( Index );
+	Kinds = ( Kinds | ( 1 << OIL_ALL ) ) & ( ( 1 << OIL_COUNT ) - 1 );
+	NatOf[Index] = byte( Nat & 7 );
+	KindsOf[Index] = byte( Kinds );
+	for (int L = 0; L < OIL_COUNT; L++)
+	{
+		if (Kinds & ( 1 << L ))
+		{
+			SetBit( Sets[L][0], Index );
+			SetBit( Sets[L][1 + ( Nat & 7 )], Index );
+		}
+	}
+}
+
+void OI_Del( int Index )
+{
+	if (Index < 0 || Index >= OI_END || !KindsOf[Index])
+	{
+		return;
+	}
+	int Kinds = KindsOf[Index];
+	int Nat = NatOf[Index];
+	for (int L = 0; L < OIL_COUNT; L++)
+	{
+		if (Kinds & ( 1 << L ))
+		{
+			ClearBit( Sets[L][0], Index );
+			ClearBit( Sets[L][1 + Nat], Index );
+		}
+	}
+	KindsOf[Index] = 0;
+}
+
+void OI_Clear()
+{
+	memset( Sets, 0, sizeof Sets );
+	memset( NatOf, 0, sizeof NatOf );
+	memset( KindsOf, 0, sizeof KindsOf );
+}
+
+bool OI_Has( int Index )
+{
+	return Index >= 0 && Index < OI_END && KindsOf[Index] != 0;
+}
+
+int OI_Next( int Index, int List, int Nat )
+{
+	if (Index >= OI_END)
+	{
+		return OI_END;
+	}
+	if (Index < 0)
+	{
+		Index = 0;
+	}
+	return NextBit( Sets[List][Nat < 0 ? 0 : 1 + ( Nat & 7 )], Index );
+}
+
+int OI_Count( int List, int Nat )
+{
+	return Sets[List][Nat < 0 ? 0 : 1 + ( Nat & 7 )].N;
+}
+
+int OI_FirstFree( int Limit )
+{
+	const OI_Set& S = Sets[OIL_ALL][0];
+	for (int s = 0; s < OI_NSUM; s++)
+	{
+		DWORD M = ~S.Full[s];
+		if (M)
+		{
+			int w = ( s << 5 ) + LowBit( M );
+			int i = ( w << 5 ) + LowBit( ~S.Bits[w] );
+			return i < Limit ? i : -1;
+		}
+	}
+	return -1;
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+/*
+	Index of the live objects (Group[i]!=nullptr).
+
+	Every list is a two level bitset over the object indices, so OI_Next()
+	skips empty ranges 1024 indices at a time and the objects always come
+	out in increasing index order, the same order as a plain scan of
+	Group[0..MAXOBJECT). Besides the list of all objects there are lists
+	per kind (units, buildings, ships, towers), each of them also split by
+	nation.
+
+	OI_Next() reads the current state, so a loop over the index behaves
+	like the old scan when objects are created or erased inside the loop.
+	Dying objects (Sdoxlo) stay in the index until they are removed from
+	Group, loops that skip them still have to check it.
+
+	OI_FirstFree() gives the lowest index that is not in the index. It is
+	the slot allocator of CreateNewMonsterAt, so it must give the same
+	result as a scan of Group for the first empty slot on every peer.
+*/
+
+enum OI_List
+{
+	OIL_ALL,
+	OIL_UNITS,
+	OIL_BUILDINGS,
+	OIL_SHIPS,
+	OIL_TOWERS,
+	OIL_COUNT
+};
+
+//Kind bits of OI_Add, every object is in OIL_ALL
+#define OIK_UNIT		( 1 << OIL_UNITS )
+#define OIK_BUILDING	( 1 << OIL_BUILDINGS )
+#define OIK_SHIP		( 1 << OIL_SHIPS )
+#define OIK_TOWER		( 1 << OIL_TOWERS )
+
+//Returned by OI_Next when there are no more objects
+#define OI_END 65536
+
+//Adds the object or moves it to another nation/kind
+void OI_Add( int Index, int Nat, int Kinds );
+void OI_Del( int Index );
+void OI_Clear();
+bool OI_Has( int Index );
+//First object with index>=Index in List of nation Nat (-1: all nations)
+int OI_Next( int Index, int List = OIL_ALL, int Nat = -1 );
+int OI_Count( int List = OIL_ALL, int Nat = -1 );
+//Lowest index below Limit that is not used, -1 if all are used
+int OI_FirstFree( int Limit );
@@ -0,0 +1,740 @@
+#include "../cross_platform/platform_compat.h"
+#include "PathFinder.h"
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include <deque>
+#include <algorithm>
+
+//cells per tick
+#define PF_BUDGET 100000
+//cells of one search
+#define PF_MAXWORK 2000000
+#define PF_MAXPENDING 256
+#define PF_NCACHE 64
+#define PF_CACHETICKS 64
+#define PF_SHARE 6
+//longest straight piece of a returned path
+#define PF_STEP 8
+//widest bar a column read covers
+#define PF_MAXL 24
+
+#define PF_DONE 1
+#define PF_WAIT 0
+
+struct PF_Layer
+{
+	const byte* Bits;
+	int SX;
+	int SY;
+	int Stride;
+};
+
+static PF_Layer Layers[PF_NLAYERS];
+
+//layer and unit size of a search
+struct PF_Grid
+{
+	const byte* Bits;
+	int SX;
+	int SY;
+	int Stride;
+	int L;
+	DWORD Mask;
+};
+
+struct PF_Node
+{
+	short x, y;
+	int g;
+	int h;
+	int Parent;
+	bool Closed;
+};
+
+struct PF_Open
+{
+	int f;
+	int h;
+	int Node;
+};
+
+struct PF_Search
+{
+	int Layer;
+	int L;
+	int gx, gy;
+	int Owner;
+	DWORD Tag;
+	int Work;
+	int Best;
+	int Goal;
+	std::vector<PF_Node> Nodes;
+	//node+1 by cell, open addressing
+	std::vector<int> Hash;
+	std::vector<PF_Open> Open;
+	int sx, sy;
+};
+
+struct PF_Kept
+{
+	int Layer;
+	int L;
+	int sx, sy;
+	int gx, gy;
+	DWORD Tick;
+	std::vector<short> X;
+	std::vector<short> Y;
+};
+
+static std::deque<PF_Search*> Pending;
+static PF_Kept Kept[PF_NCACHE];
+static int NextKept = 0;
+static DWORD Tick = PF_CACHETICKS + 1;
+static int BudgetSize = PF_BUDGET;
+static int Budget = PF_BUDGET;
+static PF_Stats Stats;
+
+static short OutX[PF_MAXPOINTS];
+static short OutY[PF_MAXPOINTS];
+
+void PF_SetField( int Layer, const byte* Bits, int SX, int SY, int Stride )
+{
+	if (Layer < 0 || Layer >= PF_NLAYERS)
+	{
+		return;
+	}
+	PF_Reset();
+	Layers[Layer].Bits = Bits;
+	Layers[Layer].SX = SX;
+	Layers[Layer].SY = SY;
+	Layers[Layer].Stride = Stride;
+}
+
+static bool MakeGrid( int Layer, int L, PF_Grid& G )
+{
+	if (Layer < 0 || Layer >= PF_NLAYERS || !Layers[Layer].Bits || L < 1 || L > PF_MAXL)
+	{
+		return false;
+	}
+	G.Bits = Layers[Layer].Bits;
+	G.SX = Layers[Layer].SX;
+	G.SY = Layers[Layer].SY;
+	G.Stride = Layers[Layer].Stride;
+	G.L = L;
+	G.Mask = ( DWORD( 1 ) << L ) - 1;
+	return true;
+}
+
+//the LxL bar at (x,y) is free, as !MotionField::CheckBar
+static inline bool Free( const PF_Grid& G, int x, int y )
+{
+	if (x <= 0 || y <= 0 || x + G.L > G.SX || y + G.L > G.SY)
+	{
+		return false;
+	}
+	int s = y & 7;
+	int nb = ( s + G.L + 7 ) >> 3;
+	const byte* C = G.Bits + x * G.Stride + ( y >> 3 );
+	for (int i = 0; i < G.L; i++, C += G.Stride)
+	{
+		DWORD V = C[0];
+		for (int b = 1; b < nb; b++)
+		{
+			V |= DWORD( C[b] ) << ( b << 3 );
+		}
+		if (( V >> s ) & G.Mask)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+static inline int Octile( int dx, int dy )
+{
+	dx = abs( dx );
+	dy = abs( dy );
+	return dx < dy ? 14 * dx + 10 * ( dy - dx ) : 14 * dy + 10 * ( dx - dy );
+}
+
+static inline int Sign( int v )
+{
+	return v > 0 ? 1 : ( v < 0 ? -1 : 0 );
+}
+
+//open entry a comes after b
+static bool Later( const PF_Open& a, const PF_Open& b )
+{
+	if (a.f != b.f)
+	{
+		return a.f > b.f;
+	}
+	if (a.h != b.h)
+	{
+		return a.h > b.h;
+	}
+	return a.Node > b.Node;
+}
+
+static int FindNode( PF_Search& S, int Key, int& Slot )
+{
+	int M = int( S.Hash.size() ) - 1;
+	Slot = int( ( DWORD( Key ) * 2654435761u ) >> 8 ) & M;
+	while (S.Hash[Slot])
+	{
+		int n = S.Hash[Slot] - 1;
+		if (S.Nodes[n].y * 65536 + S.Nodes[n].x == Key)
+		{
+			return n;
+		}
+		Slot = ( Slot + 1 ) & M;
+	}
+	return -1;
+}
+
+static void Rehash( PF_Search& S )
+{
+	S.Hash.assign( S.Hash.size() * 2, 0 );
+	for (int n = 0; n < int( S.Nodes.size() ); n++)
+	{
+		int Slot;
+		FindNode( S, S.Nodes[n].y * 65536 + S.Nodes[n].x, Slot );
+		S.Hash[Slot] = n + 1;
+	}
+}
+
+static void AddNode( PF_Search& S, int x, int y, int g, int Parent )
+{
+	int Slot;
+	int n = FindNode( S, y * 65536 + x, Slot );
+	if (n >= 0)
+	{
+		PF_Node& N = S.Nodes[n];
+		if (N.Closed || g >= N.g)
+		{
+			return;
+		}
+		N.g = g;
+		N.Parent = Parent;
+	}
+	else
+	{
+		n = int( S.Nodes.size() );
+		PF_Node N;
+		N.x = short( x );
+		N.y = short( y );
+		N.g = g;
+		N.h = Octile( x - S.gx, y - S.gy );
+		N.Parent = Parent;
+		N.Closed = false;
+		S.Nodes.push_back( N );
+		S.Hash[Slot] = n + 1;
+		if (S.Nodes.size() * 2 > S.Hash.size())
+		{
+			Rehash( S );
+		}
+		Stats.Nodes++;
+	}
+	PF_Node& N = S.Nodes[n];
+	PF_Open O = { N.g + N.h, N.h, n };
+	S.Open.push_back( O );
+	std::push_heap( S.Open.begin(), S.Open.end(), Later );
+	PF_Node& B = S.Nodes[S.Best];
+	if (N.h < B.h || ( N.h == B.h && ( N.g < B.g || ( N.g == B.g && n < S.Best ) ) ))
+	{
+		S.Best = n;
+	}
+}
+
+//straight jump from (x,y), true with the jump point in (x,y)
+static bool JumpStraight( PF_Search& S, const PF_Grid& G, int& x, int& y, int dx, int dy )
+{
+	int cx = x;
+	int cy = y;
+	for (;;)
+	{
+		cx += dx;
+		cy += dy;
+		S.Work++;
+		if (!Free( G, cx, cy ))
+		{
+			return false;
+		}
+		bool Found = cx == S.gx && cy == S.gy;
+		if (!Found)
+		{
+			if (dx)
+			{
+				Found = ( Free( G, cx, cy - 1 ) && !Free( G, cx - dx, cy - 1 ) ) ||
+					( Free( G, cx, cy + 1 ) && !Free( G, cx - dx, cy + 1 ) );
+			}
+			else
+			{
+				Found = ( Free( G, cx - 1, cy ) && !Free( G, cx - 1, cy - dy ) ) ||
+					( Free( G, cx + 1, cy ) && !Free( G, cx + 1, cy - dy ) );
+			}
+		}
+		if (Found)
+		{
+			x = cx;
+			y = cy;
+			return true;
+		}
+	}
+}
+
+//diagonal jump from (x,y), a diagonal step needs both sides free
+static bool JumpDiagonal( PF_Search& S, const PF_Grid& G, int& x, int& y, int dx, int dy )
+{
+	int cx = x;
+	int cy = y;
+	for (;;)
+	{
+		if (!Free( G, cx + dx, cy ) || !Free( G, cx, cy + dy ))
+		{
+			return false;
+		}
+		cx += dx;
+		cy += dy;
+		S.Work++;
+		if (!Free( G, cx, cy ))
+		{
+			return false;
+		}
+		//JumpStraight moves jx,jy only when it finds a jump point
+		int jx = cx;
+		int jy = cy;
+		if (( cx == S.gx && cy == S.gy ) || JumpStraight( S, G, jx, jy, dx, 0 ) || JumpStraight( S, G, jx, jy, 0, dy ))
+		{
+			x = cx;
+			y = cy;
+			return true;
+		}
+	}
+}
+
+static void Jump( PF_Search& S, const PF_Grid& G, int n, int dx, int dy )
+{
+	int x = S.Nodes[n].x;
+	int y = S.Nodes[n].y;
+	bool Found = dx && dy ? JumpDiagonal( S, G, x, y, dx, dy ) : JumpStraight( S, G, x, y, dx, dy );
+	if (Found)
+	{
+		AddNode( S, x, y, S.Nodes[n].g + Octile( x - S.Nodes[n].x, y - S.Nodes[n].y ), n );
+	}
+}
+
+static void Expand( PF_Search& S, const PF_Grid& G, int n )
+{
+	int x = S.Nodes[n].x;
+	int y = S.Nodes[n].y;
+	int p = S.Nodes[n].Parent;
+	if (p < 0)
+	{
+		//start: every direction
+		for (int dy = -1; dy <= 1; dy++)
+		{
+			for (int dx = -1; dx <= 1; dx++)
+			{
+				if (( dx || dy ) && Free( G, x + dx, y + dy ) && ( !( dx && dy ) || ( Free( G, x + dx, y ) && Free( G, x, y + dy ) ) ))
+				{
+					Jump( S, G, n, dx, dy );
+				}
+			}
+		}
+		return;
+	}
+	int dx = Sign( x - S.Nodes[p].x );
+	int dy = Sign( y - S.Nodes[p].y );
+	if (dx && dy)
+	{
+		bool V = Free( G, x, y + dy );
+		bool H = Free( G, x + dx, y );
+		if (V)
+		{
+			Jump( S, G, n, 0, dy );
+		}
+		if (H)
+		{
+			Jump( S, G, n, dx, 0 );
+		}
+		if (V && H && Free( G, x + dx, y + dy ))
+		{
+			Jump( S, G, n, dx, dy );
+		}
+	}
+	else if (dx)
+	{
+		bool Next = Free( G, x + dx, y );
+		bool Up = Free( G, x, y - 1 );
+		bool Down = Free( G, x, y + 1 );
+		if (Next)
+		{
+			Jump( S, G, n, dx, 0 );
+			if (Up && Free( G, x + dx, y - 1 ))
+			{
+				Jump( S, G, n, dx, -1 );
+			}
+			if (Down && Free( G, x + dx, y + 1 ))
+			{
+				Jump( S, G, n, dx, 1 );
+			}
+		}
+		if (Up)
+		{
+			Jump( S, G, n, 0, -1 );
+		}
+		if (Down)
+		{
+			Jump( S, G, n, 0, 1 );
+		}
+	}
+	else
+	{
+		bool Next = Free( G, x, y + dy );
+		bool Left = Free( G, x - 1, y );
+		bool Right = Free( G, x + 1, y );
+		if (Next)
+		{
+			Jump( S, G, n, 0, dy );
+			if (Left && Free( G, x - 1, y + dy ))
+			{
+				Jump( S, G, n, -1, dy );
+			}
+			if (Right && Free( G, x + 1, y + dy ))
+			{
+				Jump( S, G, n, 1, dy );
+			}
+		}
+		if (Left)
+		{
+			Jump( S, G, n, -1, 0 );
+		}
+		if (Right)
+		{
+			Jump( S, G, n, 1, 0 );
+		}
+	}
+}
+
+static PF_Search* NewSearch( int Layer, int L, int sx, int sy, int gx, int gy, int Owner, DWORD Tag )
+{
+	PF_Search* S = new PF_Search;
+	S->Layer = Layer;
+	S->L = L;
+	S->sx = sx;
+	S->sy = sy;
+	S->gx = gx;
+	S->gy = gy;
+	S->Owner = Owner;
+	S->Tag = Tag;
+	S->Work = 0;
+	S->Best = 0;
+	S->Goal = -1;
+	S->Hash.assign( 256, 0 );
+	AddNode( *S, sx, sy, 0, -1 );
+	return S;
+}
+
+//PF_DONE when the goal is reached or nothing is left to search,
+//PF_WAIT when the budget ran out
+static int Run( PF_Search& S, const PF_Grid& G )
+{
+	while (!S.Open.empty())
+	{
+		if (Budget <= 0)
+		{
+			return PF_WAIT;
+		}
+		if (S.Work > PF_MAXWORK)
+		{
+			break;
+		}
+		PF_Open O = S.Open.front();
+		std::pop_heap( S.Open.begin(), S.Open.end(), Later );
+		S.Open.pop_back();
+		PF_Node& N = S.Nodes[O.Node];
+		if (N.Closed || N.g + N.h != O.f)
+		{
+			continue;
+		}
+		N.Closed = true;
+		if (N.x == S.gx && N.y == S.gy)
+		{
+			S.Goal = O.Node;
+			break;
+		}
+		int W = S.Work;
+		Expand( S, G, O.Node );
+		Budget -= S.Work - W + 1;
+		Stats.Cells += S.Work - W;
+	}
+	return PF_DONE;
+}
+
+//Points from the first turn to the end node, PF_STEP apart at most
+static int Finish( PF_Search& S, short* X, short* Y, int MaxN )
+{
+	int n = S.Goal >= 0 ? S.Goal : S.Best;
+	if (S.Goal < 0)
+	{
+		Stats.Partial++;
+	}
+	std::vector<int> Turns;
+	for (; S.Nodes[n].Parent >= 0; n = S.Nodes[n].Parent)
+	{
+		Turns.push_back( n );
+	}
+	int N = 0;
+	int x = S.Nodes[n].x;
+	int y = S.Nodes[n].y;
+	for (int i = int( Turns.size() ) - 1; i >= 0 && N < MaxN; i--)
+	{
+		PF_Node& T = S.Nodes[Turns[i]];
+		int dx = Sign( T.x - x );
+		int dy = Sign( T.y - y );
+		int Len = std::max( abs( T.x - x ), abs( T.y - y ) );
+		for (int s = PF_STEP; s < Len && N < MaxN; s += PF_STEP)
+		{
+			X[N] = short( x + dx * s );
+			Y[N] = short( y + dy * s );
+			N++;
+		}
+		if (N < MaxN)
+		{
+			X[N] = T.x;
+			Y[N] = T.y;
+			N++;
+		}
+		x = T.x;
+		y = T.y;
+	}
+	return N;
+}
+
+//cells of the line from (x0,y0) to (x1,y1) are free, (x0,y0) excluded
+static bool Line( const PF_Grid& G, int x0, int y0, int x1, int y1 )
+{
+	int dx = abs( x1 - x0 );
+	int dy = abs( y1 - y0 );
+	int sx = x1 > x0 ? 1 : -1;
+	int sy = y1 > y0 ? 1 : -1;
+	int e = dx - dy;
+	while (x0 != x1 || y0 != y1)
+	{
+		int e2 = e * 2;
+		if (e2 > -dy)
+		{
+			e -= dy;
+			x0 += sx;
+		}
+		if (e2 < dx)
+		{
+			e += dx;
+			y0 += sy;
+		}
+		Budget--;
+		if (!Free( G, x0, y0 ))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+//the polyline from (sx,sy) through the N points is free
+static bool PathFree( const PF_Grid& G, int sx, int sy, const short* X, const short* Y, int N )
+{
+	for (int i = 0; i < N; i++)
+	{
+		if (!Line( G, sx, sy, X[i], Y[i] ))
+		{
+			return false;
+		}
+		sx = X[i];
+		sy = Y[i];
+	}
+	return true;
+}
+
+static int FromCache( int Layer, const PF_Grid& G, int sx, int sy, int gx, int gy, short* X, short* Y, int MaxN )
+{
+	for (int i = 0; i < PF_NCACHE; i++)
+	{
+		PF_Kept& K = Kept[i];
+		if (K.X.empty() || Tick - K.Tick > PF_CACHETICKS || K.Layer != Layer || K.L != G.L ||
+			K.gx != gx || K.gy != gy || abs( K.sx - sx ) > PF_SHARE || abs( K.sy - sy ) > PF_SHARE)
+		{
+			continue;
+		}
+		//the map may have changed since the path was found
+		if (!PathFree( G, K.sx, K.sy, K.X.data(), K.Y.data(), int( K.X.size() ) ))
+		{
+			K.X.clear();
+			K.Y.clear();
+			continue;
+		}
+		if (!Line( G, sx, sy, K.X[0], K.Y[0] ))
+		{
+			continue;
+		}
+		int N = std::min( int( K.X.size() ), MaxN );
+		memcpy( X, K.X.data(), N * sizeof( short ) );
+		memcpy( Y, K.Y.data(), N * sizeof( short ) );
+		return N;
+	}
+	return 0;
+}
+
+static void Keep( PF_Search& S, short* X, short* Y, int N )
+{
+	PF_Kept& K = Kept[NextKept];
+	NextKept = ( NextKept + 1 ) % PF_NCACHE;
+	K.Layer = S.Layer;
+	K.L = S.L;
+	K.sx = S.sx;
+	K.sy = S.sy;
+	K.gx = S.gx;
+	K.gy = S.gy;
+	K.Tick = Tick;
+	K.X.assign( X, X + N );
+	K.Y.assign( Y, Y + N );
+}
+
+//path of a finished search, G is given for a search that ran over some
+//ticks and read a map that may have changed since
+static int Result( PF_Search& S, short* X, short* Y, int MaxN, const PF_Grid* G )
+{
+	bool Reached = S.Goal >= 0;
+	int N = Finish( S, X, Y, MaxN );
+	if (G && !PathFree( *G, S.sx, S.sy, X, Y, N ))
+	{
+		return 0;
+	}
+	if (Reached && N)
+	{
+		Keep( S, X, Y, N );
+	}
+	return N;
+}
+
+int PF_Find( int Layer, int L, int sx, int sy, int gx, int gy, int Owner, DWORD Tag, short* X, short* Y, int MaxN )
+{
+	PF_Grid G;
+	if (!MakeGrid( Layer, L, G ) || MaxN <= 0)
+	{
+		return PF_FAILED;
+	}
+	if (Owner >= 0)
+	{
+		//the same search goes on
+		for (PF_Search* S : Pending)
+		{
+			if (S->Owner == Owner && S->Layer == Layer && S->L == L && S->gx == gx && S->gy == gy)
+			{
+				S->Tag = Tag;
+				return PF_PENDING;
+			}
+		}
+		PF_Cancel( Owner );
+	}
+	Stats.Searches++;
+	int N = FromCache( Layer, G, sx, sy, gx, gy, X, Y, MaxN );
+	if (N)
+	{
+		Stats.CacheHits++;
+		return N;
+	}
+	if (Budget <= 0 && ( Owner < 0 || Pending.size() >= PF_MAXPENDING ))
+	{
+		return PF_FAILED;
+	}
+	PF_Search* S = NewSearch( Layer, L, sx, sy, gx, gy, Owner, Tag );
+	if (Run( *S, G ) == PF_WAIT)
+	{
+		if (Owner < 0 || Pending.size() >= PF_MAXPENDING)
+		{
+			delete S;
+			return PF_FAILED;
+		}
+		Pending.push_back( S );
+		Stats.Pending++;
+		return PF_PENDING;
+	}
+	N = Result( *S, X, Y, MaxN, nullptr );
+	delete S;
+	return N ? N : PF_FAILED;
+}
+
+void PF_Cancel( int Owner )
+{
+	for (size_t i = 0; i < Pending.size(); i++)
+	{
+		if (Pending[i]->Owner == Owner)
+		{
+			delete Pending[i];
+			Pending.erase( Pending.begin() + i );
+			return;
+		}
+	}
+}
+
+void PF_Process( PF_Done Done )
+{
+	Tick++;
+	Budget = BudgetSize / 2;
+	while (!Pending.empty() && Budget > 0)
+	{
+		PF_Search* S = Pending.front();
+		PF_Grid G;
+		if (!MakeGrid( S->Layer, S->L, G ))
+		{
+			Pending.pop_front();
+			delete S;
+			continue;
+		}
+		if (Run( *S, G ) == PF_WAIT)
+		{
+			break;
+		}
+		Pending.pop_front();
+		int N = Result( *S, OutX, OutY, PF_MAXPOINTS, &G );
+		Done( S->Owner, S->Tag, OutX, OutY, N );
+		delete S;
+	}
+	//the rest is for the searches of the next tick
+	Budget += BudgetSize - BudgetSize / 2;
+}
+
+void PF_Reset()
+{
+	for (PF_Search* S : Pending)
+	{
+		delete S;
+	}
+	Pending.clear();
+	for (int i = 0; i < PF_NCACHE; i++)
+	{
+		Kept[i].X.clear();
+		Kept[i].Y.clear();
+	}
+	NextKept = 0;
+	Budget = BudgetSize;
+}
+
+void PF_SetBudget( int Cells )
+{
+	BudgetSize = Cells > 0 ? Cells : PF_BUDGET;
+	Budget = BudgetSize;
+}
+
+void PF_GetStats( PF_Stats* S )
+{
+	*S = Stats;
+}
+
+void PF_ClearStats()
+{
+	memset( &Stats, 0, sizeof Stats );
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+/*
+	Grid pathfinder over the MotionField bit maps.
+
+	A* with jump point search on the 8-connected grid of a layer (0 -
+	land, 1 - water). A unit of size L may stand at (x,y) if the LxL bar
+	at (x,y) is free, the same test as MotionField::CheckBar. Diagonal
+	steps need both orthogonal neighbours free, so paths never cut a
+	corner. Straight steps cost 10, diagonal ones 14.
+
+	The work of all searches is counted in visited cells. Every tick
+	PF_Process() refills the budget, spends up to half of it on the
+	pending searches, oldest first, and leaves the rest to the searches
+	started during the tick. A search that runs out of budget becomes
+	pending and is continued next tick; its path is handed to the Done
+	callback of PF_Process(). A search that can not reach the goal, or
+	takes more than PF_MAXWORK cells, ends at the visited cell nearest to
+	the goal.
+
+	Found paths are kept for PF_CACHETICKS ticks. A unit within
+	PF_SHARE cells of the start of a kept path with the same goal, layer
+	and size takes it if it can walk straight to its first point. The
+	map may change meanwhile, so the whole kept path is walked again
+	first and dropped if it is no longer free. The path of a pending
+	search is checked the same way before it goes to Done; a blocked one
+	is handed out as no path.
+
+	Everything depends only on the maps and the order of the calls, so
+	all peers find the same paths. The pending searches, the kept paths
+	and the budget are not saved; saving and loading a map both call
+	PF_Reset(), so a saved game goes on the same way as its load.
+*/
+
+//The game headers leave pack(1) on, the module is built without it
+#pragma pack(push)
+#pragma pack()
+
+#define PF_NLAYERS 2
+#define PF_MAXPOINTS 1024
+
+#define PF_PENDING 0
+#define PF_FAILED -1
+
+//Column major bit map of a layer, bit y&7 of Bits[x*Stride+(y>>3)] is a
+//locked point
+void PF_SetField( int Layer, const byte* Bits, int SX, int SY, int Stride );
+
+//Path for a unit of size L from (sx,sy) to (gx,gy). Returns the number of
+//points written to X/Y, from the first turn to the goal, or PF_PENDING if
+//the search goes on in PF_Process, or PF_FAILED. Owner<0 never waits:
+//without budget the search fails. One pending search per Owner, a new
+//one with the same goal keeps it going. Tag is given back with the path.
+int PF_Find( int Layer, int L, int sx, int sy, int gx, int gy, int Owner, DWORD Tag, short* X, short* Y, int MaxN );
+
+//Drops the pending search of Owner
+void PF_Cancel( int Owner );
+
+//Path of a pending search of Owner
+typedef void ( *PF_Done )( int Owner, DWORD Tag, short* X, short* Y, int N );
+
+//Next tick: refills the budget and continues the pending searches
+void PF_Process( PF_Done Done );
+
+//Drops the pending searches and the kept paths, for a new map
+void PF_Reset();
+
+//Cells per tick, the default is PF_BUDGET
+void PF_SetBudget( int Cells );
+
+struct PF_Stats
+{
+	int Searches;
+	int CacheHits;
+	int Pending;
+	int Partial;
+	int Nodes;
+	int Cells;
+};
+
+void PF_GetStats( PF_Stats* S );
+void PF_ClearStats();
+
+#pragma pack(pop)
@@ -0,0 +1,158 @@
+#include "../cross_platform/platform_compat.h"
+#include "SlabPool.h"
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+SlabPool::SlabPool( int BlockSize, int NPerSlab )
+{
+	Size = BlockSize > 0 ? ( BlockSize + 7 ) & ~7 : 8;
+	Stride = int( ( sizeof( Block ) + 7 ) & ~7 ) + Size;
+	PerSlab = NPerSlab > 0 ? NPerSlab : 1;
+	FreeList = nullptr;
+#ifdef _DEBUG
+	Poison = true;
+#else
+	Poison = false;
+#endif
+	Live = 0;
+	High = 0;
+	LastHigh = 0;
+	Peak = 0;
+	BadFrees = 0;
+}
+
+SlabPool::~SlabPool()
+{
+	for (char* S : Slabs)
+	{
+		free( S );
+	}
+}
+
+void SlabPool::AddSlab()
+{
+	char* S = (char*) malloc( size_t( Stride ) * PerSlab );
+	Slabs.push_back( S );
+	if (Poison)
+	{
+		memset( S, SP_POISON, size_t( Stride ) * PerSlab );
+	}
+	//first block of the slab is handed out first
+	for (int i = PerSlab - 1; i >= 0; i--)
+	{
+		Block* B = (Block*) ( S + size_t( i ) * Stride );
+		B->Next = FreeList;
+		B->State = SP_FREE;
+		FreeList = B;
+	}
+}
+
+//true if the block behind the header is filled with SP_POISON
+bool SlabPool::IsPoisoned( Block* B )
+{
+	byte* p = (byte*) B + Stride - Size;
+	for (int i = 0; i < Size; i++)
+	{
+		if (p[i] != SP_POISON)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+void* SlabPool::Alloc()
+{
+	if (!FreeList)
+	{
+		AddSlab();
+	}
+	Block* B = FreeList;
+	FreeList = B->Next;
+	B->State = SP_LIVE;
+	if (Poison)
+	{
+		//written after it was freed
+		assert( IsPoisoned( B ) );
+	}
+	byte* p = (byte*) B + Stride - Size;
+	memset( p, 0, Size );
+	Live++;
+	if (Live > High)
+	{
+		High = Live;
+	}
+	if (Live > Peak)
+	{
+		Peak = Live;
+	}
+	return p;
+}
+
+void SlabPool::Free( void* p )
+{
+	if (!p)
+	{
+		return;
+	}
+	Block* B = (Block*) ( (byte*) p - ( Stride - Size ) );
+	if (B->State != SP_LIVE)
+	{
+		//freed twice, a second link would hand it out twice
+		BadFrees++;
+		return;
+	}
+	if (Poison)
+	{
+		memset( p, SP_POISON, Size );
+	}
+	B->State = SP_FREE;
+	B->Next = FreeList;
+	FreeList = B;
+	Live--;
+}
+
+void SlabPool::SetPoison( bool On )
+{
+	if (On && !Poison)
+	{
+		//blocks freed so far are not filled
+		for (Block* B = FreeList; B; B = B->Next)
+		{
+			memset( (byte*) B + Stride - Size, SP_POISON, Size );
+		}
+	}
+	Poison = On;
+}
+
+void SlabPool::NewFrame()
+{
+	LastHigh = High;
+	High = Live;
+}
+
+int SlabPool::GetLive()
+{
+	return Live;
+}
+
+int SlabPool::GetFrameHigh()
+{
+	return LastHigh;
+}
+
+int SlabPool::GetPeak()
+{
+	return Peak;
+}
+
+int SlabPool::GetCapacity()
+{
+	return int( Slabs.size() ) * PerSlab;
+}
+
+int SlabPool::GetBadFrees()
+{
+	return BadFrees;
+}
@@ -0,0 +1,80 @@
+#pragma once
+#include <vector>
+
+/*
+	Pool of fixed size blocks cut from slabs of PerSlab blocks.
+	Freed blocks go to a free list and are handed out again before a
+	new slab is taken; slabs are only released with the pool. Alloc()
+	returns a zeroed block. The pool is not thread safe.
+
+	Every block has a small header in front of it with the free list
+	link and its state. Free() of a block that is not in use (freed
+	twice, or not from this pool) is refused and counted in
+	GetBadFrees(), in every build, so a double free never hands the
+	block out twice.
+
+	With poisoning on (the default of _DEBUG builds) a freed block is
+	also filled with SP_POISON, and Alloc() asserts that the fill is
+	intact, which catches writes through stale pointers.
+*/
+
+//The game headers leave pack(1) on, the module is built without it
+#pragma pack(push)
+#pragma pack()
+
+#define SP_POISON 0xDD
+//States in the block headers
+#define SP_FREE 0x46524545
+#define SP_LIVE 0x4C495645
+
+class SlabPool
+{
+public:
+	SlabPool( int Size, int PerSlab );
+	~SlabPool();
+
+	void* Alloc();
+	void Free( void* p );
+
+	void SetPoison( bool On );
+
+	//Closes the frame of the high-water statistics
+	void NewFrame();
+	//Blocks in use
+	int GetLive();
+	//Most blocks in use during the last closed frame
+	int GetFrameHigh();
+	//Most blocks in use since the pool was created
+	int GetPeak();
+	//Blocks in all slabs
+	int GetCapacity();
+	//Refused calls of Free()
+	int GetBadFrees();
+
+private:
+	struct Block
+	{
+		Block* Next;
+		int State;
+	};
+
+	void AddSlab();
+	bool IsPoisoned( Block* B );
+
+	//size of a block without the header
+	int Size;
+	//distance of the blocks in a slab
+	int Stride;
+	int PerSlab;
+	std::vector<char*> Slabs;
+	Block* FreeList;
+	bool Poison;
+
+	int Live;
+	int High;
+	int LastHigh;
+	int Peak;
+	int BadFrees;
+};
+
+#pragma pack(pop)
@@ -0,0 +1,336 @@
+#include "../cross_platform/platform_compat.h"
+#include "TargetQuery.h"
+#include "CellBuckets.h"
+#include "ObjHot.h"
+#include <stdlib.h>
+#include <string.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+#define TQ_NBITS 8
+
+//cells with an object of nation bit b
+static DWORD* Occ[TQ_NBITS];
+static int MaxCX = 0;
+static int ShfCX = 0;
+//DWORDs in a bitset row
+static int RowW = 0;
+
+static inline int LowBit( DWORD V )
+{
+#ifdef _MSC_VER
+	unsigned long r;
+	_BitScanForward( &r, V );
+	return int( r );
+#else
+	return __builtin_ctz( V );
+#endif
+}
+
+void TQ_Init( int CX, int Shift )
+{
+	TQ_Free();
+	MaxCX = CX;
+	ShfCX = Shift;
+	RowW = ( CX + 31 ) >> 5;
+	for (int b = 0; b < TQ_NBITS; b++)
+	{
+		Occ[b] = (DWORD*) calloc( RowW * CX, sizeof( DWORD ) );
+	}
+	TQ_Clear();
+}
+
+void TQ_Free()
+{
+	for (int b = 0; b < TQ_NBITS; b++)
+	{
+		free( Occ[b] );
+		Occ[b] = nullptr;
+	}
+	MaxCX = 0;
+}
+
+void TQ_Clear()
+{
+	if (!MaxCX)
+	{
+		return;
+	}
+	for (int b = 0; b < TQ_NBITS; b++)
+	{
+		memset( Occ[b], 0, RowW * MaxCX * sizeof( DWORD ) );
+	}
+}
+
+void TQ_Occupy( int Cell, byte NMask )
+{
+	int x = Cell & ( MaxCX - 1 );
+	int y = Cell >> ShfCX;
+	if (y >= MaxCX)
+	{
+		return;
+	}
+	int w = y * RowW + ( x >> 5 );
+	DWORD B = DWORD( 1 ) << ( x & 31 );
+	for (int b = 0; b < TQ_NBITS; b++)
+	{
+		if (NMask & ( 1 << b ))
+		{
+			Occ[b][w] |= B;
+		}
+	}
+}
+
+//bits of the cells x0..x1 of row y in word w that hold a nation of Mask
+static DWORD RowWord( int y, int w, int x0, int x1, byte Mask )
+{
+	DWORD M = 0xFFFFFFFF;
+	if (x0 > ( w << 5 ))
+	{
+		M &= 0xFFFFFFFF << ( x0 & 31 );
+	}
+	if (x1 < ( w << 5 ) + 31)
+	{
+		M &= 0xFFFFFFFF >> ( 31 - ( x1 & 31 ) );
+	}
+	DWORD V = 0;
+	int ofs = y * RowW + w;
+	for (int b = 0; b < TQ_NBITS; b++)
+	{
+		if (Mask & ( 1 << b ))
+		{
+			V |= Occ[b][ofs];
+		}
+	}
+	return V & M;
+}
+
+static bool RowAny( int y, int x0, int x1, byte Mask )
+{
+	if (y < 0 || y >= MaxCX)
+	{
+		return false;
+	}
+	if (x0 < 0)
+	{
+		x0 = 0;
+	}
+	if (x1 >= MaxCX)
+	{
+		x1 = MaxCX - 1;
+	}
+	for (int w = x0 >> 5; w <= ( x1 >> 5 ); w++)
+	{
+		if (RowWord( y, w, x0, x1, Mask ))
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+bool TQ_Any( int Cell, int R, byte Mask )
+{
+	if (!MaxCX)
+	{
+		return false;
+	}
+	int x = Cell & ( MaxCX - 1 );
+	int y = Cell >> ShfCX;
+	for (int yy = y - R; yy <= y + R; yy++)
+	{
+		if (RowAny( yy, x - R, x + R, Mask ))
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+struct TQ_Best
+{
+	int x, y;
+	TQ_Filter Filter;
+	void* Param;
+	word* Res;
+	long long D[TQ_MAXK];
+	int N;
+	int K;
+};
+
+static void AddUnit( TQ_Best& B, word MID )
+{
+	long long dx = OH_X[MID] - B.x;
+	long long dy = OH_Y[MID] - B.y;
+	long long D = dx * dx + dy * dy;
+	if (B.N == B.K && ( D > B.D[B.N - 1] || ( D == B.D[B.N - 1] && MID > B.Res[B.N - 1] ) ))
+	{
+		return;
+	}
+	if (B.Filter && !B.Filter( MID, B.Param ))
+	{
+		return;
+	}
+	int p = B.N < B.K ? B.N++ : B.N - 1;
+	while (p > 0 && ( B.D[p - 1] > D || ( B.D[p - 1] == D && B.Res[p - 1] > MID ) ))
+	{
+		B.D[p] = B.D[p - 1];
+		B.Res[p] = B.Res[p - 1];
+		p--;
+	}
+	B.D[p] = D;
+	B.Res[p] = MID;
+}
+
+static CB_Cell* UnitsOf( int x, int y )
+{
+	//cell lists are shifted by one row and one column
+	int Cell = ( y << ShfCX ) + x + MaxCX + 1;
+	return Cell < MaxCX * MaxCX ? CB_Units + Cell : nullptr;
+}
+
+//Calls Do( CB_Cell& ) for the cells x0..x1 of row y that hold a nation of Mask
+template <class F>
+static void WalkRow( int y, int x0, int x1, byte Mask, F& Do )
+{
+	if (y < 0 || y >= MaxCX)
+	{
+		return;
+	}
+	if (x0 < 0)
+	{
+		x0 = 0;
+	}
+	if (x1 >= MaxCX)
+	{
+		x1 = MaxCX - 1;
+	}
+	for (int w = x0 >> 5; w <= ( x1 >> 5 ); w++)
+	{
+		DWORD V = RowWord( y, w, x0, x1, Mask );
+		while (V)
+		{
+			int b = LowBit( V );
+			V &= V - 1;
+			CB_Cell* C = UnitsOf( ( w << 5 ) + b, y );
+			if (C)
+			{
+				Do( *C );
+			}
+		}
+	}
+}
+
+//The cells of the square ring r around (cx,cy)
+template <class F>
+static void WalkRing( int cx, int cy, int r, byte Mask, F& Do )
+{
+	WalkRow( cy - r, cx - r, cx + r, Mask, Do );
+	if (r)
+	{
+		for (int yy = cy - r + 1; yy < cy + r; yy++)
+		{
+			WalkRow( yy, cx - r, cx - r, Mask, Do );
+			WalkRow( yy, cx + r, cx + r, Mask, Do );
+		}
+		WalkRow( cy + r, cx - r, cx + r, Mask, Do );
+	}
+}
+
+//the next ring is at least r cells away
+static bool Enough( const TQ_Best& B, int r )
+{
+	long long Far = (long long) ( r << 11 ) * ( r << 11 );
+	return B.N == B.K && B.D[B.K - 1] <= Far;
+}
+
+static void InitBest( TQ_Best& B, int x, int y, TQ_Filter Filter, void* Param, word* Result, int K )
+{
+	B.x = x;
+	B.y = y;
+	B.Filter = Filter;
+	B.Param = Param;
+	B.Res = Result;
+	B.N = 0;
+	B.K = K > TQ_MAXK ? TQ_MAXK : K;
+}
+
+int TQ_Nearest( int x, int y, int R, byte Mask, TQ_Filter Filter, void* Param, word* Result, int K )
+{
+	int cx = x >> 11;
+	int cy = y >> 11;
+	if (K <= 0 || cx < 0 || cy < 0 || cx >= MaxCX || cy >= MaxCX || !TQ_Any( ( cy << ShfCX ) + cx, R, Mask ))
+	{
+		return 0;
+	}
+	TQ_Best B;
+	InitBest( B, x, y, Filter, Param, Result, K );
+	auto Add = [&B]( CB_Cell& C )
+	{
+		for (int i = 0; i < C.N; i++)
+		{
+			AddUnit( B, C.List[i] );
+		}
+	};
+	for (int r = 0; r <= R; r++)
+	{
+		WalkRing( cx, cy, r, Mask, Add );
+		if (Enough( B, r ))
+		{
+			break;
+		}
+	}
+	return B.N;
+}
+
+void TQ_RingsInit( TQ_Rings* C, int Cell, int R, byte Mask, TQ_Filter Filter, void* Param )
+{
+	C->Cell = Cell;
+	C->R = R;
+	C->Mask = Mask;
+	C->Filter = Filter;
+	C->Param = Param;
+	C->Any = MaxCX && Cell >= 0 && ( Cell >> ShfCX ) < MaxCX && TQ_Any( Cell, R, Mask );
+	C->Start.assign( 1, 0 );
+	C->Units.clear();
+}
+
+int TQ_NearestIn( TQ_Rings* C, int x, int y, TQ_Filter Filter, void* Param, word* Result, int K )
+{
+	if (K <= 0 || !C->Any)
+	{
+		return 0;
+	}
+	int cx = C->Cell & ( MaxCX - 1 );
+	int cy = C->Cell >> ShfCX;
+	TQ_Best B;
+	InitBest( B, x, y, Filter, Param, Result, K );
+	auto Collect = [C]( CB_Cell& Cell )
+	{
+		for (int i = 0; i < Cell.N; i++)
+		{
+			if (C->Filter( Cell.List[i], C->Param ))
+			{
+				C->Units.push_back( Cell.List[i] );
+			}
+		}
+	};
+	for (int r = 0; r <= C->R; r++)
+	{
+		if (r + 1 == int( C->Start.size() ))
+		{
+			WalkRing( cx, cy, r, C->Mask, Collect );
+			C->Start.push_back( int( C->Units.size() ) );
+		}
+		for (int i = C->Start[r]; i < C->Start[r + 1]; i++)
+		{
+			AddUnit( B, C->Units[i] );
+		}
+		if (Enough( B, r ))
+		{
+			break;
+		}
+	}
+	return B.N;
+}
@@ -0,0 +1,70 @@
+#pragma once
+#include <vector>
+
+/*
+	Nearest target queries over the 2048 point cell grid.
+
+	For every nation bit there is a bitset of the cells that hold an
+	object with that bit in its NMask, the same data as NPresence. It is
+	rebuilt once per tick with TQ_Clear() and TQ_Occupy(). A query walks
+	square rings around the start cell, skips empty rows with the
+	bitsets, and tests the units of the cell lists (CellBuckets.h) with
+	the filter of the caller. It returns the K nearest accepted units,
+	nearest first. Ties go to the lower index, so the result is the same
+	on every peer.
+
+	Queries only read the map and the objects, so they may run on the
+	workers of JOBS.
+
+	Units of one cell that ask with the same R, Mask and a filter that
+	does not depend on the asking point can share a TQ_Rings: the units
+	that filter accepts are collected ring by ring, once, as far as the
+	first query needs them. TQ_NearestIn() then only measures those and
+	gives what TQ_Nearest() gives with both filters. The objects must not
+	change while a TQ_Rings is used.
+
+	Cells are in NPresence coordinates: (y>>11)<<Shift + (x>>11).
+*/
+
+//The game headers leave pack(1) on, the module is built without it
+#pragma pack(push)
+#pragma pack()
+
+//true if the unit Index is a target, Param is the one given to the query
+typedef bool ( *TQ_Filter )( word Index, void* Param );
+
+void TQ_Init( int MaxCX, int Shift );
+void TQ_Free();
+
+//Empties the occupancy bitsets
+void TQ_Clear();
+void TQ_Occupy( int Cell, byte NMask );
+
+//true if a cell within R cells of Cell holds an object of a nation in Mask
+bool TQ_Any( int Cell, int R, byte Mask );
+
+#define TQ_MAXK 4
+
+//Up to K units accepted by Filter in the cells within R cells of the cell
+//of (x,y) that hold an object of a nation in Mask, nearest first
+int TQ_Nearest( int x, int y, int R, byte Mask, TQ_Filter Filter, void* Param, word* Result, int K );
+
+struct TQ_Rings
+{
+	int Cell;
+	int R;
+	byte Mask;
+	TQ_Filter Filter;
+	void* Param;
+	bool Any;
+	//units of ring r are Units[Start[r]..Start[r+1])
+	std::vector<int> Start;
+	std::vector<word> Units;
+};
+
+//Starts the shared units of Cell, the rings are collected by TQ_NearestIn
+void TQ_RingsInit( TQ_Rings* C, int Cell, int R, byte Mask, TQ_Filter Filter, void* Param );
+//TQ_Nearest from (x,y) in the cell of C, Filter may be nullptr
+int TQ_NearestIn( TQ_Rings* C, int x, int y, TQ_Filter Filter, void* Param, word* Result, int K );
+
+#pragma pack(pop)
@@ -0,0 +1,211 @@
+#include "../cross_platform/platform_compat.h"
+#include "TerrainRaster.h"
+#include "JobPool.h"
+
+//Same limit as the VertBuf of 3DGraph.cpp
+#define TR_MAX_LINES 2048
+
+//One line of the triangle; X1/X2 are the edge crossings (0xFFFF - none),
+//after the setup X1 is the start relative to the first vertex and X2 the length
+struct TR_Line
+{
+	word X1;
+	word X2;
+	DWORD BMX;
+	DWORD BMY;
+	DWORD Fog;
+};
+
+struct TR_Context
+{
+	TR_Line Lines[TR_MAX_LINES];
+	int CurX;
+	int CurY;
+};
+
+static thread_local TR_Context Context;
+static thread_local byte Mask[TR_MASK_SIZE];
+
+byte* TR_GetThreadMask()
+{
+	return Mask;
+}
+
+void TR_ParallelFor( int N, void( *Job )( int Index, void* Param ), void* Param )
+{
+	JOBS.ParallelFor( N, Job, Param );
+}
+
+//Walks the edge from the current point to (x,y) and stores one crossing
+//per line. The second crossing is replaced by every new distinct value.
+static void AddLine( TR_Context* C, int x, int y )
+{
+	int dy = abs( y - C->CurY ) + 1;
+	int step = y < C->CurY ? -1 : 1;
+	DWORD sdx = 0;
+	if (y != C->CurY)
+	{
+		sdx = DWORD( int( DWORD( x - C->CurX ) << 16 ) / abs( y - C->CurY ) );
+	}
+	TR_Line* L = C->Lines + C->CurY;
+	DWORD pos = ( DWORD( C->CurX ) << 16 ) + 32768;
+	for (; dy > 0; dy--, L += step, pos += sdx)
+	{
+		word px = word( pos >> 16 );
+		if (L->X1 == 0xFFFF)
+		{
+			L->X1 = px;
+		}
+		else if (L->X2 == 0xFFFF)
+		{
+			L->X2 = px;
+		}
+		else if (px != L->X1 && px != L->X2)
+		{
+			L->X2 = px;
+		}
+	}
+	C->CurX = x;
+	C->CurY = y;
+}
+
+void TR_RenderTriangle64( int xs1, int ys1, int xs2, int ys2, int xs3, int ys3,
+	int xb1, int yb1, int xb2, int yb2, int xb3, int yb3,
+	int f1, int f2, int f3,
+	byte* Dest, const byte* Bitm,
+	int StartLine, int EndLine, int ScanSize, const byte* FogTable )
+{
+	StartLine -= ys1;
+	EndLine -= ys1;
+	Dest += xs1 + ys1 * ScanSize;
+	int dxb2 = xb2 - xb1;
+	int dxb3 = xb3 - xb1;
+	int dyb2 = yb2 - yb1;
+	int dyb3 = yb3 - yb1;
+	int dxs2 = xs2 - xs1;
+	int dxs3 = xs3 - xs1;
+	int dys2 = ys2 - ys1;
+	int dys3 = ys3 - ys1;
+
+	int D = dxs2 * dys3 - dys2 * dxs3;
+	if (!D)
+	{
+		return;
+	}
+	//texture gradients, 16.16
+	int Axx = int( DWORD( dys3 * dxb2 - dxb3 * dys2 ) << 16 ) / D;
+	int Axy = int( DWORD( dxs2 * dxb3 - dxb2 * dxs3 ) << 16 ) / D;
+	int Ayx = int( DWORD( dys3 * dyb2 - dyb3 * dys2 ) << 16 ) / D;
+	int Ayy = int( DWORD( dxs2 * dyb3 - dyb2 * dxs3 ) << 16 ) / D;
+	//fog gradients
+	int DScr = -D;
+	int FDx = 0;
+	int FDy = 0;
+	if (DScr)
+	{
+		FDx = int( DWORD( ( f3 - f1 ) * dys2 - dys3 * ( f2 - f1 ) ) << 16 ) / DScr;
+		FDy = int( DWORD( ( f2 - f1 ) * dxs3 - dxs2 * ( f3 - f1 ) ) << 16 ) / DScr;
+	}
+	DWORD BMX = ( DWORD( xb1 & 255 ) << 16 ) + 32768;
+	DWORD BMY = ( DWORD( yb1 & 255 ) << 16 ) + 32768;
+	DWORD Fog = ( DWORD( f1 ) << 16 ) + 32768;
+
+	//edge walk
+	int z1 = ys1;
+	int z2 = ys1;
+	if (ys2 < z1)z1 = ys2;
+	if (ys3 < z1)z1 = ys3;
+	if (ys2 > z2)z2 = ys2;
+	if (ys3 > z2)z2 = ys3;
+	int NLines = z2 - z1 + 1;
+	if (NLines > TR_MAX_LINES)
+	{
+		return;
+	}
+	TR_Context* C = &Context;
+	for (int i = 0; i < NLines; i++)
+	{
+		C->Lines[i].X1 = 0xFFFF;
+		C->Lines[i].X2 = 0xFFFF;
+	}
+	C->CurX = xs1;
+	C->CurY = ys1 - z1;
+	AddLine( C, xs2, ys2 - z1 );
+	AddLine( C, xs3, ys3 - z1 );
+	AddLine( C, xs1, ys1 - z1 );
+
+	//span setup: start, length and texture/fog values at the span start
+	int StartX = xs1;
+	int StartY = ys1 - z1;
+	TR_Line* L = C->Lines;
+	word curx;
+	if (L->X1 == 0xFFFF)
+	{
+		return;
+	}
+	curx = L->X2 != 0xFFFF && L->X2 < L->X1 ? L->X2 : L->X1;
+	DWORD bx = BMX + DWORD( Axx ) * DWORD( curx - StartX ) - DWORD( Axy ) * DWORD( StartY );
+	DWORD by = BMY + DWORD( Ayx ) * DWORD( curx - StartX ) - DWORD( Ayy ) * DWORD( StartY );
+	DWORD fog = Fog + DWORD( FDx ) * DWORD( curx - StartX ) - DWORD( FDy ) * DWORD( StartY );
+	for (int i = 0; i < NLines; i++, L++)
+	{
+		word a = L->X1;
+		word b = L->X2 == 0xFFFF ? a : L->X2;
+		if (b < a)
+		{
+			word t = a;
+			a = b;
+			b = t;
+		}
+		L->X2 = word( b - a );
+		//the values follow the span start from line to line
+		DWORD n = DWORD( int( a ) - int( curx ) );
+		bx += DWORD( Axx ) * n;
+		by += DWORD( Ayx ) * n;
+		fog += DWORD( FDx ) * n;
+		L->Fog = fog;
+		fog += DWORD( FDy );
+		curx = a;
+		L->X1 = word( a - word( StartX ) );
+		L->BMX = bx;
+		L->BMY = by;
+		bx += DWORD( Axy );
+		by += DWORD( Ayy );
+	}
+
+	//spans
+	int Start = StartLine + ys1 - z1;
+	int End = EndLine + ys1 - z1;
+	if (Start >= NLines || End < 0)
+	{
+		return;
+	}
+	if (Start < 0)Start = 0;
+	if (End >= NLines)End = NLines - 1;
+	byte* Row = Dest + ( z1 - ys1 ) * ScanSize + Start * ScanSize;
+	//the fog dither pattern starts shifted on triangles with an odd height
+	DWORD fog0 = ( NLines & 1 ) ? 16384 : 0;
+	const byte* Fog16 = FogTable + 16384;
+	for (int i = Start; i <= End; i++, Row += ScanSize)
+	{
+		const TR_Line* S = C->Lines + i;
+		byte* d = Row + short( S->X1 );
+		int n = S->X2;
+		DWORD tx = S->BMX;
+		DWORD ty = S->BMY;
+		for (int k = 0; k < n; k++)
+		{
+			d[k] = Bitm[( ( ty >> 8 ) & 0x3F00 ) + ( ( tx >> 16 ) & 0x3F )];
+			tx += DWORD( Axx );
+			ty += DWORD( Ayx );
+		}
+		DWORD f = S->Fog + fog0;
+		for (int k = 0; k < n; k++)
+		{
+			int idx = ( int( f ) >> 8 ) & ~0xFF;
+			d[k] = Fog16[idx | d[k]];
+			f += DWORD( FDx );
+			f += ( k & 1 ) ? DWORD( -32768 ) : DWORD( 32768 );
+		}
+	}
+}
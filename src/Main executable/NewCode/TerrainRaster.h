@@ -0,0 +1,31 @@
+#pragma once
+
+/*
+	Portable terrain triangle rasterizer of the VirtualScreen.
+
+	TR_RenderTriangle64() is the C version of the old DirectRenderTriangle64()
+	assembler chain (edge walk, span setup, textured span with dithered fog)
+	and writes the same bytes. All scratch state lives in a per-thread
+	context, so triangles of different screen tiles may be rasterized on
+	the JobPool workers at the same time.
+
+	A triangle only writes the columns [min x, max x) of its vertices and
+	the rows StartLine..EndLine of the destination.
+*/
+
+//Side of the 64x64 texture and mask bitmaps, the rows are 256 bytes apart
+#define TR_MASK_SIZE ( 64 * 256 )
+
+//xs,ys - screen vertices, xb,yb - texture vertices, f - fog of the vertices.
+//Bitm is a 64x64 bitmap with 256 bytes per row, FogTable the darkfog table.
+void TR_RenderTriangle64( int xs1, int ys1, int xs2, int ys2, int xs3, int ys3,
+	int xb1, int yb1, int xb2, int yb2, int xb3, int yb3,
+	int f1, int f2, int f3,
+	byte* Dest, const byte* Bitm,
+	int StartLine, int EndLine, int ScanSize, const byte* FogTable );
+
+//Mask buffer of the calling thread for PrepareIntersection1/2()
+byte* TR_GetThreadMask();
+
+//Runs Job( 0..N-1, Param ) on the JobPool
+void TR_ParallelFor( int N, void( *Job )( int Index, void* Param ), void* Param );
@@ -0,0 +1,54 @@
+#include "../cross_platform/platform_compat.h"
+#include "ZSort.h"
+
+void ZS_RadixSort( const DWORD* Keys, int N, int KeyBits, int* Order, int* Temp )
+{
+	for (int i = 0; i < N; i++)
+	{
+		Order[i] = i;
+	}
+	if (N < 2)
+	{
+		return;
+	}
+
+	int* Src = Order;
+	int* Dst = Temp;
+	int Count[256];
+	for (int Shift = 0; Shift < KeyBits; Shift += 8)
+	{
+		//the last digit may be narrower, the bits above KeyBits are not compared
+		DWORD Digit = KeyBits - Shift < 8 ? ( DWORD( 1 ) << ( KeyBits - Shift ) ) - 1 : 255;
+		memset( Count, 0, sizeof Count );
+		for (int i = 0; i < N; i++)
+		{
+			Count[( Keys[i] >> Shift ) & Digit]++;
+		}
+		if (Count[( Keys[0] >> Shift ) & Digit] == N)
+		{
+			continue;
+		}
+
+		int Pos = 0;
+		for (int d = 0; d < 256; d++)
+		{
+			int c = Count[d];
+			Count[d] = Pos;
+			Pos += c;
+		}
+		for (int i = 0; i < N; i++)
+		{
+			int k = Src[i];
+			Dst[Count[( Keys[k] >> Shift ) & Digit]++] = k;
+		}
+
+		int* t = Src;
+		Src = Dst;
+		Dst = t;
+	}
+
+	if (Src != Order)
+	{
+		memcpy( Order, Src, N * sizeof( int ) );
+	}
+}
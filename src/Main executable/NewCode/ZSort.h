@@ -0,0 +1,12 @@
+#pragma once
+
+/*
+	Stable LSD radix sort for the Z-buffer draw list.
+	Sorts indices by 32-bit keys, 8 bits per pass. Passes where all keys
+	have the same digit are skipped, so a key with few used bits costs
+	only the passes it needs.
+*/
+
+//Order gets the indices 0..N-1 ordered by Keys, equal keys keep their
+//order. Temp must hold N ints. Only the lowest KeyBits bits are compared.
+void ZS_RadixSort( const DWORD* Keys, int N, int KeyBits, int* Order, int* Temp );
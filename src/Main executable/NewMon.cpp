@@ -20,6 +20,7 @@
 #include "Megapolis.h"
 
 #include <assert.h>
+#include <algorithm>
 #include "walls.h"
 #include "mode.h"
 #include "GSound.h"
@@ -46,6 +47,9 @@
 #include "StrategyResearch.h"
 #include "EinfoClass.h"
 #include "Sort.h"
+#include "NewCode/ObjIndex.h"
+#include "NewCode/TargetQuery.h"
+#include "NewCode/JobPool.h"
 
 extern const int kImportantMessageDisplayTime;
 extern const int kSystemMessageDisplayTime;
@@ -268,6 +272,7 @@ void InitAllGame()
 	ClearMaps();
 
 	memset( Group, 0, sizeof Group );
+	ReindexObjects();
 	memset( Sprites, 0, sizeof Sprites );
 	memset( NSL, 0, sizeof NSL );
 }
@@ -3951,9 +3956,7 @@ void SprGroup::LoadSprites( char* fname )
 //                       PHYSICS OF THE NEW MONSTER                      //
 //           New monsters choose freedom from cells through cells!       //
 //-----------------------------------------------------------------------//
-byte* MCount;//amount of monsters in 4x4 cell; 16384 elements
-byte* TmpMC; //amount of monsters in 4x4 cell,
-						  //this is used only for force calculating
+word* MCount;//amount of monsters in 4x4 cell; 16384 elements
 //word* NMsList;//array of ID of new monsters
 word* BLDList;
 void ZMem( byte* pntr, int siz )
@@ -3993,100 +3996,6 @@ word GetDir( int dx, int dy )
 	else PhDir = 64 + 128;
 	return ( PhDir + 1024 ) & 255;
 };
-//calculating forces, that acts to every monster
-void CalculateForces()
-{
-	int nmon, FX, FY, FX1, FY1, ofs0, ofs1, ofs2, R1, R2, RE1, RE2;
-	int ox, oy, nmon1, dr;
-	OneObject* OB;
-	OneObject* EN;
-	int NNN = VAL_MAXCX*( VAL_MAXCX - 1 ) - 1;
-	int NNN2 = ( 1 + VAL_MAXCX )*MAXINCELL;
-	int NNN3 = ( VAL_MAXCX - 3 )*MAXINCELL;
-	for ( int i = VAL_MAXCX + 1; i < NNN; i++ )
-	{
-		nmon = TmpMC[i];
-		ofs2 = i << SHFCELL;
-		while ( nmon )
-		{
-			nmon--;
-			TmpMC[i]--;
-			OB = Group[GetNMSL( ofs2 + nmon )];
-			if ( OB )
-			{
-				ox = OB->RealX;
-				oy = OB->RealY;
-				R1 = OB->Radius1;
-				R2 = OB->Radius2;
-				ofs0 = i - 1 - VAL_MAXCX;
-				ofs1 = ofs2 - NNN2;
-				FX = 0; FY = 0;
-				for ( int ddy = 0; ddy < 3; ddy++ )
-				{
-					for ( int ddx = 0; ddx < 3; ddx++ )
-					{
-						nmon1 = TmpMC[ofs0];
-						if ( nmon1 )
-						{
-							for ( int p = 0; p < nmon1; p++ )
-							{
-								EN = Group[GetNMSL( ofs1 + p )];
-								if ( EN )
-								{
-									//CENRAL LOOP !!!
-									dr = Norma( ox - EN->RealX, oy - EN->RealY );
-									RE1 = EN->Radius1;
-									RE2 = EN->Radius2;
-									FX1 = 0;
-									FY1 = 0;
-									if ( RE1 + R1 >= dr )
-									{
-										//COLLISION!!!!!!!
-										EN->Collision = true;
-										OB->Collision = true;
-										if ( dr )
-										{
-											//Force, that acts on OB
-											FX1 = div( ( ox - EN->RealX ) << 8, dr ).quot;
-											FY1 = div( ( oy - EN->RealY ) << 8, dr ).quot;
-										}
-										else
-										{
-											FX = 256;
-											FY = 256;
-										};
-									}
-									else
-									{
-										if ( RE2 + R2 >= dr )
-										{
-											//Inside interaction zone
-											//Force, that acts on OB
-											FX1 = div( ( ox - EN->RealX ) << 5, dr ).quot;
-											FY1 = div( ( oy - EN->RealY ) << 5, dr ).quot;
-										};
-									};
-									if ( FX1 || FY1 )
-									{
-										EN->ForceX -= FX1;
-										EN->ForceY -= FY1;
-										OB->ForceX += FX1;
-										OB->ForceY += FY1;
-									};
-								};
-							};
-						};
-						ofs0++;
-						ofs1 += MAXINCELL;
-					};
-					ofs0 += VAL_MAXCX - 3;
-					ofs1 += NNN3;
-				};
-			};
-
-		};
-	};
-};
 //-----------------------VISUALISATION------------------------
 //----VISUALISATION DATA----
 /*
@@ -4966,6 +4875,103 @@ void FireInfo::Erase()
 
 bool ShowProducedShip( OneObject* Port, int CX, int CY );
 
+//Units this far outside of the drawn window get their next frames
+//unpacked with the view, and farther along the scrolling: AHEAD_FRAMES
+//frames of it
+#define AHEAD_RING		96
+#define AHEAD_FRAMES	8
+
+static int ClampAhead( int d, int Max )
+{
+	return d > Max ? Max : ( d < -Max ? -Max : d );
+}
+
+//Window of the unpack-ahead around the drawn one, in the coordinates of
+//ShowNewMonsters()
+static void GetAheadWindow( int x0, int y0, int Lx1, int Ly1, int* ax0, int* ay0, int* ax1, int* ay1 )
+{
+	static int PrevX0 = 0;
+	static int PrevY0 = 0;
+	int dx = x0 - PrevX0;
+	int dy = y0 - PrevY0;
+	PrevX0 = x0;
+	PrevY0 = y0;
+	//a jump of the view is not a scroll
+	if ( abs( dx ) > Lx1 / 2 || abs( dy ) > Ly1 / 2 )
+	{
+		dx = 0;
+		dy = 0;
+	}
+	//at most half of the view ahead
+	dx = ClampAhead( dx * AHEAD_FRAMES, Lx1 / 2 );
+	dy = ClampAhead( dy * AHEAD_FRAMES, Ly1 / 2 );
+	*ax0 = -128 - AHEAD_RING;
+	*ay0 = -128 - AHEAD_RING;
+	*ax1 = Lx1 + 128 + AHEAD_RING;
+	*ay1 = Ly1 + 128 + AHEAD_RING;
+	if ( dx < 0 )
+	{
+		*ax0 += dx;
+	}
+	else
+	{
+		*ax1 += dx;
+	}
+	if ( dy < 0 )
+	{
+		*ay0 += dy;
+	}
+	else
+	{
+		*ay1 += dy;
+	}
+}
+
+//Queues the frame the unit will be drawn with on the next tick, the
+//animation steps by FrmDec and wraps, the rotation is picked as
+//ShowNewMonsters() picks it
+static void AddAheadUnit( OneObject* OB )
+{
+	NewAnimation* NAM = OB->NewAnm;
+	if ( !( NAM && NAM->Enabled && NAM->NFrames ) )
+	{
+		return;
+	}
+	int csp = OB->NewCurSprite + FrmDec;
+	if ( csp >= NAM->NFrames )
+	{
+		csp = 0;
+	}
+	NewFrame* NF = &NAM->Frames[csp];
+	int Spr = NF->SpriteID;
+	if ( NAM->Rotations > 1 )
+	{
+		int octs, oc2, sesize, oc1, ocM;
+		oc2 = NAM->Rotations - 1;
+		if ( NAM->Rotations & 1 )
+		{
+			octs = ( NAM->Rotations - 1 ) * 2;
+			sesize = div( 255, octs << 1 ).quot;
+			oc1 = octs;
+			ocM = oc2;
+		}
+		else
+		{
+			octs = NAM->Rotations * 2;
+			sesize = 0;
+			oc1 = octs - 1;
+			ocM = oc2 + 1;
+		}
+		int dir = ( ( ( OB->RealDir + 64 + sesize ) & 255 )*octs ) >> 8;
+		if ( dir >= ocM )
+		{
+			dir = oc1 - dir;
+		}
+		Spr = oc2 - dir + NAM->Rotations*NF->SpriteID;
+	}
+	AddAheadPoint( NF->FileID, Spr );
+}
+
 void ShowNewMonsters()
 {
 	time1 = GetTickCount();
@@ -4978,8 +4984,10 @@ void ShowNewMonsters()
 	int Ly1 = mul3( smaply ) * 8;
 	int mpdy = mapy * 16;
 	int xx, yy;
+	int ax0, ay0, ax1, ay1;
+	GetAheadWindow( x0, y0, Lx1, Ly1, &ax0, &ay0, &ax1, &ay1 );
 
-	for ( int i = 0; i < MAXOBJECT; i++ )
+	for ( int i = OI_Next( 0 ); i < MAXOBJECT; i = OI_Next( i + 1 ) )
 	{
 		OneObject* OB = Group[i];
 		if ( OB )
@@ -5281,6 +5289,10 @@ void ShowNewMonsters()
 						}
 					}
 				}
+				else if ( xx > ax0 && zz > ay0 && xx < ax1 && zz < ay1 )
+				{
+					AddAheadUnit( OB );
+				}
 			}
 			else
 			{
@@ -5621,6 +5633,7 @@ void OneObject::ProcessNewMotion()
 		};
 		x = RealX >> 9;
 		y = RealY >> 9;
+		StoreObjHot( this );
 		if ( StandTime < 8 )RZ = GetUnitHeight( RealX >> 4, RealY >> 4 );
 	};
 };
@@ -5644,44 +5657,29 @@ void RotateMon( OneObject* OB, char angle )
 	OB->UnBlockUnit();
 	if ( OB->AlwaysLock )OB->WeakBlockUnit();
 };
-void SetMonstersInCells()
+#ifdef _DEBUG
+//The hot field arrays must match the objects, a failure here is a
+//write site without StoreObjHot
+static void CheckObjHot()
 {
-	ZMem( MCount, VAL_MAXCX*VAL_MAXCX );
-	ZMem( TmpMC, VAL_MAXCX*VAL_MAXCX );
-	memset( BLDList, 0xFF, VAL_MAXCX*VAL_MAXCX * 2 );
-	CleanNMSL();
-	OneObject* OB;
-	int ofst, ofst1, k;
-	for ( int i = 0; i < MAXOBJECT; i++ )
+	for ( int i = OI_Next( 0 ); i < MAXOBJECT; i = OI_Next( i + 1 ) )
 	{
-		OB = Group[i];
-		if ( OB && !OB->Sdoxlo )
-		{
-			if ( OB->NewMonst )
-			{
-				ofst = ( OB->RealX >> 11 ) + ( ( OB->RealY >> 11 ) << VAL_SHFCX ) + VAL_MAXCX + 1;
-				ofst1 = ofst << SHFCELL;
-				if ( ofst < VAL_MAXCX*VAL_MAXCX )
-				{
-					k = MCount[ofst];
-					if ( k < MAXINCELL )
-					{
-						MCount[ofst]++;
-						TmpMC[ofst]++;
-						SetNMSL( ofst1 + k, OB->Index );
-					};
-				};
-			}
-			else
-			{
-				if ( OB->NewBuilding )
-				{
-					ofst = ( OB->RealX >> 11 ) + ( ( OB->RealY >> 11 ) << VAL_SHFCX ) + VAL_MAXCX + 1;
-					BLDList[ofst] = OB->Index;
-				};
-			};
-		};
-	};
+		OneObject* OB = Group[i];
+		assert( OH_X[i] == OB->RealX && OH_Y[i] == OB->RealY );
+		assert( ( ( OH_Flags[i] & OHF_DYING ) != 0 ) == ( OB->Sdoxlo != 0 ) );
+		assert( OH_Nat[i] == OB->NNUM && OH_NZalp[i] == OB->NZalp );
+	}
+}
+#endif
+
+//Moves the units and buildings that changed their cell since the last
+//tick, MCount, BLDList and the cell lists stay fixed until the next one
+void SetMonstersInCells()
+{
+#ifdef _DEBUG
+	CheckObjHot();
+#endif
+	CB_Update();
 };
 //checking position for monster MID in  (x,y)
 bool CheckPosition( int x, int y, int R, word MID )
@@ -5689,7 +5687,6 @@ bool CheckPosition( int x, int y, int R, word MID )
 	int cx = ( x >> 11 );
 	int cy = ( y >> 11 );
 	int ofs0 = (cx) +( ( cy ) << VAL_SHFCX );
-	int ofs1 = ofs0 << SHFCELL;
 	for ( int dy = 0; dy < 3; dy++ )
 	{
 		for ( int dx = 0; dx < 3; dx++ )
@@ -5697,9 +5694,10 @@ bool CheckPosition( int x, int y, int R, word MID )
 			int NMon = MCount[ofs0];
 			if ( ofs0 < MAXCIOFS )
 			{
+				word* CUnits = CB_CellUnits( ofs0 );
 				for ( int z = 0; z < NMon; z++ )
 				{
-					word MD = GetNMSL( z + ofs1 );
+					word MD = CUnits[z];
 					if ( MD != MID )
 					{
 						OneObject* OB = Group[MD];
@@ -5709,10 +5707,8 @@ bool CheckPosition( int x, int y, int R, word MID )
 				};
 			};
 			ofs0++;
-			ofs1 += MAXINCELL;
 		};
 		ofs0 += VAL_MAXCX - 3;
-		ofs1 += ( VAL_MAXCX - 3 ) << SHFCELL;
 	};
 	return true;
 };
@@ -6131,6 +6127,7 @@ int TryToMove( OneObject* OB, byte NewDir, bool Dirc )
 	//assert(abs(dx1)<16*256);
 	OB->RealX += dx1;//((NMN->OneStepDX[RDIR]*OB->Speed)>>4)<<SpeedSh;
 	OB->RealY += dy1;//((NMN->OneStepDY[RDIR]*OB->Speed)>>4)<<SpeedSh;
+	StoreObjHot( OB );
 	OB->InMotion = true;
 	OB->NewCurSprite = FrmDec - 1;;
 	OB->BackMotion = Dirc;
@@ -6257,6 +6254,7 @@ int NewTryToMove( OneObject* OB, byte NewDir, bool Dirc, int dx, int dy )
 	if ( !OB->MaxAIndex )OB->LeftLeg = !OB->LeftLeg;
 	OB->RealX += dx << SpeedSh;
 	OB->RealY += dy << SpeedSh;
+	StoreObjHot( OB );
 	OB->InMotion = true;
 	OB->NewCurSprite = FrmDec - 1;
 	OB->BackMotion = Dirc;
@@ -6277,13 +6275,16 @@ void CalculateMotionX0()
 {
 	if ( !( tmtmt & 31 ) )
 	{
-		for ( int i = 0; i < MAXOBJECT; i++ )
+		for ( int i = OI_Next( 0 ); i < MAXOBJECT; i = OI_Next( i + 1 ) )
 		{
-			OneObject* OB = Group[i];
-			if ( OB&&OB->NZalp < OB->newMons->MaxZalp )OB->NZalp++;
+			if ( OH_NZalp[i] < OH_MaxZalp[i] )
+			{
+				OH_NZalp[i]++;
+				Group[i]->NZalp = OH_NZalp[i];
+			}
 		};
 	};
-	for ( int i = 0; i < MAXOBJECT; i++ )
+	for ( int i = OI_Next( 0 ); i < MAXOBJECT; i = OI_Next( i + 1 ) )
 	{
 		OneObject* OB = Group[i];
 		if ( OB )
@@ -6392,6 +6393,7 @@ void CalculateMotionX0()
 								OB->DeletePath();
 								OB->ClearOrders();
 								DelObject( OB );
+								UnindexObject( OB->Index );
 								Group[OB->Index] = nullptr;
 								OB = nullptr;//died.	
 							};
@@ -6412,6 +6414,7 @@ void CalculateMotionX0()
 								OB->DeletePath();
 								OB->ClearOrders();
 								DelObject( OB );
+								UnindexObject( OB->Index );
 								Group[OB->Index] = nullptr;
 								OB = nullptr;//died.	
 							};
@@ -6428,6 +6431,7 @@ void CalculateMotionX0()
 								OB->DeletePath();
 								OB->ClearOrders();
 								DelObject( OB );
+								UnindexObject( OB->Index );
 								Group[OB->Index] = nullptr;
 								OB = nullptr;//died.	
 							};
@@ -6437,6 +6441,7 @@ void CalculateMotionX0()
 							OB->DeletePath();
 							OB->ClearOrders();
 							DelObject( OB );
+							UnindexObject( OB->Index );
 							Group[OB->Index] = nullptr;
 							OB = nullptr;//died.	
 						};
@@ -6446,7 +6451,7 @@ void CalculateMotionX0()
 			};
 		};
 	};
-	for ( int i = 0; i < MAXOBJECT; i++ )
+	for ( int i = OI_Next( 0, OIL_UNITS ); i < MAXOBJECT; i = OI_Next( i + 1, OIL_UNITS ) )
 	{
 		OneObject* OB = Group[i];
 		if ( OB&&OB->NewMonst && !OB->Sdoxlo )
@@ -6662,6 +6667,7 @@ void CalculateMotionX0()
 					{
 						OB->RealX = xx1;
 						OB->RealY = yy1;
+						StoreObjHot( OB );
 					};
 					if ( CheckPosition( OB->RealX, OB->RealY, OB->Radius2, OB->Index ) )
 						PushMonsters();
@@ -6680,6 +6686,7 @@ void CalculateMotionX0()
 	};
 };
 void UnitLight( OneObject* OB );
+void FlushFogLights();
 void CorrectLockPosition( OneObject* OB );
 void MotionHandler0( OneObject* OB )
 {
@@ -6941,6 +6948,7 @@ void MotionHandler0( OneObject* OB )
 	};
 	OB->x = ( OB->RealX - ( ( OB->Lx ) << 7 ) ) >> 8;
 	OB->y = ( OB->RealY - ( ( OB->Lx ) << 7 ) ) >> 8;
+	StoreObjHot( OB );
 	if ( OB->AlwaysLock )OB->WeakBlockUnit();
 	if ( OB->StandTime < 8 )OB->RZ = GetUnitHeight( ( OB->RealX - ( ( OB->Lx ) << 7 ) ) >> 4, ( OB->RealY - ( ( OB->Lx ) << 7 ) ) >> 4 );
 	//if(OB->LocalOrder){
@@ -6994,13 +7002,13 @@ bool RemoveFoolsInCell( int cell, int x, int y, int Lx, OneObject* MyObj )
 	int my1 = y + Lx - 1;
 	int NMon = MCount[cell];
 	if ( !NMon )return false;
-	int ofs1 = cell << SHFCELL;
+	word* CUnits = CB_CellUnits( cell );
 	word MID;
 	int cx = ( x << 1 ) + Lx;
 	int cy = ( y << 1 ) + Lx;
 	for ( int i = 0; i < NMon; i++ )
 	{
-		MID = GetNMSL( ofs1 + i );
+		MID = CUnits[i];
 		if ( MID != 0xFFFF )
 		{
 			OneObject* OB = Group[MID];
@@ -7024,6 +7032,8 @@ bool RemoveFoolsInCell( int cell, int x, int y, int Lx, OneObject* MyObj )
 								SWAP( &OB->y, &MyObj->y );
 								SWAP( &OB->RealX, &MyObj->RealX );
 								SWAP( &OB->RealY, &MyObj->RealY );
+								StoreObjHot( OB );
+								StoreObjHot( MyObj );
 								SWAP( &OB->RealDir, &MyObj->RealDir );
 								SWAP( &OB->GraphDir, &MyObj->GraphDir );
 								//SWAP(&OB->NewAnm,&MyObj->NewAnm);
@@ -7078,6 +7088,7 @@ bool RemoveFoolsInCell( int cell, int x, int y, int Lx, OneObject* MyObj )
 										OB->y = sy;
 										OB->RealX = rx1 << 5;
 										OB->RealY = ry1 << 5;
+										StoreObjHot( OB );
 										UnitsField.BSetBar( OB->x, OB->y, OB->Lx );
 										NeedRemove = false;
 									};
@@ -7343,6 +7354,7 @@ void MotionHandler1( OneObject* OB )
 			//};
 			OB->RealX += OB->RealVx << SpeedSh;
 			OB->RealY += OB->RealVy << SpeedSh;
+			StoreObjHot( OB );
 			if ( OB->AlwaysLock )OB->WeakBlockUnit();
 		};
 		OB->NewCurSprite += FrmDec;
@@ -7552,6 +7564,7 @@ void MotionHandler3( OneObject* OB )
 			//};
 			OB->RealX += OB->RealVx << SpeedSh;
 			OB->RealY += OB->RealVy << SpeedSh;
+			StoreObjHot( OB );
 			if ( OB->AlwaysLock )OB->WeakBlockUnit();
 		};
 		OB->NewCurSprite += FrmDec;
@@ -7782,6 +7795,7 @@ void MotionHandler2( OneObject* OB )
 	};
 	OB->x = ( OB->RealX - ( ( OB->Lx ) << 7 ) ) >> 8;
 	OB->y = ( OB->RealY - ( ( OB->Lx ) << 7 ) ) >> 8;
+	StoreObjHot( OB );
 	OB->RZ = 0;//GetHeight((OB->RealX-((OB->Lx)<<7))>>4,(OB->RealY-((OB->Lx)<<7))>>4);
 	//if(OB->LocalOrder){
 	//	OB->LocalOrder->DoLink(OB);
@@ -7820,6 +7834,8 @@ char* its1( int i )
 };
 void CreateTimedHint( char* s, int time );
 int DoLink_Time, SearchVictim_Time, CheckCapture_Time;
+void SearchVictims();
+void CheckCaptures();
 
 extern HGLOBAL PTR_MISS;
 int rppx = 0;
@@ -7829,40 +7845,7 @@ void LongProcesses()
 
 	int T0 = GetTickCount();
 
-	int d = tmtmt & 7;
-	int d1 = tmtmt & 15;
-	for ( int i = 0; i < MAXOBJECT; i++ )
-	{
-		OneObject* OB = Group[i];
-		if ( OB )
-		{
-			if ( OB->Nat->AI_Enabled )
-			{
-				int use = OB->newMons->Usage;
-				if ( use != TowerID )
-				{
-					if ( ( i & 7 ) == d )OB->SearchVictim();
-				}
-				else
-				{
-					OB->SearchVictim();
-				};
-			}
-			else
-			{
-				int use = OB->newMons->Usage;
-				if ( use == PeasantID )
-				{
-					if ( ( i & 15 ) == d1 )OB->SearchVictim();
-				}
-				else
-				{
-					OB->SearchVictim();
-				};
-			};
-
-		};
-	};
+	SearchVictims();
 
 	SearchVictim_Time = GetTickCount() - T0;
 	T0 = GetTickCount();
@@ -7929,18 +7912,8 @@ void LongProcesses()
 
 	DoLink_Time = GetTickCount() - T0;
 	T0 = GetTickCount();
-	for ( int i = 0; i < MAXOBJECT; i++ )
-	{
-		int mm = i & 31;
-		OneObject* OB = Group[i];
-		if ( OB && !OB->Sdoxlo )
-		{
-			if ( ( tmtmt & 31 ) == mm && ( OB->newMons->Capture || !OB->Ready ) )
-			{
-				CheckCapture( OB );
-			}
-		}
-	}
+
+	CheckCaptures();
 
 	CheckCapture_Time = GetTickCount() - T0;
 }
@@ -7957,7 +7930,7 @@ void CalculateMotion()
 
 	byte Mask = NATIONS[NatRefTBL[MyNation]].NMask;
 	bool sce = !( ( SCENINF.hLib == nullptr )/*||SCENINF.StandartVictory*/ );
-	for ( int i = 0; i < MAXOBJECT; i++ )
+	for ( int i = OI_Next( 0 ); i < MAXOBJECT; i = OI_Next( i + 1 ) )
 	{
 		OneObject* OB = Group[i];
 		if ( OB )
@@ -8083,6 +8056,7 @@ void CalculateMotion()
 					{
 						EliminateBuilding( OB );
 						DelObject( OB );
+						UnindexObject( OB->Index );
 						Group[OB->Index] = nullptr;
 					};
 				}
@@ -8109,6 +8083,7 @@ void CalculateMotion()
 									OB->DeletePath();
 									OB->ClearOrders();
 									DelObject( OB );
+									UnindexObject( OB->Index );
 									Group[OB->Index] = nullptr;
 									OB = nullptr;//died.	
 								};
@@ -8130,6 +8105,7 @@ void CalculateMotion()
 									OB->DeletePath();
 									OB->ClearOrders();
 									DelObject( OB );
+									UnindexObject( OB->Index );
 									Group[OB->Index] = nullptr;
 									OB = nullptr;//died.	
 								};
@@ -8146,6 +8122,7 @@ void CalculateMotion()
 									OB->DeletePath();
 									OB->ClearOrders();
 									DelObject( OB );
+									UnindexObject( OB->Index );
 									Group[OB->Index] = nullptr;
 									OB = nullptr;//died.	
 								};
@@ -8155,6 +8132,7 @@ void CalculateMotion()
 								OB->DeletePath();
 								OB->ClearOrders();
 								DelObject( OB );
+								UnindexObject( OB->Index );
 								Group[OB->Index] = nullptr;
 								OB = nullptr;//died.	
 							};
@@ -8164,7 +8142,7 @@ void CalculateMotion()
 			};
 		};
 	};
-
+	FlushFogLights();
 };
 void CalculateMotionV2()
 {
@@ -8207,6 +8185,7 @@ void CalculateMotionV2()
 								//erasing of the monster
 								if ( OB->PathX )free( OB->PathX );
 								if ( OB->PathY )free( OB->PathY );
+								UnindexObject( OB->Index );
 								Group[OB->Index] = nullptr;
 								free( OB );
 								OB = nullptr;
@@ -8396,6 +8375,7 @@ void CalculateMotionV2()
 					OB->UnBlockUnit();
 					OB->RealX += NMN->OneStepDX[OB->RealDir];
 					OB->RealY += NMN->OneStepDY[OB->RealDir];
+					StoreObjHot( OB );
 				};
 				OB->NewCurSprite += FrmDec;
 			};
@@ -8473,7 +8453,6 @@ bool CheckBuildingsForWalls( int x, int y )
 	int nyc = y - x;
 
 	int ofs0 = ( cx - nr ) + ( ( cy - nr ) << VAL_SHFCX ) + VAL_MAXCX + 1;
-	int ofs1 = ofs0 << SHFCELL;
 	for ( int dy = 0; dy < nr1; dy++ )
 	{
 		for ( int dx = 0; dx < nr1; dx++ )
@@ -8511,10 +8490,8 @@ bool CheckBuildingsForWalls( int x, int y )
 				};
 			};
 			ofs0++;
-			ofs1 += MAXINCELL;
 		};
 		ofs0 += VAL_MAXCX - nr1;
-		ofs1 += ( VAL_MAXCX - nr1 ) << SHFCELL;
 	};
 	return true;
 };
@@ -8525,7 +8502,6 @@ bool CheckMonstersInArea( int x, int y, int r )
 	int cx = ( x >> 11 );
 	int cy = ( y >> 11 );
 	int ofs0 = ( cx - nr ) + ( ( cy - nr ) << VAL_SHFCX );
-	int ofs1 = ofs0 << SHFCELL;
 	for ( int dy = 0; dy < nr1; dy++ )
 	{
 		for ( int dx = 0; dx < nr1; dx++ )
@@ -8533,18 +8509,17 @@ bool CheckMonstersInArea( int x, int y, int r )
 			if ( ofs0 >= 0 && ofs0 < MAXCIOFS )
 			{
 				int NMon = MCount[ofs0];
+				word* CUnits = CB_CellUnits( ofs0 );
 				for ( int z = 0; z < NMon; z++ )
 				{
-					word MD = GetNMSL( z + ofs1 );
+					word MD = CUnits[z];
 					OneObject* OB = Group[MD];
 					if ( OB&&OB->NewMonst&&Norma( OB->RealX - x, OB->RealY - y ) < r )return false;
 				};
 			};
 			ofs0++;
-			ofs1 += MAXINCELL;
 		};
 		ofs0 += VAL_MAXCX - nr1;
-		ofs1 += ( VAL_MAXCX - nr1 ) << SHFCELL;
 	};
 	return true;
 };
@@ -8967,15 +8942,7 @@ extern byte NTex2[32];
 void CreateGround( OneObject* G );
 int GetTotalUnits()
 {
-	int N = 0;
-	for ( int i = 0; i < MAXOBJECT; i++ )
-	{
-		if ( Group[i] )
-		{
-			N++;
-		}
-	}
-	return N;
+	return OI_Count();
 }
 
 extern bool Loadingmap;
@@ -9088,10 +9055,10 @@ int Nation::CreateNewMonsterAt( int rx, int ry, int n, bool Anyway )
 	}
 
 
-	int i;
-	for ( i = 0; i < MaxObj && int( Group[i] ); i++ );
+	//lowest free slot, the same on every peer
+	int i = OI_FirstFree( MaxObj );
 
-	if ( i >= MaxObj )
+	if ( i < 0 )
 	{
 		return -1;
 	}
@@ -9244,6 +9211,7 @@ int Nation::CreateNewMonsterAt( int rx, int ry, int n, bool Anyway )
 	G->Kills = 0;
 	G->NZalp = NM->MaxZalp;
 	AddObject( G );
+	IndexObject( G );
 	if ( !G->NewBuilding )
 	{
 		CITY->Account += NM->Ves;
@@ -9733,7 +9701,7 @@ word GoodSelectNewMonsters( byte NI, int xr, int yr, int xr1, int yr1, word *Col
 	x1p = xr1;
 	y1p = yr1;
 	bool UPresent = false;
-	for ( int ii = 0; ii < MAXOBJECT; ii++ )
+	for ( int ii = OI_Next( 0, OIL_ALL, NIX ); ii < MAXOBJECT; ii = OI_Next( ii + 1, OIL_ALL, NIX ) )
 	{
 		OneObject* OB = Group[ii];
 		if ( OB&&OB->newMons && ( !( ( OB->ImSelected&GM( NI ) ) || OB->Hidden || OB->Sdoxlo || OB->UnlimitedMotion ) ) && OB->NNUM == NIX && ( ( !FN ) || FN( OB, NN ) ) )
@@ -10470,11 +10438,11 @@ int GetEnemyDifference( int cell, byte Mask )
 	{
 		return 0;
 	}
-	int ofs1 = cell << SHFCELL;
+	word* CUnits = CB_CellUnits( cell );
 	word MID;
 	for ( int i = 0; i < NMon; i++ )
 	{
-		MID = GetNMSL( ofs1 + i );
+		MID = CUnits[i];
 		if ( MID != 0xFFFF )
 		{
 			OneObject* OB = Group[MID];
@@ -12592,10 +12560,12 @@ void WaterAttackLink( OneObject* OBJ )
 									if ( NMN->MaxZalp&&OBJ->NZalp )
 									{
 										OBJ->NZalp--;
+										StoreObjHot( OBJ );
 									}
 									else
 									{
 										OBJ->NZalp = NMN->MaxZalp;
+										StoreObjHot( OBJ );
 										OBJ->delay = NMN->AttackPause[AttMethod];
 										OBJ->MaxDelay = div( int( OBJ->delay )*OBJ->PersonalDelay, 100 ).quot;
 										OBJ->delay = OBJ->MaxDelay;
@@ -12615,10 +12585,12 @@ void WaterAttackLink( OneObject* OBJ )
 									if ( NMN->MaxZalp&&OBJ->NZalp )
 									{
 										OBJ->NZalp--;
+										StoreObjHot( OBJ );
 									}
 									else
 									{
 										OBJ->NZalp = NMN->MaxZalp;
+										StoreObjHot( OBJ );
 										OBJ->delay = NMN->AttackPause[AttMethod];
 										OBJ->MaxDelay = div( int( OBJ->delay )*OBJ->PersonalDelay, 100 ).quot;
 										OBJ->delay = OBJ->MaxDelay;
@@ -12670,10 +12642,12 @@ void WaterAttackLink( OneObject* OBJ )
 								if ( NMN->MaxZalp&&OBJ->NZalp )
 								{
 									OBJ->NZalp--;
+									StoreObjHot( OBJ );
 								}
 								else
 								{
 									OBJ->NZalp = NMN->MaxZalp;
+									StoreObjHot( OBJ );
 									OBJ->delay = NMN->AttackPause[AttMethod];
 									OBJ->MaxDelay = div( int( OBJ->delay )*OBJ->PersonalDelay, 100 ).quot;
 									OBJ->delay = OBJ->MaxDelay;
@@ -12756,7 +12730,7 @@ word GetNewEnemy( int xr, int yr, byte NI )
 	NI = NatRefTBL[NI];
 	byte nms = 1 << NI;
 	OneObject* OBX = nullptr;
-	for ( int ii = 0; ii < MAXOBJECT; ii++ )
+	for ( int ii = OI_Next( 0 ); ii < MAXOBJECT; ii = OI_Next( ii + 1 ) )
 	{
 		OneObject* OB = Group[ii];
 		if ( OB && ( !( ( nms&OB->NMask ) || OB->Sdoxlo ) ) )
@@ -12783,11 +12757,11 @@ word AdvancedGetNewEnemyInCell( int cx, int cy, int xr, int yr, byte EMask )
 	int cell = VAL_MAXCX + 1 + cx + ( cy << VAL_SHFCX );
 	cell += VAL_MAXCX + 1;
 	int NMon = MCount[cell];
-	int ofs1 = cell << SHFCELL;
+	word* CUnits = CB_CellUnits( cell );
 	word MID;
 	for ( int i = 0; i < NMon; i++ )
 	{
-		MID = GetNMSL( ofs1 + i );
+		MID = CUnits[i];
 		if ( MID != 0xFFFF )
 		{
 			OneObject* OB = Group[MID];
@@ -12871,7 +12845,7 @@ word AdvancedGetNewEnemy( int rex, int rey, int xr, int yr, byte NI )
 word GetNewFriend( int xr, int yr, byte NI )
 {
 	byte nms = 1 << NI;
-	for ( int ii = 0; ii < MAXOBJECT; ii++ )
+	for ( int ii = OI_Next( 0, OIL_ALL, NI ); ii < MAXOBJECT; ii = OI_Next( ii + 1, OIL_ALL, NI ) )
 	{
 		OneObject* OB = Group[ii];
 		if ( OB&&OB->NNUM == NI && !OB->Sdoxlo )
@@ -12891,11 +12865,11 @@ word AdvancedGetNewFriendInCell( int cx, int cy, int xr, int yr, byte NI )
 	int cell = VAL_MAXCX + 1 + cx + ( cy << VAL_SHFCX );
 	cell += VAL_MAXCX + 1;
 	int NMon = MCount[cell];
-	int ofs1 = cell << SHFCELL;
+	word* CUnits = CB_CellUnits( cell );
 	word MID;
 	for ( int i = 0; i < NMon; i++ )
 	{
-		MID = GetNMSL( ofs1 + i );
+		MID = CUnits[i];
 		if ( MID != 0xFFFF )
 		{
 			OneObject* OB = Group[MID];
@@ -13357,7 +13331,7 @@ void InvitePeasant( OneObject* Mine )
 	if ( NP > 64 )NP = 64;
 	byte NI = Mine->NNUM;
 	int NN = 0;
-	for ( int i = 0; i < MAXOBJECT; i++ )
+	for ( int i = OI_Next( 0, OIL_ALL, NI ); i < MAXOBJECT; i = OI_Next( i + 1, OIL_ALL, NI ) )
 	{
 		OneObject* OB = Group[i];
 		if ( OB && ( !OB->Sdoxlo ) && OB->NNUM == NI&&OB->Ref.General->newMons->Peasant &&
@@ -13404,7 +13378,7 @@ void InviteAI_Peasants( OneObject* Mine )
 	if ( NP > 64 )NP = 64;
 	byte NI = Mine->NNUM;
 	int NN = 0;
-	for ( int i = 0; i < MAXOBJECT; i++ )
+	for ( int i = OI_Next( 0, OIL_ALL, NI ); i < MAXOBJECT; i = OI_Next( i + 1, OIL_ALL, NI ) )
 	{
 		OneObject* OB = Group[i];
 		if ( OB && ( !OB->Sdoxlo ) && OB->NNUM == NI&&OB->Ref.General->newMons->Peasant &&
@@ -13576,7 +13550,7 @@ word DetermineBuilding( int x, int y, byte NMask )
 	int yy = y >> 4;
 	int xr = x << 4;
 	int yr = y << 4;
-	for ( int i = 0; i < MAXOBJECT; i++ )
+	for ( int i = OI_Next( 0, OIL_BUILDINGS ); i < MAXOBJECT; i = OI_Next( i + 1, OIL_BUILDINGS ) )
 	{
 		OneObject* OB = Group[i];
 		if ( OB&&OB->NewBuilding && ( OB->NMask&NMask ) )
@@ -13744,11 +13718,11 @@ void DamageInCell( int cell, int x, int y, int r, word Damage, OneObject* Sender
 	if ( cell < 0 || cell >= VAL_MAXCX*VAL_MAXCX )return;
 	int NMon = MCount[cell];
 	if ( !NMon )return;
-	int ofs1 = cell << SHFCELL;
+	word* CUnits = CB_CellUnits( cell );
 	word MID;
 	for ( int i = 0; i < NMon; i++ )
 	{
-		MID = GetNMSL( ofs1 + i );
+		MID = CUnits[i];
 		if ( MID != 0xFFFF )
 		{
 			OneObject* OB = Group[MID];
@@ -13929,6 +13903,33 @@ void OneObject::DeleteLastOrder()
 
 int TestCapture( OneObject* OBJ );
 
+//Priest 0: enemies of nmask in mmask, 1: wounded friends, 2: enemies or
+//free units to capture, 3: only units to capture
+static bool IsVictim( OneObject* OB, byte nmask, byte mmask, byte Priest )
+{
+	if ( !OB || OB->Sdoxlo )
+	{
+		return false;
+	}
+	if ( Priest == 3 )
+	{
+		return OB->newMons->Capture && TestCapture( OB ) == 0;
+	}
+	if ( Priest == 2 && ( !( OB->NMask&nmask ) ) && OB->newMons->Capture && TestCapture( OB ) == 0 )
+	{
+		return true;
+	}
+	if ( ( !( OB->NMask & nmask ) ) && OB->newMons->MathMask & mmask )
+	{
+		if ( Priest == 1 )
+		{
+			return OB->Life < OB->Ref.General->MoreCharacter->Life;
+		}
+		return true;
+	}
+	return false;
+}
+
 OneObject* SearchEnemyInCell( int cell, byte nmask, byte mmask, byte Priest )
 {
 	cell += VAL_MAXCX + 1;
@@ -13939,54 +13940,118 @@ OneObject* SearchEnemyInCell( int cell, byte nmask, byte mmask, byte Priest )
 		return nullptr;
 	}
 
-	int ofs1 = cell << SHFCELL;
+	word* CUnits = CB_CellUnits( cell );
 	word MID;
 
 	for ( int i = 0; i < NMon; i++ )
 	{
-		MID = GetNMSL( ofs1 + i );
-		if ( MID != 0xFFFF )
+		MID = CUnits[i];
+		if ( MID != 0xFFFF && IsVictim( Group[MID], nmask, mmask, Priest ) )
 		{
-			OneObject* OB = Group[MID];
-			if ( OB && !OB->Sdoxlo )
-			{
-				if ( Priest == 3 )
-				{
-					if ( OB->newMons->Capture && TestCapture( OB ) == 0 )
-					{
-						return OB;
-					}
-				}
-				else
-				{
-					if ( Priest == 2 && ( !( OB->NMask&nmask ) ) && OB->newMons->Capture && TestCapture( OB ) == 0 )
-					{
-						return OB;
-					}
-					else
-					{
-						if ( ( !( OB->NMask & nmask ) ) && OB->newMons->MathMask & mmask )
-						{
-							if ( Priest == 1 )
-							{
-								if ( OB->Life < OB->Ref.General->MoreCharacter->Life )
-								{
-									return OB;
-								}
-							}
-							else
-							{
-								return OB;
-							}
-						}
-					}
-				}
-			}
+			return Group[MID];
 		}
 	}
 	return nullptr;
 }
 
+//Filter of the target queries, see NewCode/TargetQuery.h
+struct VictimFilter
+{
+	byte NMask;
+	byte MMask;
+	byte Priest;
+	//targets closer than MinR to (x,y) are skipped
+	int x, y, MinR;
+};
+
+//The part of the filter that does not depend on (x,y), see TQ_Rings
+static bool AcceptAnyVictim( word MID, void* Param )
+{
+	VictimFilter* F = (VictimFilter*) Param;
+	return IsVictim( Group[MID], F->NMask, F->MMask, F->Priest );
+}
+
+static bool AcceptFarVictim( word MID, void* Param )
+{
+	VictimFilter* F = (VictimFilter*) Param;
+	OneObject* OB = Group[MID];
+	return Norma( OB->RealX - F->x, OB->RealY - F->y ) > F->MinR;
+}
+
+static bool AcceptVictim( word MID, void* Param )
+{
+	VictimFilter* F = (VictimFilter*) Param;
+	return AcceptAnyVictim( MID, Param ) && ( !F->MinR || AcceptFarVictim( MID, Param ) );
+}
+
+//Search for victims within R cells, farther than MinR and closer than
+//MaxR. NMask is the mask of the nations to search in, see IsVictim
+struct VictimQuery
+{
+	int R;
+	byte NMask;
+	byte MMask;
+	byte Priest;
+	int MinR;
+	int MaxR;
+};
+
+//Nearest victim of OB, searched from its own position. The query ranks
+//by the true distance, the nearest few are ranked again by Norma.
+//Rings, if given, holds the victims around the cell of OB for Q.
+static OneObject* SearchNearestVictim( OneObject* OB, VictimQuery& Q, TQ_Rings* Rings = nullptr )
+{
+	VictimFilter VF = { byte( ~Q.NMask ), Q.MMask, Q.Priest, OB->RealX, OB->RealY, Q.MinR };
+	word Res[TQ_MAXK];
+	int N;
+	if ( Rings )
+	{
+		N = TQ_NearestIn( Rings, OB->RealX, OB->RealY, Q.MinR ? AcceptFarVictim : nullptr, &VF, Res, TQ_MAXK );
+	}
+	else
+	{
+		N = TQ_Nearest( OB->RealX, OB->RealY, Q.R, Q.NMask, AcceptVictim, &VF, Res, TQ_MAXK );
+	}
+	OneObject* Dest = nullptr;
+	int mindist = Q.MaxR;
+	for ( int i = 0; i < N; i++ )
+	{
+		OneObject* EN = Group[Res[i]];
+		int dist = Norma( EN->RealX - OB->RealX, EN->RealY - OB->RealY );
+		if ( dist < mindist )
+		{
+			mindist = dist;
+			Dest = EN;
+		}
+	}
+	return Dest;
+}
+
+//The search for victims in sight of OneObject::SearchVictim
+static void SetVictimQuery( OneObject* OB, VictimQuery& Q )
+{
+	NewMonster* NM = OB->newMons;
+	Q.MaxR = NM->VisRange;
+	//all cells in sight, so towers keep their long range search
+	Q.R = ( Q.MaxR >> 11 ) + 1;
+	Q.NMask = ~OB->NMask;
+	Q.Priest = NM->Priest;
+	if ( Q.Priest )
+	{
+		Q.NMask = OB->NMask;
+		Q.Priest = 1;
+	}
+	else
+	{
+		if ( !( NM->Capture || OB->LockType || OB->NewBuilding ) )
+		{
+			Q.Priest = 2;
+		}
+	}
+	Q.MMask = NM->KillMask;
+	Q.MinR = int( OB->Ref.General->MoreCharacter->MinR_Attack ) << 4;
+}
+
 OneObject* SearchEnemyGroupInCell( int cell, byte nmask, byte mmask )
 {
 	cell += VAL_MAXCX + 1;// += 129
@@ -13997,12 +14062,12 @@ OneObject* SearchEnemyGroupInCell( int cell, byte nmask, byte mmask )
 	{
 		return nullptr;
 	}
-	int ofs1 = cell << SHFCELL;//* 64
+	word* CUnits = CB_CellUnits( cell );
 	word MID;
 
 	for ( int i = 0; i < NMon; i++ )//NMon can be 0 to 255
 	{
-		MID = GetNMSL( ofs1 + i );
+		MID = CUnits[i];
 		if ( MID != 0xFFFF )
 		{
 			OneObject* OB = Group[MID];
@@ -14088,6 +14153,163 @@ void SearchVictimForAI_Archer( OneObject* OB )
 
 int GetUnitActivity( OneObject* OB );
 
+//Victims found on the workers, valid while PreVictimGen[i]==VictimGen
+static word PreVictim[ULIMIT];
+static DWORD PreVictimGen[ULIMIT];
+static DWORD VictimGen = 1;
+//objects to search for on the workers
+static word VictimJobs[ULIMIT];
+static int NVictimJobs = 0;
+#define VICTIMS_PER_JOB 64
+
+//Jobs are sorted by the cell and the query, so the objects of a cell
+//that search the same share the victims around it
+struct VictimKey
+{
+	int Cell;
+	int R;
+	byte NMask;
+	byte MMask;
+	byte Priest;
+	word MID;
+
+	bool SameQuery( const VictimKey& K ) const
+	{
+		return Cell == K.Cell && R == K.R && NMask == K.NMask && MMask == K.MMask && Priest == K.Priest;
+	}
+	bool operator<( const VictimKey& K ) const
+	{
+		if ( Cell != K.Cell ) return Cell < K.Cell;
+		if ( R != K.R ) return R < K.R;
+		if ( NMask != K.NMask ) return NMask < K.NMask;
+		if ( MMask != K.MMask ) return MMask < K.MMask;
+		if ( Priest != K.Priest ) return Priest < K.Priest;
+		return MID < K.MID;
+	}
+};
+static VictimKey VictimKeys[ULIMIT];
+
+//-1 off the map, the search goes without TQ_Rings then
+static void SetVictimKey( OneObject* OB, VictimQuery& Q, VictimKey& K )
+{
+	int cx = OB->RealX >> 11;
+	int cy = OB->RealY >> 11;
+	bool In = cx >= 0 && cy >= 0 && cx < VAL_MAXCX && cy < VAL_MAXCX;
+	K.Cell = In ? ( cy << VAL_SHFCX ) + cx : -1;
+	K.R = Q.R;
+	K.NMask = Q.NMask;
+	K.MMask = Q.MMask;
+	K.Priest = Q.Priest;
+	K.MID = OB->Index;
+}
+
+//true if OB->SearchVictim() gets to the search for victims in sight
+static bool SearchesInSight( OneObject* OB )
+{
+	NewMonster* NM = OB->newMons;
+	if ( OB->NoSearchVictim || OB->Zombi || OB->PeaceMode )
+	{
+		return false;
+	}
+	if ( GetUnitActivity( OB ) && ( NM->Peasant || NM->Usage == TowerID || NM->Artilery || OB->Media ) )
+	{
+		return false;
+	}
+	if ( NM->Archer && OB->Nat->AI_Enabled )
+	{
+		return false;
+	}
+	return !( OB->LockType && OB->Nat->AI_Enabled && OB->EnemyID == 0xFFFF );
+}
+
+static void FindVictims( int Job, void* Param )
+{
+	int i1 = ( Job + 1 ) * VICTIMS_PER_JOB;
+	if ( i1 > NVictimJobs )
+	{
+		i1 = NVictimJobs;
+	}
+	TQ_Rings Rings;
+	VictimFilter Shared;
+	VictimKey Last;
+	Last.Cell = -1;
+	for ( int i = Job * VICTIMS_PER_JOB; i < i1; i++ )
+	{
+		word MID = VictimJobs[i];
+		OneObject* OB = Group[MID];
+		VictimQuery Q;
+		SetVictimQuery( OB, Q );
+		VictimKey K;
+		SetVictimKey( OB, Q, K );
+		OneObject* Dest;
+		if ( K.Cell < 0 )
+		{
+			Dest = SearchNearestVictim( OB, Q );
+		}
+		else
+		{
+			if ( !K.SameQuery( Last ) )
+			{
+				Shared = { byte( ~Q.NMask ), Q.MMask, Q.Priest, 0, 0, 0 };
+				TQ_RingsInit( &Rings, K.Cell, Q.R, Q.NMask, AcceptAnyVictim, &Shared );
+				Last = K;
+			}
+			Dest = SearchNearestVictim( OB, Q, &Rings );
+		}
+		PreVictim[MID] = Dest ? Dest->Index : 0xFFFF;
+		PreVictimGen[MID] = VictimGen;
+	}
+}
+
+static bool VictimSearchDue( OneObject* OB, int i, int d, int d1 )
+{
+	int use = OB->newMons->Usage;
+	if ( OB->Nat->AI_Enabled )
+	{
+		return use == TowerID || ( i & 7 ) == d;
+	}
+	return use != PeasantID || ( i & 15 ) == d1;
+}
+
+//SearchVictim of the objects due in this tick. The searches for victims
+//in sight only read the map, they run first on all cores and write to
+//PreVictim. SearchVictim then goes through the objects in index order on
+//this thread, with every rando() call and every order in the same place.
+void SearchVictims()
+{
+	int d = tmtmt & 7;
+	int d1 = tmtmt & 15;
+	VictimGen++;
+	NVictimJobs = 0;
+	for ( int i = OI_Next( 0 ); i < MAXOBJECT; i = OI_Next( i + 1 ) )
+	{
+		OneObject* OB = Group[i];
+		if ( OB && VictimSearchDue( OB, i, d, d1 ) && SearchesInSight( OB ) )
+		{
+			VictimQuery Q;
+			SetVictimQuery( OB, Q );
+			SetVictimKey( OB, Q, VictimKeys[NVictimJobs++] );
+		}
+	}
+	std::sort( VictimKeys, VictimKeys + NVictimJobs );
+	for ( int i = 0; i < NVictimJobs; i++ )
+	{
+		VictimJobs[i] = VictimKeys[i].MID;
+	}
+	JOBS.ParallelFor( ( NVictimJobs + VICTIMS_PER_JOB - 1 ) / VICTIMS_PER_JOB, &FindVictims, nullptr );
+
+	for ( int i = OI_Next( 0 ); i < MAXOBJECT; i = OI_Next( i + 1 ) )
+	{
+		OneObject* OB = Group[i];
+		if ( OB && VictimSearchDue( OB, i, d, d1 ) )
+		{
+			OB->SearchVictim();
+		}
+	}
+	//later calls in this tick search again
+	VictimGen++;
+}
+
 void OneObject::SearchVictim()
 {
 	if ( NoSearchVictim )
@@ -14358,141 +14580,21 @@ void OneObject::SearchVictim()
 		return;
 	}
 
-	int cell = ( ( RealY >> 11 ) << VAL_SHFCX ) + ( RealX >> 11 );
-	int rr = NM->VisRange;
-	int rx1 = ( rr >> 11 ) + 1;
-	byte nmask = ~NMask;
-	byte Priest = NM->Priest;
-
-	if ( Priest )
-	{
-		nmask = NMask;
-		Priest = 1;
-	}
-	else
+	//nearest target in sight
+	OneObject* DestObj;
+	if ( PreVictimGen[Index] == VictimGen )
 	{
-		if ( !( NM->Capture || LockType || NewBuilding ) )
-		{
-			Priest = 2;
-		}
-	}
-
-	byte mmask = NM->KillMask;
-	OneObject* DestObj = nullptr;
-	int mindist = 10000000;
-	int dist;
-
-	if ( rx1 <= 5 )
-	{
-		//short range search
-		int rx2 = rx1 + rx1 + 1;
-		int stcell = cell - rx1 - ( rx1 << VAL_SHFCX );
-		byte* bpt = NPresence + stcell;
-		for ( int nx = 0; nx < rx2; nx++ )
-		{
-			for ( int ny = 0; ny < rx2; ny++ )
-			{
-				if ( stcell >= 0 && stcell < VAL_MAXCX*VAL_MAXCX )
-				{
-					if ( bpt[0] & nmask )
-					{
-						OneObject*OB = SearchEnemyInCell( stcell, ~nmask, mmask, Priest );
-						if ( OB )
-						{
-							dist = Norma( OB->RealX - RealX, OB->RealY - RealY );
-							if ( dist<mindist&&dist>minR )
-							{
-								mindist = dist;
-								DestObj = OB;
-							}
-						}
-					}
-				}
-				stcell++;
-				bpt++;
-			}
-			stcell += VAL_MAXCX - rx2;
-			bpt += VAL_MAXCX - rx2;
-		}
+		//already found on the workers by SearchVictims
+		DestObj = PreVictim[Index] != 0xFFFF ? Group[PreVictim[Index]] : nullptr;
 	}
 	else
 	{
-		//near nose search
-		if ( Ref.General->MoreCharacter->MinR_Attack < 140 && !( StandTime > 16 && rando() > 6000 ) )
-		{
-			int rxx = 1;
-			int rx2 = rxx + rxx + 1;
-			int stcell = cell - rxx - ( rxx << VAL_SHFCX );
-			byte* bpt = NPresence + stcell;
-			for ( int nx = 0; nx < rx2; nx++ )
-			{
-				for ( int ny = 0; ny < rx2; ny++ )
-				{
-					if ( stcell >= 0 && stcell < VAL_MAXCX*VAL_MAXCX )
-					{
-						if ( bpt[0] & nmask )
-						{
-							OneObject*OB = SearchEnemyInCell( stcell, ~nmask, mmask, Priest );
-							if ( OB )
-							{
-								dist = Norma( OB->RealX - RealX, OB->RealY - RealY );
-								if ( dist<mindist&&dist>minR )
-								{
-									mindist = dist;
-									DestObj = OB;
-								}
-							}
-						}
-					}
-				}
-				stcell++;
-				bpt++;
-			}
-			stcell += VAL_MAXCX - rx2;
-			bpt += VAL_MAXCX - rx2;
-		}
-		if ( !DestObj )
-		{
-
-			//long range search
-			int rx2 = rx1 + rx1 + 1;
-			int stcell;
-			int NSR = 6;
-			if ( NM->Usage == TowerID )
-			{
-				NSR = 20;
-			}
-			for ( int i = 0; i < 6; i++ )
-			{
-				int dx = ( ( rando()*rx2 ) >> 15 ) - rx1;
-				int dy = ( ( rando()*rx2 ) >> 15 ) - rx1;
-				stcell = cell + dx + ( dy << VAL_SHFCX );
-				if ( stcell >= 0 && stcell < VAL_MAXCX*VAL_MAXCX )
-				{
-					rando();
-					if ( NPresence[stcell] & nmask )
-					{
-						rando();
-						OneObject*OB = SearchEnemyInCell( stcell, ~nmask, mmask, Priest );
-						if ( OB )
-						{
-							rando();
-							dist = Norma( OB->RealX - RealX, OB->RealY - RealY );
-							if ( dist<mindist&&dist>minR )
-							{
-								mindist = dist;
-								DestObj = OB;
-							}
-						}
-					}
-				}
-			}
-		}
+		VictimQuery Q;
+		SetVictimQuery( this, Q );
+		DestObj = SearchNearestVictim( this, Q );
 	}
-	//if(!DestObj&&!(newMons->Capture||NewBuilding||LockType)){}
 
-	//if(DestObj)
-	if ( DestObj&&mindist < rr )
+	if ( DestObj )
 	{
 		int ac2 = GetUnitActivity( DestObj );
 		if ( ac2 != 1 )
@@ -14511,49 +14613,15 @@ void OneObject::SearchVictim()
 int GetTopDistance( int xa, int ya, int xb, int yb );
 word SearchVictim( OneObject* OBJ, int R0, int R1 )
 {
-	int cell = ( ( OBJ->RealY >> 11 ) << VAL_SHFCX ) + ( OBJ->RealX >> 11 );
-	NewMonster* NM = OBJ->newMons;
-	int rr = R1 << 4;
-	int rmin = R0 << 4;
-	int rx1 = ( R1 >> 7 ) + 1;
-	byte nmask = ~OBJ->NMask;
-	byte mmask = NM->KillMask;
-	OneObject* DestObj = nullptr;
-	int mindist = 10000000;
-	int dist;
-	//short range search
-	int rx2 = rx1 + rx1 + 1;
-	int stcell = cell - rx1 - ( rx1 << VAL_SHFCX );
-	byte* bpt = NPresence + stcell;
-	int RealX = OBJ->RealX;
-	int RealY = OBJ->RealY;
-	for ( int nx = 0; nx < rx2; nx++ )
-	{
-		for ( int ny = 0; ny < rx2; ny++ )
-		{
-			if ( stcell >= 0 && stcell < VAL_MAXCX*VAL_MAXCX )
-			{
-				if ( bpt[0] & nmask )
-				{
-					OneObject*OB = SearchEnemyInCell( stcell, ~nmask, mmask, 0 );
-					if ( OB )
-					{
-						dist = Norma( OB->RealX - RealX, OB->RealY - RealY );
-						if ( dist > rmin&&dist < mindist )
-						{
-							mindist = dist;
-							DestObj = OB;
-						};
-					};
-				};
-			};
-			stcell++;
-			bpt++;
-		};
-		stcell += VAL_MAXCX - rx2;
-		bpt += VAL_MAXCX - rx2;
-	};
-	if ( DestObj&&mindist < rr )
+	VictimQuery Q;
+	Q.MaxR = R1 << 4;
+	Q.MinR = R0 << 4;
+	Q.R = ( R1 >> 7 ) + 1;
+	Q.NMask = ~OBJ->NMask;
+	Q.MMask = OBJ->newMons->KillMask;
+	Q.Priest = 0;
+	OneObject* DestObj = SearchNearestVictim( OBJ, Q );
+	if ( DestObj )
 	{
 		if ( GetTopDistance( OBJ->RealX >> 10, OBJ->RealY >> 10, DestObj->RealX >> 10, DestObj->RealY >> 10 ) < 20 )
 			return DestObj->Index;
@@ -14661,11 +14729,11 @@ OneObject* SearchCapturers( int cell, byte mmask )
 	{
 		return nullptr;
 	}
-	int ofs1 = cell << SHFCELL;
+	word* CUnits = CB_CellUnits( cell );
 	word MID;
 	for ( int i = 0; i < NMon; i++ )
 	{
-		MID = GetNMSL( ofs1 + i );
+		MID = CUnits[i];
 		if ( MID != 0xFFFF )
 		{
 			OneObject* OB = Group[MID];
@@ -14686,11 +14754,11 @@ OneObject* SearchProtectors( int cell, byte mmask )
 	{
 		return nullptr;
 	}
-	int ofs1 = cell << SHFCELL;
+	word* CUnits = CB_CellUnits( cell );
 	word MID;
 	for ( int i = 0; i < NMon; i++ )
 	{
-		MID = GetNMSL( ofs1 + i );
+		MID = CUnits[i];
 		if ( MID != 0xFFFF )
 		{
 			OneObject* OB = Group[MID];
@@ -14731,12 +14799,12 @@ int GetProtectors( int cell, byte mmask )
 	{
 		return 0;
 	}
-	int ofs1 = cell << SHFCELL;
+	word* CUnits = CB_CellUnits( cell );
 	word MID;
 	int N = 0;
 	for ( int i = 0; i < NMon; i++ )
 	{
-		MID = GetNMSL( ofs1 + i );
+		MID = CUnits[i];
 		if ( MID != 0xFFFF )
 		{
 			OneObject* OB = Group[MID];
@@ -14851,50 +14919,60 @@ extern int AlarmDelay;
 
 void StopUpgradeInBuilding( OneObject *OB );
 
-void CheckCapture( OneObject* OBJ )
+//Capturers and protectors around an object due for CheckCapture
+struct CaptureScan
+{
+	//last capturer found, nullptr - none
+	OneObject* CapUnit;
+	byte CapNation;
+	int NCapt;
+	//cells with protectors, only scanned if there is a capturer
+	int NPro;
+};
+
+//Scans found on the workers, valid while PreCaptureGen[i]==CaptureGen
+static CaptureScan PreCapture[ULIMIT];
+static DWORD PreCaptureGen[ULIMIT];
+static DWORD CaptureGen = 1;
+//objects to scan on the workers
+static word CaptureJobs[ULIMIT];
+static int NCaptureJobs = 0;
+#define CAPTURES_PER_JOB 64
+
+static bool CaptureAllowed( OneObject* OBJ )
 {
 	switch ( CaptState )
 	{//Capture Options
 	case 1://No Peasants
-		if ( OBJ->newMons->Peasant )
-		{
-			return;
-		}
-		break;
+		return !OBJ->newMons->Peasant;
 
 	case 2://No Peasants and City Centers
-		if ( OBJ->newMons->Peasant || OBJ->newMons->Usage == CenterID || OBJ->newMons->Usage == MineID )
-		{
-			return;
-		}
-		break;
+		return !( OBJ->newMons->Peasant || OBJ->newMons->Usage == CenterID || OBJ->newMons->Usage == MineID );
 
 	case 3://Only Artillery
-		if ( !( OBJ->newMons->Artilery || OBJ->Wall ) )
-		{
-			return;
-		}
-		break;
+		return OBJ->newMons->Artilery || OBJ->Wall;
 	}
+	return true;
+}
 
+//Only reads the map, may run on the workers
+static void ScanCapture( OneObject* OBJ, CaptureScan& S )
+{
 	int cell = ( ( OBJ->RealY / 2048 ) << VAL_SHFCX ) + ( OBJ->RealX / 2048 );
 
 	int CELL0 = cell;
-	NewMonster* NM = OBJ->newMons;
 	byte nmask = ~OBJ->NMask;
 	byte NMASK = OBJ->NMask;
-	OneObject* DestObj = nullptr;
-	int mindist = 10000000;
 	int dist;
 	int rx1 = 2;
 
-	bool Capture = false;
 	int rx2 = rx1 + rx1 + 1;
 	int stcell = cell - rx1 - ( rx1 << VAL_SHFCX );
-	byte CapNation = 0;
 	byte* bpt = NPresence + stcell;
-	int NCapt = 0;
-	OneObject* CAPUNIT = nullptr;
+	S.CapUnit = nullptr;
+	S.CapNation = 0;
+	S.NCapt = 0;
+	S.NPro = 0;
 
 	for ( int nx = 0; nx < rx2; nx++ )
 	{
@@ -14910,10 +14988,9 @@ void CheckCapture( OneObject* OBJ )
 						dist = Norma( OB->RealX - OBJ->RealX, OB->RealY - OBJ->RealY );
 						if ( dist < 250 * 16 )
 						{
-							Capture = true;
-							CapNation = OB->NNUM;
-							NCapt++;
-							CAPUNIT = OB;
+							S.CapNation = OB->NNUM;
+							S.NCapt++;
+							S.CapUnit = OB;
 						}
 					}
 				}
@@ -14925,10 +15002,72 @@ void CheckCapture( OneObject* OBJ )
 		bpt += VAL_MAXCX - rx2;
 	}
 
+	if ( !S.CapUnit )
+	{
+		return;
+	}
+
+	rx1 = 3;
+	rx2 = rx1 + rx1 + 1;
+
+	stcell = CELL0 - rx1 - ( rx1 << VAL_SHFCX );
+
+	//Checking for guards
+	bpt = NPresence + stcell;
+	for ( int nx = 0; nx < rx2; nx++ )
+	{
+		for ( int ny = 0; ny < rx2; ny++ )
+		{
+			if ( stcell >= 0 && stcell < VAL_MAXCX*VAL_MAXCX )
+			{
+				if ( bpt[0] & NMASK )
+				{
+					OneObject*OB = SearchProtectors( stcell, NMASK );
+					if ( OB && !OB->newMons->Capture )
+					{//Allied non-capturable units are near
+						S.NPro++;
+					}
+				}
+			}
+			stcell++;
+			bpt++;
+		}
+		stcell += VAL_MAXCX - rx2;
+		bpt += VAL_MAXCX - rx2;
+	}
+}
+
+void CheckCapture( OneObject* OBJ )
+{
+	if ( !CaptureAllowed( OBJ ) )
+	{
+		return;
+	}
+
+	CaptureScan S;
+	if ( PreCaptureGen[OBJ->Index] == CaptureGen )
+	{
+		//already found on the workers by CheckCaptures
+		S = PreCapture[OBJ->Index];
+	}
+	else
+	{
+		ScanCapture( OBJ, S );
+	}
+
+	bool Capture = S.CapUnit != nullptr;
+	byte CapNation = S.CapNation;
+	int NCapt = S.NCapt;
+	OneObject* CAPUNIT = S.CapUnit;
+
 	int npro = 0;
 
 	if ( Capture )
 	{
+		//the steps below may kill or capture units, the objects after
+		//this one scan again
+		CaptureGen++;
+
 		int ac1 = GetUnitActivity( OBJ );
 		if ( ac1 == 1 && !CAPUNIT )
 		{
@@ -14953,34 +15092,10 @@ void CheckCapture( OneObject* OBJ )
 			OBJ->MaxDelay = 100;
 		}
 
-		rx1 = 3;
-		rx2 = rx1 + rx1 + 1;
-
-		stcell = CELL0 - rx1 - ( rx1 << VAL_SHFCX );
-
-		//Checking for guards
-		bpt = NPresence + stcell;
-		for ( int nx = 0; nx < rx2; nx++ )
-		{
-			for ( int ny = 0; ny < rx2; ny++ )
-			{
-				if ( stcell >= 0 && stcell < VAL_MAXCX*VAL_MAXCX )
-				{
-					if ( bpt[0] & NMASK )
-					{
-						OneObject*OB = SearchProtectors( stcell, NMASK );
-						if ( OB && !OB->newMons->Capture )
-						{//Allied non-capturable units are near
-							Capture = false;
-							npro++;
-						}
-					}
-				}
-				stcell++;
-				bpt++;
-			}
-			stcell += VAL_MAXCX - rx2;
-			bpt += VAL_MAXCX - rx2;
+		if ( S.NPro )
+		{//Allied non-capturable units are near
+			Capture = false;
+			npro = S.NPro;
 		}
 
 		if ( OBJ->Nat->AI_Enabled && OBJ->newMons->Artilery )
@@ -15116,6 +15231,7 @@ void CheckCapture( OneObject* OBJ )
 		OBJ->Nat->CITY->RegisterNewUnit( OBJ );
 
 		AddObject( OBJ );
+		IndexObject( OBJ );
 
 		if ( OBJ->NewBuilding )
 		{
@@ -15154,6 +15270,7 @@ void CheckCapture( OneObject* OBJ )
 							OB->NNUM = CapNation;
 							OB->Nat->CITY->RegisterNewUnit( OB );
 							AddObject( OB );
+							IndexObject( OB );
 						}
 					}
 				}
@@ -15166,6 +15283,56 @@ void CheckCapture( OneObject* OBJ )
 	}
 }
 
+static void ScanCaptures( int Job, void* Param )
+{
+	int i1 = ( Job + 1 ) * CAPTURES_PER_JOB;
+	if ( i1 > NCaptureJobs )
+	{
+		i1 = NCaptureJobs;
+	}
+	for ( int i = Job * CAPTURES_PER_JOB; i < i1; i++ )
+	{
+		word MID = CaptureJobs[i];
+		ScanCapture( Group[MID], PreCapture[MID] );
+		PreCaptureGen[MID] = CaptureGen;
+	}
+}
+
+static bool CaptureDue( OneObject* OB, int i )
+{
+	return !OB->Sdoxlo && ( tmtmt & 31 ) == ( i & 31 ) && ( OB->newMons->Capture || !OB->Ready );
+}
+
+//CheckCapture of the objects due in this tick. The scans for capturers
+//and protectors only read the map, they run first on all cores and write
+//to PreCapture. CheckCapture then goes through the objects in index
+//order on this thread. Once a capturer is found the map may change, and
+//the objects after it scan again, see CaptureGen.
+void CheckCaptures()
+{
+	CaptureGen++;
+	NCaptureJobs = 0;
+	for ( int i = OI_Next( 0 ); i < MAXOBJECT; i = OI_Next( i + 1 ) )
+	{
+		OneObject* OB = Group[i];
+		if ( OB && CaptureDue( OB, i ) && CaptureAllowed( OB ) )
+		{
+			CaptureJobs[NCaptureJobs++] = word( i );
+		}
+	}
+	JOBS.ParallelFor( ( NCaptureJobs + CAPTURES_PER_JOB - 1 ) / CAPTURES_PER_JOB, &ScanCaptures, nullptr );
+
+	for ( int i = OI_Next( 0 ); i < MAXOBJECT; i = OI_Next( i + 1 ) )
+	{
+		OneObject* OB = Group[i];
+		if ( OB && CaptureDue( OB, i ) )
+		{
+			CheckCapture( OB );
+		}
+	}
+	CaptureGen++;
+}
+
 int GetAmountOfProtectors( OneObject* OBJ )
 {
 	int cell = ( ( OBJ->RealY >> 11 ) << VAL_SHFCX ) + ( OBJ->RealX >> 11 );
@@ -15482,11 +15649,11 @@ void MoveAwayInCell( int cell, int x, int y )
 	cell += VAL_MAXCX + 1;
 	int NMon = MCount[cell];
 	if ( !NMon )return;
-	int ofs1 = cell << SHFCELL;
+	word* CUnits = CB_CellUnits( cell );
 	word MID;
 	for ( int i = 0; i < NMon; i++ )
 	{
-		MID = GetNMSL( ofs1 + i );
+		MID = CUnits[i];
 		if ( MID != 0xFFFF )
 		{
 			OneObject* OB = Group[MID];
@@ -15537,12 +15704,12 @@ bool MoveAwaySectorInCell( int cell, int x, int y, int r0, int r1, char Dir, int
 	cell += VAL_MAXCX + 1;
 	int NMon = MCount[cell];
 	if ( !NMon )return false;
-	int ofs1 = cell << SHFCELL;
+	word* CUnits = CB_CellUnits( cell );
 	word MID;
 	bool Pushed = false;
 	for ( int i = 0; i < NMon; i++ )
 	{
-		MID = GetNMSL( ofs1 + i );
+		MID = CUnits[i];
 		if ( MID != 0xFFFF )
 		{
 			OneObject* OB = Group[MID];
@@ -15615,12 +15782,12 @@ void GetUnitsInSector( int cell, int x, int y, char IniDir, int* My, int* Enemy,
 	{
 		int NMon = MCount[cell];
 		if ( !NMon )return;
-		int ofs1 = cell << SHFCELL;
+		word* CUnits = CB_CellUnits( cell );
 		word MID;
 		bool Pushed = false;
 		for ( int i = 0; i < NMon; i++ )
 		{
-			MID = GetNMSL( ofs1 + i );
+			MID = CUnits[i];
 			if ( MID != 0xFFFF )
 			{
 				OneObject* OB = Group[MID];
@@ -15792,8 +15959,6 @@ int FindSuperSmartBestPosition( OneObject* OB, int* cx, int* cy, int dx, int dy,
 	MotionField* MF = MFIELDS;;
 	if ( OB )MF = MFIELDS + OB->LockType;
 
-	word* MotionLinks = GTOP[LTP].MotionLinks;
-	word* LinksDist = GTOP[LTP].LinksDist;
 	int NAreas = GTOP[LTP].NAreas;
 	Area* TopMap = GTOP[LTP].TopMap;
 	word* TopRef = GTOP[LTP].TopRef;
@@ -15957,8 +16122,6 @@ void NewMonsterSmartSendToLink( OneObject* OBJ )
 	int NextTop = OR1->info.SmartSend.NextTop;
 	byte LTP = OBJ->LockType;
 
-	word* MotionLinks = GTOP[LTP].MotionLinks;
-	word* LinksDist = GTOP[LTP].LinksDist;
 	int NAreas = GTOP[LTP].NAreas;
 	Area* TopMap = GTOP[LTP].TopMap;
 
@@ -15993,7 +16156,7 @@ void NewMonsterSmartSendToLink( OneObject* OBJ )
 	};
 	OR1->info.SmartSend.x = x;
 	OR1->info.SmartSend.y = y;
-	word NextNextTop = MotionLinks[FinalTop + NAreas*NextTop];
+	word NextNextTop = GetNextTop( LTP, NextTop, FinalTop );
 	if ( NextNextTop == FinalTop || FinalTop == NextTop )
 	{
 		int prio = OR1->PrioryLevel;
@@ -16014,7 +16177,7 @@ void NewMonsterSmartSendToLink( OneObject* OBJ )
 		int coy = OBJ->RealY >> 4;
 		do
 		{
-			int Next2 = MotionLinks[FinalTop + NAreas*NextNextTop];
+			int Next2 = GetNextTop( LTP, NextNextTop, FinalTop );
 			if ( Next2 != 0xFFFF )
 			{
 				Area* AR2 = TopMap + Next2;
@@ -16433,11 +16596,11 @@ int EnumUnitsInCell( int cell, int x, int y, int r, word Type, byte Nation )
 		{
 			return 0;
 		}
-		int ofs1 = cell << SHFCELL;
+		word* CUnits = CB_CellUnits( cell );
 		word MID;
 		for ( int i = 0; i < NMon; i++ )
 		{
-			MID = GetNMSL( ofs1 + i );
+			MID = CUnits[i];
 			if ( MID != 0xFFFF )
 			{
 				OneObject* OB = Group[MID];
@@ -16578,7 +16741,7 @@ void ProcessGuard()
 {
 	if ( ( tmtmt % 32 ) == 5 )
 	{
-		for ( int i = 0; i < MAXOBJECT; i++ )
+		for ( int i = OI_Next( 0 ); i < MAXOBJECT; i = OI_Next( i + 1 ) )
 		{
 			OneObject* OB = Group[i];
 			if ( OB && ( !OB->Sdoxlo ) )
@@ -1298,11 +1298,11 @@ void EraseUnitsInPoint( int x, int y )
 		int yc = y >> 3;
 		int cell = ( ( yc >> 7 ) << VAL_SHFCX ) + ( xc >> 7 ) + VAL_MAXCX + 1;
 		int NMon = MCount[cell];
-		int ofs1 = cell << SHFCELL;
+		word* CUnits = CB_CellUnits( cell );
 		word MID;
 		for (int i = 0; i < NMon; i++)
 		{
-			MID = GetNMSL( ofs1 + i );
+			MID = CUnits[i];
 			if (MID != 0xFFFF)
 			{
 				OneObject* OB = Group[MID];
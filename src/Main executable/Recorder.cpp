@@ -503,6 +503,7 @@ extern int REALTIME;
 extern int Inform;
 extern int RunDataSize;
 extern byte RunData[2048];
+extern word dwVersion;
 extern word COMPSTART[8];
 extern int RM_LandType;
 extern int RM_Resstart;
@@ -633,6 +634,13 @@ void RecordGame::ReadStream( char* Name )
 			BFPOS += RunDataSize;
 		}
 
+		//a record of another version plays with another simulation
+		if ( ( RunMethod == 0xFFFFFFFF || RunMethod == 0xFFFFFFFE ) && RunData[1] != byte( dwVersion ) )
+		{
+			STREAM.Close();
+			return;
+		}
+
 		//sz-=73;
 		//if(sz>MaxSize){
 		//	MaxSize=sz;
@@ -24,6 +24,7 @@
 #include "RealWater.h"
 #include "3DMapEd.h"
 #include "TopoGraf.h"
+#include "NewCode/AreaGraph.h"
 #include "crtdbg.h"
 #include "ActiveZone.h"
 
@@ -281,6 +282,7 @@ void DeleteAllUnits()
 			{
 				free( OB->Inside );
 			}
+			UnindexObject( i );
 			Group[i] = NULL;
 		}
 	}
@@ -1182,10 +1184,22 @@ void SaveWTopology( ResFile f1 )
 		if ( Ar1.NMines )RBlockWrite( f1, Ar1.MinesIdx, Ar1.NMines << 1 );
 		if ( Ar1.NLinks )RBlockWrite( f1, Ar1.Link, Ar1.NLinks << 2 );
 	};
-	RBlockWrite( f1, WMotionLinks, WNAreas*WNAreas * 2 );
-	RBlockWrite( f1, WLinksDist, WNAreas*WNAreas * 2 );
+	//the file keeps the full matrices, they are made row by row
+	word* Next = new word[WNAreas];
+	word* Dist = new word[WNAreas];
+	for ( int Pass = 0; Pass < 2; Pass++ )
+	{
+		for ( int j = 0; j < WNAreas; j++ )
+		{
+			AG_Row( 1, j, Next, Dist );
+			RBlockWrite( f1, Pass ? Dist : Next, WNAreas * 2 );
+		}
+	}
+	delete[] Next;
+	delete[] Dist;
 	RBlockWrite( f1, WTopRef, 2 * TopLx*TopLy );
 };
+void CreateLinkInfo();
 void LoadTopology1( ResFile f1 )
 {
 	EraseAreas();
@@ -1208,6 +1222,9 @@ void LoadTopology1( ResFile f1 )
 	RBlockRead( f1, MotionLinks, 2 * NAreas*NAreas );
 	RBlockRead( f1, LinksDist, 2 * NAreas*NAreas );
 	RBlockRead( f1, TopRef, 2 * TopLx*TopLy );
+	//the area graph of layer 0 is made from the links, the matrices of
+	//the map may come from the old relaxation
+	CreateLinkInfo();
 	//CreateRoadsNet();
 };
 void ResearchIslands();
@@ -1215,8 +1232,6 @@ void LoadWTopology1( ResFile f1 )
 {
 	RBlockRead( f1, &WNAreas, 4 );
 	WTopMap = new Area[WNAreas];
-	WMotionLinks = new word[WNAreas*WNAreas];
-	WLinksDist = new word[WNAreas*WNAreas];
 	for ( int j = 0; j < WNAreas; j++ )
 	{
 		Area* Ar1 = WTopMap + j;
@@ -1228,11 +1243,17 @@ void LoadWTopology1( ResFile f1 )
 		if ( Ar1->NMines )RBlockRead( f1, Ar1->MinesIdx, Ar1->NMines << 1 );
 		if ( Ar1->NLinks )RBlockRead( f1, Ar1->Link, Ar1->NLinks << 2 );
 	};
-	RBlockRead( f1, WMotionLinks, 2 * WNAreas*WNAreas );
-	RBlockRead( f1, WLinksDist, 2 * WNAreas*WNAreas );
+	//the matrices are skipped, the area graph is made from the links
+	word* Row = new word[WNAreas];
+	for ( int j = 0; j < WNAreas + WNAreas; j++ )
+	{
+		RBlockRead( f1, Row, 2 * WNAreas );
+	}
+	delete[] Row;
 	RBlockRead( f1, WTopRef, 2 * TopLx*TopLy );
-	GTOP[1].LinksDist = WLinksDist;
-	GTOP[1].MotionLinks = WMotionLinks;
+	MakeWAreaGraph();
+	GTOP[1].LinksDist = NULL;
+	GTOP[1].MotionLinks = NULL;
 	GTOP[1].NAreas = WNAreas;
 	GTOP[1].TopMap = WTopMap;
 	GTOP[1].TopRef = WTopRef;
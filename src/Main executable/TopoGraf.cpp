@@ -25,6 +25,8 @@
 #include "CDirSnd.h"
 #include "NewAI.h"
 #include "TopoGraf.h"
+#include "NewCode/AreaGraph.h"
+#include "NewCode/NavalPlan.h"
 #include <CrtDbg.h>
 #include "fonts.h"
 MediaTop GTOP[2];
@@ -356,50 +358,22 @@ void ClearLinkInfo() {
 		};
 	};
 };
-int OneIteration() {
-	int N = NAreas*NAreas;
-	int ofs = 0;
-	int NChanges = 0;
-	for (int i = 0; i < NAreas; i++)
-		for (int j = 0; j < NAreas; j++) {
-			if (i != j) {
-				Area* AR = TopMap + i;
-				int N = AR->NLinks;
-				word* LINK = AR->Link;
-				int CurDis = LinksDist[ofs];
-				for (int k = 0; k < N; k++) {
-					word N2 = LINK[k + k];
-					word adds = LINK[k + k + 1];
-					if (N2 != j) {
-						int ofs1 = j + N2*NAreas;
-						int dst = LinksDist[ofs1];
-						if (dst != 0xFFFF) {
-							if (dst + adds < CurDis) {
-								LinksDist[ofs] = dst + adds;
-								MotionLinks[ofs] = N2;
-								NChanges++;
-							};
-						};
-					};
-				};
-			};
-			ofs++;
-		};
-	return NChanges;
-};
 void CreateRoadsNet();
 extern bool MiniMade;
 bool ProcessMessages();
 bool NeedProcessTop;
+static int AreaInfo(int i, int* x, int* y, const word** Link) {
+	Area* AR = TopMap + i;
+	*x = AR->x;
+	*y = AR->y;
+	*Link = AR->Link;
+	return AR->NLinks;
+};
+//Exact matrices, one Dijkstra per area on all the cores. The time is in
+//the stats of the layer 0 area graph.
 void CreateLinkInfo() {
-	ClearLinkInfo();
-	int N;
-	int p = 0;
-	do {
-		ProcessMessages();
-		N = OneIteration();
-		p++;
-	} while (N&&p < 3);
+	AG_Build(0, NAreas, &AreaInfo);
+	AG_Matrix(0, MotionLinks, LinksDist);
 	//CreateRoadsNet();
 	NeedProcessTop = 1;
 	MiniMade = false;
@@ -417,6 +391,7 @@ void EraseAreas() {
 		free(TopMap);
 		free(MotionLinks);
 		free(LinksDist);
+		AG_Free(0);
 		NAreas = 0;
 		MaxArea = 0;
 		TopMap = NULL;
@@ -428,8 +403,7 @@ void EraseAreas() {
 		if (AR1->NMines)free(AR1->MinesIdx);
 	};
 	free(WTopMap);
-	free(WMotionLinks);
-	free(WLinksDist);
+	AG_Free(1);
 	WNAreas = 0;
 	WMaxArea = 0;
 	WTopMap = NULL;
@@ -630,332 +604,27 @@ void DynamicalUnLockTopCell(int x, int y) {
 	if (y < MinChY)MinChY = y;
 	if (y > MaxChY)MaxChY = y;
 };
-void OnePartIteration(int Nitr) {
-	if (!TmpMLinks)return;
-	int N = NAreas*NAreas;
-	int ofs = CurIStart*NAreas;
-	if (!CurIStart)TmpChanges = 0;
-	for (int i = CurIStart; i < NAreas; i++) {
-		for (int j = 0; j < NAreas; j++) {
-			if (i != j) {
-				Area* AR = TopMap + i;
-				int N = AR->NLinks;
-				word* LINK = AR->Link;
-				int CurDis = TmpMDist[ofs];
-				//int CurDis=LinksDist[ofs];//
-				for (int k = 0; k < N; k++) {
-					word N2 = LINK[k + k];
-					word adds = LINK[k + k + 1];
-					if (N2 != j&&adds != 0xFFFF) {
-						int ofs1 = j + N2*NAreas;
-						int dst = TmpMDist[ofs1];
-						//int dst=LinksDist[ofs1];//
-						if (dst != 0xFFFF) {
-							if (dst + adds < CurDis) {
-								int ddd = dst + adds;
-								TmpMDist[ofs] = ddd;
-								//LinksDist[ofs]=ddd;//
-								TmpMLinks[ofs] = N2;
-								//MotionLinks[ofs]=N2;//
-								if (ddd < LinksDist[ofs]) {
-									LinksDist[ofs] = ddd;
-									MotionLinks[ofs] = N2;
-								};
-								TmpChanges++;
-							};
-						};
-					};
-				};
-			};
-			ofs++;
-		};
-		CurIStart = i;
-		Nitr--;
-		if (!Nitr)return;
-	};
-	//COUNTER=TmpChanges;
-	if (!TmpChanges) {
-		memcpy(MotionLinks, TmpMLinks, NAreas*NAreas * 2);
-		memcpy(LinksDist, TmpMDist, NAreas*NAreas * 2);
-		free(TmpMLinks);
-		free(TmpMDist);
-		TmpMLinks = NULL;
-		TmpMDist = NULL;
-		CurIStart = 0;
-	}
-	else {
-		CurIStart = 0;
-	};
-};
-void LimitedClearBadLinks(word* AList, int Na, word* MLinks, word* MDist) {
-
-	int Change;
-	int p = 0;
-	do {
-		Change = 0;
-		for (int i = 0; i < Na; i++) {
-			int Ai = AList[i];
-			Area* ARi = TopMap + Ai;
-			int N = ARi->NLinks;
-			word* LINK = ARi->Link;
-			int ofs0 = int(AList[i])*NAreas;
-			for (int j = 0; j < Na; j++) {
-				if (i != j) {
-					int Aj = AList[j];
-					int ofs = ofs0 + Aj;
-					int CurDis = MDist[ofs];
-					if (CurDis != 0xFFFF) {
-						for (int k = 0; k < N; k++) {
-							word N2 = LINK[k + k];
-							//word adds=LINK[k+k+1];
-							if (N2 != Aj) {
-								int ofs1 = Aj + N2*NAreas;
-								int dst = TmpMDist[ofs1];
-								if (dst == 0xFFFF) {
-									MLinks[ofs] = 0xFFFF;
-									MDist[ofs] = 0xFFFF;
-									Change++;
-								};
-							};
-						};
-					};
-				};
-
-			};
-		};
-		p++;
-	} while (Change&&p < 100);
-};
-void TotalClearBadLinks(word* MLinks, word* MDist) {
-
-	int Change;
-	int p = 0;
-	do {
-		Change = 0;
-		for (int i = 0; i < NAreas; i++) {
-			int Ai = i;
-			Area* ARi = TopMap + Ai;
-			int N = ARi->NLinks;
-			word* LINK = ARi->Link;
-			int ofs0 = int(i)*NAreas;
-			for (int j = 0; j < NAreas; j++) {
-				if (i != j) {
-					int Aj = j;
-					int ofs = ofs0 + Aj;
-					int CurDis = MDist[ofs];
-					if (CurDis != 0xFFFF) {
-						for (int k = 0; k < N; k++) {
-							word N2 = LINK[k + k];
-							//word adds=LINK[k+k+1];
-							if (N2 != Aj) {
-								int ofs1 = Aj + N2*NAreas;
-								int dst = TmpMDist[ofs1];
-								if (dst == 0xFFFF) {
-									MLinks[ofs] = 0xFFFF;
-									MDist[ofs] = 0xFFFF;
-									Change++;
-								};
-							};
-						};
-					};
-				};
-
-			};
-		};
-		p++;
-	} while (Change&&p < 100);
-};
-void LimitedSetNewLinks(word* AList, int Na, word* MLinks, word* MDist) {
-
-	byte* aropt = new byte[NAreas];
-	memset(aropt, 0, NAreas);
-	for (int i = 0; i < Na; i++)aropt[AList[i]] = 1;
-
-	int Change;
-	int p = 0;
-	do {
-		Change = 0;
-		for (int i = 0; i < Na; i++) {
-			int Ai = AList[i];
-			Area* ARi = TopMap + Ai;
-			int N = ARi->NLinks;
-			word* LINK = ARi->Link;
-			int ofs0 = int(AList[i])*NAreas;
-			for (int j = 0; j < Na; j++) {
-				if (i != j) {
-					int Aj = AList[j];
-					int ofs = ofs0 + Aj;
-					int CurDis = MDist[ofs];
-					for (int k = 0; k < N; k++) {
-						word N2 = LINK[k + k];
-						if (aropt[N2]) {
-							word adds = LINK[k + k + 1];
-							if (N2 != Aj&&adds != 0xFFFF) {
-								int ofs1 = Aj + N2*NAreas;
-								int dst = MDist[ofs1];
-								if (dst != 0xFFFF) {
-									if (dst + adds < CurDis) {
-										int ddd = dst + adds;
-										MDist[ofs] = ddd;
-										MLinks[ofs] = N2;
-										if (ddd < LinksDist[ofs]) {
-											LinksDist[ofs] = ddd;
-											MotionLinks[ofs] = N2;
-										};
-										Change++;
-									};
-								};
-							};
-						};
-					};
-				};
-			};
-		};
-		p++;
-	} while (Change&&p < 100);
-	free(aropt);
-};
-void FastReduceWays(word* MLinks, word* MDist, word* StartChange, int NStartChange) {
-	word Changes[1000];
-	word PrevChanges[1000];
-	memcpy(PrevChanges, StartChange, NStartChange << 1);
-	int NPrev = NStartChange;
-	int Change = 0;
-	int p = 0;
-	int NChanges;
-	do {
-		memcpy(Changes, PrevChanges, NPrev << 1);
-		NChanges = NPrev;
-		NPrev = 0;
-		//extend changes
-		byte ChMap[1000];
-		memset(ChMap, 0, NAreas);
-		byte PrevMap[1000];
-		memset(PrevMap, 0, NAreas);
-		for (int i = 0; i < NChanges; i++)ChMap[Changes[i]] = 1;
-		int N1 = NChanges;
-		for (int i = 0; i < N1; i++) {
-			Area* AR = TopMap + Changes[i];
-			int N = AR->NLinks;
-			word* ids = AR->Link;
-			for (int j = 0; j < N; j++) {
-				word id = ids[j];
-				if (!ChMap[id]) {
-					ChMap[id] = 1;
-					Changes[NChanges] = id;
-					NChanges++;
-				};
-			};
-		};
-		//processing
-		Change = 0;
-		for (int i = 0; i < NChanges; i++) {
-			int Ai = Changes[i];
-			Area* ARi = TopMap + Ai;
-			int N = ARi->NLinks;
-			word* LINK = ARi->Link;
-			int ofs0 = int(Changes[i])*NAreas;
-			for (int j = 0; j < NChanges; j++) {
-				if (i != j) {
-					int Aj = Changes[j];
-					int ofs = ofs0 + Aj;
-					int CurDis = MDist[ofs];
-					for (int k = 0; k < N; k++) {
-						word N2 = LINK[k + k];
-						//if(aropt[N2]){
-						word adds = LINK[k + k + 1];
-						if (N2 != Aj&&adds != 0xFFFF) {
-							int ofs1 = Aj + N2*NAreas;
-							int dst = MDist[ofs1];
-							if (dst != 0xFFFF) {
-								if (dst + adds < CurDis) {
-									int ddd = dst + adds;
-									MDist[ofs] = ddd;
-									MLinks[ofs] = N2;
-									//if(ddd<LinksDist[ofs]){
-									//	LinksDist[ofs]=ddd;
-									//	MotionLinks[ofs]=N2;
-									//};
-									Change++;
-									if (!PrevMap[Ai]) {
-										PrevChanges[NPrev] = Ai;
-										PrevMap[Ai] = 1;
-										NPrev++;
-									};
-									if (!PrevMap[Aj]) {
-										PrevChanges[NPrev] = Aj;
-										PrevMap[Aj] = 1;
-										NPrev++;
-									};
-								};
-							};
-						};
-						//};
-					};
-				};
-			};
-		};
-		p++;
-	} while (Change&&p < 200);
-};
-void OnePartIterationNew(int Nitr);
 void RemakeGroupOfAreas(word* Grp, int Na);
-int NeedITR = 100;
-
+//Areas with changed cells are remade, the link matrices are repaired
+//where the ways through their links change
 void ProcessDynamicalTopology()
 {
 	if (NChAreas)
 	{
 		RemakeGroupOfAreas(ChAreas, NChAreas);
 		NChAreas = 0;
-		NeedITR = 3200;
-	}
-
-	if (MinChX <= MaxChX)
-	{
-		word LimAreas[200];
-		int xc = (MaxChX + MinChX) >> 1;
-		int yc = (MaxChY + MinChY) >> 1;
-		word NLim = 0;
-		for (int i = 0; i < NAreas; i++)
-		{
-			Area* AR1 = TopMap + i;
-			if (Norma(xc - int(AR1->x), yc - int(AR1->y)) < 70)
-			{
-				LimAreas[NLim] = i;
-				NLim++;
-			}
-		}
-
-		for (int i = 0; i < NAreas; i++)
-		{
-			Area* AR = TopMap + i;
-			int k = AR->NLinks;
-			for (int j = 0; j < k; j++)
-			{
-				int ofst = int(AR->Link[j + j]) + i*NAreas;
-				MotionLinks[ofst] = AR->Link[j + j];
-				LinksDist[ofst] = AR->Link[j + j + 1];
-			}
-		}
-		LimitedSetNewLinks(LimAreas, NLim, MotionLinks, LinksDist);
+		//the graph must be the one of these areas, see CreateLinkInfo
+		assert(AG_GetN(0) == NAreas);
+		AG_Repair(0, &AreaInfo, MotionLinks, LinksDist);
+#ifdef _DEBUG
+		assert(!AG_Check(0, MotionLinks, LinksDist));
+#endif
 	}
 
 	MinChX = 100000;
 	MaxChX = 0;
 	MinChY = 100000;
 	MaxChY = 0;
-
-	OnePartIterationNew(NeedITR);
-
-	if (!TmpChanges)
-	{
-		NeedITR = 1600;
-	}
-	else
-	{
-		int NeedITR = 4500;
-	}
 }
 
 void StopDynamicalTopology() {
@@ -1129,8 +798,6 @@ word* WTopRef;
 Area* WTopMap;
 int   WNAreas;
 int WMaxArea;
-word* WMotionLinks;
-word* WLinksDist;
 #define MinWNorm (8<<(ADDSH-1))
 bool AddWArea(short x, short y) {
 	for (int i = 0; i < WNAreas; i++) {
@@ -1171,59 +838,28 @@ void AddWLink(int N1, int N2) {
 	AR->Link[N + N + 1] = Norma(AR->x - WTopMap[N2].x, AR->y - WTopMap[N2].y);
 	AR->NLinks++;
 };
-int WOneIteration() {
-	int N = WNAreas*WNAreas;
-	int ofs = 0;
-	int NChanges = 0;
-	for (int i = 0; i < WNAreas; i++)
-		for (int j = 0; j < WNAreas; j++) {
-			if (i != j) {
-				Area* AR = WTopMap + i;
-				int N = AR->NLinks;
-				word* LINK = AR->Link;
-				int CurDis = WLinksDist[ofs];
-				for (int k = 0; k < N; k++) {
-					word N2 = LINK[k + k];
-					word adds = LINK[k + k + 1];
-					if (N2 != j) {
-						int ofs1 = j + N2*WNAreas;
-						int dst = WLinksDist[ofs1];
-						if (dst != 0xFFFF) {
-							if (dst + adds < CurDis) {
-								WLinksDist[ofs] = dst + adds;
-								WMotionLinks[ofs] = N2;
-								NChanges++;
-							};
-						};
-					};
-				};
-			};
-			ofs++;
-		};
-	return NChanges;
+static int WAreaInfo(int i, int* x, int* y, const word** Link) {
+	Area* AR = WTopMap + i;
+	*x = AR->x;
+	*y = AR->y;
+	*Link = AR->Link;
+	return AR->NLinks;
 };
-void ClearWLinkInfo() {
-	memset(WMotionLinks, 0xFFFF, WNAreas*WNAreas * 2);
-	memset(WLinksDist, 0xFFFF, WNAreas*WNAreas * 2);
-	for (int i = 0; i < WNAreas; i++) {
-		Area* AR = WTopMap + i;
-		int k = AR->NLinks;
-		for (int j = 0; j < k; j++) {
-			int ofst = AR->Link[j + j] + i*WNAreas;
-			WMotionLinks[ofst] = AR->Link[j + j];
-			WLinksDist[ofst] = AR->Link[j + j + 1];
-		};
-	};
+//Water ways are queried from the area graph, there are too many water
+//areas for the full matrices
+void MakeWAreaGraph() {
+	AG_Build(1, WNAreas, &WAreaInfo);
+	NP_SetSeas(WNAreas, &WAreaInfo);
 };
-void CreateWLinkInfo() {
-	ClearWLinkInfo();
-	int N;
-	int p = 0;
-	do {
-		ProcessMessages();
-		N = WOneIteration();
-		p++;
-	} while (N&&p < 500);
+word GetNextTop(byte LTP, int From, int To) {
+	MediaTop* MT = GTOP + LTP;
+	if (MT->MotionLinks)return MT->MotionLinks[From*MT->NAreas + To];
+	return AG_Next(LTP, From, To);
+};
+word GetTopDist(byte LTP, int From, int To) {
+	MediaTop* MT = GTOP + LTP;
+	if (MT->LinksDist)return MT->LinksDist[From*MT->NAreas + To];
+	return AG_Dist(LTP, From, To);
 };
 void CreateWTopMap() {
 
@@ -1314,24 +950,14 @@ void CreateWTopMap() {
 		};
 	};
 	ProcessMessages();
-	if (WNAreas) {
-		WMotionLinks = new word[WNAreas*WNAreas];
-		WLinksDist = new word[WNAreas*WNAreas];
-		memset(WMotionLinks, 0xFFFF, WNAreas*WNAreas * 2);
-		memset(WLinksDist, 0xFFFF, WNAreas*WNAreas * 2);
-		CreateWLinkInfo();
-	}
-	else {
-		WMotionLinks = NULL;
-		WLinksDist = NULL;
-	};
+	MakeWAreaGraph();
 	GTOP[0].LinksDist = LinksDist;
 	GTOP[0].MotionLinks = MotionLinks;
 	GTOP[0].NAreas = NAreas;
 	GTOP[0].TopMap = TopMap;
 	GTOP[0].TopRef = TopRef;
-	GTOP[1].LinksDist = WLinksDist;
-	GTOP[1].MotionLinks = WMotionLinks;
+	GTOP[1].LinksDist = NULL;
+	GTOP[1].MotionLinks = NULL;
 	GTOP[1].NAreas = WNAreas;
 	GTOP[1].TopMap = WTopMap;
 	GTOP[1].TopRef = WTopRef;
@@ -1352,28 +978,6 @@ extern word* TopIslands;
 extern word* NearWater;
 
 //Dynamic zones remarking
-int SearchID(word* Set, int N, word ID)
-{
-	for (int i = 0; i < N; i++)
-	{
-		if (Set[i] == ID)
-		{
-			return i;
-		}
-	}
-	return -1;
-}
-
-bool Stop = 0;
-void EraseAllLinks(int Strat, int Fin);
-struct OLDLINK {
-	int  NAr;
-	word* Links[2048];
-	word NLinks[2048];
-	word LinkBuf[40000];
-	int LBPOS;
-};
-OLDLINK* OLN = NULL;
 void SymmetrizeLinks() {
 	for (int i = 0; i < NAreas; i++) {
 		Area* AR = TopMap + i;
@@ -1392,40 +996,6 @@ void RemakeGroupOfAreas(word* Grp, int Na)
 		return;
 	}
 
-	byte* LSET = new byte[Na*Na];
-	memset(LSET, 0, Na*Na);
-
-	for (int q = 0; q < Na; q++)
-	{
-		int ID = Grp[q];
-		Area* AR = TopMap + ID;
-		int NL = AR->NLinks;
-		for (int j = 0; j < NL; j++)
-		{
-			int ID1 = AR->Link[j + j];
-			int qq = SearchID(Grp, Na, ID1);
-			if (qq != -1)
-			{
-				LSET[qq + q*Na] = 1;
-				LSET[qq*Na + q] = 1;
-			}
-		}
-	}
-
-	OLN = new OLDLINK;
-	OLN->LBPOS = 0;
-
-	for (int q = 0; q < NAreas; q++)
-	{
-		Area* AR = TopMap + q;
-		OLN->NLinks[q] = AR->NLinks;
-		OLN->Links[q] = OLN->LinkBuf + OLN->LBPOS;
-		OLN->LBPOS += AR->NLinks;
-		for (int j = 0; j < AR->NLinks; j++)
-		{
-			OLN->Links[q][j] = AR->Link[j + j];
-		}
-	}
 	//clear
 	int mmx = msx >> 1;
 	int mmy = msy >> 1;
@@ -1518,143 +1088,4 @@ void RemakeGroupOfAreas(word* Grp, int Na)
 		};
 	};
 	SymmetrizeLinks();
-	//setting new links
-	//determining erased links
-	for (int q = 0; q < Na; q++) {
-		int ID = Grp[q];
-		Area* AR = TopMap + ID;
-		int NL = AR->NLinks;
-		for (int j = 0; j < NL; j++) {
-			int ID1 = AR->Link[j + j];
-			int qq = SearchID(Grp, Na, ID1);
-			if (qq != -1) {
-				LSET[qq + q*Na] = 2;
-				LSET[qq*Na + q] = 2;
-			};
-		};
-	}
-
-	int NBadLinks = 0;
-	word BadLinks[1024];
-
-	for (int q = 0; q < Na; q++) {
-		for (int p = 0; p < q; p++) {
-			if (LSET[q*Na + p] == 1 && NBadLinks < 512) {
-				BadLinks[NBadLinks + NBadLinks] = Grp[q];
-				BadLinks[NBadLinks + NBadLinks + 1] = Grp[p];
-				NBadLinks++;
-			};
-		};
-	};
-	free(LSET);
-	int NBAD = 0;
-
-	for (int t = 0; t < NBadLinks; t++)
-	{
-		int C = BadLinks[t + t];
-		int D = BadLinks[t + t + 1];
-		EraseAllLinks(C, D);
-		EraseAllLinks(D, C);
-	}
-
-	int NN = NAreas*NAreas;
-	for (int q = 0; q < NN; q++)
-	{
-		if (LinksDist[q] == 0xFFFF)
-		{
-			MotionLinks[q] = 0xFFFF;
-		}
-	}
-	free(OLN);
-}
-
-void OnePartIterationNew(int Nitr)
-{
-	if (Stop)
-	{
-		return;
-	}
-
-	int N = NAreas*NAreas;
-	int ofs = CurIStart*NAreas;
-
-	if (!CurIStart)
-	{
-		TmpChanges = 0;
-	}
-
-	for (int i = CurIStart; i < NAreas; i++)
-	{
-		for (int j = 0; j < NAreas; j++)
-		{
-			if (i != j)
-			{
-				Area* AR = TopMap + i;
-				int N = AR->NLinks;
-				word* LINK = AR->Link;
-				int CurDis = LinksDist[ofs];
-				for (int k = 0; k < N; k++)
-				{
-					word N2 = LINK[k + k];
-					word adds = LINK[k + k + 1];
-					if (N2 != j&&adds != 0xFFFF)
-					{
-						int ofs1 = j + N2*NAreas;
-						int dst = LinksDist[ofs1];
-						if (dst != 0xFFFF)
-						{
-							if (dst + adds < CurDis)
-							{
-								int ddd = dst + adds;
-								LinksDist[ofs] = ddd;
-								MotionLinks[ofs] = N2;
-								TmpChanges++;
-							}
-						}
-					}
-				}
-				Nitr--;
-			}
-			ofs++;
-		}
-		CurIStart = i;
-		Nitr--;
-
-		if (Nitr <= 0)
-		{
-			return;
-		}
-	}
-
-	if (CurIStart == NAreas - 1)
-	{
-		CurIStart = 0;
-	}
 }
-
-void EraseLinks(int X, int A) {
-	int N = OLN->NLinks[A];
-	word* LINKS = OLN->Links[A];
-	for (int j = 0; j < N; j++) {
-		int W = LINKS[j];
-		int ofs = W*NAreas + X;
-		int Next = MotionLinks[ofs];
-		if (Next == A) {
-			LinksDist[ofs] = 0xFFFF;
-			EraseLinks(X, W);
-		};
-	};
-};
-void EraseAllLinks(int Start, int Fin) {
-	int NS = Start*NAreas;
-	LinksDist[Fin + NS] = 0xFFFF;
-	EraseLinks(Fin, Start);
-	for (int j = 0; j < NAreas; j++) {
-		int Next = MotionLinks[NS + j];
-		if (Next == Fin) {
-			LinksDist[j + NS] = 0xFFFF;
-			EraseLinks(j, Start);
-		};
-	};
-	LinksDist[Start*NAreas + Fin] = 0xFFFF;
-};
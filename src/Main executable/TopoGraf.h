@@ -79,8 +79,13 @@ extern word* WTopRef;
 extern Area* WTopMap;
 extern int   WNAreas;
 extern int WMaxArea;
-extern word* WMotionLinks;
-extern word* WLinksDist;
+void MakeWAreaGraph();
+//---------
+//Next area on the way from From to To on the land (LTP=0) or on the
+//water (LTP=1), 0xFFFF if there is none
+word GetNextTop(byte LTP,int From,int To);
+//Length of the way, 0xFFFF if there is none
+word GetTopDist(byte LTP,int From,int To);
 //---------
 void InitTopChange();
 void ClearTopChange();
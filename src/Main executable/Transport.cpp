@@ -819,6 +819,7 @@ void LeaveShipLink(OneObject* OB) {
 			INs->GlobUnlock();
 			INs->RealX = OB->RealX;
 			INs->RealY = OB->RealY;
+			StoreObjHot(INs);
 			INs->ShowMe();
 			INs->UnlimitedMotion = false;
 			INs->SetOrderedUnlimitedMotion(0);
@@ -1328,6 +1329,7 @@ void LeaveTransportLink(OneObject* OBJ) {
 
 	OB->RealX = OBJ->RealX;
 	OB->RealY = OBJ->RealY;
+	StoreObjHot(OB);
 	OB->UnlimitedMotion = 0;
 	OB->SetOrderedUnlimitedMotion(0);
 	OB->NewMonsterSendTo((OBJ->DstX * 3 + OBJ->RealX) >> 2, (OBJ->DstY * 3 + OBJ->RealY) >> 2, 16, 2);
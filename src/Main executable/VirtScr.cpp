@@ -22,6 +22,7 @@
 #include "VirtScreen.h"
 #include "MapSprites.h"
 #include "NewMon.h"
+#include "NewCode/TerrainRaster.h"
 #include <crtdbg.h>
 
 extern byte *tex1;
@@ -36,6 +37,12 @@ VirtualScreen SVSC;
 VirtualScreen::VirtualScreen()
 {
 	CellQuotX = nullptr;
+	Sets = nullptr;
+	NSets = 0;
+	MaxSets = 0;
+	FrameCells = 0;
+	FrameSets = 0;
+	FrameTriangles = 0;
 }
 
 void VirtualScreen::SetSize( int scLx, int scLy )
@@ -113,6 +120,7 @@ VirtualScreen::~VirtualScreen()
 	free( MarkedX );
 	free( TriangMap );
 	free( LoTriMap );
+	delete[] Sets;
 }
 
 void VirtualScreen::SetVSParameters( int sLx, int sLy )
@@ -278,6 +286,12 @@ void VirtualScreen::RenderVSPart( int QuotX, int QuotY, int cx, int cy, int clx,
 	};
 }
 
+static void DrawSetJob( int Index, void* Param )
+{
+	VirtualScreen* VS = (VirtualScreen*) Param;
+	VS->DrawVerticalSet( VS->Sets + Index );
+}
+
 void VirtualScreen::RefreshSurface()
 {
 	//calculating starting cell
@@ -312,10 +326,22 @@ void VirtualScreen::RefreshSurface()
 	};
 	int QuotX = div( scx, CellNX ).quot;
 	int QuotY = div( scy, CellNY ).quot;
+	NSets = 0;
 	RenderVSPart( QuotX, QuotY, vsx, vsy, Lx0, Ly0 );
 	RenderVSPart( QuotX + 1, QuotY, 0, vsy, Lx1, Ly0 );
 	RenderVSPart( QuotX, QuotY + 1, vsx, 0, Lx0, Ly1 );
 	RenderVSPart( QuotX + 1, QuotY + 1, 0, 0, Lx1, Ly1 );
+	//A triangle only covers the pixel columns of its cell and every run
+	//clips to its own lines, so the runs never write the same pixels
+	TR_ParallelFor( NSets, &DrawSetJob, this );
+	FrameCells = 0;
+	FrameTriangles = 0;
+	for (int i = 0; i < NSets; i++)
+	{
+		FrameCells += Sets[i].cly;
+		FrameTriangles += Sets[i].NRend;
+	}
+	FrameSets = NSets;
 }
 
 extern byte ExtTex[256][4];
@@ -538,6 +564,7 @@ int VirtualScreen::ShowLimitedSector( int i, bool Mode3D, int HiLine, int LoLine
 	yt2 -= ymin;
 	yt3 -= ymin;
 	int RSIZE = 0;
+	byte* Mask = TR_GetThreadMask();
 	int DXX = QuotX*RealVLx;
 	int DYY = QuotY*RealVLy;
 	x1 = x1 - DXX;
@@ -583,12 +610,12 @@ int VirtualScreen::ShowLimitedSector( int i, bool Mode3D, int HiLine, int LoLine
 				SECTMAP( StartSide ),
 				SECTMAP( StartSide + 2 ),
 				SECTMAP( StartSide + SectInLine + 1 ),
-				SimpleMask, tex1 );
+				SimpleMask, tex1, Mask );
 			DirectRenderTriangle64( x1, z1, x3, z3, x2, z2,
 				//63,31,0,63,0,0,
 				30, 15, 0, 31, 0, 0,
 				f1, f3, f2, VirtualScreenPointer,
-				ResultMask,
+				Mask,
 				HiLine, LoLine, RealVLx );
 			break;
 		case 1:
@@ -596,12 +623,12 @@ int VirtualScreen::ShowLimitedSector( int i, bool Mode3D, int HiLine, int LoLine
 				SECTMAP( StartSide + 2 ),
 				SECTMAP( StartSide + 3 ),
 				SECTMAP( StartSide + 1 ),
-				SimpleMask, tex1 );
+				SimpleMask, tex1, Mask );
 			DirectRenderTriangle64( x1, z1, x3, z3, x2, z2,
 				//63,0,0,31,63,63,
 				30, 1, 1, 14, 30, 30,
 				f1, f3, f2, VirtualScreenPointer,
-				ResultMask,
+				Mask,
 				HiLine, LoLine, RealVLx );
 			break;
 		case 2:
@@ -609,12 +636,12 @@ int VirtualScreen::ShowLimitedSector( int i, bool Mode3D, int HiLine, int LoLine
 				SECTMAP( StartSide + 3 ),
 				SECTMAP( StartSide + 4 ),
 				SECTMAP( StartSide + 5 ),
-				SimpleMask, tex1 );
+				SimpleMask, tex1, Mask );
 			DirectRenderTriangle64( x1, z1, x3, z3, x2, z2,
 				//0,63,0,0,63,31,
 				1, 30, 1, 1, 30, 14,
 				f1, f3, f2, VirtualScreenPointer,
-				ResultMask,
+				Mask,
 				HiLine, LoLine, RealVLx );
 			break;
 		case 3:
@@ -622,12 +649,12 @@ int VirtualScreen::ShowLimitedSector( int i, bool Mode3D, int HiLine, int LoLine
 				SECTMAP( StartSide + SectInLine + 4 ),
 				SECTMAP( StartSide + 6 ),
 				SECTMAP( StartSide + 5 ),
-				SimpleMask, tex1 );
+				SimpleMask, tex1, Mask );
 			DirectRenderTriangle64( x1, z1, x3, z3, x2, z2,
 				//63,63,63,0,0,31,
 				30, 30, 30, 1, 1, 14,
 				f1, f3, f2, VirtualScreenPointer,
-				ResultMask,
+				Mask,
 				HiLine, LoLine, RealVLx );
 			break;
 		};
@@ -637,14 +664,14 @@ int VirtualScreen::ShowLimitedSector( int i, bool Mode3D, int HiLine, int LoLine
 
 void CheckFirstLine();
 
+//Finds the triangles of the run and marks its cells as rendered. The
+//triangle mapping is built lazily here, so this part stays serial;
+//the drawing is done by DrawVerticalSet().
 void VirtualScreen::RenderVerticalSet( int QuotX, int QuotY, int cx, int cy, int cly )
 {
 	//debugging part
 	//assert(cy>=0&&cy+cly<=CellNY);
 	//--------------
-	int NRend = 0;
-	int HiLine = cy*CellSY;
-	int LoLine = ( cy + cly )*CellSY - 1;
 	int cost = QuotX*CellNX + cx + ( QuotY*CellNY + cy )*MaxTMX;
 	CheckFirstLine();
 	CheckVLINE( cost );
@@ -695,6 +722,43 @@ void VirtualScreen::RenderVerticalSet( int QuotX, int QuotY, int cx, int cy, int
 		CellFlags[pos] = 1;
 		pos += CellNX;
 	};
+	if (NSets >= MaxSets)
+	{
+		int n = MaxSets ? MaxSets * 2 : 256;
+		VSSet* NewSets = new VSSet[n];
+		if (NSets)
+		{
+			memcpy( NewSets, Sets, NSets * sizeof( VSSet ) );
+		}
+		delete[] Sets;
+		Sets = NewSets;
+		MaxSets = n;
+	}
+	VSSet* S = Sets + NSets;
+	NSets++;
+	S->QuotX = QuotX;
+	S->QuotY = QuotY;
+	S->cx = cx;
+	S->cy = cy;
+	S->cly = cly;
+	S->Tstart = TStart0;
+	S->Tend = Tend;
+	S->NRend = 0;
+	Sequrity();
+}
+
+//Draws the triangles of the run, may be called from the JobPool workers
+void VirtualScreen::DrawVerticalSet( VSSet* S )
+{
+	int QuotX = S->QuotX;
+	int QuotY = S->QuotY;
+	int cx = S->cx;
+	int Tstart = S->Tstart;
+	int TStart0 = Tstart;
+	int Tend = S->Tend;
+	int NRend = 0;
+	int HiLine = S->cy*CellSY;
+	int LoLine = ( S->cy + S->cly )*CellSY - 1;
 	if (cx & 1)
 	{
 		while (Tstart != Tend&&Tstart < Tend + 2)
@@ -750,7 +814,7 @@ void VirtualScreen::RenderVerticalSet( int QuotX, int QuotY, int cx, int cy, int
 			};
 		};
 	};
-	Sequrity();
+	S->NRend = NRend;
 }
 
 void VirtualScreen::CreateTrianglesMapping()
@@ -1,3 +1,17 @@
+//Run of cells in one column that RenderVerticalSet() found to be dirty;
+//Tstart/Tend bound the triangles, NRend counts the triangles drawn
+struct VSSet
+{
+	int QuotX;
+	int QuotY;
+	int cx;
+	int cy;
+	int cly;
+	int Tstart;
+	int Tend;
+	int NRend;
+};
+
 class VirtualScreen
 {
 public:
@@ -23,6 +37,14 @@ public:
 	byte* MarkedX;
 	bool Grids;
 	byte* VirtualScreenPointer;
+	//runs of the current RefreshSurface(), drawn in parallel
+	VSSet* Sets;
+	int NSets;
+	int MaxSets;
+	//cells, runs and triangles rendered by the last RefreshSurface()
+	int FrameCells;
+	int FrameSets;
+	int FrameTriangles;
 	VirtualScreen();
 	~VirtualScreen();
 	void CopyVSPart( int vx, int vy, int sx, int sy, int SizeX, int SizeY );
@@ -32,6 +54,7 @@ public:
 	void CreateTrianglesMapping();
 	void CreateVerticalTrianglesMapping( int VertSet );
 	void RenderVerticalSet( int QuotX, int QuotY, int cx, int cy, int cly );
+	void DrawVerticalSet( VSSet* S );
 	void ShowVerticalGrids( int QuotX, int QuotY, int cx, int cy, int cly );
 	void RenderVSPart( int QuotX, int QuotY, int cx, int cy, int clx, int cly );
 	void RefreshSurface();
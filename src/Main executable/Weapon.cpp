@@ -944,11 +944,11 @@ bool TraceObjectsInLine( int xs, int ys, int zs,
 				int NMon = MCount[cell];
 				if ( NMon )
 				{
-					int ofs1 = cell << SHFCELL;
+					word* CUnits = CB_CellUnits( cell );
 					word MID;
 					for ( int i = 0; i < NMon; i++ )
 					{
-						MID = GetNMSL( ofs1 + i );
+						MID = CUnits[i];
 						if ( MID != 0xFFFF && MID != SMID )
 						{
 							OneObject* OB = Group[MID];
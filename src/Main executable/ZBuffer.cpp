@@ -17,6 +17,8 @@
 #include "Math.h"
 #include "GP_Draw.h"
 #include "3DGraph.h"
+#include "NewCode/ZSort.h"
+#include "NewCode/GP_Bands.h"
 
 byte CurDrawNation = 0;
 
@@ -36,56 +38,145 @@ public:
 
 extern bool CINFMOD;
 
-//Global limit for ZCache, made to prevent access violations
-const int kZCacheMaxElements = 4096;//TODO: increase? disappearing trees etc. if buffer too small?
-//beware: simple multiplying won't work - buildings will partly disappear at some point...
+#define NYLines 2000
+#define DYZBuf 256
 
-//Array of classes, 114688 bytes
-ZElement ZCache[kZCacheMaxElements];
+//Per-frame draw list. ZCache holds the elements, every point an element
+//puts into the Z-buffer is one entry of ZPKey/ZPObj/ZPX. The arrays grow
+//on demand and are kept from frame to frame.
+ZElement* ZCache = NULL;
+int MaxZElm = 0;
 
-//Current existing elements in ZCache (max value kZCacheMaxElements - 1)
+//Current existing elements in ZCache
 int NZElm;
 
-#define NYLines 2000
-#define DYZBuf 256
-#define ZSHF  6
-#define ZBFNX (1<<ZSHF)//64
-
-byte ZBFCounter[NYLines];
-word ZBUF[NYLines*ZBFNX];
-word LOLAYER[1024];
+//Point entry: element index and the kind of the point
+#define ZP_INDEX	0x0FFFFFFF
+#define ZP_LINE		0x10000000
+#define ZP_UP		0x20000000
+#define ZP_DOWN		0x40000000
+#define ZP_DIR		( ZP_UP | ZP_DOWN )
+//point already drawn
+#define ZP_DRAWN	-1
+
+//Sort key of a point: layer, Y line, X. The lo layer goes first and the hi
+//layer last, both keep the order of adding.
+#define ZP_LAYER_LO	0
+#define ZP_LAYER_Z	1
+#define ZP_LAYER_HI	2
+#define ZP_KEY( Layer, Y, X ) ( ( DWORD( Layer ) << 27 ) | ( DWORD( Y ) << 16 ) | DWORD( word( ( X ) + 0x8000 ) ) )
+#define ZP_KEYBITS 29
+
+DWORD* ZPKey = NULL;
+int* ZPObj = NULL;
+short* ZPX = NULL;
+int NZPoints;
+int MaxZPoints = 0;
+
+//Points sorted by SortZBuffer()
+int* ZBUF = NULL;
+short* ZBUFX = NULL;
+int* ZBOrder = NULL;
+int* ZBTemp = NULL;
+int MaxZBUF = 0;
+//first point of every Y line in ZBUF
+int ZBLine[NYLines + 1];
+int ZBLineCount[NYLines];
+//points in the lo and hi layers
 int NLOITEMS;
-word HILAYER[1024];
 int NHIITEMS;
-short ZBUFX[NYLines*ZBFNX];
 //debug only!
-word ZBUF_OLD[NYLines*ZBFNX];
-word ZBUFX_OLD[NYLines*ZBFNX];
+int* ZBUF_OLD = NULL;
+short* ZBUFX_OLD = NULL;
+int MaxZBUF_OLD = 0;
 //-----------
 word BRSel[256];
 int NBSel;
-void ClearZBuffer()
+
+//Reallocates a per-frame array for N items, keeps the first Used ones
+template<class T>
+static void ZGrow( T*& Data, int Used, int N )
 {
-	memset( ZBFCounter, 0, NYLines );
-	NZElm = 0;
-	NLOITEMS = 0;
-	NHIITEMS = 0;
-	NBSel = 0;
+	T* D = new T[N];
+	if (Data)
+	{
+		memcpy( D, Data, Used * sizeof( T ) );
+		delete[]Data;
+	}
+	Data = D;
 }
 
-void AddHiPoint( short x, short y, OneObject* OB, word FileID, word SpriteID, int Param1, int Param2 )
+//Element NZElm, the caller fills it and increments NZElm
+static ZElement* NewZElement()
 {
-	if (NHIITEMS >= 1024)
+	if (NZElm == MaxZElm)
 	{
-		return;
+		int N = MaxZElm ? MaxZElm << 1 : 4096;
+		ZGrow( ZCache, NZElm, N );
+		MaxZElm = N;
 	}
+	return ZCache + NZElm;
+}
 
-	if (kZCacheMaxElements <= NZElm)
+static void AddZPoint( int Layer, int YL, short XL, int Obj )
+{
+	if (NZPoints == MaxZPoints)
 	{
-		return;
+		int N = MaxZPoints ? MaxZPoints << 1 : 8192;
+		ZGrow( ZPKey, NZPoints, N );
+		ZGrow( ZPObj, NZPoints, N );
+		ZGrow( ZPX, NZPoints, N );
+		MaxZPoints = N;
 	}
+	ZPKey[NZPoints] = ZP_KEY( Layer, YL, XL );
+	ZPObj[NZPoints] = Obj;
+	ZPX[NZPoints] = XL;
+	NZPoints++;
+	switch (Layer)
+	{
+	case ZP_LAYER_LO:
+		NLOITEMS++;
+		break;
+	case ZP_LAYER_Z:
+		ZBLineCount[YL]++;
+		break;
+	case ZP_LAYER_HI:
+		NHIITEMS++;
+		break;
+	}
+}
 
-	ZElement* ZEL = ZCache + NZElm;
+//Frames of the objects around the view, see ShowNewMonsters(). They are
+//queued after the view, so they only get what is left of the unpack cap
+#define MaxAhead 512
+static word AheadFile[MaxAhead];
+static word AheadSprite[MaxAhead];
+static int NAhead = 0;
+
+void AddAheadPoint( word FileID, word SpriteID )
+{
+	if (NAhead < MaxAhead)
+	{
+		AheadFile[NAhead] = FileID;
+		AheadSprite[NAhead] = SpriteID;
+		NAhead++;
+	}
+}
+
+void ClearZBuffer()
+{
+	NAhead = 0;
+	memset( ZBLineCount, 0, sizeof ZBLineCount );
+	NZElm = 0;
+	NZPoints = 0;
+	NLOITEMS = 0;
+	NHIITEMS = 0;
+	NBSel = 0;
+}
+
+void AddHiPoint( short x, short y, OneObject* OB, word FileID, word SpriteID, int Param1, int Param2 )
+{
+	ZElement* ZEL = NewZElement();
 	ZEL->x = x;
 	ZEL->y = y;
 	ZEL->FileID = FileID;
@@ -95,24 +186,13 @@ void AddHiPoint( short x, short y, OneObject* OB, word FileID, word SpriteID, in
 	ZEL->IsDrawn = false;
 	ZEL->Nat = CurDrawNation;
 	ZEL->NPoints = 0;
-	HILAYER[NHIITEMS] = NZElm;
-	NHIITEMS++;
+	AddZPoint( ZP_LAYER_HI, 0, 0, NZElm );
 	NZElm++;
 }
 
 void AddSuperLoPoint( short x, short y, OneObject* OB, word FileID, word SpriteID, int Param1, int Param2 )
 {
-	if (NLOITEMS >= 1024)
-	{
-		return;
-	}
-
-	if (kZCacheMaxElements <= NZElm)
-	{//BUGFIX: prevent access violation
-		return;
-	}
-
-	ZElement* ZEL = ZCache + NZElm;
+	ZElement* ZEL = NewZElement();
 	ZEL->x = x;
 	ZEL->y = y;
 	ZEL->FileID = FileID;
@@ -123,24 +203,13 @@ void AddSuperLoPoint( short x, short y, OneObject* OB, word FileID, word SpriteI
 	ZEL->Nat = CurDrawNation;
 	ZEL->IsDrawn = true;
 	ZEL->NPoints = 0;
-	LOLAYER[NLOITEMS] = NZElm;
-	NLOITEMS++;
+	AddZPoint( ZP_LAYER_LO, 0, 0, NZElm );
 	NZElm++;
 }
 
 void AddLoPoint( short x, short y, OneObject* OB, word FileID, word SpriteID, int Param1, int Param2 )
 {
-	if (NLOITEMS >= 1024)
-	{
-		return;
-	}
-
-	if (kZCacheMaxElements <= NZElm)
-	{//BUGFIX: prevent access violation
-		return;
-	}
-
-	ZElement* ZEL = ZCache + NZElm;
+	ZElement* ZEL = NewZElement();
 	ZEL->x = x;
 	ZEL->y = y;
 	ZEL->FileID = FileID;
@@ -151,8 +220,7 @@ void AddLoPoint( short x, short y, OneObject* OB, word FileID, word SpriteID, in
 	ZEL->Nat = CurDrawNation;
 	ZEL->IsDrawn = false;
 	ZEL->NPoints = 0;
-	LOLAYER[NLOITEMS] = NZElm;
-	NLOITEMS++;
+	AddZPoint( ZP_LAYER_LO, 0, 0, NZElm );
 	NZElm++;
 }
 
@@ -165,11 +233,6 @@ void AddLoPoint( short x, short y, OneObject* OB, word FileID, word SpriteID, in
 //4-shading with mask(Param2-pointer to gradient data)
 void AddPoint( short XL, short YL, short x, short y, OneObject* OB, word FileID, word SpriteID, int Param1, int Param2 )
 {
-	if (kZCacheMaxElements <= NZElm)
-	{
-		return;
-	}
-
 	YL += DYZBuf;
 
 	if (YL < 0)
@@ -182,13 +245,7 @@ void AddPoint( short XL, short YL, short x, short y, OneObject* OB, word FileID,
 		YL = NYLines - 1;
 	}
 
-	int zb = ZBFCounter[YL];
-	if (zb >= ZBFNX)
-	{
-		return;
-	}
-
-	ZElement* ZEL = ZCache + NZElm;
+	ZElement* ZEL = NewZElement();
 
 	ZEL->x = x;
 	ZEL->y = y;
@@ -204,10 +261,7 @@ void AddPoint( short XL, short YL, short x, short y, OneObject* OB, word FileID,
 	ZEL->NPoints = 0;
 
 	//adding to Z-Buffer
-	int zz = ( YL << ZSHF ) + zb;
-	ZBUF[zz] = NZElm;
-	ZBUFX[zz] = XL;
-	ZBFCounter[YL]++;
+	AddZPoint( ZP_LAYER_Z, YL, XL, NZElm );
 	NZElm++;
 }
 
@@ -367,11 +421,6 @@ void AddLine( short X1, short Y1, short X2, short Y2, short x, short y, OneObjec
 		return;
 	}
 
-	if (kZCacheMaxElements <= NZElm)
-	{
-		return;
-	}
-
 	Y1 += DYZBuf;
 	Y2 += DYZBuf;
 	if (Y1 < 0)Y1 = 0;
@@ -383,7 +432,7 @@ void AddLine( short X1, short Y1, short X2, short Y2, short x, short y, OneObjec
 		X1 += X2; X2 = X1 - X2; X1 -= X2;
 		Y1 += Y2; Y2 = Y1 - Y2; Y1 -= Y2;
 	};
-	ZElement* ZEL = ZCache + NZElm;
+	ZElement* ZEL = NewZElement();
 	ZEL->x = x;
 	ZEL->y = y;
 	ZEL->FileID = FileID;
@@ -396,104 +445,59 @@ void AddLine( short X1, short Y1, short X2, short Y2, short x, short y, OneObjec
 	ZEL->XL = X1;
 	ZEL->Nat = CurDrawNation;
 	//adding to Z-Buffer
-	word Mas = 0x8000;
-	if (Y1 < Y2)Mas |= 0x2000;
-	else Mas |= 0x4000;
+	int Mas = ZP_LINE;
+	if (Y1 < Y2)Mas |= ZP_UP;
+	else Mas |= ZP_DOWN;
 	int X0 = X1 << 16;
 	int DX = div( ( X2 - X1 ) << 16, abs( Y2 - Y1 + 1 ) ).quot;
-	int zz = ( Y1 << ZSHF );
 	if (Y2 > Y1)
 	{
-		int NPT = 0;
 		for (int YY = Y1; YY <= Y2; YY++)
 		{
-			int zb = ZBFCounter[YY];
-			if (zb < ZBFNX)
-			{
-				NPT++;
-				ZBUF[zz + zb] = NZElm | Mas;
-				ZBUFX[zz + zb] = X0 >> 16;
-				X0 += DX;
-				zz += ZBFNX;
-				ZBFCounter[YY]++;
-			};
+			AddZPoint( ZP_LAYER_Z, YY, X0 >> 16, NZElm | Mas );
+			X0 += DX;
 		};
-		ZEL->NPoints = NPT;
+		ZEL->NPoints = Y2 - Y1 + 1;
 	}
 	else
 	{
-		int NPT = 0;
 		for (int YY = Y1; YY >= Y2; YY--)
 		{
-			int zb = ZBFCounter[YY];
-			if (zb < ZBFNX)
-			{
-				NPT++;
-				ZBUF[zz + zb] = NZElm | Mas;
-				ZBUFX[zz + zb] = X0 >> 16;
-				X0 += DX;
-				zz -= ZBFNX;
-				ZBFCounter[YY]++;
-			};
+			AddZPoint( ZP_LAYER_Z, YY, X0 >> 16, NZElm | Mas );
+			X0 += DX;
 		};
-		ZEL->NPoints = NPT;
+		ZEL->NPoints = Y1 - Y2 + 1;
 	};
 	NZElm++;
 }
 
-void SortWords( int NWords, word* Data, short* Factor )
+//Orders the points by layer, Y line and X; equal points keep the order of adding
+void SortZBuffer()
 {
-	if (NWords < 2)
+	if (MaxZBUF < MaxZPoints)
 	{
-		return;
+		ZGrow( ZBUF, 0, MaxZPoints );
+		ZGrow( ZBUFX, 0, MaxZPoints );
+		ZGrow( ZBOrder, 0, MaxZPoints );
+		ZGrow( ZBTemp, 0, MaxZPoints );
+		MaxZBUF = MaxZPoints;
 	}
 
-	__asm
-	{
-		push	esi
-		push	edi
-		SW0 : mov		edi, Data
-			  mov		esi, Factor
-			  mov		ebx, 1
-			  mov		ecx, NWords;
-		dec		ecx
-			SW1 : mov		ax, [esi + 2]
-			cmp		ax, [esi]
-			jge		SW3
-			mov		dx, [esi]
-			mov[esi + 2], dx
-			mov[esi], ax
-			mov		ax, [edi]
-			mov		dx, [edi + 2]
-			mov[edi], dx
-			mov[edi + 2], ax
-			xor		ebx, ebx
-			SW3 : add		esi, 2
-			add		edi, 2
-			dec		ecx
-			jnz		SW1
-			or ebx, ebx
-			jz		SW0
-			pop		edi
-			pop		esi
+	ZS_RadixSort( ZPKey, NZPoints, ZP_KEYBITS, ZBOrder, ZBTemp );
+	for (int i = 0; i < NZPoints; i++)
+	{
+		int k = ZBOrder[i];
+		ZBUF[i] = ZPObj[k];
+		ZBUFX[i] = ZPX[k];
 	}
-}
 
-void SortZBuffer()
-{
-	int pos = 0;
-	short TEMPLINE[64];
-	int tofs = int( TEMPLINE );
+	int pos = NLOITEMS;
 	for (int i = 0; i < NYLines; i++)
 	{
-		int N = ZBFCounter[i];
-		if (N > 1)
-		{
-			word* ZPOS = ZBUF + pos;
-			SortWords( N, ZBUF + pos, ZBUFX + pos );
-		};
-		pos += ZBFNX;
+		ZBLine[i] = pos;
+		pos += ZBLineCount[i];
 	}
+	ZBLine[NYLines] = pos;
 }
 
 extern bool TransMode;
@@ -531,6 +535,7 @@ void ShowZElement( ZElement* ZEL )
 
 	if (ZEL->Param1 == 0xFFFF && ZEL->Param2 == 0xFFFF)
 	{
+		GPB_FlushBands();
 		DrawTriangleElement( ZEL->FileID, ZEL->SpriteID );
 		return;
 	}
@@ -561,6 +566,7 @@ void ShowZElement( ZElement* ZEL )
 				Brigade* BR = OB->Nat->CITY->Brigs + OB->BrigadeID;
 				if (!BR->WarType)
 				{
+					GPB_FlushBands();
 					DrawMarker( OB );
 				}
 			}
@@ -572,6 +578,7 @@ void ShowZElement( ZElement* ZEL )
 				}
 				else
 				{
+					GPB_FlushBands();
 					DrawMarker( OB );
 				}
 			}
@@ -594,6 +601,7 @@ void ShowZElement( ZElement* ZEL )
 			Y1 >>= 1;
 			X0 -= mpdx; Y0 -= mpdy;
 			X1 -= mpdx; Y1 -= mpdy;
+			GPB_FlushBands();
 			PtLine( X0, Y0, X0 + D, Y0 + D2, clrRed );
 			PtLine( X0, Y0, X1 - D, Y1 - D2, clrRed );
 			PtLine( X1, Y1, X0 + D, Y0 + D2, clrRed );
@@ -654,6 +662,7 @@ void ShowZElement( ZElement* ZEL )
 
 	if (OB && HealthMode)
 	{
+		GPB_FlushBands();
 		DrawHealth( OB );
 	}
 
@@ -672,20 +681,50 @@ void Clean_GP_IMG();
 void ShowZBuffer()
 {
 	Clean_GP_IMG();
-	memcpy( ZBUF_OLD, ZBUF, sizeof( ZBUF ) );
-	memcpy( ZBUFX_OLD, ZBUFX, sizeof( ZBUFX ) );
 	SortZBuffer();
+	int NZLines = ZBLine[NYLines] - NLOITEMS;
+	if (CINFMOD)
+	{
+		if (MaxZBUF_OLD < NZLines)
+		{
+			ZGrow( ZBUF_OLD, 0, NZLines );
+			ZGrow( ZBUFX_OLD, 0, NZLines );
+			MaxZBUF_OLD = NZLines;
+		}
+		memcpy( ZBUF_OLD, ZBUF + NLOITEMS, NZLines * sizeof( int ) );
+		memcpy( ZBUFX_OLD, ZBUFX + NLOITEMS, NZLines * sizeof( short ) );
+	}
+
+	//unpack the frames of this view in one batch on the worker threads, the
+//drawing waits for it
+	for (int i = 0; i < NZElm; i++)
+	{
+		ZElement* ZEL = ZCache + i;
+		if (ZEL->Param1 != 0xFFFF || ZEL->Param2 != 0xFFFF)
+		{
+			GPS.QueueUnpackGP( ZEL->FileID, ZEL->SpriteID );
+		}
+	}
+	for (int i = 0; i < NAhead; i++)
+	{
+		GPS.QueueUnpackGP( AheadFile[i], AheadSprite[i] );
+	}
+	GPS.UnpackQueued();
+
 	int Lx1 = smaplx << Shifter;
 	int Ly1 = mul3( smaply ) << ( Shifter - 2 );
 	SetRLCWindow( smapx, smapy, Lx1, Ly1, SCRSizeX );
+	//GP layers go to row bands drawn on the workers, the other
+	//drawings in ShowZElement() flush them first
+	GPS.BeginBands();
 	for (int i = 0; i < NLOITEMS; i++)
 	{
-		ZElement* ZEL = ZCache + LOLAYER[i];
+		ZElement* ZEL = ZCache + ZBUF[i];
 		if (ZEL->IsDrawn)ShowZElement( ZEL );
 	};
 	for (int i = 0; i < NLOITEMS; i++)
 	{
-		ZElement* ZEL = ZCache + LOLAYER[i];
+		ZElement* ZEL = ZCache + ZBUF[i];
 		if (!ZEL->IsDrawn)ShowZElement( ZEL );
 	};
 	int NITR = 0;
@@ -702,28 +741,29 @@ void ShowZBuffer()
 		bool FindXMax = false;
 		do
 		{
-			int nn = ZBFCounter[YMIN];
+			//YMIN is -1 after an element on the first line
+			int nn = YMIN >= 0 ? ZBLine[YMIN + 1] - ZBLine[YMIN] : 0;
 			if (nn)
 			{
-				word* OIND = ZBUF + YMIN*ZBFNX;
-				short* OINDX = ZBUFX + YMIN*ZBFNX;
+				int* OIND = ZBUF + ZBLine[YMIN];
+				short* OINDX = ZBUFX + ZBLine[YMIN];
 				if (FindXMin)
 				{
 					for (int j = 0; j < nn; j++)
 					{
-						word SOBJ = OIND[j];
-						if (SOBJ != 0xFFFF)
+						int SOBJ = OIND[j];
+						if (SOBJ != ZP_DRAWN)
 						{
-							ZElement* ZEL = ZCache + ( SOBJ % kZCacheMaxElements );
+							ZElement* ZEL = ZCache + ( SOBJ & ZP_INDEX );
 							if (!ZEL->IsDrawn)
 							{
-								if (OINDX/*ZBUFX*/[j] < XMIN && ( SOBJ & 0x6000 ) == 0x2000)
+								if (OINDX/*ZBUFX*/[j] < XMIN && ( SOBJ & ZP_DIR ) == ZP_UP)
 								{
 									XMIN = OINDX/*ZBUFX*/[j];
 									FindXMin = 0;
 								};
 							}
-							else OIND[j] = 0xFFFF;
+							else OIND[j] = ZP_DRAWN;
 						};
 					};
 					if (FindXMin)
@@ -736,19 +776,19 @@ void ShowZBuffer()
 				{
 					for (int j = nn - 1; j >= 0; j--)
 					{
-						word SOBJ = OIND[j];
-						if (SOBJ != 0xFFFF)
+						int SOBJ = OIND[j];
+						if (SOBJ != ZP_DRAWN)
 						{
-							ZElement* ZEL = ZCache + ( SOBJ % kZCacheMaxElements );
+							ZElement* ZEL = ZCache + ( SOBJ & ZP_INDEX );
 							if (!ZEL->IsDrawn)
 							{
-								if (OINDX/*ZBUFX*/[j] > XMAX && ( SOBJ & 0x6000 ) == 0x4000)
+								if (OINDX/*ZBUFX*/[j] > XMAX && ( SOBJ & ZP_DIR ) == ZP_DOWN)
 								{
 									XMAX = OINDX/*ZBUFX*/[j];
 									FindXMax = 0;
 								};
 							}
-							else OIND[j] = 0xFFFF;
+							else OIND[j] = ZP_DRAWN;
 						};
 					};
 					if (FindXMax)
@@ -760,10 +800,10 @@ void ShowZBuffer()
 				};
 				for (int j = 0; j < nn; j++)
 				{
-					word SOBJ = OIND[j];
-					if (SOBJ != 0xFFFF)
+					int SOBJ = OIND[j];
+					if (SOBJ != ZP_DRAWN)
 					{
-						ZElement* ZEL = ZCache + ( SOBJ % kZCacheMaxElements );
+						ZElement* ZEL = ZCache + ( SOBJ & ZP_INDEX );
 						if (!ZEL->IsDrawn)
 						{
 							int xx = OINDX[j];
@@ -775,10 +815,10 @@ void ShowZBuffer()
 							}
 							if (xx >= XMIN&&xx <= XMAX)
 							{
-								if (SOBJ & 0x6000)
+								if (SOBJ & ZP_DIR)
 								{
-									word w = SOBJ & 0x6000;
-									if (w == 0x2000)
+									int w = SOBJ & ZP_DIR;
+									if (w == ZP_UP)
 									{
 										XMIN = xx;
 										if (ZEL->NPoints > 1)ZEL->NPoints--;
@@ -786,17 +826,17 @@ void ShowZBuffer()
 										{
 											ShowZElement( ZEL );
 											ZEL->IsDrawn = 1;
-											OIND[j] = 0xFFFF;
+											OIND[j] = ZP_DRAWN;
 											YMIN = ZEL->YL - 1;
 											XMIN = ZEL->XL;
 											XMAX = ZEL->XL;
 											FindXMin = true;
 											FindXMax = true;
-											OIND[j] = 0xFFFF;
+											OIND[j] = ZP_DRAWN;
 										};
 									}
 									else
-										if (w == 0x4000)
+										if (w == ZP_DOWN)
 										{
 											XMAX = xx;
 											if (ZEL->NPoints > 1)ZEL->NPoints--;
@@ -804,13 +844,13 @@ void ShowZBuffer()
 											{
 												ShowZElement( ZEL );
 												ZEL->IsDrawn = 1;
-												OIND[j] = 0xFFFF;
+												OIND[j] = ZP_DRAWN;
 												YMIN = ZEL->YL - 1;
 												XMIN = ZEL->XL;
 												XMAX = ZEL->XL;
 												FindXMin = true;
 												FindXMax = true;
-												OIND[j] = 0xFFFF;
+												OIND[j] = ZP_DRAWN;
 											};
 										};
 								}
@@ -818,11 +858,11 @@ void ShowZBuffer()
 								{
 									ShowZElement( ZEL );
 									ZEL->IsDrawn = 1;
-									OIND[j] = 0xFFFF;
+									OIND[j] = ZP_DRAWN;
 								};
 							};
 						}
-						else OIND[j] = 0xFFFF;
+						else OIND[j] = ZP_DRAWN;
 					};
 				};
 			}
@@ -868,8 +908,9 @@ void ShowZBuffer()
 
 	for (int i = 0; i < NHIITEMS; i++)
 	{
-		ShowZElement( ZCache + HILAYER[i] );
+		ShowZElement( ZCache + ZBUF[NZPoints - NHIITEMS + i] );
 	}
+	GPS.EndBands();
 
 	if (!CINFMOD)
 	{
@@ -878,13 +919,13 @@ void ShowZBuffer()
 
 	for (int i = DYZBuf; i < 1600; i++)
 	{
-		if (ZBFCounter[i])
+		int n = ZBLine[i + 1] - ZBLine[i];
+		if (n)
 		{
-			int n = ZBFCounter[i];
-			int pos = i << ZSHF;
+			int pos = ZBLine[i] - NLOITEMS;
 			for (int j = 0; j < n; j++)
 			{
-				word ZT = ZBUF_OLD[pos + j] & 0x6000;
+				int ZT = ZBUF_OLD[pos + j] & ZP_DIR;
 				int xx = ZBUFX_OLD[pos + j];
 				int yy = i - DYZBuf;
 				switch (ZT)
@@ -892,10 +933,10 @@ void ShowZBuffer()
 				case 0:
 					Xbar( xx - 1, yy - 1, 3, 3, 0xFE );
 					break;
-				case 0x2000:
+				case ZP_UP:
 					Xbar( xx - 1, yy - 1, 3, 3, 0xFD );//clrBlue);
 					break;
-				case 0x4000:
+				case ZP_DOWN:
 					Xbar( xx - 1, yy - 1, 3, 3, 0xF9 );
 					break;
 				};
@@ -6,6 +6,8 @@ void AddSuperLoPoint(short x,short y,OneObject* OB,word FileID,word SpriteID,int
 void AddOptPoint(byte Method,short XL,short YL,short x,short y,OneObject* OB,word FileID,word Sprite,int Options);
 void AddOptLine(short X1,short Y1,short X2,short Y2,short x,short y,OneObject* OB,word FileID,word SpriteID,int Options);
 void ShowZBuffer();
+//Frame of an object just outside of the view, decoded after the view
+void AddAheadPoint(word FileID,word SpriteID);
 void ClearZBuffer();
 #define ZBF_NORMAL	0
 #define ZBF_LO		1
@@ -8,6 +8,8 @@
 #include "mode.h"
 #include "3DGraph.h"
 #include "AntiBug.h"
+#include "NewCode/FogDiffusion.h"
+#include "NewCode/FogLights.h"
 
 //Offset for fog coordinates calculation
 const int kFogOffset = 3;
@@ -70,181 +72,15 @@ int FogMode;
 
 void ShowSuperFog();
 
-#define FMSX_C 134
-#define FMSX2_C (2*FMSX_C)
+void FlushFogLights();
 
-void ProcessFog1_1()
-{
-	memcpy( fmap1, fmap, LX_fmap*LX_fmap * 2 );
-
-	int mlx = ( msx >> 2 ) + kFogOffset + kFogOffset;
-	int mly = ( msy >> 2 ) + kFogOffset + kFogOffset;
-	int fDV = ( mlx*mly ) << 1;
-	int fDH = ( mlx << 1 ) - 2;
-
-	byte z = 1;
-
-	__asm
-	{
-		push	esi
-		push	edi
-		mov		esi, fmap1
-		mov		edi, fmap
-		mov		ebx, fDV
-		mov		ecx, mlx
-		inc		ecx
-
-		xor		ebx, ebx
-		mov		bl, byte ptr mlx
-		mov		bh, byte ptr mly
-		dec		bl
-		dec		bh
-		mov		ecx, 2 + FMSX2_C
-		lab4 : mov		dx, [esi + ecx - FMSX2_C]
-			   add		dx, [esi + ecx + FMSX2_C]
-			   add		dx, [esi + ecx - 2]
-			   add		dx, [esi + ecx + 2]
-			   mov		ax, dx
-			   shr		ax, 2
-			   shr		dx, 10
-			   sub		ax, dx
-			   mov		word ptr[edi + ecx], ax
-			   add		ecx, 2
-			   dec		bl
-			   jnz		lab4
-			   sub		ecx, fDH
-			   add		ecx, FMSX2_C
-			   mov		bl, byte ptr mlx
-			   dec		bl
-			   dec		bh
-			   jnz		lab4
-			   pop		edi
-			   pop		esi
-	}
-}
-
-#undef FMSX_C
-#undef FMSX2_C
-
-#define FMSX_C (134<<1)
-#define FMSX2_C (2*FMSX_C)
-
-void ProcessFog1_2()
-{
-	memcpy( fmap1, fmap, LX_fmap*LX_fmap * 2 );
-	int mlx = ( msx >> 2 ) + kFogOffset + kFogOffset;
-	int mly = ( msy >> 2 ) + kFogOffset + kFogOffset;
-	int fDV = ( mlx*mly ) << 1;
-	int fDH = ( mlx << 1 ) - 2;
-	byte z = 1;
-	__asm {
-		push	esi
-		push	edi
-		mov		esi, fmap1
-		mov		edi, fmap
-		mov		ebx, fDV
-		mov		ecx, mlx
-		inc		ecx
-
-		xor		ebx, ebx
-		mov		bl, byte ptr mlx
-		mov		bh, byte ptr mly
-		dec		bl
-		dec		bh
-		mov		ecx, 2 + FMSX2_C
-		lab4 : mov		dx, [esi + ecx - FMSX2_C]
-			   add		dx, [esi + ecx + FMSX2_C]
-			   add		dx, [esi + ecx - 2]
-			   add		dx, [esi + ecx + 2]
-			   mov		ax, dx
-			   shr		ax, 2
-			   shr		dx, 10
-			   sub		ax, dx
-
-			   mov		word ptr[edi + ecx], ax
-			   add		ecx, 2
-			   dec		bl
-			   jnz		lab4
-			   sub		ecx, fDH
-			   add		ecx, FMSX2_C
-			   mov		bl, byte ptr mlx
-			   dec		bl
-			   dec		bh
-			   jnz		lab4
-
-			   pop		edi
-			   pop		esi
-	};
-};
-
-
-#undef FMSX_C
-#undef FMSX2_C
-
-#define FMSX_C (134<<2)
-#define FMSX2_C (2*FMSX_C)
-
-void ProcessFog1_3()
+//One step of the fog diffusion, see FogDiffusion.h
+void ProcessFog1()
 {
-	memcpy( fmap1, fmap, LX_fmap*LX_fmap * 2 );
 	int mlx = ( msx >> 2 ) + kFogOffset + kFogOffset;
 	int mly = ( msy >> 2 ) + kFogOffset + kFogOffset;
-	int fDV = ( mlx*mly ) << 1;
-	int fDH = ( mlx << 1 ) - 2;
-	byte z = 1;
-	__asm {
-		push	esi
-		push	edi
-		mov		esi, fmap1
-		mov		edi, fmap
-		mov		ebx, fDV
-		mov		ecx, mlx
-		inc		ecx
-
-		xor		ebx, ebx
-		mov		bx, word ptr mlx
-		dec		bx
-		dec		mly
-		mov		ecx, 2 + FMSX2_C
-		lab4 : mov		dx, [esi + ecx - FMSX2_C]
-			   add		dx, [esi + ecx + FMSX2_C]
-			   add		dx, [esi + ecx - 2]
-			   add		dx, [esi + ecx + 2]
-			   mov		ax, dx
-			   shr		ax, 2
-			   shr		dx, 10
-			   sub		ax, dx
-
-			   mov		word ptr[edi + ecx], ax
-			   add		ecx, 2
-			   dec		bx
-			   jnz		lab4
-			   sub		ecx, fDH
-			   add		ecx, FMSX2_C
-			   mov		bx, word ptr mlx
-			   dec		bx
-			   dec		mly
-			   jnz		lab4
-
-			   pop		edi
-			   pop		esi
-	};
-};
-
-void ProcessFog1()
-{
-	switch ( ADDSH )
-	{
-	case 1:
-		ProcessFog1_1();
-		break;
-	case 2:
-		ProcessFog1_2();
-		break;
-	case 3:
-		ProcessFog1_3();
-		break;
-	}
+	FlushFogLights();
+	FD_Process( fmap, fmap1, LX_fmap, mlx, mly );
 }
 
 int FOGOFFS[1024];
@@ -1167,6 +1003,62 @@ void FogSpot( int x, int y );
 
 int GetHeight( int x, int y );
 
+//Spots of the vision types relative to the unit, world coordinates / 16.
+//Type 9 is the widest type of the scenario lights, without the center.
+struct FogSpotOffset
+{
+	short dx;
+	short dy;
+};
+
+static const FogSpotOffset VisionSpots[] =
+{
+	//0: default unit line of view
+	{ 0, 0 },
+	//1
+	{ 128, 0 }, { -128, 0 }, { 0, 128 }, { 0, -128 },
+	//2
+	{ 128, 128 }, { -128, 128 }, { 128, -128 }, { -128, -128 },
+	//3
+	{ 2 * 128, 0 }, { -2 * 128, 0 }, { 0, -2 * 128 }, { 0, 2 * 128 },
+	{ 128, 128 }, { -128, 128 }, { 128, -128 }, { -128, -128 },
+	//4
+	{ 3 * 128, 0 }, { -3 * 128, 0 }, { 0, 3 * 128 }, { 0, -3 * 128 },
+	{ 2 * 128, 2 * 128 }, { -2 * 128, 2 * 128 }, { 2 * 128, -2 * 128 }, { -2 * 128, -2 * 128 },
+	//5
+	{ 4 * 128, 0 }, { -4 * 128, 0 }, { 0, 4 * 128 }, { 0, -4 * 128 },
+	{ 3 * 128, 3 * 128 }, { -3 * 128, 3 * 128 }, { 3 * 128, -3 * 128 }, { -3 * 128, -3 * 128 },
+	//6
+	{ 5 * 128, 0 }, { -5 * 128, 0 }, { 0, 5 * 128 }, { 0, -5 * 128 },
+	{ 4 * 128, 4 * 128 }, { -4 * 128, 4 * 128 }, { 4 * 128, -4 * 128 }, { -4 * 128, -4 * 128 },
+	//7
+	{ 6 * 128, 0 }, { -6 * 128, 0 }, { 0, 6 * 128 }, { 0, -6 * 128 },
+	{ 4 * 128, 4 }, { -4 * 128, 4 * 128 }, { 4 * 128, -4 * 128 }, { -4 * 128, -4 * 128 },
+	//8: Ukrainian peasant line of view
+	{ 0, 0 },//BUGFIX: Make peasants visible immediately at game start
+	//9
+	{ 7 * 128, 0 }, { -7 * 128, 0 }, { 0, 7 * 128 }, { 0, -7 * 128 },
+	{ 5 * 128, 3 }, { -5 * 128, 5 * 128 }, { 5 * 128, -5 * 128 }, { -5 * 128, -5 * 128 }
+};
+
+//First spot of every type, the last entry is the end of the table
+static const byte VisionSpotStart[11] = { 0, 1, 5, 9, 17, 25, 33, 41, 49, 50, 58 };
+
+//Queues the spots of vision type Type around (x,y)
+void FogLight( int x, int y, int Type )
+{
+	if ( Type < 0 || Type > 9 )
+	{
+		return;
+	}
+	//type 8 is the center spot followed by the spots of type 9
+	int last = VisionSpotStart[Type == 8 ? 10 : Type + 1];
+	for ( int i = VisionSpotStart[Type]; i < last; i++ )
+	{
+		FogSpot( x + VisionSpots[i].dx, y + VisionSpots[i].dy );
+	}
+}
+
 void UnitLight( OneObject* OB )
 {
 	if ( !OB->Ready )
@@ -1176,90 +1068,10 @@ void UnitLight( OneObject* OB )
 
 	int xx = OB->RealX >> 4;
 	int yy = OB->RealY >> 4;
-	int rr = 200;
-	int rr1 = rr - ( rr >> 2 );
 	yy -= ( GetHeight( xx, yy ) << 1 );
-	NewMonster* NM = OB->newMons;
-	switch ( NM->VisionType )
+	if ( OB->newMons->VisionType <= 8 )
 	{
-	case 0:
-		//Default unit line of view
-		FogSpot( xx, yy );
-		break;
-	case 1:
-		FogSpot( xx + 128, yy );
-		FogSpot( xx - 128, yy );
-		FogSpot( xx, yy + 128 );
-		FogSpot( xx, yy - 128 );
-		break;
-	case 2:
-		FogSpot( xx + 128, yy + 128 );
-		FogSpot( xx - 128, yy + 128 );
-		FogSpot( xx + 128, yy - 128 );
-		FogSpot( xx - 128, yy - 128 );
-		break;
-	case 3:
-		FogSpot( xx + 2 * 128, yy );
-		FogSpot( xx - 2 * 128, yy );
-		FogSpot( xx, yy - 2 * 128 );
-		FogSpot( xx, yy + 2 * 128 );
-		FogSpot( xx + 128, yy + 128 );
-		FogSpot( xx - 128, yy + 128 );
-		FogSpot( xx + 128, yy - 128 );
-		FogSpot( xx - 128, yy - 128 );
-		break;
-	case 4:
-		FogSpot( xx + 3 * 128, yy );
-		FogSpot( xx - 3 * 128, yy );
-		FogSpot( xx, yy + 3 * 128 );
-		FogSpot( xx, yy - 3 * 128 );
-		FogSpot( xx + 2 * 128, yy + 2 * 128 );
-		FogSpot( xx - 2 * 128, yy + 2 * 128 );
-		FogSpot( xx + 2 * 128, yy - 2 * 128 );
-		FogSpot( xx - 2 * 128, yy - 2 * 128 );
-		break;
-	case 5:
-		FogSpot( xx + 4 * 128, yy );
-		FogSpot( xx - 4 * 128, yy );
-		FogSpot( xx, yy + 4 * 128 );
-		FogSpot( xx, yy - 4 * 128 );
-		FogSpot( xx + 3 * 128, yy + 3 * 128 );
-		FogSpot( xx - 3 * 128, yy + 3 * 128 );
-		FogSpot( xx + 3 * 128, yy - 3 * 128 );
-		FogSpot( xx - 3 * 128, yy - 3 * 128 );
-		break;
-	case 6:
-		FogSpot( xx + 5 * 128, yy );
-		FogSpot( xx - 5 * 128, yy );
-		FogSpot( xx, yy + 5 * 128 );
-		FogSpot( xx, yy - 5 * 128 );
-		FogSpot( xx + 4 * 128, yy + 4 * 128 );
-		FogSpot( xx - 4 * 128, yy + 4 * 128 );
-		FogSpot( xx + 4 * 128, yy - 4 * 128 );
-		FogSpot( xx - 4 * 128, yy - 4 * 128 );
-		break;
-	case 7:
-		FogSpot( xx + 6 * 128, yy );
-		FogSpot( xx - 6 * 128, yy );
-		FogSpot( xx, yy + 6 * 128 );
-		FogSpot( xx, yy - 6 * 128 );
-		FogSpot( xx + 4 * 128, yy + 4 );
-		FogSpot( xx - 4 * 128, yy + 4 * 128 );
-		FogSpot( xx + 4 * 128, yy - 4 * 128 );
-		FogSpot( xx - 4 * 128, yy - 4 * 128 );
-		break;
-	case 8:
-		//Ukrainian peasant line of view
-		FogSpot( xx, yy );//BUGFIX: Make peasants visible immediately at game start
-		FogSpot( xx + 7 * 128, yy );
-		FogSpot( xx - 7 * 128, yy );
-		FogSpot( xx, yy + 7 * 128 );
-		FogSpot( xx, yy - 7 * 128 );
-		FogSpot( xx + 5 * 128, yy + 3 );
-		FogSpot( xx - 5 * 128, yy + 5 * 128 );
-		FogSpot( xx + 5 * 128, yy - 5 * 128 );
-		FogSpot( xx - 5 * 128, yy - 5 * 128 );
-		break;
+		FogLight( xx, yy, OB->newMons->VisionType );
 	}
 }
 
@@ -1421,7 +1233,13 @@ void FogSpot( int x, int y )
 		fy = maxFY;
 	}
 
-	fmap[FOGOFFS[fy] + fx] = 8000;
+	FL_Add( fx, fy );
+}
+
+//Lights the queued spots
+void FlushFogLights()
+{
+	FL_Flush( fmap, LX_fmap, 8000 );
 }
 
 //Checks if the given coordinates are concealed through fog of war
@@ -40,6 +40,8 @@
 #include "Graphs.h"
 
 #include "PlayerInfo.h"
+#include "NewCode/FrameBench.h"
+#include "NewCode/FogDiffusion.h"
 extern PlayerInfo PINFO[8];
 
 extern const int kMinorMessageDisplayTime;
@@ -204,9 +206,7 @@ bool	AsmUsage[MaxAsmCount];
 char	AsmBuf[MaxAsmCount*OneAsmSize];
 int		LastAsmRequest;
 //Массив для команд первого уровня
-bool	OrdUsage[MaxOrdCount];
-Order1  OrdBuf[MaxOrdCount];
-int		LastOrdRequest;
+SlabPool OrdPool( sizeof Order1, 1024 );
 //network sequence errors enumeration
 extern int SeqErrorsCount;
 extern int LastRandDif;
@@ -560,24 +560,14 @@ int CHSM1;
 
 Order1* GetOrdBlock()
 {
-	Order1* OR1 = new Order1;
-	memset( OR1, 0, sizeof Order1 );
-	return OR1;
+	return (Order1*) OrdPool.Alloc();
 }
 
 void OneObject::FreeOrdBlock( Order1* p )
 {
-	free( p );
-	return;
+	OrdPool.Free( p );
 }
 
-void InitOrdBuf()
-{
-	memset( OrdUsage, 0, sizeof OrdUsage );
-	memset( OrdBuf, 0, sizeof OrdBuf );
-	//LastOrdRequest=0;
-};
-
 void LoadLock()
 {
 	ResFile f = RReset( "lock.dat" );
@@ -644,6 +634,7 @@ void PostLoadExtendedMap( char* s )
 
 	RClose( f1 );
 	memset( fmap, 0, LX_fmap*LX_fmap * 2 );
+	FD_Reset();
 }
 
 void ClearMaps();
@@ -660,6 +651,7 @@ void NewMap( int szX, int szY )//Standard map size is 480x480
 	MAXSPR = 0;
 
 	memset( Group, 0, sizeof Group );
+	ReindexObjects();
 	memset( NLocks, 0, sizeof NLocks );
 
 	ClearMaps();
@@ -1574,7 +1566,9 @@ void GFieldShow()
 	if (SHOWSLIDE)
 	{
 		SetRLCWindow( smapx, smapy, smaplx << 5, mul3( smaply ) << 3, SCRSizeX );
+		FB_BeginStage( FBS_TERRAIN );
 		TestTriangle();
+		FB_EndStage( FBS_TERRAIN );
 		TestBlob();
 		time6 = GetRealTime() - time0;
 		time0 = GetRealTime();
@@ -1607,7 +1601,9 @@ void GFieldShow()
 				}
 			}
 		}
+		FB_BeginStage( FBS_OBJECTS );
 		ShowZBuffer();
+		FB_EndStage( FBS_OBJECTS );
 		ShowPulse();
 
 		if (CINFMOD)
@@ -1905,6 +1901,7 @@ void GFieldShow()
 	if (SHOWSLIDE && FogMode && BalloonState != 2 && ( !NATIONS[NatRefTBL[MyNation]].Vision ) && !NoText)
 	{
 		time0 = GetRealTime();
+		FB_BeginStage( FBS_FOG );
 
 		if (NOPAUSE && !( LockFog || NoPFOG ))
 		{
@@ -1915,6 +1912,7 @@ void GFieldShow()
 
 		DrawFog();
 
+		FB_EndStage( FBS_FOG );
 		time4 = GetRealTime() - time0;
 	}
 
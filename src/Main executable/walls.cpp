@@ -2276,11 +2276,11 @@ bool CheckUnitsInCell( int cell, byte NMask, int x, int y, int R )
 	if ( cell < 0 || cell >= VAL_MAXCIOFS )return false;
 	int NMon = MCount[cell];
 	if ( !NMon )return NULL;
-	int ofs1 = cell << SHFCELL;
+	word* CUnits = CB_CellUnits( cell );
 	word MID;
 	for ( int i = 0; i < NMon; i++ )
 	{
-		MID = GetNMSL( ofs1 + i );
+		MID = CUnits[i];
 		if ( MID != 0xFFFF )
 		{
 			OneObject* OB = Group[MID];
@@ -2438,11 +2438,11 @@ void SquishUnitsInCell( int cell, int x, int y, int R )
 		return;
 	}
 
-	int ofs1 = cell << SHFCELL;
+	word* CUnits = CB_CellUnits( cell );
 	word MID;
 	for ( int i = 0; i < NMon; i++ )
 	{
-		MID = GetNMSL( ofs1 + i );
+		MID = CUnits[i];
 		if ( MID != 0xFFFF )
 		{
 			OneObject* OB = Group[MID];
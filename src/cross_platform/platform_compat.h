@@ -19,8 +19,11 @@
 #include <fstream>
 #include <iostream>
 
-// Raylib for cross-platform graphics, audio, and input
+// Raylib for cross-platform graphics, audio, and input; the module tests
+// and the headless build compile without it
+#ifndef PLATFORM_NO_RAYLIB
 #include <raylib.h>
+#endif
 
 // ==============================================================================
 // PLATFORM DETECTION
@@ -53,6 +56,9 @@ using byte = uint8_t;
 using WORD = uint16_t;
 #endif
 
+// Lowercase word of the game headers, repeated here for the engine modules
+typedef unsigned short word;
+
 #ifndef DWORD
 using DWORD = uint32_t;
 #endif
@@ -627,6 +633,12 @@ void ShutdownNetworking();
 // ==============================================================================
 
 // Socket address structures (only if not already defined)
+#ifndef in_addr
+struct in_addr {
+    unsigned long s_addr;
+};
+#endif
+
 #ifndef sockaddr_in
 struct sockaddr_in {
     short sin_family;
@@ -636,12 +648,6 @@ struct sockaddr_in {
 };
 #endif
 
-#ifndef in_addr
-struct in_addr {
-    unsigned long s_addr;
-};
-#endif
-
 // Additional networking constants
 #ifndef S_OK
 #define S_OK 0
@@ -76,6 +76,7 @@ bool CreateDDObjects(HWND hwnd) {
     if (!RaylibGraphics::IsInitialized()) {
         RaylibGraphics::Initialize(RealLx, RealLy, "Cossacks", !window_mode);
     }
+    SetRaylibFramebufferSize(RealLx, RealLy);
     
     // Set up screen variables
     SCRSizeX = RealLx;
@@ -92,6 +93,7 @@ bool CreateDDObjects(HWND hwnd) {
         GPal[i].peBlue = i;
         GPal[i].peFlags = 0;
     }
+    SetRaylibScreenPalette(GPal);
     
     DDError = false;
     bActive = true;
@@ -105,6 +107,8 @@ void FreeDDObjects(void) {
 }
 
 void FlipPages(void) {
+    // The game changes GPal directly; a changed palette refreshes the whole frame
+    SetRaylibScreenPalette(GPal);
     // Redirect to raylib graphics system
     RaylibGraphics::FlipPages();
 }
@@ -0,0 +1,204 @@
+#include "indexed_framebuffer.h"
+#include <cstring>
+
+#if defined(_M_X64) || defined(__x86_64__) || defined(__SSE2__) || ( defined(_M_IX86_FP) && _M_IX86_FP >= 2 )
+#define FB_SSE2
+#include <emmintrin.h>
+#endif
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+// Clean rows between two dirty runs that are uploaded anyway to save a texture update call
+static const int span_merge_gap = 8;
+
+void ConvertIndexedRow(const uint8_t* src, uint32_t* dst, int count, const uint32_t* lut)
+{
+    int i = 0;
+#if defined(__AVX2__)
+    // 8 indices widened to dwords, one gather from the table
+    for (; i + 8 <= count; i += 8)
+    {
+        __m128i idx8 = _mm_loadl_epi64((const __m128i*)(src + i));
+        __m256i idx = _mm256_cvtepu8_epi32(idx8);
+        __m256i c = _mm256_i32gather_epi32((const int*)lut, idx, 4);
+        _mm256_storeu_si256((__m256i*)(dst + i), c);
+    }
+#elif defined(FB_SSE2)
+    // No byte gather before AVX2: the lookups stay scalar, the stores are 16 bytes wide
+    for (; i + 16 <= count; i += 16)
+    {
+        const uint8_t* s = src + i;
+        __m128i c0 = _mm_setr_epi32(lut[s[0]], lut[s[1]], lut[s[2]], lut[s[3]]);
+        __m128i c1 = _mm_setr_epi32(lut[s[4]], lut[s[5]], lut[s[6]], lut[s[7]]);
+        __m128i c2 = _mm_setr_epi32(lut[s[8]], lut[s[9]], lut[s[10]], lut[s[11]]);
+        __m128i c3 = _mm_setr_epi32(lut[s[12]], lut[s[13]], lut[s[14]], lut[s[15]]);
+        _mm_storeu_si128((__m128i*)(dst + i), c0);
+        _mm_storeu_si128((__m128i*)(dst + i + 4), c1);
+        _mm_storeu_si128((__m128i*)(dst + i + 8), c2);
+        _mm_storeu_si128((__m128i*)(dst + i + 12), c3);
+    }
+#endif
+    for (; i < count; i++)
+    {
+        dst[i] = lut[src[i]];
+    }
+}
+
+bool IndexedRowsEqual(const uint8_t* a, const uint8_t* b, int count)
+{
+    int i = 0;
+#ifdef FB_SSE2
+    for (; i + 64 <= count; i += 64)
+    {
+        __m128i e0 = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(a + i)), _mm_loadu_si128((const __m128i*)(b + i)));
+        __m128i e1 = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(a + i + 16)), _mm_loadu_si128((const __m128i*)(b + i + 16)));
+        __m128i e2 = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(a + i + 32)), _mm_loadu_si128((const __m128i*)(b + i + 32)));
+        __m128i e3 = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(a + i + 48)), _mm_loadu_si128((const __m128i*)(b + i + 48)));
+        __m128i e = _mm_and_si128(_mm_and_si128(e0, e1), _mm_and_si128(e2, e3));
+        if (_mm_movemask_epi8(e) != 0xFFFF)
+        {
+            return false;
+        }
+    }
+#endif
+    return memcmp(a + i, b + i, count - i) == 0;
+}
+
+IndexedFramebuffer::IndexedFramebuffer()
+    : width(0)
+    , height(0)
+    , full_refresh(true)
+{
+    // Grey ramp until the game sets its palette
+    for (int i = 0; i < 256; i++)
+    {
+        palette[i * 4] = (uint8_t)i;
+        palette[i * 4 + 1] = (uint8_t)i;
+        palette[i * 4 + 2] = (uint8_t)i;
+        palette[i * 4 + 3] = 0;
+        lut[i] = (uint32_t)i | ((uint32_t)i << 8) | ((uint32_t)i << 16) | 0xFF000000u;
+    }
+    memset(&stats, 0, sizeof(stats));
+}
+
+void IndexedFramebuffer::Resize(int w, int h)
+{
+    if (w < 0)
+    {
+        w = 0;
+    }
+    if (h < 0)
+    {
+        h = 0;
+    }
+    if (w == width && h == height)
+    {
+        return;
+    }
+    width = w;
+    height = h;
+    size_t n = (size_t)w * h;
+    pixels.assign(n, 0);
+    shadow.assign(n, 0);
+    rgba.assign(n, 0);
+    forced_rows.assign(h, 0);
+    spans.clear();
+    full_refresh = true;
+}
+
+bool IndexedFramebuffer::SetPalette(const void* entries)
+{
+    const uint8_t* p = (const uint8_t*)entries;
+    bool changed = false;
+    for (int i = 0; i < 256; i++)
+    {
+        // The flags byte does not change the color
+        const uint8_t* e = p + i * 4;
+        uint8_t* old = palette + i * 4;
+        if (e[0] != old[0] || e[1] != old[1] || e[2] != old[2])
+        {
+            old[0] = e[0];
+            old[1] = e[1];
+            old[2] = e[2];
+            lut[i] = (uint32_t)e[0] | ((uint32_t)e[1] << 8) | ((uint32_t)e[2] << 16) | 0xFF000000u;
+            changed = true;
+        }
+    }
+    if (changed)
+    {
+        full_refresh = true;
+    }
+    return changed;
+}
+
+void IndexedFramebuffer::MarkDirty(int y0, int y1)
+{
+    if (y0 < 0)
+    {
+        y0 = 0;
+    }
+    if (y1 > height)
+    {
+        y1 = height;
+    }
+    for (int y = y0; y < y1; y++)
+    {
+        forced_rows[y] = 1;
+    }
+}
+
+void IndexedFramebuffer::MarkAllDirty()
+{
+    full_refresh = true;
+}
+
+int IndexedFramebuffer::Update()
+{
+    spans.clear();
+    int converted = 0;
+    int span_start = -1;
+    int span_end = -1;
+    for (int y = 0; y < height; y++)
+    {
+        size_t ofs = (size_t)y * width;
+        const uint8_t* row = pixels.data() + ofs;
+        uint8_t* old = shadow.data() + ofs;
+        if (!full_refresh && !forced_rows[y] && IndexedRowsEqual(row, old, width))
+        {
+            continue;
+        }
+        forced_rows[y] = 0;
+        memcpy(old, row, width);
+        ConvertIndexedRow(row, rgba.data() + ofs, width, lut);
+        converted++;
+        if (span_start >= 0 && y - span_end <= span_merge_gap)
+        {
+            span_end = y + 1;
+        }
+        else
+        {
+            if (span_start >= 0)
+            {
+                spans.push_back({ span_start, span_end });
+            }
+            span_start = y;
+            span_end = y + 1;
+        }
+    }
+    if (span_start >= 0)
+    {
+        spans.push_back({ span_start, span_end });
+    }
+    full_refresh = false;
+
+    stats.frames++;
+    stats.rows_converted += converted;
+    for (const FramebufferSpan& s : spans)
+    {
+        stats.rows_uploaded += s.y1 - s.y0;
+    }
+    stats.last_rows_converted = converted;
+    stats.last_spans = (int)spans.size();
+    return (int)spans.size();
+}
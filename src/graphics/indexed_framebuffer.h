@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// 8-bit game surface that is presented through an RGBA texture.
+// The game draws into GetPixels() like it did into the DirectDraw surface.
+// Update() compares every row with the copy of the last presented frame,
+// converts only the changed rows through the palette and reports them as
+// spans, so the caller only uploads those lines. A palette change converts
+// the whole frame. Nothing in here depends on raylib.
+
+struct FramebufferSpan
+{
+    int y0;     // first row
+    int y1;     // one past the last row
+};
+
+struct FramebufferStats
+{
+    long long frames;
+    long long rows_converted;
+    long long rows_uploaded;
+    int last_rows_converted;
+    int last_spans;
+};
+
+class IndexedFramebuffer
+{
+public:
+    IndexedFramebuffer();
+
+    // Keeps the pixels when the size does not change
+    void Resize(int width, int height);
+    int GetWidth() const { return width; }
+    int GetHeight() const { return height; }
+    uint8_t* GetPixels() { return pixels.empty() ? nullptr : pixels.data(); }
+
+    // 256 entries of 4 bytes: red, green, blue, flags (PALETTEENTRY layout).
+    // Returns true and schedules a full refresh if the colors changed.
+    bool SetPalette(const void* entries);
+
+    // Rows y0..y1-1 are converted on the next Update() even if they did not change
+    void MarkDirty(int y0, int y1);
+    void MarkAllDirty();
+
+    // Converts the changed rows, returns the number of spans to upload
+    int Update();
+    int GetSpanCount() const { return (int)spans.size(); }
+    const FramebufferSpan& GetSpan(int index) const { return spans[index]; }
+    // R,G,B,A bytes, width pixels per row
+    const uint32_t* GetRGBA() const { return rgba.empty() ? nullptr : rgba.data(); }
+
+    const FramebufferStats& GetStats() const { return stats; }
+
+private:
+    int width;
+    int height;
+    std::vector<uint8_t> pixels;
+    std::vector<uint8_t> shadow;        // pixels of the last Update()
+    std::vector<uint8_t> forced_rows;
+    std::vector<uint32_t> rgba;
+    std::vector<FramebufferSpan> spans;
+    uint32_t lut[256];
+    uint8_t palette[256 * 4];
+    bool full_refresh;
+    FramebufferStats stats;
+};
+
+// Expands count palette indices to RGBA through lut
+void ConvertIndexedRow(const uint8_t* src, uint32_t* dst, int count, const uint32_t* lut);
+// true if the count bytes of a and b are equal
+bool IndexedRowsEqual(const uint8_t* a, const uint8_t* b, int count);
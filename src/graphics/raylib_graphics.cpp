@@ -1,4 +1,5 @@
 #include "raylib_graphics.h"
+#include "../raylib_system/raylib_window.h"
 #include <iostream>
 #include <fstream>
 #include <algorithm>
@@ -13,6 +14,8 @@ RaylibGraphics::RaylibGraphics()
     , vsync_enabled(true)
     , camera_enabled(false)
 {
+    screen_texture = { 0 };
+
     // Initialize camera
     camera.target = { 0.0f, 0.0f };
     camera.offset = { 0.0f, 0.0f };
@@ -75,6 +78,13 @@ void RaylibGraphics::Shutdown()
     
     // Clear sprite batch
     sprite_batch.clear();
+    
+    // Release the screen texture
+    if (screen_texture.id != 0)
+    {
+        ::UnloadTexture(screen_texture);
+        screen_texture = { 0 };
+    }
 }
 
 void RaylibGraphics::SetScreenSize(int width, int height)
@@ -218,16 +228,28 @@ RenderTexture2D* RaylibGraphics::GetRenderTexture(const std::string& name)
 
 void RaylibGraphics::BeginDrawing()
 {
+    if (g_window_headless)
+    {
+        return;
+    }
     ::BeginDrawing();
 }
 
 void RaylibGraphics::EndDrawing()
 {
+    if (g_window_headless)
+    {
+        return;
+    }
     ::EndDrawing();
 }
 
 void RaylibGraphics::Clear(Color color)
 {
+    if (g_window_headless)
+    {
+        return;
+    }
     ClearBackground(color);
 }
 
@@ -388,6 +410,72 @@ bool RaylibGraphics::SaveScreenshot(const std::string& filename)
     return true; // raylib doesn't return success/failure
 }
 
+void RaylibGraphics::SetFramebufferSize(int width, int height)
+{
+    framebuffer.Resize(width, height);
+}
+
+uint8_t* RaylibGraphics::GetFramebufferPixels()
+{
+    if (!framebuffer.GetPixels())
+    {
+        framebuffer.Resize(screen_width, screen_height);
+    }
+    return framebuffer.GetPixels();
+}
+
+void RaylibGraphics::SetFramebufferPalette(const void* palette_entries)
+{
+    framebuffer.SetPalette(palette_entries);
+}
+
+void RaylibGraphics::PresentFramebuffer()
+{
+    int width = framebuffer.GetWidth();
+    int height = framebuffer.GetHeight();
+    if (width == 0 || height == 0)
+    {
+        return;
+    }
+    
+    // Without a window the rows are still converted, so the frame costs
+    // the same, but there is no texture to upload them to
+    if (g_window_headless)
+    {
+        framebuffer.Update();
+        return;
+    }
+    
+    // (Re)create the texture when the surface size changed
+    if (screen_texture.id == 0 || screen_texture.width != width || screen_texture.height != height)
+    {
+        if (screen_texture.id != 0)
+        {
+            ::UnloadTexture(screen_texture);
+        }
+        Image image = GenImageColor(width, height, BLACK);
+        screen_texture = LoadTextureFromImage(image);
+        UnloadImage(image);
+        framebuffer.MarkAllDirty();
+    }
+    
+    // Only the changed rows are converted and uploaded
+    int span_count = framebuffer.Update();
+    const uint32_t* rgba = framebuffer.GetRGBA();
+    for (int i = 0; i < span_count; i++)
+    {
+        const FramebufferSpan& span = framebuffer.GetSpan(i);
+        RaylibRectangle rect = { 0.0f, (float)span.y0, (float)width, (float)(span.y1 - span.y0) };
+        UpdateTextureRec(screen_texture, rect, rgba + (size_t)span.y0 * width);
+    }
+    ::DrawTexture(screen_texture, 0, 0, WHITE);
+}
+
+const FramebufferStats& RaylibGraphics::GetFramebufferStats() const
+{
+    return framebuffer.GetStats();
+}
+
 void RaylibGraphics::LockSurface()
 {
     // No-op for raylib compatibility
@@ -462,8 +550,8 @@ void DrawRaylibGraphics()
 {
     if (g_graphics)
     {
-        // Main drawing is handled elsewhere
-        // This is for any additional graphics processing
+        // Present the game surface, the UI is drawn on top of it
+        g_graphics->PresentFramebuffer();
     }
 }
 
@@ -583,13 +671,32 @@ void SetRaylibFullscreen(bool fullscreen)
 
 void* GetRaylibScreenPtr()
 {
-    // For compatibility - return a dummy pointer
-    // In the original DirectDraw, this would return a pointer to video memory
-    // With raylib, we work with textures, so we return a dummy pointer
+    // The game draws into the 8-bit framebuffer like into the DirectDraw
+    // surface; the dummy buffer is only used before the graphics exist
+    if (g_graphics)
+    {
+        return g_graphics->GetFramebufferPixels();
+    }
     static char dummy_screen[1024 * 768];
     return dummy_screen;
 }
 
+void SetRaylibFramebufferSize(int width, int height)
+{
+    if (g_graphics)
+    {
+        g_graphics->SetFramebufferSize(width, height);
+    }
+}
+
+void SetRaylibScreenPalette(const void* palette_entries)
+{
+    if (g_graphics && palette_entries)
+    {
+        g_graphics->SetFramebufferPalette(palette_entries);
+    }
+}
+
 void FlipRaylibPages()
 {
     FlipRaylibBuffers();
@@ -5,6 +5,7 @@
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include "indexed_framebuffer.h"
 
 // Forward declarations
 struct RaylibTexture;
@@ -38,6 +39,10 @@ private:
     // Sprite batching
     std::vector<RaylibRectangle> sprite_batch;
     
+    // 8-bit game surface and the texture it is presented with
+    IndexedFramebuffer framebuffer;
+    Texture2D screen_texture;
+    
 public:
     RaylibGraphics();
     ~RaylibGraphics();
@@ -106,6 +111,14 @@ public:
     // Screen capture
     bool SaveScreenshot(const std::string& filename);
     
+    // Game surface: the game draws 8-bit pixels, PresentFramebuffer() uploads
+    // the rows that changed since the last call and draws the texture
+    void SetFramebufferSize(int width, int height);
+    uint8_t* GetFramebufferPixels();
+    void SetFramebufferPalette(const void* palette_entries);
+    void PresentFramebuffer();
+    const FramebufferStats& GetFramebufferStats() const;
+    
     // Surface operations (for compatibility with original surface-based operations)
     void LockSurface();
     void UnlockSurface();
@@ -177,6 +190,8 @@ extern "C" {
     
     // DirectDraw compatibility functions
     void* GetRaylibScreenPtr();
+    void SetRaylibFramebufferSize(int width, int height);
+    void SetRaylibScreenPalette(const void* palette_entries);
     void FlipRaylibPages();
     void LoadRaylibPalette(const char* filename, void* palette_entries);
     bool InitializeRaylibGraphics(int width, int height, const char* title, bool fullscreen);
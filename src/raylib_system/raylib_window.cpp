@@ -9,6 +9,7 @@
 #include <stdio.h>
 #include <string.h>
 #include <time.h>
+#include <chrono>
 
 // =============================================================================
 // GLOBAL STATE
@@ -19,6 +20,7 @@ int g_window_width = 1024;
 int g_window_height = 768;
 bool g_window_fullscreen = false;
 bool g_window_active = true;
+bool g_window_headless = false;
 bool g_window_should_close = false;
 
 // Game-specific globals (replacing Windows globals)
@@ -41,6 +43,8 @@ RaylibInputState g_input_state = {0};
 
 // Time tracking
 static double g_start_time = 0.0;
+// Clock of the headless backend, raylib has no timer without a window
+static std::chrono::steady_clock::time_point g_headless_start;
 
 // =============================================================================
 // CORE WINDOW FUNCTIONS
@@ -51,6 +55,18 @@ bool InitRaylibWindow(const RaylibWindowConfig* config) {
     g_window_width = config->width;
     g_window_height = config->height;
     g_window_fullscreen = config->fullscreen;
+    g_window_headless = config->headless;
+    
+    // Null backend: nothing of raylib is initialized, the game only draws
+    // into its 8-bit surface
+    if (config->headless) {
+        g_window_fullscreen = false;
+        RealLx = config->width;
+        RealLy = config->height;
+        g_headless_start = std::chrono::steady_clock::now();
+        memset(&g_input_state, 0, sizeof(RaylibInputState));
+        return true;
+    }
     
     // Set raylib configuration flags
     SetConfigFlags(FLAG_WINDOW_RESIZABLE);
@@ -90,6 +106,10 @@ bool InitRaylibWindow(const RaylibWindowConfig* config) {
 }
 
 void ShutdownRaylibWindow(void) {
+    if (g_window_headless) {
+        return;
+    }
+    
     // Shutdown audio system
     CloseAudioDevice();
     
@@ -101,20 +121,35 @@ void BeginRaylibFrame(void) {
     // Update input state
     UpdateRaylibInput();
     
+    if (g_window_headless) {
+        return;
+    }
+    
     // Begin drawing
     BeginDrawing();
 }
 
 void EndRaylibFrame(void) {
+    if (g_window_headless) {
+        return;
+    }
+    
     // End drawing
     EndDrawing();
 }
 
 bool ShouldWindowClose(void) {
+    if (g_window_headless) {
+        return g_window_should_close;
+    }
     return WindowShouldClose() || g_window_should_close;
 }
 
 void ToggleWindowFullscreen(void) {
+    if (g_window_headless) {
+        return;
+    }
+    
     ToggleFullscreen();
     g_window_fullscreen = !g_window_fullscreen;
     
@@ -132,7 +167,9 @@ void ToggleWindowFullscreen(void) {
 }
 
 void ResizeWindow(int width, int height) {
-    SetWindowSize(width, height);
+    if (!g_window_headless) {
+        SetWindowSize(width, height);
+    }
     g_window_width = width;
     g_window_height = height;
     RealLx = width;
@@ -140,6 +177,11 @@ void ResizeWindow(int width, int height) {
 }
 
 void GetWindowSize(int* width, int* height) {
+    if (g_window_headless) {
+        *width = g_window_width;
+        *height = g_window_height;
+        return;
+    }
     *width = GetScreenWidth();
     *height = GetScreenHeight();
 }
@@ -153,6 +195,13 @@ void SetWindowTitle(const char* title) {
 // =============================================================================
 
 void UpdateRaylibInput(void) {
+    // No input without a window, the run drives itself
+    if (g_window_headless) {
+        bActive = true;
+        g_window_active = true;
+        return;
+    }
+    
     // Update mouse position
     Vector2 mouse_pos = GetMousePosition();
     g_input_state.mouse_x = (int)mouse_pos.x;
@@ -259,6 +308,10 @@ const RaylibInputState* GetInputState(void) {
 // =============================================================================
 
 unsigned long GetTickCount(void) {
+    if (g_window_headless) {
+        std::chrono::duration<double, std::milli> t = std::chrono::steady_clock::now() - g_headless_start;
+        return (unsigned long)t.count();
+    }
     return (unsigned long)((GetTime() - g_start_time) * 1000.0);
 }
 
@@ -267,6 +320,10 @@ unsigned long GetRealTime(void) {
 }
 
 void SaveScreen(void) {
+    if (g_window_headless) {
+        return;
+    }
+    
     // Generate filename with timestamp
     time_t now = time(NULL);
     struct tm* timeinfo = localtime(&now);
@@ -284,6 +341,9 @@ void SetCursorPosition(int x, int y) {
 }
 
 void ShowCursor(bool show) {
+    if (g_window_headless) {
+        return;
+    }
     if (show) {
         ShowCursor();
     } else {
@@ -292,6 +352,9 @@ void ShowCursor(bool show) {
 }
 
 int GetSystemMetrics(int metric) {
+    if (g_window_headless) {
+        return metric == SM_CXSCREEN ? g_window_width : (metric == SM_CYSCREEN ? g_window_height : 0);
+    }
     switch (metric) {
         case SM_CXSCREEN:
             return GetMonitorWidth(GetCurrentMonitor());
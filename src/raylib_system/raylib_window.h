@@ -29,6 +29,8 @@ typedef struct {
     bool vsync;
     bool resizable;
     int target_fps;
+    bool headless;      // null backend: no window, GL context or audio device, no input,
+                        // counts as focused (benchmark runs)
 } RaylibWindowConfig;
 
 // Global window state
@@ -36,6 +38,7 @@ extern int g_window_width;
 extern int g_window_height;
 extern bool g_window_fullscreen;
 extern bool g_window_active;
+extern bool g_window_headless;
 extern bool g_window_should_close;
 
 // =============================================================================
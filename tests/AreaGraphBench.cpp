@@ -0,0 +1,248 @@
+#include "cross_platform/platform_compat.h"
+#include "NewCode/AreaGraph.h"
+#include "NewCode/JobPool.h"
+#include "TestSprite.h"
+#include <math.h>
+#include <chrono>
+#include <vector>
+
+/*
+	Water-like topologies of growing size: a grid of areas with some of
+	the links cut by islands. The full matrices of the old CreateWTopMap,
+	relaxation over the links until nothing changes, up to DENSE_MAX
+	areas, against building the area graph and NQUERIES random queries,
+	and against the exact matrices of AG_Matrix() on the workers. Ties
+	may give another next area, so only the lengths are compared. Then
+	NREPAIRS times an area is closed or opened again, and AG_Repair()
+	brings the exact matrices up to date; AG_Check() counts the entries
+	a fresh AG_Matrix() does not agree with. Prints
+	the times and sizes of every map size and the ways with another
+	length than the old matrices, it is not a test.
+*/
+
+#define MAXL 8
+#define NQUERIES 1000
+#define DENSE_MAX 2048
+#define NREPAIRS 16
+
+static int NAreas;
+static std::vector<int> AX;
+static std::vector<int> AY;
+static std::vector<int> NL;
+static std::vector<word> Link;
+
+static int AreaInfo( int i, int* x, int* y, const word** L )
+{
+	*x = AX[i];
+	*y = AY[i];
+	*L = &Link[i * MAXL * 2];
+	return NL[i];
+}
+
+static word Length( int a, int b )
+{
+	int dx = AX[a] - AX[b];
+	int dy = AY[a] - AY[b];
+	return word( sqrt( double( dx * dx + dy * dy ) ) );
+}
+
+static void AddLink( int a, int b )
+{
+	word* La = &Link[( a * MAXL + NL[a] ) * 2];
+	La[0] = word( b );
+	La[1] = Length( a, b );
+	NL[a]++;
+	word* Lb = &Link[( b * MAXL + NL[b] ) * 2];
+	Lb[0] = word( a );
+	Lb[1] = Length( a, b );
+	NL[b]++;
+}
+
+//Closes the links of area a both ways, or opens them again
+static void CloseArea( int a, bool Close )
+{
+	word* La = &Link[a * MAXL * 2];
+	for (int k = 0; k < NL[a]; k++)
+	{
+		int b = La[k + k];
+		word L = Close ? 0xFFFF : Length( a, b );
+		La[k + k + 1] = L;
+		word* Lb = &Link[b * MAXL * 2];
+		for (int m = 0; m < NL[b]; m++)
+		{
+			if (Lb[m + m] == a)
+			{
+				Lb[m + m + 1] = L;
+			}
+		}
+	}
+}
+
+//A grid of about N areas, a fifth of the links cut
+static void MakeAreas( int N )
+{
+	int G = int( sqrt( double( N ) ) );
+	N = G * G;
+	NAreas = N;
+	AX.assign( N, 0 );
+	AY.assign( N, 0 );
+	NL.assign( N, 0 );
+	Link.assign( N * MAXL * 2, 0 );
+	for (int i = 0; i < N; i++)
+	{
+		AX[i] = ( i % G ) * 8 + Rand() % 4;
+		AY[i] = ( i / G ) * 8 + Rand() % 4;
+	}
+	static const int Dir[4][2] = { { 1, 0 }, { 0, 1 }, { 1, 1 }, { -1, 1 } };
+	for (int i = 0; i < N; i++)
+	{
+		int x = i % G;
+		int y = i / G;
+		for (int d = 0; d < 4; d++)
+		{
+			int x1 = x + Dir[d][0];
+			int y1 = y + Dir[d][1];
+			if (x1 >= 0 && x1 < G && y1 < G && Rand() % 5)
+			{
+				AddLink( i, x1 + y1 * G );
+			}
+		}
+	}
+}
+
+//The full matrices the way CreateWTopMap made them
+static void DenseLinks( word* MLinks, word* MDist )
+{
+	int N = NAreas;
+	memset( MLinks, 0xFF, N * N * 2 );
+	memset( MDist, 0xFF, N * N * 2 );
+	for (int i = 0; i < N; i++)
+	{
+		const word* L = &Link[i * MAXL * 2];
+		for (int k = 0; k < NL[i]; k++)
+		{
+			MLinks[i * N + L[k + k]] = L[k + k];
+			MDist[i * N + L[k + k]] = L[k + k + 1];
+		}
+	}
+	int NChanges;
+	do
+	{
+		NChanges = 0;
+		for (int i = 0; i < N; i++)
+		{
+			const word* L = &Link[i * MAXL * 2];
+			for (int j = 0; j < N; j++)
+			{
+				if (i == j)
+				{
+					continue;
+				}
+				int ofs = i * N + j;
+				for (int k = 0; k < NL[i]; k++)
+				{
+					int N2 = L[k + k];
+					int dst = MDist[N2 * N + j];
+					if (N2 != j && dst != 0xFFFF && dst + L[k + k + 1] < MDist[ofs])
+					{
+						MDist[ofs] = word( dst + L[k + k + 1] );
+						MLinks[ofs] = word( N2 );
+						NChanges++;
+					}
+				}
+			}
+		}
+	} while (NChanges);
+}
+
+static double Ms( std::chrono::steady_clock::time_point t0 )
+{
+	return std::chrono::duration<double, std::milli>( std::chrono::steady_clock::now() - t0 ).count();
+}
+
+int main()
+{
+	Seed = 2468;
+	static const int Sizes[] = { 256, 1024, 2048, 8192 };
+	JOBS.Start( 0 );
+	int Bad = 0;
+	for (int s = 0; s < int( sizeof Sizes / sizeof Sizes[0] ); s++)
+	{
+		MakeAreas( Sizes[s] );
+		int N = NAreas;
+		std::vector<word> MLinks;
+		std::vector<word> MDist;
+		printf( "areas %d", N );
+		if (N <= DENSE_MAX)
+		{
+			MLinks.resize( N * N );
+			MDist.resize( N * N );
+			auto t0 = std::chrono::steady_clock::now();
+			DenseLinks( MLinks.data(), MDist.data() );
+			printf( " matrices %.3f ms %d KB,", Ms( t0 ), N * N * 4 / 1024 );
+		}
+		auto t0 = std::chrono::steady_clock::now();
+		AG_Build( 1, N, &AreaInfo );
+		double Build = Ms( t0 );
+		int Mismatch = 0;
+		t0 = std::chrono::steady_clock::now();
+		for (int q = 0; q < NQUERIES; q++)
+		{
+			int From = Rand() % N;
+			int To = Rand() % N;
+			AG_Next( 1, From, To );
+			word D = AG_Dist( 1, From, To );
+			Mismatch += !MDist.empty() && D != MDist[From * N + To];
+		}
+		double Query = Ms( t0 );
+		AG_Stats S;
+		AG_GetStats( 1, &S );
+		printf( " graph %.3f ms %d KB, %d queries %.3f ms, %.3f us per query, %d mismatches", Build, S.Bytes / 1024,
+			NQUERIES, Query, Query * 1000 / NQUERIES, Mismatch );
+		Bad += Mismatch;
+		if (!MDist.empty())
+		{
+			std::vector<word> XLinks( N * N );
+			std::vector<word> XDist( N * N );
+			AG_Matrix( 1, XLinks.data(), XDist.data() );
+			AG_GetStats( 1, &S );
+			int XMismatch = 0;
+			for (int i = 0; i < N * N; i++)
+			{
+				XMismatch += XDist[i] != MDist[i];
+			}
+			printf( ", exact matrices %.3f ms on %d threads, %d mismatches", S.MatrixTime, S.MatrixThreads, XMismatch );
+			Bad += XMismatch;
+			//dynamic obstacles: an area is closed and opened again by the
+			//next event, the matrices are repaired after each one
+			double RepairTime = 0;
+			int RepairEntries = 0;
+			int Closed = -1;
+			for (int e = 0; e < NREPAIRS; e++)
+			{
+				if (Closed < 0)
+				{
+					Closed = Rand() % N;
+					CloseArea( Closed, true );
+				}
+				else
+				{
+					CloseArea( Closed, false );
+					Closed = -1;
+				}
+				AG_Repair( 1, &AreaInfo, XLinks.data(), XDist.data() );
+				AG_GetStats( 1, &S );
+				RepairTime += S.RepairTime;
+				RepairEntries += S.RepairEntries;
+			}
+			int RMismatch = AG_Check( 1, XLinks.data(), XDist.data() );
+			printf( ", %d repairs %.3f ms %d entries per repair, %d mismatches", NREPAIRS, RepairTime / NREPAIRS,
+				RepairEntries / NREPAIRS, RMismatch );
+			Bad += RMismatch;
+		}
+		printf( "\n" );
+		AG_Free( 1 );
+	}
+	JOBS.Stop();
+	return Bad != 0;
+}
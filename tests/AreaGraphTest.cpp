@@ -0,0 +1,254 @@
+#include "cross_platform/platform_compat.h"
+#include "NewCode/AreaGraph.h"
+#include "Check.h"
+#include "TestSprite.h"
+
+/*
+	AG_Matrix() against a plain O(N^2) Dijkstra with the tie rule of the
+	header, AG_Dist()/AG_Next() of the clustered queries against the
+	matrix, and AG_Repair() against a fresh AG_Matrix() after areas are
+	closed and opened and links change their length. Short links of few
+	lengths give many ways of equal length, so the ties are exercised.
+	The last run has links of length 0, its rows are made again whole.
+*/
+
+#define GRID 14
+#define NA ( GRID * GRID )
+#define MAXL 8
+
+static int AX[NA];
+static int AY[NA];
+static int NL[NA];
+static word Link[NA][MAXL * 2];
+//links of the closed areas are kept at 0xFFFF
+static bool Closed[NA];
+
+static int AreaInfo( int i, int* x, int* y, const word** L )
+{
+	static word Open[MAXL * 2];
+	*x = AX[i];
+	*y = AY[i];
+	*L = Link[i];
+	if (!Closed[i])
+	{
+		bool Any = false;
+		for (int k = 0; k < NL[i]; k++)
+		{
+			Any |= Closed[Link[i][k + k]];
+		}
+		if (!Any)
+		{
+			return NL[i];
+		}
+	}
+	for (int k = 0; k < NL[i]; k++)
+	{
+		Open[k + k] = Link[i][k + k];
+		Open[k + k + 1] = Closed[i] || Closed[Link[i][k + k]] ? 0xFFFF : Link[i][k + k + 1];
+	}
+	*L = Open;
+	return NL[i];
+}
+
+static void AddLink( int a, int b, int Len )
+{
+	if (NL[a] < MAXL)
+	{
+		Link[a][NL[a] * 2] = word( b );
+		Link[a][NL[a] * 2 + 1] = word( Len );
+		NL[a]++;
+	}
+}
+
+//Zero adds links of length 0, AG_Repair() makes its rows again with them
+static void MakeAreas( bool Zero )
+{
+	for (int i = 0; i < NA; i++)
+	{
+		AX[i] = ( i % GRID ) * 8 + Rand() % 4;
+		AY[i] = ( i / GRID ) * 8 + Rand() % 4;
+		NL[i] = 0;
+		Closed[i] = false;
+	}
+	static const int Dir[4][2] = { { 1, 0 }, { 0, 1 }, { 1, 1 }, { -1, 1 } };
+	for (int i = 0; i < NA; i++)
+	{
+		int x = i % GRID;
+		int y = i / GRID;
+		for (int d = 0; d < 4; d++)
+		{
+			int x1 = x + Dir[d][0];
+			int y1 = y + Dir[d][1];
+			if (x1 >= 0 && x1 < GRID && y1 < GRID && Rand() % 5)
+			{
+				int j = x1 + y1 * GRID;
+				int Len = 1 + Rand() % 3;
+				AddLink( i, j, Len );
+				//some links are one way or longer back
+				if (Rand() % 8)
+				{
+					AddLink( j, i, Rand() % 4 ? Len : Len + 1 );
+				}
+			}
+		}
+		//a few closed, zero length and doubled links
+		if (!( Rand() % 16 ) && NL[i])
+		{
+			Link[i][1] = 0xFFFF;
+		}
+		if (Zero && !( Rand() % 16 ) && i + 1 < NA)
+		{
+			AddLink( i, i + 1, 0 );
+		}
+		if (!( Rand() % 16 ) && NL[i])
+		{
+			AddLink( i, Link[i][0], 1 + Rand() % 3 );
+		}
+	}
+}
+
+//Matrices by the rule of the header, with a scan for the next area to
+//take in place of the heap
+static void RefMatrix( word* Next, word* Dist )
+{
+	static int D[NA];
+	static word Via[NA];
+	static bool Done[NA];
+	for (int s = 0; s < NA; s++)
+	{
+		for (int i = 0; i < NA; i++)
+		{
+			D[i] = 0x7FFFFFFF;
+			Via[i] = AG_NONE;
+			Done[i] = false;
+		}
+		D[s] = 0;
+		for (;;)
+		{
+			int u = -1;
+			for (int i = 0; i < NA; i++)
+			{
+				if (!Done[i] && D[i] != 0x7FFFFFFF && ( u < 0 || D[i] < D[u] ))
+				{
+					u = i;
+				}
+			}
+			if (u < 0)
+			{
+				break;
+			}
+			Done[u] = true;
+			const word* L;
+			int x, y;
+			int n = AreaInfo( u, &x, &y, &L );
+			for (int k = 0; k < n; k++)
+			{
+				int v = L[k + k];
+				if (L[k + k + 1] != 0xFFFF && v != u && D[u] + L[k + k + 1] < D[v])
+				{
+					D[v] = D[u] + L[k + k + 1];
+					Via[v] = u == s ? word( v ) : Via[u];
+				}
+			}
+		}
+		for (int v = 0; v < NA; v++)
+		{
+			bool Way = v != s && D[v] != 0x7FFFFFFF;
+			Next[s * NA + v] = Way ? Via[v] : AG_NONE;
+			Dist[s * NA + v] = Way ? word( D[v] ) : AG_NONE;
+		}
+	}
+}
+
+static int Differ( const word* a, const word* b )
+{
+	int n = 0;
+	for (int i = 0; i < NA * NA; i++)
+	{
+		n += a[i] != b[i];
+	}
+	return n;
+}
+
+int main()
+{
+	static word Next[NA * NA];
+	static word Dist[NA * NA];
+	static word RNext[NA * NA];
+	static word RDist[NA * NA];
+	for (int Run = 0; Run < 3; Run++)
+	{
+		Seed = 100 + Run;
+		bool Zero = Run == 2;
+		MakeAreas( Zero );
+		AG_Build( 1, NA, &AreaInfo );
+		CHECK( AG_GetN( 1 ) == NA );
+		AG_Matrix( 1, Next, Dist );
+		RefMatrix( RNext, RDist );
+		CHECK( !Differ( Next, RNext ) );
+		CHECK( !Differ( Dist, RDist ) );
+		CHECK( !AG_Check( 1, Next, Dist ) );
+
+		//clustered queries: the same lengths, the next area is on a way
+		int BadDist = 0;
+		int BadNext = 0;
+		for (int q = 0; q < 4000; q++)
+		{
+			int a = Rand() % NA;
+			int b = Rand() % NA;
+			word d = AG_Dist( 1, a, b );
+			word n = AG_Next( 1, a, b );
+			BadDist += d != Dist[a * NA + b];
+			if (d != AG_NONE)
+			{
+				const word* L;
+				int x, y;
+				int nl = AreaInfo( a, &x, &y, &L );
+				int Best = 0x7FFFFFFF;
+				for (int k = 0; k < nl; k++)
+				{
+					if (L[k + k] == n && L[k + k + 1] != 0xFFFF && L[k + k + 1] < Best)
+					{
+						Best = L[k + k + 1];
+					}
+				}
+				int dn = n == b ? 0 : Dist[n * NA + b];
+				BadNext += Best == 0x7FFFFFFF || Best + dn != d;
+			}
+			else
+			{
+				BadNext += n != AG_NONE;
+			}
+		}
+		CHECK( !BadDist );
+		CHECK( !BadNext );
+
+		//repairs: areas closed and opened, links made longer and shorter
+		for (int e = 0; e < 24; e++)
+		{
+			int a = Rand() % NA;
+			if (e & 1)
+			{
+				Closed[a] = !Closed[a];
+			}
+			else if (NL[a])
+			{
+				int k = Rand() % NL[a];
+				Link[a][k + k + 1] = word( Zero ? Rand() % 5 : 1 + Rand() % 4 );
+			}
+			AG_Repair( 1, &AreaInfo, Next, Dist );
+			CHECK( !AG_Check( 1, Next, Dist ) );
+		}
+		RefMatrix( RNext, RDist );
+		CHECK( !Differ( Next, RNext ) );
+		CHECK( !Differ( Dist, RDist ) );
+		//a repair without changes changes nothing
+		AG_Repair( 1, &AreaInfo, Next, Dist );
+		AG_Stats S;
+		AG_GetStats( 1, &S );
+		CHECK( S.RepairLinks == 0 && S.RepairEntries == 0 );
+	}
+	AG_Free( 1 );
+	CHECK( AG_GetN( 1 ) == 0 );
+	return TestResult( "AreaGraphTest" );
+}
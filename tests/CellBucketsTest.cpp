@@ -0,0 +1,160 @@
+#include "cross_platform/platform_compat.h"
+#include "NewCode/CellBuckets.h"
+#include "NewCode/ObjHot.h"
+#include "NewCode/ObjIndex.h"
+#include "Check.h"
+#include "TestSprite.h"
+#include <vector>
+
+/*
+	CB_Update() against the lists made again from scratch every tick, as
+	the old per tick fill of MCount and BLDList did, but without its cap
+	on a cell: the units of every cell in index order, MCount the size of
+	the list and BLDList the highest building of the cell. Objects move,
+	start dying, change from a unit to a building, leave the map and are
+	removed between the ticks; a crowd stands in one cell. Objects that
+	changed but were not marked stay where they were.
+*/
+
+#define CX 32
+#define SHIFT 5
+#define NOBJ 4000
+
+static word MCount[CX * CX];
+static word BLDList[CX * CX];
+
+static void RandomObject( int i )
+{
+	OH_X[i] = Rand() % ( ( CX - 1 ) << 11 );
+	OH_Y[i] = Rand() % ( ( CX - 1 ) << 11 );
+	//a crowd in one cell
+	if (!( i % 5 ))
+	{
+		OH_X[i] = ( 7 << 11 ) + Rand() % 2048;
+		OH_Y[i] = ( 9 << 11 ) + Rand() % 2048;
+	}
+	OH_Flags[i] = Rand() % 6 ? OHF_UNIT : OHF_BUILDING;
+	OH_Nat[i] = byte( Rand() % 8 );
+	OI_Add( i, OH_Nat[i], OH_Flags[i] & OHF_UNIT ? OIK_UNIT : OIK_BUILDING );
+}
+
+//The lists made again from OH_* of the live objects
+static int CountBad()
+{
+	static std::vector<word> Units[CX * CX];
+	static word Top[CX * CX];
+	for (int c = 0; c < CX * CX; c++)
+	{
+		Units[c].clear();
+		Top[c] = 0xFFFF;
+	}
+	for (int i = OI_Next( 0 ); i < OI_END; i = OI_Next( i + 1 ))
+	{
+		if (OH_Flags[i] & OHF_DYING)
+		{
+			continue;
+		}
+		int c = ( OH_X[i] >> 11 ) + ( ( OH_Y[i] >> 11 ) << SHIFT ) + CX + 1;
+		if (c < 0 || c >= CX * CX)
+		{
+			continue;
+		}
+		if (OH_Flags[i] & OHF_UNIT)
+		{
+			Units[c].push_back( word( i ) );
+		}
+		else if (OH_Flags[i] & OHF_BUILDING)
+		{
+			Top[c] = word( i );
+		}
+	}
+	int Bad = 0;
+	for (int c = 0; c < CX * CX; c++)
+	{
+		Bad += MCount[c] != Units[c].size() || BLDList[c] != Top[c];
+		Bad += Units[c].size() && memcmp( CB_CellUnits( c ), Units[c].data(), Units[c].size() * sizeof( word ) );
+	}
+	return Bad;
+}
+
+int main()
+{
+	Seed = 515;
+	CB_Init( CX, SHIFT, MCount, BLDList );
+	OI_Clear();
+	for (int i = 0; i < NOBJ; i++)
+	{
+		RandomObject( i * 3 + Rand() % 3 );
+	}
+	CB_Reset();
+	CB_Update();
+	CHECK( !CountBad() );
+	CHECK( MCount[7 + ( 9 << SHIFT ) + CX + 1] > 255 );
+
+	for (int t = 0; t < 30; t++)
+	{
+		for (int k = 0; k < 600; k++)
+		{
+			int i = Rand() % ( NOBJ * 3 );
+			int What = Rand() % 10;
+			if (!OI_Has( i ))
+			{
+				if (What < 2)
+				{
+					RandomObject( i );
+					CB_Mark( i );
+				}
+				continue;
+			}
+			if (What < 5)
+			{
+				//mostly within the cell
+				OH_X[i] += int( Rand() % 1025 ) - 512;
+				OH_Y[i] += int( Rand() % 1025 ) - 512;
+				if (What == 4)
+				{
+					OH_X[i] = -3000 + Rand() % 1000;
+				}
+			}
+			else if (What == 5)
+			{
+				OH_Flags[i] |= OHF_DYING;
+			}
+			else if (What == 6)
+			{
+				OH_Flags[i] ^= OHF_UNIT | OHF_BUILDING;
+			}
+			else if (What == 7)
+			{
+				OI_Del( i );
+			}
+			CB_Mark( i );
+		}
+		CB_Update();
+		CHECK( !CountBad() );
+	}
+
+	//changes that are not marked wait for their mark
+	int i = OI_Next( 0, OIL_UNITS );
+	while (( OH_Flags[i] & ( OHF_DYING | OHF_BUILDING ) ) || OH_X[i] < 0)
+	{
+		i = OI_Next( i + 1, OIL_UNITS );
+	}
+	int c = ( OH_X[i] >> 11 ) + ( ( OH_Y[i] >> 11 ) << SHIFT ) + CX + 1;
+	word N = MCount[c];
+	OH_X[i] += 4096;
+	CB_Update();
+	CHECK( MCount[c] == N );
+	CB_Mark( i );
+	CB_Mark( i );
+	CB_Update();
+	CHECK( MCount[c] == N - 1 );
+	CHECK( !CountBad() );
+
+	//CB_Reset puts the live objects in again
+	CB_Reset();
+	CB_Update();
+	CHECK( !CountBad() );
+	CB_Free();
+	return TestResult( "CellBucketsTest" );
+}
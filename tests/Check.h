@@ -0,0 +1,25 @@
+#pragma once
+#include <stdio.h>
+
+/*
+	Checks of the module tests. A failed check is printed and counted,
+	main() returns TestResult() so CTest sees the failure.
+*/
+
+static int TestFailures = 0;
+
+#define CHECK( Cond ) \
+	do \
+	{ \
+		if (!( Cond )) \
+		{ \
+			printf( "%s:%d: CHECK( %s ) failed\n", __FILE__, __LINE__, #Cond ); \
+			TestFailures++; \
+		} \
+	} while (0)
+
+static inline int TestResult( const char* Name )
+{
+	printf( "%s: %s, %d failed checks\n", Name, TestFailures ? "FAILED" : "passed", TestFailures );
+	return TestFailures ? 1 : 0;
+}
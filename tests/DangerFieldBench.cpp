@@ -0,0 +1,177 @@
+#include "cross_platform/platform_compat.h"
+#include "NewCode/DangerField.h"
+#include "TestSprite.h"
+#include <math.h>
+#include <chrono>
+#include <vector>
+
+/*
+	Danger of a cannon heavy late game: NOBJ cannons, mortars and ships
+	of 8 nations stand over a map of LX x LX cells and a quarter of them
+	moves on every tick. For NTICKS ticks every nation asks the danger of
+	its enemies on NLOOKUPS cells, by the scan over all objects that
+	GetDangValue() did for a cell and by the danger maps, which stamp the
+	objects that moved first. Prints the times, the stamps and the
+	lookups that differ, it is not a test.
+*/
+
+#define LX 128
+#define SHIFT 7
+#define NOBJ 400
+#define NTICKS 64
+#define NLOOKUPS 1024
+
+//Weapons: a cannon, a mortar, a ship with cannons and a ship with a
+//mortar, with the damage of OBJDANG
+struct Weapon
+{
+	int Dam;
+	bool Water;
+	byte Kind;
+	int R1;
+	int R2;
+};
+
+static const Weapon Weapons[] =
+{
+	{ 1, false, DFW_SHOOTS, 0, 900 },
+	{ 1, false, DFW_SHOOTS | DFW_ARC, 400, 2400 },
+	{ 3, true, DFW_SHOOTS | DFW_ARC, 150, 1400 },
+	{ 6, true, DFW_SHOOTS | DFW_ARC, 300, 2000 }
+};
+
+//as the game Norma()
+static int Octagon( int dx, int dy )
+{
+	dx = abs( dx );
+	dy = abs( dy );
+	return dx > dy ? dx + ( dy * 3 >> 3 ) : dy + ( dx * 3 >> 3 );
+}
+
+//hills, the arcs reach farther downhill
+static int Bumps( int x, int y )
+{
+	return int( 60 * sin( x * 0.002 ) + 40 * cos( y * 0.003 ) ) + 100;
+}
+
+static int Height( int x, int y )
+{
+	return Bumps( x, y ) + 32;
+}
+
+static double Ms( std::chrono::steady_clock::time_point t0 )
+{
+	return std::chrono::duration<double, std::milli>( std::chrono::steady_clock::now() - t0 ).count();
+}
+
+int main()
+{
+	Seed = 2468;
+	DF_SetNorm( &Octagon );
+	DF_SetHeight( &Height );
+	DF_Init( LX, SHIFT );
+	int Size = LX << DF_CSHIFT;
+	std::vector<DF_Reach> Obj( NOBJ );
+	for (int i = 0; i < NOBJ; i++)
+	{
+		const Weapon& W = Weapons[i % 4];
+		DF_Reach& R = Obj[i];
+		memset( &R, 0, sizeof R );
+		R.x = Rand() % Size;
+		R.y = Rand() % Size;
+		R.z = Bumps( R.x, R.y ) + 16;
+		R.Nat = ( i / 4 ) & 7;
+		R.Dam = W.Dam;
+		R.Water = W.Water;
+		R.Pad = 48;
+		R.Kind[0] = W.Kind;
+		R.R1[0] = W.R1;
+		R.R2[0] = W.R2;
+	}
+	std::vector<int> CX( NLOOKUPS );
+	std::vector<int> CY( NLOOKUPS );
+	std::vector<int> CZ( NLOOKUPS );
+	std::vector<byte> Val[2];
+	Val[0].resize( NTICKS * NLOOKUPS * 8 );
+	Val[1].resize( NTICKS * NLOOKUPS * 8 );
+	double Time[2] = { 0, 0 };
+	DF_ClearStats();
+	for (int t = 0; t < NTICKS; t++)
+	{
+		for (int i = 0; i < NOBJ; i++)
+		{
+			if (!( Rand() & 3 ))
+			{
+				DF_Reach& R = Obj[i];
+				R.x += int( Rand() % 17 ) - 8;
+				R.y += int( Rand() % 17 ) - 8;
+				R.x = R.x < 0 ? 0 : ( R.x >= Size ? Size - 1 : R.x );
+				R.y = R.y < 0 ? 0 : ( R.y >= Size ? Size - 1 : R.y );
+				R.z = Bumps( R.x, R.y ) + 16;
+			}
+		}
+		for (int k = 0; k < NLOOKUPS; k++)
+		{
+			CX[k] = Rand() % LX;
+			CY[k] = Rand() % LX;
+			CZ[k] = Height( ( CX[k] << DF_CSHIFT ) + DF_CELL / 2, ( CY[k] << DF_CSHIFT ) + DF_CELL / 2 );
+		}
+		for (int m = 0; m < 2; m++)
+		{
+			byte* V = &Val[m][t * NLOOKUPS * 8];
+			auto t0 = std::chrono::steady_clock::now();
+			if (m)
+			{
+				for (int i = 0; i < NOBJ; i++)
+				{
+					DF_Set( i, &Obj[i] );
+				}
+				for (int n = 0; n < 8; n++)
+				{
+					for (int k = 0; k < NLOOKUPS; k++)
+					{
+						*( V++ ) = byte( DF_GetMask( CX[k], CY[k], 255 & ~( 1 << n ) ) );
+					}
+				}
+			}
+			else
+			{
+				for (int n = 0; n < 8; n++)
+				{
+					for (int k = 0; k < NLOOKUPS; k++)
+					{
+						int xx = ( CX[k] << DF_CSHIFT ) + DF_CELL / 2;
+						int yy = ( CY[k] << DF_CSHIFT ) + DF_CELL / 2;
+						int dam = 0;
+						int wat = 0;
+						for (int i = 0; i < NOBJ; i++)
+						{
+							if (Obj[i].Nat != n && DF_Reaches( &Obj[i], xx, yy, CZ[k] ))
+							{
+								dam += Obj[i].Dam;
+								if (Obj[i].Water)
+								{
+									wat = 128;
+								}
+							}
+						}
+						*( V++ ) = byte( ( dam > 127 ? 127 : dam ) | wat );
+					}
+				}
+			}
+			Time[m] += Ms( t0 );
+		}
+	}
+	int Mismatch = 0;
+	for (size_t k = 0; k < Val[0].size(); k++)
+	{
+		Mismatch += Val[0][k] != Val[1][k];
+	}
+	DF_Stats S;
+	DF_GetStats( &S );
+	int BadCells = DF_Check();
+	printf( "danger %d objects %d ticks %d lookups a tick, scan %.3f ms maps %.3f ms, %d stamps, %d mismatches, %d bad cells\n",
+		NOBJ, NTICKS, NLOOKUPS * 8, Time[0], Time[1], S.Stamps, Mismatch, BadCells );
+	DF_Free();
+	return Mismatch || BadCells;
+}
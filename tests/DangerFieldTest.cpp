@@ -0,0 +1,189 @@
+#include "cross_platform/platform_compat.h"
+#include "NewCode/DangerField.h"
+#include "Check.h"
+#include "TestSprite.h"
+#include <math.h>
+
+/*
+	DF_Get()/DF_GetMask() against the per cell scan the old DANGMAP of
+	GetDangValue() made: the sum of the damage of the objects whose reach
+	test holds for the cell centre, 128 if one of them is a ship. The
+	damage is capped at 127. Objects move, change their weapons and
+	nation and are removed between the checks, the heights are bumpy so
+	the arcs reach farther downhill.
+*/
+
+#define LX 64
+#define SHIFT 6
+#define NOBJ 160
+
+static int Euclid( int dx, int dy )
+{
+	return int( sqrt( double( dx ) * dx + double( dy ) * dy ) );
+}
+
+static int Bumps( int x, int y )
+{
+	return int( 40 * sin( x * 0.004 ) + 30 * cos( y * 0.006 ) ) + 32;
+}
+
+static DF_Reach Obj[NOBJ];
+static bool Alive[NOBJ];
+
+static void RandomReach( DF_Reach* R )
+{
+	memset( R, 0, sizeof *R );
+	R->x = Rand() % ( LX * DF_CELL );
+	R->y = Rand() % ( LX * DF_CELL );
+	R->z = Bumps( R->x, R->y ) + Rand() % 64;
+	R->Nat = Rand() % DF_NNAT;
+	R->Dam = 1 + Rand() % 6;
+	R->Water = !( Rand() % 4 );
+	R->Pad = 48;
+	int NW = 1 + Rand() % DF_NWEAP;
+	for (int i = 0; i < NW; i++)
+	{
+		R->Kind[i] = byte( Rand() % 4 );
+		R->R1[i] = Rand() % 400;
+		R->R2[i] = R->R1[i] + Rand() % 1800;
+	}
+}
+
+//The old scan of a cell for the nations of Mask
+static int Scan( int cx, int cy, int Mask )
+{
+	int x = ( cx << DF_CSHIFT ) + DF_CELL / 2;
+	int y = ( cy << DF_CSHIFT ) + DF_CELL / 2;
+	int z = Bumps( x, y );
+	int dam = 0;
+	int wat = 0;
+	for (int i = 0; i < NOBJ; i++)
+	{
+		if (Alive[i] && ( Mask & ( 1 << Obj[i].Nat ) ) && DF_Reaches( &Obj[i], x, y, z ))
+		{
+			dam += Obj[i].Dam;
+			if (Obj[i].Water)
+			{
+				wat = 128;
+			}
+		}
+	}
+	return ( dam > 127 ? 127 : dam ) | wat;
+}
+
+static int CountBad()
+{
+	int Bad = 0;
+	for (int cy = 0; cy < LX; cy++)
+	{
+		for (int cx = 0; cx < LX; cx++)
+		{
+			for (int n = 0; n < DF_NNAT; n++)
+			{
+				Bad += DF_Get( cx, cy, n ) != Scan( cx, cy, 1 << n );
+			}
+			int Mask = Rand() & 255;
+			Bad += DF_GetMask( cx, cy, Mask ) != Scan( cx, cy, Mask );
+		}
+	}
+	return Bad;
+}
+
+int main()
+{
+	Seed = 31;
+	DF_SetNorm( &Euclid );
+	DF_SetHeight( &Bumps );
+	DF_Init( LX, SHIFT );
+	for (int i = 0; i < NOBJ; i++)
+	{
+		RandomReach( Obj + i );
+		Alive[i] = true;
+		DF_Set( i, Obj + i );
+	}
+	CHECK( DF_Count() == NOBJ );
+	CHECK( !CountBad() );
+	CHECK( !DF_Check() );
+
+	for (int t = 0; t < 6; t++)
+	{
+		for (int i = 0; i < NOBJ; i++)
+		{
+			int What = Rand() % 8;
+			if (!Alive[i])
+			{
+				if (!What)
+				{
+					RandomReach( Obj + i );
+					Alive[i] = true;
+					DF_Set( i, Obj + i );
+				}
+				continue;
+			}
+			if (What == 0)
+			{
+				Alive[i] = false;
+				DF_Del( i );
+				continue;
+			}
+			if (What < 3)
+			{
+				Obj[i].x += int( Rand() % 129 ) - 64;
+				Obj[i].y += int( Rand() % 129 ) - 64;
+			}
+			else if (What == 3)
+			{
+				Obj[i].Nat = Rand() % DF_NNAT;
+			}
+			else if (What == 4)
+			{
+				Obj[i].R2[0] += 100;
+			}
+			//the rest stays, DF_Set keeps the stamp
+			DF_Set( i, Obj + i );
+		}
+		CHECK( !CountBad() );
+		CHECK( !DF_Check() );
+	}
+
+	//the kept reaches are not stamped again
+	DF_ClearStats();
+	for (int i = 0; i < NOBJ; i++)
+	{
+		if (Alive[i])
+		{
+			DF_Set( i, Obj + i );
+		}
+	}
+	DF_Stats S;
+	DF_GetStats( &S );
+	CHECK( S.Stamps == 0 && S.Kept == S.Objects );
+
+	//DF_Reset empties the maps, the next DF_Set stamps again
+	DF_Reset();
+	int Left = 0;
+	for (int c = 0; c < LX * LX; c++)
+	{
+		Left += DF_GetMask( c % LX, c / LX, 255 ) != 0;
+	}
+	CHECK( !Left );
+	for (int i = 0; i < NOBJ; i++)
+	{
+		if (Alive[i])
+		{
+			DF_Set( i, Obj + i );
+		}
+	}
+	CHECK( !CountBad() );
+	//outside of the map
+	CHECK( !DF_Get( -1, 0, 0 ) && !DF_Get( LX, 0, 0 ) && !DF_GetMask( 0, LX, 255 ) );
+
+	DF_Clear();
+	CHECK( !DF_Count() );
+	for (int n = 0; n < DF_NNAT; n++)
+	{
+		CHECK( !DF_Get( 5, 5, n ) );
+	}
+	DF_Free();
+	return TestResult( "DangerFieldTest" );
+}
@@ -0,0 +1,122 @@
+#include "cross_platform/platform_compat.h"
+#include "NewCode/FogDiffusion.h"
+#include "NewCode/JobPool.h"
+#include "Check.h"
+#include "TestSprite.h"
+
+/*
+	FD_Process() against the full sweep of the old ProcessFog1 loops:
+	every cell of 1..mlx-1 x 1..mly-1 from the 16 bit sum of its four
+	neighbours in the last map. Light spots come and go between the
+	steps and are marked with FD_MarkCell(), some of them bright enough
+	to wrap the sum. Between the spots the map gets quiet, and those
+	tiles must not be stepped. The map is compared after every step, in
+	the incremental mode and without it, on one thread and on the
+	workers.
+*/
+
+#define LX 160
+#define MLX 150
+#define MLY 131
+#define NSTEPS 120
+
+static word Map[LX * LX];
+static word Copy[LX * LX];
+static word Ref[LX * LX];
+static word RefCopy[LX * LX];
+
+static void FullSweep()
+{
+	memcpy( RefCopy, Ref, sizeof Ref );
+	for (int y = 1; y < MLY; y++)
+	{
+		for (int x = 1; x < MLX; x++)
+		{
+			const word* s = RefCopy + y * LX + x;
+			word Sum = word( s[-LX] + s[LX] + s[-1] + s[1] );
+			Ref[y * LX + x] = word( ( Sum >> 2 ) - ( Sum >> 10 ) );
+		}
+	}
+}
+
+//a spot of r cells, written to both maps
+static void Light( int x0, int y0, int r, word V )
+{
+	for (int y = y0 - r; y <= y0 + r; y++)
+	{
+		for (int x = x0 - r; x <= x0 + r; x++)
+		{
+			if (x >= 0 && y >= 0 && x < LX && y < LX)
+			{
+				Map[y * LX + x] = V;
+				Ref[y * LX + x] = V;
+				FD_MarkCell( x, y );
+			}
+		}
+	}
+}
+
+static void Run( bool Incremental )
+{
+	memset( Map, 0, sizeof Map );
+	memset( Ref, 0, sizeof Ref );
+	FD_SetIncremental( Incremental );
+	FD_Reset();
+	int Bad = 0;
+	int Quiet = 0;
+	//a lit unit stands in a corner and keeps its spot
+	int ux = 20;
+	int uy = 25;
+	for (int s = 0; s < NSTEPS; s++)
+	{
+		Light( ux, uy, 2, 0x1800 );
+		//spots elsewhere, now and then; some wrap the sum
+		if (s < 60 && !( s % 7 ))
+		{
+			word V = s % 21 ? 0x2000 : 0xC000;
+			Light( 40 + Rand() % ( MLX - 40 ), 40 + Rand() % ( MLY - 40 ), Rand() % 3, V );
+		}
+		//the edges of the map and the cells past mlx are written too
+		if (s == 30)
+		{
+			Light( 0, 70, 1, 0x3000 );
+			Light( MLX + 2, 40, 1, 0x3000 );
+		}
+		//the map is cleared now and then
+		if (s == 80)
+		{
+			memset( Map, 0, sizeof Map );
+			memset( Ref, 0, sizeof Ref );
+			FD_Reset();
+		}
+		FD_Process( Map, Copy, LX, MLX, MLY );
+		FullSweep();
+		Bad += memcmp( Map, Ref, sizeof Map ) != 0;
+		if (Incremental && s > 100 && FD_GetProcessedTiles() < FD_GetTotalTiles() / 4)
+		{
+			Quiet++;
+		}
+	}
+	CHECK( !Bad );
+	CHECK( !Incremental || Quiet > 10 );
+	CHECK( Incremental || FD_GetProcessedTiles() == FD_GetTotalTiles() );
+}
+
+int main()
+{
+	Seed = 17;
+	Run( true );
+	Run( false );
+	JOBS.Start( 4 );
+	Run( true );
+	JOBS.Stop();
+	//a step of another map size starts with a full step
+	static word Small[64 * 64];
+	static word SmallCopy[64 * 64];
+	FD_SetIncremental( true );
+	FD_Process( Small, SmallCopy, 64, 60, 60 );
+	CHECK( FD_GetProcessedTiles() == 16 && FD_GetTotalTiles() == 16 );
+	FD_Process( Small, SmallCopy, 64, 60, 60 );
+	CHECK( FD_GetProcessedTiles() == 0 );
+	return TestResult( "FogDiffusionTest" );
+}
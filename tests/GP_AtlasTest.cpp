@@ -0,0 +1,171 @@
+#include "cross_platform/platform_compat.h"
+#include "NewCode/GP_Blit.h"
+#include "NewCode/GP_Atlas.h"
+#include "Check.h"
+#include "TestSprite.h"
+
+/*
+	GPA_Build() of synthetic layers of different heights: the rectangles
+	lie in the page without overlapping, the page holds the pixels of the
+	spans, and GPB_Draw() of every frame gives the screen of its layer in
+	every mode, clip case and kernel set.
+*/
+
+#define NSPRITES 40
+#define SCR_LX 384
+#define SCR_LY 256
+
+alignas( 64 ) static byte ScrLayer[SCR_LX * SCR_LY];
+alignas( 64 ) static byte ScrFrame[SCR_LX * SCR_LY];
+alignas( 64 ) static byte Ground[2][SCR_LX * SCR_LY];
+alignas( 64 ) static byte Table[65536 + 64];
+
+//Lines without pixels that are not empty, they move the checkerboard
+static void MakeHollowSprite( TestSprite* S )
+{
+	S->Lx = 40;
+	S->NLines = 6;
+	byte Mask[] = { 1, 40, 0, 0, 128 | 2, 0x05, 0x03, 1, 3, 4, 0, 2, 10, 0, 5, 2 };
+	S->Mask.assign( Mask, Mask + sizeof Mask );
+	S->CData.assign( 6, 0x77 );
+}
+
+static void FillScreen( byte* Scr, int c )
+{
+	Seed = 99 + c;
+	for (int i = 0; i < SCR_LX * SCR_LY; i++)
+	{
+		unsigned int r = Rand();
+		Scr[i] = ( r & 1 ) ? byte( 0xB0 + ( r >> 1 ) % 14 ) : byte( r >> 4 );
+	}
+}
+
+int main()
+{
+	Seed = 4321;
+	for (int i = 0; i < int( sizeof Table ); i++)
+	{
+		Table[i] = byte( Rand() );
+	}
+	std::vector<TestSprite> Spr( NSPRITES );
+	std::vector<GP_BlitSprite> Layers( NSPRITES );
+	int NLayerBytes = 0;
+	for (int k = 0; k < NSPRITES; k++)
+	{
+		if (k == 7)
+		{
+			MakeHollowSprite( &Spr[k] );
+		}
+		else if (k == 11)
+		{
+			//a layer of empty lines only
+			Spr[k].Lx = 0;
+			Spr[k].NLines = 5;
+			Spr[k].Mask.assign( 5, 0 );
+		}
+		else
+		{
+			MakeSprite( &Spr[k], 4 + Rand() % 120 );
+		}
+		GP_BlitSprite& L = Layers[k];
+		L.x = 0;
+		L.y = 0;
+		L.Lx = Spr[k].Lx;
+		L.NLines = Spr[k].NLines;
+		L.Mask = Spr[k].Mask.data();
+		L.CData = Spr[k].CData.data();
+		L.Frame = nullptr;
+		NLayerBytes += int( Spr[k].CData.size() );
+	}
+
+	GPA_Atlas A;
+	GPA_Build( &A, Layers.data(), NSPRITES, 512 );
+	CHECK( A.NFrames == NSPRITES );
+	CHECK( A.PageLx >= 512 && !( A.PageLx & 15 ) );
+	CHECK( !GPA_Check( &A ) );
+	CHECK( A.NPixels == NLayerBytes );
+	CHECK( A.Frames[11].Lx == 0 );
+	printf( "page %dx%d, %d of %d bytes used, %d bytes in all\n", A.PageLx, A.PageLy,
+		A.NPixels, A.PageLx * A.PageLy, int( GPA_Bytes( &A ) ) );
+
+	//the spans point at the pixels of the layer
+	for (int k = 0; k < NSPRITES; k++)
+	{
+		const GPA_Frame& F = A.Frames[k];
+		const byte* Src = Spr[k].CData.data();
+		for (int ln = 0; ln < F.NLines; ln++)
+		{
+			const byte* Line = A.Page + size_t( F.PageY + ln ) * A.PageLx + F.PageX - F.Dx;
+			for (int s = A.Rows[F.Row + ln]; s < A.Rows[F.Row + ln + 1]; s++)
+			{
+				const GPA_Span& P = A.Spans[s];
+				CHECK( !P.n || ( P.x >= F.Dx && P.x + P.n <= F.Dx + F.Lx ) );
+				CHECK( !memcmp( Line + P.x, Src, P.n ) );
+				Src += P.n;
+			}
+		}
+		CHECK( Src == Spr[k].CData.data() + Spr[k].CData.size() );
+	}
+
+	//every frame draws as its layer
+	static const char* Sets[] = { "scalar", "sse2", "avx2" };
+	static const int Pos[][2] = { { 100, 60 }, { -20, 30 }, { 330, 200 }, { 150, -40 }, { 10, 230 } };
+	int WShift[128];
+	for (int i = 0; i < 128; i++)
+	{
+		WShift[i] = int( i % 3 ) - 1;
+	}
+	FillScreen( Ground[0], 0 );
+	FillScreen( Ground[1], 1 );
+	int Bad = 0;
+	int NDraws = 0;
+	for (const char* Name : Sets)
+	{
+		if (!GPB_SelectKernels( Name ))
+		{
+			continue;
+		}
+		for (int k = 0; k < NSPRITES; k++)
+		{
+			for (int c = 0; c < GPB_NMODES * 2 * 5; c++)
+			{
+				int Mode = c / 10;
+				bool Inv = ( c / 5 ) & 1;
+				GP_BlitTarget T;
+				T.Pitch = SCR_LX;
+				T.WindX = 16;
+				T.WindY = 8;
+				T.WindX1 = SCR_LX - 17;
+				T.WindY1 = SCR_LY - 9;
+				T.BandY = c % 2 ? T.WindY : 50;
+				T.BandY1 = c % 2 ? T.WindY1 : 150;
+				GP_BlitSprite S = Layers[k];
+				S.x = Pos[c % 5][0] + ( Inv ? S.Lx : 0 );
+				S.y = Pos[c % 5][1];
+				const int* WS = Mode == GPB_MIRROR ? WShift : nullptr;
+				memcpy( ScrLayer, Ground[c % 2], sizeof ScrLayer );
+				memcpy( ScrFrame, Ground[c % 2], sizeof ScrFrame );
+				T.Screen = ScrLayer;
+				GPB_Draw( &T, Mode, Inv, &S, Table, WS );
+				S.Mask = nullptr;
+				S.CData = nullptr;
+				S.Frame = A.Frames + k;
+				T.Screen = ScrFrame;
+				GPB_Draw( &T, Mode, Inv, &S, Table, WS );
+				if (memcmp( ScrLayer, ScrFrame, sizeof ScrLayer ))
+				{
+					printf( "%s: frame %d mode %d %s at %d,%d differs\n", Name, k, Mode,
+						Inv ? "mirrored" : "forward", Pos[c % 5][0], Pos[c % 5][1] );
+					Bad++;
+				}
+				NDraws++;
+			}
+		}
+	}
+	CHECK( !Bad );
+	CHECK( NDraws >= NSPRITES * GPB_NMODES * 10 );
+
+	GPA_Free( &A );
+	CHECK( !A.Page && !A.Frames );
+	return TestResult( "GP_AtlasTest" );
+}
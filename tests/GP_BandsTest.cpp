@@ -0,0 +1,134 @@
+#include "cross_platform/platform_compat.h"
+#include "NewCode/GP_Blit.h"
+#include "NewCode/GP_Bands.h"
+#include "NewCode/JobPool.h"
+#include "Check.h"
+#include "TestSprite.h"
+
+/*
+	GPB_FlushBands() against the serial drawing: a few hundred
+	overlapping sprites of all blend modes but the water reflection,
+	each with its own clip window and band, recorded and flushed with
+	different band counts. Every flush has to give the screen of the
+	plain GPB_Draw() calls in the same order.
+*/
+
+#define SCR_LX 640
+#define SCR_LY 480
+#define NSPRITES 16
+#define NDRAWS 400
+
+alignas( 64 ) static byte Ground[SCR_LX * SCR_LY];
+alignas( 64 ) static byte Serial[SCR_LX * SCR_LY];
+alignas( 64 ) static byte Banded[SCR_LX * SCR_LY];
+alignas( 64 ) static byte Table[65536 + 64];
+
+struct TestDraw
+{
+	GP_BlitTarget T;
+	GP_BlitSprite S;
+	int Mode;
+	bool Inv;
+};
+
+//Draws the first N commands, recorded when Bands is set
+static void DrawAll( byte* Scr, const std::vector<TestDraw>& Draws, int N, bool Bands )
+{
+	memcpy( Scr, Ground, sizeof Ground );
+	if (Bands)
+	{
+		GPB_BeginBands();
+	}
+	for (int i = 0; i < N; i++)
+	{
+		GP_BlitTarget T = Draws[i].T;
+		T.Screen = Scr;
+		if (Bands)
+		{
+			GPB_Record( &T, Draws[i].Mode, Draws[i].Inv, &Draws[i].S, Table );
+		}
+		else
+		{
+			GPB_Draw( &T, Draws[i].Mode, Draws[i].Inv, &Draws[i].S, Table, nullptr );
+		}
+	}
+	if (Bands)
+	{
+		CHECK( GPB_Recording() );
+		GPB_EndBands();
+		CHECK( !GPB_Recording() );
+	}
+}
+
+int main()
+{
+	Seed = 5150;
+	for (int i = 0; i < int( sizeof Table ); i++)
+	{
+		Table[i] = byte( Rand() );
+	}
+	for (int i = 0; i < SCR_LX * SCR_LY; i++)
+	{
+		Ground[i] = byte( Rand() );
+	}
+	std::vector<TestSprite> Spr( NSPRITES );
+	for (int k = 0; k < NSPRITES; k++)
+	{
+		MakeSprite( &Spr[k], 8 + Rand() % 120 );
+	}
+
+	std::vector<TestDraw> Draws( NDRAWS );
+	for (TestDraw& D : Draws)
+	{
+		const TestSprite& P = Spr[Rand() % NSPRITES];
+		D.Mode = Rand() % GPB_MIRROR;
+		D.Inv = Rand() & 1;
+		D.T.Screen = nullptr;
+		D.T.Pitch = SCR_LX;
+		D.T.WindX = Rand() % 64;
+		D.T.WindY = Rand() % 64;
+		D.T.WindX1 = SCR_LX - 1 - Rand() % 64;
+		D.T.WindY1 = SCR_LY - 1 - Rand() % 64;
+		//a quarter of the draws is limited to a band of its own
+		bool Band = !( Rand() & 3 );
+		D.T.BandY = Band ? D.T.WindY + Rand() % 100 : D.T.WindY;
+		D.T.BandY1 = Band ? D.T.BandY + Rand() % 200 : D.T.WindY1;
+		D.S.x = int( Rand() % ( SCR_LX + 100 ) ) - 100 + ( D.Inv ? P.Lx : 0 );
+		D.S.y = int( Rand() % ( SCR_LY + 100 ) ) - 100;
+		D.S.Lx = P.Lx;
+		D.S.NLines = P.NLines;
+		D.S.Mask = P.Mask.data();
+		D.S.CData = P.CData.data();
+		D.S.Frame = nullptr;
+	}
+
+	JOBS.Start( 4 );
+	static const int NBands[] = { 0, 1, 2, 3, 7, 64, 1000 };
+	//the short lists are drawn without the workers
+	static const int NDrawn[] = { 1, 3, 4, 50, NDRAWS };
+	for (int n : NDrawn)
+	{
+		DrawAll( Serial, Draws, n, false );
+		CHECK( memcmp( Serial, Ground, sizeof Ground ) );
+		for (int b : NBands)
+		{
+			GPB_NBands = b;
+			DrawAll( Banded, Draws, n, true );
+			if (memcmp( Serial, Banded, sizeof Serial ))
+			{
+				printf( "%d draws in %d bands differ\n", n, b );
+				CHECK( false );
+			}
+		}
+	}
+
+	//a flush of nothing leaves the screen alone
+	memcpy( Banded, Ground, sizeof Ground );
+	GPB_BeginBands();
+	GPB_FlushBands();
+	GPB_EndBands();
+	CHECK( !memcmp( Banded, Ground, sizeof Ground ) );
+	GPB_NBands = 0;
+	JOBS.Stop();
+	return TestResult( "GP_BandsTest" );
+}
@@ -0,0 +1,159 @@
+#include "cross_platform/platform_compat.h"
+#include "NewCode/GP_Blit.h"
+#include "Check.h"
+#include "TestSprite.h"
+
+/*
+	GPB_Draw() of every kernel set against stored screens.
+
+	Every case draws a synthetic masked sprite with simple and packed
+	line headers, empty lines and segments longer than a vector, in one
+	blend mode, forward or mirrored, against one clip window and band.
+	The screen after the draw is hashed and compared with the stored
+	hash, so all kernel sets have to give the very same pixels. The
+	stored hashes are the screens of the old 32-bit __asm blitters
+	(GP_ShowMasked*Pict* before the portable kernels) for the same
+	cases, with the pixels they wrote outside of the clip window put
+	back: the old blitters clipped a sprite over both edges at one of
+	them only. A band case is the old draw of the whole window with the
+	rows outside of the band put back.
+*/
+
+#define SCR_LX 512
+#define SCR_LY 320
+struct TestClip
+{
+	const char* Name;
+	int x, y;		//sprite position relative to the window corner
+	int WX, WY, WX1, WY1;
+	int BandY, BandY1;	//relative to WY, -1: the whole window
+};
+
+static const TestClip Clips[] =
+{
+	{ "inside", 60, 40, 40, 30, 471, 289, -1, -1 },
+	{ "left", -50, 40, 40, 30, 471, 289, -1, -1 },
+	{ "right", 380, 40, 40, 30, 471, 289, -1, -1 },
+	{ "top", 60, -40, 40, 30, 471, 289, -1, -1 },
+	{ "bottom", 60, 220, 40, 30, 471, 289, -1, -1 },
+	{ "all", -30, -20, 200, 100, 260, 150, -1, -1 },
+	{ "band", 60, 40, 40, 30, 471, 289, 70, 101 },
+	{ "band-top", 60, -40, 40, 30, 471, 289, 10, 33 },
+	{ "outside", 460, 40, 40, 30, 471, 289, -1, -1 }
+};
+
+#define NCLIPS int( sizeof Clips / sizeof Clips[0] )
+#define NCASES ( GPB_NMODES * 2 * NCLIPS )
+
+alignas( 64 ) static byte Screen[SCR_LX * SCR_LY];
+alignas( 64 ) static byte Table[65536 + 64];
+
+static unsigned long long Hash( const byte* p, int n )
+{
+	unsigned long long h = 14695981039346656037ULL;
+	for (int i = 0; i < n; i++)
+	{
+		h = ( h ^ p[i] ) * 1099511628211ULL;
+	}
+	return h;
+}
+
+//Screen of case c before the draw, every second pixel is water
+static void FillScreen( int c )
+{
+	Seed = 777 + c;
+	for (int i = 0; i < SCR_LX * SCR_LY; i++)
+	{
+		unsigned int r = Rand();
+		Screen[i] = ( r & 1 ) ? byte( 0xB0 + ( r >> 1 ) % 14 ) : byte( r >> 4 );
+	}
+}
+
+//Draws case c with the current kernels and hashes the screen
+static unsigned long long DrawCase( const TestSprite& Spr, int c )
+{
+	int Mode = c / ( 2 * NCLIPS );
+	bool Inv = ( c / NCLIPS ) & 1;
+	const TestClip& C = Clips[c % NCLIPS];
+	FillScreen( c );
+	int WShift[TS_NLINES];
+	int Sum = 0;
+	for (int i = 0; i < TS_NLINES; i++)
+	{
+		int d = int( Rand() % 3 ) - 1;
+		if (Sum + d < -3 || Sum + d > 3)
+		{
+			d = -d;
+		}
+		WShift[i] = d;
+		Sum += d;
+	}
+	GP_BlitTarget T;
+	T.Screen = Screen;
+	T.Pitch = SCR_LX;
+	T.WindX = C.WX;
+	T.WindY = C.WY;
+	T.WindX1 = C.WX1;
+	T.WindY1 = C.WY1;
+	T.BandY = C.BandY < 0 ? C.WY : C.WY + C.BandY;
+	T.BandY1 = C.BandY1 < 0 ? C.WY1 : C.WY + C.BandY1;
+	GP_BlitSprite S;
+	S.x = C.WX + C.x + ( Inv ? Spr.Lx : 0 );
+	S.y = C.WY + C.y;
+	S.Lx = Spr.Lx;
+	S.NLines = TS_NLINES;
+	S.Mask = Spr.Mask.data();
+	S.CData = Spr.CData.data();
+	S.Frame = nullptr;
+	GPB_Draw( &T, Mode, Inv, &S, Table, Mode == GPB_MIRROR ? WShift : nullptr );
+	return Hash( Screen, SCR_LX * SCR_LY );
+}
+
+//Made by the old __asm blitters, see above
+static const unsigned long long Golden[NCASES] =
+{
+#include "GP_BlitGolden.inc"
+};
+
+int main()
+{
+	Seed = 12345;
+	for (int i = 0; i < int( sizeof Table ); i++)
+	{
+		Table[i] = byte( Rand() );
+	}
+	TestSprite Spr;
+	MakeSprite( &Spr );
+	CHECK( Spr.Lx > 64 );
+
+	static const char* Sets[] = { "scalar", "sse2", "avx2" };
+	for (const char* Name : Sets)
+	{
+		if (!GPB_SelectKernels( Name ))
+		{
+			printf( "%s kernels not supported here, skipped\n", Name );
+			continue;
+		}
+		int Bad = 0;
+		for (int c = 0; c < NCASES; c++)
+		{
+			if (DrawCase( Spr, c ) != Golden[c])
+			{
+				printf( "%s: mode %d %s %s differs\n", Name, c / ( 2 * NCLIPS ),
+					( c / NCLIPS ) & 1 ? "mirrored" : "forward", Clips[c % NCLIPS].Name );
+				Bad++;
+			}
+		}
+		CHECK( !Bad );
+	}
+	//only a sprite outside of the window leaves the screen alone
+	GPB_SelectKernels( "scalar" );
+	for (int c = 0; c < NCASES; c++)
+	{
+		unsigned long long h = DrawCase( Spr, c );
+		FillScreen( c );
+		bool Outside = c % NCLIPS == NCLIPS - 1;
+		CHECK( ( h == Hash( Screen, SCR_LX * SCR_LY ) ) == Outside );
+	}
+	return TestResult( "GP_BlitTest" );
+}
@@ -0,0 +1,165 @@
+#include "cross_platform/platform_compat.h"
+#include "graphics/indexed_framebuffer.h"
+#include "Check.h"
+#include "TestSprite.h"
+#include <string.h>
+
+/*
+	IndexedFramebuffer::Update(): only changed or marked rows are
+	converted, close rows are merged into one span, a palette change
+	converts the whole frame, and the RGBA copy always matches the pixels
+	through the palette. The width is not a multiple of the vector rows,
+	so the tails of the row compare and convert are hit too.
+*/
+
+#define FB_LX 200
+#define FB_LY 120
+
+static uint8_t Pal[256 * 4];
+
+static uint32_t Color( int c )
+{
+	return uint32_t( Pal[c * 4] ) | ( uint32_t( Pal[c * 4 + 1] ) << 8 ) | ( uint32_t( Pal[c * 4 + 2] ) << 16 ) | 0xFF000000u;
+}
+
+//RGBA of every pixel is its palette colour
+static bool SameColors( IndexedFramebuffer& F )
+{
+	const uint8_t* p = F.GetPixels();
+	const uint32_t* c = F.GetRGBA();
+	for (int i = 0; i < FB_LX * FB_LY; i++)
+	{
+		if (c[i] != Color( p[i] ))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+static bool Spans( IndexedFramebuffer& F, int N, const int* Rows )
+{
+	if (F.Update() != N || F.GetSpanCount() != N)
+	{
+		return false;
+	}
+	for (int i = 0; i < N; i++)
+	{
+		if (F.GetSpan( i ).y0 != Rows[i * 2] || F.GetSpan( i ).y1 != Rows[i * 2 + 1])
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+int main()
+{
+	//row helpers against the plain loops
+	Seed = 606;
+	uint32_t Lut[256];
+	for (int i = 0; i < 256; i++)
+	{
+		Lut[i] = ( Rand() << 16 ) ^ Rand();
+	}
+	uint8_t A[300];
+	uint8_t B[300];
+	uint32_t Dst[301];
+	for (int i = 0; i < 300; i++)
+	{
+		A[i] = B[i] = uint8_t( Rand() );
+	}
+	for (int n = 0; n <= 300; n += n < 40 ? 1 : 37)
+	{
+		Dst[n] = 0xDEADBEEF;
+		ConvertIndexedRow( A, Dst, n, Lut );
+		bool Same = Dst[n] == 0xDEADBEEF;
+		for (int i = 0; i < n; i++)
+		{
+			Same = Same && Dst[i] == Lut[A[i]];
+		}
+		CHECK( Same );
+		CHECK( IndexedRowsEqual( A, B, n ) );
+		for (int i = 0; i < n; i += 1 + i / 8)
+		{
+			B[i] ^= 0x40;
+			CHECK( !IndexedRowsEqual( A, B, n ) );
+			B[i] ^= 0x40;
+		}
+	}
+
+	IndexedFramebuffer F;
+	F.Resize( FB_LX, FB_LY );
+	CHECK( F.GetWidth() == FB_LX && F.GetHeight() == FB_LY );
+	for (int i = 0; i < 256; i++)
+	{
+		Pal[i * 4] = Pal[i * 4 + 1] = Pal[i * 4 + 2] = uint8_t( i );
+		Pal[i * 4 + 3] = 0;
+	}
+	uint8_t* Pix = F.GetPixels();
+	for (int i = 0; i < FB_LX * FB_LY; i++)
+	{
+		Pix[i] = uint8_t( Rand() );
+	}
+
+	//a new surface is converted at once
+	const int All[] = { 0, FB_LY };
+	CHECK( Spans( F, 1, All ) );
+	CHECK( F.GetStats().last_rows_converted == FB_LY );
+	CHECK( SameColors( F ) );
+	//nothing changed
+	CHECK( Spans( F, 0, nullptr ) );
+	CHECK( F.GetStats().last_rows_converted == 0 );
+
+	//rows with 8 clean rows between them are one span, with 9 or more
+	//they are not; the changed pixel
+	//is at the start, in the middle and in the tail of the row
+	Pix[10 * FB_LX] ^= 1;
+	Pix[19 * FB_LX + 100] ^= 1;
+	Pix[29 * FB_LX + FB_LX - 1] ^= 1;
+	Pix[( FB_LY - 1 ) * FB_LX + FB_LX - 3] ^= 1;
+	const int Changed[] = { 10, 20, 29, 30, FB_LY - 1, FB_LY };
+	CHECK( Spans( F, 3, Changed ) );
+	CHECK( F.GetStats().last_rows_converted == 4 );
+	CHECK( SameColors( F ) );
+
+	//marked rows are converted without a change, the marks are clipped
+	F.MarkDirty( 30, 33 );
+	F.MarkDirty( -5, 2 );
+	F.MarkDirty( FB_LY - 1, FB_LY + 10 );
+	const int Marked[] = { 0, 2, 30, 33, FB_LY - 1, FB_LY };
+	CHECK( Spans( F, 3, Marked ) );
+	CHECK( F.GetStats().last_rows_converted == 6 );
+	CHECK( Spans( F, 0, nullptr ) );
+
+	//the flags byte alone is not a change of the palette
+	for (int i = 0; i < 256; i++)
+	{
+		Pal[i * 4 + 3] = 4;
+	}
+	CHECK( !F.SetPalette( Pal ) );
+	CHECK( Spans( F, 0, nullptr ) );
+	//one colour converts the whole frame with the new colours
+	Pal[Pix[0] * 4 + 1] ^= 0x80;
+	CHECK( F.SetPalette( Pal ) );
+	CHECK( Spans( F, 1, All ) );
+	CHECK( SameColors( F ) );
+	Pix[50 * FB_LX + 7] = 0;
+	F.MarkAllDirty();
+	CHECK( Spans( F, 1, All ) );
+	CHECK( SameColors( F ) );
+
+	//the same size keeps the pixels, a new size starts over
+	uint8_t Keep = Pix[1234];
+	F.Resize( FB_LX, FB_LY );
+	CHECK( F.GetPixels()[1234] == Keep );
+	CHECK( Spans( F, 0, nullptr ) );
+	F.Resize( FB_LX / 2, FB_LY / 2 );
+	const int Half[] = { 0, FB_LY / 2 };
+	CHECK( Spans( F, 1, Half ) );
+
+	const FramebufferStats& S = F.GetStats();
+	CHECK( S.frames == 10 );
+	CHECK( S.rows_uploaded >= S.rows_converted );
+	return TestResult( "IndexedFramebufferTest" );
+}
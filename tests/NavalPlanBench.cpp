@@ -0,0 +1,352 @@
+#include "cross_platform/platform_compat.h"
+#include "NewCode/NavalPlan.h"
+#include "TestSprite.h"
+#include <math.h>
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+/*
+	AI desants over archipelagos of growing size: a grid of water areas
+	with round islands cut out of it and a coast place on the side of
+	every area next to an island. NNATIONS nations with NSHIPS ships
+	each look for a place to load on their island and one to land on an
+	enemy island, by the scan over all places of the old FindCostPoint()
+	and by NP_FindCoast(). The ships that found a place to load take
+	NGROUPS land groups of every nation, by the scan over all ships and
+	by NP_Assign(), and the ships with a place to land get the route
+	there. Prints the times of every map size and the answers that
+	differ, it is not a test.
+*/
+
+#define NNATIONS 7
+#define NSHIPS 16
+#define NGROUPS 64
+#define MAXL 8
+
+static int NAreas;
+static std::vector<int> AX;
+static std::vector<int> AY;
+static std::vector<int> NL;
+static std::vector<word> Link;
+
+static int NPlaces;
+static std::vector<int> PX;
+static std::vector<int> PY;
+static std::vector<int> PArea;
+static std::vector<int> PIsland;
+
+//as the game Norma()
+static int Octagon( int dx, int dy )
+{
+	dx = abs( dx );
+	dy = abs( dy );
+	return dx > dy ? dx + ( dy * 3 >> 3 ) : dy + ( dx * 3 >> 3 );
+}
+
+static int AreaInfo( int i, int* x, int* y, const word** L )
+{
+	*x = AX[i];
+	*y = AY[i];
+	*L = &Link[i * MAXL * 2];
+	return NL[i];
+}
+
+static void AddLink( int a, int b )
+{
+	int dx = AX[a] - AX[b];
+	int dy = AY[a] - AY[b];
+	word Len = word( sqrt( double( dx * dx + dy * dy ) ) );
+	word* La = &Link[( a * MAXL + NL[a] ) * 2];
+	La[0] = word( b );
+	La[1] = Len;
+	NL[a]++;
+	word* Lb = &Link[( b * MAXL + NL[b] ) * 2];
+	Lb[0] = word( a );
+	Lb[1] = Len;
+	NL[b]++;
+}
+
+static int PlaceInfo( int i, int* x, int* y, int* Key )
+{
+	*x = PX[i];
+	*y = PY[i];
+	*Key = PIsland[i];
+	return PArea[i];
+}
+
+static bool PlaceOfIsland( int i, void* Param )
+{
+	return PIsland[i] == *(int*) Param;
+}
+
+static bool PlaceOfEnemy( int i, void* Param )
+{
+	return PIsland[i] != *(int*) Param;
+}
+
+//FindCostPoint: over 20 and under 100000, the first of the nearest
+static int ScanPlace( int x, int y, int Sea, NP_Accept Accept, void* Param )
+{
+	int MinR = 100000;
+	int Best = -1;
+	for (int i = 0; i < NPlaces; i++)
+	{
+		int R = Octagon( x - PX[i], y - PY[i] );
+		if (R > 20 && R < MinR && ( Sea < 0 || NP_GetSea( PArea[i] ) == Sea ) && Accept( i, Param ))
+		{
+			MinR = R;
+			Best = i;
+		}
+	}
+	return Best;
+}
+
+//The groups by priority, each with the nearest free ship of its key
+static void ScanAssign( const NP_Ship* S, int NS, const NP_Group* G, int NG, int* Ship )
+{
+	std::vector<int> Order( NG );
+	std::vector<byte> Taken( NS, 0 );
+	for (int g = 0; g < NG; g++)
+	{
+		Order[g] = g;
+		Ship[g] = -1;
+	}
+	std::stable_sort( Order.begin(), Order.end(), [G]( int a, int b ) { return G[a].Prio < G[b].Prio; } );
+	for (int k = 0; k < NG; k++)
+	{
+		const NP_Group& Gr = G[Order[k]];
+		int MinR = 0x7FFFFFFF;
+		int Best = -1;
+		for (int s = 0; s < NS; s++)
+		{
+			if (Taken[s] || ( Gr.Key >= 0 && S[s].Key >= 0 && S[s].Key != Gr.Key ))
+			{
+				continue;
+			}
+			int R = Octagon( Gr.x - S[s].x, Gr.y - S[s].y );
+			if (R < MinR)
+			{
+				MinR = R;
+				Best = s;
+			}
+		}
+		if (Best >= 0)
+		{
+			Taken[Best] = 1;
+			Ship[Order[k]] = Best;
+		}
+	}
+}
+
+//A G x G grid of areas with islands, the links between the water areas
+//and the coast places; Land[i] is the island of area i or -1
+static void MakeArchipelago( int G, std::vector<int>& Land )
+{
+	int N = G * G;
+	NAreas = N;
+	AX.assign( N, 0 );
+	AY.assign( N, 0 );
+	NL.assign( N, 0 );
+	Link.assign( N * MAXL * 2, 0 );
+	Land.assign( N, -1 );
+	for (int i = 0; i < N; i++)
+	{
+		AX[i] = ( i % G ) * 8;
+		AY[i] = ( i / G ) * 8;
+	}
+	int NIsl = G * G / 128;
+	for (int k = 0; k < NIsl; k++)
+	{
+		int cx = Rand() % G;
+		int cy = Rand() % G;
+		int r = 1 + Rand() % 4;
+		for (int y = cy - r; y <= cy + r; y++)
+		{
+			for (int x = cx - r; x <= cx + r; x++)
+			{
+				if (x >= 0 && y >= 0 && x < G && y < G && ( x - cx ) * ( x - cx ) + ( y - cy ) * ( y - cy ) <= r * r && Land[x + y * G] < 0)
+				{
+					Land[x + y * G] = k;
+				}
+			}
+		}
+	}
+	PX.clear();
+	PY.clear();
+	PArea.clear();
+	PIsland.clear();
+	for (int i = 0; i < N; i++)
+	{
+		if (Land[i] >= 0)
+		{
+			continue;
+		}
+		int x = i % G;
+		int y = i / G;
+		static const int Dir[4][2] = { { 1, 0 }, { 0, 1 }, { 1, 1 }, { -1, 1 } };
+		for (int d = 0; d < 4; d++)
+		{
+			int x1 = x + Dir[d][0];
+			int y1 = y + Dir[d][1];
+			if (x1 >= 0 && x1 < G && y1 < G && Land[x1 + y1 * G] < 0)
+			{
+				AddLink( i, x1 + y1 * G );
+			}
+		}
+		//a place on the side of the first island next to the area
+		static const int Side[4][2] = { { 1, 0 }, { 0, 1 }, { -1, 0 }, { 0, -1 } };
+		for (int d = 0; d < 4; d++)
+		{
+			int x1 = x + Side[d][0];
+			int y1 = y + Side[d][1];
+			if (x1 >= 0 && y1 >= 0 && x1 < G && y1 < G && Land[x1 + y1 * G] >= 0)
+			{
+				PX.push_back( AX[i] + Side[d][0] * 4 );
+				PY.push_back( AY[i] + Side[d][1] * 4 );
+				PArea.push_back( i );
+				PIsland.push_back( Land[x1 + y1 * G] );
+				break;
+			}
+		}
+	}
+	NPlaces = int( PX.size() );
+}
+
+static double Ms( std::chrono::steady_clock::time_point t0 )
+{
+	return std::chrono::duration<double, std::milli>( std::chrono::steady_clock::now() - t0 ).count();
+}
+
+int main()
+{
+	Seed = 1357;
+	NP_SetNorm( &Octagon );
+	static const int Sizes[] = { 48, 96, 160 };
+	int Bad = 0;
+	for (int s = 0; s < int( sizeof Sizes / sizeof Sizes[0] ); s++)
+	{
+		std::vector<int> Land;
+		MakeArchipelago( Sizes[s], Land );
+		int N = NAreas;
+		AG_Build( NP_LAYER, N, &AreaInfo );
+		NP_SetSeas( N, &AreaInfo );
+		NP_SetCoast( NPlaces, &PlaceInfo );
+		//ships at sea, a home island for every nation
+		int NS = NNATIONS * NSHIPS;
+		std::vector<int> ShipArea( NS );
+		std::vector<int> Home( NNATIONS );
+		for (int n = 0; n < NNATIONS; n++)
+		{
+			Home[n] = NPlaces ? PIsland[( n * NPlaces ) / NNATIONS] : -1;
+		}
+		for (int i = 0; i < NS; i++)
+		{
+			do
+			{
+				ShipArea[i] = Rand() % N;
+			} while (Land[ShipArea[i]] >= 0);
+		}
+		std::vector<int> Load[2];
+		std::vector<int> Dest[2];
+		double Time[2];
+		for (int m = 0; m < 2; m++)
+		{
+			Load[m].resize( NS );
+			Dest[m].resize( NS );
+			auto t0 = std::chrono::steady_clock::now();
+			for (int i = 0; i < NS; i++)
+			{
+				int x = AX[ShipArea[i]];
+				int y = AY[ShipArea[i]];
+				int Sea = NP_GetSea( ShipArea[i] );
+				int Isl = Home[i / NSHIPS];
+				if (m)
+				{
+					Load[m][i] = NP_FindCoast( x, y, 20, Sea, Isl, &PlaceOfIsland, &Isl );
+					Dest[m][i] = NP_FindCoast( x, y, 20, Sea, -1, &PlaceOfEnemy, &Isl );
+				}
+				else
+				{
+					Load[m][i] = ScanPlace( x, y, Sea, &PlaceOfIsland, &Isl );
+					Dest[m][i] = ScanPlace( x, y, Sea, &PlaceOfEnemy, &Isl );
+				}
+			}
+			Time[m] = Ms( t0 );
+		}
+		int Mismatch = 0;
+		for (int i = 0; i < NS; i++)
+		{
+			Mismatch += ( Load[0][i] != Load[1][i] ) + ( Dest[0][i] != Dest[1][i] );
+		}
+		printf( "naval %d nations %d areas %d places, %d ships scan %.3f ms grid %.3f ms, %d mismatches", NNATIONS,
+			N, NPlaces, NS, Time[0], Time[1], Mismatch );
+		Bad += Mismatch;
+		//the ships stand at their places to load, the groups wait around them
+		std::vector<NP_Ship> Ships;
+		for (int i = 0; i < NS; i++)
+		{
+			if (Load[1][i] >= 0)
+			{
+				NP_Ship Sh = { PX[Load[1][i]], PY[Load[1][i]], Home[i / NSHIPS] };
+				Ships.push_back( Sh );
+			}
+		}
+		if (!Ships.empty())
+		{
+			std::vector<NP_Group> Groups;
+			for (int n = 0; n < NNATIONS; n++)
+			{
+				for (int k = 0; k < NGROUPS; k++)
+				{
+					const NP_Ship& Near = Ships[Rand() % Ships.size()];
+					NP_Group Gr = { Near.x + int( Rand() % 81 ) - 40, Near.y + int( Rand() % 81 ) - 40, Home[n], int( Rand() % 7 ) };
+					Groups.push_back( Gr );
+				}
+			}
+			int NG = int( Groups.size() );
+			std::vector<int> Ship[2];
+			for (int m = 0; m < 2; m++)
+			{
+				Ship[m].resize( NG );
+				auto t0 = std::chrono::steady_clock::now();
+				if (m)
+				{
+					NP_Assign( Ships.data(), int( Ships.size() ), Groups.data(), NG, NG, Ship[m].data() );
+				}
+				else
+				{
+					ScanAssign( Ships.data(), int( Ships.size() ), Groups.data(), NG, Ship[m].data() );
+				}
+				Time[m] = Ms( t0 );
+			}
+			int AMismatch = 0;
+			for (int g = 0; g < NG; g++)
+			{
+				AMismatch += Ship[0][g] != Ship[1][g];
+			}
+			printf( ", %d groups scan %.3f ms grid %.3f ms, %d mismatches", NG, Time[0], Time[1], AMismatch );
+			Bad += AMismatch;
+		}
+		static word Route[4096];
+		int NRoutes = 0;
+		int RouteAreas = 0;
+		auto t0 = std::chrono::steady_clock::now();
+		for (int i = 0; i < NS; i++)
+		{
+			if (Dest[1][i] >= 0)
+			{
+				int n = NP_Route( ShipArea[i], PArea[Dest[1][i]], Route, 4096 );
+				if (n >= 0)
+				{
+					NRoutes++;
+					RouteAreas += n;
+				}
+			}
+		}
+		printf( ", %d routes %.3f ms %d areas\n", NRoutes, Ms( t0 ), RouteAreas );
+		NP_SetCoast( 0, nullptr );
+		AG_Free( NP_LAYER );
+	}
+	return Bad != 0;
+}
@@ -0,0 +1,287 @@
+#include "cross_platform/platform_compat.h"
+#include "NewCode/NavalPlan.h"
+#include "Check.h"
+#include "TestSprite.h"
+#include <algorithm>
+#include <vector>
+
+/*
+	NP_FindCoast() against the scan over all places of the old
+	FindCostPoint()/FindCostPointEx(), with and without a key and a sea,
+	and NP_Assign() against the scan over all ships. With one ship
+	without a key NP_Assign() gives the brigade the old loading loop of
+	MakeDiversionLink() took: the first one of the first type of its
+	type order. Places and ships stand in clusters, so many are as far.
+*/
+
+#define NPLACES 1500
+#define NAREAS 40
+#define NKEYS 12
+
+static int PX[NPLACES];
+static int PY[NPLACES];
+static int PKey[NPLACES];
+static int PArea[NPLACES];
+static bool Free[NPLACES];
+
+static int Octagon( int dx, int dy )
+{
+	dx = abs( dx );
+	dy = abs( dy );
+	return dx > dy ? dx + ( dy * 3 >> 3 ) : dy + ( dx * 3 >> 3 );
+}
+
+//areas 2k and 2k+1 are joined, so seas are pairs of areas
+static int AreaInfo( int i, int* x, int* y, const word** L )
+{
+	static word Link[2];
+	*x = i;
+	*y = 0;
+	Link[0] = word( i ^ 1 );
+	Link[1] = 1;
+	*L = Link;
+	return 1;
+}
+
+static int PlaceInfo( int i, int* x, int* y, int* Key )
+{
+	*x = PX[i];
+	*y = PY[i];
+	*Key = PKey[i];
+	return PArea[i];
+}
+
+static bool FreePlace( int i, void* Param )
+{
+	return Free[i];
+}
+
+static bool FreeOfKeys( int i, void* Param )
+{
+	return Free[i] && ( *(int*) Param & ( 1 << PKey[i] ) );
+}
+
+//FindCostPoint: over 20 and under 100000, the first of the nearest
+static int ScanPlace( int x, int y, int Sea, int Key, NP_Accept Accept, void* Param )
+{
+	int MinR = 100000;
+	int Best = -1;
+	for (int i = 0; i < NPLACES; i++)
+	{
+		int R = Octagon( x - PX[i], y - PY[i] );
+		if (R > 20 && R < MinR && ( Sea < 0 || NP_GetSea( PArea[i] ) == Sea ) && ( Key < 0 || PKey[i] == Key ) && Accept( i, Param ))
+		{
+			MinR = R;
+			Best = i;
+		}
+	}
+	return Best;
+}
+
+//The groups by priority, each with the nearest free ship of its key
+static void ScanAssign( const NP_Ship* S, int NS, const NP_Group* G, int NG, int MaxN, int* Ship )
+{
+	std::vector<int> Order( NG );
+	std::vector<byte> Taken( NS, 0 );
+	for (int g = 0; g < NG; g++)
+	{
+		Order[g] = g;
+		Ship[g] = -1;
+	}
+	std::stable_sort( Order.begin(), Order.end(), [G]( int a, int b ) { return G[a].Prio < G[b].Prio; } );
+	int NM = 0;
+	for (int k = 0; k < NG && NM < MaxN; k++)
+	{
+		const NP_Group& Gr = G[Order[k]];
+		int MinR = 0x7FFFFFFF;
+		int Best = -1;
+		for (int s = 0; s < NS; s++)
+		{
+			if (Taken[s] || ( Gr.Key >= 0 && S[s].Key >= 0 && S[s].Key != Gr.Key ))
+			{
+				continue;
+			}
+			int R = Octagon( Gr.x - S[s].x, Gr.y - S[s].y );
+			if (R < MinR)
+			{
+				MinR = R;
+				Best = s;
+			}
+		}
+		if (Best >= 0)
+		{
+			Taken[Best] = 1;
+			Ship[Order[k]] = Best;
+			NM++;
+		}
+	}
+}
+
+//A point near one of the clusters or anywhere
+static void RandomPoint( int* x, int* y )
+{
+	int c = Rand() % 9;
+	if (c < 8)
+	{
+		*x = 200 + ( c & 3 ) * 450 + Rand() % 120;
+		*y = 300 + ( c >> 2 ) * 900 + Rand() % 120;
+	}
+	else
+	{
+		*x = Rand() % 2048;
+		*y = Rand() % 2048;
+	}
+}
+
+//the brigade types of the old loading loop, the first ones first
+static const int TypeOrder[7] = { 2, 3, 5, 0, 1, 4, 6 };
+
+static int OldPick( const int* Type, const bool* Valid, int NB )
+{
+	for (int t = 0; t < 7; t++)
+	{
+		for (int b = 0; b < NB; b++)
+		{
+			if (Type[b] == TypeOrder[t] && Valid[b])
+			{
+				return b;
+			}
+		}
+	}
+	return -1;
+}
+
+static int AssignPick( const int* Type, const bool* Valid, int NB )
+{
+	std::vector<NP_Group> G;
+	std::vector<int> Brig;
+	for (int b = 0; b < NB; b++)
+	{
+		int p = 0;
+		while (p < 7 && TypeOrder[p] != Type[b])
+		{
+			p++;
+		}
+		if (p < 7 && Valid[b])
+		{
+			NP_Group Gr = { int( Rand() % 2048 ), int( Rand() % 2048 ), -1, p };
+			G.push_back( Gr );
+			Brig.push_back( b );
+		}
+	}
+	if (G.empty())
+	{
+		return -1;
+	}
+	NP_Ship S = { int( Rand() % 2048 ), int( Rand() % 2048 ), -1 };
+	std::vector<int> Ship( G.size() );
+	NP_Assign( &S, 1, G.data(), int( G.size() ), 1, Ship.data() );
+	for (int g = 0; g < int( G.size() ); g++)
+	{
+		if (Ship[g] == 0)
+		{
+			return Brig[g];
+		}
+	}
+	return -1;
+}
+
+int main()
+{
+	Seed = 909;
+	NP_SetNorm( &Octagon );
+	NP_SetSeas( NAREAS, &AreaInfo );
+	CHECK( NP_GetSea( 7 ) == 6 && NP_GetSea( 6 ) == 6 && NP_GetSea( NAREAS ) == -1 );
+	for (int i = 0; i < NPLACES; i++)
+	{
+		RandomPoint( PX + i, PY + i );
+		//some stand on one point
+		if (!( i % 13 ) && i)
+		{
+			PX[i] = PX[i - 1];
+			PY[i] = PY[i - 1];
+		}
+		PKey[i] = Rand() % NKEYS;
+		PArea[i] = Rand() % NAREAS;
+		Free[i] = Rand() % 4 != 0;
+	}
+	NP_SetCoast( NPLACES, &PlaceInfo );
+
+	int Bad = 0;
+	int Found = 0;
+	for (int q = 0; q < 3000; q++)
+	{
+		int x, y;
+		RandomPoint( &x, &y );
+		int Sea = q & 1 ? -1 : NP_GetSea( Rand() % NAREAS );
+		if (q % 3)
+		{
+			//FindCostPoint: the island of the city
+			int Key = Rand() % ( NKEYS + 1 );
+			int a = NP_FindCoast( x, y, 20, Sea, Key, &FreePlace, nullptr );
+			Bad += a != ScanPlace( x, y, Sea, Key, &FreePlace, nullptr );
+			Found += a >= 0;
+		}
+		else
+		{
+			//FindCostPointEx: the islands of the enemies
+			int Keys = Rand() & ( ( 1 << NKEYS ) - 1 );
+			int a = NP_FindCoast( x, y, 20, Sea, -1, &FreeOfKeys, &Keys );
+			Bad += a != ScanPlace( x, y, Sea, -1, &FreeOfKeys, &Keys );
+			Found += a >= 0;
+		}
+		//the places change between the queries
+		Free[Rand() % NPLACES] ^= 1;
+	}
+	CHECK( !Bad );
+	CHECK( Found > 2000 );
+
+	//ships and groups in the same clusters, some ships and groups without a key
+	int BadShip = 0;
+	for (int t = 0; t < 40; t++)
+	{
+		int NS = 1 + Rand() % 60;
+		int NG = 1 + Rand() % 120;
+		std::vector<NP_Ship> S( NS );
+		std::vector<NP_Group> G( NG );
+		for (NP_Ship& Sh : S)
+		{
+			RandomPoint( &Sh.x, &Sh.y );
+			Sh.Key = Rand() % 5 ? int( Rand() % 4 ) : -1;
+		}
+		for (NP_Group& Gr : G)
+		{
+			RandomPoint( &Gr.x, &Gr.y );
+			Gr.Key = Rand() % 7 ? int( Rand() % 4 ) : -1;
+			Gr.Prio = Rand() % 7;
+		}
+		int MaxN = t & 1 ? NG : 1 + Rand() % NG;
+		std::vector<int> A( NG );
+		std::vector<int> B( NG );
+		int NM = NP_Assign( S.data(), NS, G.data(), NG, MaxN, A.data() );
+		ScanAssign( S.data(), NS, G.data(), NG, MaxN, B.data() );
+		BadShip += A != B;
+		BadShip += NM != NG - int( std::count( A.begin(), A.end(), -1 ) );
+	}
+	CHECK( !BadShip );
+
+	//the one loading ship of a city takes the brigade of the old loop
+	int BadPick = 0;
+	for (int t = 0; t < 500; t++)
+	{
+		int NB = Rand() % 30;
+		int Type[30];
+		bool Valid[30];
+		for (int b = 0; b < NB; b++)
+		{
+			Type[b] = Rand() % 10;
+			Valid[b] = Rand() % 3 != 0;
+		}
+		BadPick += OldPick( Type, Valid, NB ) != AssignPick( Type, Valid, NB );
+	}
+	CHECK( !BadPick );
+
+	NP_SetCoast( 0, nullptr );
+	CHECK( NP_FindCoast( 100, 100, 20, -1, -1, &FreePlace, nullptr ) == -1 );
+	return TestResult( "NavalPlanTest" );
+}
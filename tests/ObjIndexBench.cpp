@@ -0,0 +1,91 @@
+#include "cross_platform/platform_compat.h"
+#include "NewCode/ObjIndex.h"
+#include "TestSprite.h"
+#include <chrono>
+
+/*
+	Slot allocation of a mass spawn late in a game: the first NLIVE
+	slots are taken, then units die in random places and NSPAWN new ones
+	take the lowest free slot, as production with the 250x multiplier
+	does. OI_FirstFree() against the scan of Group for the first empty
+	slot of the old CreateNewMonsterAt. Prints the time of one spawn run
+	and checks that both take the same slots.
+*/
+
+#define LIMIT 65535
+#define NLIVE 50000
+#define NSPAWN 20000
+#define NREPS 5
+
+static void* Group[LIMIT];
+static int Slot[2][NSPAWN];
+
+//the old scan, Group[i] of a live object is not null
+static int ScanFree()
+{
+	int i;
+	for (i = 0; i < LIMIT && Group[i]; i++);
+	return i < LIMIT ? i : -1;
+}
+
+template <class F>
+static double Time( F Run )
+{
+	auto t0 = std::chrono::steady_clock::now();
+	for (int r = 0; r < NREPS; r++)
+	{
+		Run();
+	}
+	auto t1 = std::chrono::steady_clock::now();
+	return std::chrono::duration<double, std::milli>( t1 - t0 ).count() / NREPS;
+}
+
+//Fills the first NLIVE slots and spawns NSPAWN units through Free,
+//a unit dies before every spawn
+template <class F>
+static void Spawn( F Free, int* Out )
+{
+	memset( Group, 0, sizeof Group );
+	OI_Clear();
+	for (int i = 0; i < NLIVE; i++)
+	{
+		Group[i] = Group;
+		OI_Add( i, i & 7, OIK_UNIT );
+	}
+	Seed = 31;
+	for (int k = 0; k < NSPAWN; k++)
+	{
+		int d = Rand() % NLIVE;
+		if (Group[d])
+		{
+			Group[d] = nullptr;
+			OI_Del( d );
+		}
+		int i = Free();
+		Out[k] = i;
+		if (i >= 0)
+		{
+			Group[i] = Group;
+			OI_Add( i, k & 7, OIK_UNIT );
+		}
+	}
+}
+
+int main()
+{
+	double ScanTime = Time( []
+	{
+		Spawn( &ScanFree, Slot[0] );
+	} );
+	double IndexTime = Time( []
+	{
+		Spawn( [] { return OI_FirstFree( LIMIT ); }, Slot[1] );
+	} );
+	int Differ = 0;
+	for (int k = 0; k < NSPAWN; k++)
+	{
+		Differ += Slot[0][k] != Slot[1][k];
+	}
+	printf( "%d live, %d spawns: scan %.3f ms, OI_FirstFree %.3f ms, %d differ\n", NLIVE, NSPAWN, ScanTime, IndexTime, Differ );
+	return Differ != 0;
+}
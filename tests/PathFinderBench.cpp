@@ -0,0 +1,200 @@
+#include "cross_platform/platform_compat.h"
+#include "NewCode/PathFinder.h"
+#include "TestSprite.h"
+#include <chrono>
+
+/*
+	Land paths of units of size 2 across a 1024x1024 map with rivers and
+	blocks, in groups of GROUP units next to each other with one goal,
+	the way a selection is ordered. PF_Find() with the kept paths and
+	with them dropped before every search. Prints the time of one run,
+	the paths taken from the kept ones and the cells visited, it is not
+	a test.
+*/
+
+#define SX 1024
+#define SY 1024
+#define STRIDE ( SY >> 3 )
+#define NPATHS 64
+#define GROUP 8
+#define NREPS 1
+
+static byte Bits[SX * STRIDE];
+
+static void Lock( int x, int y )
+{
+	if (x >= 0 && y >= 0 && x < SX && y < SY)
+	{
+		Bits[x * STRIDE + ( y >> 3 )] |= 1 << ( y & 7 );
+	}
+}
+
+static bool Free( int x, int y )
+{
+	for (int i = 0; i < 2; i++)
+	{
+		for (int j = 0; j < 2; j++)
+		{
+			if (x + i >= SX || y + j >= SY || ( ( Bits[( x + i ) * STRIDE + ( ( y + j ) >> 3 )] >> ( ( y + j ) & 7 ) ) & 1 ))
+			{
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+static byte Reach[SX * SY];
+
+//Cells of the unit that are reached from (x,y), a path may go straight or
+//diagonally only past free cells, so the 4 neighbours are enough
+static void Fill( int x, int y )
+{
+	static int Queue[SX * SY];
+	int N = 0;
+	Queue[N++] = y * SX + x;
+	Reach[y * SX + x] = 1;
+	for (int k = 0; k < N; k++)
+	{
+		int cx = Queue[k] % SX;
+		int cy = Queue[k] / SX;
+		static const int D[4][2] = { { 1, 0 }, { -1, 0 }, { 0, 1 }, { 0, -1 } };
+		for (int d = 0; d < 4; d++)
+		{
+			int nx = cx + D[d][0];
+			int ny = cy + D[d][1];
+			if (nx >= 0 && ny >= 0 && !Reach[ny * SX + nx] && Free( nx, ny ))
+			{
+				Reach[ny * SX + nx] = 1;
+				Queue[N++] = ny * SX + nx;
+			}
+		}
+	}
+}
+
+//Room for the GROUP units of a group at (x,y)
+static bool GroupFree( int x, int y )
+{
+	for (int i = 0; i < GROUP; i++)
+	{
+		if (!Reach[( y + ( i >> 2 ) * 2 ) * SX + x + ( i & 3 ) * 2])
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+//rivers with fords and blocks like forests and houses
+static void MakeMap()
+{
+	for (int w = 0; w < 6; w++)
+	{
+		int p = 100 + Rand() % ( SX - 200 );
+		for (int i = 0; i < SY; i++)
+		{
+			if (i % 160 > 8)
+			{
+				for (int k = 0; k < 3; k++)
+				{
+					if (w & 1)
+					{
+						Lock( p + k, i );
+					}
+					else
+					{
+						Lock( i, p + k );
+					}
+				}
+			}
+		}
+	}
+	for (int b = 0; b < 1500; b++)
+	{
+		int x = Rand() % SX;
+		int y = Rand() % SY;
+		int w = 1 + Rand() % 10;
+		int h = 1 + Rand() % 10;
+		for (int i = 0; i < w; i++)
+		{
+			for (int j = 0; j < h; j++)
+			{
+				Lock( x + i, y + j );
+			}
+		}
+	}
+}
+
+static int Run( bool Keep )
+{
+	static short X[PF_MAXPOINTS];
+	static short Y[PF_MAXPOINTS];
+	Seed = 4321;
+	PF_Reset();
+	int NFound = 0;
+	int sx = 0;
+	int sy = 0;
+	int gx = 0;
+	int gy = 0;
+	for (int i = 0; i < NPATHS; i++)
+	{
+		if (i % GROUP == 0)
+		{
+			//start and goal on free land, far apart
+			do
+			{
+				sx = Rand() % SX;
+				sy = Rand() % SY;
+				gx = Rand() % SX;
+				gy = Rand() % SY;
+			} while (!GroupFree( sx, sy ) || !Reach[gy * SX + gx] || abs( gx - sx ) + abs( gy - sy ) < ( SX >> 1 ));
+		}
+		if (!Keep)
+		{
+			PF_Reset();
+		}
+		int ux = sx + ( i % GROUP & 3 ) * 2;
+		int uy = sy + ( i % GROUP >> 2 ) * 2;
+		NFound += PF_Find( 0, 2, ux, uy, gx, gy, -1, 0, X, Y, PF_MAXPOINTS ) > 0;
+	}
+	return NFound;
+}
+
+template <class F>
+static double Time( F Paths )
+{
+	auto t0 = std::chrono::steady_clock::now();
+	for (int r = 0; r < NREPS; r++)
+	{
+		Paths();
+	}
+	auto t1 = std::chrono::steady_clock::now();
+	return std::chrono::duration<double, std::milli>( t1 - t0 ).count() / NREPS;
+}
+
+int main()
+{
+	Seed = 99;
+	MakeMap();
+	//starts and goals in the part of the map the centre is in
+	int cx = SX / 2;
+	while (!Free( cx, SY / 2 ))
+	{
+		cx++;
+	}
+	Fill( cx, SY / 2 );
+	PF_SetField( 0, Bits, SX, SY, STRIDE );
+	PF_SetBudget( 0x7FFFFFFF );
+	int NFound[2];
+	PF_ClearStats();
+	double KeptTime = Time( [&NFound] { NFound[0] = Run( true ); } );
+	PF_Stats S0;
+	PF_GetStats( &S0 );
+	PF_ClearStats();
+	double SearchTime = Time( [&NFound] { NFound[1] = Run( false ); } );
+	PF_Stats S1;
+	PF_GetStats( &S1 );
+	printf( "%d paths: %d found %.3f ms, %d kept ones, %d cells; without the kept ones %d found %.3f ms, %d cells\n",
+		NPATHS, NFound[0], KeptTime, S0.CacheHits / NREPS, S0.Cells / NREPS, NFound[1], SearchTime, S1.Cells / NREPS );
+	return 0;
+}
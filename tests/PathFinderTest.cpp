@@ -0,0 +1,309 @@
+#include "cross_platform/platform_compat.h"
+#include "NewCode/PathFinder.h"
+#include "Check.h"
+#include "TestSprite.h"
+#include <vector>
+
+/*
+	PF_Find() against a wave search over all cells: the cells a unit of
+	size L may stand on, 8-connected, straight steps 10, diagonal ones 14
+	and only with both sides free. On random maps with walls and blocks
+	every path must be free, go in straight or diagonal pieces of at most
+	8 cells and cost what the wave gives to the goal. Goals that can not
+	be reached give a free path to a cell the wave reaches. A search that
+	waits for the budget gives the same path through PF_Process(), and a
+	kept path that got blocked is not handed out again.
+*/
+
+#define SX 64
+#define SY 64
+#define STRIDE ( SY >> 3 )
+#define NMAPS 150
+#define FAR 0x7FFFFFFF
+
+static byte Bits[SX * STRIDE];
+
+static bool Locked( int x, int y )
+{
+	return ( Bits[x * STRIDE + ( y >> 3 )] >> ( y & 7 ) ) & 1;
+}
+
+static void Lock( int x, int y )
+{
+	if (x >= 0 && y >= 0 && x < SX && y < SY)
+	{
+		Bits[x * STRIDE + ( y >> 3 )] |= 1 << ( y & 7 );
+	}
+}
+
+static bool Free( int x, int y, int L )
+{
+	if (x <= 0 || y <= 0 || x + L > SX || y + L > SY)
+	{
+		return false;
+	}
+	for (int i = 0; i < L; i++)
+	{
+		for (int j = 0; j < L; j++)
+		{
+			if (Locked( x + i, y + j ))
+			{
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+static bool Step( int x, int y, int dx, int dy, int L )
+{
+	return Free( x + dx, y + dy, L ) && ( !( dx && dy ) || ( Free( x + dx, y, L ) && Free( x, y + dy, L ) ) );
+}
+
+static int Dist[SX * SY];
+
+//Costs from (sx,sy) to every cell, a scan for the next cell in place of a heap
+static void Wave( int sx, int sy, int L )
+{
+	static bool Done[SX * SY];
+	for (int i = 0; i < SX * SY; i++)
+	{
+		Dist[i] = FAR;
+		Done[i] = false;
+	}
+	Dist[sy * SX + sx] = 0;
+	for (;;)
+	{
+		int u = -1;
+		for (int i = 0; i < SX * SY; i++)
+		{
+			if (!Done[i] && Dist[i] != FAR && ( u < 0 || Dist[i] < Dist[u] ))
+			{
+				u = i;
+			}
+		}
+		if (u < 0)
+		{
+			return;
+		}
+		Done[u] = true;
+		int x = u % SX;
+		int y = u / SX;
+		for (int dy = -1; dy <= 1; dy++)
+		{
+			for (int dx = -1; dx <= 1; dx++)
+			{
+				if (( dx || dy ) && Step( x, y, dx, dy, L ))
+				{
+					int v = u + dy * SX + dx;
+					int d = Dist[u] + ( dx && dy ? 14 : 10 );
+					if (d < Dist[v])
+					{
+						Dist[v] = d;
+					}
+				}
+			}
+		}
+	}
+}
+
+//Cost of the path from (sx,sy), -1 if it is not free or not in pieces
+static int Walk( int sx, int sy, int L, const short* X, const short* Y, int N )
+{
+	int Cost = 0;
+	int x = sx;
+	int y = sy;
+	for (int i = 0; i < N; i++)
+	{
+		int ax = abs( X[i] - x );
+		int ay = abs( Y[i] - y );
+		if (( ax && ay && ax != ay ) || ( !ax && !ay ) || ax > 8 || ay > 8)
+		{
+			return -1;
+		}
+		int dx = X[i] > x ? 1 : ( X[i] < x ? -1 : 0 );
+		int dy = Y[i] > y ? 1 : ( Y[i] < y ? -1 : 0 );
+		while (x != X[i] || y != Y[i])
+		{
+			if (!Step( x, y, dx, dy, L ))
+			{
+				return -1;
+			}
+			x += dx;
+			y += dy;
+			Cost += dx && dy ? 14 : 10;
+		}
+	}
+	return Cost;
+}
+
+//walls with gaps and some blocks
+static void MakeMap()
+{
+	memset( Bits, 0, sizeof Bits );
+	int NW = Rand() % 6;
+	for (int w = 0; w < NW; w++)
+	{
+		int p = 4 + Rand() % ( SX - 8 );
+		int Gap = Rand() % SY;
+		int GapL = 3 + Rand() % 4;
+		for (int i = 0; i < SY; i++)
+		{
+			if (i < Gap || i >= Gap + GapL)
+			{
+				if (w & 1)
+				{
+					Lock( p, i );
+				}
+				else
+				{
+					Lock( i, p );
+				}
+			}
+		}
+	}
+	int NB = Rand() % 40;
+	for (int b = 0; b < NB; b++)
+	{
+		int x = Rand() % SX;
+		int y = Rand() % SY;
+		int w = 1 + Rand() % 6;
+		int h = 1 + Rand() % 6;
+		for (int i = 0; i < w; i++)
+		{
+			for (int j = 0; j < h; j++)
+			{
+				Lock( x + i, y + j );
+			}
+		}
+	}
+	//scattered cells
+	for (int k = Rand() % 120; k > 0; k--)
+	{
+		Lock( Rand() % SX, Rand() % SY );
+	}
+}
+
+static bool RandomFree( int L, int* x, int* y )
+{
+	for (int k = 0; k < 200; k++)
+	{
+		*x = 1 + Rand() % ( SX - 1 );
+		*y = 1 + Rand() % ( SY - 1 );
+		if (Free( *x, *y, L ))
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+static int Owner;
+static short DoneX[PF_MAXPOINTS];
+static short DoneY[PF_MAXPOINTS];
+static int DoneN = -2;
+
+static void TakePath( int O, DWORD Tag, short* X, short* Y, int N )
+{
+	if (O == Owner && Tag == 77)
+	{
+		memcpy( DoneX, X, N * sizeof( short ) );
+		memcpy( DoneY, Y, N * sizeof( short ) );
+		DoneN = N;
+	}
+}
+
+int main()
+{
+	Seed = 2718;
+	static short X[PF_MAXPOINTS];
+	static short Y[PF_MAXPOINTS];
+	int BadPath = 0;
+	int BadCost = 0;
+	int BadEnd = 0;
+	int BadPending = 0;
+	int Reached = 0;
+	int Unreached = 0;
+	for (int m = 0; m < NMAPS; m++)
+	{
+		MakeMap();
+		PF_SetField( 0, Bits, SX, SY, STRIDE );
+		int L = 1 + m % 3;
+		int sx, sy, gx, gy;
+		if (!RandomFree( L, &sx, &sy ) || !RandomFree( L, &gx, &gy ) || ( sx == gx && sy == gy ))
+		{
+			continue;
+		}
+		Wave( sx, sy, L );
+		PF_SetBudget( 0x7FFFFFFF );
+		int N = PF_Find( 0, L, sx, sy, gx, gy, -1, 0, X, Y, PF_MAXPOINTS );
+		int Cost = N > 0 ? Walk( sx, sy, L, X, Y, N ) : -1;
+		if (Dist[gy * SX + gx] != FAR)
+		{
+			Reached++;
+			BadPath += Cost < 0;
+			BadCost += Cost != Dist[gy * SX + gx];
+			BadEnd += N <= 0 || X[N - 1] != gx || Y[N - 1] != gy;
+		}
+		else if (N > 0)
+		{
+			//to the nearest cell it found
+			Unreached++;
+			BadPath += Cost < 0;
+			BadEnd += Dist[Y[N - 1] * SX + X[N - 1]] == FAR;
+		}
+
+		//the same search with a small budget goes on over some ticks
+		PF_Reset();
+		PF_SetBudget( 64 );
+		Owner = 1 + m;
+		DoneN = -2;
+		int P = PF_Find( 0, L, sx, sy, gx, gy, Owner, 77, X, Y, PF_MAXPOINTS );
+		if (P == PF_PENDING)
+		{
+			for (int t = 0; t < 10000 && DoneN == -2; t++)
+			{
+				PF_Process( &TakePath );
+			}
+			BadPending += DoneN != N && !( DoneN == 0 && N == PF_FAILED );
+			BadPending += DoneN > 0 && ( memcmp( DoneX, X, DoneN * sizeof( short ) ) || memcmp( DoneY, Y, DoneN * sizeof( short ) ) );
+		}
+		else
+		{
+			BadPending += P != N;
+		}
+	}
+	CHECK( !BadPath );
+	CHECK( !BadCost );
+	CHECK( !BadEnd );
+	CHECK( !BadPending );
+	CHECK( Reached > NMAPS / 2 );
+	CHECK( Unreached > 0 );
+
+	//a kept path is handed to a unit next to its start, and not once a
+	//wall is put across it
+	memset( Bits, 0, sizeof Bits );
+	PF_SetField( 0, Bits, SX, SY, STRIDE );
+	PF_SetBudget( 0x7FFFFFFF );
+	int N = PF_Find( 0, 1, 5, 5, 50, 50, -1, 0, X, Y, PF_MAXPOINTS );
+	CHECK( N > 0 );
+	PF_Stats S0;
+	PF_GetStats( &S0 );
+	CHECK( PF_Find( 0, 1, 6, 5, 50, 50, -1, 0, X, Y, PF_MAXPOINTS ) == N );
+	PF_Stats S1;
+	PF_GetStats( &S1 );
+	CHECK( S1.CacheHits == S0.CacheHits + 1 );
+	for (int i = 0; i < 40; i++)
+	{
+		Lock( 30 + i - 20, 30 - i + 20 );
+		Lock( 31 + i - 20, 30 - i + 20 );
+	}
+	N = PF_Find( 0, 1, 6, 5, 50, 50, -1, 0, X, Y, PF_MAXPOINTS );
+	PF_GetStats( &S0 );
+	CHECK( S0.CacheHits == S1.CacheHits );
+	Wave( 6, 5, 1 );
+	CHECK( N > 0 && Walk( 6, 5, 1, X, Y, N ) == Dist[50 * SX + 50] );
+	PF_SetField( 0, nullptr, 0, 0, 0 );
+	CHECK( PF_Find( 0, 1, 6, 5, 50, 50, -1, 0, X, Y, PF_MAXPOINTS ) == PF_FAILED );
+	return TestResult( "PathFinderTest" );
+}
@@ -0,0 +1,81 @@
+#include "cross_platform/platform_compat.h"
+#include "NewCode/SlabPool.h"
+#include "TestSprite.h"
+#include <chrono>
+
+/*
+	Orders of armies under micro-management: NLIVE orders are live and
+	NORDERS times one of them in a random place is dropped and a new one
+	given. SlabPool against new and memset, the way GetOrdBlock took its
+	blocks before, and delete. The blocks have the size of a packed
+	Order1. Prints the time of one run, it is not a test.
+*/
+
+#define ORDER_SIZE 40
+#define NLIVE 4096
+#define NORDERS 1000000
+#define NREPS 5
+
+struct Order
+{
+	byte Data[ORDER_SIZE];
+};
+
+static Order* Live[NLIVE];
+
+template <class F>
+static double Time( F Run )
+{
+	auto t0 = std::chrono::steady_clock::now();
+	for (int r = 0; r < NREPS; r++)
+	{
+		Run();
+	}
+	auto t1 = std::chrono::steady_clock::now();
+	return std::chrono::duration<double, std::milli>( t1 - t0 ).count() / NREPS;
+}
+
+//Gives the live orders with Get, replaces NORDERS of them and drops
+//them all with Put
+template <class G, class P>
+static void Orders( G Get, P Put )
+{
+	Seed = 12345;
+	for (int i = 0; i < NLIVE; i++)
+	{
+		Live[i] = Get();
+	}
+	for (int i = 0; i < NORDERS; i++)
+	{
+		int j = Rand() % NLIVE;
+		Put( Live[j] );
+		Live[j] = Get();
+		Live[j]->Data[1] = 2;
+	}
+	for (int i = 0; i < NLIVE; i++)
+	{
+		Put( Live[i] );
+	}
+}
+
+int main()
+{
+	SlabPool Pool( sizeof( Order ), 1024 );
+	Pool.SetPoison( false );
+	double PoolTime = Time( [&Pool]
+	{
+		Orders( [&Pool] { return (Order*) Pool.Alloc(); }, [&Pool]( Order* p ) { Pool.Free( p ); } );
+	} );
+	double HeapTime = Time( []
+	{
+		Orders( []
+		{
+			Order* p = new Order;
+			memset( p, 0, sizeof( Order ) );
+			return p;
+		}, []( Order* p ) { delete p; } );
+	} );
+	printf( "%d orders: pool %.3f ms heap %.3f ms, %.1f ns and %.1f ns per order, %d blocks at most\n", NORDERS,
+		PoolTime, HeapTime, PoolTime * 1e6 / NORDERS, HeapTime * 1e6 / NORDERS, Pool.GetPeak() );
+	return Pool.GetBadFrees() != 0;
+}
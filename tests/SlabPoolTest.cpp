@@ -0,0 +1,124 @@
+#include "cross_platform/platform_compat.h"
+#include "NewCode/SlabPool.h"
+#include "Check.h"
+#include "TestSprite.h"
+#include <set>
+#include <stdint.h>
+
+/*
+	SlabPool: blocks are zeroed, aligned and reused from the free list,
+	a double free is refused and never hands a block out twice, and the
+	statistics follow random alloc/free sequences.
+*/
+
+static bool IsZero( void* p, int Size )
+{
+	for (int i = 0; i < Size; i++)
+	{
+		if (( (byte*) p )[i])
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+int main()
+{
+	Seed = 77;
+
+	//blocks are zeroed and aligned, the first slab is taken on demand
+	{
+		SlabPool P( 20, 4 );
+		CHECK( P.GetCapacity() == 0 );
+		void* a = P.Alloc();
+		CHECK( P.GetCapacity() == 4 );
+		CHECK( IsZero( a, 20 ) );
+		CHECK( ( uintptr_t( a ) & 7 ) == 0 );
+		memset( a, 0x55, 20 );
+		//the freed block is the next one handed out, zeroed again
+		P.Free( a );
+		void* b = P.Alloc();
+		CHECK( b == a );
+		CHECK( IsZero( b, 20 ) );
+		//more than a slab takes a second one
+		std::vector<void*> More;
+		for (int i = 0; i < 5; i++)
+		{
+			More.push_back( P.Alloc() );
+		}
+		CHECK( P.GetCapacity() == 8 );
+		CHECK( P.GetLive() == 6 );
+		P.Free( nullptr );
+		CHECK( P.GetBadFrees() == 0 );
+	}
+
+	//a double free is counted and the block is handed out once
+	for (int Poison = 0; Poison < 2; Poison++)
+	{
+		SlabPool P( 16, 8 );
+		P.SetPoison( Poison != 0 );
+		void* a = P.Alloc();
+		void* b = P.Alloc();
+		P.Free( a );
+		P.Free( a );
+		CHECK( P.GetBadFrees() == 1 );
+		CHECK( P.GetLive() == 1 );
+		void* c = P.Alloc();
+		void* d = P.Alloc();
+		CHECK( c == a );
+		CHECK( d != a && d != b );
+		//a block that was freed, reused and freed again is fine
+		P.Free( c );
+		CHECK( P.GetBadFrees() == 1 );
+	}
+
+	//random sequences: live blocks are distinct, stay intact and the
+	//statistics match a count kept here
+	{
+		const int Size = 40;
+		SlabPool P( Size, 64 );
+		std::vector<byte*> Live;
+		int Peak = 0;
+		int High = 0;
+		for (int Frame = 0; Frame < 200; Frame++)
+		{
+			for (int k = 0; k < 50; k++)
+			{
+				if (Live.empty() || Rand() % 100 < 55)
+				{
+					byte* p = (byte*) P.Alloc();
+					CHECK( IsZero( p, Size ) );
+					memset( p, byte( uintptr_t( p ) ), Size );
+					Live.push_back( p );
+				}
+				else
+				{
+					int i = Rand() % Live.size();
+					byte* p = Live[i];
+					for (int j = 0; j < Size; j++)
+					{
+						CHECK( p[j] == byte( uintptr_t( p ) ) );
+					}
+					P.Free( p );
+					Live[i] = Live.back();
+					Live.pop_back();
+				}
+				int N = int( Live.size() );
+				Peak = N > Peak ? N : Peak;
+				High = N > High ? N : High;
+			}
+			CHECK( P.GetLive() == int( Live.size() ) );
+			P.NewFrame();
+			CHECK( P.GetFrameHigh() == High );
+			High = int( Live.size() );
+		}
+		CHECK( P.GetPeak() == Peak );
+		CHECK( P.GetCapacity() >= Peak );
+		std::set<byte*> Distinct( Live.begin(), Live.end() );
+		CHECK( Distinct.size() == Live.size() );
+		CHECK( P.GetBadFrees() == 0 );
+	}
+
+	return TestResult( "SlabPoolTest" );
+}
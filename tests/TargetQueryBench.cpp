@@ -0,0 +1,162 @@
+#include "cross_platform/platform_compat.h"
+#include "NewCode/TargetQuery.h"
+#include "NewCode/CellBuckets.h"
+#include "NewCode/ObjHot.h"
+#include "NewCode/ObjIndex.h"
+#include "TestSprite.h"
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+/*
+	The victim searches of one tick of a battle: two armies of 4000 units
+	in dense blocks, every unit asks for the nearest enemy within 5 cells.
+	TQ_Nearest() per unit against TQ_NearestIn() with one TQ_Rings per
+	cell, as SearchVictims() runs them, the sort of the units by cell
+	included. The filter looks at the unit through a pointer, as IsVictim
+	does. Prints the time of one tick and checks that both find the same.
+*/
+
+#define CX 256
+#define SHIFT 8
+#define NUNITS 8000
+#define NREPS 20
+
+static word MCount[CX * CX];
+static word BLDList[CX * CX];
+
+struct Unit
+{
+	bool Dead;
+	int Life;
+	byte Kind;
+	byte Pad[52];
+};
+static Unit* Units[NUNITS * 2];
+
+struct Filter
+{
+	int x, y;
+	int MinR2;
+};
+
+static bool AcceptAny( word MID, void* Param )
+{
+	Unit* U = Units[MID];
+	return !U->Dead && U->Life > 0 && U->Kind != 3;
+}
+
+static bool AcceptFar( word MID, void* Param )
+{
+	Filter* F = (Filter*) Param;
+	long long dx = OH_X[MID] - F->x;
+	long long dy = OH_Y[MID] - F->y;
+	return dx * dx + dy * dy >= F->MinR2;
+}
+
+static bool Accept( word MID, void* Param )
+{
+	return AcceptAny( MID, Param ) && AcceptFar( MID, Param );
+}
+
+static int MinR2( int i )
+{
+	return i % 3 ? 0 : 600 * 600;
+}
+
+static word Found[2][NUNITS * 2];
+
+template <class F>
+static double Time( F Tick )
+{
+	auto t0 = std::chrono::steady_clock::now();
+	for (int r = 0; r < NREPS; r++)
+	{
+		Tick();
+	}
+	auto t1 = std::chrono::steady_clock::now();
+	return std::chrono::duration<double, std::milli>( t1 - t0 ).count() / NREPS;
+}
+
+int main()
+{
+	Seed = 2024;
+	CB_Init( CX, SHIFT, MCount, BLDList );
+	TQ_Init( CX, SHIFT );
+	OI_Clear();
+	std::vector<int> All;
+	for (int i = 0; i < NUNITS; i++)
+	{
+		int Index = i * 2;
+		int Army = i & 1;
+		Units[Index] = new Unit();
+		Units[Index]->Life = Rand() % 16 ? 100 : 0;
+		Units[Index]->Kind = byte( Rand() % 8 );
+		//blocks of 80 units, 12 blocks a row, the armies face each other
+		int Block = i >> 1;
+		int bx = ( Block / 80 ) % 12;
+		int by = ( Block / 80 ) / 12;
+		OH_X[Index] = 200000 + bx * 9000 + ( Block % 10 ) * 500 + Rand() % 200;
+		OH_Y[Index] = 200000 + Army * 14000 + by * 30000 + ( ( Block / 10 ) % 8 ) * 400 + Rand() % 200;
+		OH_Flags[Index] = OHF_UNIT;
+		OH_Nat[Index] = byte( Army );
+		OI_Add( Index, OH_Nat[Index], OIK_UNIT );
+		All.push_back( Index );
+	}
+	CB_Reset();
+	CB_Update();
+	TQ_Clear();
+	for (int i : All)
+	{
+		TQ_Occupy( ( OH_X[i] >> 11 ) + ( ( OH_Y[i] >> 11 ) << SHIFT ), byte( 1 << OH_Nat[i] ) );
+	}
+
+	double PerUnit = Time( [&All]
+	{
+		for (int i : All)
+		{
+			Filter F = { OH_X[i], OH_Y[i], MinR2( i ) };
+			word Res[TQ_MAXK];
+			int N = TQ_Nearest( F.x, F.y, 5, byte( 1 << ( 1 - OH_Nat[i] ) ), &Accept, &F, Res, TQ_MAXK );
+			Found[0][i] = N ? Res[0] : 0xFFFF;
+		}
+	} );
+	double Shared = Time( [&All]
+	{
+		std::vector<std::pair<int, int> > Jobs;
+		for (int i : All)
+		{
+			Jobs.push_back( std::make_pair( ( ( OH_Y[i] >> 11 ) << SHIFT ) + ( OH_X[i] >> 11 ) + ( OH_Nat[i] << 16 ), i ) );
+		}
+		std::sort( Jobs.begin(), Jobs.end() );
+		TQ_Rings C;
+		int Last = -1;
+		for (auto& J : Jobs)
+		{
+			int i = J.second;
+			if (J.first != Last)
+			{
+				TQ_RingsInit( &C, J.first & 0xFFFF, 5, byte( 1 << ( 1 - OH_Nat[i] ) ), &AcceptAny, nullptr );
+				Last = J.first;
+			}
+			Filter F = { OH_X[i], OH_Y[i], MinR2( i ) };
+			word Res[TQ_MAXK];
+			int N = TQ_NearestIn( &C, F.x, F.y, F.MinR2 ? &AcceptFar : nullptr, &F, Res, TQ_MAXK );
+			Found[1][i] = N ? Res[0] : 0xFFFF;
+		}
+	} );
+	int Differ = 0;
+	for (int i : All)
+	{
+		Differ += Found[0][i] != Found[1][i];
+	}
+
+	printf( "%d units: TQ_Nearest %.3f ms, TQ_NearestIn per cell %.3f ms, %d differ\n", NUNITS, PerUnit, Shared, Differ );
+	for (int i : All)
+	{
+		delete Units[i];
+	}
+	TQ_Free();
+	CB_Free();
+	return Differ != 0;
+}
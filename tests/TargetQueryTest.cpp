@@ -0,0 +1,245 @@
+#include "cross_platform/platform_compat.h"
+#include "NewCode/TargetQuery.h"
+#include "NewCode/CellBuckets.h"
+#include "NewCode/ObjHot.h"
+#include "NewCode/ObjIndex.h"
+#include "Check.h"
+#include "TestSprite.h"
+#include <algorithm>
+#include <vector>
+
+/*
+	TQ_Nearest() against a linear scan of all the units: the units of the
+	cells within R cells that hold a nation of Mask, accepted by the
+	filter, ranked by the squared distance and then the index. Crowds
+	with equal positions give ties, the filter drops some units by their
+	index and some by the distance, as the MinR of SearchVictim does.
+	TQ_NearestIn() of the units of a cell that share a TQ_Rings against
+	TQ_Nearest() with the two filters in one.
+*/
+
+#define CX 64
+#define SHIFT 6
+#define NUNITS 3000
+
+static word MCount[CX * CX];
+static word BLDList[CX * CX];
+
+struct Filter
+{
+	int x, y;
+	int MinR2;
+	int Drop;
+};
+
+static bool Accept( word MID, void* Param )
+{
+	Filter* F = (Filter*) Param;
+	long long dx = OH_X[MID] - F->x;
+	long long dy = OH_Y[MID] - F->y;
+	return MID % 7 != F->Drop && dx * dx + dy * dy >= F->MinR2;
+}
+
+//the part of Accept that does not depend on the asking point
+static bool AcceptIndex( word MID, void* Param )
+{
+	return MID % 7 != ( (Filter*) Param )->Drop;
+}
+
+static bool AcceptFar( word MID, void* Param )
+{
+	Filter* F = (Filter*) Param;
+	long long dx = OH_X[MID] - F->x;
+	long long dy = OH_Y[MID] - F->y;
+	return dx * dx + dy * dy >= F->MinR2;
+}
+
+//Units of each crowd cell ask with one TQ_Rings, in turn as the workers do
+static int CountBadShared( int R, byte Mask, int K, int Drop )
+{
+	int Bad = 0;
+	TQ_Rings C;
+	for (int Cell = 0; Cell < CX * CX; Cell++)
+	{
+		Filter Shared = { 0, 0, 0, Drop };
+		TQ_RingsInit( &C, Cell, R, Mask, &AcceptIndex, &Shared );
+		for (int i = OI_Next( 0, OIL_UNITS ); i < OI_END; i = OI_Next( i + 1, OIL_UNITS ))
+		{
+			if (( OH_X[i] >> 11 ) + ( ( OH_Y[i] >> 11 ) << SHIFT ) != Cell)
+			{
+				continue;
+			}
+			Filter F = { OH_X[i], OH_Y[i], i % 3 ? 0 : 1500 * 1500, Drop };
+			word A[TQ_MAXK];
+			word B[TQ_MAXK];
+			int NA = TQ_NearestIn( &C, F.x, F.y, F.MinR2 ? &AcceptFar : nullptr, &F, A, K );
+			int NB = TQ_Nearest( F.x, F.y, R, Mask, &Accept, &F, B, K );
+			Bad += NA != NB || !std::equal( A, A + NA, B );
+		}
+	}
+	return Bad;
+}
+
+static bool CellHolds( int cx, int cy, byte Mask )
+{
+	for (int i = OI_Next( 0, OIL_UNITS ); i < OI_END; i = OI_Next( i + 1, OIL_UNITS ))
+	{
+		if (( OH_X[i] >> 11 ) == cx && ( OH_Y[i] >> 11 ) == cy && ( Mask & ( 1 << OH_Nat[i] ) ))
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+static int Scan( int x, int y, int R, byte Mask, Filter* F, word* Res, int K )
+{
+	static byte Holds[CX][CX];
+	for (int cy = 0; cy < CX; cy++)
+	{
+		for (int cx = 0; cx < CX; cx++)
+		{
+			Holds[cy][cx] = 0;
+		}
+	}
+	for (int i = OI_Next( 0, OIL_UNITS ); i < OI_END; i = OI_Next( i + 1, OIL_UNITS ))
+	{
+		if (Mask & ( 1 << OH_Nat[i] ))
+		{
+			Holds[OH_Y[i] >> 11][OH_X[i] >> 11] = 1;
+		}
+	}
+	std::vector<std::pair<long long, int> > All;
+	for (int i = OI_Next( 0, OIL_UNITS ); i < OI_END; i = OI_Next( i + 1, OIL_UNITS ))
+	{
+		int cx = OH_X[i] >> 11;
+		int cy = OH_Y[i] >> 11;
+		if (abs( cx - ( x >> 11 ) ) <= R && abs( cy - ( y >> 11 ) ) <= R && Holds[cy][cx] && Accept( word( i ), F ))
+		{
+			long long dx = OH_X[i] - x;
+			long long dy = OH_Y[i] - y;
+			All.push_back( std::make_pair( dx * dx + dy * dy, i ) );
+		}
+	}
+	std::sort( All.begin(), All.end() );
+	int N = int( All.size() ) < K ? int( All.size() ) : K;
+	for (int i = 0; i < N; i++)
+	{
+		Res[i] = word( All[i].second );
+	}
+	return N;
+}
+
+//Units of nation 0..7 in a few crowds, the rest spread over the map
+static void PlaceUnits()
+{
+	OI_Clear();
+	for (int i = 0; i < NUNITS; i++)
+	{
+		int Index = i * 3 + Rand() % 3;
+		int x, y;
+		if (i % 3)
+		{
+			int c = Rand() % 8;
+			x = 12000 + c * 14000 + Rand() % 3000;
+			y = 30000 + ( c & 3 ) * 9000 + Rand() % 3000;
+			//stacked on one point
+			if (!( i % 17 ))
+			{
+				x = 12000 + c * 14000;
+				y = 30000 + ( c & 3 ) * 9000;
+			}
+		}
+		else
+		{
+			x = Rand() % ( ( CX - 2 ) << 11 );
+			y = Rand() % ( ( CX - 2 ) << 11 );
+		}
+		OH_X[Index] = x;
+		OH_Y[Index] = y;
+		OH_Flags[Index] = OHF_UNIT;
+		OH_Nat[Index] = byte( Rand() % 8 );
+		OI_Add( Index, OH_Nat[Index], OIK_UNIT );
+	}
+	CB_Reset();
+	CB_Update();
+	TQ_Clear();
+	for (int i = OI_Next( 0, OIL_UNITS ); i < OI_END; i = OI_Next( i + 1, OIL_UNITS ))
+	{
+		TQ_Occupy( ( OH_X[i] >> 11 ) + ( ( OH_Y[i] >> 11 ) << SHIFT ), byte( 1 << OH_Nat[i] ) );
+	}
+}
+
+int main()
+{
+	Seed = 4242;
+	CB_Init( CX, SHIFT, MCount, BLDList );
+	TQ_Init( CX, SHIFT );
+	for (int Run = 0; Run < 2; Run++)
+	{
+		PlaceUnits();
+		int Bad = 0;
+		int BadAny = 0;
+		int Found = 0;
+		for (int q = 0; q < 1500; q++)
+		{
+			int x;
+			int y;
+			if (q & 1)
+			{
+				//a unit asks from its own position
+				int i = OI_Next( Rand() % ( NUNITS * 3 ), OIL_UNITS );
+				i = i < OI_END ? i : OI_Next( 0, OIL_UNITS );
+				x = OH_X[i];
+				y = OH_Y[i];
+			}
+			else
+			{
+				x = Rand() % ( ( CX - 2 ) << 11 );
+				y = Rand() % ( ( CX - 2 ) << 11 );
+			}
+			int R = Rand() % 6;
+			byte Mask = byte( Rand() );
+			int K = 1 + Rand() % TQ_MAXK;
+			Filter F = { x, y, Rand() % 3 ? 0 : int( Rand() % 2000 ) * int( Rand() % 2000 ), int( Rand() % 9 ) };
+			word A[TQ_MAXK];
+			word B[TQ_MAXK];
+			int NA = TQ_Nearest( x, y, R, Mask, &Accept, &F, A, K );
+			int NB = Scan( x, y, R, Mask, &F, B, K );
+			Found += NA;
+			if (NA != NB || !std::equal( A, A + NA, B ))
+			{
+				Bad++;
+			}
+			bool Any = false;
+			for (int dy = -R; dy <= R && !Any; dy++)
+			{
+				for (int dx = -R; dx <= R && !Any; dx++)
+				{
+					int cx = ( x >> 11 ) + dx;
+					int cy = ( y >> 11 ) + dy;
+					Any = cx >= 0 && cy >= 0 && cx < CX && cy < CX && CellHolds( cx, cy, Mask );
+				}
+			}
+			BadAny += Any != TQ_Any( ( x >> 11 ) + ( ( y >> 11 ) << SHIFT ), R, Mask );
+		}
+		CHECK( !Bad );
+		CHECK( !BadAny );
+		CHECK( Found > 1500 );
+		for (int q = 0; q < 3; q++)
+		{
+			CHECK( !CountBadShared( 1 + Rand() % 5, byte( Rand() | 1 ), 1 + Rand() % TQ_MAXK, int( Rand() % 9 ) ) );
+		}
+	}
+	//a point off the map and K of 0 find nothing
+	word A[TQ_MAXK];
+	Filter F = { 0, 0, 0, -1 };
+	CHECK( !TQ_Nearest( -1, 0, 3, 255, &Accept, &F, A, TQ_MAXK ) );
+	CHECK( !TQ_Nearest( 1000, 1000, 3, 255, &Accept, &F, A, 0 ) );
+	TQ_Rings C;
+	TQ_RingsInit( &C, CX * CX, 3, 255, &AcceptIndex, &F );
+	CHECK( !TQ_NearestIn( &C, 0, CX << 11, nullptr, &F, A, TQ_MAXK ) );
+	TQ_Free();
+	CB_Free();
+	return TestResult( "TargetQueryTest" );
+}
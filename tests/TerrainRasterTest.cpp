@@ -0,0 +1,241 @@
+#include "cross_platform/platform_compat.h"
+#include "NewCode/TerrainRaster.h"
+#include "Check.h"
+#include "TestSprite.h"
+
+/*
+	TR_RenderTriangle64() on random triangles.
+
+	- Every triangle only writes the columns [min x, max x) of its
+	  vertices and the rows StartLine..EndLine.
+	- A texture mapped one to one with the screen and a fog table that
+	  keeps the colour give the texture back, so the edge walk, the
+	  texture gradients and the fog dither rows line up.
+	- Rows split among the JobPool workers give the serial screen.
+	- The screen after every triangle is hashed and compared with the
+	  stored hash. The hashes were made by this C port, which was checked
+	  against a model of the old assembler when it was written; the model
+	  is not in the tree, so they keep the port from changing rather than
+	  prove it right. Run with "print" to write the table again.
+*/
+
+#define SCR_LX 256
+#define SCR_LY 256
+#define NTRI 64
+//fog rows -64..63 around row 0 at FogTable+16384
+#define FOG_SIZE ( 16384 + 64 * 256 )
+
+static byte Screen[SCR_LX * SCR_LY];
+static byte Strips[SCR_LX * SCR_LY];
+static byte Bitm[TR_MASK_SIZE];
+static byte FogTable[FOG_SIZE];
+
+struct TestTri
+{
+	int xs[3], ys[3], xb[3], yb[3], f[3];
+	int StartLine, EndLine;
+};
+
+static TestTri Tris[NTRI];
+
+static unsigned long long Hash( const byte* p, int n )
+{
+	unsigned long long h = 14695981039346656037ULL;
+	for (int i = 0; i < n; i++)
+	{
+		h = ( h ^ p[i] ) * 1099511628211ULL;
+	}
+	return h;
+}
+
+static void Render( const TestTri& T, byte* Scr, int StartLine, int EndLine )
+{
+	TR_RenderTriangle64( T.xs[0], T.ys[0], T.xs[1], T.ys[1], T.xs[2], T.ys[2],
+		T.xb[0], T.yb[0], T.xb[1], T.yb[1], T.xb[2], T.yb[2],
+		T.f[0], T.f[1], T.f[2], Scr, Bitm, StartLine, EndLine, SCR_LX, FogTable );
+}
+
+static void MakeTriangles()
+{
+	Seed = 8086;
+	for (int t = 0; t < NTRI; t++)
+	{
+		TestTri& T = Tris[t];
+		int Size = t < NTRI / 2 ? 32 : 160;
+		int x0 = 16 + Rand() % ( SCR_LX - 32 - Size );
+		int y0 = 16 + Rand() % ( SCR_LY - 32 - Size );
+		for (int v = 0; v < 3; v++)
+		{
+			T.xs[v] = x0 + Rand() % Size;
+			T.ys[v] = y0 + Rand() % Size;
+			T.xb[v] = Rand() % 256;
+			T.yb[v] = Rand() % 256;
+			T.f[v] = int( Rand() % 96 ) - 48;
+		}
+		//a few flat tops and bottoms, as on the terrain grid
+		if (t % 8 == 3)
+		{
+			T.ys[1] = T.ys[0];
+		}
+		if (t % 8 == 5)
+		{
+			T.ys[2] = T.ys[1];
+		}
+		//every third triangle is clipped to some of its rows
+		T.StartLine = t % 3 ? 0 : T.ys[0] + int( Rand() % 40 ) - 20;
+		T.EndLine = t % 3 ? SCR_LY - 1 : T.StartLine + Rand() % 60;
+	}
+}
+
+//Made by the C port, see above
+static const unsigned long long Golden[NTRI] =
+{
+#include "TerrainRasterGolden.inc"
+};
+
+struct StripJob
+{
+	int NStrips;
+};
+
+//Strip Index of every triangle into Strips
+static void DrawStrip( int Index, void* Param )
+{
+	int NStrips = ( (StripJob*) Param )->NStrips;
+	int y0 = SCR_LY * Index / NStrips;
+	int y1 = SCR_LY * ( Index + 1 ) / NStrips - 1;
+	for (int t = 0; t < NTRI; t++)
+	{
+		int s = Tris[t].StartLine > y0 ? Tris[t].StartLine : y0;
+		int e = Tris[t].EndLine < y1 ? Tris[t].EndLine : y1;
+		if (s <= e)
+		{
+			Render( Tris[t], Strips, s, e );
+		}
+	}
+}
+
+int main( int argc, char** argv )
+{
+	Seed = 1987;
+	for (int i = 0; i < TR_MASK_SIZE; i++)
+	{
+		Bitm[i] = byte( Rand() );
+	}
+	//no colour maps to 0, so every written pixel shows
+	for (int i = 0; i < FOG_SIZE; i++)
+	{
+		FogTable[i] = byte( 1 + Rand() % 255 );
+	}
+	MakeTriangles();
+
+	if (argc > 1 && !strcmp( argv[1], "print" ))
+	{
+		memset( Screen, 0, sizeof Screen );
+		for (int t = 0; t < NTRI; t++)
+		{
+			Render( Tris[t], Screen, Tris[t].StartLine, Tris[t].EndLine );
+			printf( "\t0x%016llXULL,\n", Hash( Screen, sizeof Screen ) );
+		}
+		return 0;
+	}
+
+	//stored screens
+	memset( Screen, 0, sizeof Screen );
+	int Bad = 0;
+	for (int t = 0; t < NTRI; t++)
+	{
+		Render( Tris[t], Screen, Tris[t].StartLine, Tris[t].EndLine );
+		if (Hash( Screen, sizeof Screen ) != Golden[t])
+		{
+			printf( "triangle %d differs\n", t );
+			Bad++;
+		}
+	}
+	CHECK( !Bad );
+
+	//written pixels stay in the columns and rows of the triangle
+	int NWritten = 0;
+	for (int t = 0; t < NTRI; t++)
+	{
+		const TestTri& T = Tris[t];
+		memset( Strips, 0, sizeof Strips );
+		Render( T, Strips, T.StartLine, T.EndLine );
+		int x0 = T.xs[0], x1 = T.xs[0], y0 = T.ys[0], y1 = T.ys[0];
+		for (int v = 1; v < 3; v++)
+		{
+			x0 = T.xs[v] < x0 ? T.xs[v] : x0;
+			x1 = T.xs[v] > x1 ? T.xs[v] : x1;
+			y0 = T.ys[v] < y0 ? T.ys[v] : y0;
+			y1 = T.ys[v] > y1 ? T.ys[v] : y1;
+		}
+		int Out = 0;
+		for (int y = 0; y < SCR_LY; y++)
+		{
+			for (int x = 0; x < SCR_LX; x++)
+			{
+				if (Strips[x + y * SCR_LX])
+				{
+					NWritten++;
+					Out += x < x0 || x >= x1 || y < y0 || y > y1 || y < T.StartLine || y > T.EndLine;
+				}
+			}
+		}
+		CHECK( !Out );
+	}
+	CHECK( NWritten > 0 );
+
+	//texture mapped to the screen, fog rows 0 and 1 keep the colour
+	byte Fog[FOG_SIZE];
+	memcpy( Fog, FogTable, sizeof Fog );
+	for (int c = 0; c < 512; c++)
+	{
+		FogTable[16384 + c] = byte( c );
+	}
+	for (int v = 0; v < 64; v++)
+	{
+		for (int u = 0; u < 64; u++)
+		{
+			Bitm[u + v * 256] = byte( 1 + ( ( u * 7 + v * 13 ) % 255 ) );
+		}
+	}
+	for (int t = 0; t < NTRI; t++)
+	{
+		TestTri T = Tris[t];
+		memset( Strips, 0, sizeof Strips );
+		for (int v = 0; v < 3; v++)
+		{
+			T.xb[v] = T.xs[v];
+			T.yb[v] = T.ys[v];
+			T.f[v] = 0;
+		}
+		Render( T, Strips, 0, SCR_LY - 1 );
+		int Wrong = 0;
+		for (int y = 0; y < SCR_LY; y++)
+		{
+			for (int x = 0; x < SCR_LX; x++)
+			{
+				byte c = Strips[x + y * SCR_LX];
+				Wrong += c && c != Bitm[( x & 63 ) + ( y & 63 ) * 256];
+			}
+		}
+		CHECK( !Wrong );
+	}
+	memcpy( FogTable, Fog, sizeof Fog );
+	Seed = 1987;
+	for (int i = 0; i < TR_MASK_SIZE; i++)
+	{
+		Bitm[i] = byte( Rand() );
+	}
+
+	//rows on the workers, every worker has its own scratch lines
+	for (int NStrips : { 2, 7, 16 })
+	{
+		memset( Strips, 0, sizeof Strips );
+		StripJob J;
+		J.NStrips = NStrips;
+		TR_ParallelFor( NStrips, &DrawStrip, &J );
+		CHECK( !memcmp( Strips, Screen, sizeof Screen ) );
+	}
+	return TestResult( "TerrainRasterTest" );
+}
@@ -0,0 +1,82 @@
+#pragma once
+#include <vector>
+
+/*
+	Synthetic masked GP layers for the blitter tests: simple and packed
+	line headers, empty lines and segments longer than a vector.
+*/
+
+#define TS_NLINES 96
+
+static unsigned int Seed;
+
+static inline unsigned int Rand()
+{
+	Seed = Seed * 1103515245 + 12345;
+	return Seed >> 8;
+}
+
+//Masked sprite: the line masks and the pixel data
+struct TestSprite
+{
+	std::vector<byte> Mask;
+	std::vector<byte> CData;
+	int Lx;
+	int NLines;
+};
+
+static inline void MakeSprite( TestSprite* S, int NLines = TS_NLINES )
+{
+	S->Lx = 0;
+	S->NLines = NLines;
+	int NPix = 0;
+	for (int ln = 0; ln < NLines; ln++)
+	{
+		int Kind = Rand() % 5;
+		int Width = 0;
+		if (!Kind)
+		{
+			S->Mask.push_back( 0 );
+		}
+		else if (Kind < 3)
+		{
+			//simple header: (space, pixels) byte pairs
+			int nseg = 1 + Rand() % 4;
+			S->Mask.push_back( byte( nseg ) );
+			for (int s = 0; s < nseg; s++)
+			{
+				int space = Rand() % 24;
+				int n = 1 + Rand() % ( Kind == 1 ? 70 : 12 );
+				S->Mask.push_back( byte( space ) );
+				S->Mask.push_back( byte( n ) );
+				Width += space + n;
+				NPix += n;
+			}
+		}
+		else
+		{
+			//packed header: nibbles with the +16 flags
+			int nseg = 1 + Rand() % 6;
+			int sm = Rand() & 1;
+			int pm = Kind == 4;
+			S->Mask.push_back( byte( 128 | ( sm ? 64 : 0 ) | ( pm ? 32 : 0 ) | nseg ) );
+			for (int s = 0; s < nseg; s++)
+			{
+				int space = Rand() & 15;
+				int n = pm ? Rand() & 15 : 1 + Rand() % 15;
+				S->Mask.push_back( byte( space | ( n << 4 ) ) );
+				Width += ( space | ( sm ? 16 : 0 ) ) + ( n | ( pm ? 16 : 0 ) );
+				NPix += n | ( pm ? 16 : 0 );
+			}
+		}
+		if (Width > S->Lx)
+		{
+			S->Lx = Width;
+		}
+	}
+	S->CData.resize( NPix );
+	for (int i = 0; i < NPix; i++)
+	{
+		S->CData[i] = byte( Rand() );
+	}
+}
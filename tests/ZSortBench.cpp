@@ -0,0 +1,107 @@
+#include "cross_platform/platform_compat.h"
+#include "NewCode/ZSort.h"
+#include "TestSprite.h"
+#include <chrono>
+
+/*
+	Sort of a Z-buffer draw list of 20000 points: ZS_RadixSort() of the
+	packed keys against the per-line bubble sort it replaced, a C copy of
+	the old SortWords() over lines of at most 64 points. Prints the time
+	of one sort, it is not a test.
+*/
+
+#define NPOINTS 20000
+#define NYLINES 2000
+#define ZBFNX 64
+#define NREPS 200
+
+static DWORD Keys[NPOINTS];
+static short PX[NPOINTS];
+static int PY[NPOINTS];
+static int Order[NPOINTS];
+static int Temp[NPOINTS];
+
+static word ZBUF[NYLINES * ZBFNX];
+static short ZBUFX[NYLINES * ZBFNX];
+static byte ZBFCounter[NYLINES];
+
+//SortWords() of the old ZBuffer.cpp
+static void SortWords( int NWords, word* Data, short* Factor )
+{
+	bool Done;
+	do
+	{
+		Done = true;
+		for (int i = 0; i < NWords - 1; i++)
+		{
+			if (Factor[i + 1] < Factor[i])
+			{
+				short f = Factor[i];
+				Factor[i] = Factor[i + 1];
+				Factor[i + 1] = f;
+				word d = Data[i];
+				Data[i] = Data[i + 1];
+				Data[i + 1] = d;
+				Done = false;
+			}
+		}
+	} while (!Done);
+}
+
+static void FillLines()
+{
+	memset( ZBFCounter, 0, sizeof ZBFCounter );
+	for (int i = 0; i < NPOINTS; i++)
+	{
+		int y = PY[i];
+		if (ZBFCounter[y] < ZBFNX)
+		{
+			int pos = y * ZBFNX + ZBFCounter[y]++;
+			ZBUF[pos] = word( i );
+			ZBUFX[pos] = PX[i];
+		}
+	}
+}
+
+template <class F>
+static double Time( F Sort )
+{
+	auto t0 = std::chrono::steady_clock::now();
+	for (int r = 0; r < NREPS; r++)
+	{
+		Sort();
+	}
+	auto t1 = std::chrono::steady_clock::now();
+	return std::chrono::duration<double, std::milli>( t1 - t0 ).count() / NREPS;
+}
+
+int main()
+{
+	//points of a 1024x768 view, Y lines from DYZBuf on
+	Seed = 31337;
+	for (int i = 0; i < NPOINTS; i++)
+	{
+		PY[i] = 256 + Rand() % 768;
+		PX[i] = short( int( Rand() % 1224 ) - 100 );
+		Keys[i] = ( DWORD( 1 ) << 27 ) | ( DWORD( PY[i] ) << 16 ) | DWORD( word( PX[i] + 0x8000 ) );
+	}
+
+	double Radix = Time( [] { ZS_RadixSort( Keys, NPOINTS, 29, Order, Temp ); } );
+	//the bubble sort needs the unsorted lines every time, so filling
+	//them is timed on its own and taken off
+	double Fill = Time( [] { FillLines(); } );
+	double Bubble = Time( []
+	{
+		FillLines();
+		for (int y = 0; y < NYLINES; y++)
+		{
+			if (ZBFCounter[y] > 1)
+			{
+				SortWords( ZBFCounter[y], ZBUF + y * ZBFNX, ZBUFX + y * ZBFNX );
+			}
+		}
+	} ) - Fill;
+
+	printf( "%d points: radix sort %.3f ms, per-line bubble sort %.3f ms\n", NPOINTS, Radix, Bubble );
+	return 0;
+}
@@ -0,0 +1,74 @@
+#include "cross_platform/platform_compat.h"
+#include "NewCode/ZSort.h"
+#include "Check.h"
+#include "TestSprite.h"
+#include <algorithm>
+
+/*
+	ZS_RadixSort() against std::stable_sort() of the same keys: lists
+	with many equal keys, keys of few used bits, bits above KeyBits that
+	must be ignored, and the draw list keys of the Z-buffer.
+*/
+
+static bool SameAsStable( const std::vector<DWORD>& Keys, int KeyBits )
+{
+	int N = int( Keys.size() );
+	DWORD Mask = KeyBits >= 32 ? 0xFFFFFFFF : ( DWORD( 1 ) << KeyBits ) - 1;
+	std::vector<int> Ref( N );
+	for (int i = 0; i < N; i++)
+	{
+		Ref[i] = i;
+	}
+	std::stable_sort( Ref.begin(), Ref.end(), [&]( int a, int b )
+	{
+		return ( Keys[a] & Mask ) < ( Keys[b] & Mask );
+	} );
+	std::vector<int> Order( N + 1, -1 );
+	std::vector<int> Temp( N + 1, -1 );
+	ZS_RadixSort( Keys.data(), N, KeyBits, Order.data(), Temp.data() );
+	//the sort writes N indices and nothing past them
+	return Order[N] == -1 && std::equal( Ref.begin(), Ref.end(), Order.begin() );
+}
+
+int main()
+{
+	Seed = 2024;
+	static const int Sizes[] = { 0, 1, 2, 3, 255, 256, 257, 4096, 20000 };
+	static const int Bits[] = { 8, 16, 24, 29, 32 };
+	for (int N : Sizes)
+	{
+		for (int KeyBits : Bits)
+		{
+			//few distinct keys, so most of them are equal
+			std::vector<DWORD> Keys( N );
+			for (int i = 0; i < N; i++)
+			{
+				Keys[i] = DWORD( Rand() % 7 ) << ( KeyBits - 8 );
+			}
+			CHECK( SameAsStable( Keys, KeyBits ) );
+			//random keys with garbage above KeyBits
+			for (int i = 0; i < N; i++)
+			{
+				Keys[i] = ( Rand() << 16 ) ^ Rand();
+			}
+			CHECK( SameAsStable( Keys, KeyBits ) );
+		}
+	}
+
+	//all keys alike: every pass is skipped and the order stays
+	std::vector<DWORD> Same( 1000, 0x12345678 );
+	CHECK( SameAsStable( Same, 32 ) );
+
+	//keys of the Z-buffer: layer, Y line, X; the lo and hi layers keep
+	//the order of adding
+	std::vector<DWORD> Keys( 20000 );
+	for (int i = 0; i < 20000; i++)
+	{
+		DWORD Layer = i < 300 ? 0 : ( i >= 19700 ? 2 : 1 );
+		DWORD Y = Layer == 1 ? 256 + Rand() % 1024 : 0;
+		int X = Layer == 1 ? int( Rand() % 1400 ) - 100 : 0;
+		Keys[i] = ( Layer << 27 ) | ( Y << 16 ) | DWORD( word( X + 0x8000 ) );
+	}
+	CHECK( SameAsStable( Keys, 29 ) );
+	return TestResult( "ZSortTest" );
+}